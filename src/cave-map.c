@@ -108,6 +108,7 @@ void map_info(unsigned y, unsigned x, grid_data *g)
 
 		/* Remember seen feature */
 		cave_k->squares[y][x].feat = cave->squares[y][x].feat;
+		square_update_planes(cave_k, y, x);
 	} else if (!square_ismark(cave, y, x)) {
 		g->f_idx = FEAT_NONE;
 		//cave_k->squares[y][x].feat = FEAT_NONE;
@@ -231,6 +232,21 @@ void square_note_spot(struct chunk *c, int y, int x)
 
 
 
+/**
+ * Most map updates a batch passes on one by one; past this many different
+ * grids it asks for the whole map to be redrawn instead
+ */
+#define MAP_BATCH_MAX 256
+
+/**
+ * Map updates held back since map_batch_begin(): the grids already noted,
+ * and the order they came in
+ */
+static int map_batch_depth;
+static byte *map_batch_seen;
+static struct loc map_batch[MAP_BATCH_MAX];
+static int map_batch_num;
+
 /**
  * Tell the UI that a given map location has been updated
  *
@@ -239,11 +255,61 @@ void square_note_spot(struct chunk *c, int y, int x)
 void square_light_spot(struct chunk *c, int y, int x)
 {
 	if (c == cave) {
+		int grid = y * c->width + x;
+
 		player->upkeep->redraw |= PR_ITEMLIST;
-		event_signal_point(EVENT_MAP, x, y);
+
+		if (!map_batch_depth) {
+			event_signal_point(EVENT_MAP, x, y);
+			return;
+		}
+
+		/* Note each grid once, until there are too many to bother */
+		if (map_batch_num > MAP_BATCH_MAX) return;
+		if (map_batch_seen[grid / 8] & (1 << (grid % 8))) return;
+		map_batch_seen[grid / 8] |= 1 << (grid % 8);
+		if (map_batch_num < MAP_BATCH_MAX) {
+			map_batch[map_batch_num].y = y;
+			map_batch[map_batch_num].x = x;
+		}
+		map_batch_num++;
+	}
+}
+
+/**
+ * Hold back map updates until map_batch_end(), for effects which change
+ * large parts of the map at once; batches can nest.
+ */
+void map_batch_begin(void)
+{
+	if (!map_batch_depth++) {
+		map_batch_seen = mem_zalloc((cave->height * cave->width + 7) / 8);
+		map_batch_num = 0;
 	}
 }
 
+/**
+ * Let the UI have the map updates held back since map_batch_begin(), each
+ * grid once, or as a single redraw of the whole map if there are many
+ */
+void map_batch_end(void)
+{
+	int i;
+
+	assert(map_batch_depth > 0);
+	if (--map_batch_depth) return;
+
+	if (map_batch_num > MAP_BATCH_MAX)
+		event_signal_point(EVENT_MAP, -1, -1);
+	else
+		for (i = 0; i < map_batch_num; i++)
+			event_signal_point(EVENT_MAP, map_batch[i].x, map_batch[i].y);
+
+	mem_free(map_batch_seen);
+	map_batch_seen = NULL;
+	map_batch_num = 0;
+}
+
 
 /**
  * This routine will Perma-Light all grids in the set passed in.
@@ -408,16 +474,57 @@ void light_room(int y1, int x1, bool light)
 	}
 
 	/* Now, lighten or darken them all at once */
+	map_batch_begin();
 	if (light) {
 		cave_light(ps);
 	} else {
 		cave_unlight(ps);
 	}
+	map_batch_end();
 	point_set_dispose(ps);
 }
 
 
 
+/**
+ * Find every grid of a chunk which is, or is next to, a fully in-bounds grid
+ * passing the given test.
+ *
+ * Each grid is tested once, rather than once for every neighbour it has,
+ * and the result is a height * width array of flags which the caller frees.
+ */
+static bool *cave_near(struct chunk *c, square_predicate test)
+{
+	int y, x, i;
+	bool *near = mem_zalloc(c->height * c->width * sizeof(bool));
+
+	for (y = 1; y < c->height - 1; y++) {
+		for (x = 1; x < c->width - 1; x++) {
+			if (!test(c, y, x)) continue;
+			for (i = 0; i < 9; i++)
+				near[(y + ddy_ddd[i]) * c->width + x + ddx_ddd[i]] = TRUE;
+		}
+	}
+
+	return near;
+}
+
+/**
+ * True if the square doesn't look like a wall to the player
+ */
+static bool square_seemsopen(struct chunk *c, int y, int x)
+{
+	return !square_seemslikewall(c, y, x);
+}
+
+/**
+ * True if the square is a floor or a staircase
+ */
+static bool square_isfloor_or_stairs(struct chunk *c, int y, int x)
+{
+	return square_isfloor(c, y, x) || square_isstairs(c, y, x);
+}
+
 /**
  * Light up the dungeon using "claravoyance"
  *
@@ -427,33 +534,31 @@ void light_room(int y1, int x1, bool light)
  */
 void wiz_light(struct chunk *c, bool full)
 {
-	int i, y, x;
+	int y, x;
+
+	/* Every grid next to a non-wall gets lit */
+	bool *near = cave_near(c, square_seemsopen);
 
 	/* Scan all grids */
-	for (y = 1; y < c->height - 1; y++) {
-		for (x = 1; x < c->width - 1; x++) {
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < c->width; x++) {
 			struct object *obj;
 
-			/* Process all non-walls */
-			if (!square_seemslikewall(c, y, x)) {
-				/* Scan all neighbors */
-				for (i = 0; i < 9; i++) {
-					int yy = y + ddy_ddd[i];
-					int xx = x + ddx_ddd[i];
-
-					/* Perma-light the grid */
-					sqinfo_on(c->squares[yy][xx].info, SQUARE_GLOW);
-
-					/* Memorize normal features */
-					if (!square_isfloor(c, yy, xx) || 
-						square_isvisibletrap(c, yy, xx)) {
-						sqinfo_on(c->squares[yy][xx].info, SQUARE_MARK);
-						cave_k->squares[yy][xx].feat = c->squares[yy][xx].feat;
-					}
+			if (near[y * c->width + x]) {
+				/* Perma-light the grid */
+				sqinfo_on(c->squares[y][x].info, SQUARE_GLOW);
+
+				/* Memorize normal features */
+				if (!square_isfloor(c, y, x) || 
+					square_isvisibletrap(c, y, x)) {
+					sqinfo_on(c->squares[y][x].info, SQUARE_MARK);
+					cave_k->squares[y][x].feat = c->squares[y][x].feat;
+					square_update_planes(cave_k, y, x);
 				}
 			}
 
 			/* Memorize objects */
+			if (!square_in_bounds_fully(c, y, x)) continue;
 			for (obj = square_object(cave, y, x); obj; obj = obj->next) {
 				/* Skip dead objects */
 				assert(obj->kind);
@@ -465,6 +570,8 @@ void wiz_light(struct chunk *c, bool full)
 		}
 	}
 
+	mem_free(near);
+
 	/* Fully update the visuals */
 	player->upkeep->update |= (PU_FORGET_VIEW | PU_UPDATE_VIEW | PU_MONSTERS);
 
@@ -479,19 +586,20 @@ void wiz_light(struct chunk *c, bool full)
 void wiz_dark(void)
 {
 	int y, x;
-
+	bitflag forget[SQUARE_SIZE];
 
 	/* Forget every grid */
+	sqinfo_wipe(forget);
+	sqinfo_on(forget, SQUARE_MARK);
+	sqinfo_on(forget, SQUARE_DTRAP);
+	sqinfo_on(forget, SQUARE_DEDGE);
+	cave_sqinfo_off(cave, forget);
+
+	/* Forget all objects */
 	for (y = 0; y < cave->height; y++) {
 		for (x = 0; x < cave->width; x++) {
 			struct object *obj;
 
-			/* Process the grid */
-			sqinfo_off(cave->squares[y][x].info, SQUARE_MARK);
-			sqinfo_off(cave->squares[y][x].info, SQUARE_DTRAP);
-			sqinfo_off(cave->squares[y][x].info, SQUARE_DEDGE);
-
-			/* Forget all objects */
 			for (obj = square_object(cave, y, x); obj; obj = obj->next) {
 				/* Skip dead objects */
 				assert(obj->kind);
@@ -518,28 +626,15 @@ void cave_illuminate(struct chunk *c, bool daytime)
 {
 	int y, x, i;
 
+	/* Skip grids with no surrounding floors or stairs */
+	bool *near = cave_near(c, square_isfloor_or_stairs);
+
 	/* Apply light or darkness */
 	for (y = 0; y < c->height; y++)
 		for (x = 0; x < c->width; x++) {
-			int d;
-			bool light = FALSE;
 			feature_type *f_ptr = &f_info[c->squares[y][x].feat];
-			
-			/* Skip grids with no surrounding floors or stairs */
-			for (d = 0; d < 9; d++) {
-				/* Extract adjacent (legal) location */
-				int yy = y + ddy_ddd[d];
-				int xx = x + ddx_ddd[d];
-
-				/* Paranoia */
-				if (!square_in_bounds_fully(c, yy, xx)) continue;
-
-				/* Test */
-				if (square_isfloor(c, yy, xx) || square_isstairs(c, yy, xx))
-					light = TRUE;
-			}
 
-			if (!light) continue;
+			if (!near[y * c->width + x]) continue;
 
 			/* Only interesting grids at night */
 			if (daytime || !tf_has(f_ptr->flags, TF_FLOOR)) {
@@ -550,7 +645,8 @@ void cave_illuminate(struct chunk *c, bool daytime)
 				sqinfo_off(c->squares[y][x].info, SQUARE_MARK);
 			}
 		}
-			
+
+	mem_free(near);
 			
 	/* Light shop doorways */
 	for (y = 0; y < c->height; y++) {
@@ -574,185 +670,409 @@ void cave_illuminate(struct chunk *c, bool daytime)
 	player->upkeep->redraw |= (PR_MAP | PR_MONLIST | PR_ITEMLIST);
 }
 
+/*
+ * The flow records, for each grid the player can reach, the number of steps
+ * needed to reach it ("cost") and the pass which last reached it ("when").
+ * A "when" of zero means the grid has never been reached.
+ *
+ * Each pass that actually changes the flow gets a new stamp, c->flow_stamp.
+ * When the stamps run out every grid is shifted back by FLOW_STAMP_HALF, so
+ * that old data stays older than new data; this means that as long as the
+ * player does not "teleport", then any monster up to
+ * z_info->max_flow_depth steps away will be able to track down the player,
+ * and in general, will be able to track down either the player or a
+ * position recently occupied by the player.
+ *
+ * Both fields are 16 bits wide, so the flow depth may cover a whole level.
+ */
+#define FLOW_STAMP_HALF 0x8000
+
 /**
- * Size of the circular queue used by "update_flow()"
+ * Can the flow pass through a grid?
  */
-#define FLOW_MAX 2048
+static bool square_isflow(struct chunk *c, int y, int x)
+{
+	return !tf_has(f_info[c->squares[y][x].feat].flags, TF_NO_FLOW);
+}
 
-/*
- * Hack -- provide some "speed" for the "flow" code
- * This entry is the "current index" for the "when" field
- * Note that a "when" value of "zero" means "not used".
- *
- * Note that the "cost" indexes from 1 to 127 are for
- * "old" data, and from 128 to 255 are for "new" data.
+/**
+ * Spread the flow outwards from the grids in a queue.
  *
- * This means that as long as the player does not "teleport",
- * then any monster up to 128 + z_info->max_flow_depth will be
- * able to track down the player, and in general, will be
- * able to track down either the player or a position recently
- * occupied by the player.
+ * Each grid in queue[head..tail) has its cost set for the current stamp;
+ * its neighbours are given one more, if that is new or better than what
+ * they have.  Because every step costs one and the queue is taken in order,
+ * the first improvement to a grid is the final one, so no grid is queued
+ * twice and the queue never needs more than one entry per grid.
  */
-static int flow_save = 0;
+static void flow_spread(struct chunk *c, int *queue, int head, int tail)
+{
+	u16b stamp = c->flow_stamp;
+
+	while (head != tail) {
+		int grid = queue[head++];
+		int ty = grid / c->width, tx = grid % c->width;
+		int n = c->cost[ty][tx] + 1;
+		int d;
 
+		/* Limit flow depth */
+		if (n >= z_info->max_flow_depth) continue;
 
+		/* Add the "children" */
+		for (d = 0; d < 8; d++) {
+			int y = ty + ddy_ddd[d];
+			int x = tx + ddx_ddd[d];
+			if (!square_in_bounds(c, y, x)) continue;
+
+			/* Ignore grids which already have as good a route */
+			if (c->when[y][x] == stamp && c->cost[y][x] <= n) continue;
+
+			/* Ignore "walls" and "rubble" */
+			if (!square_isflow(c, y, x)) continue;
+
+			/* Save the flow */
+			c->when[y][x] = stamp;
+			c->cost[y][x] = n;
+			queue[tail++] = y * c->width + x;
+		}
+	}
+}
 
 /**
- * Forget the "flow" information ready for a complete update
+ * Is a grid somewhere a monster could stand out of the player's view?
  */
-void cave_forget_flow(struct chunk *c)
+static bool square_issafe(struct chunk *c, int y, int x)
 {
-	int x, y;
+	return square_in_bounds_fully(c, y, x) && square_ispassable(c, y, x) &&
+		!square_isview(c, y, x);
+}
 
-	/* Nothing to forget */
-	if (!flow_save) return;
+/**
+ * Size of the sectors the level is split into for FIELD_ROUTE
+ */
+#define ROUTE_SECTOR 8
+
+/**
+ * Get the sector a grid is in
+ */
+static struct loc route_sector(int y, int x)
+{
+	return loc(x / ROUTE_SECTOR, y / ROUTE_SECTOR);
+}
+
+/**
+ * Is a grid in the player's sector, and reached by the current flow?
+ *
+ * Routing to these grids, rather than to the player, means the route only
+ * needs redoing when the player changes sector; once a monster arrives the
+ * flow takes over.
+ */
+static bool square_isroutegoal(struct chunk *c, int y, int x)
+{
+	return c->flow_stamp && (c->when[y][x] == c->flow_stamp) &&
+		(y / ROUTE_SECTOR == player->py / ROUTE_SECTOR) &&
+		(x / ROUTE_SECTOR == player->px / ROUTE_SECTOR);
+}
+
+/**
+ * The distance fields.  Each has a test for its goal grids, and says
+ * whether it depends on the player's view, in which case it is redone
+ * whenever update_view() has changed the view since it was made, and
+ * whether it depends on the player's sector, in which case it is redone
+ * when the player has moved to another one.  All of them are redone after
+ * any change of terrain.
+ */
+static const struct field_info {
+	bool (*goal)(struct chunk *c, int y, int x);
+	bool follows_view;
+	bool follows_sector;
+} field_info[FIELD_MAX] = {
+	{ square_isstairs, FALSE, FALSE },
+	{ square_issafe, TRUE, FALSE },
+	{ square_isroutegoal, FALSE, TRUE },
+};
+
+/**
+ * Make a distance field, by a breadth-first search outwards from all its
+ * goal grids at once, through any grid the flow could pass
+ */
+static void field_make(struct chunk *c, int field)
+{
+	int n = c->height * c->width;
+	u16b *dist = c->fields[field];
+	int *queue = mem_alloc(n * sizeof(int));
+	int head = 0, tail = 0;
+	int i, y, x, d;
+
+	for (i = 0; i < n; i++)
+		dist[i] = FIELD_UNREACHED;
 
-	/* Check the entire dungeon */
 	for (y = 0; y < c->height; y++) {
 		for (x = 0; x < c->width; x++) {
-			/* Forget the old data */
-			c->squares[y][x].cost = 0;
-			c->squares[y][x].when = 0;
+			if (!field_info[field].goal(c, y, x)) continue;
+			dist[y * c->width + x] = 0;
+			queue[tail++] = y * c->width + x;
 		}
 	}
 
-	/* Start over */
-	flow_save = 0;
-}
+	while (head != tail) {
+		int grid = queue[head++];
+		int ty = grid / c->width, tx = grid % c->width;
+
+		for (d = 0; d < 8; d++) {
+			y = ty + ddy_ddd[d];
+			x = tx + ddx_ddd[d];
+			if (!square_in_bounds(c, y, x)) continue;
+			if (dist[y * c->width + x] != FIELD_UNREACHED) continue;
+			if (!square_isflow(c, y, x)) continue;
 
+			dist[y * c->width + x] = dist[grid] + 1;
+			queue[tail++] = y * c->width + x;
+		}
+	}
 
-/*
- * Hack -- fill in the "cost" field of every grid that the player can
- * "reach" with the number of steps needed to reach that grid.  This
- * also yields the "distance" of the player from every grid.
- *
- * In addition, mark the "when" of the grids that can reach the player
- * with the incremented value of "flow_save".
+	mem_free(queue);
+
+	c->field_stale[field] = FALSE;
+	c->field_sector[field] = route_sector(player->py, player->px);
+}
+
+/**
+ * Find the steps from the nearest of some source grids to every grid that
+ * can be reached from them through the grids of one of the chunk's planes.
  *
- * Hack -- use the local "flow_y" and "flow_x" arrays as a "circular
- * queue" of cave grids.
+ * The caller gives 'dist' and 'queue', each with room for one entry per grid
+ * of the chunk, so that the search can be run over and over with nothing
+ * allocated; grid (y, x) is entry y * c->width + x.  Grids not reached are
+ * left at FIELD_UNREACHED.  The sources themselves are always at 0, and the
+ * search keeps to grids fully in bounds.
  *
- * We do not need a priority queue because the cost from grid to grid
- * is always "one" (even along diagonals) and we process them in order.
+ * Returns the number of grids reached.
  */
-void cave_update_flow(struct chunk *c)
+int cave_distances(struct chunk *c, int plane, const struct loc *from,
+				   int num, u16b *dist, int *queue)
 {
-	int py = player->py;
-	int px = player->px;
+	int n = c->height * c->width;
+	int head = 0, tail = 0;
+	int i, y, x, d;
 
-	int ty, tx;
+	assert(plane >= 0 && plane < PLANE_MAX);
 
-	int y, x;
+	for (i = 0; i < n; i++)
+		dist[i] = FIELD_UNREACHED;
 
-	int n, d;
+	for (i = 0; i < num; i++) {
+		int grid = from[i].y * c->width + from[i].x;
+		if (dist[grid] == 0) continue;
+		dist[grid] = 0;
+		queue[tail++] = grid;
+	}
 
-	int flow_n;
+	while (head != tail) {
+		int grid = queue[head++];
+		int ty = grid / c->width, tx = grid % c->width;
 
-	int flow_tail = 0;
-	int flow_head = 0;
+		for (d = 0; d < 8; d++) {
+			y = ty + ddy_ddd[d];
+			x = tx + ddx_ddd[d];
+			if (!square_in_bounds_fully(c, y, x)) continue;
+			if (dist[y * c->width + x] != FIELD_UNREACHED) continue;
+			if (!plane_has(c, plane, y, x)) continue;
 
-	byte flow_y[FLOW_MAX];
-	byte flow_x[FLOW_MAX];
+			dist[y * c->width + x] = dist[grid] + 1;
+			queue[tail++] = y * c->width + x;
+		}
+	}
 
+	return tail;
+}
 
-	/*** Cycle the flow ***/
+/**
+ * Get the distance from a grid to the nearest goal of a distance field,
+ * making the field first if it isn't up to date.
+ *
+ * FIELD_UNREACHED means no goal can be reached from the grid.
+ */
+int cave_field_dist(struct chunk *c, int field, int y, int x)
+{
+	assert(field >= 0 && field < FIELD_MAX);
 
-	/* Cycle the flow */
-	if (flow_save++ == 255)
-	{
-		/* Cycle the flow */
-		for (y = 0; y < c->height; y++)
-		{
-			for (x = 0; x < c->width; x++)
-			{
-				int w = c->squares[y][x].when;
-				c->squares[y][x].when = (w >= 128) ? (w - 128) : 0;
-			}
-		}
+	if (!c->fields[field]) {
+		c->fields[field] = mem_alloc(c->height * c->width * sizeof(u16b));
+		c->field_stale[field] = TRUE;
+	}
 
-		/* Restart */
-		flow_save = 128;
+	if (field_info[field].follows_sector) {
+		struct loc sector = route_sector(player->py, player->px);
+		if ((sector.x != c->field_sector[field].x) ||
+			(sector.y != c->field_sector[field].y))
+			c->field_stale[field] = TRUE;
 	}
 
-	/* Local variable */
-	flow_n = flow_save;
+	if (c->field_stale[field])
+		field_make(c, field);
 
+	return c->fields[field][y * c->width + x];
+}
 
-	/*** Player Grid ***/
+/**
+ * Mark the distance fields which depend on the player's view to be redone
+ */
+void cave_fields_view_changed(struct chunk *c)
+{
+	int i;
 
-	/* Save the time-stamp */
-	c->squares[py][px].when = flow_n;
+	for (i = 0; i < FIELD_MAX; i++)
+		if (field_info[i].follows_view)
+			c->field_stale[i] = TRUE;
+}
 
-	/* Save the flow cost */
-	c->squares[py][px].cost = 0;
+/**
+ * Free the distance fields of a chunk
+ */
+void cave_fields_free(struct chunk *c)
+{
+	int i;
 
-	/* Enqueue that entry */
-	flow_y[flow_head] = py;
-	flow_x[flow_head] = px;
+	for (i = 0; i < FIELD_MAX; i++) {
+		mem_free(c->fields[i]);
+		c->fields[i] = NULL;
+	}
+}
 
-	/* Advance the queue */
-	++flow_tail;
+/**
+ * Forget the "flow" information ready for a complete update
+ */
+void cave_forget_flow(struct chunk *c)
+{
+	/* Nothing to forget */
+	if (!c->flow_stamp) return;
 
+	/* Forget the old data for the entire dungeon */
+	memset(c->cost[0], 0, c->height * c->width * sizeof(u16b));
+	memset(c->when[0], 0, c->height * c->width * sizeof(u16b));
 
-	/*** Process Queue ***/
+	/* Start over */
+	c->flow_stamp = 0;
+	c->flow_dirty = FALSE;
+}
 
-	/* Now process the queue */
-	while (flow_head != flow_tail)
-	{
-		/* Extract the next entry */
-		ty = flow_y[flow_head];
-		tx = flow_x[flow_head];
 
-		/* Forget that entry (with wrap) */
-		if (++flow_head == FLOW_MAX) flow_head = 0;
+/**
+ * Repair the flow after the terrain of a grid has changed.
+ *
+ * A grid which has become open can only shorten routes, so its cost is
+ * taken from its best neighbour and spread from there.  A grid which has
+ * closed may lengthen routes through it, which can't be repaired locally,
+ * so the next cave_update_flow() starts afresh instead.
+ *
+ * Any distance fields are marked to be redone the next time they're used.
+ */
+void cave_flow_feat_changed(struct chunk *c, int y, int x)
+{
+	u16b stamp = c->flow_stamp;
+	int best = -1;
+	int d, *queue;
 
-		/* Child cost */
-		n = c->squares[ty][tx].cost + 1;
+	/* Distance fields are simply redone when next asked for */
+	for (d = 0; d < FIELD_MAX; d++)
+		c->field_stale[d] = TRUE;
 
-		/* Hack -- Limit flow depth */
-		if (n == z_info->max_flow_depth) continue;
+	/* No flow yet, or already due to be redone */
+	if (!stamp || c->flow_dirty) return;
 
-		/* Add the "children" */
-		for (d = 0; d < 8; d++)
-		{
-			int old_head = flow_tail;
+	if (!square_isflow(c, y, x)) {
+		if (c->when[y][x] == stamp) c->flow_dirty = TRUE;
+		return;
+	}
 
-			/* Child location */
-			y = ty + ddy_ddd[d];
-			x = tx + ddx_ddd[d];
-			if (!square_in_bounds(c, y, x)) continue;
+	/* Find the best route in */
+	for (d = 0; d < 8; d++) {
+		int yy = y + ddy_ddd[d];
+		int xx = x + ddx_ddd[d];
+		if (!square_in_bounds(c, yy, xx)) continue;
+		if (c->when[yy][xx] != stamp) continue;
+		if (best < 0 || c->cost[yy][xx] < best)
+			best = c->cost[yy][xx];
+	}
 
-			/* Ignore "pre-stamped" entries */
-			if (c->squares[y][x].when == flow_n) continue;
+	/* Nothing reached it, or it was already as close as it can be */
+	if (best < 0 || best + 1 >= z_info->max_flow_depth) return;
+	if (c->when[y][x] == stamp && c->cost[y][x] <= best + 1) return;
 
-			/* Ignore "walls" and "rubble" */
-			if (tf_has(f_info[c->squares[y][x].feat].flags, TF_NO_FLOW))
-				continue;
+	c->when[y][x] = stamp;
+	c->cost[y][x] = best + 1;
 
-			/* Save the time-stamp */
-			c->squares[y][x].when = flow_n;
+	queue = mem_alloc(c->height * c->width * sizeof(int));
+	queue[0] = y * c->width + x;
+	flow_spread(c, queue, 0, 1);
+	mem_free(queue);
+}
 
-			/* Save the flow cost */
-			c->squares[y][x].cost = n;
 
-			/* Enqueue that entry */
-			flow_y[flow_tail] = y;
-			flow_x[flow_tail] = x;
+/**
+ * Fill in the "cost" field of every grid that the player can "reach" with
+ * the number of steps needed to reach that grid.  This also yields the
+ * "distance" of the player from every grid.
+ *
+ * In addition, mark the "when" of the grids that can reach the player
+ * with a new stamp.
+ *
+ * If the player hasn't moved and no terrain has closed since the last
+ * update, the flow is still correct (terrain which opened has already been
+ * repaired by cave_flow_feat_changed()), so nothing is done.
+ *
+ * We do not need a priority queue because the cost from grid to grid
+ * is always "one" (even along diagonals) and we process them in order.
+ */
+void cave_update_flow(struct chunk *c)
+{
+	int py = player->py;
+	int px = player->px;
+	int n, *queue;
 
-			/* Advance the queue */
-			if (++flow_tail == FLOW_MAX) flow_tail = 0;
+	/* Still up to date */
+	if (c->flow_stamp && !c->flow_dirty &&
+		(c->flow_source.y == py) && (c->flow_source.x == px))
+		return;
 
-			/* Hack -- Overflow by forgetting new entry */
-			if (flow_tail == flow_head) flow_tail = old_head;
-		}
+	/*** Cycle the flow ***/
+
+	/* Cycle the flow */
+	if (c->flow_stamp++ == 0xFFFF) {
+		/* Cycle the flow, which is all in one block */
+		u16b *when = c->when[0];
+		for (n = 0; n < c->height * c->width; n++)
+			when[n] = (when[n] >= FLOW_STAMP_HALF) ?
+				(when[n] - FLOW_STAMP_HALF) : 0;
+
+		/* Restart */
+		c->flow_stamp = FLOW_STAMP_HALF;
 	}
+
+	c->flow_source = loc(px, py);
+	c->flow_dirty = FALSE;
+
+	/*** Player Grid ***/
+
+	c->when[py][px] = c->flow_stamp;
+	c->cost[py][px] = 0;
+
+	/*** Process Queue ***/
+
+	queue = mem_alloc(c->height * c->width * sizeof(int));
+	queue[0] = py * c->width + px;
+	flow_spread(c, queue, 0, 1);
+	mem_free(queue);
 }
 
 /* Make map features known */
 void cave_known (void)
 {
 	int y,x;
-	for (y = 0; y < cave->height; y++)
-		for (x = 0; x < cave->width; x++)
+	for (y = 0; y < cave->height; y++) {
+		for (x = 0; x < cave->width; x++) {
 			cave_k->squares[y][x].feat = cave->squares[y][x].feat;
+			square_update_planes(cave_k, y, x);
+		}
+	}
 }
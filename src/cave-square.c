@@ -462,7 +462,46 @@ bool square_isproject(struct chunk *c, int y, int x) {
  * True if the square is open (a floor square not occupied by a monster).
  */
 bool square_isopen(struct chunk *c, int y, int x) {
-	return square_isfloor(c, y, x) && !c->squares[y][x].mon;
+	return square_isfloor(c, y, x) && !square_isoccupied(c, y, x);
+}
+
+/**
+ * True if the square holds a monster or the player.
+ */
+bool square_isoccupied(struct chunk *c, int y, int x) {
+	return plane_has(c, PLANE_OCCUPIED, y, x);
+}
+
+/**
+ * Count the grids holding a monster or the player in the rectangle from
+ * (y1, x1) to (y2, x2) inclusive, which must be within the chunk; each row
+ * is taken from the occupied plane a word at a time.
+ */
+int square_num_occupied(struct chunk *c, int y1, int x1, int y2, int x2)
+{
+	int y, x, num = 0;
+
+	assert(square_in_bounds(c, y1, x1) && square_in_bounds(c, y2, x2));
+
+	for (y = y1; y <= y2; y++) {
+		for (x = x1; x <= x2; x = (x / PLANE_WORD_BITS + 1) * PLANE_WORD_BITS) {
+			int first = x % PLANE_WORD_BITS, last = PLANE_WORD_BITS - 1;
+			u32b bits = plane_word(c, PLANE_OCCUPIED, y, x) >> first;
+
+			/* Leave out anything past the end of the rectangle */
+			if (x2 / PLANE_WORD_BITS == x / PLANE_WORD_BITS)
+				last = x2 % PLANE_WORD_BITS;
+			if (last - first + 1 < PLANE_WORD_BITS)
+				bits &= (1UL << (last - first + 1)) - 1;
+
+			while (bits) {
+				bits &= bits - 1;
+				num++;
+			}
+		}
+	}
+
+	return num;
 }
 
 /**
@@ -499,7 +538,7 @@ bool square_isdiggable(struct chunk *c, int y, int x) {
 bool square_is_monster_walkable(struct chunk *c, int y, int x)
 {
 	assert(square_in_bounds(c, y, x));
-	return feat_is_monster_walkable(c->squares[y][x].feat);
+	return plane_has(c, PLANE_PASSABLE, y, x);
 }
 
 /**
@@ -507,7 +546,7 @@ bool square_is_monster_walkable(struct chunk *c, int y, int x)
  */
 bool square_ispassable(struct chunk *c, int y, int x) {
 	assert(square_in_bounds(c, y, x));
-	return feat_is_passable(c->squares[y][x].feat);
+	return plane_has(c, PLANE_PASSABLE, y, x);
 }
 
 /**
@@ -517,7 +556,7 @@ bool square_ispassable(struct chunk *c, int y, int x) {
  */
 bool square_isprojectable(struct chunk *c, int y, int x) {
 	assert(square_in_bounds(c, y, x));
-	return feat_is_projectable(c->squares[y][x].feat);
+	return plane_has(c, PLANE_PROJECT, y, x);
 }
 
 /**
@@ -527,7 +566,7 @@ bool square_isprojectable(struct chunk *c, int y, int x) {
  */
 bool square_iswall(struct chunk *c, int y, int x) {
 	assert(square_in_bounds(c, y, x));
-	return !square_isprojectable(c, y, x);
+	return !plane_has(c, PLANE_PROJECT, y, x);
 }
 
 /**
@@ -546,7 +585,7 @@ bool square_isstrongwall(struct chunk *c, int y, int x) {
  */
 bool square_isbright(struct chunk *c, int y, int x) {
 	assert(square_in_bounds(c, y, x));
-	return feat_is_bright(c->squares[y][x].feat);
+	return plane_has(c, PLANE_BRIGHT, y, x);
 }
 
 bool square_iswarded(struct chunk *c, int y, int x)
@@ -715,12 +754,16 @@ bool square_holds_object(struct chunk *c, int y, int x, struct object *obj) {
  */
 void square_excise_object(struct chunk *c, int y, int x, struct object *obj) {
 	pile_excise(&c->squares[y][x].obj, obj);
+	if (!c->squares[y][x].obj)
+		cave_object_cell(c, y, x, FALSE);
 }
 
 /**
  * Excise an entire floor pile.
  */
 void square_excise_pile(struct chunk *c, int y, int x) {
+	if (c->squares[y][x].obj)
+		cave_object_cell(c, y, x, FALSE);
 	object_pile_free(square_object(c, y, x));
 	c->squares[y][x].obj = NULL;
 }
@@ -746,6 +789,10 @@ void square_set_feat(struct chunk *c, int y, int x, int feat)
 
 	/* Make the change */
 	c->squares[y][x].feat = feat;
+	cave_terrain_stamp++;
+	square_update_planes(c, y, x);
+	cave_note_view_change(c, y, x);
+	cave_flow_feat_changed(c, y, x);
 
 	/* Make the new terrain feel at home */
 	if (character_dungeon) {
@@ -763,6 +810,86 @@ void square_set_feat(struct chunk *c, int y, int x, int feat)
 	}
 }
 
+/**
+ * Bring the terrain planes for a square into line with its feature.
+ *
+ * Anything which writes a square's feat directly, rather than through
+ * square_set_feat(), needs to call this afterwards.
+ */
+void square_update_planes(struct chunk *c, int y, int x)
+{
+	int feat = c->squares[y][x].feat;
+	u32b bit = 1UL << (x % PLANE_WORD_BITS);
+	bool has[PLANE_MAX];
+	int i;
+
+	has[PLANE_PROJECT] = feat_is_projectable(feat);
+	has[PLANE_PASSABLE] = feat_is_passable(feat);
+	has[PLANE_BRIGHT] = feat_is_bright(feat);
+
+	/* The terrain planes come before the occupied one */
+	for (i = 0; i < PLANE_OCCUPIED; i++) {
+		if (has[i])
+			plane_word(c, i, y, x) |= bit;
+		else
+			plane_word(c, i, y, x) &= ~bit;
+	}
+}
+
+/**
+ * Bring the terrain planes of a whole chunk into line with its features, a
+ * word at a time and looking each feature up only once, for when every
+ * square has been written directly.
+ */
+void cave_update_planes(struct chunk *c)
+{
+	byte *has = mem_zalloc(z_info->f_max);
+	int y, x, i, j;
+
+	for (i = 0; i < z_info->f_max; i++) {
+		if (feat_is_projectable(i)) has[i] |= 1 << PLANE_PROJECT;
+		if (feat_is_passable(i)) has[i] |= 1 << PLANE_PASSABLE;
+		if (feat_is_bright(i)) has[i] |= 1 << PLANE_BRIGHT;
+	}
+
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < c->width; x += PLANE_WORD_BITS) {
+			u32b word[PLANE_OCCUPIED] = { 0 };
+			int n = MIN(PLANE_WORD_BITS, c->width - x);
+
+			for (j = 0; j < n; j++) {
+				byte feat_has = has[c->squares[y][x + j].feat];
+
+				for (i = 0; i < PLANE_OCCUPIED; i++)
+					if (feat_has & (1 << i))
+						word[i] |= 1UL << j;
+			}
+
+			for (i = 0; i < PLANE_OCCUPIED; i++)
+				plane_word(c, i, y, x) = word[i];
+		}
+	}
+
+	mem_free(has);
+}
+
+/**
+ * Put a monster (m_idx > 0), the player (m_idx < 0) or nobody in a square,
+ * keeping the occupied plane in step.
+ *
+ * Everything which sets a square's mon should come through here.
+ */
+void square_set_mon(struct chunk *c, int y, int x, int m_idx)
+{
+	u32b bit = 1UL << (x % PLANE_WORD_BITS);
+
+	c->squares[y][x].mon = m_idx;
+	if (m_idx)
+		plane_word(c, PLANE_OCCUPIED, y, x) |= bit;
+	else
+		plane_word(c, PLANE_OCCUPIED, y, x) &= ~bit;
+}
+
 void square_add_trap(struct chunk *c, int y, int x)
 {
 	place_trap(c, y, x, -1, c->depth);
@@ -22,6 +22,7 @@
 #include "init.h"
 #include "monster.h"
 #include "player-timed.h"
+#include "project.h"
 
 /**
  * Approximate distance between two points.
@@ -42,6 +43,65 @@ int distance(int y1, int x1, int y2, int x2)
 	return ay > ax ? ay + (ax >> 1) : ax + (ay >> 1);
 }
 
+/**
+ * Offsets of every grid within max_sight of a point, sorted by distance(),
+ * with dist_start[d] giving the index of the first grid at distance d.
+ */
+static struct loc *dist_grids;
+static int *dist_start;
+static int dist_radius;
+
+/**
+ * Sort all the offsets within max_sight by distance
+ */
+static void make_distance_table(void)
+{
+	int d, dy, dx, n = 0;
+	int radius = z_info->max_sight;
+	int side = 2 * radius + 1;
+
+	dist_grids = mem_zalloc(side * side * sizeof(struct loc));
+	dist_start = mem_zalloc((radius + 2) * sizeof(int));
+	dist_radius = radius;
+
+	for (d = 0; d <= radius; d++) {
+		dist_start[d] = n;
+		for (dy = -radius; dy <= radius; dy++)
+			for (dx = -radius; dx <= radius; dx++)
+				if (distance(0, 0, dy, dx) == d)
+					dist_grids[n++] = loc(dx, dy);
+	}
+	dist_start[radius + 1] = n;
+}
+
+/**
+ * Get the offsets of all the grids within distance d of a point, nearest
+ * first, and return how many of them there are.
+ *
+ * d may be at most z_info->max_sight.  Since the list is shared among all
+ * distances, the first distance_offsets(d - 1) offsets are the ones nearer
+ * than d.
+ */
+int distance_offsets(int d, const struct loc **offsets)
+{
+	if (!dist_start) make_distance_table();
+	assert(d >= 0 && d <= dist_radius);
+
+	*offsets = dist_grids;
+	return dist_start[d + 1];
+}
+
+
+/**
+ * Test one grid of a line of sight being traced by los_trace(); if there is
+ * no chunk to test against, just record the grid on the path instead.
+ */
+static bool los_step(struct chunk *c, int y, int x, struct loc *path, int *len)
+{
+	if (c) return square_isprojectable(c, y, x);
+	path[(*len)++] = loc(x, y);
+	return TRUE;
+}
 
 /**
  * A simple, fast, integer-based line-of-sight algorithm.  By Joseph Hall,
@@ -78,8 +138,13 @@ int distance(int y1, int x1, int y2, int x2)
  * are "viewable" by the player, which is used for many things, such as
  * determining which grids are illuminated by the player's torch, and which
  * grids and monsters can be "seen" by the player, etc).
+ *
+ * The degenerate adjacent-grid and "knight move" cases are handled by los()
+ * before this is called.  If there is no chunk, nothing is tested; instead
+ * every grid which would have been is recorded in path, and counted in len.
  */
-bool los(struct chunk *c, int y1, int x1, int y2, int x2)
+static bool los_trace(struct chunk *c, int y1, int x1, int y2, int x2,
+					  struct loc *path, int *len)
 {
 	/* Delta */
 	int dx, dy;
@@ -112,19 +177,15 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 	ax = ABS(dx);
 
 
-	/* Handle adjacent (or identical) grids */
-	if ((ax < 2) && (ay < 2)) return (TRUE);
-
-
 	/* Directly South/North */
 	if (!dx) {
 		/* South -- check for walls */
 		if (dy > 0) {
 			for (ty = y1 + 1; ty < y2; ty++)
-				if (!square_isprojectable(c, ty, x1)) return (FALSE);
+				if (!los_step(c, ty, x1, path, len)) return (FALSE);
 		} else { /* North -- check for walls */
 			for (ty = y1 - 1; ty > y2; ty--)
-				if (!square_isprojectable(c, ty, x1)) return (FALSE);
+				if (!los_step(c, ty, x1, path, len)) return (FALSE);
 		}
 
 		/* Assume los */
@@ -136,10 +197,10 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 		/* East -- check for walls */
 		if (dx > 0) {
 			for (tx = x1 + 1; tx < x2; tx++)
-				if (!square_isprojectable(c, y1, tx)) return (FALSE);
+				if (!los_step(c, y1, tx, path, len)) return (FALSE);
 		} else { /* West -- check for walls */
 			for (tx = x1 - 1; tx > x2; tx--)
-				if (!square_isprojectable(c, y1, tx)) return (FALSE);
+				if (!los_step(c, y1, tx, path, len)) return (FALSE);
 		}
 
 		/* Assume los */
@@ -151,14 +212,6 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 	sx = (dx < 0) ? -1 : 1;
 	sy = (dy < 0) ? -1 : 1;
 
-	/* Vertical "knights" */
-	if ((ax == 1) && (ay == 2) && square_isprojectable(c, y1 + sy, x1))
-		return (TRUE);
-	
-	/* Horizontal "knights" */
-	else if ((ay == 1) && (ax == 2) && square_isprojectable(c, y1, x1 + sx))
-		return (TRUE);
-
 	/* Calculate scale factor div 2 */
 	f2 = (ax * ay);
 
@@ -185,7 +238,7 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 		/* Note (below) the case (qy == f2), where */
 		/* the LOS exactly meets the corner of a tile. */
 		while (x2 - tx) {
-			if (!square_isprojectable(c, ty, tx))
+			if (!los_step(c, ty, tx, path, len))
 				return (FALSE);
 
 			qy += m;
@@ -194,7 +247,7 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 				tx += sx;
 			} else if (qy > f2) {
 				ty += sy;
-				if (!square_isprojectable(c, ty, tx))
+				if (!los_step(c, ty, tx, path, len))
 					return (FALSE);
 				qy -= f1;
 				tx += sx;
@@ -221,7 +274,7 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 		/* Note (below) the case (qx == f2), where */
 		/* the LOS exactly meets the corner of a tile. */
 		while (y2 - ty) {
-			if (!square_isprojectable(c, ty, tx))
+			if (!los_step(c, ty, tx, path, len))
 				return (FALSE);
 
 			qx += m;
@@ -230,7 +283,7 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 				ty += sy;
 			} else if (qx > f2) {
 				tx += sx;
-				if (!square_isprojectable(c, ty, tx))
+				if (!los_step(c, ty, tx, path, len))
 					return (FALSE);
 				qx -= f1;
 				ty += sy;
@@ -246,6 +299,128 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 	return (TRUE);
 }
 
+
+
+/**
+ * Grids which must be projectable for each precomputed line of sight,
+ * stored as offsets from the origin; los_paths[] holds, for each offset
+ * (dy, dx), where its grids start in los_grids[] and how many there are.
+ */
+static struct loc *los_grids;
+static struct los_path {
+	int start;
+	int len;
+} *los_paths;
+static int los_radius;
+
+/**
+ * Work out the grids los_trace() tests for every offset within max_sight
+ */
+static void los_make_table(void)
+{
+	int dy, dx, n = 0;
+	int radius = MIN(z_info->max_sight, 90);
+	int side = 2 * radius + 1;
+
+	/* No path along a line tests more than two grids per step */
+	los_grids = mem_zalloc(side * side * 2 * radius * sizeof(struct loc));
+	los_paths = mem_zalloc(side * side * sizeof(struct los_path));
+	los_radius = radius;
+
+	for (dy = -radius; dy <= radius; dy++) {
+		for (dx = -radius; dx <= radius; dx++) {
+			struct los_path *lp = &los_paths[(dy + radius) * side + dx + radius];
+			lp->start = n;
+			los_trace(NULL, 0, 0, dy, dx, los_grids + n, &lp->len);
+			n += lp->len;
+		}
+	}
+
+	los_grids = mem_realloc(los_grids, MAX(n, 1) * sizeof(struct loc));
+}
+
+/**
+ * Free the precomputed lines of sight and distances
+ */
+void cave_view_cleanup(void)
+{
+	mem_free(los_grids);
+	mem_free(los_paths);
+	los_grids = NULL;
+	los_paths = NULL;
+
+	mem_free(dist_grids);
+	mem_free(dist_start);
+	dist_grids = NULL;
+	dist_start = NULL;
+}
+
+/**
+ * Line of sight between two grids, as traced by los_trace().
+ *
+ * Which grids los_trace() has to look at depends only on the offset
+ * between the two endpoints, so for every offset within max_sight of the
+ * origin the grids are worked out once, and stored in los_grids[] in the
+ * order los_trace() would test them.  A query is then a walk down that
+ * list.  Longer lines, which are rare, are traced in full.
+ */
+bool los(struct chunk *c, int y1, int x1, int y2, int x2)
+{
+	int dy = y2 - y1;
+	int dx = x2 - x1;
+	int ay = ABS(dy);
+	int ax = ABS(dx);
+	int sx = (dx < 0) ? -1 : 1;
+	int sy = (dy < 0) ? -1 : 1;
+	int i;
+	struct los_path *lp;
+
+	/* Handle adjacent (or identical) grids */
+	if ((ax < 2) && (ay < 2)) return (TRUE);
+
+	/* Vertical "knights" */
+	if ((ax == 1) && (ay == 2) && square_isprojectable(c, y1 + sy, x1))
+		return (TRUE);
+
+	/* Horizontal "knights" */
+	else if ((ay == 1) && (ax == 2) && square_isprojectable(c, y1, x1 + sx))
+		return (TRUE);
+
+	/* Make the table if necessary */
+	if (!los_paths) los_make_table();
+
+	/* Trace long lines the slow way */
+	if ((ax > los_radius) || (ay > los_radius))
+		return los_trace(c, y1, x1, y2, x2, NULL, NULL);
+
+	/* Check the grids on the precomputed path */
+	lp = &los_paths[(dy + los_radius) * (2 * los_radius + 1) + dx + los_radius];
+	for (i = 0; i < lp->len; i++) {
+		struct loc *grid = &los_grids[lp->start + i];
+		if (!plane_has(c, PLANE_PROJECT, y1 + grid->y, x1 + grid->x))
+			return (FALSE);
+	}
+
+	/* Assume los */
+	return (TRUE);
+}
+
+/**
+ * Can the player be seen from the given grid?
+ *
+ * Normally this traces a projection path from the grid to the player.  With
+ * birth_symmetric_view, sight is taken to be symmetric, so the answer is
+ * just whether the grid is in the player's view, which was worked out once
+ * for everyone by update_view().
+ */
+bool square_sees_player(struct chunk *c, int y, int x)
+{
+	if (OPT(birth_symmetric_view))
+		return square_isview(c, y, x);
+
+	return projectable(c, y, x, player->py, player->px, PROJECT_NONE);
+}
+
 /**
  * The comments below are still predominantly true, and have been left
  * (slightly modified for accuracy) for historical and nostalgic reasons.
@@ -447,8 +622,8 @@ void forget_view(struct chunk *c)
 {
 	int x, y;
 
-	for (y = 0; y < c->height; y++) {
-		for (x = 0; x < c->width; x++) {
+	for (y = c->view_min.y; y <= c->view_max.y; y++) {
+		for (x = c->view_min.x; x <= c->view_max.x; x++) {
 			if (!square_isview(c, y, x))
 				continue;
 			sqinfo_off(c->squares[y][x].info, SQUARE_VIEW);
@@ -456,6 +631,25 @@ void forget_view(struct chunk *c)
 			square_light_spot(c, y, x);
 		}
 	}
+
+	/* The view has to be worked out from scratch next time */
+	c->view_changed = TRUE;
+}
+
+/**
+ * Note that something which may affect the view has happened at a grid,
+ * such as a terrain change or a light-carrying monster moving.
+ *
+ * Anything more than one grid outside the last view can't make a
+ * difference to it (only the player moving can, and that is noticed
+ * separately), so it is ignored.
+ */
+void cave_note_view_change(struct chunk *c, int y, int x)
+{
+	if (y < c->view_min.y - 1 || y > c->view_max.y + 1) return;
+	if (x < c->view_min.x - 1 || x > c->view_max.x + 1) return;
+
+	c->view_changed = TRUE;
 }
 
 
@@ -467,8 +661,8 @@ static void mark_wasseen(struct chunk *c)
 {
 	int x, y;
 	/* Save the old "view" grids for later */
-	for (y = 0; y < c->height; y++) {
-		for (x = 0; x < c->width; x++) {
+	for (y = c->view_min.y; y <= c->view_max.y; y++) {
+		for (x = c->view_min.x; x <= c->view_max.x; x++) {
 			if (square_isseen(c, y, x))
 				sqinfo_on(c->squares[y][x].info, SQUARE_WASSEEN);
 			sqinfo_off(c->squares[y][x].info, SQUARE_VIEW);
@@ -477,49 +671,85 @@ static void mark_wasseen(struct chunk *c)
 	}
 }
 /**
- * Like it says on the tin
+ * Add or remove a monster's light, if it carries any, at a grid of the
+ * chunk's monster light map.
+ *
+ * This must be called whenever a monster appears, moves or disappears, so
+ * that update_view() never needs to look through the monster list.
  */
-static void add_monster_lights(struct chunk *c, struct loc from)
+void cave_monster_light(struct chunk *c, struct monster *m, int y, int x,
+						bool add)
 {
-	int i, j, k;
+	int i, j;
+
+	if (!m->race || !rf_has(m->race->flags, RF_HAS_LIGHT))
+		return;
 
-	/* Scan monster list and add monster lights */
-	for (k = 1; k < cave_monster_max(c); k++) {
-		/* Check the k'th monster */
-		struct monster *m = cave_monster(c, k);
+	/* Light a 3x3 box centered on the monster */
+	for (i = -1; i <= 1; i++) {
+		for (j = -1; j <= 1; j++) {
+			if (!square_in_bounds(c, y + i, x + j))
+				continue;
+			if (add)
+				c->mon_light[y + i][x + j]++;
+			else if (c->mon_light[y + i][x + j])
+				c->mon_light[y + i][x + j]--;
+		}
+	}
 
-		bool in_los = los(c, from.y, from.x, m->fy, m->fx);
+	cave_note_view_change(c, y, x);
+}
 
-		/* Skip dead monsters */
-		if (!m->race)
-			continue;
+/**
+ * Like it says on the tin
+ *
+ * Only grids within the bounds given, which are those the player could
+ * possibly view, are looked at.
+ */
+static void add_monster_lights(struct chunk *c, struct loc from,
+							   struct loc min, struct loc max)
+{
+	int x, y, i;
 
-		/* Skip monsters not carrying light */
-		if (!rf_has(m->race->flags, RF_HAS_LIGHT))
-			continue;
+	for (y = min.y; y <= max.y; y++) {
+		for (x = min.x; x <= max.x; x++) {
+			if (!c->mon_light[y][x])
+				continue;
 
-		/* Light a 3x3 box centered on the monster */
-		for (i = -1; i <= 1; i++)
-			for (j = -1; j <= 1; j++) {
-				int sy = m->fy + i;
-				int sx = m->fx + j;
-				
-				/* If the monster isn't visible we can only light open tiles */
-				if (!in_los && !square_isprojectable(c, sy, sx))
-					continue;
+			/* If the tile is too far away we won't light it */
+			if (distance(from.y, from.x, y, x) > z_info->max_sight)
+				continue;
 
-				/* If the tile is too far away we won't light it */
-				if (distance(from.y, from.x, sy, sx) > z_info->max_sight)
+			/* If no monster lighting it is visible we can only light open
+			 * tiles */
+			if (!square_isprojectable(c, y, x)) {
+				bool seen = FALSE;
+
+				for (i = 0; i < 9 && !seen; i++) {
+					int my = y + ddy_ddd[i];
+					int mx = x + ddx_ddd[i];
+					struct monster *m;
+
+					if (!square_in_bounds(c, my, mx))
+						continue;
+					m = square_monster(c, my, mx);
+					if (m && rf_has(m->race->flags, RF_HAS_LIGHT) &&
+						los(c, from.y, from.x, my, mx))
+						seen = TRUE;
+				}
+
+				if (!seen)
 					continue;
-				
-				/* If the tile itself isn't in LOS, don't light it */
-				if (!los(c, from.y, from.x, sy, sx))
-					continue;
-
-				/* Mark the square lit and seen */
-				sqinfo_on(c->squares[sy][sx].info, SQUARE_VIEW);
-				sqinfo_on(c->squares[sy][sx].info, SQUARE_SEEN);
 			}
+
+			/* If the tile itself isn't in LOS, don't light it */
+			if (!los(c, from.y, from.x, y, x))
+				continue;
+
+			/* Mark the square lit and seen */
+			sqinfo_on(c->squares[y][x].info, SQUARE_VIEW);
+			sqinfo_on(c->squares[y][x].info, SQUARE_SEEN);
+		}
 	}
 }
 
@@ -582,20 +812,18 @@ static void become_viewable(struct chunk *c, int y, int x, int lit, int py, int
 }
 
 /**
- * Decide whether to include a square in the current view
+ * Decide whether to include a square, at distance d from the player, in the
+ * current view
  */
-static void update_view_one(struct chunk *c, int y, int x, int radius, int py, int px)
+static void update_view_one(struct chunk *c, int y, int x, int d, int radius,
+							int py, int px)
 {
 	int dir;
 	int xc = x;
 	int yc = y;
 
-	int d = distance(y, x, py, px);
 	int lit = d < radius;
 
-	if (d > z_info->max_sight)
-		return;
-
 	/* Light squares with adjacent bright terrain */
 	for (dir = 0; dir < 8; dir++) {
 		if (!square_in_bounds(c, y + ddy_ddd[dir], x + ddx_ddd[dir]))
@@ -660,11 +888,14 @@ static void update_view_one(struct chunk *c, int y, int x, int radius, int py, i
  */
 void update_view(struct chunk *c, struct player *p)
 {
-	int x, y;
+	int x, y, d, i;
+	const struct loc *grids;
 
 	int radius;
+	bool blind = p->timed[TMD_BLIND] ? TRUE : FALSE;
 
-	mark_wasseen(c);
+	struct loc old_min = c->view_min, old_max = c->view_max;
+	struct loc new_min, new_max;
 
 	/* Extract "radius" value */
 	radius = p->state.cur_light;
@@ -672,22 +903,51 @@ void update_view(struct chunk *c, struct player *p)
 	/* Handle real light */
 	if (radius > 0) ++radius;
 
-	add_monster_lights(c, loc(p->px, p->py));
+	/* Nothing has changed since last time, so the old view still holds */
+	if (!c->view_changed && (c->view_grid.y == p->py) &&
+		(c->view_grid.x == p->px) && (c->view_radius == radius) &&
+		(c->view_blind == blind))
+		return;
+
+	/* Only grids within sight of the player can be viewed */
+	new_min = loc(MAX(p->px - z_info->max_sight, 0),
+				  MAX(p->py - z_info->max_sight, 0));
+	new_max = loc(MIN(p->px + z_info->max_sight, c->width - 1),
+				  MIN(p->py + z_info->max_sight, c->height - 1));
+
+	mark_wasseen(c);
+
+	add_monster_lights(c, loc(p->px, p->py), new_min, new_max);
 
 	/* Assume we can view the player grid */
 	sqinfo_on(c->squares[p->py][p->px].info, SQUARE_VIEW);
 	if (radius > 0 || square_isglow(c, p->py, p->px))
 		sqinfo_on(c->squares[p->py][p->px].info, SQUARE_SEEN);
 
-	/* View squares we have LOS to */
-	for (y = 0; y < c->height; y++)
-		for (x = 0; x < c->width; x++)
-			update_view_one(c, y, x, radius, p->py, p->px);
+	/* View squares we have LOS to, going out one distance at a time */
+	for (d = 0, i = 0; d <= z_info->max_sight; d++) {
+		int n = distance_offsets(d, &grids);
+		for (; i < n; i++) {
+			y = p->py + grids[i].y;
+			x = p->px + grids[i].x;
+			if (!square_in_bounds(c, y, x)) continue;
+			update_view_one(c, y, x, d, radius, p->py, p->px);
+		}
+	}
 
-	/* Complete the algorithm */
-	for (y = 0; y < c->height; y++)
-		for (x = 0; x < c->width; x++)
-			update_one(c, y, x, p->timed[TMD_BLIND]);
+	/* Remember what the view is, and where it was taken from */
+	c->view_min = new_min;
+	c->view_max = new_max;
+	c->view_grid = loc(p->px, p->py);
+	c->view_radius = radius;
+	c->view_blind = blind;
+	c->view_changed = FALSE;
+	cave_fields_view_changed(c);
+
+	/* Complete the algorithm over both the old and the new view */
+	for (y = MIN(old_min.y, new_min.y); y <= MAX(old_max.y, new_max.y); y++)
+		for (x = MIN(old_min.x, new_min.x); x <= MAX(old_max.x, new_max.x); x++)
+			update_one(c, y, x, blind);
 }
 
 
@@ -24,6 +24,7 @@
 #include "game-world.h"
 #include "init.h"
 #include "monster.h"
+#include "mon-move.h"
 #include "obj-ignore.h"
 #include "obj-pile.h"
 #include "obj-tval.h"
@@ -35,6 +36,8 @@
 struct feature *f_info;
 struct chunk *cave = NULL;
 struct chunk *cave_k = NULL;
+u32b cave_terrain_stamp = 0;
+u32b cave_occupant_stamp = 0;
 
 /**
  * Global array for looping through the "keypad directions".
@@ -112,29 +115,108 @@ void set_terrain(void)
 	FEAT_DTRAP_WALL = lookup_feat("dtrap edge - wall");
 }
 
+/**
+ * Allocate a zeroed byte for each grid of a chunk, as one block in row order
+ * with row pointers into it
+ */
+static byte **cave_byte_grid_new(struct chunk *c)
+{
+	int y;
+	byte **grid = mem_zalloc(c->height * sizeof(byte*));
+
+	grid[0] = mem_zalloc(c->height * c->width * sizeof(byte));
+	for (y = 1; y < c->height; y++)
+		grid[y] = grid[0] + y * c->width;
+
+	return grid;
+}
+
+/**
+ * Free a byte grid made by cave_byte_grid_new()
+ */
+static void cave_byte_grid_free(byte **grid)
+{
+	if (!grid) return;
+	mem_free(grid[0]);
+	mem_free(grid);
+}
+
+/**
+ * Allocate a zeroed u16b for each grid of a chunk, like cave_byte_grid_new()
+ */
+static u16b **cave_u16b_grid_new(struct chunk *c)
+{
+	int y;
+	u16b **grid = mem_zalloc(c->height * sizeof(u16b*));
+
+	grid[0] = mem_zalloc(c->height * c->width * sizeof(u16b));
+	for (y = 1; y < c->height; y++)
+		grid[y] = grid[0] + y * c->width;
+
+	return grid;
+}
+
+/**
+ * Free a u16b grid made by cave_u16b_grid_new()
+ */
+static void cave_u16b_grid_free(u16b **grid)
+{
+	if (!grid) return;
+	mem_free(grid[0]);
+	mem_free(grid);
+}
+
 /**
  * Allocate a new chunk of the world
  */
 struct chunk *cave_new(int height, int width) {
-	int y, x;
+	int y, x, i;
 
 	struct chunk *c = mem_zalloc(sizeof *c);
 	c->height = height;
 	c->width = width;
 	c->feat_count = mem_zalloc((z_info->f_max + 1) * sizeof(int));
 
+	/* All the squares live in one block, with the rows pointing into it */
 	c->squares = mem_zalloc(c->height * sizeof(struct square*));
-	for (y = 0; y < c->height; y++) {
-		c->squares[y] = mem_zalloc(c->width * sizeof(struct square));
-		for (x = 0; x < c->width; x++)
-			c->squares[y][x].info = mem_zalloc(SQUARE_SIZE * sizeof(bitflag));
-	}
+	c->squares[0] = mem_zalloc(c->height * c->width * sizeof(struct square));
+	for (y = 1; y < c->height; y++)
+		c->squares[y] = c->squares[0] + y * c->width;
+
+	/* The per-grid byte arrays are laid out the same way */
+	c->cost = cave_u16b_grid_new(c);
+	c->when = cave_u16b_grid_new(c);
+	c->mon_light = cave_byte_grid_new(c);
+
+	c->plane_stride = (c->width + PLANE_WORD_BITS - 1) / PLANE_WORD_BITS;
+	for (i = 0; i < PLANE_MAX; i++)
+		c->planes[i] = mem_zalloc(c->height * c->plane_stride * sizeof(u32b));
+
+	/* The squares all start as feature 0, which normally has none of the
+	 * terrain planes' properties, leaving the cleared planes already right */
+	if (feat_is_projectable(0) || feat_is_passable(0) || feat_is_bright(0))
+		for (y = 0; y < c->height; y++)
+			for (x = 0; x < c->width; x++)
+				square_update_planes(c, y, x);
 
 	c->monsters = mem_zalloc(z_info->level_monster_max *sizeof(struct monster));
+	c->cells_wide = (c->width + CAVE_CELL - 1) / CAVE_CELL;
+	c->mon_cells = mem_zalloc(((c->height + CAVE_CELL - 1) / CAVE_CELL) *
+							  c->cells_wide * sizeof(s16b));
+	c->mon_cell_next = mem_zalloc(z_info->level_monster_max * sizeof(s16b));
+	c->obj_cells = mem_zalloc(((c->height + CAVE_CELL - 1) / CAVE_CELL) *
+							  c->cells_wide * sizeof(u16b));
 	c->mon_max = 1;
+	c->mon_hole = 1;
 	c->mon_current = -1;
 
+	/* Nothing is known about the view yet, so it may be anywhere */
+	c->view_min = loc(0, 0);
+	c->view_max = loc(c->width - 1, c->height - 1);
+	c->view_changed = TRUE;
+
 	c->created_at = turn;
+	cave_terrain_stamp++;
 	return c;
 }
 
@@ -142,28 +224,89 @@ struct chunk *cave_new(int height, int width) {
  * Free a chunk
  */
 void cave_free(struct chunk *c) {
-	int y, x;
+	int y, x, i;
+
+	cave_terrain_stamp++;
 
 	for (y = 0; y < c->height; y++) {
 		for (x = 0; x < c->width; x++) {
-			mem_free(c->squares[y][x].info);
 			if (c->squares[y][x].trap)
 				square_free_trap(c, y, x);
 			if (c->squares[y][x].obj)
 				object_pile_free(c->squares[y][x].obj);
 		}
-		mem_free(c->squares[y]);
 	}
+	mem_free(c->squares[0]);
 	mem_free(c->squares);
+	cave_u16b_grid_free(c->cost);
+	cave_u16b_grid_free(c->when);
+	cave_byte_grid_free(c->mon_light);
+
+	for (i = 0; i < PLANE_MAX; i++)
+		mem_free(c->planes[i]);
+	cave_fields_free(c);
+	monster_schedule_free(c);
 
 	mem_free(c->feat_count);
 	mem_free(c->monsters);
+	mem_free(c->mon_known);
+	mem_free(c->mon_cells);
+	mem_free(c->mon_cell_next);
+	mem_free(c->obj_cells);
+	mem_free(c->charging);
 	if (c->name)
 		string_free(c->name);
 	mem_free(c);
 }
 
 
+/**
+ * Free the parts of a chunk that only matter while it is being played: the
+ * flow and light grids, distance fields, and the monster list and indexes.
+ *
+ * This is for stored chunks with no monsters, which are only read by
+ * chunk_copy() and the savefile code; neither needs any of it.  The chunk
+ * can still be freed with cave_free().
+ */
+void cave_shrink(struct chunk *c)
+{
+	assert(cave_monster_max(c) <= 1);
+
+	cave_u16b_grid_free(c->cost);
+	cave_u16b_grid_free(c->when);
+	cave_byte_grid_free(c->mon_light);
+	c->cost = NULL;
+	c->when = NULL;
+	c->mon_light = NULL;
+
+	cave_fields_free(c);
+	monster_schedule_free(c);
+
+	mem_free(c->monsters);
+	mem_free(c->mon_known);
+	mem_free(c->mon_cells);
+	mem_free(c->mon_cell_next);
+	c->monsters = NULL;
+	c->mon_known = NULL;
+	c->mon_cells = NULL;
+	c->mon_cell_next = NULL;
+}
+
+/**
+ * Turn off a set of square info flags for every grid of a chunk.
+ *
+ * The squares are all in one block, so this is a single pass over it
+ * rather than a flag-by-flag walk of the rows.
+ */
+void cave_sqinfo_off(struct chunk *c, const bitflag *flags)
+{
+	struct square *sq = c->squares[0];
+	int i, n = c->height * c->width;
+
+	for (i = 0; i < n; i++)
+		sqinfo_diff(sq[i].info, flags);
+}
+
 /**
  * Standard "find me a location" function
  *
@@ -214,6 +357,37 @@ struct monster *cave_monster(struct chunk *c, int idx) {
 	return &c->monsters[idx];
 }
 
+/**
+ * Get what a monster on the level knows of the player, by its index.
+ *
+ * This is kept apart from the monster itself, since it is only wanted when
+ * the monster picks a spell, and is most of the monster's size.  The array
+ * is only made when something first asks for it; on levels where no monster
+ * learns anything, c->mon_known stays NULL and every monster knows nothing.
+ */
+struct player_state *cave_monster_known(struct chunk *c, int idx) {
+	if (idx <= 0) return NULL;
+	if (!c->mon_known)
+		c->mon_known = mem_zalloc(z_info->level_monster_max *
+								  sizeof(struct player_state));
+	return &c->mon_known[idx];
+}
+
+/**
+ * Give monster 'didx' of chunk 'dest' whatever monster 'sidx' of chunk 'src'
+ * knows of the player, or nothing if 'src' is NULL.
+ *
+ * Neither array is made just to hold nothing.
+ */
+void cave_monster_known_copy(struct chunk *dest, int didx,
+							 struct chunk *src, int sidx)
+{
+	if (src && src->mon_known)
+		*cave_monster_known(dest, didx) = src->mon_known[sidx];
+	else if (dest->mon_known)
+		memset(&dest->mon_known[didx], 0, sizeof(struct player_state));
+}
+
 /**
  * The maximum number of monsters allowed in the level.
  */
@@ -228,6 +402,208 @@ int cave_monster_count(struct chunk *c) {
 	return c->mon_cnt;
 }
 
+/**
+ * Add a monster to, or take it from, the cell of the chunk's monster index
+ * which holds a grid.
+ *
+ * Each cell keeps a list of the monsters in it, so that those near a point
+ * can be found without looking through the whole monster list.  Like
+ * cave_monster_light(), this must be called whenever a monster appears,
+ * moves or disappears, and also when it changes index.
+ */
+void cave_monster_cell(struct chunk *c, struct monster *m, int y, int x,
+					   bool add)
+{
+	s16b *link = &c->mon_cells[(y / CAVE_CELL) * c->cells_wide +
+							   x / CAVE_CELL];
+
+	if (add) {
+		c->mon_cell_next[m->midx] = *link;
+		*link = m->midx;
+		return;
+	}
+
+	/* Find the link to the monster and step over it */
+	while (*link && *link != m->midx)
+		link = &c->mon_cell_next[*link];
+	if (*link)
+		*link = c->mon_cell_next[m->midx];
+}
+
+/**
+ * Empty the monster index of a chunk
+ */
+void cave_monster_cells_wipe(struct chunk *c)
+{
+	int rows = (c->height + CAVE_CELL - 1) / CAVE_CELL;
+
+	memset(c->mon_cells, 0, rows * c->cells_wide * sizeof(s16b));
+}
+
+/**
+ * Count a grid's floor pile in, or out of, the chunk's object index.  This
+ * must be called whenever a grid's pile starts or stops being empty.
+ */
+void cave_object_cell(struct chunk *c, int y, int x, bool add)
+{
+	u16b *count = &c->obj_cells[(y / CAVE_CELL) * c->cells_wide +
+								x / CAVE_CELL];
+
+	if (add)
+		(*count)++;
+	else if (*count)
+		(*count)--;
+}
+
+/**
+ * Queue a grid whose floor pile holds a charging rod for recharge_objects(),
+ * which drops it again once nothing there is charging.  This must be called
+ * whenever a charging rod lands on the floor, or a rod on the floor is used.
+ */
+void cave_object_charging(struct chunk *c, int y, int x)
+{
+	int i;
+
+	for (i = 0; i < c->charging_num; i++)
+		if (c->charging[i].y == y && c->charging[i].x == x) return;
+
+	if (c->charging_num == c->charging_max) {
+		c->charging_max = c->charging_max ? 2 * c->charging_max : 8;
+		c->charging = mem_realloc(c->charging,
+								  c->charging_max * sizeof(struct loc));
+	}
+	c->charging[c->charging_num++] = loc(x, y);
+}
+
+/**
+ * Set a walk going at the first grid of its current cell which is in the area
+ */
+static void cell_iter_enter(struct cell_iter *it)
+{
+	it->next = it->c->mon_cells[it->cell.y * it->c->cells_wide + it->cell.x];
+	it->grid.y = MAX(it->cell.y * CAVE_CELL, it->min.y);
+	it->grid.x = MAX(it->cell.x * CAVE_CELL, it->min.x);
+}
+
+/**
+ * Move a walk on to its next cell, returning FALSE when there are no more
+ */
+static bool cell_iter_step(struct cell_iter *it)
+{
+	if (++it->cell.x > it->cell_max.x) {
+		it->cell.x = it->min.x / CAVE_CELL;
+		it->cell.y++;
+	}
+	if (it->cell.y > it->cell_max.y)
+		return FALSE;
+
+	cell_iter_enter(it);
+	return TRUE;
+}
+
+/**
+ * Is a grid in the area a walk covers?
+ */
+static bool cell_iter_covers(const struct cell_iter *it, int y, int x)
+{
+	if (y < it->min.y || y > it->max.y || x < it->min.x || x > it->max.x)
+		return FALSE;
+	if (it->radius >= 0 &&
+		distance(it->centre.y, it->centre.x, y, x) > it->radius)
+		return FALSE;
+	return TRUE;
+}
+
+/**
+ * Start a walk over the grids from (y1, x1) to (y2, x2) inclusive, cut down
+ * to the chunk
+ */
+void cell_iter_rect(struct cell_iter *it, struct chunk *c, int y1, int x1,
+					int y2, int x2)
+{
+	it->c = c;
+	it->min = loc(MAX(x1, 0), MAX(y1, 0));
+	it->max = loc(MIN(x2, c->width - 1), MIN(y2, c->height - 1));
+	it->radius = -1;
+	it->cell = loc(it->min.x / CAVE_CELL, it->min.y / CAVE_CELL);
+	it->cell_max = loc(it->max.x / CAVE_CELL, it->max.y / CAVE_CELL);
+
+	/* Nothing to walk */
+	if (it->min.x > it->max.x || it->min.y > it->max.y) {
+		it->cell.y = it->cell_max.y + 1;
+		return;
+	}
+
+	cell_iter_enter(it);
+}
+
+/**
+ * Start a walk over the grids within distance() r of (y, x)
+ */
+void cell_iter_radius(struct cell_iter *it, struct chunk *c, int y, int x,
+					  int r)
+{
+	cell_iter_rect(it, c, y - r, x - r, y + r, x + r);
+	it->centre = loc(x, y);
+	it->radius = r;
+}
+
+/**
+ * Get the next monster of a walk, or NULL at the end.  The monster returned
+ * may be deleted or moved before the next call.
+ */
+struct monster *cell_iter_next_monster(struct cell_iter *it)
+{
+	while (it->cell.y <= it->cell_max.y) {
+		while (it->next) {
+			struct monster *mon = cave_monster(it->c, it->next);
+			it->next = it->c->mon_cell_next[it->next];
+
+			if (cell_iter_covers(it, mon->fy, mon->fx))
+				return mon;
+		}
+
+		if (!cell_iter_step(it))
+			break;
+	}
+
+	return NULL;
+}
+
+/**
+ * Get the next grid of a walk with a floor pile, returning FALSE at the end
+ */
+bool cell_iter_next_object(struct cell_iter *it, int *y, int *x)
+{
+	while (it->cell.y <= it->cell_max.y) {
+		int cell = it->cell.y * it->c->cells_wide + it->cell.x;
+		int y_max = MIN(it->cell.y * CAVE_CELL + CAVE_CELL - 1, it->max.y);
+		int x_min = MAX(it->cell.x * CAVE_CELL, it->min.x);
+		int x_max = MIN(it->cell.x * CAVE_CELL + CAVE_CELL - 1, it->max.x);
+
+		while (it->c->obj_cells[cell] && it->grid.y <= y_max) {
+			struct loc grid = it->grid;
+
+			if (++it->grid.x > x_max) {
+				it->grid.x = x_min;
+				it->grid.y++;
+			}
+
+			if (it->c->squares[grid.y][grid.x].obj &&
+				cell_iter_covers(it, grid.y, grid.x)) {
+				*y = grid.y;
+				*x = grid.x;
+				return TRUE;
+			}
+		}
+
+		if (!cell_iter_step(it))
+			break;
+	}
+
+	return FALSE;
+}
+
 /**
  * Return the number of doors/traps around (or under) the character.
  */
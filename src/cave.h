@@ -24,6 +24,7 @@
 
 struct player;
 struct monster;
+struct monster_schedule;
 
 const s16b ddd[9];
 const s16b ddx[10];
@@ -79,6 +80,53 @@ enum
 
 #define tf_has(f, flag)        flag_has_dbg(f, TF_SIZE, flag, #f, #flag)
 
+/**
+ * Terrain properties which are also kept in each chunk as one bit per grid,
+ * so they can be tested without going through the feature table.
+ *
+ * Walls are exactly the grids which aren't projectable, and monsters can
+ * walk wherever the player can, so those need no planes of their own.
+ *
+ * The occupied plane, after the terrain ones, marks the grids holding a
+ * monster or the player; square_set_mon() keeps it in step.
+ */
+enum
+{
+	PLANE_PROJECT = 0,
+	PLANE_PASSABLE,
+	PLANE_BRIGHT,
+	PLANE_OCCUPIED,
+	PLANE_MAX
+};
+
+#define PLANE_WORD_BITS        32
+
+#define plane_word(c, plane, y, x) \
+	((c)->planes[plane][(y) * (c)->plane_stride + (x) / PLANE_WORD_BITS])
+#define plane_has(c, plane, y, x) \
+	((plane_word(c, plane, y, x) >> ((x) % PLANE_WORD_BITS)) & 1)
+
+/**
+ * Distance fields kept in each chunk alongside the player's flow.  Each one
+ * holds, for every grid, the number of steps to the nearest of its goal
+ * grids; they are made on demand by cave_field_dist().
+ */
+enum
+{
+	FIELD_STAIRS = 0,   /* Nearest staircase */
+	FIELD_SAFETY,       /* Nearest open grid out of the player's view */
+	FIELD_ROUTE,        /* Nearest grid near the player and in the flow */
+	FIELD_MAX
+};
+
+#define FIELD_UNREACHED        0xFFFF
+
+/**
+ * Side, in grids, of the square cells grouping monsters and objects in a
+ * chunk's indexes
+ */
+#define CAVE_CELL               16
+
 /**
  * Information about terrain features.
  *
@@ -134,9 +182,7 @@ typedef struct
 
 struct square {
 	byte feat;
-	bitflag *info;
-	byte cost;
-	byte when;
+	bitflag info[SQUARE_SIZE];
 	s16b mon;
 	struct object *obj;
 	struct trap *trap;
@@ -148,8 +194,8 @@ struct chunk {
 	int depth;
 
 	byte feeling;
-	u32b obj_rating;
-	u32b mon_rating;
+	u32b obj_rating;	/* Running total, added to as objects are placed */
+	u32b mon_rating;	/* Running total, added to as monsters are placed */
 	bool good_item;
 
 	int height;
@@ -158,15 +204,62 @@ struct chunk {
 	u16b feeling_squares; /* How many feeling squares the player has visited */
 	int *feat_count;
 
-	byte **feat;
-	s16b **m_idx;
-
 	struct square **squares;
 
+	/* Flow data, kept apart from the squares since it is scanned alone */
+	u16b **cost; /* Steps to reach the player */
+	u16b **when; /* Flow pass which last reached the grid */
+	u16b flow_stamp;        /* Stamp of the latest flow pass */
+	struct loc flow_source; /* Where the player was for that pass */
+	bool flow_dirty;        /* Has terrain closed since that pass? */
+
+	u16b *fields[FIELD_MAX];         /* Distance fields, or NULL until used */
+	bool field_stale[FIELD_MAX];     /* Does the field need to be redone? */
+	struct loc field_sector[FIELD_MAX]; /* Player's sector when it was made */
+	bool long_routes;  /* Do monsters use FIELD_ROUTE beyond the flow? */
+
+	byte **mon_light; /* How many light-carrying monsters light each grid */
+
+	int plane_stride;        /* Words per row in each of the planes */
+	u32b *planes[PLANE_MAX]; /* Terrain and occupancy, one bit per grid */
+
 	struct monster *monsters;
+	struct player_state *mon_known; /* What each monster knows of the player */
 	u16b mon_max;
 	u16b mon_cnt;
+	u16b mon_hole;       /* No dead monster has a lower index than this */
 	int mon_current;
+	struct monster_schedule *mon_sched; /* When monsters next move */
+	int cells_wide;      /* Columns of cells in the indexes */
+	s16b *mon_cells;     /* First monster in each cell, 0 for none */
+	s16b *mon_cell_next; /* Next monster in the same cell, by index */
+	u16b *obj_cells;     /* Grids with floor objects in each cell */
+	struct loc *charging; /* Grids whose floor piles may hold charging rods */
+	int charging_num;
+	int charging_max;
+
+	struct loc view_min; /* Top left of the grids update_view() last marked */
+	struct loc view_max; /* Bottom right of the grids update_view() marked */
+	struct loc view_grid; /* Grid the last view was taken from */
+	int view_radius;      /* Light radius the last view was taken with */
+	bool view_blind;      /* Was the viewer blind? */
+	bool view_changed;    /* Has anything affecting the view changed since? */
+};
+
+/**
+ * A walk over the monsters, or the grids with floor objects, in a rectangle
+ * or circle of a chunk, which uses its indexes to pass over empty cells
+ */
+struct cell_iter {
+	struct chunk *c;
+	struct loc min;      /* Top left grid of the area */
+	struct loc max;      /* Bottom right grid of the area */
+	struct loc centre;   /* Centre of a circle, if radius isn't -1 */
+	int radius;
+	struct loc cell;     /* Cell being walked */
+	struct loc cell_max; /* Last cell to walk */
+	int next;            /* Next monster of the cell to look at */
+	struct loc grid;     /* Next grid of the cell to look at */
 };
 
 /*** Feature Indexes (see "lib/edit/terrain.txt") ***/
@@ -209,13 +302,22 @@ int FEAT_DTRAP_WALL;
 struct chunk *cave;
 /* Known cave */
 struct chunk *cave_k;
+/* Bumped whenever terrain, or what occupies a square, changes */
+extern u32b cave_terrain_stamp;
+extern u32b cave_occupant_stamp;
 struct chunk **chunk_list;
 u16b chunk_list_max;
 
 /* cave-view.c */
 int distance(int y1, int x1, int y2, int x2);
+int distance_offsets(int d, const struct loc **offsets);
 bool los(struct chunk *c, int y1, int x1, int y2, int x2);
+bool square_sees_player(struct chunk *c, int y, int x);
+void cave_view_cleanup(void);
 void forget_view(struct chunk *c);
+void cave_note_view_change(struct chunk *c, int y, int x);
+void cave_monster_light(struct chunk *c, struct monster *m, int y, int x,
+						bool add);
 void update_view(struct chunk *c, struct player *p);
 bool no_light(void);
 
@@ -223,12 +325,20 @@ bool no_light(void);
 void map_info(unsigned x, unsigned y, grid_data *g);
 void square_note_spot(struct chunk *c, int y, int x);
 void square_light_spot(struct chunk *c, int y, int x);
+void map_batch_begin(void);
+void map_batch_end(void);
 void light_room(int y1, int x1, bool light);
 void wiz_light(struct chunk *c, bool full);
 void wiz_dark(void);
 void cave_illuminate(struct chunk *c, bool daytime);
 void cave_update_flow(struct chunk *c);
 void cave_forget_flow(struct chunk *c);
+void cave_flow_feat_changed(struct chunk *c, int y, int x);
+int cave_field_dist(struct chunk *c, int field, int y, int x);
+int cave_distances(struct chunk *c, int plane, const struct loc *from,
+				   int num, u16b *dist, int *queue);
+void cave_fields_view_changed(struct chunk *c);
+void cave_fields_free(struct chunk *c);
 
 /* cave-square.c */
 /**
@@ -246,7 +356,7 @@ bool feat_is_monster_walkable(int feat);
 bool feat_is_shop(int feat);
 bool feat_is_passable(int feat);
 bool feat_is_projectable(int feat);
-bool feat_isbright(feature_type *f_ptr);
+bool feat_is_bright(int feat);
 
 /* SQUARE FEATURE PREDICATES */
 bool square_isfloor(struct chunk *c, int y, int x);
@@ -292,6 +402,8 @@ bool square_isno_esp(struct chunk *c, int y, int x);
 bool square_isproject(struct chunk *c, int y, int x);
 
 /* SQUARE BEHAVIOR PREDICATES */
+bool square_isoccupied(struct chunk *c, int y, int x);
+int square_num_occupied(struct chunk *c, int y1, int x1, int y2, int x2);
 bool square_isopen(struct chunk *c, int y, int x);
 bool square_isempty(struct chunk *c, int y, int x);
 bool square_canputitem(struct chunk *c, int y, int x);
@@ -323,6 +435,9 @@ void square_excise_object(struct chunk *c, int y, int x, struct object *obj);
 void square_excise_pile(struct chunk *c, int y, int x);
 
 void square_set_feat(struct chunk *c, int y, int x, int feat);
+void square_update_planes(struct chunk *c, int y, int x);
+void cave_update_planes(struct chunk *c);
+void square_set_mon(struct chunk *c, int y, int x, int m_idx);
 
 /* Feature placers */
 void square_add_trap(struct chunk *c, int y, int x);
@@ -357,11 +472,27 @@ const char *square_apparent_name(struct chunk *c, struct player *p, int y, int x
 void set_terrain(void);
 struct chunk *cave_new(int height, int width);
 void cave_free(struct chunk *c);
+void cave_shrink(struct chunk *c);
+void cave_sqinfo_off(struct chunk *c, const bitflag *flags);
 void scatter(struct chunk *c, int *yp, int *xp, int y, int x, int d, bool need_los);
 
 struct monster *cave_monster(struct chunk *c, int idx);
+struct player_state *cave_monster_known(struct chunk *c, int idx);
+void cave_monster_known_copy(struct chunk *dest, int didx,
+							 struct chunk *src, int sidx);
 int cave_monster_max(struct chunk *c);
 int cave_monster_count(struct chunk *c);
+void cave_monster_cell(struct chunk *c, struct monster *m, int y, int x,
+					   bool add);
+void cave_monster_cells_wipe(struct chunk *c);
+void cave_object_cell(struct chunk *c, int y, int x, bool add);
+void cave_object_charging(struct chunk *c, int y, int x);
+void cell_iter_rect(struct cell_iter *it, struct chunk *c, int y1, int x1,
+					int y2, int x2);
+void cell_iter_radius(struct cell_iter *it, struct chunk *c, int y, int x,
+					  int r);
+struct monster *cell_iter_next_monster(struct cell_iter *it);
+bool cell_iter_next_object(struct cell_iter *it, int *y, int *x);
 
 int count_feats(int *y, int *x, bool (*test)(struct chunk *cave, int y, int x), bool under);
 
@@ -20,6 +20,7 @@
 #include "angband.h"
 #include "cmds.h"
 #include "cmd-core.h"
+#include "cmd-record.h"
 #include "game-input.h"
 #include "obj-chest.h"
 #include "obj-desc.h"
@@ -223,6 +224,9 @@ void process_command(cmd_context ctx, struct command *cmd)
 	if (game_cmds[idx].fn)
 		game_cmds[idx].fn(cmd);
 
+	/* Anything the command did may have changed how objects read */
+	object_desc_invalidate();
+
 	/* If the command hasn't changed nrepeats, count this execution. */
 	if (cmd->nrepeats > 0 && oldrepeats == cmd_get_nrepeats())
 		cmd_set_repeat(oldrepeats - 1);
@@ -238,21 +242,40 @@ bool cmdq_pop(cmd_context c)
 	/* If we're repeating, just pull the last command again. */
 	if (repeating) {
 		cmd = &cmd_queue[prev_cmd_idx(cmd_tail)];
-	} else if (cmd_head != cmd_tail) {
-		/* If we have a command ready, set it. */
-		cmd = &cmd_queue[cmd_tail++];
-		if (cmd_tail == CMD_QUEUE_SIZE)
-			cmd_tail = 0;
 	} else {
-		/* Failure to get a command. */
-		return FALSE;
+		/* A replay puts back whatever was found here last time */
+		if (cmd_replay_active() && !cmd_replay_next(c))
+			return FALSE;
+
+		if (cmd_head != cmd_tail) {
+			/* If we have a command ready, set it. */
+			cmd = &cmd_queue[cmd_tail++];
+			if (cmd_tail == CMD_QUEUE_SIZE)
+				cmd_tail = 0;
+		} else {
+			/* Failure to get a command. */
+			cmd_record_pop(c, NULL);
+			return FALSE;
+		}
+
+		cmd_record_pop(c, cmd);
 	}
 
 	/* Now process it */
+	cmd_record_enter();
 	process_command(c, cmd);
+	cmd_record_leave();
 	return TRUE;
 }
 
+/**
+ * Throw away any commands still waiting in the queue
+ */
+void cmdq_flush(void)
+{
+	cmd_tail = cmd_head;
+}
+
 /**
  * Inserts a command in the queue to be carried out, with the given
  * number of repeats.
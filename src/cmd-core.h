@@ -241,6 +241,11 @@ struct command *cmdq_peek(void);
 
 /**
  * A function called by the game to get a command from the UI.
+ *
+ * Anything that drives the game without keypresses (see cmd-record.c) can
+ * put its own function here, and give the game commands by pushing them
+ * from it with cmdq_push() and the cmd_set_arg_*() calls.  It is called,
+ * like everything else, on the thread running the game.
  */
 extern errr (*cmd_get_hook)(cmd_context c);
 
@@ -262,6 +267,11 @@ errr cmdq_push(cmd_code c);
  */
 void cmdq_execute(cmd_context ctx);
 
+/**
+ * Empty the queue without executing anything.
+ */
+void cmdq_flush(void);
+
 /**
  * ------------------------------------------------------------------------
  * Command repeat manipulation
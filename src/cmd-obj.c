@@ -654,6 +654,10 @@ static void use_aux(struct command *cmd, struct object *obj, enum use use,
 			floor_item_charges(obj);
 	} else if (used && use == USE_TIMEOUT) {
 		obj->timeout += randcalc(obj->time, 0, RANDOMISE);
+
+		/* Rods on the floor charge from the chunk's queue */
+		if (tval_can_have_timeout(obj) && !object_is_carried(player, obj))
+			cave_object_charging(cave, obj->iy, obj->ix);
 	} else if (used && use == USE_SINGLE) {
 		struct object *used_obj;
 
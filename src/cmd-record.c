@@ -0,0 +1,960 @@
+/**
+ * \file cmd-record.c
+ * \brief Record the commands of a session, and replay them
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "buildid.h"
+#include "cave.h"
+#include "cmd-core.h"
+#include "cmd-record.h"
+#include "game-input.h"
+#include "game-world.h"
+#include "message.h"
+#include "monster.h"
+#include "player.h"
+#include "player-util.h"
+#include "store.h"
+#include "target.h"
+
+/**
+ * A record starts from a copy of the savefile, which holds the whole game
+ * including the RNG state, and then lists everything the UI told the game,
+ * one line each, in the order the game asked:
+ *
+ *   pop <context> <turn> <hash> -
+ *   pop <context> <turn> <hash> <code> <repeats> [<arg> <type> <value>]...
+ *       The game went to the command queue, and found nothing there or
+ *       the given command.  <hash> sums up the game state at that point,
+ *       so that a replay can tell where it first goes astray.
+ *   in <kind> <answer>...
+ *       A game-input hook (see game-input.c) was answered, such as a
+ *       direction, an item or a yes/no question.
+ *   int
+ *       The player interrupted a repeated command, a run or a rest.
+ *
+ * Items are noted by where they are (gear, the floor under the player, or a
+ * store) and targets by monster index or grid, so that they can be found
+ * again.  Everything the UI does between commands is left out, and whatever
+ * the game pushes on the queue itself gets pushed again by the replay, so
+ * the replay starts each command in the same state the original did.
+ */
+#define CMD_RECORD_MAGIC "angband-record"
+#define CMD_RECORD_VERSION 1
+
+/**
+ * Where to record, if anywhere
+ */
+static char record_path[1024];
+static ang_file *record_file;
+
+/**
+ * The record being replayed, with its current line
+ */
+static ang_file *replay_file;
+static char replay_line[1024];
+static char *replay_pos;
+static bool replay_loaded;
+static bool replay_done;
+static struct replay_result replay_result;
+
+/**
+ * How deeply commands are nested, and the depth at which the UI last took
+ * over (as for a store), so that prompts it answers for itself aren't taken
+ * to be for the game
+ */
+static int exec_depth;
+static int ui_depth = -1;
+
+/**
+ * The UI's own hooks, which the recording hooks ask
+ */
+static errr (*ui_get_cmd)(cmd_context c);
+static bool (*ui_get_string)(const char *prompt, char *buf, size_t len);
+static int (*ui_get_quantity)(const char *prompt, int max);
+static bool (*ui_get_check)(const char *prompt);
+static bool (*ui_get_com)(const char *prompt, char *command);
+static bool (*ui_get_rep_dir)(int *dir, bool allow_none);
+static bool (*ui_get_aim_dir)(int *dir);
+static int (*ui_get_spell_from_book)(const char *verb, struct object *book,
+									 const char *error,
+									 bool (*spell_filter)(int spell));
+static int (*ui_get_spell)(const char *verb, item_tester book_filter,
+						   cmd_code cmd, const char *error,
+						   bool (*spell_filter)(int spell));
+static bool (*ui_get_item)(struct object **choice, const char *pmt,
+						   const char *str, cmd_code cmd, item_tester tester,
+						   int mode);
+
+/**
+ * ------------------------------------------------------------------------
+ * Game state
+ * ------------------------------------------------------------------------ */
+
+static u32b record_hash_u32b(u32b h, u32b value)
+{
+	int i;
+
+	/* FNV-1a, a byte at a time */
+	for (i = 0; i < 4; i++) {
+		h ^= (value >> (i * 8)) & 0xFF;
+		h *= 16777619UL;
+	}
+
+	return h;
+}
+
+/**
+ * Sum up the RNG and the most telling parts of the player and level
+ */
+static u32b record_state_hash(void)
+{
+	u32b h = 2166136261UL;
+	int i;
+
+	h = record_hash_u32b(h, Rand_value);
+	h = record_hash_u32b(h, state_i);
+	h = record_hash_u32b(h, z0);
+	h = record_hash_u32b(h, z1);
+	h = record_hash_u32b(h, z2);
+	for (i = 0; i < RAND_DEG; i++)
+		h = record_hash_u32b(h, STATE[i]);
+
+	h = record_hash_u32b(h, turn);
+	h = record_hash_u32b(h, player->depth);
+	h = record_hash_u32b(h, player->py);
+	h = record_hash_u32b(h, player->px);
+	h = record_hash_u32b(h, player->chp);
+	h = record_hash_u32b(h, player->csp);
+	h = record_hash_u32b(h, player->energy);
+	h = record_hash_u32b(h, player->au);
+	h = record_hash_u32b(h, player->exp);
+	if (cave)
+		h = record_hash_u32b(h, cave_monster_count(cave));
+
+	return h;
+}
+
+/**
+ * Note where an object is
+ */
+static void record_obj(char *buf, size_t len, const struct object *obj)
+{
+	struct object *o;
+	int i, s;
+
+	my_strcpy(buf, "-", len);
+	if (!obj) return;
+
+	for (o = player->gear, i = 0; o; o = o->next, i++) {
+		if (o == obj) {
+			strnfmt(buf, len, "g%d", i);
+			return;
+		}
+	}
+
+	o = square_object(cave, player->py, player->px);
+	for (i = 0; o; o = o->next, i++) {
+		if (o == obj) {
+			strnfmt(buf, len, "f%d", i);
+			return;
+		}
+	}
+
+	for (s = 0; stores && s < MAX_STORES; s++) {
+		for (o = stores[s].stock, i = 0; o; o = o->next, i++) {
+			if (o == obj) {
+				strnfmt(buf, len, "s%d.%d", s, i);
+				return;
+			}
+		}
+	}
+
+	my_strcpy(buf, "?", len);
+}
+
+/**
+ * Find an object noted by record_obj()
+ */
+static struct object *replay_obj(const char *where)
+{
+	struct object *o = NULL;
+	int i, s;
+
+	switch (where[0]) {
+		case 'g': o = player->gear; break;
+		case 'f': o = square_object(cave, player->py, player->px); break;
+		case 's': {
+			if (sscanf(where + 1, "%d.%d", &s, &i) != 2 || s < 0 ||
+				s >= MAX_STORES)
+				return NULL;
+			for (o = stores[s].stock; o && i; o = o->next, i--) ;
+			return o;
+		}
+		default: return NULL;
+	}
+
+	for (i = atoi(where + 1); o && i; o = o->next, i--) ;
+	return o;
+}
+
+/**
+ * Note the current target
+ */
+static void record_target(char *buf, size_t len)
+{
+	struct monster *mon = target_get_monster();
+	int x, y;
+
+	if (!target_is_set()) {
+		my_strcpy(buf, "-", len);
+	} else if (mon) {
+		strnfmt(buf, len, "m%d", mon->midx);
+	} else {
+		target_get(&x, &y);
+		strnfmt(buf, len, "g%d,%d", y, x);
+	}
+}
+
+/**
+ * Set the target noted by record_target()
+ */
+static void replay_target(const char *where)
+{
+	int x, y, i;
+
+	if (where[0] == 'm' && (i = atoi(where + 1)) > 0 &&
+		i < cave_monster_max(cave))
+		target_set_monster(cave_monster(cave, i));
+	else if (where[0] == 'g' && sscanf(where + 1, "%d,%d", &y, &x) == 2)
+		target_set_location(y, x);
+	else
+		target_set_monster(NULL);
+}
+
+/**
+ * ------------------------------------------------------------------------
+ * Recording
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Whether the game, rather than the UI, is asking for input
+ */
+static bool record_for_game(void)
+{
+	return record_file && exec_depth > ui_depth;
+}
+
+static void record_put(const char *fmt, ...)
+{
+	va_list vp;
+
+	va_start(vp, fmt);
+	file_vputf(record_file, fmt, vp);
+	va_end(vp);
+}
+
+static errr record_get_cmd(cmd_context c)
+{
+	int depth = cmd_record_ui_enter();
+	errr err = ui_get_cmd(c);
+
+	cmd_record_ui_leave(depth);
+	return err;
+}
+
+static bool record_get_string(const char *prompt, char *buf, size_t len)
+{
+	bool ok = ui_get_string(prompt, buf, len);
+
+	if (record_for_game())
+		record_put("in s %d %d:%s\n", ok, (int)strlen(buf), buf);
+	return ok;
+}
+
+static int record_get_quantity(const char *prompt, int max)
+{
+	int amt = ui_get_quantity(prompt, max);
+
+	if (record_for_game())
+		record_put("in q %d\n", amt);
+	return amt;
+}
+
+static bool record_get_check(const char *prompt)
+{
+	bool ok = ui_get_check(prompt);
+
+	if (record_for_game())
+		record_put("in y %d\n", ok);
+	return ok;
+}
+
+static bool record_get_com(const char *prompt, char *command)
+{
+	bool ok = ui_get_com(prompt, command);
+
+	if (record_for_game())
+		record_put("in k %d %d\n", ok, (int)(unsigned char)*command);
+	return ok;
+}
+
+static bool record_get_rep_dir(int *dir, bool allow_none)
+{
+	bool ok = ui_get_rep_dir(dir, allow_none);
+
+	if (record_for_game())
+		record_put("in r %d %d\n", ok, *dir);
+	return ok;
+}
+
+static bool record_get_aim_dir(int *dir)
+{
+	bool ok = ui_get_aim_dir(dir);
+	char where[40];
+
+	if (record_for_game()) {
+		record_target(where, sizeof(where));
+		record_put("in a %d %d %s\n", ok, *dir, where);
+	}
+	return ok;
+}
+
+static int record_get_spell_from_book(const char *verb, struct object *book,
+									  const char *error,
+									  bool (*spell_filter)(int spell))
+{
+	int spell = ui_get_spell_from_book(verb, book, error, spell_filter);
+
+	if (record_for_game())
+		record_put("in b %d\n", spell);
+	return spell;
+}
+
+static int record_get_spell(const char *verb, item_tester book_filter,
+							cmd_code cmd, const char *error,
+							bool (*spell_filter)(int spell))
+{
+	int spell = ui_get_spell(verb, book_filter, cmd, error, spell_filter);
+
+	if (record_for_game())
+		record_put("in p %d\n", spell);
+	return spell;
+}
+
+static bool record_get_item(struct object **choice, const char *pmt,
+							const char *str, cmd_code cmd, item_tester tester,
+							int mode)
+{
+	bool ok = ui_get_item(choice, pmt, str, cmd, tester, mode);
+	char where[40];
+
+	if (record_for_game()) {
+		record_obj(where, sizeof(where), ok ? *choice : NULL);
+		record_put("in i %d %s\n", ok, where);
+	}
+	return ok;
+}
+
+/**
+ * Ask for the session to be recorded to 'path', once the game starts
+ */
+void cmd_record_set_file(const char *path)
+{
+	my_strcpy(record_path, path, sizeof(record_path));
+}
+
+/**
+ * Whether the session should be recorded
+ */
+bool cmd_record_wanted(void)
+{
+	return record_path[0] != '\0';
+}
+
+/**
+ * Start recording from the savefile 'save', which must be the one just
+ * loaded; the record goes in the file given to cmd_record_set_file(), with
+ * a copy of the savefile next to it.
+ */
+bool cmd_record_start(const char *save)
+{
+	char snapshot[1024];
+	char buf[4096];
+	ang_file *from, *to;
+	int n;
+	bool ok = TRUE;
+
+	if (!cmd_record_wanted() || record_file) return FALSE;
+
+	/* Keep the savefile as it is now, as later saves will change it */
+	strnfmt(snapshot, sizeof(snapshot), "%s.sav", record_path);
+	if (file_exists(snapshot))
+		file_delete(snapshot);
+	from = file_open(save, MODE_READ, FTYPE_RAW);
+	if (!from) return FALSE;
+	to = file_open(snapshot, MODE_WRITE, FTYPE_SAVE);
+	if (!to) {
+		file_close(from);
+		return FALSE;
+	}
+	while (ok && (n = file_read(from, buf, sizeof(buf))) > 0)
+		ok = file_write(to, buf, n);
+	file_close(from);
+	if (!file_close(to) || !ok) return FALSE;
+
+	record_file = file_open(record_path, MODE_WRITE, FTYPE_TEXT);
+	if (!record_file) return FALSE;
+	record_put("%s %d %s\n", CMD_RECORD_MAGIC, CMD_RECORD_VERSION, buildid);
+
+	exec_depth = 0;
+	ui_depth = -1;
+
+	/* Listen in on the UI */
+	ui_get_cmd = cmd_get_hook;
+	ui_get_string = get_string_hook;
+	ui_get_quantity = get_quantity_hook;
+	ui_get_check = get_check_hook;
+	ui_get_com = get_com_hook;
+	ui_get_rep_dir = get_rep_dir_hook;
+	ui_get_aim_dir = get_aim_dir_hook;
+	ui_get_spell_from_book = get_spell_from_book_hook;
+	ui_get_spell = get_spell_hook;
+	ui_get_item = get_item_hook;
+
+	cmd_get_hook = record_get_cmd;
+	get_string_hook = record_get_string;
+	get_quantity_hook = record_get_quantity;
+	get_check_hook = record_get_check;
+	get_com_hook = record_get_com;
+	get_rep_dir_hook = record_get_rep_dir;
+	get_aim_dir_hook = record_get_aim_dir;
+	get_spell_from_book_hook = record_get_spell_from_book;
+	get_spell_hook = record_get_spell;
+	get_item_hook = record_get_item;
+
+	return TRUE;
+}
+
+/**
+ * Finish the record, and give the UI its hooks back
+ */
+void cmd_record_stop(void)
+{
+	if (!record_file) return;
+
+	file_close(record_file);
+	record_file = NULL;
+
+	cmd_get_hook = ui_get_cmd;
+	get_string_hook = ui_get_string;
+	get_quantity_hook = ui_get_quantity;
+	get_check_hook = ui_get_check;
+	get_com_hook = ui_get_com;
+	get_rep_dir_hook = ui_get_rep_dir;
+	get_aim_dir_hook = ui_get_aim_dir;
+	get_spell_from_book_hook = ui_get_spell_from_book;
+	get_spell_hook = ui_get_spell;
+	get_item_hook = ui_get_item;
+}
+
+/**
+ * Note a trip to the command queue, which found 'cmd' (or nothing)
+ */
+void cmd_record_pop(cmd_context ctx, struct command *cmd)
+{
+	char where[40];
+	int i;
+
+	if (!record_file) return;
+
+	record_put("pop %d %ld %08lx", (int)ctx, (long)turn,
+			   (unsigned long)record_state_hash());
+	if (!cmd) {
+		record_put(" -\n");
+		return;
+	}
+
+	record_put(" %d %d", (int)cmd->code, cmd->nrepeats);
+	for (i = 0; i < CMD_MAX_ARGS; i++) {
+		struct cmd_arg *arg = &cmd->arg[i];
+
+		if (!arg->name[0]) continue;
+
+		switch (arg->type) {
+			case arg_STRING:
+				record_put(" %s s %d:%s", arg->name,
+						   (int)strlen(arg->data.string), arg->data.string);
+				break;
+			case arg_CHOICE:
+				record_put(" %s c %d", arg->name, arg->data.choice);
+				break;
+			case arg_ITEM:
+				record_obj(where, sizeof(where), arg->data.obj);
+				record_put(" %s i %s", arg->name, where);
+				break;
+			case arg_NUMBER:
+				record_put(" %s n %d", arg->name, arg->data.number);
+				break;
+			case arg_DIRECTION:
+				record_put(" %s d %d", arg->name, arg->data.direction);
+				break;
+			case arg_TARGET:
+				record_target(where, sizeof(where));
+				record_put(" %s t %d %s", arg->name, arg->data.direction,
+						   where);
+				break;
+			case arg_POINT:
+				record_put(" %s p %d,%d", arg->name, arg->data.point.x,
+						   arg->data.point.y);
+				break;
+			default:
+				break;
+		}
+	}
+	record_put("\n");
+}
+
+/**
+ * Bracket the execution of a command
+ */
+void cmd_record_enter(void)
+{
+	exec_depth++;
+}
+
+void cmd_record_leave(void)
+{
+	exec_depth--;
+}
+
+/**
+ * The UI is taking over from here, until cmd_record_ui_leave() is given the
+ * returned value, so anything it asks for itself needn't be recorded
+ */
+int cmd_record_ui_enter(void)
+{
+	int depth = ui_depth;
+
+	ui_depth = exec_depth;
+	return depth;
+}
+
+void cmd_record_ui_leave(int depth)
+{
+	ui_depth = depth;
+}
+
+/**
+ * The player has just interrupted the game
+ */
+void cmd_record_interrupt(void)
+{
+	if (record_file)
+		record_put("int\n");
+}
+
+/**
+ * ------------------------------------------------------------------------
+ * Replaying
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Stop the replay, noting why it had to stop early
+ */
+static void replay_diverge(const char *reason)
+{
+	if (replay_done) return;
+
+	my_strcpy(replay_result.reason, reason, sizeof(replay_result.reason));
+	replay_done = TRUE;
+	player->upkeep->playing = FALSE;
+}
+
+/**
+ * Check whether the next record is of the given kind, reading it if need be
+ */
+static bool replay_peek(const char *kind)
+{
+	size_t len = strlen(kind);
+
+	if (replay_done) return FALSE;
+
+	if (!replay_loaded) {
+		if (!file_getl(replay_file, replay_line, sizeof(replay_line))) {
+			/* Everything matched to the end */
+			replay_done = TRUE;
+			player->upkeep->playing = FALSE;
+			return FALSE;
+		}
+		replay_loaded = TRUE;
+		replay_result.line++;
+	}
+
+	return !strncmp(replay_line, kind, len) &&
+		(replay_line[len] == ' ' || !replay_line[len]);
+}
+
+/**
+ * Use the record that replay_peek() found, leaving its fields to be read
+ */
+static void replay_take(void)
+{
+	replay_loaded = FALSE;
+	replay_pos = replay_line;
+	while (*replay_pos && *replay_pos != ' ') replay_pos++;
+}
+
+static bool replay_word(char *buf, size_t len)
+{
+	size_t n;
+
+	while (*replay_pos == ' ') replay_pos++;
+	n = strcspn(replay_pos, " ");
+	if (!n) return FALSE;
+
+	my_strcpy(buf, replay_pos, MIN(n + 1, len));
+	replay_pos += n;
+	return TRUE;
+}
+
+static int replay_int(void)
+{
+	char buf[24];
+
+	return replay_word(buf, sizeof(buf)) ? atoi(buf) : 0;
+}
+
+/**
+ * Read a string written as <length>:<text>, which may have spaces in it
+ */
+static void replay_string(char *buf, size_t len)
+{
+	char *end;
+	long n;
+
+	while (*replay_pos == ' ') replay_pos++;
+	n = strtol(replay_pos, &end, 10);
+	if (*end != ':' || n < 0 || (size_t)n > strlen(end + 1)) {
+		buf[0] = '\0';
+		return;
+	}
+
+	my_strcpy(buf, end + 1, MIN((size_t)n + 1, len));
+	replay_pos = end + 1 + n;
+}
+
+/**
+ * Take the next record, which should be an answer of the given kind
+ */
+static bool replay_input(const char *kind)
+{
+	char word[8];
+
+	if (!replay_peek("in")) {
+		replay_diverge(format("the game asked for input '%s'", kind));
+		return FALSE;
+	}
+	replay_take();
+	if (!replay_word(word, sizeof(word)) || !streq(word, kind)) {
+		replay_diverge(format("the game asked for input '%s'", kind));
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static bool replay_get_string(const char *prompt, char *buf, size_t len)
+{
+	bool ok;
+
+	if (!replay_input("s")) return FALSE;
+	ok = replay_int();
+	replay_string(buf, len);
+	return ok;
+}
+
+static int replay_get_quantity(const char *prompt, int max)
+{
+	return replay_input("q") ? replay_int() : 0;
+}
+
+static bool replay_get_check(const char *prompt)
+{
+	return replay_input("y") ? replay_int() : FALSE;
+}
+
+static bool replay_get_com(const char *prompt, char *command)
+{
+	bool ok;
+
+	if (!replay_input("k")) return FALSE;
+	ok = replay_int();
+	*command = (char)replay_int();
+	return ok;
+}
+
+static bool replay_get_rep_dir(int *dir, bool allow_none)
+{
+	bool ok;
+
+	if (!replay_input("r")) return FALSE;
+	ok = replay_int();
+	*dir = replay_int();
+	return ok;
+}
+
+static bool replay_get_aim_dir(int *dir)
+{
+	char where[40];
+	bool ok;
+
+	if (!replay_input("a")) return FALSE;
+	ok = replay_int();
+	*dir = replay_int();
+	if (replay_word(where, sizeof(where)) && ok && *dir == DIR_TARGET)
+		replay_target(where);
+	return ok;
+}
+
+static int replay_get_spell_from_book(const char *verb, struct object *book,
+									  const char *error,
+									  bool (*spell_filter)(int spell))
+{
+	return replay_input("b") ? replay_int() : -1;
+}
+
+static int replay_get_spell(const char *verb, item_tester book_filter,
+							cmd_code cmd, const char *error,
+							bool (*spell_filter)(int spell))
+{
+	return replay_input("p") ? replay_int() : -1;
+}
+
+static bool replay_get_item(struct object **choice, const char *pmt,
+							const char *str, cmd_code cmd, item_tester tester,
+							int mode)
+{
+	char where[40];
+	bool ok;
+
+	if (!replay_input("i")) return FALSE;
+	ok = replay_int();
+	if (!ok) return FALSE;
+
+	if (!replay_word(where, sizeof(where)) || !replay_obj(where)) {
+		replay_diverge("the item chosen isn't there");
+		return FALSE;
+	}
+	*choice = replay_obj(where);
+	return TRUE;
+}
+
+static void replay_get_panel(int *min_y, int *min_x, int *max_y, int *max_x)
+{
+	*min_y = 0;
+	*min_x = 0;
+	*max_y = cave->height;
+	*max_x = cave->width;
+}
+
+static bool replay_panel_contains(unsigned int y, unsigned int x)
+{
+	return TRUE;
+}
+
+/**
+ * The map is in view while the game runs, except under a store's screen
+ */
+static bool replay_map_is_visible(void)
+{
+	return exec_depth > ui_depth;
+}
+
+/**
+ * Open the record at 'path' and take over the game-input hooks; 'save' is
+ * set to the savefile the game must then be loaded from.
+ */
+bool cmd_replay_start(const char *path, char *save, size_t len)
+{
+	char magic[40];
+	int version;
+
+	replay_file = file_open(path, MODE_READ, FTYPE_TEXT);
+	if (!replay_file) return FALSE;
+
+	if (!file_getl(replay_file, replay_line, sizeof(replay_line)) ||
+		sscanf(replay_line, "%39s %d", magic, &version) != 2 ||
+		!streq(magic, CMD_RECORD_MAGIC) || version != CMD_RECORD_VERSION) {
+		file_close(replay_file);
+		replay_file = NULL;
+		return FALSE;
+	}
+	strnfmt(save, len, "%s.sav", path);
+
+	memset(&replay_result, 0, sizeof(replay_result));
+	replay_result.line = 1;
+	replay_loaded = FALSE;
+	replay_done = FALSE;
+	exec_depth = 0;
+	ui_depth = -1;
+
+	get_string_hook = replay_get_string;
+	get_quantity_hook = replay_get_quantity;
+	get_check_hook = replay_get_check;
+	get_com_hook = replay_get_com;
+	get_rep_dir_hook = replay_get_rep_dir;
+	get_aim_dir_hook = replay_get_aim_dir;
+	get_spell_from_book_hook = replay_get_spell_from_book;
+	get_spell_hook = replay_get_spell;
+	get_item_hook = replay_get_item;
+	get_panel_hook = replay_get_panel;
+	panel_contains_hook = replay_panel_contains;
+	map_is_visible_hook = replay_map_is_visible;
+
+	return TRUE;
+}
+
+/**
+ * Close the record, saying how far the replay got
+ */
+void cmd_replay_finish(struct replay_result *result)
+{
+	if (!replay_file) return;
+
+	/* Anything left over means the game stopped early */
+	if (!replay_done) {
+		replay_peek("");
+		replay_diverge("the game ended before the record did");
+	}
+
+	*result = replay_result;
+	if (!result->reason[0])
+		result->line = 0;
+
+	file_close(replay_file);
+	replay_file = NULL;
+}
+
+bool cmd_replay_active(void)
+{
+	return replay_file != NULL;
+}
+
+/**
+ * Put the next recorded command for context 'ctx' on the queue, in place of
+ * anything the game has queued itself.  Returns FALSE if the game found no
+ * command here, or the replay is over.
+ */
+bool cmd_replay_next(cmd_context ctx)
+{
+	struct command cmd = { 0 };
+	char name[20], type[4], where[40], buf[1024];
+	long rec_turn;
+	unsigned long hash;
+	int x, y;
+
+	cmdq_flush();
+
+	if (!replay_peek("pop")) {
+		if (!replay_done)
+			replay_diverge("the game wanted a command");
+		return FALSE;
+	}
+	replay_take();
+
+	if (replay_int() != (int)ctx) {
+		replay_diverge("the game wanted a command somewhere else");
+		return FALSE;
+	}
+	rec_turn = strtol(replay_pos, &replay_pos, 10);
+	hash = strtoul(replay_pos, &replay_pos, 16);
+	if (rec_turn != (long)turn) {
+		replay_diverge(format("the command is at turn %ld, not %ld",
+							  (long)turn, rec_turn));
+		return FALSE;
+	}
+	if (hash != (unsigned long)record_state_hash()) {
+		replay_diverge("the game state differs");
+		return FALSE;
+	}
+
+	if (!replay_word(buf, sizeof(buf)) || streq(buf, "-"))
+		return FALSE;
+
+	cmd.code = atoi(buf);
+	cmd.nrepeats = replay_int();
+
+	while (replay_word(name, sizeof(name)) && replay_word(type, sizeof(type))) {
+		switch (type[0]) {
+			case 's':
+				replay_string(buf, sizeof(buf));
+				cmd_set_arg_string(&cmd, name, buf);
+				break;
+			case 'c':
+				cmd_set_arg_choice(&cmd, name, replay_int());
+				break;
+			case 'i':
+				replay_word(where, sizeof(where));
+				cmd_set_arg_item(&cmd, name, replay_obj(where));
+				break;
+			case 'n':
+				cmd_set_arg_number(&cmd, name, replay_int());
+				break;
+			case 'd':
+				cmd_set_arg_direction(&cmd, name, replay_int());
+				break;
+			case 't':
+				x = replay_int();
+				replay_word(where, sizeof(where));
+				if (x == DIR_TARGET)
+					replay_target(where);
+				cmd_set_arg_target(&cmd, name, x);
+				break;
+			case 'p':
+				replay_word(where, sizeof(where));
+				if (sscanf(where, "%d,%d", &x, &y) == 2)
+					cmd_set_arg_point(&cmd, name, x, y);
+				break;
+		}
+	}
+
+	cmdq_push_copy(&cmd);
+	replay_result.commands++;
+	return TRUE;
+}
+
+/**
+ * Whether the record has a command for 'ctx' next, as the store's screen
+ * does while the player shops
+ */
+bool cmd_replay_pending(cmd_context ctx)
+{
+	int c;
+
+	return replay_peek("pop") && sscanf(replay_line, "pop %d", &c) == 1 &&
+		c == (int)ctx;
+}
+
+/**
+ * Interrupt the game if the player did at this point
+ */
+void cmd_replay_interrupt(void)
+{
+	if (!replay_file || !replay_peek("int")) return;
+
+	replay_take();
+	disturb(player, 0);
+	msg("Cancelled.");
+}
@@ -0,0 +1,51 @@
+/**
+ * \file cmd-record.h
+ * \brief Record the commands of a session, and replay them
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef INCLUDED_CMD_RECORD_H
+#define INCLUDED_CMD_RECORD_H
+
+#include "cmd-core.h"
+
+/**
+ * How a replay went
+ */
+struct replay_result {
+	int commands;		/* Commands replayed */
+	int line;			/* Line of the record where it diverged, or 0 */
+	char reason[80];	/* What didn't match */
+};
+
+/* Recording */
+void cmd_record_set_file(const char *path);
+bool cmd_record_wanted(void);
+bool cmd_record_start(const char *save);
+void cmd_record_stop(void);
+void cmd_record_pop(cmd_context ctx, struct command *cmd);
+void cmd_record_enter(void);
+void cmd_record_leave(void);
+int cmd_record_ui_enter(void);
+void cmd_record_ui_leave(int depth);
+void cmd_record_interrupt(void);
+
+/* Replaying */
+bool cmd_replay_start(const char *path, char *save, size_t len);
+void cmd_replay_finish(struct replay_result *result);
+bool cmd_replay_active(void);
+bool cmd_replay_next(cmd_context ctx);
+bool cmd_replay_pending(cmd_context ctx);
+void cmd_replay_interrupt(void);
+
+#endif /* INCLUDED_CMD_RECORD_H */
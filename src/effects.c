@@ -26,6 +26,7 @@
 #include "mon-desc.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-spell.h"
 #include "mon-summon.h"
 #include "mon-util.h"
@@ -275,6 +276,7 @@ bool effect_handler_MON_HEAL_HP(effect_handler_context_t *context)
 	seen = (!player->timed[TMD_BLIND] && mflag_has(mon->mflag, MFLAG_VISIBLE));
 
 	/* Heal some */
+	monster_settle_regen(mon);
 	mon->hp += amount;
 
 	/* Fully healed */
@@ -641,6 +643,7 @@ bool effect_handler_DRAIN_MANA(effect_handler_context_t *context)
 	player->upkeep->redraw |= PR_MANA;
 
 	/* Heal the monster */
+	monster_settle_regen(mon);
 	if (mon->hp < mon->maxhp) {
 		mon->hp += (6 * drain);
 		if (mon->hp > mon->maxhp)
@@ -882,6 +885,8 @@ bool effect_handler_MAP_AREA(effect_handler_context_t *context)
 	if (y2 > cave->height - 1) y2 = cave->height - 1;
 	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
+	map_batch_begin();
+
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++) {
 		for (x = x1; x < x2; x++) {
@@ -907,12 +912,15 @@ bool effect_handler_MAP_AREA(effect_handler_context_t *context)
 					if (square_seemslikewall(cave, yy, xx)) {
 						sqinfo_on(cave->squares[yy][xx].info, SQUARE_MARK);
 						cave_k->squares[yy][xx].feat = cave->squares[yy][xx].feat;
+						square_update_planes(cave_k, yy, xx);
 						square_light_spot(cave, yy, xx);
 					}
 				}
 			}
 		}
 	}
+	map_batch_end();
+
 	/* Notice */
 	context->ident = TRUE;
 
@@ -946,6 +954,8 @@ bool effect_handler_DETECT_TRAPS(effect_handler_context_t *context)
 	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
 
+	map_batch_begin();
+
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++) {
 		for (x = x1; x < x2; x++) {
@@ -997,6 +1007,8 @@ bool effect_handler_DETECT_TRAPS(effect_handler_context_t *context)
 		}
 	}
 
+	map_batch_end();
+
 	/* Describe */
 	if (detect)
 		msg("You sense the presence of traps!");
@@ -1038,6 +1050,8 @@ bool effect_handler_DETECT_DOORS(effect_handler_context_t *context)
 	if (y2 > cave->height - 1) y2 = cave->height - 1;
 	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
+	map_batch_begin();
+
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++) {
 		for (x = x1; x < x2; x++) {
@@ -1052,6 +1066,7 @@ bool effect_handler_DETECT_DOORS(effect_handler_context_t *context)
 				/* Hack -- Memorize */
 				sqinfo_on(cave->squares[y][x].info, SQUARE_MARK);
 				cave_k->squares[y][x].feat = cave->squares[y][x].feat;
+				square_update_planes(cave_k, y, x);
 				/* Redraw */
 				square_light_spot(cave, y, x);
 
@@ -1062,6 +1077,8 @@ bool effect_handler_DETECT_DOORS(effect_handler_context_t *context)
 		}
 	}
 
+	map_batch_end();
+
 	/* Describe */
 	if (doors)
 		msg("You sense the presence of doors!");
@@ -1095,6 +1112,8 @@ bool effect_handler_DETECT_STAIRS(effect_handler_context_t *context)
 	if (y2 > cave->height - 1) y2 = cave->height - 1;
 	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
+	map_batch_begin();
+
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++) {
 		for (x = x1; x < x2; x++) {
@@ -1105,6 +1124,7 @@ bool effect_handler_DETECT_STAIRS(effect_handler_context_t *context)
 				/* Hack -- Memorize */
 				sqinfo_on(cave->squares[y][x].info, SQUARE_MARK);
 				cave_k->squares[y][x].feat = cave->squares[y][x].feat;
+				square_update_planes(cave_k, y, x);
 				/* Redraw */
 				square_light_spot(cave, y, x);
 
@@ -1115,6 +1135,8 @@ bool effect_handler_DETECT_STAIRS(effect_handler_context_t *context)
 		}
 	}
 
+	map_batch_end();
+
 	/* Describe */
 	if (stairs)
 		msg("You sense the presence of stairs!");
@@ -1150,6 +1172,8 @@ bool effect_handler_DETECT_GOLD(effect_handler_context_t *context)
 	if (y2 > cave->height - 1) y2 = cave->height - 1;
 	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
+	map_batch_begin();
+
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++) {
 		for (x = x1; x < x2; x++) {
@@ -1170,6 +1194,8 @@ bool effect_handler_DETECT_GOLD(effect_handler_context_t *context)
 		}
 	}
 
+	map_batch_end();
+
 	/* Message unless we're silently detecting */
 	if (context->p1 != 1) {
 		if (gold_buried)
@@ -1188,6 +1214,7 @@ bool effect_handler_DETECT_GOLD(effect_handler_context_t *context)
  */
 bool effect_handler_SENSE_OBJECTS(effect_handler_context_t *context)
 {
+	struct cell_iter iter;
 	int x, y;
 	int x1, x2, y1, y2;
 	int y_dist = context->value.dice;
@@ -1206,30 +1233,30 @@ bool effect_handler_SENSE_OBJECTS(effect_handler_context_t *context)
 	if (y2 > cave->height - 1) y2 = cave->height - 1;
 	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
-	/* Scan the area for objects */
-	for (y = y1; y <= y2; y++) {
-		for (x = x1; x <= x2; x++) {
-			struct object *obj = square_object(cave, y, x);
+	map_batch_begin();
 
-			/* Skip empty grids */
-			if (!obj) continue;
-
-			/* Notice an object is detected */
-			objects = TRUE;
-			context->ident = TRUE;
+	/* Scan the area for objects */
+	cell_iter_rect(&iter, cave, y1, x1, y2, x2);
+	while (cell_iter_next_object(&iter, &y, &x)) {
+		struct object *obj = square_object(cave, y, x);
 
-			/* Mark the pile as aware */
-			while (obj) {
-				if (obj->marked == MARK_UNAWARE)
-					obj->marked = MARK_AWARE;
-				obj = obj->next;
-			}
+		/* Notice an object is detected */
+		objects = TRUE;
+		context->ident = TRUE;
 
-			/* Redraw */
-			square_light_spot(cave, y, x);
+		/* Mark the pile as aware */
+		while (obj) {
+			if (obj->marked == MARK_UNAWARE)
+				obj->marked = MARK_AWARE;
+			obj = obj->next;
 		}
+
+		/* Redraw */
+		square_light_spot(cave, y, x);
 	}
 
+	map_batch_end();
+
 	if (objects)
 		msg("You sense the presence of objects!");
 	else if (context->aware)
@@ -1245,6 +1272,7 @@ bool effect_handler_SENSE_OBJECTS(effect_handler_context_t *context)
  */
 bool effect_handler_DETECT_OBJECTS(effect_handler_context_t *context)
 {
+	struct cell_iter iter;
 	int x, y;
 	int x1, x2, y1, y2;
 	int y_dist = context->value.dice;
@@ -1263,31 +1291,31 @@ bool effect_handler_DETECT_OBJECTS(effect_handler_context_t *context)
 	if (y2 > cave->height - 1) y2 = cave->height - 1;
 	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
-	/* Scan the area for objects */
-	for (y = y1; y <= y2; y++) {
-		for (x = x1; x <= x2; x++) {
-			struct object *obj = square_object(cave, y, x);
-
-			/* Skip empty grids */
-			if (!obj) continue;
+	map_batch_begin();
 
-			/* Notice an object is detected */
-			if (!ignore_item_ok(obj)) {
-				objects = TRUE;
-				context->ident = TRUE;
-			}
+	/* Scan the area for objects */
+	cell_iter_rect(&iter, cave, y1, x1, y2, x2);
+	while (cell_iter_next_object(&iter, &y, &x)) {
+		struct object *obj = square_object(cave, y, x);
 
-			/* Markthe pile as seen */
-			while (obj) {
-				obj->marked = MARK_SEEN;
-				obj = obj->next;
-			}
+		/* Notice an object is detected */
+		if (!ignore_item_ok(obj)) {
+			objects = TRUE;
+			context->ident = TRUE;
+		}
 
-			/* Redraw */
-			square_light_spot(cave, y, x);
+		/* Markthe pile as seen */
+		while (obj) {
+			obj->marked = MARK_SEEN;
+			obj = obj->next;
 		}
+
+		/* Redraw */
+		square_light_spot(cave, y, x);
 	}
 
+	map_batch_end();
+
 	if (objects)
 		msg("You detect the presence of objects!");
 	else if (context->aware)
@@ -1303,7 +1331,8 @@ bool effect_handler_DETECT_OBJECTS(effect_handler_context_t *context)
  */
 bool effect_handler_DETECT_VISIBLE_MONSTERS(effect_handler_context_t *context)
 {
-	int i, x, y;
+	struct cell_iter iter;
+	struct monster *m_ptr;
 	int x1, x2, y1, y2;
 	int y_dist = context->value.dice;
 	int x_dist = context->value.sides;
@@ -1322,19 +1351,8 @@ bool effect_handler_DETECT_VISIBLE_MONSTERS(effect_handler_context_t *context)
 	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
 	/* Scan monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		monster_type *m_ptr = cave_monster(cave, i);
-
-		/* Skip dead monsters */
-		if (!m_ptr->race) continue;
-
-		/* Location */
-		y = m_ptr->fy;
-		x = m_ptr->fx;
-
-		/* Only detect nearby monsters */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
-
+	cell_iter_rect(&iter, cave, y1, x1, y2, x2);
+	while ((m_ptr = cell_iter_next_monster(&iter))) {
 		/* Detect all non-invisible, obvious monsters */
 		if (!rf_has(m_ptr->race->flags, RF_INVISIBLE) &&
 			!mflag_has(m_ptr->mflag, MFLAG_UNAWARE)) {
@@ -1372,7 +1390,8 @@ bool effect_handler_DETECT_VISIBLE_MONSTERS(effect_handler_context_t *context)
  */
 bool effect_handler_DETECT_INVISIBLE_MONSTERS(effect_handler_context_t *context)
 {
-	int i, x, y;
+	struct cell_iter iter;
+	struct monster *m_ptr;
 	int x1, x2, y1, y2;
 	int y_dist = context->value.dice;
 	int x_dist = context->value.sides;
@@ -1391,22 +1410,12 @@ bool effect_handler_DETECT_INVISIBLE_MONSTERS(effect_handler_context_t *context)
 	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
 	/* Scan monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		monster_type *m_ptr = cave_monster(cave, i);
+	cell_iter_rect(&iter, cave, y1, x1, y2, x2);
+	while ((m_ptr = cell_iter_next_monster(&iter))) {
 		monster_lore *l_ptr;
 
-		/* Skip dead monsters */
-		if (!m_ptr->race) continue;
-
 		l_ptr = get_lore(m_ptr->race);
 
-		/* Location */
-		y = m_ptr->fy;
-		x = m_ptr->fx;
-
-		/* Only detect nearby monsters */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
-
 		/* Detect invisible monsters */
 		if (rf_has(m_ptr->race->flags, RF_INVISIBLE)) {
 			/* Take note that they are invisible */
@@ -1446,7 +1455,8 @@ bool effect_handler_DETECT_INVISIBLE_MONSTERS(effect_handler_context_t *context)
  */
 bool effect_handler_DETECT_EVIL(effect_handler_context_t *context)
 {
-	int i, x, y;
+	struct cell_iter iter;
+	struct monster *m_ptr;
 	int x1, x2, y1, y2;
 	int y_dist = context->value.dice;
 	int x_dist = context->value.sides;
@@ -1465,22 +1475,12 @@ bool effect_handler_DETECT_EVIL(effect_handler_context_t *context)
 	if (x2 > cave->width - 1) x2 = cave->width - 1;
 
 	/* Scan monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		monster_type *m_ptr = cave_monster(cave, i);
+	cell_iter_rect(&iter, cave, y1, x1, y2, x2);
+	while ((m_ptr = cell_iter_next_monster(&iter))) {
 		monster_lore *l_ptr;
 
-		/* Skip dead monsters */
-		if (!m_ptr->race) continue;
-
 		l_ptr = get_lore(m_ptr->race);
 
-		/* Location */
-		y = m_ptr->fy;
-		x = m_ptr->fx;
-
-		/* Only detect nearby monsters */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
-
 		/* Detect evil monsters */
 		if (rf_has(m_ptr->race->flags, RF_EVIL)) {
 			/* Take note that they are evil */
@@ -2113,7 +2113,8 @@ bool effect_handler_ACQUIRE(effect_handler_context_t *context)
  */
 bool effect_handler_AGGRAVATE(effect_handler_context_t *context)
 {
-	int i;
+	struct cell_iter iter;
+	struct monster *m_ptr;
 	bool sleep = FALSE;
 	int midx = cave->mon_current;
 	monster_type *who = midx > 0 ? cave_monster(cave, midx) : NULL;
@@ -2125,12 +2126,9 @@ bool effect_handler_AGGRAVATE(effect_handler_context_t *context)
 	}
 
 	/* Aggravate everyone nearby */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		monster_type *m_ptr = cave_monster(cave, i);
-
-		/* Paranoia -- Skip dead monsters */
-		if (!m_ptr->race) continue;
-
+	cell_iter_radius(&iter, cave, player->py, player->px,
+					 z_info->max_sight * 2);
+	while ((m_ptr = cell_iter_next_monster(&iter))) {
 		/* Skip aggravating monster (or player) */
 		if (m_ptr == who) continue;
 
@@ -2298,27 +2296,21 @@ bool effect_handler_BANISH(effect_handler_context_t *context)
  */
 bool effect_handler_MASS_BANISH(effect_handler_context_t *context)
 {
-	int i;
+	struct cell_iter iter;
+	struct monster *m_ptr;
 	int radius = context->p2 ? context->p2 : z_info->max_sight;
 	unsigned dam = 0;
 
 	context->ident = TRUE;
 
 	/* Delete the (nearby) monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		monster_type *m_ptr = cave_monster(cave, i);
-
-		/* Paranoia -- Skip dead monsters */
-		if (!m_ptr->race) continue;
-
+	cell_iter_radius(&iter, cave, player->py, player->px, radius);
+	while ((m_ptr = cell_iter_next_monster(&iter))) {
 		/* Hack -- Skip unique monsters */
 		if (rf_has(m_ptr->race->flags, RF_UNIQUE)) continue;
 
-		/* Skip distant monsters */
-		if (m_ptr->cdis > radius) continue;
-
 		/* Delete the monster */
-		delete_monster_idx(i);
+		delete_monster_idx(m_ptr->midx);
 
 		/* Take some damage */
 		dam += randint1(3);
@@ -2800,6 +2792,8 @@ bool effect_handler_DESTRUCTION(effect_handler_context_t *context)
 		return TRUE;
 	}
 
+	map_batch_begin();
+
 	/* Big area of affect */
 	for (y = (y1 - r); y <= (y1 + r); y++) {
 		for (x = (x1 - r); x <= (x1 + r); x++) {
@@ -2841,6 +2835,8 @@ bool effect_handler_DESTRUCTION(effect_handler_context_t *context)
 		}
 	}
 
+	map_batch_end();
+
 	/* Message */
 	msg("There is a searing blast of light!");
 
@@ -3041,8 +3037,8 @@ bool effect_handler_EARTHQUAKE(effect_handler_context_t *context)
 				monster_type *m_ptr = square_monster(cave, yy, xx);
 
 				/* Most monsters cannot co-exist with rock */
-				if (!flags_test(m_ptr->race->flags, RF_SIZE, RF_KILL_WALL,
-								RF_PASS_WALL, FLAG_END)) {
+				if (!(m_ptr->race->move_flags &
+					  (MOVE_KILL_WALL | MOVE_PASS_WALL))) {
 					char m_name[80];
 
 					/* Assume not safe */
@@ -3091,6 +3087,7 @@ bool effect_handler_EARTHQUAKE(effect_handler_context_t *context)
 							MON_TMD_FLG_NOMESSAGE, FALSE);
 
 					/* If the quake finished the monster off, show message */
+					monster_settle_regen(m_ptr);
 					if (m_ptr->hp < damage && m_ptr->hp >= 0)
 						msg("%s is embedded in the rock!", m_name);
 
@@ -3123,6 +3120,8 @@ bool effect_handler_EARTHQUAKE(effect_handler_context_t *context)
 	map[16 + py - cy][16 + px - cx] = FALSE;
 
 
+	map_batch_begin();
+
 	/* Examine the quaked region */
 	for (dy = -r; dy <= r; dy++) {
 		for (dx = -r; dx <= r; dx++) {
@@ -3145,6 +3144,8 @@ bool effect_handler_EARTHQUAKE(effect_handler_context_t *context)
 		}
 	}
 
+	map_batch_end();
+
 	/* Fully update the visuals */
 	player->upkeep->update |= (PU_FORGET_VIEW | PU_UPDATE_VIEW | PU_MONSTERS);
 
@@ -4377,6 +4378,49 @@ bool effect_do(struct effect *effect, bool *ident, bool aware, int dir, int beam
 	return completed;
 }
 
+/**
+ * Dice strings recently given to effect_simple(), already parsed.  The same
+ * few strings ("0" above all) come round again and again from monster blows,
+ * traps and the like, so there is no need to parse them every time.
+ */
+#define SIMPLE_DICE_MAX 32
+
+static struct simple_dice {
+	char *text;
+	dice_t *dice;
+	u32b used;
+} simple_dice[SIMPLE_DICE_MAX];
+
+static u32b simple_dice_clock;
+
+/**
+ * Find the parsed form of a dice string, parsing it over the least recently
+ * used entry if it is not there
+ */
+static dice_t *simple_dice_get(const char *dice_string)
+{
+	struct simple_dice *entry = &simple_dice[0];
+	int i;
+
+	for (i = 0; i < SIMPLE_DICE_MAX; i++) {
+		if (simple_dice[i].text && streq(simple_dice[i].text, dice_string)) {
+			simple_dice[i].used = ++simple_dice_clock;
+			return simple_dice[i].dice;
+		}
+		if (simple_dice[i].used < entry->used)
+			entry = &simple_dice[i];
+	}
+
+	string_free(entry->text);
+	if (entry->dice)
+		dice_free(entry->dice);
+	entry->text = string_make(dice_string);
+	entry->dice = dice_new();
+	dice_parse_string(entry->dice, dice_string);
+	entry->used = ++simple_dice_clock;
+	return entry->dice;
+}
+
 /**
  * Perform a single effect with a simple dice string and parameters
  * Calling with ident a valid pointer will (depending on effect) give success
@@ -4384,27 +4428,38 @@ bool effect_do(struct effect *effect, bool *ident, bool aware, int dir, int beam
  */
 void effect_simple(int index, const char* dice_string, int p1, int p2, int p3, bool *ident)
 {
-	struct effect *effect = mem_zalloc(sizeof(*effect));
+	struct effect effect = { NULL, index, NULL, { p1, p2, p3 } };
 	int dir = DIR_TARGET;
 	bool dummy_ident;
 
-	/* Set all the values */
-	effect->index = index;
-	effect->dice = dice_new();
-	dice_parse_string(effect->dice, dice_string);
-	effect->params[0] = p1;
-	effect->params[1] = p2;
-	effect->params[2] = p3;
+	/* The dice are only needed until they are rolled, at the start of
+	 * effect_do(), so a nested call replacing them does no harm */
+	effect.dice = simple_dice_get(dice_string);
 
 	/* Direction if needed */
-	if (effect_aim(effect))
+	if (effect_aim(&effect))
 		get_aim_dir(&dir);
 
 	/* Do the effect */
 	if (ident)
-		effect_do(effect, ident, TRUE, dir, 0, 0);
+		effect_do(&effect, ident, TRUE, dir, 0, 0);
 	else
-		effect_do(effect, &dummy_ident, TRUE, dir, 0, 0);
+		effect_do(&effect, &dummy_ident, TRUE, dir, 0, 0);
+}
 
-	free_effect(effect);
+/**
+ * Free the dice kept by effect_simple()
+ */
+void effect_simple_cleanup(void)
+{
+	int i;
+
+	for (i = 0; i < SIMPLE_DICE_MAX; i++) {
+		string_free(simple_dice[i].text);
+		if (simple_dice[i].dice)
+			dice_free(simple_dice[i].dice);
+		simple_dice[i].text = NULL;
+		simple_dice[i].dice = NULL;
+		simple_dice[i].used = 0;
+	}
 }
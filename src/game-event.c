@@ -17,104 +17,202 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "game-event.h"
 #include "object.h"
 #include "z-virt.h"
 
 struct event_handler_entry
 {
-	struct event_handler_entry *next;	
 	game_event_handler *fn;
 	void *user;
 };
 
-static struct event_handler_entry *event_handlers[N_GAME_EVENTS];
+/**
+ * The handlers for one event, oldest first; they are called newest first.
+ * Entries removed while events are being dispatched are left with no
+ * function until the outermost dispatch is over, so that a handler may
+ * add or remove handlers without upsetting the walks in progress.
+ */
+struct event_handler_list
+{
+	struct event_handler_entry *entries;
+	size_t num;
+	size_t max;
+};
+
+static struct event_handler_list event_handlers[N_GAME_EVENTS];
+
+/**
+ * How many dispatches are in progress, and whether any entries have been
+ * removed during them
+ */
+static int dispatch_depth = 0;
+static bool dispatch_removed = FALSE;
+
+/**
+ * Set when there is no display at all (see "event_set_headless()")
+ */
+static bool headless = FALSE;
+
+/**
+ * Check whether an event only exists to keep a display up to date
+ */
+static bool event_is_display_only(game_event_type type)
+{
+	switch (type) {
+		case EVENT_MAP:
+		case EVENT_STATS:
+		case EVENT_HP:
+		case EVENT_MANA:
+		case EVENT_AC:
+		case EVENT_EXPERIENCE:
+		case EVENT_PLAYERLEVEL:
+		case EVENT_PLAYERTITLE:
+		case EVENT_GOLD:
+		case EVENT_MONSTERHEALTH:
+		case EVENT_DUNGEONLEVEL:
+		case EVENT_PLAYERSPEED:
+		case EVENT_RACE_CLASS:
+		case EVENT_STUDYSTATUS:
+		case EVENT_STATUS:
+		case EVENT_DETECTIONSTATUS:
+		case EVENT_STATE:
+		case EVENT_PLAYERMOVED:
+		case EVENT_SEEFLOOR:
+		case EVENT_EXPLOSION:
+		case EVENT_BOLT:
+		case EVENT_MISSILE:
+		case EVENT_INVENTORY:
+		case EVENT_EQUIPMENT:
+		case EVENT_ITEMLIST:
+		case EVENT_MONSTERLIST:
+		case EVENT_MONSTERTARGET:
+		case EVENT_OBJECTTARGET:
+		case EVENT_REFRESH:
+		case EVENT_NEW_LEVEL_DISPLAY:
+		case EVENT_COMMAND_REPEAT:
+		case EVENT_ANIMATE:
+		case EVENT_END:
+			return TRUE;
+
+		default:
+			return FALSE;
+	}
+}
+
+/**
+ * Squeeze the entries removed during dispatches out of the lists
+ */
+static void event_compact_handlers(void)
+{
+	int type;
+
+	for (type = 0; type < N_GAME_EVENTS; type++) {
+		struct event_handler_list *list = &event_handlers[type];
+		size_t i, n = 0;
+
+		for (i = 0; i < list->num; i++)
+			if (list->entries[i].fn)
+				list->entries[n++] = list->entries[i];
+		list->num = n;
+	}
+
+	dispatch_removed = FALSE;
+}
+
+/**
+ * Take an entry out of a list, or just mark it if it may be being walked
+ */
+static void event_remove_entry(struct event_handler_list *list, size_t i)
+{
+	if (dispatch_depth) {
+		list->entries[i].fn = NULL;
+		dispatch_removed = TRUE;
+	} else {
+		memmove(&list->entries[i], &list->entries[i + 1],
+				(list->num - i - 1) * sizeof(list->entries[0]));
+		list->num--;
+	}
+}
 
 static void game_event_dispatch(game_event_type type, game_event_data *data)
 {
-	struct event_handler_entry *this = event_handlers[type];
+	struct event_handler_list *list = &event_handlers[type];
+	size_t i = list->num;
+
+	/* Nothing to show it on */
+	if (headless && event_is_display_only(type)) return;
 
 	/* 
-	 * Send the word out to all interested event handlers.
+	 * Send the word out to all interested event handlers, newest first;
+	 * any added by the handlers will hear about the next one.
 	 */
-	while (this)
-	{
+	dispatch_depth++;
+	while (i--) {
+		/* The list may move if a handler adds to it */
+		struct event_handler_entry this = list->entries[i];
+
 		/* Call the handler with the relevant data */
-		this->fn(type, data, this->user);
-		this = this->next;
+		if (this.fn)
+			this.fn(type, data, this.user);
 	}
+
+	if (!--dispatch_depth && dispatch_removed)
+		event_compact_handlers();
 }
 
 void event_add_handler(game_event_type type, game_event_handler *fn, void *user)
 {
-	struct event_handler_entry *new;
+	struct event_handler_list *list = &event_handlers[type];
 
 	assert(fn != NULL);
 
-	/* Make a new entry */
-	new = mem_alloc(sizeof *new);
-	new->fn = fn;
-	new->user = user;
+	/* Make room */
+	if (list->num == list->max) {
+		list->max = list->max ? 2 * list->max : 4;
+		list->entries = mem_realloc(list->entries,
+									list->max * sizeof(list->entries[0]));
+	}
 
-	/* Add it to the head of the appropriate list */
-	new->next = event_handlers[type];
-	event_handlers[type] = new;
+	/* Add it to the end of the appropriate list */
+	list->entries[list->num].fn = fn;
+	list->entries[list->num].user = user;
+	list->num++;
 }
 
 void event_remove_handler(game_event_type type, game_event_handler *fn, void *user)
 {
-	struct event_handler_entry *prev = NULL;
-	struct event_handler_entry *this = event_handlers[type];
-
-	/* Look for the entry in the list */
-	while (this)
-	{
-		/* Check if this is the entry we want to remove */
-		if (this->fn == fn && this->user == user)
-		{
-			if (!prev)
-			{
-				event_handlers[type] = this->next;
-			}
-			else
-			{
-				prev->next = this->next;
-			}
-
-			mem_free(this);
+	struct event_handler_list *list = &event_handlers[type];
+	size_t i = list->num;
+
+	/* Look for the newest matching entry in the list */
+	while (i--) {
+		if (list->entries[i].fn == fn && list->entries[i].user == user) {
+			event_remove_entry(list, i);
 			return;
 		}
-
-		prev = this;
-		this = this->next;
 	}
 }
 
 void event_remove_handler_type(game_event_type type)
 {
-	struct event_handler_entry *handler = event_handlers[type];
+	struct event_handler_list *list = &event_handlers[type];
+	size_t i = list->num;
 
-	while (handler) {
-		struct event_handler_entry *next = handler->next;
-		mem_free(handler);
-		handler = next;
-	}
-	event_handlers[type] = NULL;
+	while (i--)
+		event_remove_entry(list, i);
 }
 
 void event_remove_all_handlers(void)
 {
 	int type;
-	struct event_handler_entry *handler, *next;
 
 	for (type = 0; type < N_GAME_EVENTS; type++) {
-		handler = event_handlers[type];
-		while (handler) {
-			next = handler->next;
-			mem_free(handler);
-			handler = next;
-		}
-		event_handlers[type] = NULL;
+		mem_free(event_handlers[type].entries);
+		event_handlers[type].entries = NULL;
+		event_handlers[type].num = 0;
+		event_handlers[type].max = 0;
 	}
 }
 
@@ -137,6 +235,24 @@ void event_remove_handler_set(game_event_type *type, size_t n_types, game_event_
 
 
 
+/**
+ * Tell the game whether there is a display at all.
+ *
+ * Frontends that only run the game for its results (see main-stats.c) set
+ * this before anything is signalled.  The events that only update a display
+ * are then dropped, and "redraw_stuff()" does nothing; everything that
+ * affects the game itself still happens.
+ */
+void event_set_headless(bool no_display)
+{
+	headless = no_display;
+}
+
+bool event_headless(void)
+{
+	return headless;
+}
+
 void event_signal(game_event_type type)
 {
 	game_event_dispatch(type, NULL);
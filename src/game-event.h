@@ -172,6 +172,9 @@ void event_remove_all_handlers(void);
 void event_add_handler_set(game_event_type *type, size_t n_types, game_event_handler *fn, void *user);
 void event_remove_handler_set(game_event_type *type, size_t n_types, game_event_handler *fn, void *user);
 
+void event_set_headless(bool no_display);
+bool event_headless(void);
+
 void event_signal_birthpoints(int stats[6], int remaining);
 
 void event_signal_point(game_event_type, int x, int y);
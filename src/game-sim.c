@@ -0,0 +1,269 @@
+/**
+ * \file game-sim.c
+ * \brief Drive the game from a program, without any display
+ *
+ * Copyright (c) 2026 Angband contributors
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ *
+ * This is the whole of a front end for programs that play the game
+ * themselves: a bot, a search, a simulation.  There is no term, so no key
+ * handling, no screen updates and no prompts; the game runs headless (see
+ * event_set_headless()) and the game-input hooks are left unset, so any
+ * question the game asks gets its default answer.
+ *
+ * A program starts with sim_init() and sim_new_game(). It then plays by
+ * pushing commands itself, just as the UI does:
+ *
+ *	cmdq_push(CMD_WALK);
+ *	cmd_set_arg_direction(cmdq_peek(), "direction", 6);
+ *	sim_step();
+ *
+ * sim_step() runs the game until it wants the next command. In between,
+ * the sim_*() queries copy out what the player knows, leaving the game
+ * untouched, so that querying never changes how a game plays out.
+ * savefile_snapshot() and savefile_restore() can be used to branch a game.
+ *
+ * Built as lib<progname>.a, only the game objects a program asks for are
+ * linked in with it.
+ */
+
+#include "angband.h"
+#include "cave.h"
+#include "cmd-core.h"
+#include "game-event.h"
+#include "game-sim.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-timed.h"
+#include "obj-desc.h"
+#include "obj-identify.h"
+#include "obj-ignore.h"
+#include "player-calcs.h"
+
+/**
+ * Make sure a path ends in a separator, as init_file_paths() expects
+ */
+static void sim_path(char *buf, size_t len, const char *path,
+					 const char *fallback)
+{
+	my_strcpy(buf, path ? path : fallback, len);
+	if (!suffix(buf, PATH_SEP))
+		my_strcat(buf, PATH_SEP, len);
+}
+
+/**
+ * Read the game data, from the given directories or, for any left NULL,
+ * the ones the game was configured with.
+ */
+bool sim_init(const char *configpath, const char *libpath,
+			  const char *datapath)
+{
+	char config[512], lib[512], data[512];
+
+	sim_path(config, sizeof(config), configpath, DEFAULT_CONFIG_PATH);
+	sim_path(lib, sizeof(lib), libpath, DEFAULT_LIB_PATH);
+	sim_path(data, sizeof(data), datapath, DEFAULT_DATA_PATH);
+
+	/* Nothing is ever shown */
+	event_set_headless(TRUE);
+
+	init_file_paths(config, lib, data);
+	return init_angband();
+}
+
+/**
+ * Free everything sim_init() and the game allocated
+ */
+void sim_cleanup(void)
+{
+	cleanup_angband();
+}
+
+/**
+ * Make a new character and put them on their first level.
+ *
+ * The race and class are indices into the races and classes shown at birth;
+ * the stats are rolled, never point-bought.  The whole game follows from
+ * 'seed' and the commands given.  Call this once after sim_init().
+ */
+bool sim_new_game(u32b seed, int race, int class, const char *name)
+{
+	Rand_quick = FALSE;
+	Rand_state_init(seed);
+
+	cmdq_push(CMD_BIRTH_INIT);
+	cmdq_push(CMD_BIRTH_RESET);
+	cmdq_push(CMD_CHOOSE_RACE);
+	cmd_set_arg_choice(cmdq_peek(), "choice", race);
+	cmdq_push(CMD_CHOOSE_CLASS);
+	cmd_set_arg_choice(cmdq_peek(), "choice", class);
+	cmdq_push(CMD_ROLL_STATS);
+	cmdq_push(CMD_NAME_CHOICE);
+	cmd_set_arg_string(cmdq_peek(), "name", name);
+	cmdq_push(CMD_ACCEPT_CHARACTER);
+	cmdq_execute(CMD_BIRTH);
+
+	if (!character_generated || player->is_dead)
+		return FALSE;
+
+	/* Nothing is saved behind the program's back */
+	player->upkeep->autosave = FALSE;
+
+	cave_generate(&cave, player);
+	on_new_level();
+	return TRUE;
+}
+
+/**
+ * Carry out the queued commands, and the rest of the game world, until the
+ * game needs another command.  Returns FALSE once the game is over.
+ */
+bool sim_step(void)
+{
+	if (player->is_dead || !player->upkeep->playing)
+		return FALSE;
+
+	run_game_loop();
+	player->upkeep->autosave = FALSE;
+
+	return !player->is_dead && player->upkeep->playing;
+}
+
+/**
+ * Fill in the player's status
+ */
+void sim_status(struct sim_status *status)
+{
+	status->turn = turn;
+	status->depth = player->depth;
+	status->y = player->py;
+	status->x = player->px;
+	status->lev = player->lev;
+	status->exp = player->exp;
+	status->au = player->au;
+	status->chp = player->chp;
+	status->mhp = player->mhp;
+	status->csp = player->csp;
+	status->msp = player->msp;
+	status->food = player->food;
+	status->dead = player->is_dead;
+}
+
+/**
+ * Give the size of the current level, for sizing the grids for sim_map()
+ */
+void sim_map_size(int *height, int *width)
+{
+	*height = cave->height;
+	*width = cave->width;
+}
+
+/**
+ * Fill in the map, row by row, as the player knows it.
+ *
+ * This follows map_info(), less the hallucinations, which would use up
+ * random numbers.
+ */
+void sim_map(struct sim_grid *grids)
+{
+	int y, x;
+
+	for (y = 0; y < cave->height; y++) {
+		for (x = 0; x < cave->width; x++) {
+			struct sim_grid *g = &grids[y * cave->width + x];
+			struct object *obj;
+			int m_idx = cave->squares[y][x].mon;
+
+			g->seen = square_isseen(cave, y, x);
+			g->feat = cave->squares[y][x].feat;
+			if (f_info[g->feat].mimic)
+				g->feat = f_info[g->feat].mimic;
+			if (!g->seen && !square_ismark(cave, y, x))
+				g->feat = FEAT_NONE;
+
+			g->object = 0;
+			for (obj = square_object(cave, y, x); obj; obj = obj->next) {
+				if (obj->marked == MARK_SEEN && !ignore_item_ok(obj)) {
+					g->object = obj->kind->kidx;
+					break;
+				}
+			}
+
+			g->monster = 0;
+			if (m_idx > 0) {
+				struct monster *mon = cave_monster(cave, m_idx);
+				if (mflag_has(mon->mflag, MFLAG_VISIBLE))
+					g->monster = mon->race->ridx;
+			}
+		}
+	}
+}
+
+/**
+ * Fill in up to 'max' of the monsters the player is aware of, returning
+ * how many there are in all.
+ */
+int sim_monsters(struct sim_monster *mons, int max)
+{
+	int i, n = 0;
+
+	for (i = 1; i < cave_monster_max(cave); i++) {
+		struct monster *mon = cave_monster(cave, i);
+
+		/* Only visible, known monsters, as in the monster list */
+		if (!mon->race || !mflag_has(mon->mflag, MFLAG_VISIBLE) ||
+			mflag_has(mon->mflag, MFLAG_UNAWARE))
+			continue;
+
+		if (n < max) {
+			struct sim_monster *m = &mons[n];
+			m->midx = i;
+			m->race = mon->race->ridx;
+			m->y = mon->fy;
+			m->x = mon->fx;
+			m->hp = mon->hp;
+			m->maxhp = mon->maxhp;
+			m->asleep = mon->m_timed[MON_TMD_SLEEP] > 0;
+		}
+		n++;
+	}
+
+	return n;
+}
+
+/**
+ * Fill in up to 'max' of the player's items, returning how many there are
+ * in all.
+ */
+int sim_gear(struct sim_item *items, int max)
+{
+	struct object *obj;
+	int n = 0;
+
+	for (obj = player->gear; obj; obj = obj->next) {
+		if (n < max) {
+			struct sim_item *item = &items[n];
+			int slot = equipped_item_slot(player->body, obj);
+
+			item->kind = object_flavor_is_aware(obj) ? (int)obj->kind->kidx : 0;
+			item->number = obj->number;
+			item->slot = slot < player->body.count ? slot : -1;
+			object_desc(item->name, sizeof(item->name), obj,
+						ODESC_PREFIX | ODESC_FULL);
+		}
+		n++;
+	}
+
+	return n;
+}
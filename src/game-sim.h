@@ -0,0 +1,83 @@
+/**
+ * \file game-sim.h
+ * \brief Drive the game from a program, without any display
+ *
+ * Copyright (c) 2026 Angband contributors
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef INCLUDED_GAME_SIM_H
+#define INCLUDED_GAME_SIM_H
+
+#include "h-basic.h"
+
+/**
+ * One grid of the map, as the player knows it
+ */
+struct sim_grid {
+	int feat;		/* Remembered terrain, FEAT_NONE if never known */
+	bool seen;		/* Currently in view */
+	int monster;	/* Race index of a visible monster, or 0 */
+	int object;		/* Kind index of the top known object, or 0 */
+};
+
+/**
+ * A monster the player can see or detect
+ */
+struct sim_monster {
+	int midx;		/* Index into the level's monster list */
+	int race;		/* Race index */
+	int y, x;
+	int hp, maxhp;
+	bool asleep;
+};
+
+/**
+ * One item carried or worn by the player, as the player knows it
+ */
+struct sim_item {
+	int kind;		/* Kind index, 0 if not yet known */
+	int number;
+	int slot;		/* Equipment slot, or -1 if only carried */
+	char name[80];
+};
+
+/**
+ * The player's vital statistics
+ */
+struct sim_status {
+	s32b turn;
+	int depth;
+	int y, x;
+	int lev;
+	s32b exp;
+	s32b au;
+	int chp, mhp;
+	int csp, msp;
+	int food;
+	bool dead;
+};
+
+bool sim_init(const char *configpath, const char *libpath,
+			  const char *datapath);
+void sim_cleanup(void);
+bool sim_new_game(u32b seed, int race, int class, const char *name);
+bool sim_step(void);
+
+void sim_status(struct sim_status *status);
+void sim_map_size(int *height, int *width);
+void sim_map(struct sim_grid *grids);
+int sim_monsters(struct sim_monster *mons, int max);
+int sim_gear(struct sim_item *items, int max);
+
+#endif /* INCLUDED_GAME_SIM_H */
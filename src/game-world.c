@@ -17,6 +17,7 @@
  */
 
 #include "angband.h"
+#include "cmd-record.h"
 #include "cmds.h"
 #include "game-world.h"
 #include "init.h"
@@ -32,6 +33,7 @@
 #include "player-timed.h"
 #include "player-util.h"
 #include "target.h"
+#include "z-trace.h"
 
 u16b daycount = 0;
 u32b seed_randart;		/* Hack -- consistent random artifacts */
@@ -160,7 +162,7 @@ static void recharged_notice(const object_type *obj, bool all)
  */
 static void recharge_objects(void)
 {
-	int y, x;
+	int i;
 
 	bool discharged_stack;
 
@@ -205,13 +207,22 @@ static void recharge_objects(void)
 		}
 	}
 
-	/* Recharge the ground */
-	for (y = 1; y < cave->height; y++)
-		for (x = 1; x < cave->width; x++)
-			for (obj = square_object(cave, y, x); obj; obj = obj->next)
-				/* Recharge rods on the ground */
-				if (tval_can_have_timeout(obj))
-					recharge_timeout(obj);
+	/* Recharge rods on the ground, dropping grids with nothing charging */
+	for (i = 0; i < cave->charging_num; ) {
+		struct loc grid = cave->charging[i];
+		bool charging = FALSE;
+
+		for (obj = square_object(cave, grid.y, grid.x); obj; obj = obj->next)
+			if (tval_can_have_timeout(obj)) {
+				recharge_timeout(obj);
+				if (obj->timeout) charging = TRUE;
+			}
+
+		if (charging)
+			i++;
+		else
+			cave->charging[i] = cave->charging[--cave->charging_num];
+	}
 }
 
 
@@ -582,6 +593,7 @@ void process_player(void)
 {
 	/* Check for interrupts */
 	player_resting_complete_special(player);
+	cmd_replay_interrupt();
 	event_signal(EVENT_CHECK_INTERRUPT);
 
 	/* Repeat until energy is reduced */
@@ -710,13 +722,131 @@ static void on_leave_level(void) {
 }
 
 
+#ifdef TURN_PROFILE
 /**
- * The main game loop.
- *
- * This function will run until the player needs to enter a command, or closes
- * the game, or the character dies.
+ * Whether the turn profiler is running
  */
-void run_game_loop(void)
+bool turn_prof_on = FALSE;
+
+static const char *turn_phase_names[TURN_PHASE_MAX] = {
+	"idle", "game loop", "process_world", "process_player",
+	"process_monsters", "notice/update/redraw", "update_inventory",
+	"update_bonuses", "update_view",
+	"cave_update_flow", "update_monsters", "Term_fresh", "new level"
+};
+
+static struct {
+	int phase;						/* Phase being charged */
+	clock_t since;					/* When it was entered */
+	clock_t ticks[TURN_PHASE_MAX];	/* Time charged to each phase */
+	u32b calls[TURN_PHASE_MAX];		/* Number of times each was entered */
+	s32b start_turn;				/* Game turn when profiling started */
+} turn_prof;
+
+/**
+ * Charge the time since the last change of phase to the current phase
+ */
+static void turn_prof_charge(void)
+{
+	clock_t now = clock();
+
+	turn_prof.ticks[turn_prof.phase] += now - turn_prof.since;
+	turn_prof.since = now;
+}
+
+/**
+ * Stop charging time to the current phase and start charging 'phase',
+ * counting one call of it.  Returns the previous phase, for TURN_PROF() to
+ * go back to.
+ */
+int turn_prof_enter(int phase)
+{
+	int old = turn_prof.phase;
+
+	if (!turn_prof_on) return old;
+
+	turn_prof_charge();
+	turn_prof.phase = phase;
+	turn_prof.calls[phase]++;
+
+	return old;
+}
+
+/**
+ * Go back to charging 'phase', which TURN_PROF() got from turn_prof_enter()
+ */
+void turn_prof_leave(int phase)
+{
+	if (!turn_prof_on) return;
+
+	turn_prof_charge();
+	turn_prof.phase = phase;
+}
+
+/**
+ * Throw away everything gathered so far, and start again from now
+ */
+void turn_prof_reset(void)
+{
+	memset(&turn_prof, 0, sizeof(turn_prof));
+	turn_prof.since = clock();
+	turn_prof.start_turn = turn;
+}
+
+/**
+ * Describe where the time has gone since the last reset, a line at a time.
+ * Percentages are of the time spent in the game loop, leaving out idle time.
+ */
+void turn_prof_dump(void (*out)(const char *line))
+{
+	char buf[160];
+	double busy = 0.0;
+	s32b turns = turn - turn_prof.start_turn;
+	int i;
+
+	if (turn_prof_on)
+		turn_prof_charge();
+
+	for (i = TURN_PHASE_OTHER; i < TURN_PHASE_MAX; i++)
+		busy += (double)turn_prof.ticks[i] / CLOCKS_PER_SEC;
+
+	strnfmt(buf, sizeof(buf), "Turn profile over %ld game turns: %.3fs busy, "
+			"%.3fs idle", (long)turns, busy,
+			(double)turn_prof.ticks[TURN_PHASE_IDLE] / CLOCKS_PER_SEC);
+	out(buf);
+	out("");
+	strnfmt(buf, sizeof(buf), "%-22s %10s %10s %6s %10s", "phase", "calls",
+			"seconds", "%", "us/turn");
+	out(buf);
+
+	for (i = TURN_PHASE_OTHER; i < TURN_PHASE_MAX; i++) {
+		double secs = (double)turn_prof.ticks[i] / CLOCKS_PER_SEC;
+
+		strnfmt(buf, sizeof(buf), "%-22s %10lu %10.3f %6.1f %10.1f",
+				turn_phase_names[i], (unsigned long)turn_prof.calls[i], secs,
+				busy > 0.0 ? 100.0 * secs / busy : 0.0,
+				turns > 0 ? 1000000.0 * secs / turns : 0.0);
+		out(buf);
+	}
+}
+#endif /* TURN_PROFILE */
+
+/**
+ * Leave the current level, if there is one, and make the next
+ */
+static void change_level(void)
+{
+	if (character_dungeon)
+		on_leave_level();
+
+	cave_generate(&cave, player);
+	on_new_level();
+}
+
+/**
+ * The main game loop, profiled as a whole by run_game_loop().
+ */
+static void run_game_loop_aux(void)
 {
 	/* Tidy up after the player's command */
 	process_player_cleanup();
@@ -724,7 +854,7 @@ void run_game_loop(void)
 	/* Keep processing the player until they use some energy or
 	 * another command is needed */
 	while (player->upkeep->playing) {
-		process_player();
+		TURN_PROF(TURN_PHASE_PLAYER, process_player());
 		if (player->upkeep->energy_use)
 			break;
 		else
@@ -738,14 +868,15 @@ void run_game_loop(void)
 		event_signal(EVENT_ANIMATE);
 		
 		/* Process monster with even more energy first */
-		process_monsters(cave, player->energy + 1);
+		TURN_PROF(TURN_PHASE_MONSTERS,
+				  process_monsters(cave, player->energy + 1));
 		if (player->is_dead || !player->upkeep->playing ||
 			player->upkeep->generate_level)
 			break;
 
 		/* Process the player until they use some energy */
 		while (player->upkeep->playing) {
-			process_player();
+			TURN_PROF(TURN_PHASE_PLAYER, process_player());
 			if (player->upkeep->energy_use)
 				break;
 			else
@@ -756,9 +887,9 @@ void run_game_loop(void)
 	/* Now that the player's turn is fully complete, we run the main loop 
 	 * until player input is needed again */
 	while (TRUE) {
-		notice_stuff(player);
-		handle_stuff(player);
-		event_signal(EVENT_REFRESH);
+		TURN_PROF(TURN_PHASE_STUFF, notice_stuff(player));
+		TURN_PROF(TURN_PHASE_STUFF, handle_stuff(player));
+		TURN_PROF(TURN_PHASE_REFRESH, event_signal(EVENT_REFRESH));
 
 		/* Process the rest of the world, give the player energy and 
 		 * increment the turn counter unless we need to stop playing or
@@ -767,26 +898,23 @@ void run_game_loop(void)
 			return;
 		else if (!player->upkeep->generate_level) {
 			/* Process the rest of the monsters */
-			process_monsters(cave, 0);
-
-			/* Mark all monsters as ready to act when they have the energy */
-			reset_monsters();
+			TURN_PROF(TURN_PHASE_MONSTERS, process_monsters(cave, 0));
 
 			/* Refresh */
-			notice_stuff(player);
-			handle_stuff(player);
-			event_signal(EVENT_REFRESH);
+			TURN_PROF(TURN_PHASE_STUFF, notice_stuff(player));
+			TURN_PROF(TURN_PHASE_STUFF, handle_stuff(player));
+			TURN_PROF(TURN_PHASE_REFRESH, event_signal(EVENT_REFRESH));
 			if (player->is_dead || !player->upkeep->playing)
 				return;
 
 			/* Process the world every ten turns */
 			if (!(turn % 10) && !player->upkeep->generate_level) {
-				process_world(cave);
+				TURN_PROF(TURN_PHASE_WORLD, process_world(cave));
 
 				/* Refresh */
-				notice_stuff(player);
-				handle_stuff(player);
-				event_signal(EVENT_REFRESH);
+				TURN_PROF(TURN_PHASE_STUFF, notice_stuff(player));
+				TURN_PROF(TURN_PHASE_STUFF, handle_stuff(player));
+				TURN_PROF(TURN_PHASE_REFRESH, event_signal(EVENT_REFRESH));
 				if (player->is_dead || !player->upkeep->playing)
 					return;
 			}
@@ -796,16 +924,12 @@ void run_game_loop(void)
 
 			/* Count game turns */
 			turn++;
+			object_desc_invalidate();
 		}
 
 		/* Make a new level if requested */
 		if (player->upkeep->generate_level) {
-			if (character_dungeon)
-				on_leave_level();
-
-			cave_generate(&cave, player);
-			on_new_level();
-
+			TURN_PROF(TURN_PHASE_LEVEL, change_level());
 			player->upkeep->generate_level = FALSE;
 		}
 
@@ -816,14 +940,15 @@ void run_game_loop(void)
 			event_signal(EVENT_ANIMATE);
 
 			/* Process monster with even more energy first */
-			process_monsters(cave, player->energy + 1);
+			TURN_PROF(TURN_PHASE_MONSTERS,
+					  process_monsters(cave, player->energy + 1));
 			if (player->is_dead || !player->upkeep->playing ||
 				player->upkeep->generate_level)
 				break;
 
 			/* Process the player until they use some energy */
 			while (player->upkeep->playing) {
-				process_player();
+				TURN_PROF(TURN_PHASE_PLAYER, process_player());
 				if (player->upkeep->energy_use)
 					break;
 				else
@@ -832,3 +957,14 @@ void run_game_loop(void)
 		}
 	}
 }
+
+/**
+ * The main game loop.
+ *
+ * This function will run until the player needs to enter a command, or closes
+ * the game, or the character dies.
+ */
+void run_game_loop(void)
+{
+	TRACE("run_game_loop", TURN_PROF(TURN_PHASE_OTHER, run_game_loop_aux()));
+}
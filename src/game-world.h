@@ -38,4 +38,50 @@ void on_new_level(void);
 void process_player(void);
 void run_game_loop(void);
 
+/**
+ * Parts of the game loop that the turn profiler tells apart.  Time is
+ * charged to the innermost phase running, so an update_view() called from
+ * a command counts as view time rather than player time.
+ */
+enum turn_phase {
+	TURN_PHASE_IDLE = 0,		/* Outside the game loop, eg waiting for keys */
+	TURN_PHASE_OTHER,			/* The game loop itself */
+	TURN_PHASE_WORLD,			/* process_world() */
+	TURN_PHASE_PLAYER,			/* process_player() */
+	TURN_PHASE_MONSTERS,		/* process_monsters() */
+	TURN_PHASE_STUFF,			/* notice_stuff(), update_stuff(), redraw_stuff() */
+	TURN_PHASE_INVEN,			/* update_stuff() for PU_INVEN */
+	TURN_PHASE_BONUS,			/* update_stuff() for PU_BONUS */
+	TURN_PHASE_VIEW,			/* update_view() */
+	TURN_PHASE_FLOW,			/* cave_update_flow() */
+	TURN_PHASE_UPDATE_MONSTERS,	/* update_monsters() */
+	TURN_PHASE_REFRESH,			/* Term_fresh(), through EVENT_REFRESH */
+	TURN_PHASE_LEVEL,			/* Leaving and generating levels */
+
+	TURN_PHASE_MAX
+};
+
+/**
+ * The turn profiler is only compiled into builds with TURN_PROFILE defined,
+ * and then only does any work while turn_prof_on is set.  TURN_PROF() runs
+ * 'call' as part of 'phase'.
+ */
+#ifdef TURN_PROFILE
+extern bool turn_prof_on;
+
+int turn_prof_enter(int phase);
+void turn_prof_leave(int phase);
+void turn_prof_reset(void);
+void turn_prof_dump(void (*out)(const char *line));
+
+#define TURN_PROF(phase, call) \
+	do { \
+		int turn_prof_old = turn_prof_enter(phase); \
+		call; \
+		turn_prof_leave(turn_prof_old); \
+	} while (0)
+#else
+#define TURN_PROF(phase, call) call
+#endif
+
 #endif /* !GAME_WORLD_H */
@@ -105,6 +105,7 @@ static void build_streamer(struct chunk *c, int feat, int chance)
 {
     int i, tx, ty;
     int y, x, dir;
+    int stage = gen_stage_enter(GEN_STAGE_STREAMERS);
 
     /* Hack -- Choose starting point */
     y = rand_spread(c->height / 2, 10);
@@ -139,6 +140,7 @@ static void build_streamer(struct chunk *c, int feat, int chance)
 		/* Stop at dungeon edge */
 		if (!square_in_bounds(c, y, x)) break;
     }
+    gen_stage_enter(stage);
 }
 
 
@@ -175,6 +177,7 @@ static void build_tunnel(struct chunk *c, int row1, int col1, int row2, int col2
     int row_dir, col_dir;
     int start_row, start_col;
     int main_loop_count = 0;
+    int stage = gen_stage_enter(GEN_STAGE_TUNNELS);
 
     /* Used to prevent excessive door creation along overlapping corridors. */
     bool door_flag = FALSE;
@@ -349,6 +352,7 @@ static void build_tunnel(struct chunk *c, int row1, int col1, int row2, int col2
 		if (randint0(100) < dun->profile->tun.pen)
 			place_random_door(c, y, x);
     }
+    gen_stage_enter(stage);
 }
 
 /**
@@ -623,8 +627,13 @@ struct chunk *classic_gen(struct player *p) {
     i = z_info->level_monster_min + randint1(8) + k;
 
     /* Put some monsters in the dungeon */
-    for (; i > 0; i--)
+    gen_stage_enter(GEN_STAGE_POPULATE);
+    for (; i > 0 && !gen_level_full(c); i--)
 		pick_and_place_distant_monster(c, loc(p->px, p->py), 0, TRUE, c->depth);
+    gen_stage_enter(GEN_STAGE_OTHER);
+
+    /* Stop here if the level is going to be rejected anyway */
+    if (gen_level_full(c)) return c;
 
     /* Put some objects in rooms */
     alloc_objects(c, SET_ROOM, TYP_OBJECT, Rand_normal(z_info->room_item_av, 3),
@@ -663,6 +672,22 @@ static void lab_get_adjoin(int i, int w, int *a, int *b) {
     }
 }
 
+/**
+ * Find the cell that represents the set a labyrinth cell is in.
+ * \param sets is the union-find forest; each cell points at a cell in the
+ * same set, and representatives point at themselves
+ * \param i is the cell
+ */
+static int lab_find_set(int sets[], int i) {
+    while (sets[i] != i) {
+		/* Halve the path as we go */
+		sets[i] = sets[sets[i]];
+		i = sets[i];
+    }
+
+    return i;
+}
+
 /**
  * Return whether (x, y) is in a tunnel.
  *
@@ -700,7 +725,7 @@ static bool lab_is_tunnel(struct chunk *c, int y, int x) {
  */
 struct chunk *labyrinth_chunk(int depth, int h, int w, bool lit, bool soft)
 {
-    int i, j, k, y, x;
+    int i, j, y, x;
     /* This is the number of squares in the labyrinth */
     int n = h * w;
 
@@ -709,8 +734,9 @@ struct chunk *labyrinth_chunk(int depth, int h, int w, bool lit, bool soft)
      * a lot more complicated, so let's just stick with this because it's
      * easier to read. */
 
-    /* 'sets' tracks connectedness; if sets[i] == sets[j] then cells i and j
-     * are connected to each other in the maze. */
+    /* 'sets' tracks connectedness as a union-find forest; cells i and j are
+     * connected to each other in the maze if lab_find_set() gives the same
+     * result for both. */
     int *sets;
 
     /* 'walls' is a list of wall coordinates which we will randomize */
@@ -769,15 +795,12 @@ struct chunk *labyrinth_chunk(int depth, int h, int w, bool lit, bool soft)
 		lab_get_adjoin(j, w, &a, &b);
 
 		/* If the cells aren't connected, kill the wall and join the sets */
-		if (sets[a] != sets[b]) {
-			int sa = sets[a];
-			int sb = sets[b];
+		a = lab_find_set(sets, a);
+		b = lab_find_set(sets, b);
+		if (a != b) {
 			square_set_feat(c, y + 1, x + 1, FEAT_FLOOR);
 			if (lit) sqinfo_on(c->squares[y + 1][x + 1].info, SQUARE_GLOW);
-
-			for (k = 0; k < n; k++) {
-				if (sets[k] == sb) sets[k] = sa;
-			}
+			sets[b] = a;
 		}
     }
 
@@ -843,6 +866,9 @@ struct chunk *labyrinth_gen(struct player *p) {
 	if (!c) return NULL;
 	c->depth = p->depth;
 
+	/* Monsters can't find their way around without help */
+	c->long_routes = TRUE;
+
     /* Determine the character location */
     new_player_spot(c, p);
 
@@ -867,8 +893,14 @@ struct chunk *labyrinth_gen(struct player *p) {
     alloc_objects(c, SET_BOTH, TYP_TRAP, randint1(k), c->depth, 0);
 
     /* Put some monsters in the dungeon */
-    for (i = z_info->level_monster_min + randint1(8) + k; i > 0; i--)
+    gen_stage_enter(GEN_STAGE_POPULATE);
+    for (i = z_info->level_monster_min + randint1(8) + k;
+		 i > 0 && !gen_level_full(c); i--)
 		pick_and_place_distant_monster(c, loc(p->px, p->py), 0, TRUE, c->depth);
+    gen_stage_enter(GEN_STAGE_OTHER);
+
+    /* Stop here if the level is going to be rejected anyway */
+    if (gen_level_full(c)) return c;
 
     /* Put some objects/gold in the dungeon */
     alloc_objects(c, SET_BOTH, TYP_OBJECT, Rand_normal(k * 6, 2), c->depth,
@@ -913,59 +945,109 @@ static void init_cavern(struct chunk *c, int density) {
 }
 
 /**
- * Return the number of walls (0-8) adjacent to this square.
- * \param c is the current chunk
- * \param y
- * \param x are the co-ordinates
+ * Add one bit-vector of neighbours to a bit-sliced counter.
+ * \param sum is the four bit-planes of the counter, least significant first
+ * \param a says which grids have this neighbour
  */
-static int count_adj_walls(struct chunk *c, int y, int x) {
-    int yd, xd;
-    int count = 0;
-
-    for (yd = -1; yd <= 1; yd++) {
-		for (xd = -1; xd <= 1; xd++) {
-			if (yd == 0 && xd == 0) continue;
-			if (square_isfloor(c, y + yd, x + xd)) continue;
-			count++;
-		}
-    }
-
-    return count;
+static void count_add(u64b sum[4], u64b a)
+{
+	u64b carry0 = sum[0] & a;
+	u64b carry1 = sum[1] & carry0;
+	u64b carry2 = sum[2] & carry1;
+
+	sum[0] ^= a;
+	sum[1] ^= carry0;
+	sum[2] ^= carry1;
+	sum[3] |= carry2;
 }
 
 /**
- * Run a single pass of the cellular automata rules (4,5) on the dungeon.
+ * Run passes of the cellular automata rules (4,5) on the dungeon.
  * \param c is the chunk being mutated
+ * \param times is the number of passes
+ *
+ * Each row is packed into 64-bit words with a bit set for every wall, so
+ * that a pass counts the walls around 64 grids at once.  The chunk itself is
+ * only written after the last pass.
  */
-static void mutate_cavern(struct chunk *c) {
-    int y, x;
-    int h = c->height;
-    int w = c->width;
+static void mutate_cavern(struct chunk *c, int times) {
+	int h = c->height;
+	int w = c->width;
+	int words = (w + 63) / 64;
+	int y, x, i, pass;
+
+	u64b *cur = mem_zalloc(h * words * sizeof(u64b));
+	u64b *next = mem_zalloc(h * words * sizeof(u64b));
+	u64b *inner = mem_zalloc(words * sizeof(u64b));
+
+	/* Pack the walls, and mark the columns each pass may change */
+	for (y = 0; y < h; y++)
+		for (x = 0; x < w; x++)
+			if (!square_isfloor(c, y, x))
+				cur[y * words + x / 64] |= (u64b) 1 << (x % 64);
+	for (x = 1; x < w - 1; x++)
+		inner[x / 64] |= (u64b) 1 << (x % 64);
+
+	for (pass = 0; pass < times; pass++) {
+		u64b *swap;
+
+		/* The top and bottom rows never change */
+		memcpy(next, cur, words * sizeof(u64b));
+		memcpy(next + (h - 1) * words, cur + (h - 1) * words,
+			   words * sizeof(u64b));
+
+		for (y = 1; y < h - 1; y++) {
+			for (i = 0; i < words; i++) {
+				u64b sum[4] = { 0, 0, 0, 0 };
+				u64b more, middle;
+				int dy;
+
+				/* Walls to the west, at, and east of each grid, row by row */
+				for (dy = -1; dy <= 1; dy++) {
+					const u64b *row = cur + (y + dy) * words;
+					u64b west = row[i] << 1;
+					u64b east = row[i] >> 1;
+
+					if (i > 0) west |= row[i - 1] >> 63;
+					if (i < words - 1) east |= row[i + 1] << 63;
+
+					count_add(sum, west);
+					count_add(sum, east);
+					if (dy) count_add(sum, row[i]);
+				}
 
-    int *temp = mem_zalloc(h * w * sizeof(int));
-
-    for (y = 1; y < h - 1; y++) {
-		for (x = 1; x < w - 1; x++) {
-			int count = count_adj_walls(c, y, x);
-			if (count > 5)
-				temp[y * w + x] = FEAT_GRANITE;
-			else if (count < 4)
-				temp[y * w + x] = FEAT_FLOOR;
-			else
-				temp[y * w + x] = c->squares[y][x].feat;
+				/* More than five walls makes a wall, four or five keep it */
+				more = sum[3] | (sum[2] & sum[1]);
+				middle = sum[2] & ~sum[1] & ~sum[3];
+
+				next[y * words + i] = (inner[i] & (more | (middle &
+					cur[y * words + i]))) | (~inner[i] & cur[y * words + i]);
+			}
 		}
-    }
 
-    for (y = 1; y < h - 1; y++) {
-		for (x = 1; x < w - 1; x++) {
-			if (temp[y * w + x] == FEAT_GRANITE)
-				set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
-			else
-				square_set_feat(c, y, x, temp[y * w + x]);
+		swap = cur;
+		cur = next;
+		next = swap;
+	}
+
+	/* Write the result */
+	if (times > 0) {
+		for (y = 1; y < h - 1; y++) {
+			for (x = 1; x < w - 1; x++) {
+				u64b bit = (u64b) 1 << (x % 64);
+				int n = y * words + x / 64;
+
+				if (cur[n] & bit)
+					set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
+				else
+					square_set_feat(c, y, x, FEAT_FLOOR);
+			}
 		}
-    }
+	}
 
-    mem_free(temp);
+	mem_free(inner);
+	mem_free(next);
+	mem_free(cur);
 }
 
 /**
@@ -1011,6 +1093,29 @@ static void glow_point(struct chunk *c, int y, int x) {
 }
 #endif
 
+/**
+ * Find the color that a color has been merged into.
+ * \param counts is the array of current color counts
+ * \param color is the color to look up
+ *
+ * The counts array doubles as a union-find forest: a color still in use holds
+ * its number of cells, and a color merged into another holds minus that
+ * color.  Lookups compress the path they followed.
+ */
+static int region_of(int counts[], int color) {
+    int root = color;
+
+    while (counts[root] < 0) root = -counts[root];
+
+    while (counts[color] < 0) {
+		int next = -counts[color];
+		counts[color] = -root;
+		color = next;
+    }
+
+    return root;
+}
+
 /**
  * Color a particular point, and all adjacent points.
  * \param c is the current chunk
@@ -1020,18 +1125,17 @@ static void glow_point(struct chunk *c, int y, int x) {
  * \param x are the co-ordinates
  * \param color is the color we are coloring
  * \param diagonal controls whether we can progress diagonally
+ * \param queue is an empty queue big enough for the whole chunk
+ * \param added marks the points ever queued; no point is in two regions, so
+ * it can be shared by every region of the chunk
  */
-static void build_color_point(struct chunk *c, int colors[], int counts[], int y, int x, int color, bool diagonal) {
-    int h = c->height;
+static void build_color_point(struct chunk *c, int colors[], int counts[],
+							  int y, int x, int color, bool diagonal,
+							  struct queue *queue, int added[]) {
     int w = c->width;
-    int size = h * w;
-    struct queue *queue = q_new(size);
 
     int dslimit = diagonal ? 8 : 4;
 
-    int *added = mem_zalloc(size * sizeof(int));
-    array_filler(added, 0, size);
-
     q_push_int(queue, yx_to_i(y, x, w));
 
     counts[color] = 0;
@@ -1060,9 +1164,6 @@ static void build_color_point(struct chunk *c, int colors[], int counts[], int y
 			added[n3] = 1;
 		}
     }
-
-    mem_free(added);
-    q_free(queue);
 }
 
 /**
@@ -1077,14 +1178,20 @@ static void build_colors(struct chunk *c, int colors[], int counts[], bool diago
     int h = c->height;
     int w = c->width;
     int color = 1;
+    struct queue *queue = q_new(h * w);
+    int *added = mem_zalloc(h * w * sizeof(int));
 
     for (y = 0; y < h; y++) {
 		for (x = 0; x < w; x++) {
 			if (ignore_point(c, colors, y, x)) continue;
-			build_color_point(c, colors, counts, y, x, color, diagonal);
+			build_color_point(c, colors, counts, y, x, color, diagonal, queue,
+							  added);
 			color++;
 		}
     }
+
+    mem_free(added);
+    q_free(queue);
 }
 
 /**
@@ -1103,7 +1210,7 @@ static void clear_small_regions(struct chunk *c, int colors[], int counts[]) {
     array_filler(deleted, 0, size);
 
     for (i = 0; i < size; i++) {
-		if (counts[i] < 9) {
+		if (counts[i] >= 0 && counts[i] < 9) {
 			deleted[i] = 1;
 			counts[i] = 0;
 		}
@@ -1113,7 +1220,7 @@ static void clear_small_regions(struct chunk *c, int colors[], int counts[]) {
 		for (x = 1; x < c->width - 1; x++) {
 			i = yx_to_i(y, x, w);
 
-			if (!deleted[colors[i]]) continue;
+			if (!deleted[region_of(counts, colors[i])]) continue;
 
 			colors[i] = 0;
 			set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
@@ -1146,18 +1253,15 @@ static int first_color(int counts[], int size) {
 }
 
 /**
- * Find all cells of 'fromcolor' and repaint them to 'tocolor'.
- * \param colors is the array of current point colors
+ * Merge the color 'from' into 'to'; cells keep their old color, which
+ * region_of() now maps to 'to'.
  * \param counts is the array of current color counts
  * \param from is the color to change
  * \param to is the color to change to
- * \param size is the total area
  */
-static void fix_colors(int colors[], int counts[], int from, int to, int size) {
-    int i;
-    for (i = 0; i < size; i++) if (colors[i] == from) colors[i] = to;
+static void fix_colors(int counts[], int from, int to) {
     counts[to] += counts[from];
-    counts[from] = 0;
+    counts[from] = -to;
 }
 
 /**
@@ -1186,9 +1290,14 @@ static void join_region(struct chunk *c, int colors[], int counts[], int color,
     int *previous = mem_zalloc(size * sizeof(int));
     array_filler(previous, -1, size);
 
+    /* Colors may have been merged since the caller looked them up */
+    color = region_of(counts, color);
+    if (new_color != -1)
+		new_color = region_of(counts, new_color);
+
     /* Push all squares of the given color onto the queue */
     for (i = 0; i < size; i++) {
-		if (colors[i] == color) {
+		if (region_of(counts, colors[i]) == color) {
 			q_push_int(queue, i);
 			previous[i] = i;
 		}
@@ -1198,7 +1307,7 @@ static void join_region(struct chunk *c, int colors[], int counts[], int color,
     while (q_len(queue) > 0) {
 		/* Get the current square and its color */
 		int n = q_pop_int(queue);
-		int color2 = colors[n];
+		int color2 = region_of(counts, colors[n]);
 
 		/* If we're not looking for a specific color, any new one will do */
 		if ((new_color == -1) && color2 && (color2 != color))
@@ -1207,7 +1316,7 @@ static void join_region(struct chunk *c, int colors[], int counts[], int color,
 		/* See if we've reached a square with a new color */
 		if (color2 == new_color) {
 			/* Step backward through the path, turning stone to tunnel */
-			while (colors[n] != color) {
+			while (region_of(counts, colors[n]) != color) {
 				int x, y;
 				i_to_yx(n, w, &y, &x);
 				colors[n] = color;
@@ -1218,7 +1327,7 @@ static void join_region(struct chunk *c, int colors[], int counts[], int color,
 			}
 
 			/* Update the color mapping to combine the two colors */
-			fix_colors(colors, counts, color2, color, size);
+			fix_colors(counts, color2, color);
 
 			/* We're done now */
 			break;
@@ -1306,7 +1415,6 @@ void ensure_connectedness(struct chunk *c) {
  */
 struct chunk *cavern_chunk(int depth, int h, int w)
 {
-    int i;
     int size = h * w;
     int limit = size / 13;
     int density = rand_range(25, 40);
@@ -1327,7 +1435,7 @@ struct chunk *cavern_chunk(int depth, int h, int w)
 	for (tries = 0; tries < MAX_CAVERN_TRIES; tries++) {
 		/* Build a random cavern and mutate it a number of times */
 		init_cavern(c, density);
-		for (i = 0; i < times; i++) mutate_cavern(c);
+		mutate_cavern(c, times);
 
 		/* If there are enough open squares then we're done */
 		if (c->feat_count[FEAT_FLOOR] >= limit) {
@@ -1378,6 +1486,9 @@ struct chunk *cavern_gen(struct player *p) {
     }
 	c->depth = p->depth;
 
+	/* Monsters can't find their way around without help */
+	c->long_routes = TRUE;
+
 	/* Surround the level with perma-rock */
     draw_rectangle(c, 0, 0, h - 1, w - 1, FEAT_PERM, SQUARE_NONE);
 
@@ -1403,8 +1514,13 @@ struct chunk *cavern_gen(struct player *p) {
 	new_player_spot(c, p);
 
 	/* Put some monsters in the dungeon */
-	for (i = randint1(8) + k; i > 0; i--)
+	gen_stage_enter(GEN_STAGE_POPULATE);
+	for (i = randint1(8) + k; i > 0 && !gen_level_full(c); i--)
 		pick_and_place_distant_monster(c, loc(p->px, p->py), 0, TRUE, c->depth);
+	gen_stage_enter(GEN_STAGE_OTHER);
+
+	/* Stop here if the level is going to be rejected anyway */
+	if (gen_level_full(c)) return c;
 
 	/* Put some objects/gold in the dungeon */
 	alloc_objects(c, SET_BOTH, TYP_OBJECT, Rand_normal(k, 2), c->depth + 5,
@@ -1586,9 +1702,11 @@ struct chunk *town_gen(struct player *p)
 	cave_illuminate(c_new, is_daytime());
 
 	/* Make some residents */
+	gen_stage_enter(GEN_STAGE_POPULATE);
 	for (i = 0; i < residents; i++)
 		pick_and_place_distant_monster(c_new, loc(p->px, p->py), 3, TRUE,
 									   c_new->depth);
+	gen_stage_enter(GEN_STAGE_OTHER);
 
 	return c_new;
 }
@@ -1808,8 +1926,13 @@ struct chunk *modified_gen(struct player *p) {
 	mon_restrict(NULL, c->depth, TRUE);
 
     /* Put some monsters in the dungeon */
-    for (; i > 0; i--)
+    gen_stage_enter(GEN_STAGE_POPULATE);
+    for (; i > 0 && !gen_level_full(c); i--)
 		pick_and_place_distant_monster(c, loc(p->px, p->py), 0, TRUE, c->depth);
+    gen_stage_enter(GEN_STAGE_OTHER);
+
+    /* Stop here if the level is going to be rejected anyway */
+    if (gen_level_full(c)) return c;
 
     /* Put some objects in rooms */
     alloc_objects(c, SET_ROOM, TYP_OBJECT, Rand_normal(z_info->room_item_av, 3),
@@ -2032,8 +2155,13 @@ struct chunk *moria_gen(struct player *p) {
 	mon_restrict("Moria dwellers", c->depth, TRUE);
 
     /* Put some monsters in the dungeon */
-    for (; i > 0; i--)
+    gen_stage_enter(GEN_STAGE_POPULATE);
+    for (; i > 0 && !gen_level_full(c); i--)
 		pick_and_place_distant_monster(c, loc(p->px, p->py), 0, TRUE, c->depth);
+    gen_stage_enter(GEN_STAGE_OTHER);
+
+    /* Stop here if the level is going to be rejected anyway */
+    if (gen_level_full(c)) return c;
 
     /* Put some objects in rooms */
     alloc_objects(c, SET_ROOM, TYP_OBJECT, Rand_normal(z_info->room_item_av, 3),
@@ -2246,8 +2374,13 @@ struct chunk *hard_centre_gen(struct player *p)
 	new_player_spot(c, p);
 
 	/* Put some monsters in the dungeon */
-	for (i = randint1(8) + k; i > 0; i--)
+	gen_stage_enter(GEN_STAGE_POPULATE);
+	for (i = randint1(8) + k; i > 0 && !gen_level_full(c); i--)
 		pick_and_place_distant_monster(c, loc(p->px, p->py), 0, TRUE, c->depth);
+	gen_stage_enter(GEN_STAGE_OTHER);
+
+	/* Stop here if the level is going to be rejected anyway */
+	if (gen_level_full(c)) return c;
 
 	/* Put some objects/gold in the dungeon */
 	alloc_objects(c, SET_BOTH, TYP_OBJECT, Rand_normal(k, 2), c->depth + 5,
@@ -2298,9 +2431,11 @@ struct chunk *lair_gen(struct player *p) {
     i = randint1(4) + k;
 
     /* Put some monsters in the dungeon */
+    gen_stage_enter(GEN_STAGE_POPULATE);
     for (; i > 0; i--)
 		pick_and_place_distant_monster(normal, loc(p->px, p->py), 0, TRUE,
 									   normal->depth);
+    gen_stage_enter(GEN_STAGE_OTHER);
 
     /* Add some magma streamers */
     for (i = 0; i < dun->profile->str.mag; i++)
@@ -2459,17 +2594,21 @@ struct chunk *gauntlet_gen(struct player *p) {
 	i = z_info->level_monster_min + randint1(4) + k;
 
 	/* Place the monsters */
+	gen_stage_enter(GEN_STAGE_POPULATE);
 	for (; i > 0; i--)
 		pick_and_place_distant_monster(arrival, loc(p->px, p->py), 0, TRUE,
 									   arrival->depth);
+	gen_stage_enter(GEN_STAGE_OTHER);
 
 	/* Pick some of monsters for the departure cavern */
 	i = z_info->level_monster_min + randint1(4) + k;
 
 	/* Place the monsters */
+	gen_stage_enter(GEN_STAGE_POPULATE);
 	for (; i > 0; i--)
 		pick_and_place_distant_monster(departure, loc(p->px, p->py), 0, TRUE,
 									   departure->depth);
+	gen_stage_enter(GEN_STAGE_OTHER);
 
 	/* Pick a larger number of monsters for the gauntlet */
 	i = (z_info->level_monster_min + randint1(6) + k);
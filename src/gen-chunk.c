@@ -25,9 +25,12 @@
 
 #include "angband.h"
 #include "cave.h"
+#include "game-world.h"
 #include "generate.h"
 #include "init.h"
 #include "mon-make.h"
+#include "mon-move.h"
+#include "obj-tval.h"
 #include "obj-util.h"
 #include "trap.h"
 
@@ -35,6 +38,65 @@
 struct chunk **chunk_list;     /**< list of pointers to saved chunks */
 u16b chunk_list_max = 0;      /**< current max actual chunk index */
 
+/**
+ * Open-addressed hash of chunk names; each slot holds a chunk_list index
+ * plus one, or zero if empty.  Kept at most half full.
+ */
+static u16b *chunk_index;
+static int chunk_index_size = 0;
+
+/**
+ * Hash a chunk name (djb2)
+ */
+static u32b chunk_name_hash(const char *name)
+{
+	u32b hash = 5381;
+
+	while (*name)
+		hash = hash * 33 + (byte) *name++;
+
+	return hash;
+}
+
+/**
+ * Find the index slot for a name: the slot holding it, or the empty slot
+ * where it would go
+ */
+static int chunk_index_slot(const char *name)
+{
+	int slot = chunk_name_hash(name) & (chunk_index_size - 1);
+
+	while (chunk_index[slot] &&
+		   strcmp(name, chunk_list[chunk_index[slot] - 1]->name))
+		slot = (slot + 1) & (chunk_index_size - 1);
+
+	return slot;
+}
+
+/**
+ * Rebuild the name index from the chunk list, growing it if necessary
+ */
+static void chunk_index_rebuild(void)
+{
+	int i;
+
+	if (chunk_index_size < 2 * chunk_list_max) {
+		while (chunk_index_size < 2 * chunk_list_max)
+			chunk_index_size = chunk_index_size ? chunk_index_size * 2 : 16;
+		mem_free(chunk_index);
+		chunk_index = mem_zalloc(chunk_index_size * sizeof(u16b));
+	} else if (chunk_index) {
+		memset(chunk_index, 0, chunk_index_size * sizeof(u16b));
+	}
+
+	/* The first chunk with a given name is the one that is found */
+	for (i = 0; i < chunk_list_max; i++) {
+		int slot = chunk_index_slot(chunk_list[i]->name);
+		if (!chunk_index[slot])
+			chunk_index[slot] = i + 1;
+	}
+}
+
 /**
  * Write a chunk to memory and return a pointer to it.  Optionally write
  * monsters, objects and/or traps, and in those cases delete those things from
@@ -60,6 +122,7 @@ struct chunk *chunk_write(int y0, int x0, int height, int width, bool monsters,
 		for (x = 0; x < width; x++) {
 			/* Terrain */
 			new->squares[y][x].feat = cave->squares[y0 + y][x0 + x].feat;
+			square_update_planes(new, y, x);
 			sqinfo_copy(new->squares[y][x].info,
 						cave->squares[y0 + y][x0 + x].info);
 
@@ -68,10 +131,14 @@ struct chunk *chunk_write(int y0, int x0, int height, int width, bool monsters,
 				struct object *obj = square_object(cave, y0 + y, x0 + x);
 				if (obj) {
 					new->squares[y][x].obj = obj;
+					cave_object_cell(new, y, x, TRUE);
 					while (obj) {
 						/* Adjust stuff */
 						obj->iy = y;
 						obj->ix = x;
+						if (tval_can_have_timeout(obj) && obj->timeout)
+							cave_object_charging(new, y, x);
+						obj = obj->next;
 					}
 				}
 			}
@@ -87,14 +154,21 @@ struct chunk *chunk_write(int y0, int x0, int height, int width, bool monsters,
 					if (!source_mon->race)
 						continue;
 
-					/* Copy over */
-					new->squares[y][x].mon = ++new->mon_cnt;
+					/* Copy over, with its energy and hitpoints up to date */
+					monster_settle_energy(source_mon);
+					monster_settle_regen(source_mon);
+					square_set_mon(new, y, x, ++new->mon_cnt);
 					dest_mon = cave_monster(new, new->mon_cnt);
 					memcpy(dest_mon, source_mon, sizeof(*source_mon));
+					cave_monster_known_copy(new, new->mon_cnt, cave,
+											source_mon->midx);
 
 					/* Adjust position */
+					dest_mon->midx = new->mon_cnt;
 					dest_mon->fy = y;
 					dest_mon->fx = x;
+					cave_monster_light(new, dest_mon, y, x, TRUE);
+					cave_monster_cell(new, dest_mon, y, x, TRUE);
 
 					/* Held objects */
 					if (objects && source_mon->held_obj)
@@ -123,13 +197,18 @@ struct chunk *chunk_write(int y0, int x0, int height, int width, bool monsters,
 
 /**
  * Add an entry to the chunk list - any problems with the length of this will
- * be more in the memory used by the chunks themselves rather than the list
+ * be more in the memory used by the chunks themselves rather than the list.
+ * Chunks stored without monsters give up their monster list and other
+ * state that is only used in play.
  * \param c the chunk being added to the list
  */
 void chunk_list_add(struct chunk *c)
 {
 	int newsize = (chunk_list_max + CHUNK_LIST_INCR) *	sizeof(struct chunk *);
 
+	if (cave_monster_max(c) <= 1)
+		cave_shrink(c);
+
 	/* Lengthen the list if necessary */
 	if (chunk_list_max == 0)
 		chunk_list = mem_zalloc(newsize);
@@ -138,6 +217,15 @@ void chunk_list_add(struct chunk *c)
 
 	/* Add the new one */
 	chunk_list[chunk_list_max++] = c;
+
+	/* Index it */
+	if (chunk_index_size < 2 * chunk_list_max) {
+		chunk_index_rebuild();
+	} else {
+		int slot = chunk_index_slot(c->name);
+		if (!chunk_index[slot])
+			chunk_index[slot] = chunk_list_max;
+	}
 }
 
 /**
@@ -147,30 +235,34 @@ void chunk_list_add(struct chunk *c)
  */
 bool chunk_list_remove(char *name)
 {
-	int i, j;
-	int newsize = 0;
-
-	for (i = 0; i < chunk_list_max; i++) {
-		/* Find the match */
-		if (!strcmp(name, chunk_list[i]->name)) {
-			/* Copy all the succeeding ones back one */
-			for (j = i + 1; j < chunk_list_max; j++)
-				chunk_list[j - 1] = chunk_list[j];
-
-			/* Destroy the last one, and shorten the list */
-			if ((chunk_list_max % CHUNK_LIST_INCR) == 0)
-				newsize = (chunk_list_max - CHUNK_LIST_INCR) *	
-					sizeof(struct chunk *);
-			chunk_list_max--;
-			chunk_list[chunk_list_max] = NULL;
-			if (newsize)
-				chunk_list = (struct chunk **) mem_realloc(chunk_list, newsize);
-
-			return TRUE;
-		}
+	int i, j, slot;
+
+	if (!chunk_list_max) return FALSE;
+
+	/* Find the match */
+	slot = chunk_index_slot(name);
+	if (!chunk_index[slot]) return FALSE;
+	i = chunk_index[slot] - 1;
+
+	/* Copy all the succeeding ones back one */
+	for (j = i + 1; j < chunk_list_max; j++)
+		chunk_list[j - 1] = chunk_list[j];
+
+	/* Destroy the last one, and shorten the list to what adding needs */
+	chunk_list_max--;
+	chunk_list[chunk_list_max] = NULL;
+	if (!chunk_list_max) {
+		mem_free(chunk_list);
+		chunk_list = NULL;
+	} else if ((chunk_list_max % CHUNK_LIST_INCR) == 0) {
+		chunk_list = (struct chunk **) mem_realloc(chunk_list,
+								chunk_list_max * sizeof(struct chunk *));
 	}
 
-	return FALSE;
+	/* Later chunks have moved down */
+	chunk_index_rebuild();
+
+	return TRUE;
 }
 
 /**
@@ -179,14 +271,31 @@ bool chunk_list_remove(char *name)
  * \return the pointer to the chunk
  */
 struct chunk *chunk_find_name(char *name)
+{
+	int slot;
+
+	if (!chunk_list_max) return NULL;
+
+	slot = chunk_index_slot(name);
+	return chunk_index[slot] ? chunk_list[chunk_index[slot] - 1] : NULL;
+}
+
+/**
+ * Free all the chunks in the chunk list, and the list itself
+ */
+void chunk_list_free(void)
 {
 	int i;
 
 	for (i = 0; i < chunk_list_max; i++)
-		if (!strcmp(name, chunk_list[i]->name))
-			return chunk_list[i];
-
-	return NULL;
+		cave_free(chunk_list[i]);
+	mem_free(chunk_list);
+	chunk_list = NULL;
+	chunk_list_max = 0;
+
+	mem_free(chunk_index);
+	chunk_index = NULL;
+	chunk_index_size = 0;
 }
 
 /**
@@ -239,7 +348,7 @@ void symmetry_transform(int *y, int *x, int y0, int x0, int height, int width,
 
 /**
  * Write a chunk, transformed, to a given offset in another chunk.  Note that
- * objects are copied from the old chunk and not retained there
+ * objects and traps are moved from the old chunk and not retained there
  * \param dest the chunk where the copy is going
  * \param source the chunk being copied
  * \param y0
@@ -254,6 +363,7 @@ bool chunk_copy(struct chunk *dest, struct chunk *source, int y0, int x0,
 	int i;
 	int y, x;
 	int h = source->height, w = source->width;
+	int row_y, row_x, step_y, step_x, col_y, col_x;
 
 	/* Check bounds */
 	if (rotate % 1) {
@@ -264,29 +374,55 @@ bool chunk_copy(struct chunk *dest, struct chunk *source, int y0, int x0,
 			return FALSE;
 	}
 
+	/* The transform is affine, so find where the first grid goes and how
+	 * moving along a source row or down a source column moves in dest */
+	row_y = 0;
+	row_x = 0;
+	symmetry_transform(&row_y, &row_x, y0, x0, h, w, rotate, reflect);
+	step_y = 0;
+	step_x = 1;
+	symmetry_transform(&step_y, &step_x, y0, x0, h, w, rotate, reflect);
+	step_y -= row_y;
+	step_x -= row_x;
+	col_y = 1;
+	col_x = 0;
+	symmetry_transform(&col_y, &col_x, y0, x0, h, w, rotate, reflect);
+	col_y -= row_y;
+	col_x -= row_x;
+
 	/* Write the location stuff */
-	for (y = 0; y < h; y++) {
+	for (y = 0; y < h; y++, row_y += col_y, row_x += col_x) {
+		int dest_y = row_y - step_y;
+		int dest_x = row_x - step_x;
+
 		for (x = 0; x < w; x++) {
 			/* Work out where we're going */
-			int dest_y = y;
-			int dest_x = x;
-			symmetry_transform(&dest_y, &dest_x, y0, x0, h, w, rotate, reflect);
+			dest_y += step_y;
+			dest_x += step_x;
 
 			/* Terrain */
 			dest->squares[dest_y][dest_x].feat = source->squares[y][x].feat;
+			square_update_planes(dest, dest_y, dest_x);
 			sqinfo_copy(dest->squares[dest_y][dest_x].info,
 						source->squares[y][x].info);
 
 			/* Dungeon objects */
 			if (square_object(source, y, x)) {
 				struct object *obj;
+				if (!square_object(dest, dest_y, dest_x))
+					cave_object_cell(dest, dest_y, dest_x, TRUE);
 				dest->squares[dest_y][dest_x].obj = square_object(source, y, x);
 
 				for (obj = square_object(source, y, x); obj; obj = obj->next) {
 					/* Adjust position */
 					obj->iy = dest_y;
 					obj->ix = dest_x;
+					if (tval_can_have_timeout(obj) && obj->timeout)
+						cave_object_charging(dest, dest_y, dest_x);
 				}
+
+				/* The pile now belongs to the destination */
+				source->squares[y][x].obj = NULL;
 			}
 
 			/* Monsters */
@@ -308,13 +444,19 @@ bool chunk_copy(struct chunk *dest, struct chunk *source, int y0, int x0,
 
 				/* Copy over */
 				dest_mon = cave_monster(dest, idx);
-				dest->squares[dest_y][dest_x].mon = idx;
+				square_set_mon(dest, dest_y, dest_x, idx);
 				memcpy(dest_mon, source_mon, sizeof(*source_mon));
+				cave_monster_known_copy(dest, idx, source, source_mon->midx);
 
-				/* Adjust stuff */
+				/* Adjust stuff; nothing is gained while stored */
 				dest_mon->midx = idx;
+				dest_mon->energy_turn = turn - 1;
+				dest_mon->regen_turn = turn;
+				monster_reschedule(dest, dest_mon);
 				dest_mon->fy = dest_y;
 				dest_mon->fx = dest_x;
+				cave_monster_light(dest, dest_mon, dest_y, dest_x, TRUE);
+				cave_monster_cell(dest, dest_mon, dest_y, dest_x, TRUE);
 
 				/* Held objects */
 				if (source_mon->held_obj)
@@ -324,7 +466,8 @@ bool chunk_copy(struct chunk *dest, struct chunk *source, int y0, int x0,
 			/* Traps */
 			if (source->squares[y][x].trap) {
 				struct trap *trap = source->squares[y][x].trap;
-				dest->squares[y][x].trap = trap;
+				dest->squares[dest_y][dest_x].trap = trap;
+				source->squares[y][x].trap = NULL;
 
 				/* Traverse the trap list */
 				while (trap) {
@@ -337,10 +480,14 @@ bool chunk_copy(struct chunk *dest, struct chunk *source, int y0, int x0,
 
 			/* Player */
 			if (source->squares[y][x].mon == -1) 
-				dest->squares[dest_y][dest_x].mon = -1;
+				square_set_mon(dest, dest_y, dest_x, -1);
 		}
 	}
 
+	/* Anything cached about the destination is out of date */
+	cave_terrain_stamp++;
+	cave_occupant_stamp++;
+
 	/* Miscellany */
 	for (i = 0; i < z_info->f_max + 1; i++)
 		dest->feat_count[i] += source->feat_count[i];
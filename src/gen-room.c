@@ -40,6 +40,7 @@
 #include "parser.h"
 #include "trap.h"
 #include "z-queue.h"
+#include "z-trace.h"
 #include "z-type.h"
 
 /**
@@ -70,17 +71,13 @@ struct room_template *random_room_template(int typ)
  */
 struct vault *random_vault(int depth, const char *typ)
 {
-	struct vault *v = vaults;
+	int i, num;
+	struct vault **list = vaults_allowed(depth, typ, &num);
 	struct vault *r = NULL;
-	int n = 1;
-	do {
-		if (streq(v->typ, typ) && (v->min_lev <= depth)
-			&& (v->max_lev >= depth)) {
-			if (one_in_(n)) r = v;
-			n++;
-		}
-		v = v->next;
-	} while(v);
+
+	for (i = 0; i < num; i++)
+		if (one_in_(i + 1)) r = list[i];
+
 	return r;
 }
 
@@ -2961,8 +2958,8 @@ bool build_huge(struct chunk *c, int y0, int x0)
  * Note that we restrict the number of pits/nests to reduce
  * the chance of overflowing the monster list during level creation.
  */
-bool room_build(struct chunk *c, int by0, int bx0, struct room_profile profile,
-	bool finds_own_space)
+static bool room_build_aux(struct chunk *c, int by0, int bx0,
+	struct room_profile profile, bool finds_own_space)
 {
 	/* Extract blocks */
 	int by1 = by0;
@@ -3029,3 +3026,19 @@ bool room_build(struct chunk *c, int by0, int bx0, struct room_profile profile,
 	/* Success */
 	return TRUE;
 }
+
+/**
+ * Attempt to build a room, charging the time taken to room building
+ */
+bool room_build(struct chunk *c, int by0, int bx0, struct room_profile profile,
+	bool finds_own_space)
+{
+	int stage = gen_stage_enter(GEN_STAGE_ROOMS);
+	bool built;
+
+	TRACE(profile.name,
+		  built = room_build_aux(c, by0, bx0, profile, finds_own_space));
+
+	gen_stage_enter(stage);
+	return built;
+}
@@ -147,6 +147,17 @@ void shuffle(int *arr, int n)
 }
 
 
+/**
+ * Scratch space for _find_in_range()'s shuffle, kept between calls.  An entry
+ * of find_order is only meaningful if its find_stamp matches find_pass;
+ * otherwise the entry still holds its own index, so the array never needs
+ * filling in before a search.
+ */
+static int *find_order;
+static u32b *find_stamp;
+static u32b find_pass;
+static int find_size;
+
 /**
  * Locate a square in y1 <= y < y2, x1 <= x < x2 which satisfies the given
  * predicate.
@@ -166,28 +177,51 @@ static bool _find_in_range(struct chunk *c, int *y, int y1, int y2, int *x,
     int yd = y2 - y1;
     int xd = x2 - x1;
     int i, n = yd * xd;
-    bool found = FALSE;
 
-    /* Allocate the squares, and randomize their order */
-    int *squares = mem_alloc(n * sizeof(int));
-    for (i = 0; i < n; i++) squares[i] = i;
+    if (yd <= 0 || xd <= 0) return FALSE;
+
+    /* Make room, and start a new pass so every entry reads as untouched */
+    if (n > find_size) {
+		mem_free(find_order);
+		mem_free(find_stamp);
+		find_order = mem_alloc(n * sizeof(int));
+		find_stamp = mem_zalloc(n * sizeof(u32b));
+		find_size = n;
+		find_pass = 0;
+    }
+    if (++find_pass == 0) {
+		memset(find_stamp, 0, find_size * sizeof(u32b));
+		find_pass = 1;
+    }
 
     /* Test each square in (random) order for openness */
-    for (i = 0; i < n && !found; i++) {
+    for (i = 0; i < n; i++) {
 		int j = randint0(n - i) + i;
-		int k = squares[j];
-		squares[j] = squares[i];
-		squares[i] = k;
+		int k = find_stamp[j] == find_pass ? find_order[j] : j;
+
+		/* Swap entry i into slot j; entry i is never looked at again */
+		find_order[j] = find_stamp[i] == find_pass ? find_order[i] : i;
+		find_stamp[j] = find_pass;
 
 		*y = (k / xd) + y1;
 		*x = (k % xd) + x1;
-		if (pred(c, *y, *x)) found = TRUE;
+		if (pred(c, *y, *x)) return TRUE;
     }
 
-	mem_free(squares);
+    /* We didn't find a square */
+    return FALSE;
+}
 
-    /* Return whether we found an empty square or not. */
-    return found;
+/**
+ * Free the scratch space used for finding squares
+ */
+void cave_find_cleanup(void)
+{
+	mem_free(find_order);
+	mem_free(find_stamp);
+	find_order = NULL;
+	find_stamp = NULL;
+	find_size = 0;
 }
 
 
@@ -546,6 +580,7 @@ void place_random_door(struct chunk *c, int y, int x)
 void alloc_stairs(struct chunk *c, int feat, int num, int walls)
 {
     int y, x, i, j, done;
+    int stage = gen_stage_enter(GEN_STAGE_POPULATE);
 
     /* Place "num" stairs */
     for (i = 0; i < num; i++) {
@@ -565,6 +600,7 @@ void alloc_stairs(struct chunk *c, int feat, int num, int walls)
 			if (walls) walls--;
 		}
     }
+    gen_stage_enter(stage);
 }
 
 
@@ -582,10 +618,12 @@ void alloc_stairs(struct chunk *c, int feat, int num, int walls)
 void alloc_objects(struct chunk *c, int set, int typ, int num, int depth, byte origin)
 {
     int k, l = 0;
+    int stage = gen_stage_enter(GEN_STAGE_POPULATE);
     for (k = 0; k < num; k++) {
 		bool ok = alloc_object(c, set, typ, depth, origin);
 		if (!ok) l++;
     }
+    gen_stage_enter(stage);
 }
 
 
@@ -632,6 +670,51 @@ bool alloc_object(struct chunk *c, int set, int typ, int depth, byte origin)
     return TRUE;
 }
 
+/**
+ * Make the objects and gold that the classic profile scatters over a level
+ * at 'depth', with the same calls and distributions, but without a level to
+ * put them in.  Each one is handed to 'take', which then owns it.
+ * \param depth generation depth
+ * \param take what to do with each object
+ * \param data passed on to 'take'
+ * \return how many objects were made
+ *
+ * Vaults, special rooms and monster drops aren't included; the player's
+ * depth should be 'depth', as it would be on the level.
+ */
+int sample_floor_objects(int depth,
+						 void (*take)(struct object *obj, void *data),
+						 void *data)
+{
+	int room = Rand_normal(z_info->room_item_av, 3);
+	int both = Rand_normal(z_info->both_item_av, 3);
+	int gold = Rand_normal(z_info->both_gold_av, 3);
+	int items = MAX(room, 0) + MAX(both, 0);
+	int made = 0;
+
+	while (items-- > 0) {
+		struct object *obj = make_object(NULL, depth, FALSE, FALSE, FALSE,
+										 NULL, 0);
+		if (!obj) continue;
+
+		obj->origin = ORIGIN_FLOOR;
+		obj->origin_depth = depth;
+		take(obj, data);
+		made++;
+	}
+
+	while (gold-- > 0) {
+		struct object *money = make_gold(depth, "any");
+
+		money->origin = ORIGIN_FLOOR;
+		money->origin_depth = depth;
+		take(money, data);
+		made++;
+	}
+
+	return made;
+}
+
 /**
  * Create up to 'num' objects near the given coordinates in a vault.
  * \param c the current chunk
@@ -738,4 +821,12 @@ void vault_monsters(struct chunk *c, int y1, int x1, int depth, int num)
     }
 }
 
-
+/**
+ * Check whether a chunk has used up its monster list.  cave_generate()
+ * rejects such levels, so builders can stop populating them at once.
+ * \param c the current chunk
+ */
+bool gen_level_full(struct chunk *c)
+{
+	return cave_monster_max(c) >= z_info->level_monster_max;
+}
@@ -38,12 +38,14 @@
 #include "mon-make.h"
 #include "mon-spell.h"
 #include "monster.h"
+#include "obj-pile.h"
 #include "obj-tval.h"
 #include "obj-util.h"
 #include "object.h"
 #include "parser.h"
 #include "trap.h"
 #include "z-queue.h"
+#include "z-trace.h"
 #include "z-type.h"
 
 /*
@@ -53,6 +55,73 @@ struct pit_profile *pit_info;
 struct vault *vaults;
 struct cave_profile *cave_profiles;
 
+/**
+ * Counts of generation attempts and rejections
+ */
+struct gen_stats gen_stats;
+
+/**
+ * Time spent in each stage of generation, for benchmarking
+ */
+struct gen_timing gen_timing;
+
+/**
+ * Profile to use for every dungeon level instead of a random one, if set
+ */
+const struct cave_profile *gen_force_profile;
+
+/**
+ * Generation context reused from level to level
+ */
+static struct dun_data *dun_scratch;
+
+/**
+ * Allocate a generation context, with scratch buffers at their maximum sizes
+ * so that no builder needs to grow them
+ */
+static struct dun_data *dun_data_new(void)
+{
+	struct dun_data *d = mem_zalloc(sizeof(*d));
+
+	d->cent = mem_zalloc(z_info->level_room_max * sizeof(struct loc));
+	d->door = mem_zalloc(z_info->level_door_max * sizeof(struct loc));
+	d->wall = mem_zalloc(z_info->wall_pierce_max * sizeof(struct loc));
+	d->tunn = mem_zalloc(z_info->tunn_grid_max * sizeof(struct loc));
+
+	return d;
+}
+
+/**
+ * Make a generation context ready for a new level, keeping its buffers
+ */
+static void dun_data_reset(struct dun_data *d)
+{
+	d->profile = NULL;
+	d->cent_n = 0;
+	d->door_n = 0;
+	d->wall_n = 0;
+	d->tunn_n = 0;
+	d->block_hgt = 0;
+	d->block_wid = 0;
+	d->row_blocks = 0;
+	d->col_blocks = 0;
+	d->room_map = NULL;
+	d->pit_num = 0;
+	d->pit_type = NULL;
+}
+
+/**
+ * Free a generation context and its buffers
+ */
+static void dun_data_free(struct dun_data *d)
+{
+	mem_free(d->cent);
+	mem_free(d->door);
+	mem_free(d->wall);
+	mem_free(d->tunn);
+	mem_free(d);
+}
+
 
 static const struct {
 	const char *name;
@@ -563,15 +632,89 @@ static errr run_parse_vault(struct parser *p) {
 	return parse_file(p, "vault");
 }
 
+/**
+ * Vaults of one type, listed by the depths at which they can appear
+ */
+struct vault_group {
+	const char *typ;			/*!< Vault type */
+	int num[256];				/*!< Number of vaults allowed at each depth */
+	struct vault **list[256];	/*!< Those vaults, in vault list order */
+};
+
+static struct vault_group *vault_groups;
+static int vault_group_count;
+
+/**
+ * Sort the vaults into groups, so random_vault() only looks at candidates
+ */
+static void group_vaults(void)
+{
+	struct vault *v;
+	int i, depth;
+
+	for (v = vaults; v; v = v->next) {
+		/* Find or add the group for this type */
+		for (i = 0; i < vault_group_count; i++)
+			if (streq(vault_groups[i].typ, v->typ)) break;
+		if (i == vault_group_count) {
+			vault_groups = mem_realloc(vault_groups,
+				(vault_group_count + 1) * sizeof(*vault_groups));
+			memset(&vault_groups[i], 0, sizeof(*vault_groups));
+			vault_groups[i].typ = v->typ;
+			vault_group_count++;
+		}
+
+		for (depth = v->min_lev; depth <= v->max_lev; depth++) {
+			struct vault_group *g = &vault_groups[i];
+			g->list[depth] = mem_realloc(g->list[depth],
+				(g->num[depth] + 1) * sizeof(struct vault *));
+			g->list[depth][g->num[depth]++] = v;
+		}
+	}
+}
+
+/**
+ * Get the vaults of a given type allowed at a given depth.
+ * \param depth is the depth being generated
+ * \param typ is the vault type
+ * \param num is set to the number of vaults
+ * \return the vaults, in vault list order
+ */
+struct vault **vaults_allowed(int depth, const char *typ, int *num)
+{
+	int i;
+
+	*num = 0;
+	if (depth < 0 || depth > 255) return NULL;
+
+	for (i = 0; i < vault_group_count; i++) {
+		if (!streq(vault_groups[i].typ, typ)) continue;
+		*num = vault_groups[i].num[depth];
+		return vault_groups[i].list[depth];
+	}
+
+	return NULL;
+}
+
 static errr finish_parse_vault(struct parser *p) {
 	vaults = parser_priv(p);
 	parser_destroy(p);
+	group_vaults();
 	return 0;
 }
 
 static void cleanup_vault(void)
 {
 	struct vault *v, *next;
+	int i, depth;
+
+	for (i = 0; i < vault_group_count; i++)
+		for (depth = 0; depth < 256; depth++)
+			mem_free(vault_groups[i].list[depth]);
+	mem_free(vault_groups);
+	vault_groups = NULL;
+	vault_group_count = 0;
+
 	for (v = vaults; v; v = next) {
 		next = v->next;
 		mem_free(v->name);
@@ -617,6 +760,14 @@ static void cleanup_template_parser(void)
 	cleanup_parser(&profile_parser);
 	cleanup_parser(&room_parser);
 	cleanup_parser(&vault_parser);
+	cave_find_cleanup();
+
+	if (dun_scratch) {
+		if (dun == dun_scratch)
+			dun = NULL;
+		dun_data_free(dun_scratch);
+		dun_scratch = NULL;
+	}
 }
 
 
@@ -658,6 +809,9 @@ static void place_feeling(struct chunk *c)
 /**
  * Calculate the level feeling for objects.
  * \param c is the cave where the feeling is being measured
+ *
+ * This only reads the rating accumulated by place_object() during
+ * generation; it never rescans the level.
  */
 static int calc_obj_feeling(struct chunk *c)
 {
@@ -689,6 +843,9 @@ static int calc_obj_feeling(struct chunk *c)
 /**
  * Calculate the level feeling for monsters.
  * \param c is the cave where the feeling is being measured
+ *
+ * As for objects, the rating is accumulated as monsters, pits, nests and
+ * vaults are placed.
  */
 static int calc_mon_feeling(struct chunk *c)
 {
@@ -740,6 +897,26 @@ bool labyrinth_check(int depth)
 	return TRUE;
 }
 
+/**
+ * Charge the time since the last change of stage to that stage, and start
+ * charging 'stage' instead.  Returns the previous stage so that callers can
+ * go back to it when they finish.  Does nothing unless gen_timing.on is set.
+ */
+int gen_stage_enter(int stage)
+{
+	int old = gen_timing.stage;
+	clock_t now;
+
+	if (!gen_timing.on) return old;
+
+	now = clock();
+	gen_timing.ticks[old] += now - gen_timing.since;
+	gen_timing.since = now;
+	gen_timing.stage = stage;
+
+	return old;
+}
+
 /**
  * Find a cave_profile by name
  * \param name is the name of the cave_profile being looked for
@@ -783,6 +960,9 @@ const struct cave_profile *choose_profile(int depth)
 		if (profile) return profile;
 	}
 
+	/* Benchmarks may ask for a single profile throughout */
+	if (depth && gen_force_profile) return gen_force_profile;
+
 	/* Make the profile choice */
 	if (depth == 0)
 		profile = find_cave_profile("town");
@@ -809,6 +989,25 @@ const struct cave_profile *choose_profile(int depth)
 	return NULL;
 }
 
+/**
+ * Throw away a level that was built but could not be used, putting back the
+ * monsters it used up so they can appear on the next try.
+ */
+static void cave_discard(struct chunk *c, struct player *p)
+{
+	int i;
+
+	for (i = 1; i < cave_monster_max(c); i++) {
+		struct monster *mon = cave_monster(c, i);
+		if (mon->race && mon->held_obj) {
+			object_pile_free(mon->held_obj);
+			mon->held_obj = NULL;
+		}
+	}
+	wipe_mon_list(c, p);
+	cave_free(c);
+}
+
 /**
  * Generate a random level.
  *
@@ -823,31 +1022,30 @@ void cave_generate(struct chunk **c, struct player *p) {
 
 	assert(c);
 
+	TRACE_BEGIN("cave_generate");
+
+	/* The scratch buffers outlive each level */
+	if (!dun_scratch)
+		dun_scratch = dun_data_new();
+
 	/* Generate */
 	for (tries = 0; tries < 100 && error; tries++) {
-		struct dun_data dun_body;
-
 		error = NULL;
 
 		/* Mark the dungeon as being unready (to avoid artifact loss, etc) */
 		character_dungeon = FALSE;
 
-		/* Allocate global data (will be freed when we leave the loop) */
-		dun = &dun_body;
-		dun->cent = mem_zalloc(z_info->level_room_max * sizeof(struct loc));
-		dun->door = mem_zalloc(z_info->level_door_max * sizeof(struct loc));
-		dun->wall = mem_zalloc(z_info->wall_pierce_max * sizeof(struct loc));
-		dun->tunn = mem_zalloc(z_info->tunn_grid_max * sizeof(struct loc));
+		/* Start from a clean context */
+		dun = dun_scratch;
+		dun_data_reset(dun);
+		gen_stats.attempts++;
 
 		/* Choose a profile and build the level */
 		dun->profile = choose_profile(p->depth);
-		chunk = dun->profile->builder(p);
+		TRACE(dun->profile->name, chunk = dun->profile->builder(p));
 		if (!chunk) {
 			error = "Failed to find builder";
-			mem_free(dun->cent);
-			mem_free(dun->door);
-			mem_free(dun->wall);
-			mem_free(dun->tunn);
+			gen_stats.builder_failed++;
 			continue;
 		}
 
@@ -880,15 +1078,15 @@ void cave_generate(struct chunk **c, struct player *p) {
 		}
 
 		/* Regenerate levels that overflow their maxima */
-		if (cave_monster_max(chunk) >= z_info->level_monster_max)
+		if (gen_level_full(chunk)) {
 			error = "too many monsters";
+			gen_stats.too_many_monsters++;
+		}
 
-		if (error) ROOM_LOG("Generation restarted: %s.", error);
-
-		mem_free(dun->cent);
-		mem_free(dun->door);
-		mem_free(dun->wall);
-		mem_free(dun->tunn);
+		if (error) {
+			ROOM_LOG("Generation restarted: %s.", error);
+			cave_discard(chunk, p);
+		}
 	}
 
 	if (error) quit_fmt("cave_generate() failed 100 times!");
@@ -926,6 +1124,8 @@ void cave_generate(struct chunk **c, struct player *p) {
 		cave_known();
 
 	(*c)->created_at = turn;
+
+	TRACE_END("cave_generate");
 }
 
 /**
@@ -237,10 +237,53 @@ typedef struct room_template {
     byte tval;			/*!< tval for objects in this room */
 } room_template_type;
 
+/**
+ * Generation attempts made by cave_generate(), and how many were thrown away
+ * at each stage
+ */
+struct gen_stats {
+	u32b attempts;			/*!< Levels started */
+	u32b builder_failed;	/*!< Builder gave up before populating */
+	u32b too_many_monsters;	/*!< Monster list overflowed */
+};
+
+extern struct gen_stats gen_stats;
+
+/**
+ * Stages of level building that can be timed separately
+ */
+enum gen_stage {
+	GEN_STAGE_OTHER = 0,
+	GEN_STAGE_ROOMS,
+	GEN_STAGE_TUNNELS,
+	GEN_STAGE_STREAMERS,
+	GEN_STAGE_POPULATE,
+
+	GEN_STAGE_MAX
+};
+
+/**
+ * Processor time spent in each stage, gathered only when 'on' is set
+ */
+struct gen_timing {
+	bool on;				/*!< Whether to time anything */
+	int stage;				/*!< Stage currently being charged */
+	clock_t since;			/*!< When the current stage was entered */
+	clock_t ticks[GEN_STAGE_MAX];	/*!< Time spent in each stage */
+};
+
+extern struct gen_timing gen_timing;
+extern const struct cave_profile *gen_force_profile;
+
 struct dun_data *dun;
 struct vault *vaults;
 struct room_template *room_templates;
 
+/* generate.c */
+int gen_stage_enter(int stage);
+const struct cave_profile *find_cave_profile(char *name);
+struct vault **vaults_allowed(int depth, const char *typ, int *num);
+
 /* gen-cave.c */
 struct chunk *town_gen(struct player *p);
 struct chunk *classic_gen(struct player *p);
@@ -259,6 +302,7 @@ struct chunk *chunk_write(int y0, int x0, int height, int width, bool monsters,
 void chunk_list_add(struct chunk *c);
 bool chunk_list_remove(char *name);
 struct chunk *chunk_find_name(char *name);
+void chunk_list_free(void);
 bool chunk_find(struct chunk *c);
 bool chunk_copy(struct chunk *dest, struct chunk *source, int y0, int x0,
 				int rotate, bool reflect);
@@ -308,6 +352,7 @@ int yx_to_i(int y, int x, int w);
 void i_to_yx(int i, int w, int *y, int *x);
 void shuffle(int *arr, int n);
 bool cave_find(struct chunk *c, int *y, int *x, square_predicate pred);
+void cave_find_cleanup(void);
 bool find_empty(struct chunk *c, int *y, int *x);
 bool find_empty_range(struct chunk *c, int *y, int y1, int y2, int *x, int x1, int x2);
 bool find_nearby_grid(struct chunk *c, int *y, int y0, int yd, int *x, int x0, int xd);
@@ -327,6 +372,10 @@ void vault_traps(struct chunk *c, int y, int x, int yd, int xd, int num);
 void vault_monsters(struct chunk *c, int y1, int x1, int depth, int num);
 void alloc_objects(struct chunk *c, int set, int typ, int num, int depth, byte origin);
 bool alloc_object(struct chunk *c, int set, int typ, int depth, byte origin);
+int sample_floor_objects(int depth,
+						 void (*take)(struct object *obj, void *data),
+						 void *data);
+bool gen_level_full(struct chunk *c);
 
 /* gen-monster.c */
 bool mon_restrict(const char *monster_type, int depth, bool unique_ok);
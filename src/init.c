@@ -27,6 +27,7 @@
 #include "buildid.h"
 #include "cave.h"
 #include "cmds.h"
+#include "effects.h"
 #include "game-event.h"
 #include "cmd-core.h"
 #include "generate.h"
@@ -41,6 +42,7 @@
 #include "obj-ignore.h"
 #include "obj-list.h"
 #include "obj-make.h"
+#include "obj-pile.h"
 #include "obj-randart.h"
 #include "obj-slays.h"
 #include "obj-tval.h"
@@ -50,13 +52,16 @@
 #include "parser.h"
 #include "player.h"
 #include "player-history.h"
+#include "player-path.h"
 #include "player-quest.h"
 #include "player-spell.h"
 #include "player-timed.h"
 #include "project.h"
 #include "randname.h"
+#include "savefile.h"
 #include "store.h"
 #include "trap.h"
+#include "z-trace.h"
 
 /**
  * Structure (not array) of game constants
@@ -92,6 +97,34 @@ char *ANGBAND_DIR_XTRA_ICON;
 
 static struct history_chart *histories;
 
+/**
+ * The names and descriptions from the main game data tables, packed
+ * together as each table is finished, and freed all at once with the tables
+ */
+static struct mem_arena *data_text;
+
+#define DATA_TEXT_BLOCK 65536
+
+/**
+ * Move a string made while parsing into the game data's text pool, freeing
+ * the original.  Strings in the pool must never be freed by themselves.
+ */
+char *data_string(char *str)
+{
+	size_t len;
+	char *text;
+
+	if (!str) return NULL;
+	if (!data_text)
+		data_text = mem_arena_new(DATA_TEXT_BLOCK);
+
+	len = strlen(str) + 1;
+	text = mem_arena_alloc(data_text, len);
+	memcpy(text, str, len);
+	string_free(str);
+	return text;
+}
+
 static const char *slots[] = {
 	#define EQUIP(a, b, c, d, e, f) #a,
 	#include "list-equip-slots.h"
@@ -307,6 +340,9 @@ static enum parser_error write_dummy_object_record(struct artifact *art, const c
 	/* Register this as an INSTA_ART object */
 	kf_on(dummy->kind_flags, KF_INSTA_ART);
 
+	/* The kinds have moved, and there is a new one */
+	kind_index_init();
+
 	return PARSE_ERROR_NONE;
 }
 
@@ -1306,6 +1342,7 @@ static errr run_parse_object(struct parser *p) {
 
 static errr finish_parse_object(struct parser *p) {
 	struct object_kind *k, *next = NULL;
+	int i;
 
 	/* scan the list for the max id */
 	z_info->k_max = 0;
@@ -1332,6 +1369,13 @@ static errr finish_parse_object(struct parser *p) {
 		mem_free(k);
 	}
 	z_info->k_max += 1;
+	kind_index_init();
+
+	for (i = 0; i < z_info->k_max; i++) {
+		k_info[i].name = data_string(k_info[i].name);
+		k_info[i].text = data_string(k_info[i].text);
+		k_info[i].effect_msg = data_string(k_info[i].effect_msg);
+	}
 
 	/*objkinds = parser_priv(p); not used yet, when used, remove the mem_free(k); above */
 	parser_destroy(p);
@@ -1342,13 +1386,11 @@ static void cleanup_object(void)
 {
 	int idx;
 	for (idx = 0; idx < z_info->k_max; idx++) {
-		string_free(k_info[idx].name);
-		mem_free(k_info[idx].text);
-		mem_free(k_info[idx].effect_msg);
 		free_brand(k_info[idx].brands);
 		free_slay(k_info[idx].slays);
 		free_effect(k_info[idx].effect);
 	}
+	kind_index_free();
 	mem_free(k_info);
 }
 
@@ -1835,6 +1877,7 @@ static errr run_parse_artifact(struct parser *p) {
 
 static errr finish_parse_artifact(struct parser *p) {
 	struct artifact *a, *n;
+	int i;
 
 	/* scan the list for the max id */
 	z_info->a_max = 0;
@@ -1859,6 +1902,12 @@ static errr finish_parse_artifact(struct parser *p) {
 	}
 	z_info->a_max += 1;
 
+	for (i = 0; i < z_info->a_max; i++) {
+		a_info[i].name = data_string(a_info[i].name);
+		a_info[i].text = data_string(a_info[i].text);
+		a_info[i].alt_msg = data_string(a_info[i].alt_msg);
+	}
+
 	parser_destroy(p);
 	return 0;
 }
@@ -1867,9 +1916,6 @@ static void cleanup_artifact(void)
 {
 	int idx;
 	for (idx = 0; idx < z_info->a_max; idx++) {
-		string_free(a_info[idx].name);
-		mem_free(a_info[idx].alt_msg);
-		mem_free(a_info[idx].text);
 		free_brand(a_info[idx].brands);
 		free_slay(a_info[idx].slays);
 	}
@@ -1953,12 +1999,16 @@ static errr finish_parse_names(struct parser *p) {
 	}
 	mem_free(n);
 	parser_destroy(p);
+
+	/* Build the name models for every type now, rather than on first use */
+	randname_prepare(name_sections);
 	return 0;
 }
 
 static void cleanup_names(void)
 {
 	int i, j;
+	randname_cleanup();
 	for (i = 0; i < RANDNAME_NUM_TYPES; i++) {
 		for (j = 0; name_sections[i][j]; j++) {
 			string_free((char *)name_sections[i][j]);
@@ -1966,6 +2016,7 @@ static void cleanup_names(void)
 		mem_free(name_sections[i]);
 	}
 	mem_free(name_sections);
+	name_sections = NULL;
 }
 
 static struct file_parser names_parser = {
@@ -2335,6 +2386,7 @@ static errr run_parse_feat(struct parser *p) {
 
 static errr finish_parse_feat(struct parser *p) {
 	struct feature *f, *n;
+	int i;
 
 	/* scan the list for the max id */
 	z_info->f_max = 0;
@@ -2358,6 +2410,9 @@ static errr finish_parse_feat(struct parser *p) {
 	}
 	z_info->f_max += 1;
 
+	for (i = 0; i < z_info->f_max; i++)
+		f_info[i].name = data_string(f_info[i].name);
+
 	/* Set the terrain constants */
 	set_terrain();
 
@@ -2366,10 +2421,6 @@ static errr finish_parse_feat(struct parser *p) {
 }
 
 static void cleanup_feat(void) {
-	int idx;
-	for (idx = 0; idx < z_info->f_max; idx++) {
-		string_free(f_info[idx].name);
-	}
 	mem_free(f_info);
 }
 
@@ -2716,6 +2767,7 @@ static errr run_parse_ego(struct parser *p) {
 
 static errr finish_parse_ego(struct parser *p) {
 	struct ego_item *e, *n;
+	int i;
 
 	/* scan the list for the max id */
 	z_info->e_max = 0;
@@ -2739,6 +2791,11 @@ static errr finish_parse_ego(struct parser *p) {
 	}
 	z_info->e_max += 1;
 
+	for (i = 0; i < z_info->e_max; i++) {
+		e_info[i].name = data_string(e_info[i].name);
+		e_info[i].text = data_string(e_info[i].text);
+	}
+
 	create_slay_cache(e_info);
 
 	parser_destroy(p);
@@ -2750,8 +2807,6 @@ static void cleanup_ego(void)
 	int idx;
 	struct ego_poss_item *poss, *pn;
 	for (idx = 0; idx < z_info->e_max; idx++) {
-		string_free(e_info[idx].name);
-		mem_free(e_info[idx].text);
 		free_brand(e_info[idx].brands);
 		free_slay(e_info[idx].slays);
 		free_effect(e_info[idx].effect);
@@ -3850,6 +3905,7 @@ static void cleanup_flavor(void)
 {
 	struct flavor *f, *next;
 
+	flavor_forget();
 	f = flavors;
 	while(f) {
 		next = f->next;
@@ -3911,6 +3967,7 @@ static void cleanup_hints(void)
 		mem_free(h);
 		h = next;
 	}
+	hints = NULL;
 }
 
 static struct file_parser hints_parser = {
@@ -4322,9 +4379,20 @@ static struct {
 	{ "bodies", &body_parser },
 	{ "player races", &p_race_parser },
 	{ "player classes", &class_parser },
-	{ "flavours", &flavor_parser },
-	{ "hints", &hints_parser },
-	{ "random names", &names_parser }
+	{ "flavours", &flavor_parser }
+};
+
+/**
+ * Parsers for data that many sessions never use, which are only run the
+ * first time the data is asked for
+ */
+static struct {
+	const char *name;
+	struct file_parser *parser;
+	bool loaded;
+} lazy_pl[] = {
+	{ "hints", &hints_parser, FALSE },
+	{ "random names", &names_parser, FALSE }
 };
 
 /**
@@ -4346,6 +4414,35 @@ void init_arrays(void)
 	}
 }
 
+/**
+ * Run one of the lazily loaded parsers if it hasn't been run yet
+ */
+static void init_lazy(unsigned int i)
+{
+	if (lazy_pl[i].loaded)
+		return;
+
+	if (run_parser(lazy_pl[i].parser))
+		quit_fmt("Cannot initialize %s.", lazy_pl[i].name);
+	lazy_pl[i].loaded = TRUE;
+}
+
+/**
+ * Make sure the shopkeepers' hints are loaded
+ */
+void init_hints(void)
+{
+	init_lazy(0);
+}
+
+/**
+ * Make sure the random name tables (name_sections) are loaded
+ */
+void init_randnames(void)
+{
+	init_lazy(1);
+}
+
 /**
  * Free all the internal arrays
  */
@@ -4353,10 +4450,20 @@ static void cleanup_arrays(void)
 {
 	unsigned int i;
 
+	for (i = 0; i < N_ELEMENTS(lazy_pl); i++) {
+		if (lazy_pl[i].loaded)
+			cleanup_parser(lazy_pl[i].parser);
+		lazy_pl[i].loaded = FALSE;
+	}
+
 	for (i = 1; i < N_ELEMENTS(pl); i++)
 		cleanup_parser(pl[i].parser);
 
 	cleanup_parser(pl[0].parser);
+
+	/* All the tables' text goes at once */
+	mem_arena_destroy(data_text);
+	data_text = NULL;
 }
 
 static struct init_module arrays_module = {
@@ -4371,6 +4478,7 @@ extern struct init_module generate_module;
 extern struct init_module obj_make_module;
 extern struct init_module ignore_module;
 extern struct init_module mon_make_module;
+extern struct init_module mon_summon_module;
 extern struct init_module player_module;
 extern struct init_module store_module;
 extern struct init_module messages_module;
@@ -4386,6 +4494,7 @@ static struct init_module *modules[] = {
 	&obj_make_module,
 	&ignore_module,
 	&mon_make_module,
+	&mon_summon_module,
 	&store_module,
 	&options_module,
 	&monmsg_module,
@@ -4417,7 +4526,7 @@ bool init_angband(void)
 	/* Initialise modules */
 	for (i = 0; modules[i]; i++)
 		if (modules[i]->init)
-			modules[i]->init();
+			TRACE(modules[i]->name, modules[i]->init());
 
 	/* Initialize some other things */
 	event_signal_message(EVENT_INITSTATUS, 0, "Initializing other stuff...");
@@ -4446,9 +4555,7 @@ void cleanup_angband(void)
 	event_remove_all_handlers();
 
 	/* Free the chunk list */
-	for (i = 0; i < chunk_list_max; i++)
-		cave_free(chunk_list[i]);
-	mem_free(chunk_list);
+	chunk_list_free();
 
 	/* Free the main cave */
 	if (cave)
@@ -4456,12 +4563,24 @@ void cleanup_angband(void)
 	if (cave_k)
 		cave_free(cave_k);
 
+	/* Free the line of sight and distance tables */
+	cave_view_cleanup();
+	pathfind_cleanup();
+	project_cleanup();
+	effect_simple_cleanup();
+
 	/* Free the history */
 	history_clear();
 
+	/* Free the last savefile image */
+	savefile_cleanup();
+
 	monster_list_finalize();
 	object_list_finalize();
 
+	/* Free the objects' memory now nothing holds any */
+	object_pool_free();
+
 	cleanup_game_constants();
 
 	/* Free the format() buffer */
@@ -154,7 +154,10 @@ extern struct parser *init_parse_quest(void);
 
 extern void init_file_paths(const char *config, const char *lib, const char *data);
 extern void init_game_constants(void);
+extern char *data_string(char *str);
 extern void init_arrays(void);
+extern void init_hints(void);
+extern void init_randnames(void);
 extern void create_needed_dirs(void);
 extern bool init_angband(void);
 extern void cleanup_angband(void);
@@ -13,3 +13,4 @@ MFLAG(VISIBLE,	"Monster is \"visible\"")
 MFLAG(UNAWARE,	"Player doesn't know this is a monster")
 MFLAG(AWARE,	"Monster is aware of the player")
 MFLAG(HANDLED,	"Monster has been processed this turn")
+MFLAG(DORMANT,	"Monster is off the schedule until the player is near")
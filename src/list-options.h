@@ -93,4 +93,6 @@ OP(birth_ai_learn,        "Monsters learn from their mistakes",
 BIRTH, FALSE)
 OP(birth_force_descend,   "Force player descent",
 BIRTH, FALSE)
+OP(birth_symmetric_view,  "Monsters see you only from where you can see",
+BIRTH, FALSE)
 
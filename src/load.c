@@ -24,9 +24,11 @@
 #include "init.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-timed.h"
 #include "mon-spell.h"
 #include "mon-util.h"
 #include "monster.h"
+#include "obj-desc.h"
 #include "obj-gear.h"
 #include "obj-identify.h"
 #include "obj-ignore.h"
@@ -109,6 +111,8 @@ static struct object *rd_item(void)
 	size_t i;
 	char buf[128];
 	byte ver = 1;
+	struct brand **brand_end = &obj->brands;
+	struct slay **slay_end = &obj->slays;
 
 	rd_u16b(&tmp16u);
 	rd_byte(&ver);
@@ -147,22 +151,18 @@ static struct object *rd_item(void)
 	rd_u16b(&obj->origin_xtra);
 	rd_byte(&obj->ignore);
 
-	for (i = 0; i < of_size; i++)
-		rd_byte(&obj->flags[i]);
+	rd_bytes(obj->flags, of_size);
 
 	of_wipe(obj->known_flags);
 
-	for (i = 0; i < of_size; i++)
-		rd_byte(&obj->known_flags[i]);
-
-	for (i = 0; i < id_size; i++)
-		rd_byte(&obj->id_flags[i]);
+	rd_bytes(obj->known_flags, of_size);
+	rd_bytes(obj->id_flags, id_size);
 
 	for (i = 0; i < obj_mod_max; i++) {
 		rd_s16b(&obj->modifiers[i]);
 	}
 
-	/* Read brands */
+	/* Read brands, keeping them in the order they were saved */
 	rd_byte(&tmp8u);
 	while (tmp8u) {
 		char buf[40];
@@ -175,12 +175,12 @@ static struct object *rd_item(void)
 		b->multiplier = tmp16s;
 		rd_byte(&tmp8u);
 		b->known = tmp8u ? TRUE : FALSE;
-		b->next = obj->brands;
-		obj->brands = b;
+		*brand_end = b;
+		brand_end = &b->next;
 		rd_byte(&tmp8u);
 	}
 
-	/* Read slays */
+	/* Read slays, likewise */
 	rd_byte(&tmp8u);
 	while (tmp8u) {
 		char buf[40];
@@ -193,8 +193,8 @@ static struct object *rd_item(void)
 		s->multiplier = tmp16s;
 		rd_byte(&tmp8u);
 		s->known = tmp8u ? TRUE : FALSE;
-		s->next = obj->slays;
-		obj->slays = s;
+		*slay_end = s;
+		slay_end = &s->next;
 		rd_byte(&tmp8u);
 	}
 
@@ -251,7 +251,8 @@ static struct object *rd_item(void)
 /**
  * Read a monster
  */
-static void rd_monster(struct chunk *c, monster_type *mon)
+static void rd_monster(struct chunk *c, monster_type *mon,
+					   struct player_state *known)
 {
 	byte tmp8u;
 	s16b r_idx;
@@ -272,16 +273,14 @@ static void rd_monster(struct chunk *c, monster_type *mon)
 
 	for (j = 0; j < tmp8u; j++)
 		rd_s16b(&mon->m_timed[j]);
+	mon_timed_refresh(mon);
 
 	/* Read and extract the flag */
-	for (j = 0; j < mflag_size; j++)
-		rd_byte(&mon->mflag[j]);
-
-	for (j = 0; j < of_size; j++)
-		rd_byte(&mon->known_pstate.flags[j]);
+	rd_bytes(mon->mflag, mflag_size);
+	rd_bytes(known->flags, of_size);
 
 	for (j = 0; j < elem_max; j++)
-		rd_s16b(&mon->known_pstate.el_info[j].res_level);
+		rd_s16b(&known->el_info[j].res_level);
 
 	rd_byte(&tmp8u);
 	if (tmp8u) {
@@ -315,16 +314,13 @@ static void rd_monster(struct chunk *c, monster_type *mon)
  */
 static void rd_trap(struct trap *trap)
 {
-    int i;
-
     rd_byte(&trap->t_idx);
     trap->kind = &trap_info[trap->t_idx];
     rd_byte(&trap->fy);
     rd_byte(&trap->fx);
     rd_byte(&trap->xtra);
 
-    for (i = 0; i < trf_size; i++)
-		rd_byte(&trap->flags[i]);
+    rd_bytes(trap->flags, trf_size);
 }
 
 /**
@@ -776,8 +772,8 @@ int rd_ignore(void)
 	if (tmp8u != ignore_size) {
 		strip_bytes(tmp8u);
 	} else {
-		for (i = 0; i < ignore_size; i++)
-			rd_byte(&ignore_level[i]);
+		rd_bytes(ignore_level, ignore_size);
+		object_desc_invalidate();
 	}
 		
 	/* Read the number of saved ego-item */
@@ -797,8 +793,7 @@ int rd_ignore(void)
 			e_info[i].everseen = (flags & 0x02) ? TRUE : FALSE;
 
 			/* Read and extract the ignore flags */
-			for (j = 0; j < ITYPE_SIZE; j++)
-				rd_byte(&itypes[j]);
+			rd_bytes(itypes, ITYPE_SIZE);
 
 			for (j = ITYPE_NONE; j < ITYPE_MAX; j++)
 				if (itype_has(itypes, j))
@@ -830,6 +825,7 @@ int rd_ignore(void)
 int rd_misc(void)
 {
 	byte tmp8u;
+	u32b rand_value = Rand_value;
 	
 	/* Read the randart seed */
 	rd_u32b(&seed_randart);
@@ -839,6 +835,9 @@ int rd_misc(void)
 	rd_u32b(&seed_flavor);
 	flavor_init();
 
+	/* Both of those run the simple RNG; leave it as it was saved */
+	Rand_value = rand_value;
+
 	/* Special stuff */
 	rd_u16b(&player->total_winner);
 	rd_u16b(&player->noscore);
@@ -879,11 +878,8 @@ int rd_player_hp(void)
  */
 int rd_player_spells(void)
 {
-	int i;
 	u16b tmp16u;
 	
-	int cnt;
-	
 	/* Read the number of spells */
 	rd_u16b(&tmp16u);
 	if (tmp16u > player->class->magic.total_spells) {
@@ -895,12 +891,10 @@ int rd_player_spells(void)
 	player_spells_init(player);
 	
 	/* Read the spell flags */
-	for (i = 0; i < tmp16u; i++)
-		rd_byte(&player->spell_flags[i]);
+	rd_bytes(player->spell_flags, tmp16u);
 	
 	/* Read the spell order */
-	for (i = 0, cnt = 0; i < tmp16u; i++, cnt++)
-		rd_byte(&player->spell_order[cnt]);
+	rd_bytes(player->spell_order, tmp16u);
 	
 	/* Success */
 	return (0);
@@ -1006,12 +1000,11 @@ static int rd_stores_aux(rd_item_t rd_item_version)
 				return (-1);
 			}
 
-			/* Accept any valid items */
+			/* Accept any valid items, in the order they were saved; they
+			 * were stocked and stacked before saving */
 			if (store->stock_num < z_info->store_inven_max && obj->kind) {
-				if (store->sidx == STORE_HOME)
-					home_carry(obj);
-				else
-					store_carry(store, obj);
+				pile_insert_end(&store->stock, obj);
+				store->stock_num++;
 			}
 		}
 	}
@@ -1025,6 +1018,32 @@ static int rd_stores_aux(rd_item_t rd_item_version)
 int rd_stores(void) { return rd_stores_aux(rd_item); }
 
 
+/**
+ * Read one run of a run-length encoded square plane
+ */
+typedef void (*rd_run_t)(u32b *count, byte *value);
+
+/**
+ * Runs with a byte count, as in version 1 dungeon and chunk blocks
+ */
+static void rd_run_1(u32b *count, byte *value)
+{
+	byte tmp8u;
+
+	rd_byte(&tmp8u);
+	*count = tmp8u;
+	rd_byte(value);
+}
+
+/**
+ * Runs with a variable length count
+ */
+static void rd_run(u32b *count, byte *value)
+{
+	rd_varint(count);
+	rd_byte(value);
+}
+
 /**
  * Read the dungeon
  *
@@ -1042,14 +1061,14 @@ int rd_stores(void) { return rd_stores_aux(rd_item); }
  * After loading the monsters, the objects being held by monsters are
  * linked directly into those monsters.
  */
-static int rd_dungeon_aux(struct chunk **c)
+static int rd_dungeon_aux(struct chunk **c, rd_run_t rd_run)
 {
 	struct chunk *c1 = *c;
-	int i, n, y, x;
+	int n, y, x;
 
 	u16b height, width;
 
-	byte count;
+	u32b i, count;
 	byte tmp8u;
 	u16b tmp16u;
 	char name[100];
@@ -1068,8 +1087,9 @@ static int rd_dungeon_aux(struct chunk **c)
 		/* Load the dungeon data */
 		for (x = y = 0; y < c1->height; ) {
 			/* Grab RLE info */
-			rd_byte(&count);
-			rd_byte(&tmp8u);
+			rd_run(&count, &tmp8u);
+			if (rd_overrun())
+				return -1;
 
 			/* Apply the RLE info */
 			for (i = count; i > 0; i--) {
@@ -1091,13 +1111,16 @@ static int rd_dungeon_aux(struct chunk **c)
 	/* Run length decoding of dungeon data */
 	for (x = y = 0; y < c1->height; ) {
 		/* Grab RLE info */
-		rd_byte(&count);
-		rd_byte(&tmp8u);
+		rd_run(&count, &tmp8u);
+		if (rd_overrun())
+			return -1;
 
 		/* Apply the RLE info */
 		for (i = count; i > 0; i--) {
-			/* Extract "feat" */
-			square_set_feat(c1, y, x, tmp8u);
+			/* Extract "feat", leaving the info as it was saved rather than
+			 * fitting it to the level being played */
+			c1->squares[y][x].feat = tmp8u;
+			if (tmp8u) c1->feat_count[tmp8u]++;
 
 			/* Advance/Wrap */
 			if (++x >= c1->width) {
@@ -1111,6 +1134,8 @@ static int rd_dungeon_aux(struct chunk **c)
 	}
 
 
+	cave_update_planes(c1);
+
 	/* Read "feeling" */
 	rd_byte(&tmp8u);
 	c1->feeling = tmp8u;
@@ -1154,6 +1179,7 @@ static int rd_objects_aux(rd_item_t rd_item_version, struct chunk *c)
  */
 static int rd_monsters_aux(struct chunk *c)
 {
+	static const struct player_state blank;
 	int i;
 	u16b limit;
 
@@ -1172,19 +1198,26 @@ static int rd_monsters_aux(struct chunk *c)
 	for (i = 1; i < limit; i++) {
 		monster_type *mon;
 		monster_type monster_type_body;
+		struct player_state known;
 
 		/* Get local monster */
 		mon = &monster_type_body;
 		memset(mon, 0, sizeof(*mon));
+		memset(&known, 0, sizeof(known));
 
 		/* Read the monster */
-		rd_monster(c, mon);
+		rd_monster(c, mon, &known);
 
 		/* Place monster in dungeon */
 		if (place_monster(c, mon->fy, mon->fx, mon, 0) != i) {
 			note(format("Cannot place monster %d", i));
 			return (-1);
 		}
+
+		/* Only make room for what monsters know if there is any */
+		if (!of_is_empty(known.flags) ||
+			memcmp(known.el_info, blank.el_info, sizeof(known.el_info)))
+			*cave_monster_known(c, i) = known;
 	}
 
 	return 0;
@@ -1220,7 +1253,7 @@ static int rd_traps_aux(struct chunk *c)
     return 0;
 }
 
-int rd_dungeon(void)
+static int rd_dungeon_common(rd_run_t rd_run)
 {
 	u16b depth;
 	u16b py, px;
@@ -1242,7 +1275,7 @@ int rd_dungeon(void)
 		return (0);
 	}
 
-	if (rd_dungeon_aux(&cave))
+	if (rd_dungeon_aux(&cave, rd_run))
 		return 1;
 
 	/* Ignore illegal dungeons */
@@ -1262,12 +1295,22 @@ int rd_dungeon(void)
 	character_dungeon = TRUE;
 
 	/* Read known cave */
-	if (rd_dungeon_aux(&cave_k))
+	if (rd_dungeon_aux(&cave_k, rd_run))
 		return 1;
 
 	return 0;
 }
 
+int rd_dungeon_1(void)
+{
+	return rd_dungeon_common(rd_run_1);
+}
+
+int rd_dungeon(void)
+{
+	return rd_dungeon_common(rd_run);
+}
+
 
 /**
  * Read the objects - wrapper functions
@@ -1308,7 +1351,7 @@ int rd_traps(void)
 /**
  * Read the chunk list
  */
-int rd_chunks(void)
+static int rd_chunks_common(rd_run_t rd_run)
 {
 	int j;
 	u16b chunk_max;
@@ -1321,7 +1364,7 @@ int rd_chunks(void)
 		struct chunk *c;
 
 		/* Read the dungeon */
-		if (rd_dungeon_aux(&c))
+		if (rd_dungeon_aux(&c, rd_run))
 			return -1;
 
 		/* Read the objects */
@@ -1342,11 +1385,21 @@ int rd_chunks(void)
 	return 0;
 }
 
+int rd_chunks_1(void)
+{
+	return rd_chunks_common(rd_run_1);
+}
+
+int rd_chunks(void)
+{
+	return rd_chunks_common(rd_run);
+}
+
 
 int rd_history(void)
 {
 	u32b tmp32u;
-	size_t i, j;
+	size_t i;
 	
 	history_clear();
 
@@ -1365,8 +1418,7 @@ int rd_history(void)
 		byte art_name;
 		char text[80];
 
-		for (j = 0; j < hist_size; j++)		
-			rd_byte(&type[j]);
+		rd_bytes(type, hist_size);
 		rd_s32b(&turnno);
 		rd_s16b(&dlev);
 		rd_s16b(&clev);
@@ -737,8 +737,11 @@ static errr Term_xtra_gcu(int n, int v) {
 		/* Make a noise */
 		case TERM_XTRA_NOISE: write(1, "\007", 1); return 0;
 
-		/* Flush the Curses buffer */
-		case TERM_XTRA_FRESH: wrefresh(td->win); return 0;
+		/* Flush the Curses buffer, to be sent with the frame */
+		case TERM_XTRA_FRESH: wnoutrefresh(td->win); return 0;
+
+		/* Send every window's changes in one update */
+		case TERM_XTRA_FRAME: doupdate(); return 0;
 
 #ifdef USE_CURS_SET
 		/* Change the cursor visibility */
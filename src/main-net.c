@@ -0,0 +1,476 @@
+/**
+ * \file main-net.c
+ * \brief Stream the main term to read-only network spectators
+ *
+ * Copyright (c) 2014 Angband contributors
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "main.h"
+
+#ifdef USE_NET
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * This isn't a display of its own: it sits between the term and whichever
+ * frontend is drawing it.  The frontend's drawing hooks are wrapped, so the
+ * only cells seen are the ones Term_fresh() has already found to differ
+ * between "scr" and "old".  Each refresh is encoded once into a ring buffer
+ * and every viewer simply reads the ring from its own position, so the
+ * cost to the game is the same for one spectator as for thirty.
+ *
+ * The stream is a sequence of records, each a one byte code followed by
+ * little-endian fields:
+ *
+ *	'S' u16 width, u16 height        New screen size; viewers start afresh
+ *	'C'                              Clear the screen
+ *	'T' u16 x, u16 y, u16 n, u8 a    A run of n characters in colour a,
+ *	    then n UTF-8 characters
+ *	'W' u16 x, u16 y, u16 n          A run of n blank grids
+ *	'G' u16 x, u16 y, u8 a, u8 c,    A tile, with the terrain tile under it
+ *	    u8 ta, u8 tc
+ *	'K' u16 x, u16 y, u8 visible     Cursor position
+ *	'F'                              End of a refresh
+ *
+ * A viewer that connects starts at a keyframe: a size record followed by
+ * the full screen.  One that falls a whole ring behind has lost part of a
+ * record, so it is dropped and can reconnect for a fresh keyframe.
+ * Nothing is encoded at all while nobody is watching.
+ */
+
+/**
+ * Size of the ring of encoded refreshes; a power of two
+ */
+#define NET_RING_SIZE	(1 << 18)
+
+/**
+ * Maximum number of spectators
+ */
+#define NET_VIEWERS_MAX	32
+
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
+
+/**
+ * A connected spectator
+ */
+struct net_viewer {
+	int fd;				/* Socket, or -1 if this slot is free */
+	size_t pos;			/* Next byte of the ring to send */
+	bool waiting;		/* Has not had a keyframe yet */
+};
+
+/**
+ * The frontend's own hooks for the streamed term
+ */
+static struct {
+	errr (*xtra_hook)(int n, int v);
+	errr (*wipe_hook)(int x, int y, int n);
+	errr (*text_hook)(int x, int y, int n, int a, const wchar_t *s);
+	errr (*pict_hook)(int x, int y, int n, const int *ap, const wchar_t *cp,
+					  const int *tap, const wchar_t *tcp);
+	errr (*batch_hook)(const term_cell *cells, int n);
+} host;
+
+static term *net_term;
+static int net_listen = -1;
+static struct net_viewer net_viewers[NET_VIEWERS_MAX];
+static int net_watching;
+
+/**
+ * The ring, and positions in it counted in bytes ever written
+ */
+static byte net_ring[NET_RING_SIZE];
+static size_t net_head;		/* End of what has been written */
+static size_t net_frame;	/* End of the last complete refresh */
+static size_t net_key;		/* Start of the latest keyframe */
+static bool net_want_key;
+
+/**
+ * Last cursor sent
+ */
+static int net_cx = -1, net_cy = -1;
+static bool net_cv;
+
+/*** Encoding ***/
+
+static void net_put_byte(int b)
+{
+	net_ring[net_head++ & (NET_RING_SIZE - 1)] = (byte) b;
+}
+
+static void net_put_u16(int v)
+{
+	net_put_byte(v & 0xFF);
+	net_put_byte((v >> 8) & 0xFF);
+}
+
+static void net_put_utf8(wchar_t c)
+{
+	u32b v = (u32b) c;
+
+	if (v < 0x80) {
+		net_put_byte(v);
+	} else if (v < 0x800) {
+		net_put_byte(0xC0 | (v >> 6));
+		net_put_byte(0x80 | (v & 0x3F));
+	} else if (v < 0x10000) {
+		net_put_byte(0xE0 | (v >> 12));
+		net_put_byte(0x80 | ((v >> 6) & 0x3F));
+		net_put_byte(0x80 | (v & 0x3F));
+	} else {
+		net_put_byte(0xF0 | (v >> 18));
+		net_put_byte(0x80 | ((v >> 12) & 0x3F));
+		net_put_byte(0x80 | ((v >> 6) & 0x3F));
+		net_put_byte(0x80 | (v & 0x3F));
+	}
+}
+
+static void net_put_text(int x, int y, int n, int a, const wchar_t *s)
+{
+	int i;
+
+	net_put_byte('T');
+	net_put_u16(x);
+	net_put_u16(y);
+	net_put_u16(n);
+	net_put_byte(a);
+	for (i = 0; i < n; i++)
+		net_put_utf8(s[i]);
+}
+
+static void net_put_wipe(int x, int y, int n)
+{
+	net_put_byte('W');
+	net_put_u16(x);
+	net_put_u16(y);
+	net_put_u16(n);
+}
+
+static void net_put_tile(int x, int y, int a, wchar_t c, int ta, wchar_t tc)
+{
+	net_put_byte('G');
+	net_put_u16(x);
+	net_put_u16(y);
+	net_put_byte(a);
+	net_put_byte(c);
+	net_put_byte(ta);
+	net_put_byte(tc);
+}
+
+/**
+ * Whether an attr/char pair names a graphical tile rather than a character
+ */
+static bool net_is_tile(int a, wchar_t c)
+{
+	return (a & 0x80) && (c & 0x80);
+}
+
+/**
+ * Encode the cursor if it has moved, then close the refresh
+ */
+static void net_end_frame(void)
+{
+	term_win *scr = net_term->scr;
+	bool visible = scr->cv && !scr->cu;
+
+	if (scr->cx != net_cx || scr->cy != net_cy || visible != net_cv) {
+		net_cx = scr->cx;
+		net_cy = scr->cy;
+		net_cv = visible;
+
+		net_put_byte('K');
+		net_put_u16(net_cx);
+		net_put_u16(net_cy);
+		net_put_byte(net_cv);
+	}
+
+	net_put_byte('F');
+	net_frame = net_head;
+}
+
+/**
+ * Encode the whole screen as a keyframe
+ */
+static void net_put_keyframe(void)
+{
+	term_win *scr = net_term->scr;
+	int w = net_term->wid;
+	int h = net_term->hgt;
+	int x, y;
+
+	net_key = net_head;
+	net_want_key = FALSE;
+
+	net_put_byte('S');
+	net_put_u16(w);
+	net_put_u16(h);
+
+	for (y = 0; y < h; y++) {
+		const int *aa = scr->a[y];
+		const wchar_t *cc = scr->c[y];
+
+		for (x = 0; x < w; ) {
+			int n = 1;
+
+			/* Second half of a big tile */
+			if (aa[x] == 255) {
+				x++;
+				continue;
+			}
+
+			if (net_is_tile(aa[x], cc[x])) {
+				net_put_tile(x, y, aa[x], cc[x], scr->ta[y][x], scr->tc[y][x]);
+				x++;
+				continue;
+			}
+
+			/* Gather a run of characters of one colour */
+			while (x + n < w && aa[x + n] == aa[x] &&
+				   !net_is_tile(aa[x + n], cc[x + n]))
+				n++;
+
+			net_put_text(x, y, n, aa[x], cc + x);
+			x += n;
+		}
+	}
+
+	/* Always send the cursor */
+	net_cx = -1;
+	net_end_frame();
+}
+
+/*** Viewers ***/
+
+static void net_drop(struct net_viewer *v)
+{
+	close(v->fd);
+	v->fd = -1;
+	net_watching--;
+}
+
+/**
+ * Take any new spectators
+ */
+static void net_accept(void)
+{
+	int fd;
+
+	while ((fd = accept(net_listen, NULL, NULL)) >= 0) {
+		int i;
+
+		for (i = 0; i < NET_VIEWERS_MAX; i++)
+			if (net_viewers[i].fd < 0) break;
+
+		if (i == NET_VIEWERS_MAX) {
+			close(fd);
+			continue;
+		}
+
+		(void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		net_viewers[i].fd = fd;
+		net_viewers[i].waiting = TRUE;
+		net_watching++;
+		net_want_key = TRUE;
+	}
+}
+
+/**
+ * Send each viewer whatever it has not had yet, without blocking
+ */
+static void net_send(struct net_viewer *v)
+{
+	while (v->pos != net_frame) {
+		size_t off = v->pos & (NET_RING_SIZE - 1);
+		size_t len = MIN(net_frame - v->pos, NET_RING_SIZE - off);
+		ssize_t sent = send(v->fd, net_ring + off, len, MSG_NOSIGNAL);
+
+		if (sent < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				net_drop(v);
+			return;
+		}
+
+		v->pos += sent;
+	}
+}
+
+/**
+ * Accept, resync and feed spectators; only ever called between refreshes
+ */
+static void net_service(void)
+{
+	int i;
+
+	net_accept();
+	if (!net_watching) return;
+
+	if (net_want_key)
+		net_put_keyframe();
+
+	for (i = 0; i < NET_VIEWERS_MAX; i++) {
+		struct net_viewer *v = &net_viewers[i];
+
+		if (v->fd < 0) continue;
+
+		if (v->waiting) {
+			v->pos = net_key;
+			v->waiting = FALSE;
+		}
+
+		/* Anyone a whole ring behind has lost frames */
+		if (net_frame - v->pos > NET_RING_SIZE)
+			net_drop(v);
+		else
+			net_send(v);
+	}
+}
+
+/*** Term hooks ***/
+
+static errr Term_xtra_net(int n, int v)
+{
+	errr res;
+
+	switch (n) {
+		case TERM_XTRA_CLEAR:
+			if (net_watching) net_put_byte('C');
+			break;
+
+		case TERM_XTRA_EVENT:
+		case TERM_XTRA_DELAY:
+			/* The frontend may block here, so catch up first */
+			net_service();
+			break;
+	}
+
+	res = host.xtra_hook ? host.xtra_hook(n, v) : 0;
+
+	if (n == TERM_XTRA_FRESH) {
+		if (net_watching) net_end_frame();
+		net_service();
+	}
+
+	return res;
+}
+
+static errr Term_wipe_net(int x, int y, int n)
+{
+	if (net_watching) net_put_wipe(x, y, n);
+
+	return host.wipe_hook ? host.wipe_hook(x, y, n) : 0;
+}
+
+static errr Term_text_net(int x, int y, int n, int a, const wchar_t *s)
+{
+	if (net_watching) net_put_text(x, y, n, a, s);
+
+	return host.text_hook ? host.text_hook(x, y, n, a, s) : 0;
+}
+
+static errr Term_pict_net(int x, int y, int n, const int *ap,
+						  const wchar_t *cp, const int *tap, const wchar_t *tcp)
+{
+	if (net_watching) {
+		int i;
+
+		for (i = 0; i < n; i++) {
+			if (net_is_tile(ap[i], cp[i]))
+				net_put_tile(x + i, y, ap[i], cp[i], tap[i], tcp[i]);
+			else
+				net_put_text(x + i, y, 1, ap[i], cp + i);
+		}
+	}
+
+	return host.pict_hook ? host.pict_hook(x, y, n, ap, cp, tap, tcp) : 0;
+}
+
+static errr Term_batch_net(const term_cell *cells, int n)
+{
+	int i;
+
+	for (i = 0; net_watching && i < n; i++) {
+		const term_cell *cell = &cells[i];
+
+		if (net_is_tile(cell->a, cell->c))
+			net_put_tile(cell->x, cell->y, cell->a, cell->c, cell->ta,
+						 cell->tc);
+		else
+			net_put_text(cell->x, cell->y, 1, cell->a, &cell->c);
+	}
+
+	return host.batch_hook(cells, n);
+}
+
+/**
+ * Start streaming the main term to spectators connecting on the given port.
+ *
+ * Must be called once the frontend has set up its terms.
+ */
+errr net_spectate(int port)
+{
+	struct sockaddr_in addr;
+	int one = 1;
+	int i;
+	term *t = angband_term[0];
+
+	if (!t || net_term) return (-1);
+
+	net_listen = socket(AF_INET, SOCK_STREAM, 0);
+	if (net_listen < 0) return (-1);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+
+	(void)setsockopt(net_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	if (bind(net_listen, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+		listen(net_listen, NET_VIEWERS_MAX) < 0) {
+		close(net_listen);
+		net_listen = -1;
+		return (-1);
+	}
+	(void)fcntl(net_listen, F_SETFL, fcntl(net_listen, F_GETFL) | O_NONBLOCK);
+
+	for (i = 0; i < NET_VIEWERS_MAX; i++)
+		net_viewers[i].fd = -1;
+
+	/* Wrap the frontend's hooks */
+	net_term = t;
+	host.xtra_hook = t->xtra_hook;
+	host.wipe_hook = t->wipe_hook;
+	host.text_hook = t->text_hook;
+	host.pict_hook = t->pict_hook;
+	host.batch_hook = t->batch_hook;
+
+	t->xtra_hook = Term_xtra_net;
+	if (t->batch_hook) {
+		t->batch_hook = Term_batch_net;
+	} else {
+		t->wipe_hook = Term_wipe_net;
+		t->text_hook = Term_text_net;
+		t->pict_hook = Term_pict_net;
+	}
+
+	return (0);
+}
+
+#endif /* USE_NET */
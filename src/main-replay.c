@@ -0,0 +1,212 @@
+/**
+ * \file main-replay.c
+ * \brief Replay a recorded session with no display, as a benchmark
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+
+#ifdef USE_REPLAY
+
+#include "buildid.h"
+#include "cave.h"
+#include "cmd-core.h"
+#include "cmd-record.h"
+#include "game-event.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "main.h"
+#include "player-calcs.h"
+#include "savefile.h"
+#include "store.h"
+#include <time.h>
+
+static const char *replay_path;
+static bool running_replay;
+
+/**
+ * Stand in for the store's screen: let the game have the commands that were
+ * given there, refreshing after each just as the screen does
+ */
+static void replay_use_store(game_event_type type, game_event_data *data,
+							 void *user)
+{
+	int depth;
+
+	if (!store_at(cave, player->py, player->px)) return;
+
+	depth = cmd_record_ui_enter();
+	forget_view(cave);
+
+	while (cmd_replay_pending(CMD_STORE)) {
+		cmdq_pop(CMD_STORE);
+		notice_stuff(player);
+		handle_stuff(player);
+	}
+
+	/* Take a turn */
+	player->upkeep->energy_use = z_info->move_energy;
+
+	cmd_record_ui_leave(depth);
+}
+
+static void replay_enter_store(game_event_type type, game_event_data *data,
+							   void *user);
+
+static void replay_leave_store(game_event_type type, game_event_data *data,
+							   void *user)
+{
+	player->upkeep->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
+	player->upkeep->redraw |= (PR_BASIC | PR_EXTRA | PR_MAP);
+
+	/* Handlers only last for one visit */
+	event_add_handler(EVENT_ENTER_STORE, replay_enter_store, NULL);
+}
+
+static void replay_enter_store(game_event_type type, game_event_data *data,
+							   void *user)
+{
+	event_add_handler(EVENT_USE_STORE, replay_use_store, NULL);
+	event_add_handler(EVENT_LEAVE_STORE, replay_leave_store, NULL);
+}
+
+/**
+ * Load the game the record started from, and feed it the record
+ */
+static errr run_replay(void)
+{
+	char save[1024];
+	struct replay_result result;
+	s32b start_turn;
+	clock_t start;
+	double secs;
+
+	if (!cmd_replay_start(replay_path, save, sizeof(save)))
+		quit_fmt("Couldn't read the record %s", replay_path);
+
+	/* Start just as start_game() does, less the display */
+	player->is_dead = TRUE;
+	if (!savefile_load(save, FALSE) || player->is_dead)
+		quit_fmt("Couldn't load %s", save);
+	player->upkeep->autosave = FALSE;
+	if (!character_dungeon)
+		cave_generate(&cave, player);
+	event_add_handler(EVENT_ENTER_STORE, replay_enter_store, NULL);
+	on_new_level();
+
+	start_turn = turn;
+	start = clock();
+	while (!player->is_dead && player->upkeep->playing)
+		run_game_loop();
+	secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	cmd_replay_finish(&result);
+
+	printf("%s: %d commands, %ld game turns in %.3f seconds",
+		   buildid, result.commands, (long)(turn - start_turn), secs);
+	if (secs > 0)
+		printf(", %.0f turns/sec", (turn - start_turn) / secs);
+	printf("\n");
+
+	if (result.line) {
+		printf("Went astray at line %d of %s: %s\n", result.line,
+			   replay_path, result.reason);
+		exit(1);
+	}
+
+	exit(0);
+}
+
+typedef struct term_data term_data;
+struct term_data {
+	term t;
+};
+
+static term_data td;
+
+static errr term_xtra_replay(int n, int v)
+{
+	/* The first wait for a key starts the replay, which never returns */
+	if (n == TERM_XTRA_EVENT && !running_replay) {
+		running_replay = TRUE;
+		return run_replay();
+	}
+
+	return 0;
+}
+
+static errr term_curs_replay(int x, int y)
+{
+	return 0;
+}
+
+static errr term_wipe_replay(int x, int y, int n)
+{
+	return 0;
+}
+
+static errr term_text_replay(int x, int y, int n, int a, const wchar_t *s)
+{
+	return 0;
+}
+
+static void term_data_link(int i)
+{
+	term *t = &td.t;
+
+	term_init(t, 80, 24, 256);
+
+	/* Ignore some actions for efficiency and safety */
+	t->never_bored = TRUE;
+	t->never_frosh = TRUE;
+
+	t->xtra_hook = term_xtra_replay;
+	t->curs_hook = term_curs_replay;
+	t->wipe_hook = term_wipe_replay;
+	t->text_hook = term_text_replay;
+
+	t->data = &td;
+
+	Term_activate(t);
+
+	angband_term[i] = t;
+}
+
+const char help_replay[] = "Replay mode, subopts <record made with -R>";
+
+/**
+ * Usage:
+ *
+ * angband -mreplay -- <file>
+ *
+ * Replays the record <file>, made by playing with -R<file>, as fast as the
+ * game will go, then reports the game turns per second.  If the game goes
+ * differently from the record, it says where and exits with status 1; as
+ * the game state is checked before every command, a good replay played the
+ * same game to the last bit.
+ */
+errr init_replay(int argc, char *argv[])
+{
+	if (argc != 2)
+		quit("Usage: angband -mreplay -- <file>");
+	replay_path = argv[1];
+
+	/* Nothing is ever shown */
+	event_set_headless(TRUE);
+
+	term_data_link(0);
+	return 0;
+}
+
+#endif /* USE_REPLAY */
@@ -160,6 +160,19 @@ static int num_fonts = 0;
  * values for pitch & bpp. If a surface is resized the data _must_ be
  * recalculated.
  */
+#define NUM_GLYPHS 256
+
+/*
+ * The glyphs of one font in one colour pair, drawn into a row of cells the
+ * first time each is needed, so text is copied rather than rendered
+ */
+typedef struct sdl_Glyphs sdl_Glyphs;
+struct sdl_Glyphs
+{
+	SDL_Surface *atlas;			/* One cell per glyph */
+	Uint8 drawn[NUM_GLYPHS / 8];	/* Which cells are filled in */
+};
+
 typedef struct sdl_Font sdl_Font;
 struct sdl_Font
 {
@@ -174,12 +187,12 @@ struct sdl_Font
 
 	int *data;					/* The data */
 	TTF_Font *sdl_font;			/* The native font */
+
+	sdl_Glyphs *glyphs[MAX_COLORS * BG_MAX];	/* Glyph cache, by attr */
 };
 
 static sdl_Font SystemFont;
 
-#define NUM_GLYPHS 256
-
 /*
  * Window information
  * Each window has its own surface and coordinates
@@ -469,13 +482,32 @@ static errr sdl_CheckFont(const char *fontname, int *width, int *height)
  * The sdl_Font routines
  */
 
+/**
+ * Throw away the cached glyphs, when they no longer match the font, the
+ * surface or the colours
+ */
+static void sdl_FontFlush(sdl_Font *font)
+{
+	int i;
+
+	for (i = 0; i < MAX_COLORS * BG_MAX; i++) {
+		if (!font->glyphs[i]) continue;
+		SDL_FreeSurface(font->glyphs[i]->atlas);
+		mem_free(font->glyphs[i]);
+		font->glyphs[i] = NULL;
+	}
+}
+
 /**
  * Free any memory assigned by Create()
  */
 static void sdl_FontFree(sdl_Font *font)
 {
+	sdl_FontFlush(font);
+
 	/* Finished with the font */
-	TTF_CloseFont(font->sdl_font);
+	if (font->sdl_font) TTF_CloseFont(font->sdl_font);
+	font->sdl_font = NULL;
 }
 
 
@@ -501,6 +533,9 @@ static errr sdl_FontCreate(sdl_Font *font, const char *fontname, SDL_Surface *su
 	/* Get the size */
 	if (TTF_SizeText(ttf_font, "M", &font->width, &font->height)) return (-1);
 
+	/* Replace any font (and glyphs) made for another surface */
+	sdl_FontFree(font);
+
 	/* Fill in some of the font struct */
 	if (font->name != fontname) my_strcpy(font->name, fontname, 30);
 	font->pitch = surface->pitch;
@@ -514,41 +549,119 @@ static errr sdl_FontCreate(sdl_Font *font, const char *fontname, SDL_Surface *su
 
 
 
+/**
+ * Find the glyph cache for one attr, making an empty one if need be.
+ * The cells are made in the surface's own format so that they are copied
+ * straight across.
+ */
+static sdl_Glyphs *sdl_FontGlyphs(sdl_Font *font, SDL_Surface *surface,
+								  int a, SDL_Color bg)
+{
+	sdl_Glyphs *glyphs;
+
+	if ((a < 0) || (a >= MAX_COLORS * BG_MAX)) return NULL;
+	glyphs = font->glyphs[a];
+	if (glyphs) return glyphs;
+
+	glyphs = mem_zalloc(sizeof(*glyphs));
+	glyphs->atlas = SDL_CreateRGBSurface(SDL_SWSURFACE,
+										 NUM_GLYPHS * font->width,
+										 font->height,
+										 surface->format->BitsPerPixel,
+										 surface->format->Rmask,
+										 surface->format->Gmask,
+										 surface->format->Bmask,
+										 surface->format->Amask);
+	if (!glyphs->atlas) {
+		mem_free(glyphs);
+		return NULL;
+	}
+	SDL_FillRect(glyphs->atlas, NULL,
+				 SDL_MapRGB(glyphs->atlas->format, bg.r, bg.g, bg.b));
+
+	font->glyphs[a] = glyphs;
+	return glyphs;
+}
+
+/**
+ * Render a glyph into its cell, unless that has been done already
+ */
+static bool sdl_GlyphDraw(sdl_Font *font, sdl_Glyphs *glyphs, int c,
+						  SDL_Color colour, SDL_Color bg)
+{
+	SDL_Rect src, dest;
+	SDL_Surface *glyph;
+
+	if (glyphs->drawn[c / 8] & (1 << (c % 8))) return TRUE;
+
+	glyph = TTF_RenderGlyph_Shaded(font->sdl_font, (Uint16)c, colour, bg);
+	if (!glyph) return FALSE;
+
+	RECT(0, 0, font->width, font->height, &src);
+	RECT(c * font->width, 0, font->width, font->height, &dest);
+	SDL_BlitSurface(glyph, &src, glyphs->atlas, &dest);
+	SDL_FreeSurface(glyph);
+
+	glyphs->drawn[c / 8] |= 1 << (c % 8);
+	return TRUE;
+}
+
 /**
  * Draw some text onto a surface, allowing shaded backgrounds
  * The surface is first checked to see if it is compatible with
  * this font, if it isn't the the font will be 're-precalculated'
  *
+ * Glyphs come from the cache for attr 'a', which is filled in as they are
+ * first used; anything outside it is rendered as it comes.
+ *
  * You can, I suppose, use one font on many surfaces, but it is
  * definitely not recommended. One font per surface is good enough.
  */
-static errr sdl_mapFontDraw(sdl_Font *font, SDL_Surface *surface,
+static errr sdl_mapFontDraw(sdl_Font *font, SDL_Surface *surface, int a,
 							SDL_Color colour, SDL_Color bg, int x, int y,
-							int n , const char *s)
+							int n, const wchar_t *s)
 {
 	Uint8 bpp = surface->format->BytesPerPixel;
 	Uint16 pitch = surface->pitch;
 
-	SDL_Rect rc;
-	SDL_Surface *text;
+	sdl_Glyphs *glyphs;
+	SDL_Rect src, rc;
+	int i;
 
 	if ((bpp != font->bpp) || (pitch != font->pitch))
 		sdl_FontCreate(font, font->name, surface);
 
-	/* Lock the window surface (if necessary) */
-	if (SDL_MUSTLOCK(surface))
-		if (SDL_LockSurface(surface) < 0)
-			return (-1);
+	glyphs = sdl_FontGlyphs(font, surface, a, bg);
 
-	RECT(x, y, n * font->width, font->height, &rc);
-	text = TTF_RenderUTF8_Shaded(font->sdl_font, s, colour, bg);
-	if (text) {
-	    SDL_BlitSurface(text, NULL, surface, &rc);
-	    SDL_FreeSurface(text);
-	}
+	for (i = 0; i < n; i++) {
+		unsigned long c = (unsigned long)s[i];
 
-	/* Unlock the surface */
-	if (SDL_MUSTLOCK(surface)) SDL_UnlockSurface(surface);
+		RECT(x + i * font->width, y, font->width, font->height, &rc);
+
+		if (glyphs && (c < NUM_GLYPHS) &&
+			sdl_GlyphDraw(font, glyphs, (int)c, colour, bg)) {
+			RECT((int)c * font->width, 0, font->width, font->height, &src);
+			SDL_BlitSurface(glyphs->atlas, &src, surface, &rc);
+		} else {
+			wchar_t wc[2];
+			char mbstr[MB_LEN_MAX + 1];
+			size_t len;
+			SDL_Surface *text;
+
+			/* Convert to UTF-8 for display */
+			wc[0] = s[i];
+			wc[1] = L'\0';
+			len = wcstombs(mbstr, wc, MB_LEN_MAX);
+			if (len == (size_t)-1) continue;
+			mbstr[len] = '\0';
+
+			text = TTF_RenderUTF8_Shaded(font->sdl_font, mbstr, colour, bg);
+			if (text) {
+				SDL_BlitSurface(text, NULL, surface, &rc);
+				SDL_FreeSurface(text);
+			}
+		}
+	}
 
 	/* Success */
 	return (0);
@@ -2768,6 +2881,10 @@ static errr Term_xtra_sdl(int n, int v)
 				text_colours[i].g = angband_color_table[i][2];
 				text_colours[i].b = angband_color_table[i][3];
 			}
+
+			/* The cached glyphs are in the old colours */
+			for (i = 0; i < ANGBAND_TERM_MAX; i++)
+				sdl_FontFlush(&windows[i].font);
 		}
 	}
 
@@ -2811,9 +2928,6 @@ static errr Term_text_sdl(int col, int row, int n, int a, const wchar_t *s)
 	SDL_Color bg = text_colours[COLOUR_DARK];
 	int x = col * win->tile_wid;
 	int y = row * win->tile_hgt;
-	wchar_t src[255];
-	char mbstr[MB_LEN_MAX * 255];
-	size_t len;
 
 	/* Translate */
 	x += win->border;
@@ -2825,13 +2939,6 @@ static errr Term_text_sdl(int col, int row, int n, int a, const wchar_t *s)
 	/* Clear the way */
 	Term_wipe_sdl(col, row, n);
 
-	/* Take a copy of the incoming string, but truncate it at n chars */
-	wcsncpy(src, s, n);
-	src[n] = L'\0';
-	/* Convert to UTF-8 for display */
-	len = wcstombs(mbstr, src, n * MB_LEN_MAX);
-	mbstr[len] = '\0';
-
 	/* Handle background */
 	switch (a / MAX_COLORS)
 	{
@@ -2849,8 +2956,8 @@ static errr Term_text_sdl(int col, int row, int n, int a, const wchar_t *s)
 	}
 
 	/* Draw it */
-	return (sdl_mapFontDraw(&win->font, win->surface, colour, bg, x, y, n,
-							mbstr));
+	return (sdl_mapFontDraw(&win->font, win->surface, a, colour, bg, x, y, n,
+							s));
 }
 
 /**
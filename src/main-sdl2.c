@@ -0,0 +1,806 @@
+/**
+ * \file main-sdl2.c
+ * \brief Angband SDL2 port, drawing through the SDL2 renderer
+ *
+ * Copyright (c) 2015 The Angband developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+#include "angband.h"
+#include "buildid.h"
+#include "init.h"
+#include "ui-game.h"
+#include "ui-input.h"
+#include "ui-prefs.h"
+#include "ui-term.h"
+
+#ifdef USE_SDL2
+
+#include "main.h"
+#include "grafmode.h"
+#include "SDL.h"
+#include "SDL_ttf.h"
+#include "SDL_image.h"
+
+/**
+ * This port drives a single main term through the SDL2 renderer.
+ *
+ * The screen is kept in a render-target texture the size of the window.
+ * Each Term_fresh() hands over every changed grid at once (see "batch_hook"
+ * in ui-term.c), and they are drawn straight into that texture: backgrounds
+ * with one SDL_RenderFillRects(), text from a texture atlas of pre-rendered
+ * white glyphs tinted per colour, and graphical tiles from the tile sheet,
+ * which is uploaded as a single texture when the graphics mode is chosen.
+ * SDL queues these copies and submits them together, so a full redraw of a
+ * large window is one upload-free pass on the GPU.  TERM_XTRA_FRESH copies
+ * the texture to the window, adds the cursor and presents.
+ *
+ * Options:
+ *   -g<n>     Use graphics mode <n> from graphics.txt
+ *   -f<font>  Use the named font from lib/xtra/font
+ *   -s<n>     Use a font size of <n> points for scalable fonts
+ */
+
+static const char *DEFAULT_FONT_FILE = "6x10x.fon";
+
+/* Glyphs kept in the atlas: the Latin-1 range */
+#define GLYPH_COUNT	256
+#define GLYPH_COLS	32
+
+static SDL_Window *window;
+static SDL_Renderer *renderer;
+
+/* The whole screen, as last drawn */
+static SDL_Texture *screen;
+
+/* White glyphs, GLYPH_COLS across */
+static SDL_Texture *glyphs;
+static TTF_Font *font;
+
+/* The tile sheet of the current graphics mode, if any */
+static SDL_Texture *tiles;
+
+/* Size of one text cell, in pixels */
+static int cell_w, cell_h;
+
+/* The cursor, drawn over the screen at each refresh */
+static bool cursor_on;
+static bool cursor_big;
+static int cursor_x, cursor_y;
+
+/* Keydown events that produced a key, so the matching text is ignored */
+static bool text_used;
+
+static SDL_Color colours[MAX_COLORS];
+
+static term main_term;
+
+/* Background rectangles of the batch being drawn */
+static SDL_Rect *fill_rects;
+static int fill_rects_max;
+
+
+/**
+ * Load the colours from the game's colour table
+ */
+static void sdl2_load_colours(void)
+{
+	int i;
+
+	for (i = 0; i < MAX_COLORS; i++) {
+		colours[i].r = angband_color_table[i][1];
+		colours[i].g = angband_color_table[i][2];
+		colours[i].b = angband_color_table[i][3];
+		colours[i].a = 255;
+	}
+}
+
+/**
+ * Render each glyph of the atlas once, in white, so that it can be tinted
+ * with SDL_SetTextureColorMod() when drawn.
+ */
+static bool sdl2_build_glyphs(void)
+{
+	SDL_Surface *atlas;
+	SDL_Color white = { 255, 255, 255, 255 };
+	int i;
+
+	atlas = SDL_CreateRGBSurface(0, GLYPH_COLS * cell_w,
+			(GLYPH_COUNT / GLYPH_COLS) * cell_h, 32,
+			0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+	if (!atlas) return FALSE;
+
+	for (i = ' '; i < GLYPH_COUNT; i++) {
+		SDL_Surface *glyph;
+		SDL_Rect dst;
+
+		if (!TTF_GlyphIsProvided(font, (Uint16)i)) continue;
+		glyph = TTF_RenderGlyph_Blended(font, (Uint16)i, white);
+		if (!glyph) continue;
+
+		dst.x = (i % GLYPH_COLS) * cell_w;
+		dst.y = (i / GLYPH_COLS) * cell_h;
+		dst.w = glyph->w;
+		dst.h = glyph->h;
+		SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_NONE);
+		SDL_BlitSurface(glyph, NULL, atlas, &dst);
+		SDL_FreeSurface(glyph);
+	}
+
+	if (glyphs) SDL_DestroyTexture(glyphs);
+	glyphs = SDL_CreateTextureFromSurface(renderer, atlas);
+	SDL_FreeSurface(atlas);
+	if (!glyphs) return FALSE;
+
+	SDL_SetTextureBlendMode(glyphs, SDL_BLENDMODE_BLEND);
+	return TRUE;
+}
+
+/**
+ * Open a font and size the text cells from it
+ */
+static bool sdl2_load_font(const char *name, int size)
+{
+	char path[1024];
+
+	path_build(path, sizeof(path), ANGBAND_DIR_XTRA_FONT, name);
+	font = TTF_OpenFont(path, size);
+	if (!font) {
+		plog_fmt("Couldn't open font %s: %s", path, TTF_GetError());
+		return FALSE;
+	}
+
+	if (TTF_SizeText(font, "M", &cell_w, &cell_h)) return FALSE;
+	cell_h = MAX(cell_h, TTF_FontLineSkip(font));
+
+	return sdl2_build_glyphs();
+}
+
+/**
+ * Upload the tile sheet for the current graphics mode as one texture
+ */
+static void sdl2_load_tiles(void)
+{
+	char path[1024];
+	SDL_Surface *sheet;
+
+	if (tiles) SDL_DestroyTexture(tiles);
+	tiles = NULL;
+
+	current_graphics_mode = get_graphics_mode(use_graphics);
+	if (!current_graphics_mode || !current_graphics_mode->file[0]) {
+		use_graphics = GRAPHICS_NONE;
+		current_graphics_mode = NULL;
+		return;
+	}
+
+	path_build(path, sizeof(path), ANGBAND_DIR_XTRA_GRAF,
+			   current_graphics_mode->file);
+	sheet = IMG_Load(path);
+	if (!sheet) {
+		plog_fmt("Couldn't load tiles %s: %s", path, IMG_GetError());
+		use_graphics = GRAPHICS_NONE;
+		current_graphics_mode = NULL;
+		return;
+	}
+
+	tiles = SDL_CreateTextureFromSurface(renderer, sheet);
+	SDL_FreeSurface(sheet);
+	if (!tiles) {
+		use_graphics = GRAPHICS_NONE;
+		current_graphics_mode = NULL;
+		return;
+	}
+
+	if (current_graphics_mode->alphablend)
+		SDL_SetTextureBlendMode(tiles, SDL_BLENDMODE_BLEND);
+}
+
+/**
+ * (Re)create the screen texture to fit the window
+ */
+static bool sdl2_make_screen(int w, int h)
+{
+	if (screen) SDL_DestroyTexture(screen);
+	screen = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+							   SDL_TEXTUREACCESS_TARGET, w, h);
+	if (!screen) return FALSE;
+
+	SDL_SetRenderTarget(renderer, screen);
+	SDL_SetRenderDrawColor(renderer, colours[COLOUR_DARK].r,
+						   colours[COLOUR_DARK].g, colours[COLOUR_DARK].b, 255);
+	SDL_RenderClear(renderer);
+	SDL_SetRenderTarget(renderer, NULL);
+
+	return TRUE;
+}
+
+
+/**
+ * Draw one tile from the sheet, stretched over a grid (or a big tile)
+ */
+static void sdl2_draw_tile(int a, wchar_t c, const SDL_Rect *dst)
+{
+	SDL_Rect src;
+
+	src.w = current_graphics_mode->cell_width;
+	src.h = current_graphics_mode->cell_height;
+	src.x = (c & 0x7F) * src.w;
+	src.y = (a & 0x7F) * src.h;
+
+	SDL_RenderCopy(renderer, tiles, &src, dst);
+}
+
+/**
+ * Draw one glyph from the atlas, tinted to an attr
+ */
+static void sdl2_draw_glyph(int a, wchar_t c, const SDL_Rect *dst)
+{
+	SDL_Rect src;
+	SDL_Color *col = &colours[a % MAX_COLORS];
+
+	/* Nothing to draw over the background */
+	if (c == L' ' || a == COLOUR_DARK) return;
+	if (c < 0 || c >= GLYPH_COUNT) c = L'?';
+
+	src.x = (c % GLYPH_COLS) * cell_w;
+	src.y = (c / GLYPH_COLS) * cell_h;
+	src.w = cell_w;
+	src.h = cell_h;
+
+	SDL_SetTextureColorMod(glyphs, col->r, col->g, col->b);
+	SDL_RenderCopy(renderer, glyphs, &src, dst);
+}
+
+/**
+ * Draw every changed grid of a refresh into the screen texture.
+ *
+ * Text grids get their backgrounds cleared together first; tiles cover their
+ * grid completely, terrain first and then whatever stands on it.
+ */
+static errr Term_batch_sdl2(const term_cell *cells, int n)
+{
+	int i, fills = 0;
+
+	if (n > fill_rects_max) {
+		fill_rects_max = n;
+		fill_rects = mem_realloc(fill_rects,
+								 fill_rects_max * sizeof(*fill_rects));
+	}
+
+	SDL_SetRenderTarget(renderer, screen);
+
+	/* Clear the text grids */
+	for (i = 0; i < n; i++) {
+		if ((cells[i].a & 0x80) && tiles) continue;
+
+		fill_rects[fills].x = cells[i].x * cell_w;
+		fill_rects[fills].y = cells[i].y * cell_h;
+		fill_rects[fills].w = cell_w;
+		fill_rects[fills].h = cell_h;
+		fills++;
+	}
+	SDL_SetRenderDrawColor(renderer, colours[COLOUR_DARK].r,
+						   colours[COLOUR_DARK].g, colours[COLOUR_DARK].b, 255);
+	SDL_RenderFillRects(renderer, fill_rects, fills);
+
+	/* Draw the contents */
+	for (i = 0; i < n; i++) {
+		const term_cell *cell = &cells[i];
+		SDL_Rect dst;
+
+		dst.x = cell->x * cell_w;
+		dst.y = cell->y * cell_h;
+		dst.w = cell_w;
+		dst.h = cell_h;
+
+		if ((cell->a & 0x80) && tiles) {
+			dst.w *= tile_width;
+			dst.h *= tile_height;
+
+			sdl2_draw_tile(cell->ta, cell->tc, &dst);
+			if (cell->ta != cell->a || cell->tc != cell->c)
+				sdl2_draw_tile(cell->a, cell->c, &dst);
+		} else {
+			sdl2_draw_glyph(cell->a, cell->c, &dst);
+		}
+	}
+
+	SDL_SetRenderTarget(renderer, NULL);
+
+	return (0);
+}
+
+/**
+ * The single-run hooks, for the few places in ui-term.c that draw outside
+ * Term_fresh(), go through the batch drawing too.
+ */
+static errr Term_wipe_sdl2(int x, int y, int n)
+{
+	term_cell cells[256];
+	int i;
+
+	for (i = 0; i < n && i < 256; i++) {
+		cells[i].x = x + i;
+		cells[i].y = y;
+		cells[i].a = cells[i].ta = COLOUR_DARK;
+		cells[i].c = cells[i].tc = L' ';
+	}
+
+	return Term_batch_sdl2(cells, i);
+}
+
+static errr Term_text_sdl2(int x, int y, int n, int a, const wchar_t *s)
+{
+	term_cell cells[256];
+	int i;
+
+	for (i = 0; i < n && i < 256; i++) {
+		cells[i].x = x + i;
+		cells[i].y = y;
+		cells[i].a = cells[i].ta = a;
+		cells[i].c = cells[i].tc = s[i];
+	}
+
+	return Term_batch_sdl2(cells, i);
+}
+
+static errr Term_pict_sdl2(int x, int y, int n, const int *ap,
+						   const wchar_t *cp, const int *tap, const wchar_t *tcp)
+{
+	term_cell cells[256];
+	int i;
+
+	for (i = 0; i < n && i < 256; i++) {
+		cells[i].x = x + i;
+		cells[i].y = y;
+		cells[i].a = ap[i];
+		cells[i].c = cp[i];
+		cells[i].ta = tap[i];
+		cells[i].tc = tcp[i];
+	}
+
+	return Term_batch_sdl2(cells, i);
+}
+
+static errr Term_curs_sdl2(int x, int y)
+{
+	cursor_x = x;
+	cursor_y = y;
+	cursor_big = FALSE;
+	return (0);
+}
+
+static errr Term_bigcurs_sdl2(int x, int y)
+{
+	cursor_x = x;
+	cursor_y = y;
+	cursor_big = TRUE;
+	return (0);
+}
+
+/**
+ * Show the screen texture, with the cursor on top
+ */
+static void sdl2_present(void)
+{
+	SDL_RenderCopy(renderer, screen, NULL, NULL);
+
+	if (cursor_on) {
+		SDL_Rect rc;
+		SDL_Color *col = &colours[COLOUR_YELLOW];
+
+		rc.x = cursor_x * cell_w;
+		rc.y = cursor_y * cell_h;
+		rc.w = cell_w * (cursor_big ? tile_width : 1);
+		rc.h = cell_h * (cursor_big ? tile_height : 1);
+		SDL_SetRenderDrawColor(renderer, col->r, col->g, col->b, 255);
+		SDL_RenderDrawRect(renderer, &rc);
+	}
+
+	SDL_RenderPresent(renderer);
+}
+
+
+/**
+ * Fit the main term to the window, keeping at least 80x24 grids
+ */
+static void sdl2_resize(int w, int h)
+{
+	int cols = MAX(w / cell_w, 80);
+	int rows = MAX(h / cell_h, 24);
+
+	if (!sdl2_make_screen(cols * cell_w, rows * cell_h)) return;
+
+	Term_activate(&main_term);
+	Term_resize(cols, rows);
+	Term_redraw();
+	Term_fresh();
+}
+
+/**
+ * Decode the first character of some UTF-8 text
+ */
+static keycode_t sdl2_utf8_char(const char *s)
+{
+	const unsigned char *u = (const unsigned char *)s;
+
+	if (u[0] < 0x80) return u[0];
+	if ((u[0] & 0xE0) == 0xC0 && u[1])
+		return ((u[0] & 0x1F) << 6) | (u[1] & 0x3F);
+	if ((u[0] & 0xF0) == 0xE0 && u[1] && u[2])
+		return ((u[0] & 0x0F) << 12) | ((u[1] & 0x3F) << 6) | (u[2] & 0x3F);
+	return 0;
+}
+
+/**
+ * Handle a key going down.  Keys with no text of their own, and anything
+ * pressed with control or alt, are sent from here; plain text arrives as
+ * SDL_TEXTINPUT instead.
+ */
+static void sdl2_keydown(const SDL_Keysym *keysym)
+{
+	SDL_Keycode sym = keysym->sym;
+	bool mc = (keysym->mod & KMOD_CTRL) != 0;
+	bool ms = (keysym->mod & KMOD_SHIFT) != 0;
+	bool ma = (keysym->mod & KMOD_ALT) != 0;
+	bool mm = (keysym->mod & KMOD_GUI) != 0;
+	bool kp = FALSE;
+	keycode_t ch = 0;
+	byte mods = (ma ? KC_MOD_ALT : 0) | (mm ? KC_MOD_META : 0);
+
+	text_used = FALSE;
+
+	switch (sym) {
+		/* keypad */
+		case SDLK_KP_0: ch = '0'; kp = TRUE; break;
+		case SDLK_KP_1: ch = '1'; kp = TRUE; break;
+		case SDLK_KP_2: ch = '2'; kp = TRUE; break;
+		case SDLK_KP_3: ch = '3'; kp = TRUE; break;
+		case SDLK_KP_4: ch = '4'; kp = TRUE; break;
+		case SDLK_KP_5: ch = '5'; kp = TRUE; break;
+		case SDLK_KP_6: ch = '6'; kp = TRUE; break;
+		case SDLK_KP_7: ch = '7'; kp = TRUE; break;
+		case SDLK_KP_8: ch = '8'; kp = TRUE; break;
+		case SDLK_KP_9: ch = '9'; kp = TRUE; break;
+		case SDLK_KP_PERIOD: ch = '.'; kp = TRUE; break;
+		case SDLK_KP_DIVIDE: ch = '/'; kp = TRUE; break;
+		case SDLK_KP_MULTIPLY: ch = '*'; kp = TRUE; break;
+		case SDLK_KP_MINUS: ch = '-'; kp = TRUE; break;
+		case SDLK_KP_PLUS: ch = '+'; kp = TRUE; break;
+		case SDLK_KP_ENTER: ch = KC_ENTER; kp = TRUE; break;
+		case SDLK_KP_EQUALS: ch = '='; kp = TRUE; break;
+
+		case SDLK_UP: ch = ARROW_UP; break;
+		case SDLK_DOWN: ch = ARROW_DOWN; break;
+		case SDLK_RIGHT: ch = ARROW_RIGHT; break;
+		case SDLK_LEFT: ch = ARROW_LEFT; break;
+
+		case SDLK_INSERT: ch = KC_INSERT; break;
+		case SDLK_HOME: ch = KC_HOME; break;
+		case SDLK_PAGEUP: ch = KC_PGUP; break;
+		case SDLK_DELETE: ch = KC_DELETE; break;
+		case SDLK_END: ch = KC_END; break;
+		case SDLK_PAGEDOWN: ch = KC_PGDOWN; break;
+		case SDLK_ESCAPE: ch = ESCAPE; break;
+		case SDLK_BACKSPACE: ch = KC_BACKSPACE; break;
+		case SDLK_RETURN: ch = KC_ENTER; break;
+		case SDLK_TAB: ch = KC_TAB; break;
+
+		case SDLK_F1: ch = KC_F1; break;
+		case SDLK_F2: ch = KC_F2; break;
+		case SDLK_F3: ch = KC_F3; break;
+		case SDLK_F4: ch = KC_F4; break;
+		case SDLK_F5: ch = KC_F5; break;
+		case SDLK_F6: ch = KC_F6; break;
+		case SDLK_F7: ch = KC_F7; break;
+		case SDLK_F8: ch = KC_F8; break;
+		case SDLK_F9: ch = KC_F9; break;
+		case SDLK_F10: ch = KC_F10; break;
+		case SDLK_F11: ch = KC_F11; break;
+		case SDLK_F12: ch = KC_F12; break;
+		case SDLK_F13: ch = KC_F13; break;
+		case SDLK_F14: ch = KC_F14; break;
+		case SDLK_F15: ch = KC_F15; break;
+
+		default: break;
+	}
+
+	if (ch) {
+		if (kp) mods |= KC_MOD_KEYPAD;
+		if (mc) mods |= KC_MOD_CONTROL;
+		if (ms) mods |= KC_MOD_SHIFT;
+		Term_keypress(ch, mods);
+
+		/* Keypad digits also produce text */
+		text_used = TRUE;
+	} else if ((mc || ma) && sym > 0 && sym < 0x7F) {
+		ch = sym;
+
+		/* Control letters are encoded in the key itself */
+		if (mc) {
+			if (ENCODE_KTRL(toupper((unsigned char)ch)))
+				ch = KTRL(toupper((unsigned char)ch));
+			else
+				mods |= KC_MOD_CONTROL;
+		}
+		if (ms && MODS_INCLUDE_SHIFT(ch)) mods |= KC_MOD_SHIFT;
+
+		Term_keypress(ch, mods);
+		text_used = TRUE;
+	}
+}
+
+/**
+ * Handle one SDL event
+ */
+static void sdl2_handle_event(const SDL_Event *event)
+{
+	switch (event->type) {
+		case SDL_KEYDOWN:
+			sdl2_keydown(&event->key.keysym);
+			break;
+
+		case SDL_TEXTINPUT:
+		{
+			keycode_t ch;
+
+			/* Already sent as a keypress */
+			if (text_used) {
+				text_used = FALSE;
+				break;
+			}
+
+			ch = sdl2_utf8_char(event->text.text);
+			if (ch) Term_keypress(ch, 0);
+			break;
+		}
+
+		case SDL_MOUSEBUTTONDOWN:
+			Term_mousepress(event->button.x / cell_w,
+							event->button.y / cell_h, event->button.button);
+			break;
+
+		case SDL_WINDOWEVENT:
+			if (event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+				sdl2_resize(event->window.data1, event->window.data2);
+			else if (event->window.event == SDL_WINDOWEVENT_EXPOSED)
+				sdl2_present();
+			break;
+
+		case SDL_QUIT:
+			save_game();
+			quit(NULL);
+			break;
+
+		default:
+			break;
+	}
+}
+
+static errr Term_xtra_sdl2(int n, int v)
+{
+	SDL_Event event;
+
+	switch (n) {
+		/* Process an event, waiting for one if asked */
+		case TERM_XTRA_EVENT:
+		{
+			if (v) {
+				if (!SDL_WaitEvent(&event)) return (1);
+			} else if (!SDL_PollEvent(&event)) {
+				return (0);
+			}
+			sdl2_handle_event(&event);
+			return (0);
+		}
+
+		/* Flush all events */
+		case TERM_XTRA_FLUSH:
+		{
+			while (SDL_PollEvent(&event))
+				sdl2_handle_event(&event);
+			return (0);
+		}
+
+		/* Clear the screen */
+		case TERM_XTRA_CLEAR:
+		{
+			SDL_SetRenderTarget(renderer, screen);
+			SDL_SetRenderDrawColor(renderer, colours[COLOUR_DARK].r,
+								   colours[COLOUR_DARK].g,
+								   colours[COLOUR_DARK].b, 255);
+			SDL_RenderClear(renderer);
+			SDL_SetRenderTarget(renderer, NULL);
+			return (0);
+		}
+
+		/* Show or hide the cursor */
+		case TERM_XTRA_SHAPE:
+		{
+			cursor_on = v ? TRUE : FALSE;
+			return (0);
+		}
+
+		/* Show what has been drawn */
+		case TERM_XTRA_FRESH:
+		{
+			sdl2_present();
+			return (0);
+		}
+
+		case TERM_XTRA_DELAY:
+		{
+			if (v > 0) SDL_Delay(v);
+			return (0);
+		}
+
+		/* React to changes in colours or graphics */
+		case TERM_XTRA_REACT:
+		{
+			sdl2_load_colours();
+			if (use_graphics != (current_graphics_mode ?
+								 current_graphics_mode->grafID : 0)) {
+				sdl2_load_tiles();
+				reset_visuals(TRUE);
+			}
+			return (0);
+		}
+	}
+
+	/* Unknown or unhandled action */
+	return (1);
+}
+
+
+/**
+ * Free everything
+ */
+static void hook_quit(const char *str)
+{
+	/* Unused */
+	(void)str;
+
+	(void)term_nuke(&main_term);
+
+	mem_free(fill_rects);
+	if (tiles) SDL_DestroyTexture(tiles);
+	if (glyphs) SDL_DestroyTexture(glyphs);
+	if (screen) SDL_DestroyTexture(screen);
+	if (font) TTF_CloseFont(font);
+	if (renderer) SDL_DestroyRenderer(renderer);
+	if (window) SDL_DestroyWindow(window);
+
+	close_graphics_modes();
+
+	IMG_Quit();
+	TTF_Quit();
+	SDL_Quit();
+}
+
+
+const char help_sdl2[] = "SDL2 renderer frontend, subopts -g<mode> -f<font> -s<size>";
+
+/**
+ * The SDL2 port's "main()" function.
+ */
+errr init_sdl2(int argc, char **argv)
+{
+	const char *font_name = DEFAULT_FONT_FILE;
+	int font_size = 12;
+	int i;
+	term *t = &main_term;
+
+	/* Parse args */
+	for (i = 1; i < argc; i++) {
+		if (prefix(argv[i], "-g")) {
+			use_graphics = atoi(&argv[i][2]);
+			arg_graphics = use_graphics ? TRUE : FALSE;
+			continue;
+		}
+
+		if (prefix(argv[i], "-f")) {
+			font_name = &argv[i][2];
+			continue;
+		}
+
+		if (prefix(argv[i], "-s")) {
+			font_size = atoi(&argv[i][2]);
+			continue;
+		}
+
+		plog_fmt("Ignoring option: %s", argv[i]);
+	}
+
+	if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return (2);
+	}
+
+	if (TTF_Init() < 0) {
+		fprintf(stderr, "Couldn't initialize TTF: %s\n", TTF_GetError());
+		SDL_Quit();
+		return (2);
+	}
+	IMG_Init(IMG_INIT_PNG);
+
+	window = SDL_CreateWindow(VERSION_NAME, SDL_WINDOWPOS_UNDEFINED,
+							  SDL_WINDOWPOS_UNDEFINED, 640, 480,
+							  SDL_WINDOW_RESIZABLE);
+	if (!window) {
+		fprintf(stderr, "Couldn't open a window: %s\n", SDL_GetError());
+		SDL_Quit();
+		return (2);
+	}
+
+	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED |
+								  SDL_RENDERER_TARGETTEXTURE);
+	if (!renderer) {
+		fprintf(stderr, "Couldn't create a renderer: %s\n", SDL_GetError());
+		SDL_DestroyWindow(window);
+		SDL_Quit();
+		return (2);
+	}
+
+	sdl2_load_colours();
+	if (!sdl2_load_font(font_name, font_size)) {
+		SDL_DestroyRenderer(renderer);
+		SDL_DestroyWindow(window);
+		SDL_Quit();
+		return (2);
+	}
+
+	/* Size the window to a standard 80x24 term */
+	SDL_SetWindowSize(window, 80 * cell_w, 24 * cell_h);
+	SDL_SetWindowMinimumSize(window, 80 * cell_w, 24 * cell_h);
+	if (!sdl2_make_screen(80 * cell_w, 24 * cell_h)) return (2);
+
+	/* Load the graphics modes and the chosen tile sheet */
+	init_graphics_modes("graphics.txt");
+	if (use_graphics) sdl2_load_tiles();
+
+	/* Initialize the term */
+	term_init(t, 80, 24, 256);
+
+	/* Hardware-style cursor, drawn at each refresh */
+	t->soft_cursor = FALSE;
+	t->higher_pict = TRUE;
+
+	/* Erase with "white space" */
+	t->attr_blank = COLOUR_WHITE;
+	t->char_blank = ' ';
+
+	/* Differentiate between BS/^h, Tab/^i, etc. */
+	t->complex_input = TRUE;
+
+	/* Hooks */
+	t->xtra_hook = Term_xtra_sdl2;
+	t->curs_hook = Term_curs_sdl2;
+	t->bigcurs_hook = Term_bigcurs_sdl2;
+	t->wipe_hook = Term_wipe_sdl2;
+	t->text_hook = Term_text_sdl2;
+	t->pict_hook = Term_pict_sdl2;
+	t->batch_hook = Term_batch_sdl2;
+
+	Term_activate(t);
+	angband_term[0] = t;
+	term_screen = t;
+
+	SDL_StartTextInput();
+
+	/* Activate quit hook */
+	quit_aux = hook_quit;
+
+	return (0);
+}
+
+#endif /* USE_SDL2 */
@@ -22,26 +22,36 @@
 
 #include "buildid.h"
 #include "game-world.h"
+#include "generate.h"
 #include "init.h"
 #include "main.h"
+#include "mon-lore.h"
 #include "mon-make.h"
 #include "monster.h"
+#include "obj-desc.h"
 #include "obj-gear.h"
 #include "obj-identify.h"
+#include "obj-pile.h"
 #include "obj-power.h"
 #include "obj-randart.h"
+#include "obj-slays.h"
 #include "obj-tval.h"
 #include "obj-util.h"
 #include "object.h"
 #include "player.h"
 #include "player-birth.h"
+#include "player-quest.h"
+#include "player-timed.h"
 #include "player-util.h"
 #include "project.h"
+#include "stats/cols.h"
 #include "stats/db.h"
 #include "stats/structs.h"
 #include "store.h"
 #include <stddef.h>
+#include <sys/wait.h>
 #include <time.h>
+#include <unistd.h>
 
 #define OBJ_FEEL_MAX	 11
 #define MON_FEEL_MAX 	 10
@@ -67,12 +77,27 @@ static int randarts = 0;
 static int no_selling = 0;
 static u32b num_runs = 1;
 static bool quiet = FALSE;
+static u32b base_seed = 0;
+static rng_state run_seeds;
+static int shard_count = 1;
+static int shard_index = -1;
+static bool jobs = FALSE;
+static bool merge_shards = FALSE;
+static bool scratch_db = FALSE;
+static bool column_output = FALSE;
+static bool sample_items = FALSE;
+static int bench_min = 0;
+static int bench_max = 0;
+static char *bench_profile;
+static char *cols_dir;
 static int nextkey = 0;
 static int running_stats = 0;
 static char *ANGBAND_DIR_STATS;
 
 static int *consumables_index;
 static int *wearables_index;
+static int *consumables_kidx;
+static int *wearables_kidx;
 static int wearable_count = 0;
 static int consumable_count = 0;
 
@@ -121,6 +146,16 @@ static void create_indices()
 		else
 			consumables_index[i] = ++consumable_count;
 	}
+
+	/* Map back the other way for writing the database */
+	consumables_kidx = mem_zalloc((consumable_count + 1) * sizeof(int));
+	wearables_kidx = mem_zalloc((wearable_count + 1) * sizeof(int));
+	for (i = 0; i < z_info->k_max; i++) {
+		if (consumables_index[i])
+			consumables_kidx[consumables_index[i]] = i;
+		if (wearables_index[i])
+			wearables_kidx[wearables_index[i]] = i;
+	}
 }
 
 static void alloc_memory()
@@ -173,12 +208,16 @@ static void free_stats_memory(void)
 	}
 	mem_free(consumables_index);
 	mem_free(wearables_index);
+	mem_free(consumables_kidx);
+	mem_free(wearables_kidx);
 	string_free(ANGBAND_DIR_STATS);
 }
 
 /* Copied from birth.c:generate_player() */
 static void generate_player_for_stats()
 {
+	int i;
+
 	OPT(birth_randarts) = randarts;
 	OPT(birth_no_selling) = no_selling;
 	OPT(birth_no_stacking) = FALSE;
@@ -189,6 +228,16 @@ static void generate_player_for_stats()
 	player->race = races;  /* Human   */
 	player->class = classes; /* Warrior */
 
+	/* Object values depend on the slots the player has; the names are
+	 * borrowed from the body template, not owned */
+	memcpy(&player->body, &bodies[player->race->body], sizeof(player->body));
+	player->body.slots = mem_zalloc(player->body.count *
+									sizeof(struct equip_slot));
+	for (i = 0; i < player->body.count; i++) {
+		player->body.slots[i].type = bodies[player->race->body].slots[i].type;
+		player->body.slots[i].name = bodies[player->race->body].slots[i].name;
+	}
+
 	/* Level 1 */
 	player->max_lev = player->lev = 1;
 
@@ -208,9 +257,111 @@ static void generate_player_for_stats()
 	player->ht = player->ht_birth = 66;
 	player->wt = player->wt_birth = 150;
 	player->age = 14;
+}
 
-	/* Set social class and (null) history */
-	player->history = get_history(player->race->history);
+/*** Fast run reset ***/
+
+/**
+ * Copies of the character as first made, with its buffers.  Each run puts
+ * these back over the same buffers instead of freeing and remaking the
+ * player; quest names are shared with the copy rather than duplicated.
+ * Store owners are kept too, since store_reset() picks new ones by
+ * rerolling until they differ from the old.
+ */
+static struct player player_start;
+static struct player_upkeep upkeep_start;
+static s16b timed_start[TMD_MAX];
+static struct quest *quests_start;
+static struct equip_slot *slots_start;
+static struct owner *owners_start[MAX_STORES];
+
+static void stats_snapshot(void)
+{
+	int i;
+
+	player_init(player);
+	generate_player_for_stats();
+
+	memcpy(&player_start, player, sizeof(player_start));
+	memcpy(&upkeep_start, player->upkeep, sizeof(upkeep_start));
+	memcpy(timed_start, player->timed, sizeof(timed_start));
+	quests_start = mem_alloc(z_info->quest_max * sizeof(struct quest));
+	memcpy(quests_start, player->quests,
+		   z_info->quest_max * sizeof(struct quest));
+	slots_start = mem_alloc(player->body.count * sizeof(struct equip_slot));
+	memcpy(slots_start, player->body.slots,
+		   player->body.count * sizeof(struct equip_slot));
+
+	for (i = 0; i < MAX_STORES; i++)
+		owners_start[i] = stores[i].owner;
+}
+
+/**
+ * Put the player and the game data back as player_init() and
+ * generate_player_for_stats() would leave them, without allocation
+ */
+static void stats_reset_run(void)
+{
+	struct player_upkeep *upkeep = player->upkeep;
+	struct object **inven = upkeep->inven;
+	struct object **quiver = upkeep->quiver;
+	s16b *timed = player->timed;
+	struct quest *quests = player->quests;
+	struct equip_slot *slots = player->body.slots;
+	int i;
+
+	memcpy(player, &player_start, sizeof(*player));
+	player->upkeep = upkeep;
+	player->timed = timed;
+	player->quests = quests;
+	player->body.slots = slots;
+
+	memcpy(upkeep, &upkeep_start, sizeof(*upkeep));
+	upkeep->inven = inven;
+	upkeep->quiver = quiver;
+	memset(inven, 0, (z_info->pack_size + 1) * sizeof(struct object *));
+	memset(quiver, 0, z_info->quiver_size * sizeof(struct object *));
+
+	memcpy(timed, timed_start, sizeof(timed_start));
+	memcpy(quests, quests_start, z_info->quest_max * sizeof(struct quest));
+	memcpy(slots, slots_start, player->body.count * sizeof(struct equip_slot));
+
+	/* No artifacts made, nothing learnt, and every unique alive */
+	for (i = 0; i < z_info->a_max; i++) {
+		a_info[i].created = FALSE;
+		a_info[i].seen = FALSE;
+	}
+
+	for (i = 1; i < z_info->k_max; i++) {
+		k_info[i].tried = FALSE;
+		k_info[i].aware = FALSE;
+	}
+	object_desc_invalidate();
+
+	for (i = 1; i < z_info->r_max; i++) {
+		r_info[i].cur_num = 0;
+		r_info[i].max_num = rf_has(r_info[i].flags, RF_UNIQUE) ? 1 : 100;
+		l_list[i].pkills = 0;
+	}
+
+	/* Every run builds its own town, rather than reusing the last one */
+	chunk_list_free();
+
+	for (i = 0; i < MAX_STORES; i++)
+		stores[i].owner = owners_start[i];
+
+	turn = 1;
+}
+
+/**
+ * Free the copies, and the player buffers they were put back into
+ */
+static void stats_free_snapshot(void)
+{
+	mem_free(quests_start);
+	mem_free(slots_start);
+	mem_free(player->body.slots);
+	memset(&player->body, 0, sizeof(player->body));
 }
 
 static void initialize_character(void)
@@ -222,12 +373,22 @@ static void initialize_character(void)
 		fflush(stdout);
 	}
 
-	seed = (time(NULL));
+	/* Runs with a base seed are reproducible; see init_stats() */
+	if (base_seed)
+		seed = rng_div(&run_seeds, 0x10000000);
+	else
+		seed = (time(NULL));
 	Rand_quick = FALSE;
+
+	/* The table index survives reseeding, so a run would otherwise depend
+	 * on where the last one left off */
+	state_i = 0;
 	Rand_state_init(seed);
 
-	player_init(player);
-	generate_player_for_stats();
+	stats_reset_run();
+
+	/* Set social class and (null) history */
+	player->history = get_history(player->race->history);
 
 	seed_flavor = randint0(0x10000000);
 	seed_randart = randint0(0x10000000);
@@ -237,11 +398,15 @@ static void initialize_character(void)
 		do_randart(seed_randart, TRUE);
 	}
 
-	store_reset();
 	flavor_init();
 	player->upkeep->playing = TRUE;
 	player->upkeep->autosave = FALSE;
-	cave_generate(&cave, player);
+
+	/* Sampling runs never visit the town */
+	if (!sample_items) {
+		store_reset();
+		cave_generate(&cave, player);
+	}
 }
 
 static void kill_all_monsters(int level)
@@ -260,91 +425,89 @@ static void kill_all_monsters(int level)
 	}
 }
 
-static void unkill_uniques(void)
+static void log_object(int level, struct object *obj)
 {
 	int i;
 
-	if (!quiet) {
-		printf(" [U  ]\b\b\b\b\b\b");
-		fflush(stdout);
-	}
+	/*	u32b o_power = 0; */
 
-	for (i = 0; i < z_info->r_max; i++) {
-		monster_race *r_ptr = &r_info[i];
+	/* Mark object as fully known */
+	object_notice_everything(obj);
 
-		if (rf_has(r_ptr->flags, RF_UNIQUE))
-			r_ptr->max_num = 1;
-	}
-}
+/*	o_power = object_power(obj, FALSE, NULL, TRUE); */
 
-static void reset_artifacts(void)
-{
-	int i;
+	/* Capture gold amounts */
+	if (tval_is_money(obj))
+		level_data[level].gold[obj->origin] += obj->pval;
 
-	if (!quiet) {
-		printf(" [R  ]\b\b\b\b\b\b");
-		fflush(stdout);
-	}
+	/* Capture artifact drops */
+	if (obj->artifact)
+		level_data[level].artifacts[obj->origin][obj->artifact->aidx]++;
 
-	for (i = 0; i < z_info->a_max; i++)
-		a_info[i].created = FALSE;
+	/* Capture kind details */
+	if (tval_has_variable_power(obj)) {
+		struct wearables_data *w
+			= &level_data[level].wearables[obj->origin][wearables_index[obj->kind->kidx]];
+
+		w->count++;
+		w->dice[MIN(obj->dd, TOP_DICE - 1)][MIN(obj->ds, TOP_SIDES - 1)]++;
+		w->ac[MIN(MAX(obj->ac + obj->to_a, 0), TOP_AC - 1)]++;
+		w->hit[MIN(MAX(obj->to_h, 0), TOP_PLUS - 1)]++;
+		w->dam[MIN(MAX(obj->to_d, 0), TOP_PLUS - 1)]++;
 
+		/* Capture egos */
+		if (obj->ego)
+			w->egos[obj->ego->eidx]++;
+		/* Capture object flags */
+		for (i = of_next(obj->flags, FLAG_START); i != FLAG_END;
+				i = of_next(obj->flags, i + 1))
+			w->flags[i]++;
+		/* Capture object modifiers */
+		for (i = 0; i < OBJ_MOD_MAX; i++) {
+			int p = obj->modifiers[i];
+			w->modifiers[MIN(MAX(p, 0), TOP_MOD - 1)][i]++;
+		}
+	} else
+		level_data[level].consumables[obj->origin][consumables_index[obj->kind->kidx]]++;
 }
 
 static void log_all_objects(int level)
 {
-	int x, y, i;
+	int x, y;
 
 	for (y = 1; y < cave->height - 1; y++) {
 		for (x = 1; x < cave->width - 1; x++) {
-			struct object *obj = square_object(cave, y, x);
-
-			for (obj = square_object(cave, y, x); obj; obj = obj->next) {
-				/*	u32b o_power = 0; */
-
-				/* Mark object as fully known */
-				object_notice_everything(obj);
-
-/*				o_power = object_power(obj, FALSE, NULL, TRUE); */
-
-				/* Capture gold amounts */
-				if (tval_is_money(obj))
-					level_data[level].gold[obj->origin] += obj->pval;
-
-				/* Capture artifact drops */
-				if (obj->artifact)
-					level_data[level].artifacts[obj->origin][obj->artifact->aidx]++;
-
-				/* Capture kind details */
-				if (tval_has_variable_power(obj)) {
-					struct wearables_data *w
-						= &level_data[level].wearables[obj->origin][wearables_index[obj->kind->kidx]];
-
-					w->count++;
-					w->dice[MIN(obj->dd, TOP_DICE - 1)][MIN(obj->ds, TOP_SIDES - 1)]++;
-					w->ac[MIN(MAX(obj->ac + obj->to_a, 0), TOP_AC - 1)]++;
-					w->hit[MIN(MAX(obj->to_h, 0), TOP_PLUS - 1)]++;
-					w->dam[MIN(MAX(obj->to_d, 0), TOP_PLUS - 1)]++;
-
-					/* Capture egos */
-					if (obj->ego)
-						w->egos[obj->ego->eidx]++;
-					/* Capture object flags */
-					for (i = of_next(obj->flags, FLAG_START); i != FLAG_END;
-							i = of_next(obj->flags, i + 1))
-						w->flags[i]++;
-					/* Capture object modifiers */
-					for (i = 0; i < OBJ_MOD_MAX; i++) {
-						int p = obj->modifiers[i];
-						w->modifiers[MIN(MAX(p, 0), TOP_MOD - 1)][i]++;
-					}
-				} else
-					level_data[level].consumables[obj->origin][consumables_index[obj->kind->kidx]]++;
-			}
+			struct object *obj;
+
+			for (obj = square_object(cave, y, x); obj; obj = obj->next)
+				log_object(level, obj);
 		}
 	}
 }
 
+/**
+ * Log a sampled object, then throw it away as the level would be
+ */
+static void log_sample(struct object *obj, void *data)
+{
+	log_object(*(int *)data, obj);
+	object_delete(obj);
+}
+
+/**
+ * Make each level's floor objects directly, without building the levels;
+ * see sample_floor_objects()
+ */
+static void sample_dungeon(void)
+{
+	int level;
+
+	for (level = 1; level < LEVEL_MAX; level++) {
+		player->depth = level;
+		sample_floor_objects(level, log_sample, &level);
+	}
+}
+
 static void descend_dungeon(void)
 {
 	int level;
@@ -988,9 +1151,32 @@ static bool stats_prep_db(void)
 	int err;
 
 	/* Open the database connection */
-	status = stats_db_open();
+	status = stats_db_open(base_seed);
 	if (!status) return status;
 
+	/* Trade crash safety for speed; a lost scratch database is just rerun */
+	if (scratch_db) {
+		err = stats_db_exec("PRAGMA journal_mode=WAL;");
+		if (err) return false;
+
+		err = stats_db_exec("PRAGMA synchronous=OFF;");
+		if (err) return false;
+	}
+
+	/* Count tables go in a directory named after the database */
+	if (column_output) {
+		char buf[1024];
+		size_t len;
+
+		my_strcpy(buf, stats_db_path(), sizeof(buf));
+		len = strlen(buf);
+		if (len > 3 && streq(buf + len - 3, ".db"))
+			buf[len - 3] = '\0';
+		my_strcat(buf, ".cols", sizeof(buf));
+		if (!dir_create(buf)) return false;
+		cols_dir = string_make(buf);
+	}
+
 	/* Create some tables */
 	err = stats_db_exec("CREATE TABLE metadata(field TEXT UNIQUE NOT NULL, value TEXT);");
 	if (err) return false;
@@ -1164,30 +1350,80 @@ static int stats_wearables_data_offsetof(const char *member)
 }
 
 /**
- * Given a pointer to a dynamically allocated array and a value, look up
- * the index with that value; e.g. given wearables_index[k_idx], return k_idx.
- * If not found, return -1 * value.
+ * Where a checkpoint writes one count table: the database, or with -c a
+ * column file of the same name
+ */
+struct stats_table {
+	sqlite3_stmt *sql_stmt;
+	struct stats_cols *cols;
+	int ncols;
+};
+
+/**
+ * Start writing table 'table', whose columns are named in 'columns',
+ * separated by commas
  */
+static int stats_table_open(struct stats_table *t, const char *table,
+							const char *columns)
+{
+	char sql_buf[256];
+	const char *s;
+	int i;
+
+	memset(t, 0, sizeof(*t));
+	t->ncols = 1;
+	for (s = columns; *s; s++)
+		if (*s == ',') t->ncols++;
+
+	if (cols_dir) {
+		t->cols = stats_cols_open(cols_dir, table, columns);
+		return t->cols ? SQLITE_OK : SQLITE_CANTOPEN;
+	}
+
+	strnfmt(sql_buf, sizeof(sql_buf), "INSERT INTO %s VALUES(?", table);
+	for (i = 1; i < t->ncols; i++)
+		my_strcat(sql_buf, ",?", sizeof(sql_buf));
+	my_strcat(sql_buf, ");", sizeof(sql_buf));
+
+	return stats_db_stmt_cached(&t->sql_stmt, sql_buf);
+}
 
-static int stats_lookup_index(const int *index, int max_idx, int value)
+static int stats_table_row(struct stats_table *t, const u32b *values)
 {
-	int idx;
+	int err, i;
 
-	for (idx = 0; idx < max_idx; idx ++) {
-		if (index[idx] == value) return idx;
+	if (t->cols)
+		return stats_cols_row(t->cols, values) ? SQLITE_OK : SQLITE_IOERR;
+
+	for (i = 0; i < t->ncols; i++) {
+		err = sqlite3_bind_int(t->sql_stmt, i + 1, values[i]);
+		if (err) return err;
 	}
 
-	return -1 * value;
+	STATS_DB_STEP_RESET(t->sql_stmt)
+
+	return SQLITE_OK;
 }
 
-static int stats_write_db_level_data(const char *table, int max_idx)
+static int stats_table_close(struct stats_table *t)
 {
-	char sql_buf[256];
-	sqlite3_stmt *sql_stmt;
+	if (t->cols)
+		return stats_cols_close(t->cols) ? SQLITE_OK : SQLITE_IOERR;
+
+	return SQLITE_OK;
+}
+
+/**
+ * As for the wearables below, pass in true if the member is an array and
+ * false if it is a pointer.
+ */
+static int stats_write_db_level_data(const char *table, const char *columns,
+									 int max_idx, bool array_p)
+{
+	struct stats_table t;
 	int err, level, i, offset;
 
-	strnfmt(sql_buf, 256, "INSERT INTO %s VALUES(?,?,?);", table);
-	err = stats_db_stmt_prep(&sql_stmt, sql_buf);
+	err = stats_table_open(&t, table, columns);
 	if (err) return err;
 
 	offset = stats_level_data_offsetof(table);
@@ -1199,30 +1435,27 @@ static int stats_write_db_level_data(const char *table, int max_idx)
 			u32b count;
 			if (streq(table, "gold"))
 				count = *((long long *)((byte *)&level_data[level] + offset) + i);
-			else
+			else if (array_p)
 				count = *((u32b *)((byte *)&level_data[level] + offset) + i);
+			else
+				count = (*(u32b **)((byte *)&level_data[level] + offset))[i];
 
 			if (!count) continue;
 
-			err = stats_db_bind_ints(sql_stmt, 3, 0,
-				level, count, i);
+			err = stats_table_row(&t, (u32b []){ level, count, i });
 			if (err) return err;
-
-			STATS_DB_STEP_RESET(sql_stmt)
 		}
 
-	return sqlite3_finalize(sql_stmt);
+	return stats_table_close(&t);
 }
 
-static int stats_write_db_level_data_items(const char *table, int max_idx, 
-	bool translate_consumables)
+static int stats_write_db_level_data_items(const char *table,
+	const char *columns, int max_idx, bool translate_consumables)
 {
-	char sql_buf[256];
-	sqlite3_stmt *sql_stmt;
+	struct stats_table t;
 	int err, level, origin, i, offset;
 
-	strnfmt(sql_buf, 256, "INSERT INTO %s VALUES(?,?,?,?);", table);
-	err = stats_db_stmt_prep(&sql_stmt, sql_buf);
+	err = stats_table_open(&t, table, columns);
 	if (err) return err;
 
 	offset = stats_level_data_offsetof(table);
@@ -1235,22 +1468,20 @@ static int stats_write_db_level_data_items(const char *table, int max_idx,
 				u32b count = ((u32b **)((byte *)&level_data[level] + offset))[origin][i];
 				if (!count) continue;
 				
-				err = stats_db_bind_ints(sql_stmt, 4, 0, level, count, translate_consumables ? stats_lookup_index(consumables_index, z_info->k_max, i) : i, origin);
+				err = stats_table_row(&t, (u32b []){ level, count,
+					translate_consumables ? consumables_kidx[i] : i, origin });
 				if (err) return err;
-
-				STATS_DB_STEP_RESET(sql_stmt)
 			}
 
-	return sqlite3_finalize(sql_stmt);
+	return stats_table_close(&t);
 }
 
 static int stats_write_db_wearables_count(void)
 {
-	sqlite3_stmt *sql_stmt;
+	struct stats_table t;
 	int err, level, origin, k_idx, idx;
 
-	err = stats_db_stmt_prep(&sql_stmt, 
-		"INSERT INTO wearables_count VALUES(?,?,?,?);");
+	err = stats_table_open(&t, "wearables_count", "level,count,k_idx,origin");
 	if (err) return err;
 
 	for (level = 1; level < LEVEL_MAX; level++)
@@ -1260,20 +1491,17 @@ static int stats_write_db_wearables_count(void)
 				/* Skip if object did not appear */
 				if (!count) continue;
 
-				k_idx = stats_lookup_index(wearables_index, 
-					z_info->k_max, idx);
+				k_idx = wearables_kidx[idx];
 
 				/* Skip if pile */
 				if (! k_idx) continue;
 
-				err = stats_db_bind_ints(sql_stmt, 4, 0,
-					level, count, k_idx, origin);
+				err = stats_table_row(&t,
+					(u32b []){ level, count, k_idx, origin });
 				if (err) return err;
-
-				STATS_DB_STEP_RESET(sql_stmt)
 			}
 
-	return sqlite3_finalize(sql_stmt);
+	return stats_table_close(&t);
 }
 
 /**
@@ -1282,14 +1510,16 @@ static int stats_write_db_wearables_count(void)
  * as an array or as a pointer. Pass in true if the member is an array, and
  * false if the member is a pointer.
  */
-static int stats_write_db_wearables_array(const char *field, int max_val, bool array_p)
+static int stats_write_db_wearables_array(const char *field,
+	const char *column, int max_val, bool array_p)
 {
-	char sql_buf[256];
-	sqlite3_stmt *sql_stmt;
+	char table[40], columns[80];
+	struct stats_table t;
 	int err, level, origin, idx, k_idx, i, offset;
 
-	strnfmt(sql_buf, 256, "INSERT INTO wearables_%s VALUES(?,?,?,?,?);", field);
-	err = stats_db_stmt_prep(&sql_stmt, sql_buf);
+	strnfmt(table, sizeof(table), "wearables_%s", field);
+	strnfmt(columns, sizeof(columns), "level,count,k_idx,origin,%s", column);
+	err = stats_table_open(&t, table, columns);
 	if (err) return err;
 
 	offset = stats_wearables_data_offsetof(field);
@@ -1297,8 +1527,7 @@ static int stats_write_db_wearables_array(const char *field, int max_val, bool a
 	for (level = 1; level < LEVEL_MAX; level++)
 		for (origin = 0; origin < ORIGIN_STATS; origin++)
 			for (idx = 0; idx < wearable_count + 1; idx++) {
-				k_idx = stats_lookup_index(wearables_index, 
-					z_info->k_max, idx);
+				k_idx = wearables_kidx[idx];
 
 				/* Skip if pile */
 				if (! k_idx) continue;
@@ -1314,15 +1543,13 @@ static int stats_write_db_wearables_array(const char *field, int max_val, bool a
 
 					if (!count) continue;
 
-					err = stats_db_bind_ints(sql_stmt, 5, 0,
-						level, count, k_idx, origin, i);
+					err = stats_table_row(&t,
+						(u32b []){ level, count, k_idx, origin, i });
 					if (err) return err;
-
-					STATS_DB_STEP_RESET(sql_stmt)
 				}
 			}
 
-	return sqlite3_finalize(sql_stmt);
+	return stats_table_close(&t);
 }
 
 /**
@@ -1332,15 +1559,17 @@ static int stats_write_db_wearables_array(const char *field, int max_val, bool a
  * false if the member is a pointer.
  */
 static int stats_write_db_wearables_2d_array(const char *field, 
-	int max_val1, int max_val2, bool array_p)
+	const char *column1, const char *column2, int max_val1, int max_val2,
+	bool array_p)
 {
-	char sql_buf[256];
-	sqlite3_stmt *sql_stmt;
+	char table[40], columns[80];
+	struct stats_table t;
 	int err, level, origin, idx, k_idx, i, j, offset;
 
-	strnfmt(sql_buf, 256, "INSERT INTO wearables_%s VALUES(?,?,?,?,?,?);",
-			field);
-	err = stats_db_stmt_prep(&sql_stmt, sql_buf);
+	strnfmt(table, sizeof(table), "wearables_%s", field);
+	strnfmt(columns, sizeof(columns), "level,count,k_idx,origin,%s,%s",
+			column1, column2);
+	err = stats_table_open(&t, table, columns);
 	if (err) return err;
 
 	offset = stats_wearables_data_offsetof(field);
@@ -1348,8 +1577,7 @@ static int stats_write_db_wearables_2d_array(const char *field,
 	for (level = 1; level < LEVEL_MAX; level++)
 		for (origin = 0; origin < ORIGIN_STATS; origin++)
 			for (idx = 0; idx < wearable_count + 1; idx++) {
-				k_idx = stats_lookup_index(wearables_index, 
-					z_info->k_max, idx);
+				k_idx = wearables_kidx[idx];
 
 				/* Skip if pile */
 				if (! k_idx) continue;
@@ -1370,16 +1598,13 @@ static int stats_write_db_wearables_2d_array(const char *field,
 
 						if (!count) continue;
 
-						err = stats_db_bind_ints(sql_stmt, 6, 0,
-							level, count, k_idx, origin, 
-							i, j);
+						err = stats_table_row(&t,
+							(u32b []){ level, count, k_idx, origin, i, j });
 						if (err) return err;
-
-						STATS_DB_STEP_RESET(sql_stmt)
 					}
 			}
 
-	return sqlite3_finalize(sql_stmt);
+	return stats_table_close(&t);
 }
 
 static int stats_write_db(u32b run)
@@ -1396,49 +1621,55 @@ static int stats_write_db(u32b run)
 	err = stats_db_exec(sql_buf);
 	if (err) return err;
 
-	err = stats_write_db_level_data("monsters", z_info->r_max);
+	err = stats_write_db_level_data("monsters", "level,count,k_idx",
+		z_info->r_max, false);
 	if (err) return err;
 
-	err = stats_write_db_level_data("obj_feelings", OBJ_FEEL_MAX);
+	err = stats_write_db_level_data("obj_feelings", "level,count,feeling",
+		OBJ_FEEL_MAX, true);
 	if (err) return err;
 
-	err = stats_write_db_level_data("mon_feelings", MON_FEEL_MAX);
+	err = stats_write_db_level_data("mon_feelings", "level,count,feeling",
+		MON_FEEL_MAX, true);
 	if (err) return err;
 
-	err = stats_write_db_level_data("gold", ORIGIN_STATS);
+	err = stats_write_db_level_data("gold", "level,count,origin",
+		ORIGIN_STATS, true);
 	if (err) return err;
 
-	err = stats_write_db_level_data_items("artifacts", z_info->a_max, 
-		false);
+	err = stats_write_db_level_data_items("artifacts",
+		"level,count,a_idx,origin", z_info->a_max, false);
 	if (err) return err;
 
-	err = stats_write_db_level_data_items("consumables", 
-		consumable_count + 1, true);
+	err = stats_write_db_level_data_items("consumables",
+		"level,count,k_idx,origin", consumable_count + 1, true);
 	if (err) return err;
 
 	err = stats_write_db_wearables_count();
 	if (err) return err;
 
-	err = stats_write_db_wearables_2d_array("dice", TOP_DICE, TOP_SIDES, true);
+	err = stats_write_db_wearables_2d_array("dice", "dd", "ds", TOP_DICE,
+		TOP_SIDES, true);
 	if (err) return err;
 
-	err = stats_write_db_wearables_array("ac", TOP_AC, true);
+	err = stats_write_db_wearables_array("ac", "ac", TOP_AC, true);
 	if (err) return err;
 
-	err = stats_write_db_wearables_array("hit", TOP_PLUS, true);
+	err = stats_write_db_wearables_array("hit", "to_h", TOP_PLUS, true);
 	if (err) return err;
 
-	err = stats_write_db_wearables_array("dam", TOP_PLUS, true);
+	err = stats_write_db_wearables_array("dam", "to_d", TOP_PLUS, true);
 	if (err) return err;
 
-	err = stats_write_db_wearables_array("egos", z_info->e_max, false);
+	err = stats_write_db_wearables_array("egos", "e_idx", z_info->e_max,
+		false);
 	if (err) return err;
 
-	err = stats_write_db_wearables_array("flags", OF_MAX, true);
+	err = stats_write_db_wearables_array("flags", "of_idx", OF_MAX, true);
 	if (err) return err;
 
-	err = stats_write_db_wearables_2d_array("mods", TOP_MOD, OBJ_MOD_MAX + 1,
-											false);
+	err = stats_write_db_wearables_2d_array("mods", "mod", "mod_idx",
+		TOP_MOD, OBJ_MOD_MAX + 1, false);
 	if (err) return err;
 
 	/* Commit transaction */
@@ -1449,18 +1680,18 @@ static int stats_write_db(u32b run)
 }
 
 /**
- * Call with the number of runs that have been completed.
+ * Call with the number of runs that have been completed, out of 'total'.
  */
 
 #define STATS_PROGRESS_BAR_LEN 30
 
-void progress_bar(u32b run, time_t start) {
+void progress_bar(u32b run, u32b total, time_t start) {
 	u32b i;
-	u32b n = (run * STATS_PROGRESS_BAR_LEN) / num_runs;
-	u32b p10 = ((long long)run * 1000) / num_runs;
+	u32b n = (run * STATS_PROGRESS_BAR_LEN) / total;
+	u32b p10 = ((long long)run * 1000) / total;
 
 	time_t delta = time(NULL) - start;
-	u32b togo = num_runs - run;
+	u32b togo = total - run;
 	u32b expect = delta ? ((long long)delta * (long long)togo) / run 
 		: 0;
 
@@ -1471,7 +1702,7 @@ void progress_bar(u32b run, time_t start) {
 	printf("\r|");
 	for (i = 0; i < n; i++) printf("*");
 	for (i = 0; i < STATS_PROGRESS_BAR_LEN - n; i++) printf(" ");
-	printf("| %d/%d (%5.1f%%) %3d:%02d:%02d ", run, num_runs, p10/10.0, h, m,
+	printf("| %d/%d (%5.1f%%) %3d:%02d:%02d ", run, total, p10/10.0, h, m,
 		   s);
 	fflush(stdout);
 }
@@ -1485,81 +1716,594 @@ void progress_bar(u32b run, time_t start) {
 static void stats_cleanup_angband_run(void)
 {
 	if (player->history) mem_free(player->history);
+	player->history = NULL;
 }
 
-static errr run_stats(void)
+/*** Sharded runs ***/
+
+/**
+ * Shard files hold one worker's raw counters, so they can be added up into
+ * a single database once every shard has finished.  The header records
+ * everything that has to agree between the shards being merged.
+ */
+#define STATS_SHARD_MAGIC	0x41535348	/* "ASSH" */
+#define STATS_SHARD_VERSION	2
+
+struct stats_shard_header {
+	u32b magic;
+	u32b version;
+	u32b seed;
+	u32b runs;		/* Runs this shard has completed */
+	u32b index;
+	u32b count;
+	u32b randarts;
+	u32b no_selling;
+	u32b sample_items;
+	u32b sizes[6];	/* Array sizes the counters were kept with */
+	struct gen_stats gen;
+};
+
+static void stats_shard_path(char *buf, size_t len, int index, int count)
+{
+	char name[64];
+
+	strnfmt(name, sizeof(name), "shard-%08lx-%d-of-%d.dat",
+			(unsigned long)base_seed, index + 1, count);
+	path_build(buf, len, ANGBAND_DIR_STATS, name);
+}
+
+static void stats_shard_sizes(u32b *sizes)
+{
+	sizes[0] = z_info->r_max;
+	sizes[1] = z_info->a_max;
+	sizes[2] = z_info->e_max;
+	sizes[3] = z_info->k_max;
+	sizes[4] = wearable_count;
+	sizes[5] = consumable_count;
+}
+
+/**
+ * State for a walk over every counter, writing it to or merging it from a
+ * shard file
+ *
+ * Nearly all the counters stay at zero, so the file holds only the others,
+ * as (position in the walk, value) pairs ending with an empty pair.
+ */
+struct stats_shard_io {
+	ang_file *f;
+	bool merge;
+	bool ok;
+	u32b pos;		/* Position in the walk of the next array */
+	u32b next[2];	/* Next pair to merge */
+};
+
+static void stats_shard_next(struct stats_shard_io *io)
+{
+	if (file_read(io->f, (char *)io->next, sizeof(io->next)) !=
+			(int)sizeof(io->next))
+		io->ok = FALSE;
+}
+
+/**
+ * Write an array of counters to a shard file, or add the shard file's
+ * copy of it to ours.
+ */
+static void stats_shard_u32b(struct stats_shard_io *io, u32b *counts,
+							 size_t n)
+{
+	u32b pair[2];
+	size_t i;
+
+	if (!io->ok) return;
+
+	if (io->merge) {
+		/* Pairs come in walk order, and an empty one ends them */
+		while (io->ok && io->next[1] && io->next[0] < io->pos + n) {
+			if (io->next[0] < io->pos) {
+				io->ok = FALSE;
+				return;
+			}
+			counts[io->next[0] - io->pos] += io->next[1];
+			stats_shard_next(io);
+		}
+		io->pos += n;
+		return;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (!counts[i]) continue;
+		pair[0] = io->pos + i;
+		pair[1] = counts[i];
+		if (!file_write(io->f, (const char *)pair, sizeof(pair))) {
+			io->ok = FALSE;
+			return;
+		}
+	}
+	io->pos += n;
+}
+
+/**
+ * Write every counter to a shard file, or add up a shard file's counters
+ * into ours; the walk is the same either way.
+ */
+static bool stats_shard_counters(ang_file *f, bool merge)
+{
+	struct stats_shard_io io = { f, merge, TRUE, 0, { 0, 0 } };
+	long long gold[ORIGIN_STATS];
+	u32b end[2] = { 0, 0 };
+	int i, j, k, l;
+
+	/* Gold is summed in long longs, and there's little of it */
+	for (i = 0; i < LEVEL_MAX; i++) {
+		if (!merge) {
+			if (!file_write(f, (const char *)level_data[i].gold, sizeof(gold)))
+				return FALSE;
+			continue;
+		}
+
+		if (file_read(f, (char *)gold, sizeof(gold)) != (int)sizeof(gold))
+			return FALSE;
+		for (j = 0; j < ORIGIN_STATS; j++)
+			level_data[i].gold[j] += gold[j];
+	}
+
+	if (merge) stats_shard_next(&io);
+
+	for (i = 0; i < LEVEL_MAX; i++) {
+		struct level_data *ld = &level_data[i];
+
+		stats_shard_u32b(&io, ld->monsters, z_info->r_max);
+		stats_shard_u32b(&io, ld->obj_feelings, OBJ_FEEL_MAX);
+		stats_shard_u32b(&io, ld->mon_feelings, MON_FEEL_MAX);
+
+		for (j = 0; j < ORIGIN_STATS; j++) {
+			stats_shard_u32b(&io, ld->artifacts[j], z_info->a_max);
+			stats_shard_u32b(&io, ld->consumables[j], consumable_count + 1);
+
+			for (k = 0; k < wearable_count + 1; k++) {
+				struct wearables_data *w = &ld->wearables[j][k];
+
+				stats_shard_u32b(&io, &w->count, 1);
+				stats_shard_u32b(&io, &w->dice[0][0], TOP_DICE * TOP_SIDES);
+				stats_shard_u32b(&io, w->ac, TOP_AC);
+				stats_shard_u32b(&io, w->hit, TOP_PLUS);
+				stats_shard_u32b(&io, w->dam, TOP_PLUS);
+				stats_shard_u32b(&io, w->egos, z_info->e_max);
+				stats_shard_u32b(&io, w->flags, OF_MAX);
+				for (l = 0; l < TOP_MOD; l++)
+					stats_shard_u32b(&io, w->modifiers[l], OBJ_MOD_MAX + 1);
+			}
+		}
+	}
+
+	/* Every pair should have been used up */
+	if (merge)
+		return io.ok && io.next[1] == 0;
+
+	return io.ok && file_write(f, (const char *)end, sizeof(end));
+}
+
+/**
+ * Save this process's counters as shard 'index' of 'count'
+ */
+static bool stats_write_shard(int index, int count, u32b runs)
+{
+	char path[1024];
+	char tmp[1024];
+	struct stats_shard_header head;
+	ang_file *f;
+	bool ok;
+
+	memset(&head, 0, sizeof(head));
+	head.magic = STATS_SHARD_MAGIC;
+	head.version = STATS_SHARD_VERSION;
+	head.seed = base_seed;
+	head.runs = runs;
+	head.index = index;
+	head.count = count;
+	head.randarts = randarts;
+	head.no_selling = no_selling;
+	head.sample_items = sample_items;
+	stats_shard_sizes(head.sizes);
+	head.gen = gen_stats;
+
+	/* Write to one side so a checkpoint never leaves half a shard */
+	stats_shard_path(path, sizeof(path), index, count);
+	strnfmt(tmp, sizeof(tmp), "%s.new", path);
+
+	f = file_open(tmp, MODE_WRITE, FTYPE_RAW);
+	if (!f) return FALSE;
+	ok = file_write(f, (const char *)&head, sizeof(head)) &&
+		stats_shard_counters(f, FALSE);
+	file_close(f);
+
+	if (ok) {
+		if (file_exists(path)) file_delete(path);
+		ok = file_move(tmp, path);
+	}
+
+	return ok;
+}
+
+/**
+ * Add shard 'index' of 'count' to our counters, returning its run count
+ */
+static u32b stats_merge_shard(int index, int count)
+{
+	char path[1024];
+	struct stats_shard_header head;
+	u32b sizes[6];
+	ang_file *f;
+
+	stats_shard_path(path, sizeof(path), index, count);
+	f = file_open(path, MODE_READ, FTYPE_RAW);
+	if (!f) quit_fmt("Couldn't open shard %s", path);
+
+	stats_shard_sizes(sizes);
+	if (file_read(f, (char *)&head, sizeof(head)) != (int)sizeof(head) ||
+		head.magic != STATS_SHARD_MAGIC ||
+		head.version != STATS_SHARD_VERSION ||
+		head.seed != base_seed || head.randarts != (u32b)randarts ||
+		head.no_selling != (u32b)no_selling ||
+		head.sample_items != (u32b)sample_items ||
+		memcmp(head.sizes, sizes, sizeof(sizes)))
+		quit_fmt("Shard %s doesn't match this run", path);
+
+	if (!stats_shard_counters(f, TRUE))
+		quit_fmt("Shard %s is truncated", path);
+	file_close(f);
+
+	gen_stats.attempts += head.gen.attempts;
+	gen_stats.builder_failed += head.gen.builder_failed;
+	gen_stats.too_many_monsters += head.gen.too_many_monsters;
+
+	return head.runs;
+}
+
+/**
+ * Put the artifacts back as they were before any were randomised.  The
+ * slays and brands are copied, as the randart code frees those it replaces.
+ */
+static void restore_artifacts(const artifact_type *a_info_save)
+{
+	int i;
+
+	for (i = 0; i < z_info->a_max; i++) {
+		free_slay(a_info[i].slays);
+		free_brand(a_info[i].brands);
+		memcpy(&a_info[i], &a_info_save[i], sizeof(artifact_type));
+		a_info[i].slays = NULL;
+		a_info[i].brands = NULL;
+		copy_slay(&a_info[i].slays, a_info_save[i].slays);
+		copy_brand(&a_info[i].brands, a_info_save[i].brands);
+	}
+}
+
+static void free_artifacts_save(artifact_type *a_info_save)
+{
+	int i;
+
+	if (!a_info_save) return;
+
+	for (i = 0; i < z_info->a_max; i++) {
+		free_slay(a_info_save[i].slays);
+		free_brand(a_info_save[i].brands);
+	}
+	mem_free(a_info_save);
+}
+
+/**
+ * Time level generation alone: make num_runs passes from bench_min to
+ * bench_max, building each level and throwing it away, and report the rate,
+ * where the time went, how often levels were rejected and how many
+ * allocations each level took.  The monsters are killed between levels just
+ * as in a dive, so uniques and artifacts run out in the same way.
+ */
+static void stats_benchmark(artifact_type *a_info_save)
+{
+	static const char *stage_names[GEN_STAGE_MAX] = {
+		"other", "rooms", "tunnels", "streamers", "population"
+	};
+	struct gen_stats before, gen = { 0, 0, 0 };
+	unsigned long allocs = 0;
+	u32b levels = 0, pass;
+	double total = 0.0;
+	int depth, i;
+
+	if (bench_profile) {
+		char *s;
+
+		/* Allow "moria_cave" for "moria cave" and so on */
+		for (s = bench_profile; *s; s++)
+			if (*s == '_') *s = ' ';
+		gen_force_profile = find_cave_profile(bench_profile);
+		if (!gen_force_profile)
+			quit_fmt("init-stats: no cave profile '%s'", bench_profile);
+	}
+
+	if (!quiet) {
+		printf("Generating levels %d to %d, %d times...\n", bench_min,
+			   bench_max, num_runs);
+		fflush(stdout);
+	}
+
+	memset(&gen_timing, 0, sizeof(gen_timing));
+	for (pass = 0; pass < num_runs; pass++) {
+		if (randarts)
+			restore_artifacts(a_info_save);
+		initialize_character();
+
+		for (depth = bench_min; depth <= bench_max; depth++) {
+			unsigned long allocs_before = mem_alloc_count;
+
+			dungeon_change_level(depth);
+
+			before = gen_stats;
+			gen_timing.on = TRUE;
+			gen_timing.stage = GEN_STAGE_OTHER;
+			gen_timing.since = clock();
+			cave_generate(&cave, player);
+			gen_stage_enter(GEN_STAGE_OTHER);
+			gen_timing.on = FALSE;
+
+			allocs += mem_alloc_count - allocs_before;
+			gen.attempts += gen_stats.attempts - before.attempts;
+			gen.builder_failed +=
+				gen_stats.builder_failed - before.builder_failed;
+			gen.too_many_monsters +=
+				gen_stats.too_many_monsters - before.too_many_monsters;
+			levels++;
+
+			kill_all_monsters(depth);
+		}
+
+		stats_cleanup_angband_run();
+	}
+	gen_force_profile = NULL;
+
+	for (i = 0; i < GEN_STAGE_MAX; i++)
+		total += (double)gen_timing.ticks[i] / CLOCKS_PER_SEC;
+
+	printf("Levels: %lu in %.2fs, %.1f levels/sec\n", (unsigned long)levels,
+		   total, total > 0.0 ? levels / total : 0.0);
+	for (i = 0; i < GEN_STAGE_MAX; i++) {
+		double secs = (double)gen_timing.ticks[i] / CLOCKS_PER_SEC;
+
+		printf("  %-10s %8.3fs %5.1f%%\n", stage_names[i], secs,
+			   total > 0.0 ? 100.0 * secs / total : 0.0);
+	}
+	printf("Attempts: %lu, retry rate %.3f (builder failures: %lu, "
+		   "monster overflows: %lu)\n", (unsigned long)gen.attempts,
+		   levels ? (double)(gen.attempts - levels) / levels : 0.0,
+		   (unsigned long)gen.builder_failed,
+		   (unsigned long)gen.too_many_monsters);
+	printf("Allocations: %lu, %.0f per level\n", allocs,
+		   levels ? (double)allocs / levels : 0.0);
+}
+
+/**
+ * Dive once for each of runs first..last, both counted from 1.
+ *
+ * Seeded runs draw their seeds from one stream, so the seeds of earlier
+ * runs are skipped and any split of the runs gives the same dives.  A
+ * shard checkpoints to its shard file; otherwise to the database.
+ */
+static void stats_run_range(u32b first, u32b last, int shard,
+							artifact_type *a_info_save)
 {
 	u32b run;
-	artifact_type *a_info_save;
+	int err;
+	u32b total = last - first + 1;
+	time_t start = time(NULL);
+
+	if (base_seed)
+		for (run = 1; run < first; run++)
+			(void)rng_div(&run_seeds, 0x10000000);
+
+	for (run = first; run <= last; run++) {
+		u32b done = run - first + 1;
+
+		if (!quiet) progress_bar(done - 1, total, start);
+
+		if (randarts)
+			restore_artifacts(a_info_save);
+
+		initialize_character();
+		if (sample_items)
+			sample_dungeon();
+		else
+			descend_dungeon();
+		stats_cleanup_angband_run();
+
+		/* Checkpoint every so many runs */
+		if (done % RUNS_PER_CHECKPOINT == 0) {
+			if (shard >= 0) {
+				if (!stats_write_shard(shard, shard_count, done))
+					quit("Problems writing shard!");
+			} else {
+				err = stats_write_db(run);
+				if (err) {
+					stats_db_close();
+					quit_fmt("Problems writing to database!  sqlite3 errno %d.",
+							 err);
+				}
+			}
+		}
+
+		if (quiet && done % 1000 == 0) {
+			printf("Finished %d runs.\n", done);
+			fflush(stdout);
+		}
+	}
+
+	if (!quiet) progress_bar(total, total, start);
+}
+
+/**
+ * The first run of shard 'index' of 'count'
+ */
+static u32b stats_shard_first(int index, int count)
+{
+	return (u32b)(((unsigned long long)num_runs * index) / count) + 1;
+}
+
+/**
+ * Run one shard and save its counters
+ */
+static void stats_run_shard(int index, artifact_type *a_info_save)
+{
+	u32b first = stats_shard_first(index, shard_count);
+	u32b last = stats_shard_first(index + 1, shard_count) - 1;
+
+	if (first <= last)
+		stats_run_range(first, last, index, a_info_save);
+
+	if (!stats_write_shard(index, shard_count, last - first + 1))
+		quit("Problems writing shard!");
+}
+
+/**
+ * Run all the shards at once in worker processes, returning how many
+ * worker processes failed.
+ */
+static int stats_run_jobs(artifact_type *a_info_save)
+{
+	int i;
+	int failed = 0;
+
+	fflush(stdout);
+
+	for (i = 0; i < shard_count; i++) {
+		pid_t pid = fork();
+
+		if (pid < 0) quit("Couldn't start a worker process!");
+
+		if (pid == 0) {
+			quiet = TRUE;
+			stats_run_shard(i, a_info_save);
+			_exit(0);
+		}
+	}
+
+	for (i = 0; i < shard_count; i++) {
+		int status;
+
+		if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status))
+			failed++;
+		else if (!quiet) {
+			printf("Worker %d of %d done.\n", i + 1, shard_count);
+			fflush(stdout);
+		}
+	}
+
+	return failed;
+}
+
+static errr run_stats(void)
+{
+	u32b runs = 0;
+	artifact_type *a_info_save = NULL;
 	unsigned int i;
 	int err;
 	bool status; 
 
-	time_t start;
-
 	prep_output_dir();
 	create_indices();
 	alloc_memory();
+	stats_snapshot();
 	if (randarts) {
+		/* A randart.log for every run would only slow things down */
+		randart_set_verbose(FALSE);
+
 		a_info_save = mem_zalloc(z_info->a_max * sizeof(artifact_type));
 		for (i = 0; i < z_info->a_max; i++) {
 			if (!a_info[i].name) continue;
 
 			memcpy(&a_info_save[i], &a_info[i], sizeof(artifact_type));
+			a_info_save[i].slays = NULL;
+			a_info_save[i].brands = NULL;
+			copy_slay(&a_info_save[i].slays, a_info[i].slays);
+			copy_brand(&a_info_save[i].brands, a_info[i].brands);
 		}
 	}
 
-	if (!quiet) printf("Creating the database and dumping info...\n");
-	status = stats_prep_db();
-	if (!status) quit("Couldn't prepare database!");
-
-	if (!quiet) {
-		printf("Beginning %d runs...\n", num_runs);
-		fflush(stdout);
+	/* Shards must agree on their seeds, so pick one for them all */
+	if ((jobs || shard_index >= 0) && !base_seed)
+		base_seed = (u32b) time(NULL);
+	if (base_seed)
+		rng_state_init(&run_seeds, base_seed);
+
+	/* Benchmarks don't keep any counts */
+	if (bench_min) {
+		stats_benchmark(a_info_save);
+		free_artifacts_save(a_info_save);
+		stats_free_snapshot();
+		free_stats_memory();
+		cleanup_angband();
+		quit(NULL);
+		exit(0);
 	}
 
-	start = time(NULL);
-	for (run = 1; run <= num_runs; run++) {
-		if (!quiet) progress_bar(run - 1, start);
+	/* A lone shard saves its counters for a later merge, and stops */
+	if (shard_index >= 0) {
+		if (!quiet) {
+			printf("Running shard %d of %d with seed 0x%08lx...\n",
+				   shard_index + 1, shard_count, (unsigned long)base_seed);
+			fflush(stdout);
+		}
+		stats_run_shard(shard_index, a_info_save);
+		if (!quiet) printf("\nDone!\n");
+		quit(NULL);
+		exit(0);
+	}
 
-		if (randarts)
-			for (i = 0; i < z_info->a_max; i++)
-				memcpy(&a_info[i], &a_info_save[i], sizeof(artifact_type));
+	/* Workers are started before the database is open */
+	if (jobs) {
+		if (!quiet) {
+			printf("Beginning %d runs in %d workers with seed 0x%08lx...\n",
+				   num_runs, shard_count, (unsigned long)base_seed);
+			fflush(stdout);
+		}
+		if (stats_run_jobs(a_info_save))
+			quit("A worker process failed!");
+	}
 
-		initialize_character();
-		unkill_uniques();
-		reset_artifacts();
-		descend_dungeon();
-		stats_cleanup_angband_run();
+	if (!quiet) printf("Creating the database and dumping info...\n");
 
-		/* Checkpoint every so many runs */
-		if (run % RUNS_PER_CHECKPOINT == 0) {
-			err = stats_write_db(run);
-			if (err) {
-				stats_db_close();
-				quit_fmt("Problems writing to database!  sqlite3 errno %d.",
-						 err);
-			}
-		}
+	status = stats_prep_db();
+	if (!status) quit("Couldn't prepare database!");
 
-		if (quiet && run % 1000 == 0) {
-			printf("Finished %d runs.\n", run);
+	if (jobs || merge_shards) {
+		if (!quiet) printf("Merging %d shards...\n", shard_count);
+		for (i = 0; i < (unsigned int)shard_count; i++)
+			runs += stats_merge_shard(i, shard_count);
+	} else {
+		if (!quiet) {
+			printf("Beginning %d runs...\n", num_runs);
 			fflush(stdout);
 		}
+		stats_run_range(1, num_runs, -1, a_info_save);
+		runs = num_runs;
 	}
 
 	if (!quiet) {
-		progress_bar(num_runs, start);
 		printf("\nSaving the data...\n");
 		fflush(stdout);
 	}
 
-	err = stats_write_db(run);
+	err = stats_write_db(runs);
 	stats_db_close();
+	string_free(cols_dir);
 	if (err) quit_fmt("Problems writing to database!  sqlite3 errno %d.", err);
 
-	if (randarts)
-		mem_free(a_info_save);
+	if (!quiet)
+		printf("Level attempts: %lu, builder failures: %lu, "
+			   "monster overflows: %lu\n", (unsigned long)gen_stats.attempts,
+			   (unsigned long)gen_stats.builder_failed,
+			   (unsigned long)gen_stats.too_many_monsters);
+
+	free_artifacts_save(a_info_save);
+	stats_free_snapshot();
 	free_stats_memory();
 	cleanup_angband();
 	if (!quiet) printf("Done!\n");
@@ -1689,17 +2433,46 @@ static void term_data_link(int i) {
 	angband_term[i] = t;
 }
 
-const char help_stats[] = "Stats mode, subopts -q(uiet) -r(andarts) -n(# of runs) -s(no selling)";
+const char help_stats[] = "Stats mode, subopts -q(uiet) -r(andarts) -n(# of runs) -s(no selling) -x(base seed) -j(obs) -k(shard) -M(erge) -w(scratch db) -c(olumns) -g(enerate only) -p(rofile) -i(tems only)";
 
 /**
  * Usage:
  *
- * angband -mstats -- [-q] [-r] [-nNNNN] [-s]
+ * angband -mstats -- [-q] [-r] [-nNNNN] [-s] [-xNNNN] [-jN] [-kK/N] [-MN] [-w] [-c]
+ *                     [-gMIN-MAX] [-pNAME] [-i]
  *
  *   -q      Quiet mode (turn off progress messages)
  *   -r      Turn on randarts
  *   -nNNNN  Make NNNN runs through the dungeon (default: 1)
  *   -s      Turn on no-selling
+ *   -xNNNN  Seed each run from a stream started at NNNN (default: the clock)
+ *   -jN     Split the runs between N worker processes and merge the results
+ *   -kK/N   Only make the Kth of N equal shares of the runs, and save the
+ *           counts in a shard file in the stats directory instead of a
+ *           database
+ *   -MN     Merge shard files 1 to N into a database
+ *   -w      Scratch database: use a write-ahead log and don't wait for
+ *           writes to reach the disk, so checkpoints are cheaper but a
+ *           crash can lose or corrupt the database
+ *   -c      Write the count tables as column files (see stats/cols.c) in a
+ *           directory named after the database, which then holds only the
+ *           metadata and the game data tables
+ *   -gMIN-MAX  Benchmark level generation: build levels MIN to MAX (default
+ *           1 to 100) once per run, collecting nothing, and report levels per
+ *           second, the time taken by each stage, retries and allocations
+ *   -pNAME  With -g, build every level with cave profile NAME, with '_' for
+ *           any spaces (eg -pmoria, -plair)
+ *   -i      Sample item generation alone: make each level's floor objects
+ *           and gold as the classic profile would, without building the
+ *           level or its monsters, and count them in the usual tables;
+ *           vault, room and monster drop items are left out
+ *
+ * Level generation works on the global cave and player, so runs can't share
+ * a process; each worker keeps its own copy of the counters.  Seeds are drawn
+ * from one stream whichever shard makes the run, so a sharded job gives the
+ * same database as running it in one process.  Shards run by hand with -k,
+ * perhaps on different machines, must all use the same -x, -n, -r, -s and
+ * -i; the merge checks that they do.
  */
 
 errr init_stats(int argc, char *argv[]) {
@@ -1719,13 +2492,66 @@ errr init_stats(int argc, char *argv[]) {
 			num_runs = atoi(&argv[i][2]);
 			continue;
 		}
+		if (prefix(argv[i], "-x")) {
+			base_seed = strtoul(&argv[i][2], NULL, 0);
+			continue;
+		}
 		if (prefix(argv[i], "-s")) {
 			no_selling = 1;
 			continue;
 		}
+		if (prefix(argv[i], "-j")) {
+			shard_count = atoi(&argv[i][2]);
+			jobs = TRUE;
+			continue;
+		}
+		if (prefix(argv[i], "-k")) {
+			int k, n;
+			if (sscanf(&argv[i][2], "%d/%d", &k, &n) == 2 && k >= 1 &&
+				k <= n) {
+				shard_index = k - 1;
+				shard_count = n;
+				continue;
+			}
+		}
+		if (streq(argv[i], "-c")) {
+			column_output = TRUE;
+			continue;
+		}
+		if (streq(argv[i], "-w")) {
+			scratch_db = TRUE;
+			continue;
+		}
+		if (streq(argv[i], "-i")) {
+			sample_items = TRUE;
+			continue;
+		}
+		if (prefix(argv[i], "-g")) {
+			int lo = 1, hi = LEVEL_MAX - 1;
+			if (argv[i][2])
+				sscanf(&argv[i][2], "%d-%d", &lo, &hi);
+			bench_min = MAX(lo, 1);
+			bench_max = MIN(MAX(hi, bench_min), LEVEL_MAX - 1);
+			continue;
+		}
+		if (prefix(argv[i], "-p")) {
+			bench_profile = &argv[i][2];
+			continue;
+		}
+		if (prefix(argv[i], "-M")) {
+			shard_count = atoi(&argv[i][2]);
+			merge_shards = TRUE;
+			continue;
+		}
 		printf("init-stats: bad argument '%s'\n", argv[i]);
 	}
 
+	if (shard_count < 1)
+		quit("init-stats: need at least one shard");
+
+	/* Nothing is ever shown, so skip the display updates altogether */
+	event_set_headless(TRUE);
+
 	term_data_link(0);
 	return 0;
 }
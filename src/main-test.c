@@ -198,6 +198,11 @@ static errr term_xtra_fresh(int v) {
 	return 0;
 }
 
+static errr term_xtra_frame(int v) {
+	if (verbose) printf("term-xtra-frame %d\n", v);
+	return 0;
+}
+
 static errr term_xtra_shape(int v) {
 	if (verbose) printf("term-xtra-shape %d\n", v);
 	return 0;
@@ -236,6 +241,7 @@ static term_xtra_func xtras[] = {
 	{ TERM_XTRA_CLEAR, term_xtra_clear },
 	{ TERM_XTRA_NOISE, term_xtra_noise },
 	{ TERM_XTRA_FRESH, term_xtra_fresh },
+	{ TERM_XTRA_FRAME, term_xtra_frame },
 	{ TERM_XTRA_SHAPE, term_xtra_shape },
 	{ TERM_XTRA_ALIVE, term_xtra_alive },
 	{ TERM_XTRA_EVENT, term_xtra_event },
@@ -113,6 +113,12 @@
 #include <X11/keysymdef.h>
 #include <X11/XKBlib.h>
 
+#ifdef HAVE_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/extensions/XShm.h>
+#endif /* HAVE_XSHM */
+
 #include "main.h"
 
 /*
@@ -391,6 +397,15 @@ struct infofnt
 
 
 
+/**
+ * A glyph as one byte per pixel of a tile, set where it is drawn
+ */
+struct x11_glyph
+{
+	wchar_t c;
+	byte *mask;
+};
+
 /**
  * Forward declare
  */
@@ -411,6 +426,22 @@ struct term_data
 	int tile_wid2; /* Tile-width with bigscreen */
 	int tile_hgt;
 
+	/* Client-side image of the window, if drawing through one */
+	XImage *img;
+	bool img_shm;		/* The image is shared with the server */
+	bool img_busy;		/* The server may still be reading it */
+#ifdef HAVE_XSHM
+	XShmSegmentInfo shm;
+#endif /* HAVE_XSHM */
+
+	/* Pixels of the image not yet sent, x1 > x2 if none */
+	int dirty_x1, dirty_y1, dirty_x2, dirty_y2;
+
+	/* Glyphs rendered in this term's font and tile size */
+	struct x11_glyph *glyphs;
+	int glyph_max;
+	int glyph_count;
+
 	/* Pointers to allocated data, needed to clear up memory */
 	XClassHint *classh;
 	XSizeHints *sizeh;
@@ -1498,6 +1529,31 @@ static errr Infofnt_text_std(int x, int y, const wchar_t *str, int len)
 }
 
 
+/**
+ * Draw a run of text over an already cleared background
+ */
+static void Infofnt_text_over(int x, int y, const wchar_t *str, int len)
+{
+	int i;
+
+	term_data *td = (term_data*)(Term->data);
+
+	x = (x * td->tile_wid) + Infowin->ox;
+	y = (y * td->tile_hgt) + Infowin->oy + Infofnt->asc;
+
+	/* Monotize the font */
+	if (Infofnt->mono) {
+		for (i = 0; i < len; ++i)
+			XwcDrawString(Metadpy->dpy, Infowin->win, Infofnt->fs,
+						  Infoclr->gc, x + i * td->tile_wid + Infofnt->off,
+						  y, str + i, 1);
+	} else {
+		XwcDrawString(Metadpy->dpy, Infowin->win, Infofnt->fs, Infoclr->gc,
+					  x, y, str, len);
+	}
+}
+
+
 /**
  * Painting where text would be
  */
@@ -1539,6 +1595,414 @@ static errr Infofnt_text_non(int x, int y, const wchar_t *str, int len)
 
 
 
+/**
+ * ------------------------------------------------------------------------
+ *  Drawing through a client-side image
+ *
+ * Instead of a core request for every run of text, a term can keep an image
+ * of its window here and draw into that: each cell is copied out of glyphs
+ * rendered once per font, and each refresh sends only the rectangle that
+ * changed, in one request.  With the MIT-SHM extension the image is shared
+ * with the server, which then reads it straight from memory.
+ *
+ * This needs a 32 bit TrueColor visual.  By default it is used only when the
+ * image can be shared; ANGBAND_X11_IMAGE=1 asks for it anyway (sending the
+ * pixels with XPutImage), ANGBAND_X11_IMAGE=0 never uses it.
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Whether images are wanted: -1 when they can be shared, 0 never, 1 always
+ */
+static int image_wanted = -1;
+
+/**
+ * Whether images can be shared with the server
+ */
+static bool image_can_share = FALSE;
+
+#ifdef HAVE_XSHM
+
+/**
+ * Set when attaching a shared image fails
+ */
+static bool image_share_failed;
+
+static int image_share_error(Display *dpy, XErrorEvent *ev)
+{
+	(void)dpy;
+	(void)ev;
+	image_share_failed = TRUE;
+	return 0;
+}
+
+#endif /* HAVE_XSHM */
+
+/**
+ * Check the display can take images and see what the user asked for
+ */
+static void image_init(void)
+{
+	Visual *visual = DefaultVisualOfScreen(Metadpy->screen);
+	const char *str = getenv("ANGBAND_X11_IMAGE");
+
+	if (str) image_wanted = atoi(str) ? 1 : 0;
+
+	/* Pixels are written as 32 bit words of the visual's own colours */
+	if (visual->class != TrueColor || Metadpy->depth < 24)
+		image_wanted = 0;
+
+#ifdef HAVE_XSHM
+	image_can_share = XShmQueryExtension(Metadpy->dpy) ? TRUE : FALSE;
+#endif /* HAVE_XSHM */
+}
+
+/**
+ * Wait until the server has finished reading a shared image
+ */
+static void image_wait(term_data *td)
+{
+	if (!td->img_busy) return;
+	XSync(Metadpy->dpy, False);
+	td->img_busy = FALSE;
+}
+
+/**
+ * Free a term's image
+ */
+static void image_free(term_data *td)
+{
+	if (!td->img) return;
+
+	image_wait(td);
+
+#ifdef HAVE_XSHM
+	if (td->img_shm) {
+		XShmDetach(Metadpy->dpy, &td->shm);
+		XDestroyImage(td->img);
+		shmdt(td->shm.shmaddr);
+		td->img = NULL;
+		td->img_shm = FALSE;
+		return;
+	}
+#endif /* HAVE_XSHM */
+
+	/* XDestroyImage() frees the pixels too */
+	XDestroyImage(td->img);
+	td->img = NULL;
+}
+
+/**
+ * Note a rectangle of the image to be sent
+ */
+static void image_dirty(term_data *td, int x, int y, int w, int h)
+{
+	if (td->dirty_x1 > td->dirty_x2) {
+		td->dirty_x1 = x;
+		td->dirty_y1 = y;
+		td->dirty_x2 = x + w - 1;
+		td->dirty_y2 = y + h - 1;
+		return;
+	}
+
+	td->dirty_x1 = MIN(td->dirty_x1, x);
+	td->dirty_y1 = MIN(td->dirty_y1, y);
+	td->dirty_x2 = MAX(td->dirty_x2, x + w - 1);
+	td->dirty_y2 = MAX(td->dirty_y2, y + h - 1);
+}
+
+/**
+ * Fill a rectangle of the image with one pixel value
+ */
+static void image_fill(term_data *td, int x, int y, int w, int h, Pixell p)
+{
+	XImage *img = td->img;
+	int i, j;
+
+	/* Stay inside the image */
+	if (x < 0) w += x, x = 0;
+	if (y < 0) h += y, y = 0;
+	if (x + w > img->width) w = img->width - x;
+	if (y + h > img->height) h = img->height - y;
+	if (w <= 0 || h <= 0) return;
+
+	image_wait(td);
+
+	for (j = y; j < y + h; j++) {
+		u32b *row = (u32b *)(img->data + j * img->bytes_per_line);
+		for (i = x; i < x + w; i++)
+			row[i] = (u32b)p;
+	}
+
+	image_dirty(td, x, y, w, h);
+}
+
+/**
+ * Make an image the size of the term's window, if the term should have one
+ */
+static void image_make(term_data *td)
+{
+	Visual *visual = DefaultVisualOfScreen(Metadpy->screen);
+	int w = td->win->w, h = td->win->h;
+	int one = 1;
+
+	image_free(td);
+
+	if (!image_wanted || (image_wanted < 0 && !image_can_share)) return;
+	if (w <= 0 || h <= 0) return;
+
+#ifdef HAVE_XSHM
+	if (image_can_share) {
+		XErrorHandler old;
+
+		td->img = XShmCreateImage(Metadpy->dpy, visual, Metadpy->depth,
+								  ZPixmap, NULL, &td->shm, w, h);
+		if (td->img) {
+			td->shm.shmid = shmget(IPC_PRIVATE,
+								   td->img->bytes_per_line * h,
+								   IPC_CREAT | 0600);
+			td->shm.shmaddr = (td->shm.shmid < 0) ? (char *)-1 :
+				shmat(td->shm.shmid, NULL, 0);
+			td->shm.readOnly = True;
+		}
+
+		if (td->img && td->shm.shmaddr != (char *)-1) {
+			td->img->data = td->shm.shmaddr;
+
+			/* A remote server can't attach, so find out before going on */
+			image_share_failed = FALSE;
+			old = XSetErrorHandler(image_share_error);
+			XShmAttach(Metadpy->dpy, &td->shm);
+			XSync(Metadpy->dpy, False);
+			XSetErrorHandler(old);
+
+			/* The segment goes away once both sides have let go */
+			shmctl(td->shm.shmid, IPC_RMID, NULL);
+
+			if (!image_share_failed) {
+				td->img_shm = TRUE;
+			} else {
+				XDestroyImage(td->img);
+				shmdt(td->shm.shmaddr);
+				td->img = NULL;
+			}
+		} else if (td->img) {
+			if (td->shm.shmid >= 0) shmctl(td->shm.shmid, IPC_RMID, NULL);
+			XDestroyImage(td->img);
+			td->img = NULL;
+		}
+
+		/* Sharing can't be done, so only use images if asked to */
+		if (!td->img) {
+			image_can_share = FALSE;
+			if (image_wanted < 0) return;
+		}
+	}
+#endif /* HAVE_XSHM */
+
+	if (!td->img) {
+		td->img = XCreateImage(Metadpy->dpy, visual, Metadpy->depth, ZPixmap,
+							   0, NULL, w, h, 32, 0);
+		if (!td->img) return;
+
+		/* Xlib swaps the pixels for the server if it needs to */
+		td->img->byte_order = *(char *)&one ? LSBFirst : MSBFirst;
+		td->img->data = malloc(td->img->bytes_per_line * h);
+		if (!td->img->data) {
+			XDestroyImage(td->img);
+			td->img = NULL;
+			return;
+		}
+	}
+
+	/* The cells are written as whole words */
+	if (td->img->bits_per_pixel != 32) {
+		image_free(td);
+		return;
+	}
+
+	td->dirty_x1 = 1;
+	td->dirty_x2 = 0;
+	image_fill(td, 0, 0, w, h, clr[COLOUR_DARK]->fg);
+}
+
+/**
+ * Render a glyph of the term's font, as a mask the size of a tile
+ */
+static byte *glyph_render(term_data *td, wchar_t c)
+{
+	int w = td->tile_wid, h = td->tile_hgt;
+	byte *mask = mem_zalloc(w * h);
+	Pixmap pm = XCreatePixmap(Metadpy->dpy, td->win->win, w, h, 1);
+	GC gc = XCreateGC(Metadpy->dpy, pm, 0, NULL);
+	XImage *img;
+	int x, y;
+
+	XSetForeground(Metadpy->dpy, gc, 0);
+	XFillRectangle(Metadpy->dpy, pm, gc, 0, 0, w, h);
+	XSetForeground(Metadpy->dpy, gc, 1);
+	XwcDrawString(Metadpy->dpy, pm, td->fnt->fs, gc, td->fnt->off,
+				  td->fnt->asc, &c, 1);
+
+	img = XGetImage(Metadpy->dpy, pm, 0, 0, w, h, 1, XYPixmap);
+	if (img) {
+		for (y = 0; y < h; y++)
+			for (x = 0; x < w; x++)
+				mask[y * w + x] = XGetPixel(img, x, y) ? 1 : 0;
+		XDestroyImage(img);
+	}
+
+	XFreeGC(Metadpy->dpy, gc);
+	XFreePixmap(Metadpy->dpy, pm);
+
+	return mask;
+}
+
+/**
+ * Find a glyph's mask, rendering it the first time it is asked for
+ */
+static const byte *glyph_get(term_data *td, wchar_t c)
+{
+	int i;
+
+	/* Keep the table at most half full */
+	if (2 * (td->glyph_count + 1) > td->glyph_max) {
+		struct x11_glyph *old = td->glyphs;
+		int old_max = td->glyph_max;
+
+		td->glyph_max = old_max ? old_max * 2 : 256;
+		td->glyphs = mem_zalloc(td->glyph_max * sizeof(*td->glyphs));
+		for (i = 0; i < old_max; i++) {
+			int j;
+			if (!old[i].mask) continue;
+			for (j = old[i].c & (td->glyph_max - 1); td->glyphs[j].mask;
+				 j = (j + 1) & (td->glyph_max - 1))
+				;
+			td->glyphs[j] = old[i];
+		}
+		mem_free(old);
+	}
+
+	for (i = c & (td->glyph_max - 1); td->glyphs[i].mask;
+		 i = (i + 1) & (td->glyph_max - 1))
+		if (td->glyphs[i].c == c) return td->glyphs[i].mask;
+
+	td->glyphs[i].c = c;
+	td->glyphs[i].mask = glyph_render(td, c);
+	td->glyph_count++;
+
+	return td->glyphs[i].mask;
+}
+
+/**
+ * Forget every glyph, as when the font or tile size changes
+ */
+static void glyph_forget(term_data *td)
+{
+	int i;
+
+	for (i = 0; i < td->glyph_max; i++)
+		mem_free(td->glyphs[i].mask);
+	mem_free(td->glyphs);
+	td->glyphs = NULL;
+	td->glyph_max = 0;
+	td->glyph_count = 0;
+}
+
+/**
+ * Draw a run of cells of one attr into the image
+ */
+static void image_text(term_data *td, int col, int row, int n, int a,
+					   const wchar_t *s)
+{
+	XImage *img = td->img;
+	int w = td->tile_wid, h = td->tile_hgt;
+	int x0 = col * w + td->win->ox, y0 = row * h + td->win->oy;
+	u32b fg = (u32b)clr[a]->fg, bg = (u32b)clr[a]->bg;
+	int i, x, y;
+
+	/* Cells that don't fit wholly are left to the next resize */
+	if (x0 < 0 || y0 < 0 || y0 + h > img->height) return;
+	if (x0 + n * w > img->width) n = (img->width - x0) / w;
+	if (n <= 0) return;
+
+	image_wait(td);
+
+	for (i = 0; i < n; i++) {
+		const byte *mask = (s[i] == L' ') ? NULL : glyph_get(td, s[i]);
+		int left = x0 + i * w;
+
+		for (y = 0; y < h; y++) {
+			u32b *p = (u32b *)(img->data + (y0 + y) * img->bytes_per_line) +
+				left;
+
+			if (!mask) {
+				for (x = 0; x < w; x++) p[x] = bg;
+			} else {
+				const byte *m = mask + y * w;
+				for (x = 0; x < w; x++) p[x] = m[x] ? fg : bg;
+			}
+		}
+	}
+
+	image_dirty(td, x0, y0, n * w, h);
+}
+
+/**
+ * Draw the cursor into the image, as the xor outline Term_curs_x11() draws
+ */
+static void image_cursor(term_data *td, int col, int row, int w)
+{
+	XImage *img = td->img;
+	int h = td->tile_hgt;
+	int x0 = col * td->tile_wid + td->win->ox, y0 = row * h + td->win->oy;
+	u32b flip = (u32b)(Metadpy->fg ^ Metadpy->bg);
+	int x, y;
+
+	if (x0 < 0 || y0 < 0 || x0 + w > img->width || y0 + h > img->height)
+		return;
+
+	image_wait(td);
+
+	for (y = y0; y < y0 + h; y++) {
+		u32b *p = (u32b *)(img->data + y * img->bytes_per_line);
+
+		if (y == y0 || y == y0 + h - 1) {
+			for (x = x0; x < x0 + w; x++) p[x] ^= flip;
+		} else {
+			p[x0] ^= flip;
+			if (w > 1) p[x0 + w - 1] ^= flip;
+		}
+	}
+
+	image_dirty(td, x0, y0, w, h);
+}
+
+/**
+ * Send the changed part of the image to the window
+ */
+static void image_push(term_data *td)
+{
+	int x = td->dirty_x1, y = td->dirty_y1;
+	int w = td->dirty_x2 - x + 1, h = td->dirty_y2 - y + 1;
+
+	if (td->dirty_x1 > td->dirty_x2) return;
+	td->dirty_x1 = 1;
+	td->dirty_x2 = 0;
+
+#ifdef HAVE_XSHM
+	if (td->img_shm) {
+		XShmPutImage(Metadpy->dpy, td->win->win, clr[COLOUR_DARK]->gc,
+					 td->img, x, y, x, y, w, h, False);
+		td->img_busy = TRUE;
+		return;
+	}
+#endif /* HAVE_XSHM */
+
+	XPutImage(Metadpy->dpy, td->win->win, clr[COLOUR_DARK]->gc, td->img,
+			  x, y, x, y, w, h);
+}
+
+
 /*************************************************************************/
 
 
@@ -1822,6 +2286,11 @@ static errr CheckEvent(bool wait)
 			y2 = (xev->xexpose.y + xev->xexpose.height - Infowin->oy) /
 				td->tile_hgt;
 
+			/* The border is only ever drawn in the image */
+			if (td->img)
+				image_dirty(td, xev->xexpose.x, xev->xexpose.y,
+							xev->xexpose.width, xev->xexpose.height);
+
 			Term_redraw_section(x1, y1, x2, y2);
 
 			break;
@@ -1849,12 +2318,18 @@ static errr CheckEvent(bool wait)
 			int ox = Infowin->ox;
 			int oy = Infowin->oy;
 
+			bool resized = (Infowin->w != xev->xconfigure.width) ||
+				(Infowin->h != xev->xconfigure.height);
+
 			/* Save the new Window Parms */
 			Infowin->x = xev->xconfigure.x;
 			Infowin->y = xev->xconfigure.y;
 			Infowin->w = xev->xconfigure.width;
 			Infowin->h = xev->xconfigure.height;
 
+			/* The image follows the window; an Expose will refill it */
+			if (resized) image_make(td);
+
 			/* Determine "proper" number of rows/cols */
 			cols = ((Infowin->w - (ox + ox)) / td->tile_wid);
 			rows = ((Infowin->h - (oy + oy)) / td->tile_hgt);
@@ -1971,6 +2446,8 @@ static errr Term_xtra_x11_react(void)
  */
 static errr Term_xtra_x11(int n, int v)
 {
+	term_data *td = (term_data*)(Term->data);
+
 	/* Handle a subset of the legal requests */
 	switch (n)
 	{
@@ -1978,7 +2455,10 @@ static errr Term_xtra_x11(int n, int v)
 		case TERM_XTRA_NOISE: Metadpy_do_beep(); return (0);
 
 		/* Flush the output XXX XXX */
-		case TERM_XTRA_FRESH: Metadpy_update(1, 0, 0); return (0);
+		case TERM_XTRA_FRESH:
+			if (td->img) image_push(td);
+			Metadpy_update(1, 0, 0);
+			return (0);
 
 		/* Process random events XXX */
 		case TERM_XTRA_BORED: return (CheckEvent(0));
@@ -1993,7 +2473,13 @@ static errr Term_xtra_x11(int n, int v)
 		case TERM_XTRA_LEVEL: return (Term_xtra_x11_level(v));
 
 		/* Clear the screen */
-		case TERM_XTRA_CLEAR: Infowin_wipe(); return (0);
+		case TERM_XTRA_CLEAR:
+			if (td->img)
+				image_fill(td, 0, 0, td->img->width, td->img->height,
+						   clr[COLOUR_DARK]->fg);
+			else
+				Infowin_wipe();
+			return (0);
 
 		/* Delay for some milliseconds */
 		case TERM_XTRA_DELAY:
@@ -2016,6 +2502,11 @@ static errr Term_curs_x11(int x, int y)
 {
 	term_data *td = (term_data*)(Term->data);
 
+	if (td->img) {
+		image_cursor(td, x, y, td->tile_wid);
+		return (0);
+	}
+
 	XDrawRectangle(Metadpy->dpy, Infowin->win, xor->gc,
 				   x * td->tile_wid + Infowin->ox,
 				   y * td->tile_hgt + Infowin->oy,
@@ -2033,6 +2524,11 @@ static errr Term_bigcurs_x11(int x, int y)
 {
 	term_data *td = (term_data*)(Term->data);
 
+	if (td->img) {
+		image_cursor(td, x, y, td->tile_wid2);
+		return (0);
+	}
+
 	XDrawRectangle(Metadpy->dpy, Infowin->win, xor->gc,
 				   x * td->tile_wid + Infowin->ox,
 				   y * td->tile_hgt + Infowin->oy,
@@ -2048,6 +2544,15 @@ static errr Term_bigcurs_x11(int x, int y)
  */
 static errr Term_wipe_x11(int x, int y, int n)
 {
+	term_data *td = (term_data*)(Term->data);
+
+	if (td->img) {
+		image_fill(td, x * td->tile_wid + Infowin->ox,
+				   y * td->tile_hgt + Infowin->oy, n * td->tile_wid,
+				   td->tile_hgt, clr[COLOUR_DARK]->fg);
+		return (0);
+	}
+
 	/* Erase (use black) */
 	Infoclr_set(clr[COLOUR_DARK]);
 
@@ -2064,6 +2569,13 @@ static errr Term_wipe_x11(int x, int y, int n)
  */
 static errr Term_text_x11(int x, int y, int n, int a, const wchar_t *s)
 {
+	term_data *td = (term_data*)(Term->data);
+
+	if (td->img) {
+		image_text(td, x, y, n, a, s);
+		return (0);
+	}
+
 	/* Draw the text */
 	Infoclr_set(clr[a]);
 
@@ -2077,6 +2589,91 @@ static errr Term_text_x11(int x, int y, int n, int a, const wchar_t *s)
 
 
 
+/**
+ * Background rectangles for Term_batch_x11()
+ */
+static XRectangle *batch_rects;
+static int batch_rects_max;
+
+/**
+ * Draw every changed grid of a refresh.  The backgrounds are all cleared with
+ * one XFillRectangles(), then each run of adjacent grids in one colour is
+ * drawn as a single string.
+ */
+static errr Term_batch_x11(const term_cell *cells, int n)
+{
+	term_data *td = (term_data*)(Term->data);
+	int i, start, rects = 0;
+
+	/* Draw each run of one attr straight into the image */
+	if (td->img) {
+		for (start = 0; start < n; start = i) {
+			wchar_t text[256];
+			int len = 0;
+
+			for (i = start; i < n && len < 256; i++, len++) {
+				if (cells[i].y != cells[start].y ||
+					cells[i].x != cells[start].x + len ||
+					cells[i].a != cells[start].a)
+					break;
+				text[len] = cells[i].c;
+			}
+
+			image_text(td, cells[start].x, cells[start].y, len,
+					   cells[start].a, text);
+		}
+
+		return (0);
+	}
+
+	if (n > batch_rects_max) {
+		batch_rects_max = n;
+		batch_rects = mem_realloc(batch_rects,
+								  batch_rects_max * sizeof(*batch_rects));
+	}
+
+	/* Clear the changed grids, merged into horizontal strips */
+	for (i = 0; i < n; i++) {
+		if (rects && cells[i].y == cells[i - 1].y &&
+			cells[i].x == cells[i - 1].x + 1) {
+			batch_rects[rects - 1].width += td->tile_wid;
+			continue;
+		}
+
+		batch_rects[rects].x = cells[i].x * td->tile_wid + Infowin->ox;
+		batch_rects[rects].y = cells[i].y * td->tile_hgt + Infowin->oy;
+		batch_rects[rects].width = td->tile_wid;
+		batch_rects[rects].height = td->tile_hgt;
+		rects++;
+	}
+	XFillRectangles(Metadpy->dpy, Infowin->win, clr[COLOUR_DARK]->gc,
+					batch_rects, rects);
+
+	/* Draw the text */
+	for (start = 0; start < n; start = i) {
+		wchar_t text[256];
+		int len = 0;
+
+		for (i = start; i < n && len < 256; i++, len++) {
+			if (cells[i].y != cells[start].y ||
+				cells[i].x != cells[start].x + len ||
+				cells[i].a != cells[start].a)
+				break;
+			text[len] = cells[i].c;
+		}
+
+		/* Blank attrs are left as cleared background */
+		if (cells[start].a == COLOUR_DARK) continue;
+
+		Infoclr_set(clr[cells[start].a % MAX_COLORS]);
+		Infofnt_text_over(cells[start].x, cells[start].y, text, len);
+	}
+
+	/* Success */
+	return (0);
+}
+
+
 static void save_prefs(void)
 {
 	ang_file *fff;
@@ -2477,10 +3074,14 @@ static errr term_data_init(term_data *td, int i)
 	t->bigcurs_hook = Term_bigcurs_x11;
 	t->wipe_hook = Term_wipe_x11;
 	t->text_hook = Term_text_x11;
+	t->batch_hook = Term_batch_x11;
 
 	/* Save the data */
 	t->data = td;
 
+	/* Draw through an image if the display allows it */
+	image_make(td);
+
 	/* Activate (important) */
 	Term_activate(t);
 
@@ -2516,6 +3117,10 @@ static void hook_quit(const char *str)
 		(void)Infofnt_nuke();
 		mem_free(td->fnt);
 
+		/* Free the image and glyphs */
+		image_free(td);
+		glyph_forget(td);
+
 		/* Free window */
 		Infowin_set(td->win);
 		(void)Infowin_nuke();
@@ -2525,6 +3130,8 @@ static void hook_quit(const char *str)
 		(void)term_nuke(t);
 	}
 
+	mem_free(batch_rects);
+
 	/* Free colors */
 	Infoclr_set(xor);
 	(void)Infoclr_nuke();
@@ -2627,6 +3234,9 @@ errr init_x11(int argc, char **argv)
 	/* Init the Metadpy if possible */
 	if (Metadpy_init_name(dpy_name)) return (-1);
 
+	/* See whether terms can draw through images */
+	image_init();
+
 	/* Remember the number of terminal windows */
 	term_windows_open = num_term;
 
@@ -17,9 +17,11 @@
  */
 
 #include "angband.h"
+#include "cmd-record.h"
 #include "init.h"
 #include "mon-power.h"
 #include "savefile.h"
+#include "score.h"
 #include "ui-command.h"
 #include "ui-display.h"
 #include "ui-game.h"
@@ -39,7 +41,8 @@
  * all the others use this file for their "main()" function.
  */
 
-#if defined(WIN32_CONSOLE_MODE) || !defined(WINDOWS) || defined(USE_SDL)
+#if defined(WIN32_CONSOLE_MODE) || !defined(WINDOWS) || defined(USE_SDL) || \
+	defined(USE_SDL2)
 
 #include "main.h"
 
@@ -56,6 +59,10 @@ static const struct module modules[] =
 	{ "sdl", help_sdl, init_sdl },
 #endif /* USE_SDL */
 
+#ifdef USE_SDL2
+	{ "sdl2", help_sdl2, init_sdl2 },
+#endif /* USE_SDL2 */
+
 #ifdef USE_GCU
 	{ "gcu", help_gcu, init_gcu },
 #endif /* USE_GCU */
@@ -67,6 +74,10 @@ static const struct module modules[] =
 #ifdef USE_STATS
 	{ "stats", help_stats, init_stats },
 #endif /* USE_STATS */
+
+#ifdef USE_REPLAY
+	{ "replay", help_replay, init_replay },
+#endif /* USE_REPLAY */
 };
 
 static int init_sound_dummy(int argc, char *argv[]) {
@@ -112,7 +123,7 @@ static void quit_hook(const char *s)
 /**
  * SDL needs a look-in
  */
-#ifdef USE_SDL
+#if defined(USE_SDL) || defined(USE_SDL2)
 # include "SDL.h"
 #endif
 
@@ -328,6 +339,10 @@ int main(int argc, char *argv[])
 
 	bool args = TRUE;
 
+#ifdef USE_NET
+	int spectate_port = 0;
+#endif /* USE_NET */
+
 	/* Save the "program name" XXX XXX XXX */
 	argv0 = argv[0];
 
@@ -371,6 +386,14 @@ int main(int argc, char *argv[])
 				list_saves();
 				exit(0);
 
+			case 'c':
+				/* Merge the score log into the score table */
+				if (!highscore_compact()) {
+					puts("Couldn't compact the high scores.");
+					exit(1);
+				}
+				exit(0);
+
 			case 'n':
 				new_game = TRUE;
 				break;
@@ -394,6 +417,12 @@ int main(int argc, char *argv[])
 				if (*arg) arg_graphics = atoi(arg);
 				break;
 
+			case 'f':
+				/* Screen updates per second while running or resting */
+				if (!*arg) goto usage;
+				term_frame_rate = atoi(arg);
+				continue;
+
 			case 'u': {
 
 				if (!*arg) goto usage;
@@ -434,6 +463,20 @@ int main(int argc, char *argv[])
 				debug_opt(arg);
 				continue;
 
+			case 'R':
+				/* Record the session, to be replayed with -mreplay */
+				if (!*arg) goto usage;
+				cmd_record_set_file(arg);
+				continue;
+
+#ifdef USE_NET
+			case 'b':
+				/* Broadcast the main window to spectators */
+				if (!*arg) goto usage;
+				spectate_port = atoi(arg);
+				continue;
+#endif /* USE_NET */
+
 			case '-':
 				argv[i] = argv[0];
 				argc = argc - i;
@@ -446,10 +489,16 @@ int main(int argc, char *argv[])
 				puts("Usage: angband [options] [-- subopts]");
 				puts("  -n             Start a new character (WARNING: overwrites default savefile without -u)");
 				puts("  -l             Lists all savefiles you can play");
+				puts("  -c             Merge new entries into the high score table");
 				puts("  -w             Resurrect dead character (marks savefile)");
 				puts("  -r             Rebalance monsters");
 				puts("  -g             Request graphics mode");
+				puts("  -f<fps>        Limit screen updates while running or resting (0 for none)");
 				puts("  -x<opt>        Debug options; see -xhelp");
+				puts("  -R<file>       Record the session's commands in <file>");
+#ifdef USE_NET
+				puts("  -b<port>       Stream the game to spectators connecting on <port>");
+#endif /* USE_NET */
 				puts("  -u<who>        Use your <who> savefile");
 				puts("  -d<dir>=<path> Override a specific directory with <path>. <path> can be:");
 				for (i = 0; i < (int)N_ELEMENTS(change_path_values); i++) {
@@ -510,6 +559,12 @@ int main(int argc, char *argv[])
 	/* Make sure we have a display! */
 	if (!done) quit("Unable to prepare any 'display module'!");
 
+#ifdef USE_NET
+	/* Let spectators watch */
+	if (spectate_port && net_spectate(spectate_port))
+		quit_fmt("Unable to listen for spectators on port %d", spectate_port);
+#endif /* USE_NET */
+
 #ifdef UNIX
 
 	/* Get the "user name" as default player name, unless set with -u switch */
@@ -537,8 +592,9 @@ int main(int argc, char *argv[])
 	/* Set up the command hook */
 	cmd_get_hook = textui_get_cmd;
 
-	/* Set up the display handlers and things. */
-	init_display();
+	/* Set up the display handlers and things, unless there is no display */
+	if (!event_headless())
+		init_display();
 	init_angband();
 	textui_init();
 
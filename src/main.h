@@ -40,8 +40,12 @@ extern errr init_ami(int argc, char **argv);
 extern errr init_vme(int argc, char **argv);
 extern errr init_vcs(int argc, char **argv);
 extern errr init_sdl(int argc, char **argv);
+extern errr init_sdl2(int argc, char **argv);
 extern errr init_test(int argc, char **argv);
 extern errr init_stats(int argc, char **argv);
+extern errr init_replay(int argc, char **argv);
+
+extern errr net_spectate(int port);
 
 
 extern const char help_lfb[];
@@ -59,8 +63,10 @@ extern const char help_emx[];
 extern const char help_ibm[];
 extern const char help_dos[];
 extern const char help_sdl[];
+extern const char help_sdl2[];
 extern const char help_test[];
 extern const char help_stats[];
+extern const char help_replay[];
 
 
 struct module
@@ -27,8 +27,7 @@
 typedef struct _message_t
 {
 	char *str;
-	struct _message_t *newer;
-	struct _message_t *older;
+	size_t size;
 	u16b type;
 	u16b count;
 } message_t;
@@ -42,8 +41,8 @@ typedef struct _msgcolor_t
 
 typedef struct _msgqueue_t
 {
-	message_t *head;
-	message_t *tail;
+	message_t *ring;
+	u32b head;
 	msgcolor_t *colors;
 	u32b count;
 	u32b max;
@@ -63,6 +62,7 @@ void messages_init(void)
 {
 	messages = mem_zalloc(sizeof(msgqueue_t));
 	messages->max = 2048;
+	messages->ring = mem_zalloc(messages->max * sizeof(message_t));
 }
 
 /**
@@ -72,15 +72,11 @@ void messages_free(void)
 {
 	msgcolor_t *c = messages->colors;
 	msgcolor_t *nextc;
-	message_t *m = messages->head;
-	message_t *nextm;
-
-	while (m) {
-		nextm = m->older;
-		mem_free(m->str);
-		mem_free(m);
-		m = nextm;
-	}
+	u32b i;
+
+	for (i = 0; i < messages->max; i++)
+		mem_free(messages->ring[i].str);
+	mem_free(messages->ring);
 
 	while (c) {
 		nextc = c->next;
@@ -91,6 +87,15 @@ void messages_free(void)
 	mem_free(messages);
 }
 
+/**
+ * Forget all the messages, keeping the text buffers for the next ones
+ */
+void messages_clear(void)
+{
+	messages->head = 0;
+	messages->count = 0;
+}
+
 /**
  * Return the current number of messages stored.
  */
@@ -114,38 +119,30 @@ u16b messages_num(void)
 void message_add(const char *str, u16b type)
 {
 	message_t *m;
+	size_t len;
 
-	if (messages->head &&
-	    messages->head->type == type &&
-	    !strcmp(messages->head->str, str)) {
-		messages->head->count++;
-		return;
+	if (messages->count) {
+		m = &messages->ring[messages->head];
+		if (m->type == type && !strcmp(m->str, str)) {
+			m->count++;
+			return;
+		}
+		messages->head = (messages->head + 1) % messages->max;
 	}
 
-	m = mem_zalloc(sizeof(message_t));
-	m->str = string_make(str);
+	/* Reuse the oldest slot once the ring is full, text buffer and all */
+	m = &messages->ring[messages->head];
+	len = strlen(str) + 1;
+	if (m->size < len) {
+		m->size = MAX(len, 64);
+		m->str = mem_realloc(m->str, m->size);
+	}
+	memmove(m->str, str, len);
 	m->type = type;
 	m->count = 1;
-	m->older = messages->head;
-
-	if (messages->head)
-		messages->head->newer = m;
 
-	messages->head = m;
-	messages->count++;
-
-	if (!messages->tail)
-		messages->tail = m;
-
-	if (messages->count > messages->max) {
-		message_t *old_tail = messages->tail;
-
-		messages->tail = old_tail->newer;
-		messages->tail->older = NULL;
-		mem_free(old_tail->str);
-		mem_free(old_tail);
-		messages->count--;
-	}
+	if (messages->count < messages->max)
+		messages->count++;
 }
 
 /**
@@ -153,15 +150,13 @@ void message_add(const char *str, u16b type)
  */
 static message_t *message_get(u16b age)
 {
-	message_t *m = messages->head;
-
-	while (m && age--)
-		m = m->older;
+	if (age >= messages->count)
+		return NULL;
 
-	return m;
+	return &messages->ring[(messages->head + messages->max - age) %
+		messages->max];
 }
 
-
 /**
  * Returns the text of the message of age `age`.  The age of the most recently
  * saved message is 0, the one before that is of age 1, etc.
@@ -383,6 +378,29 @@ void bell(const char *fmt, ...)
 	event_signal_message(EVENT_BELL, MSG_BELL, buf);
 }
 
+/**
+ * Format a message, unless it needs no formatting at all
+ *
+ * Most messages are fixed text, and those are used as they are rather than
+ * being run through vstrnfmt().  Nothing is formatted before the message log
+ * exists, since the message would be dropped anyway.
+ *
+ * \param buf is where formatted text goes
+ * \return the text of the message, or NULL if there is nowhere to put it
+ */
+static const char *message_format(char *buf, size_t max, const char *fmt,
+								  va_list vp)
+{
+	if (!messages)
+		return NULL;
+
+	if (!strchr(fmt, '%') && strlen(fmt) < max)
+		return fmt;
+
+	(void)vstrnfmt(buf, max, fmt, vp);
+	return buf;
+}
+
 /**
  * Display a formatted message.
  *
@@ -395,26 +413,21 @@ void bell(const char *fmt, ...)
 void msg(const char *fmt, ...)
 {
 	va_list vp;
+	const char *str;
 
 	char buf[1024];
 
-	/* Begin the Varargs Stuff */
+	/* Format the message, if there is a log to add it to */
 	va_start(vp, fmt);
-
-	/* Format the args, save the length */
-	(void)vstrnfmt(buf, sizeof(buf), fmt, vp);
-
-	/* End the Varargs Stuff */
+	str = message_format(buf, sizeof(buf), fmt, vp);
 	va_end(vp);
-
-	/* Fail if messages not loaded */
-	if (!messages) return;
+	if (!str) return;
 
 	/* Add to message log */
-	message_add(buf, MSG_GENERIC);
+	message_add(str, MSG_GENERIC);
 
 	/* Send refresh event */
-	event_signal_message(EVENT_MESSAGE, MSG_GENERIC, buf);
+	event_signal_message(EVENT_MESSAGE, MSG_GENERIC, str);
 
 }
 
@@ -428,20 +441,21 @@ void msg(const char *fmt, ...)
 void msgt(unsigned int type, const char *fmt, ...)
 {
 	va_list vp;
+	const char *str;
 	char buf[1024];
+
+	/* Format the message, if there is a log to add it to */
 	va_start(vp, fmt);
-	vstrnfmt(buf, sizeof(buf), fmt, vp);
+	str = message_format(buf, sizeof(buf), fmt, vp);
 	va_end(vp);
-
-	/* Fail if messages not loaded */
-	if (!messages) return;
+	if (!str) return;
 
 	/* Add to message log */
-	message_add(buf, type);
+	message_add(str, type);
 
 	/* Send refresh event */
 	sound(type);
-	event_signal_message(EVENT_MESSAGE, type, buf);
+	event_signal_message(EVENT_MESSAGE, type, str);
 }
 
 
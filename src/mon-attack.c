@@ -90,24 +90,25 @@ static void remove_bad_spells(struct monster *m_ptr, bitflag f[RSF_SIZE])
 	of_wipe(ai_flags);
 	pf_wipe(ai_pflags);
 	if (OPT(birth_ai_learn)) {
+		struct player_state *known = cave_monster_known(cave, m_ptr->midx);
 		size_t i;
 
 		/* Occasionally forget player status */
 		if (one_in_(100)) {
-			of_wipe(m_ptr->known_pstate.flags);
-			pf_wipe(m_ptr->known_pstate.pflags);
+			of_wipe(known->flags);
+			pf_wipe(known->pflags);
 			for (i = 0; i < ELEM_MAX; i++)
-				m_ptr->known_pstate.el_info[i].res_level = 0;
+				known->el_info[i].res_level = 0;
 		}
 
 		/* Use the memorized info */
-		of_copy(ai_flags, m_ptr->known_pstate.flags);
-		of_copy(ai_pflags, m_ptr->known_pstate.pflags);
+		of_copy(ai_flags, known->flags);
+		of_copy(ai_pflags, known->pflags);
 		if (!of_is_empty(ai_flags) || !pf_is_empty(ai_pflags))
 			know_something = TRUE;
 
 		for (i = 0; i < ELEM_MAX; i++) {
-			el[i].res_level = m_ptr->known_pstate.el_info[i].res_level;
+			el[i].res_level = known->el_info[i].res_level;
 			if (el[i].res_level != 0)
 				know_something = TRUE;
 		}
@@ -268,41 +269,45 @@ bool make_attack_spell(struct monster *m_ptr)
 			return FALSE;
 
 		/* Check path */
-		if (!projectable(cave, m_ptr->fy, m_ptr->fx, py, px, PROJECT_NONE))
+		if (!square_sees_player(cave, m_ptr->fy, m_ptr->fx))
 			return FALSE;
 	}
 
 	/* Extract the monster level */
 	rlev = ((m_ptr->race->level >= 1) ? m_ptr->race->level : 1);
 
-	/* Extract the racial spell flags */
-	rsf_copy(f, m_ptr->race->spell_flags);
-
 	/* Allow "desperate" spells */
 	if (rf_has(m_ptr->race->flags, RF_SMART) &&
 	    m_ptr->hp < m_ptr->maxhp / 10 &&
 	    randint0(100) < 50)
 
 		/* Require intelligent spells */
-		set_spells(f, RST_HASTE | RST_ANNOY | RST_ESCAPE | RST_HEAL | RST_TACTIC | RST_SUMMON);
+		rsf_copy(f, m_ptr->race->spell_smart);
+
+	else
+		/* Extract the racial spell flags */
+		rsf_copy(f, m_ptr->race->spell_flags);
 
 	/* Remove the "ineffective" spells */
 	remove_bad_spells(m_ptr, f);
 
-	/* Check whether summons and bolts are worth it. */
+	/* Check whether summons and bolts are worth it; the race's bolts and
+	 * summons are sorted out at load, so only look at the grids if the
+	 * monster still has some to cast */
 	if (!rf_has(m_ptr->race->flags, RF_STUPID)) {
 		/* Check for a clean bolt shot */
-		if (test_spells(f, RST_BOLT) &&
+		if (rsf_is_inter(f, m_ptr->race->spell_bolt) &&
 			!projectable(cave, m_ptr->fy, m_ptr->fx, py, px, PROJECT_STOP))
 
 			/* Remove spells that will only hurt friends */
-			set_spells(f, ~RST_BOLT);
+			rsf_diff(f, m_ptr->race->spell_bolt);
 
 		/* Check for a possible summon */
-		if (!(summon_possible(m_ptr->fy, m_ptr->fx)))
+		if (rsf_is_inter(f, m_ptr->race->spell_summon) &&
+			!(summon_possible(m_ptr->fy, m_ptr->fx)))
 
 			/* Remove summoning spells */
-			set_spells(f, ~RST_SUMMON);
+			rsf_diff(f, m_ptr->race->spell_summon);
 	}
 
 	/* No spells left */
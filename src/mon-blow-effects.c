@@ -24,6 +24,7 @@
 #include "mon-blow-effects.h"
 #include "mon-blow-methods.h"
 #include "mon-lore.h"
+#include "mon-move.h"
 #include "mon-util.h"
 #include "obj-desc.h"
 #include "obj-gear.h"
@@ -282,6 +283,7 @@ static void melee_effect_handler_DRAIN_CHARGES(melee_effect_handler_context_t *c
 			context->obvious = TRUE;
 
 			/* Don't heal more than max hp */
+			monster_settle_regen(monster);
 			heal = MIN(heal, monster->maxhp - monster->hp);
 
 			/* Heal */
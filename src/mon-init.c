@@ -17,6 +17,7 @@
  */
 
 #include "angband.h"
+#include "cave.h"
 #include "init.h"
 #include "mon-init.h"
 #include "mon-lore.h"
@@ -32,11 +33,13 @@
 #include "object.h"
 #include "parser.h"
 #include "player-spell.h"
+#include "project.h"
 
 monster_pain *pain_messages;
 struct monster_spell *monster_spells;
 monster_base *rb_info;
 monster_race *r_info;
+byte *feat_mon_terrain;	/* enum monster_terrain for each terrain feature */
 const monster_race *ref_race = NULL;
 monster_lore *l_list;
 
@@ -438,7 +441,14 @@ static errr run_parse_mon_base(struct parser *p) {
 }
 
 static errr finish_parse_mon_base(struct parser *p) {
+	struct monster_base *rb;
+
 	rb_info = parser_priv(p);
+	for (rb = rb_info; rb; rb = rb->next) {
+		rb->name = data_string(rb->name);
+		rb->text = data_string(rb->text);
+	}
+
 	parser_destroy(p);
 	return 0;
 }
@@ -450,8 +460,6 @@ static void cleanup_mon_base(void)
 	rb = rb_info;
 	while (rb) {
 		next = rb->next;
-		string_free(rb->text);
-		string_free(rb->name);
 		mem_free(rb);
 		rb = next;
 	}
@@ -852,6 +860,7 @@ static errr run_parse_monster(struct parser *p) {
 static errr finish_parse_monster(struct parser *p) {
 	struct monster_race *r, *n;
 	size_t i;
+	bitflag bolt_mask[RSF_SIZE], summon_mask[RSF_SIZE], smart_mask[RSF_SIZE];
 
 	/* Scan the list for the max id and max blows */
 	z_info->r_max = 0;
@@ -916,6 +925,13 @@ static errr finish_parse_monster(struct parser *p) {
 	}
 	z_info->r_max += 1;
 
+	for (i = 0; i < z_info->r_max; i++) {
+		r_info[i].name = data_string(r_info[i].name);
+		r_info[i].text = data_string(r_info[i].text);
+		r_info[i].plural = data_string(r_info[i].plural);
+	}
+	race_index_init();
+
 	/* Convert friend names into race pointers */
 	for (i = 0; i < z_info->r_max; i++) {
 		struct monster_race *r = &r_info[i];
@@ -934,6 +950,72 @@ static errr finish_parse_monster(struct parser *p) {
 		}
 	}
 
+	/* Work out how each race moves */
+	for (i = 0; i < z_info->r_max; i++) {
+		struct monster_race *r = &r_info[i];
+
+		if (rf_has(r->flags, RF_PASS_WALL))
+			r->move_flags |= MOVE_PASS_WALL;
+		if (rf_has(r->flags, RF_KILL_WALL))
+			r->move_flags |= MOVE_KILL_WALL;
+		if (rf_has(r->flags, RF_OPEN_DOOR))
+			r->move_flags |= MOVE_OPEN_DOOR;
+		if (rf_has(r->flags, RF_BASH_DOOR))
+			r->move_flags |= MOVE_BASH_DOOR;
+		if (rf_has(r->flags, RF_NEVER_MOVE))
+			r->move_flags |= MOVE_NEVER_MOVE;
+
+		if (r->move_flags & MOVE_PASS_WALL)
+			r->move_class = MOVE_CLASS_PASSER;
+		else if (r->move_flags & MOVE_KILL_WALL)
+			r->move_class = MOVE_CLASS_TUNNELLER;
+		else if (r->move_flags & (MOVE_OPEN_DOOR | MOVE_BASH_DOOR))
+			r->move_class = MOVE_CLASS_OPENER;
+		else
+			r->move_class = MOVE_CLASS_WALKER;
+	}
+
+	/* Sort out the spells which are only cast in some situations */
+	create_mon_spell_mask(bolt_mask, RST_BOLT);
+	create_mon_spell_mask(summon_mask, RST_SUMMON);
+	create_mon_spell_mask(smart_mask, RST_HASTE | RST_ANNOY | RST_ESCAPE |
+						  RST_HEAL | RST_TACTIC | RST_SUMMON);
+	for (i = 0; i < z_info->r_max; i++) {
+		struct monster_race *r = &r_info[i];
+
+		rsf_copy(r->spell_bolt, r->spell_flags);
+		rsf_inter(r->spell_bolt, bolt_mask);
+		rsf_copy(r->spell_summon, r->spell_flags);
+		rsf_inter(r->spell_summon, summon_mask);
+		rsf_copy(r->spell_smart, r->spell_flags);
+		rsf_inter(r->spell_smart, smart_mask);
+	}
+
+	/* Work out how each race stands up to each kind of projection */
+	for (i = 0; i < z_info->r_max; i++) {
+		struct monster_race *r = &r_info[i];
+
+		r->gf_defence = mem_zalloc(GF_MAX * sizeof(byte));
+		project_m_defences(r, r->gf_defence);
+	}
+
+	/* And what each terrain feature is to them, with the terrain loaded */
+	feat_mon_terrain = mem_zalloc(z_info->f_max * sizeof(byte));
+	for (i = 0; i < z_info->f_max; i++) {
+		bitflag *flags = f_info[i].flags;
+
+		if (tf_has(flags, TF_PASSABLE))
+			feat_mon_terrain[i] = MON_TERRAIN_OPEN;
+		else if (!tf_has(flags, TF_PROJECT) && tf_has(flags, TF_PERMANENT) &&
+				 tf_has(flags, TF_ROCK))
+			feat_mon_terrain[i] = MON_TERRAIN_PERM;
+		else if (tf_has(flags, TF_DOOR_CLOSED) ||
+				 (tf_has(flags, TF_DOOR_ANY) && tf_has(flags, TF_ROCK)))
+			feat_mon_terrain[i] = MON_TERRAIN_DOOR;
+		else
+			feat_mon_terrain[i] = MON_TERRAIN_WALL;
+	}
+
 	/* Allocate space for the monster lore */
 	l_list = mem_zalloc(z_info->r_max * sizeof(monster_lore));
 	for (i = 0; i < z_info->r_max; i++) {
@@ -985,13 +1067,13 @@ static void cleanup_monster(void)
 			mem_free(m);
 			m = mn;
 		}
-		string_free(r->plural);
-		string_free(r->text);
-		string_free(r->name);
 		mem_free(r->blow);
+		mem_free(r->gf_defence);
 	}
 
+	race_index_free();
 	mem_free(r_info);
+	mem_free(feat_mon_terrain);
 }
 
 struct file_parser monster_parser = {
@@ -18,6 +18,7 @@
  */
 
 #include "game-world.h"
+#include "init.h"
 #include "mon-desc.h"
 #include "mon-list.h"
 #include "project.h"
@@ -41,6 +42,8 @@ monster_list_t *monster_list_new(void)
 		return NULL;
 	}
 
+	list->race_entry = mem_zalloc(z_info->r_max * sizeof(u16b));
+
 	list->entries_size = size;
 
 	return list;
@@ -59,6 +62,7 @@ void monster_list_free(monster_list_t *list)
 		list->entries = NULL;
 	}
 
+	mem_free(list->race_entry);
 	mem_free(list);
 	list = NULL;
 }
@@ -128,6 +132,7 @@ void monster_list_reset(monster_list_t *list)
 	}
 
 	memset(list->entries, 0, list->entries_size * sizeof(monster_list_entry_t));
+	memset(list->race_entry, 0, z_info->r_max * sizeof(u16b));
 	memset(&list->total_entries, 0, MONSTER_LIST_SECTION_MAX * sizeof(u16b));
 	memset(&list->total_monsters, 0, MONSTER_LIST_SECTION_MAX * sizeof(u16b));
 	list->distinct_entries = 0;
@@ -141,15 +146,21 @@ void monster_list_reset(monster_list_t *list)
 void monster_list_collect(monster_list_t *list)
 {
 	int i;
+	size_t next_entry = 0;
 
 	if (list == NULL || list->entries == NULL)
 		return;
 
+	/* Entries are filled from the front; carry on after any already there */
+	while (next_entry < list->entries_size && list->entries[next_entry].race)
+		next_entry++;
+
 	/* Use cave_monster_max() here in case the monster list isn't compacted. */
 	for (i = 1; i < cave_monster_max(cave); i++) {
 		struct monster *mon = cave_monster(cave, i);
 		monster_list_entry_t *entry = NULL;
-		int j, field;
+		u16b *slot;
+		int field;
 		bool los = FALSE;
 
 		/* Only consider visible, known monsters */
@@ -158,20 +169,16 @@ void monster_list_collect(monster_list_t *list)
 			continue;
 
 		/* Find or add a list entry. */
-		for (j = 0; j < (int)list->entries_size; j++) {
-			if (list->entries[j].race == NULL) {
-				/* We found an empty slot, so add this race here. */
-				entry = &list->entries[j];
-				memset(entry, 0, sizeof(monster_list_entry_t));
-				entry->race = mon->race;
-
-				break;
-			}
-			else if (list->entries[j].race == mon->race) {
-				/* We found a matching race and we'll use that. */
-				entry = &list->entries[j];
-				break;
-			}
+		slot = &list->race_entry[mon->race->ridx];
+		if (*slot) {
+			/* We found a matching race and we'll use that. */
+			entry = &list->entries[*slot - 1];
+		} else if (next_entry < list->entries_size) {
+			/* Add this race in the next empty slot. */
+			entry = &list->entries[next_entry++];
+			memset(entry, 0, sizeof(monster_list_entry_t));
+			entry->race = mon->race;
+			*slot = next_entry;
 		}
 
 		if (entry == NULL)
@@ -212,7 +219,7 @@ void monster_list_collect(monster_list_t *list)
 		return;
 
 	/* Collect totals for easier calculations of the list. */
-	for (i = 0; i < (int)list->entries_size; i++) {
+	for (i = 0; i < (int)next_entry; i++) {
 		if (list->entries[i].race == NULL)
 			continue;
 
@@ -269,7 +276,7 @@ int monster_list_standard_compare(const void *a, const void *b)
 void monster_list_sort(monster_list_t *list,
 					   int (*compare)(const void *, const void *))
 {
-	size_t elements;
+	size_t i, elements;
 
 	if (list == NULL || list->entries == NULL)
 		return;
@@ -284,6 +291,10 @@ void monster_list_sort(monster_list_t *list,
 
 	sort(list->entries, elements, sizeof(list->entries[0]), compare);
 	list->sorted = TRUE;
+
+	/* The races have moved */
+	for (i = 0; i < elements; i++)
+		list->race_entry[list->entries[i].race->ridx] = i + 1;
 }
 
 /**
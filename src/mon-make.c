@@ -23,6 +23,7 @@
 #include "mon-desc.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-timed.h"
 #include "mon-util.h"
 #include "obj-identify.h"
@@ -40,6 +41,29 @@ s16b num_repro;
 static s16b alloc_race_size;
 static struct alloc_entry *alloc_race_table;
 
+/**
+ * Running sums of the third pass probabilities of alloc_race_table, kept as
+ * a Fenwick tree so a monster can be picked without walking the table.
+ *
+ * The third pass only depends on the level asked for, the restriction set
+ * by get_mon_num_prep(), the player's depth and the date, and on which
+ * uniques are about.  The sums are only worked out afresh when one of the
+ * first four changes; the uniques are checked on every call.
+ */
+static long *alloc_race_sums;
+static int alloc_race_step;
+static long alloc_race_total;
+static s16b *alloc_race_uniques;
+static s16b alloc_race_unique_num;
+static u32b alloc_race_prep;
+static struct {
+	bool valid;
+	int level;
+	u32b prep;
+	int depth;
+	bool season;
+} alloc_race_key;
+
 static void init_race_allocs(void) {
 	int i;
 	struct monster_race *race;
@@ -79,6 +103,12 @@ static void init_race_allocs(void) {
 
 	/* Allocate the alloc_race_table */
 	alloc_race_table = mem_zalloc(alloc_race_size * sizeof(alloc_entry));
+	alloc_race_sums = mem_zalloc((alloc_race_size + 1) * sizeof(long));
+	alloc_race_uniques = mem_zalloc(alloc_race_size * sizeof(s16b));
+	alloc_race_unique_num = 0;
+	alloc_race_key.valid = FALSE;
+	for (alloc_race_step = 1; alloc_race_step * 2 <= alloc_race_size;
+		 alloc_race_step *= 2) ;
 
 	/* Get the table entry */
 	table = alloc_race_table;
@@ -115,11 +145,19 @@ static void init_race_allocs(void) {
 			aux[x]++;
 		}
 	}
+
+	/* Note the uniques, in table order */
+	for (i = 0; i < alloc_race_size; i++)
+		if (rf_has(r_info[table[i].index].flags, RF_UNIQUE))
+			alloc_race_uniques[alloc_race_unique_num++] = i;
+
 	mem_free(aux);
 	mem_free(num);
 }
 
 static void cleanup_race_allocs(void) {
+	mem_free(alloc_race_uniques);
+	mem_free(alloc_race_sums);
 	mem_free(alloc_race_table);
 }
 
@@ -155,7 +193,15 @@ void delete_monster_idx(int m_idx)
 	if (player->upkeep->health_who == mon) health_track(player->upkeep, NULL);
 
 	/* Monster is gone */
-	cave->squares[y][x].mon = 0;
+	square_set_mon(cave, y, x, 0);
+	cave_occupant_stamp++;
+	cave_monster_cell(cave, mon, y, x, FALSE);
+
+	/* Its light goes with it */
+	if (rf_has(mon->race->flags, RF_HAS_LIGHT)) {
+		cave_monster_light(cave, mon, y, x, FALSE);
+		player->upkeep->update |= PU_UPDATE_VIEW;
+	}
 
 	/* Delete objects */
 	obj = mon->held_obj;
@@ -184,6 +230,8 @@ void delete_monster_idx(int m_idx)
 
 	/* Count monsters */
 	cave->mon_cnt--;
+	if (m_idx < cave->mon_hole)
+		cave->mon_hole = m_idx;
 
 	/* Visual update */
 	square_light_spot(cave, y, x);
@@ -221,7 +269,9 @@ static void compact_monsters_aux(int i1, int i2)
 	x = mon->fx;
 
 	/* Update the cave */
-	cave->squares[y][x].mon = i2;
+	square_set_mon(cave, y, x, i2);
+	cave_occupant_stamp++;
+	cave_monster_cell(cave, mon, y, x, FALSE);
 	
 	/* Update midx */
 	mon->midx = i2;
@@ -248,6 +298,13 @@ static void compact_monsters_aux(int i1, int i2)
 
 	/* Hack -- wipe hole */
 	memset(cave_monster(cave, i1), 0, sizeof(struct monster));
+
+	/* What it knows goes with it */
+	cave_monster_known_copy(cave, i2, cave, i1);
+
+	/* Index and schedule it under its new index */
+	cave_monster_cell(cave, cave_monster(cave, i2), y, x, TRUE);
+	monster_reschedule(cave, cave_monster(cave, i2));
 }
 
 
@@ -267,7 +324,7 @@ static void compact_monsters_aux(int i1, int i2)
  */
 void compact_monsters(int num_to_compact)
 {
-	int m_idx, num_compacted, iter;
+	int m_idx, num_compacted, iter, next_iter;
 
 	int max_lev, min_dis, chance;
 
@@ -278,13 +335,17 @@ void compact_monsters(int num_to_compact)
 
 
 	/* Compact at least 'num_to_compact' objects */
-	for (num_compacted = 0, iter = 1; num_compacted < num_to_compact; iter++) {
+	for (num_compacted = 0, iter = 1; num_compacted < num_to_compact;
+		 iter = next_iter) {
 		/* Get more vicious each iteration */
 		max_lev = 5 * iter;
 
 		/* Get closer each iteration */
 		min_dis = 5 * (20 - iter);
 
+		/* The first iteration in which a monster that is spared now won't be */
+		next_iter = 0;
+
 		/* Check all the monsters */
 		for (m_idx = 1; m_idx < cave_monster_max(cave); m_idx++) {
 			struct monster *mon = cave_monster(cave, m_idx);
@@ -292,11 +353,19 @@ void compact_monsters(int num_to_compact)
 			/* Skip "dead" monsters */
 			if (!mon->race) continue;
 
-			/* High level monsters start out "immune" */
-			if (mon->race->level > max_lev) continue;
+			/* High level monsters start out "immune", and nearby monsters
+			 * are ignored */
+			if ((mon->race->level > max_lev) ||
+				((min_dis > 0) && (mon->cdis < min_dis))) {
+				int when = MAX((mon->race->level + 4) / 5,
+							   20 - mon->cdis / 5);
+				if (!next_iter || when < next_iter)
+					next_iter = when;
+				continue;
+			}
 
-			/* Ignore nearby monsters */
-			if ((min_dis > 0) && (mon->cdis < min_dis)) continue;
+			/* Everything from now on will be looked at next time */
+			next_iter = iter + 1;
 
 			/* Saving throw chance */
 			chance = 90;
@@ -317,6 +386,9 @@ void compact_monsters(int num_to_compact)
 			/* Count the monster */
 			num_compacted++;
 		}
+
+		/* Passes that would spare every monster untouched are skipped */
+		next_iter = MAX(next_iter, iter + 1);
 	}
 
 
@@ -333,6 +405,7 @@ void compact_monsters(int num_to_compact)
 		/* Compress "cave->mon_max" */
 		cave->mon_max--;
 	}
+	cave->mon_hole = cave->mon_max;
 }
 
 
@@ -360,14 +433,19 @@ void wipe_mon_list(struct chunk *c, struct player *p)
 		mon->race->cur_num--;
 
 		/* Monster is gone */
-		c->squares[mon->fy][mon->fx].mon = 0;
+		square_set_mon(c, mon->fy, mon->fx, 0);
+		cave_monster_light(c, mon, mon->fy, mon->fx, FALSE);
 
 		/* Wipe the Monster */
 		memset(mon, 0, sizeof(struct monster));
 	}
+	cave_occupant_stamp++;
 
 	/* Reset "cave->mon_max" */
 	c->mon_max = 1;
+	c->mon_hole = 1;
+	cave_monster_cells_wipe(c);
+	monster_schedule_free(c);
 
 	/* Reset "mon_cnt" */
 	c->mon_cnt = 0;
@@ -406,8 +484,8 @@ s16b mon_pop(struct chunk *c)
 		return m_idx;
 	}
 
-	/* Recycle dead monsters if we've run out of room */
-	for (m_idx = 1; m_idx < cave_monster_max(c); m_idx++) {
+	/* Recycle dead monsters if we've run out of room, lowest first */
+	for (m_idx = c->mon_hole; m_idx < cave_monster_max(c); m_idx++) {
 		struct monster *mon = cave_monster(c, m_idx);
 
 		/* Skip live monsters */
@@ -415,10 +493,12 @@ s16b mon_pop(struct chunk *c)
 
 		/* Count monsters */
 		c->mon_cnt++;
+		c->mon_hole = m_idx + 1;
 
 		/* Use this monster */
 		return m_idx;
 	}
+	c->mon_hole = cave_monster_max(c);
 
 	/* Warn the player if no index is available 
 	 * (except during dungeon creation)
@@ -454,32 +534,125 @@ void get_mon_num_prep(bool (*get_mon_num_hook)(struct monster_race *race))
 			entry->prob2 = 0;
 	}
 
+	/* The third pass needs working out again */
+	alloc_race_prep++;
+
 	return;
 }
 
 /**
- * Helper function for get_mon_num(). Scans the prepared monster allocation
- * table and picks a random monster. Returns the index of a monster in
- * `table`.
+ * Work out the third pass probability of an allocation table entry for the
+ * given level
  */
-static struct monster_race *get_mon_race_aux(long total,
-											 const alloc_entry *table)
+static int get_mon_num_prob(const alloc_entry *entry, int level, bool season)
+{
+	struct monster_race *race = &r_info[entry->index];
+
+	/* Monsters are sorted by depth */
+	if (entry->level > level) return 0;
+
+	/* No town monsters in dungeon */
+	if ((level > 0) && (entry->level <= 0)) return 0;
+
+	/* No seasonal monsters outside of Christmas */
+	if (rf_has(race->flags, RF_SEASONAL) && !season) return 0;
+
+	/* Only one copy of a a unique must be around at the same time */
+	if (rf_has(race->flags, RF_UNIQUE) && race->cur_num >= race->max_num)
+		return 0;
+
+	/* Some monsters never appear out of depth */
+	if (rf_has(race->flags, RF_FORCE_DEPTH) && race->level > player->depth)
+		return 0;
+
+	/* Accept */
+	return entry->prob2;
+}
+
+/**
+ * Add to the running sums from a table entry onwards
+ */
+static void alloc_race_sums_add(int i, long amount)
+{
+	for (i++; i <= alloc_race_size; i += i & (-i))
+		alloc_race_sums[i] += amount;
+}
+
+/**
+ * Bring the third pass probabilities of the allocation table, and their
+ * running sums, up to date for the given level.
+ */
+static void get_mon_num_update(int level)
 {
 	int i;
+	alloc_entry *table = alloc_race_table;
+	time_t cur_time = time(NULL);
+	struct tm *date = localtime(&cur_time);
+	bool season = (date->tm_mon == 11 && date->tm_mday >= 24 &&
+				   date->tm_mday <= 26) ? TRUE : FALSE;
+
+	/* Only the uniques can have changed, so just look at them */
+	if (alloc_race_key.valid && alloc_race_key.level == level &&
+		alloc_race_key.prep == alloc_race_prep &&
+		alloc_race_key.depth == player->depth &&
+		alloc_race_key.season == season) {
+		for (i = 0; i < alloc_race_unique_num; i++) {
+			alloc_entry *entry = &table[alloc_race_uniques[i]];
+			int prob = get_mon_num_prob(entry, level, season);
+
+			if (entry->level > level) break;
+			if (prob == entry->prob3) continue;
+
+			alloc_race_sums_add(alloc_race_uniques[i], prob - entry->prob3);
+			alloc_race_total += prob - entry->prob3;
+			entry->prob3 = prob;
+		}
+		return;
+	}
+
+	/* Process probabilities */
+	alloc_race_total = 0L;
+	for (i = 0; i < alloc_race_size; i++) {
+		table[i].prob3 = get_mon_num_prob(&table[i], level, season);
+		alloc_race_sums[i + 1] = table[i].prob3;
+		alloc_race_total += table[i].prob3;
+	}
+
+	/* Turn them into running sums */
+	for (i = 1; i <= alloc_race_size; i++) {
+		int j = i + (i & (-i));
+		if (j <= alloc_race_size)
+			alloc_race_sums[j] += alloc_race_sums[i];
+	}
+
+	alloc_race_key.valid = TRUE;
+	alloc_race_key.level = level;
+	alloc_race_key.prep = alloc_race_prep;
+	alloc_race_key.depth = player->depth;
+	alloc_race_key.season = season;
+}
+
+/**
+ * Helper function for get_mon_num(). Picks a random monster from the
+ * prepared monster allocation table, using the running sums to find the
+ * entry a walk along the table would have stopped at.
+ */
+static struct monster_race *get_mon_race_aux(void)
+{
+	int i = 0, step;
 
 	/* Pick a monster */
-	long value = randint0(total);
+	long value = randint0(alloc_race_total);
 
 	/* Find the monster */
-	for (i = 0; i < alloc_race_size; i++) {
-		/* Found the entry */
-		if (value < table[i].prob3) break;
-
-		/* Decrement */
-		value -= table[i].prob3;
+	for (step = alloc_race_step; step; step /= 2) {
+		if (i + step <= alloc_race_size && alloc_race_sums[i + step] <= value) {
+			i += step;
+			value -= alloc_race_sums[i];
+		}
 	}
 	
-	return &r_info[table[i].index];
+	return &r_info[alloc_race_table[i].index];
 }
 
 /**
@@ -506,63 +679,22 @@ static struct monster_race *get_mon_race_aux(long total,
  */
 struct monster_race *get_mon_num(int level)
 {
-	int i, p;
-
-	long total;
+	int p;
 
 	struct monster_race *race;
 
-	alloc_entry *table = alloc_race_table;
-
 	/* Occasionally produce a nastier monster in the dungeon */
 	if (level > 0 && one_in_(z_info->ood_monster_chance))
 		level += MIN(level / 4 + 2, z_info->ood_monster_amount);
 
-	total = 0L;
-
 	/* Process probabilities */
-	for (i = 0; i < alloc_race_size; i++) {
-		time_t cur_time = time(NULL);
-		struct tm *date = localtime(&cur_time);
-
-		/* Monsters are sorted by depth */
-		if (table[i].level > level) break;
-
-		/* Default */
-		table[i].prob3 = 0;
-
-		/* No town monsters in dungeon */
-		if ((level > 0) && (table[i].level <= 0)) continue;
-
-		/* Get the chosen monster */
-		race = &r_info[table[i].index];
-
-		/* No seasonal monsters outside of Christmas */
-		if (rf_has(race->flags, RF_SEASONAL) && 
-			!(date->tm_mon == 11 && date->tm_mday >= 24 && date->tm_mday <= 26))
-			continue;
-
-		/* Only one copy of a a unique must be around at the same time */
-		if (rf_has(race->flags, RF_UNIQUE) && 
-				race->cur_num >= race->max_num)
-			continue;
-
-		/* Some monsters never appear out of depth */
-		if (rf_has(race->flags, RF_FORCE_DEPTH) && race->level > player->depth)
-			continue;
-
-		/* Accept */
-		table[i].prob3 = table[i].prob2;
-
-		/* Total */
-		total += table[i].prob3;
-	}
+	get_mon_num_update(level);
 
 	/* No legal monsters */
-	if (total <= 0) return NULL;
+	if (alloc_race_total <= 0) return NULL;
 
 	/* Pick a monster */
-	race = get_mon_race_aux(total, table);
+	race = get_mon_race_aux();
 
 	/* Try for a "harder" monster once (50%) or twice (10%) */
 	p = randint0(100);
@@ -571,7 +703,7 @@ struct monster_race *get_mon_num(int level)
 		struct monster_race *old = race;
 
 		/* Pick a new monster */
-		race = get_mon_race_aux(total, table);
+		race = get_mon_race_aux();
 
 		/* Keep the deepest one */
 		if (race->level < old->level) race = old;
@@ -582,7 +714,7 @@ struct monster_race *get_mon_num(int level)
 		struct monster_race *old = race;
 
 		/* Pick a monster */
-		race = get_mon_race_aux(total, table);
+		race = get_mon_race_aux();
 
 		/* Keep the deepest one */
 		if (race->level < old->level) race = old;
@@ -763,11 +895,23 @@ s16b place_monster(struct chunk *c, int y, int x, struct monster *mon,
 	/* Set the ID */
 	new_mon->midx = m_idx;
 
+	/* It knows nothing yet of the player */
+	cave_monster_known_copy(c, m_idx, NULL, 0);
+
+	/* Its energy is as of the end of the last game turn */
+	mflag_off(new_mon->mflag, MFLAG_DORMANT);
+	new_mon->energy_turn = turn - 1;
+	new_mon->regen_turn = turn;
+	monster_reschedule(c, new_mon);
+
 	/* Set the location */
-	c->squares[y][x].mon = new_mon->midx;
+	square_set_mon(c, y, x, new_mon->midx);
+	cave_occupant_stamp++;
 	new_mon->fy = y;
 	new_mon->fx = x;
 	assert(square_monster(c, y, x) == new_mon);
+	cave_monster_light(c, new_mon, y, x, TRUE);
+	cave_monster_cell(c, new_mon, y, x, TRUE);
 
 	update_mon(new_mon, c, TRUE);
 
@@ -928,6 +1072,7 @@ static bool place_new_monster_one(struct chunk *c, int y, int x,
 	if (sleep && race->sleep) {
 		int val = race->sleep;
 		mon->m_timed[MON_TMD_SLEEP] = ((val * 2) + randint1(val * 10));
+		mon_timed_refresh(mon);
 	}
 
 	/* Uniques get a fixed amount of HP */
@@ -1312,8 +1457,9 @@ void monster_death(struct monster *mon, bool stats)
 	bool visible = (mflag_has(mon->mflag, MFLAG_VISIBLE) ||
 					rf_has(mon->race->flags, RF_UNIQUE));
 
-	/* Delete any mimicked objects */
+	/* Delete any mimicked objects, which are on the floor */
 	if (mon->mimicked_obj) {
+		square_excise_object(cave, mon->fy, mon->fx, mon->mimicked_obj);
 		object_delete(mon->mimicked_obj);
 		mon->mimicked_obj = NULL;
 	}
@@ -1398,6 +1544,7 @@ bool mon_take_hit(struct monster *mon, int dam, bool *fear, const char *note)
 		become_aware(mon);
 
 	/* Hurt it */
+	monster_settle_regen(mon);
 	mon->hp -= dam;
 
 	/* It is dead now */
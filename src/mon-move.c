@@ -31,6 +31,7 @@
 #include "mon-desc.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-spell.h"
 #include "mon-util.h"
 #include "obj-desc.h"
@@ -43,6 +44,7 @@
 #include "player-util.h"
 #include "project.h"
 #include "trap.h"
+#include "z-trace.h"
 
 
 /**
@@ -134,7 +136,7 @@ static void find_range(monster_type *m_ptr)
 
 	if (m_ptr->min_range < flee_range) {
 		/* Creatures that don't move never like to get too close */
-		if (rf_has(m_ptr->race->flags, RF_NEVER_MOVE))
+		if (m_ptr->race->move_flags & MOVE_NEVER_MOVE)
 			m_ptr->min_range += 3;
 
 		/* Spellcasters that don't strike never like to get too close */
@@ -207,6 +209,28 @@ bool multiply_monster(const monster_type *m_ptr)
 }
 
 
+/**
+ * Turns it takes a monster of each movement class to get into each kind of
+ * terrain, or 0 if it can't
+ */
+static const byte mon_move_cost[MON_TERRAIN_MAX][MOVE_CLASS_MAX] = {
+	/* Walker, opener, tunneller, passer */
+	{ 1, 1, 1, 1 },	/* Open */
+	{ 0, 0, 0, 0 },	/* Permanent wall */
+	{ 0, 2, 1, 1 },	/* Door */
+	{ 0, 0, 1, 1 }	/* Wall */
+};
+
+/**
+ * Turns it takes a monster race to get into a grid of a terrain feature, or
+ * 0 if it never can; for working out routes by movement class
+ */
+int monster_move_cost(const struct monster_race *race, int feat)
+{
+	return mon_move_cost[feat_mon_terrain[feat]][race->move_class];
+}
+
+
 /* From Will Asher in DJA:
  * Find whether a monster is near a permanent wall
  * this decides whether PASS_WALL & KILL_WALL monsters 
@@ -219,7 +243,7 @@ static bool near_permwall(const monster_type *m_ptr, struct chunk *c)
 	int mx = m_ptr->fx;
 	
 	/* if PC is in LOS, there's no need to go around walls */
-    if (projectable(cave, my, mx, player->py, player->px, PROJECT_NONE)) 
+    if (square_sees_player(cave, my, mx))
 		return FALSE;
     
     /* PASS_WALL & KILL_WALL monsters occasionally flow for a turn anyway */
@@ -245,7 +269,7 @@ static bool near_permwall(const monster_type *m_ptr, struct chunk *c)
  * through obstacles.
  *
  * Monsters first try to use up-to-date distance information ('sound') as
- * saved in cave->squares[y][x].cost.  Failing that, they'll try using scent
+ * saved in cave->cost[y][x].  Failing that, they'll try using scent
  * ('when') which is just old cost information.
  *
  * Tracking by 'scent' means that monsters end up near enough the player to
@@ -269,18 +293,18 @@ static bool get_moves_flow(struct chunk *c, struct monster *m_ptr)
 
 	/* Only use this algorithm for passwall monsters if near permanent walls,
 	 * to avoid getting snagged */
-	if (flags_test(m_ptr->race->flags, RF_SIZE, RF_PASS_WALL, RF_KILL_WALL,
-				   FLAG_END) && !near_permwall(m_ptr, c))
+	if ((m_ptr->race->move_flags & (MOVE_PASS_WALL | MOVE_KILL_WALL)) &&
+		!near_permwall(m_ptr, c))
 		return (FALSE);
 
 	/* The player is not currently near the monster grid */
-	if (c->squares[my][mx].when < c->squares[py][px].when)
+	if (c->when[my][mx] < c->when[py][px])
 		/* If the player has never been near this grid, abort */
-		if (c->squares[my][mx].when == 0) return FALSE;
+		if (c->when[my][mx] == 0) return FALSE;
 
 	/* Monster is too far away to notice the player */
-	if (c->squares[my][mx].cost > z_info->max_flow_depth) return FALSE;
-	if (c->squares[my][mx].cost > m_ptr->race->aaf) return FALSE;
+	if (c->cost[my][mx] > z_info->max_flow_depth) return FALSE;
+	if (c->cost[my][mx] > m_ptr->race->aaf) return FALSE;
 	/* If the player can see monster, run towards them */
 	if (square_isview(c, my, mx)) return FALSE;
 
@@ -292,17 +316,17 @@ static bool get_moves_flow(struct chunk *c, struct monster *m_ptr)
 		int x = mx + ddx_ddd[i];
 
 		/* Ignore unvisited/unpassable locations */
-		if (c->squares[y][x].when == 0) continue;
+		if (c->when[y][x] == 0) continue;
 
 		/* Ignore locations whose data is more stale */
-		if (c->squares[y][x].when < best_when) continue;
+		if (c->when[y][x] < best_when) continue;
 
 		/* Ignore locations which are farther away */
-		if (c->squares[y][x].cost > best_cost) continue;
+		if (c->cost[y][x] > best_cost) continue;
 
 		/* Save the cost and time */
-		best_when = c->squares[y][x].when;
-		best_cost = c->squares[y][x].cost;
+		best_when = c->when[y][x];
+		best_cost = c->cost[y][x];
 		best_direction = i;
 		found_direction = TRUE;
 	}
@@ -328,6 +352,51 @@ static bool get_moves_flow(struct chunk *c, struct monster *m_ptr)
 	return FALSE;
 }
 
+/**
+ * Choose a direction along the level's routes towards the player, for
+ * monsters which are beyond the reach of the flow.
+ *
+ * This is only done on levels where the layout makes heading straight for
+ * the player hopeless, such as caverns and labyrinths; FIELD_ROUTE gives
+ * the steps from every grid to the player's sector, and is shared by every
+ * monster.
+ */
+static bool get_moves_route(struct chunk *c, struct monster *m_ptr)
+{
+	int i;
+	int my = m_ptr->fy, mx = m_ptr->fx;
+	int dist;
+
+	if (!c->long_routes) return FALSE;
+
+	/* Monsters which go through walls don't need routes */
+	if (flags_test(m_ptr->race->flags, RF_SIZE, RF_PASS_WALL, RF_KILL_WALL,
+				   FLAG_END))
+		return FALSE;
+
+	/* If the player can see monster, run towards them */
+	if (square_isview(c, my, mx)) return FALSE;
+
+	/* No route, or already there */
+	dist = cave_field_dist(c, FIELD_ROUTE, my, mx);
+	if (dist == FIELD_UNREACHED || dist == 0) return FALSE;
+
+	/* Take the first step which gets closer, diagonals first */
+	for (i = 7; i >= 0; i--) {
+		int y = my + ddy_ddd[i];
+		int x = mx + ddx_ddd[i];
+
+		if (!square_in_bounds(c, y, x)) continue;
+		if (cave_field_dist(c, FIELD_ROUTE, y, x) >= dist) continue;
+
+		m_ptr->ty = y;
+		m_ptr->tx = x;
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
 /**
  * Provide a location to flee to, but give the player a wide berth.
  *
@@ -345,12 +414,12 @@ static bool get_moves_fear(struct chunk *c, struct monster *m_ptr)
 	int my = m_ptr->fy, mx = m_ptr->fx;
 
 	/* If the player is not currently near the monster, no reason to flow */
-	if (c->squares[my][mx].when < c->squares[py][px].when)
+	if (c->when[my][mx] < c->when[py][px])
 		return FALSE;
 
 	/* Monster is too far away to use flow information */
-	if (c->squares[my][mx].cost > z_info->max_flow_depth) return FALSE;
-	if (c->squares[my][mx].cost > m_ptr->race->aaf) return FALSE;
+	if (c->cost[my][mx] > z_info->max_flow_depth) return FALSE;
+	if (c->cost[my][mx] > m_ptr->race->aaf) return FALSE;
 
 	/* Check nearby grids, diagonals first */
 	for (i = 7; i >= 0; i--) {
@@ -361,7 +430,7 @@ static bool get_moves_fear(struct chunk *c, struct monster *m_ptr)
 		int x = mx + ddx_ddd[i];
 
 		/* Ignore illegal & older locations */
-		if (c->squares[y][x].when == 0 || c->squares[y][x].when < best_when)
+		if (c->when[y][x] == 0 || c->when[y][x] < best_when)
 			continue;
 
 		/* Calculate distance of this grid from our target */
@@ -371,7 +440,7 @@ static bool get_moves_fear(struct chunk *c, struct monster *m_ptr)
 		 * First half of calculation is inversely proportional to distance
 		 * Second half is inversely proportional to grid's distance from player
 		 */
-		score = 5000 / (dis + 3) - 500 / (c->squares[y][x].cost + 1);
+		score = 5000 / (dis + 3) - 500 / (c->cost[y][x] + 1);
 
 		/* No negative scores */
 		if (score < 0) score = 0;
@@ -380,7 +449,7 @@ static bool get_moves_fear(struct chunk *c, struct monster *m_ptr)
 		if (score < best_score) continue;
 
 		/* Save the score and time */
-		best_when = c->squares[y][x].when;
+		best_when = c->when[y][x];
 		best_score = score;
 
 		/* Save the location */
@@ -401,136 +470,10 @@ static bool get_moves_fear(struct chunk *c, struct monster *m_ptr)
 
 
 
-/*
- * Hack -- Precompute a bunch of calls to distance() in find_safety() and
- * find_hiding().
- *
- * The pair of arrays dist_offsets_y[n] and dist_offsets_x[n] contain the
- * offsets of all the locations with a distance of n from a central point,
- * with an offset of (0,0) indicating no more offsets at this distance.
- *
- * This is, of course, fairly unreadable, but it eliminates multiple loops
- * from the previous version.
- *
- * It is probably better to replace these arrays with code to compute
- * the relevant arrays, even if the storage is pre-allocated in hard
- * coded sizes.  At the very least, code should be included which is
- * able to generate and dump these arrays (ala "los()").  XXX XXX XXX
- *
- * Also, the storage needs could be reduced by using char.  XXX XXX XXX
+/**
+ * How far a monster will look for somewhere to run or hide
  */
-
-
-static const int d_off_y_0[] =
-{ 0 };
-
-static const int d_off_x_0[] =
-{ 0 };
-
-
-static const int d_off_y_1[] =
-{ -1, -1, -1, 0, 0, 1, 1, 1, 0 };
-
-static const int d_off_x_1[] =
-{ -1, 0, 1, -1, 1, -1, 0, 1, 0 };
-
-
-static const int d_off_y_2[] =
-{ -1, -1, -2, -2, -2, 0, 0, 1, 1, 2, 2, 2, 0 };
-
-static const int d_off_x_2[] =
-{ -2, 2, -1, 0, 1, -2, 2, -2, 2, -1, 0, 1, 0 };
-
-
-static const int d_off_y_3[] =
-{ -1, -1, -2, -2, -3, -3, -3, 0, 0, 1, 1, 2, 2,
-  3, 3, 3, 0 };
-
-static const int d_off_x_3[] =
-{ -3, 3, -2, 2, -1, 0, 1, -3, 3, -3, 3, -2, 2,
-  -1, 0, 1, 0 };
-
-
-static const int d_off_y_4[] =
-{ -1, -1, -2, -2, -3, -3, -3, -3, -4, -4, -4, 0,
-  0, 1, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 0 };
-
-static const int d_off_x_4[] =
-{ -4, 4, -3, 3, -2, -3, 2, 3, -1, 0, 1, -4, 4,
-  -4, 4, -3, 3, -2, -3, 2, 3, -1, 0, 1, 0 };
-
-
-static const int d_off_y_5[] =
-{ -1, -1, -2, -2, -3, -3, -4, -4, -4, -4, -5, -5,
-  -5, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 4, 4, 5, 5,
-  5, 0 };
-
-static const int d_off_x_5[] =
-{ -5, 5, -4, 4, -4, 4, -2, -3, 2, 3, -1, 0, 1,
-  -5, 5, -5, 5, -4, 4, -4, 4, -2, -3, 2, 3, -1,
-  0, 1, 0 };
-
-
-static const int d_off_y_6[] =
-{ -1, -1, -2, -2, -3, -3, -4, -4, -5, -5, -5, -5,
-  -6, -6, -6, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5,
-  5, 5, 6, 6, 6, 0 };
-
-static const int d_off_x_6[] =
-{ -6, 6, -5, 5, -5, 5, -4, 4, -2, -3, 2, 3, -1,
-  0, 1, -6, 6, -6, 6, -5, 5, -5, 5, -4, 4, -2,
-  -3, 2, 3, -1, 0, 1, 0 };
-
-
-static const int d_off_y_7[] =
-{ -1, -1, -2, -2, -3, -3, -4, -4, -5, -5, -5, -5,
-  -6, -6, -6, -6, -7, -7, -7, 0, 0, 1, 1, 2, 2, 3,
-  3, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 0 };
-
-static const int d_off_x_7[] =
-{ -7, 7, -6, 6, -6, 6, -5, 5, -4, -5, 4, 5, -2,
-  -3, 2, 3, -1, 0, 1, -7, 7, -7, 7, -6, 6, -6,
-  6, -5, 5, -4, -5, 4, 5, -2, -3, 2, 3, -1, 0,
-  1, 0 };
-
-
-static const int d_off_y_8[] =
-{ -1, -1, -2, -2, -3, -3, -4, -4, -5, -5, -6, -6,
-  -6, -6, -7, -7, -7, -7, -8, -8, -8, 0, 0, 1, 1,
-  2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
-  8, 8, 8, 0 };
-
-static const int d_off_x_8[] =
-{ -8, 8, -7, 7, -7, 7, -6, 6, -6, 6, -4, -5, 4,
-  5, -2, -3, 2, 3, -1, 0, 1, -8, 8, -8, 8, -7,
-  7, -7, 7, -6, 6, -6, 6, -4, -5, 4, 5, -2, -3,
-  2, 3, -1, 0, 1, 0 };
-
-
-static const int d_off_y_9[] =
-{ -1, -1, -2, -2, -3, -3, -4, -4, -5, -5, -6, -6,
-  -7, -7, -7, -7, -8, -8, -8, -8, -9, -9, -9, 0,
-  0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 7,
-  7, 8, 8, 8, 8, 9, 9, 9, 0 };
-
-static const int d_off_x_9[] =
-{ -9, 9, -8, 8, -8, 8, -7, 7, -7, 7, -6, 6, -4,
-  -5, 4, 5, -2, -3, 2, 3, -1, 0, 1, -9, 9, -9,
-  9, -8, 8, -8, 8, -7, 7, -7, 7, -6, 6, -4, -5,
-  4, 5, -2, -3, 2, 3, -1, 0, 1, 0 };
-
-
-static const int *dist_offsets_y[10] =
-{
-	d_off_y_0, d_off_y_1, d_off_y_2, d_off_y_3, d_off_y_4,
-	d_off_y_5, d_off_y_6, d_off_y_7, d_off_y_8, d_off_y_9
-};
-
-static const int *dist_offsets_x[10] =
-{
-	d_off_x_0, d_off_x_1, d_off_x_2, d_off_x_3, d_off_x_4,
-	d_off_x_5, d_off_x_6, d_off_x_7, d_off_x_8, d_off_x_9
-};
+#define HIDE_RANGE 9
 
 
 /**
@@ -541,77 +484,62 @@ static const int *dist_offsets_x[10] =
  * cause monsters to "duck" behind walls.  Hopefully, monsters will also
  * try to run towards corridor openings if they are in a room.
  *
- * This function may take lots of CPU time if lots of monsters are fleeing.
+ * The steps to the nearest such grid are shared by every monster in the
+ * FIELD_SAFETY distance field, so each monster just walks down the field,
+ * preferring at each step the grid furthest from the player.  A monster
+ * which is already safe moves to a safe neighbour further from the player.
  *
  * Return TRUE if a safe location is available.
  */
 static bool find_safety(struct chunk *c, struct monster *m_ptr)
 {
-	int fy = m_ptr->fy;
-	int fx = m_ptr->fx;
-
 	int py = player->py;
 	int px = player->px;
 
-	int i, y, x, dy, dx, d, dis;
-	int gy = 0, gx = 0, gdis = 0;
+	int y = m_ptr->fy;
+	int x = m_ptr->fx;
 
-	const int *y_offsets;
-	const int *x_offsets;
+	int dist = cave_field_dist(c, FIELD_SAFETY, y, x);
+	int steps = MAX(dist, 1);
 
-	/* Start with adjacent locations, spread further */
-	for (d = 1; d < 10; d++) {
-		/* Get the lists of points with a distance d from (fx, fy) */
-		y_offsets = dist_offsets_y[d];
-		x_offsets = dist_offsets_x[d];
-
-		/* Check the locations */
-		for (i = 0, dx = x_offsets[0], dy = y_offsets[0];
-		     dx != 0 || dy != 0;
-		     i++, dx = x_offsets[i], dy = y_offsets[i]) {
-			y = fy + dy;
-			x = fx + dx;
-
-			/* Skip illegal locations */
-			if (!square_in_bounds_fully(cave, y, x)) continue;
+	/* Nowhere safe close enough */
+	if (dist > HIDE_RANGE) return FALSE;
 
-			/* Skip locations in a wall */
-			if (!square_ispassable(cave, y, x)) continue;
+	while (steps--) {
+		int i, gy = 0, gx = 0, gdis = -1;
+		int want = MAX(dist - 1, 0);
 
-			/* Ignore grids very far from the player */
-			if (c->squares[y][x].when < c->squares[py][px].when) continue;
-
-			/* Ignore too-distant grids */
-			if (c->squares[y][x].cost > c->squares[fy][fx].cost + 2 * d)
-				continue;
-
-			/* Check for absence of shot (more or less) */
-			if (!square_isview(c, y, x)) {
-				/* Calculate distance from player */
-				dis = distance(y, x, py, px);
-
-				/* Remember if further than previous */
-				if (dis > gdis) {
-					gy = y;
-					gx = x;
-					gdis = dis;
-				}
+		for (i = 0; i < 8; i++) {
+			int yy = y + ddy_ddd[i];
+			int xx = x + ddx_ddd[i];
+			int dis;
+
+			if (!square_in_bounds_fully(c, yy, xx)) continue;
+			if (cave_field_dist(c, FIELD_SAFETY, yy, xx) != want) continue;
+
+			/* Remember if further than previous */
+			dis = distance(yy, xx, py, px);
+			if (dis > gdis) {
+				gy = yy;
+				gx = xx;
+				gdis = dis;
 			}
 		}
 
-		/* Check for success */
-		if (gdis > 0) {
-			/* Good location */
-			m_ptr->ty = gy;
-			m_ptr->tx = gx;
+		/* Nowhere to go (only possible for a monster which is safe) */
+		if (gdis < 0) return FALSE;
 
-			/* Found safe place */
-			return (TRUE);
-		}
+		y = gy;
+		x = gx;
+		dist = want;
 	}
 
-	/* No safe place */
-	return (FALSE);
+	/* Good location */
+	m_ptr->ty = y;
+	m_ptr->tx = x;
+
+	/* Found safe place */
+	return (TRUE);
 }
 
 
@@ -623,6 +551,10 @@ static bool find_safety(struct chunk *c, struct monster *m_ptr)
  * Pack monsters will use this to "ambush" the player and lure him out
  * of corridors into open space so they can swarm him.
  *
+ * Grids are looked at nearest the monster first; the projection from the
+ * monster, which is by far the dearest test, is only made for grids which
+ * would be an improvement.
+ *
  * Return TRUE if a good location is available.
  */
 static bool find_hiding(struct monster *m_ptr)
@@ -633,26 +565,22 @@ static bool find_hiding(struct monster *m_ptr)
 	int py = player->py;
 	int px = player->px;
 
-	int i, y, x, dy, dx, d, dis;
+	int i, y, x, d, dis;
 	int gy = 0, gx = 0, gdis = 999, min;
 
-	const int *y_offsets, *x_offsets;
+	const struct loc *offsets;
 
 	/* Closest distance to get */
 	min = distance(py, px, fy, fx) * 3 / 4 + 2;
 
 	/* Start with adjacent locations, spread further */
-	for (d = 1; d < 10; d++) {
-		/* Get the lists of points with a distance d from (fx, fy) */
-		y_offsets = dist_offsets_y[d];
-		x_offsets = dist_offsets_x[d];
-
-		/* Check the locations */
-		for (i = 0, dx = x_offsets[0], dy = y_offsets[0];
-		     dx != 0 || dy != 0;
-		     i++, dx = x_offsets[i], dy = y_offsets[i]) {
-			y = fy + dy;
-			x = fx + dx;
+	for (d = 1, i = distance_offsets(0, &offsets); d <= HIDE_RANGE; d++) {
+		int n = distance_offsets(d, &offsets);
+
+		/* Check the locations at distance d from the monster */
+		for (; i < n; i++) {
+			y = fy + offsets[i].y;
+			x = fx + offsets[i].x;
 
 			/* Skip illegal locations */
 			if (!square_in_bounds_fully(cave, y, x)) continue;
@@ -660,19 +588,19 @@ static bool find_hiding(struct monster *m_ptr)
 			/* Skip occupied locations */
 			if (!square_isempty(cave, y, x)) continue;
 
-			/* Check for hidden, available grid */
-			if (!square_isview(cave, y, x) &&
-				projectable(cave, fy, fx, y, x, PROJECT_STOP)) {
-				/* Calculate distance from player */
-				dis = distance(y, x, py, px);
-
-				/* Remember if closer than previous */
-				if (dis < gdis && dis >= min) {
-					gy = y;
-					gx = x;
-					gdis = dis;
-				}
-			}
+			/* Skip grids the player can see */
+			if (square_isview(cave, y, x)) continue;
+
+			/* Only closer than previous, but far enough, will do */
+			dis = distance(y, x, py, px);
+			if (dis >= gdis || dis < min) continue;
+
+			/* Check the monster can get there directly */
+			if (!projectable(cave, fy, fx, y, x, PROJECT_STOP)) continue;
+
+			gy = y;
+			gx = x;
+			gdis = dis;
 		}
 
 		/* Check for success */
@@ -772,14 +700,97 @@ static int choose_direction(int dy, int dx)
 }
 
 
+/**
+ * What monster packs make of the player's surroundings.  This is the same for
+ * every pack member, so the first to move each game turn works it out for the
+ * rest; it also records which grids next to the player pack members are
+ * already heading for, so they spread out around the player.
+ */
+static struct {
+	struct chunk *c;
+	s32b turn;
+	int py, px;
+	bool corridor;	/* Fewer than 7 open grids next to the player */
+	byte claimed;	/* Bit for each grid next to the player being filled */
+} pack_plan;
+
+/**
+ * Bring the pack plan up to date for this game turn and player position
+ */
+static void pack_plan_update(struct chunk *c)
+{
+	int i, open = 0;
+	int py = player->py, px = player->px;
+
+	if (pack_plan.c == c && pack_plan.turn == turn &&
+		pack_plan.py == py && pack_plan.px == px)
+		return;
+
+	/* Count empty grids next to player */
+	for (i = 0; i < 8; i++) {
+		int ry = py + ddy_ddd[i];
+		int rx = px + ddx_ddd[i];
+		/* Check grid around the player for room interior (room walls count)
+		 * or other empty space */
+		if (square_ispassable(c, ry, rx) || square_isroom(c, ry, rx)) {
+			/* One more open grid */
+			open++;
+		}
+	}
+
+	pack_plan.c = c;
+	pack_plan.turn = turn;
+	pack_plan.py = py;
+	pack_plan.px = px;
+	pack_plan.corridor = (open < 7) ? TRUE : FALSE;
+	pack_plan.claimed = 0;
+}
+
+/**
+ * Choose the grid next to the player a pack member should fill, preferring
+ * one no other pack member is heading for this game turn
+ */
+static void pack_plan_claim(struct chunk *c, int *yy, int *xx)
+{
+	int i, hole = -1;
+	int tmp = randint0(8);
+
+	pack_plan_update(c);
+
+	/* Pick squares near player (pseudo-randomly) */
+	for (i = 0; i < 8; i++) {
+		int d = (tmp + i) & 7;
+
+		/* Ignore filled grids */
+		if (!square_isempty(c, player->py + ddy_ddd[d],
+							player->px + ddx_ddd[d]))
+			continue;
+
+		/* Try to fill this hole, or a free one if there is one */
+		if (hole < 0)
+			hole = d;
+		if (!(pack_plan.claimed & (1 << d))) {
+			hole = d;
+			break;
+		}
+	}
+
+	/* Nowhere to go, so settle for the last grid looked at */
+	if (hole < 0) {
+		hole = (tmp + 7) & 7;
+	} else {
+		pack_plan.claimed |= (1 << hole);
+	}
+
+	*yy = player->py + ddy_ddd[hole];
+	*xx = player->px + ddx_ddd[hole];
+}
+
 /**
  * Choose "logical" directions for monster movement
  */
 static bool get_moves(struct chunk *c, struct monster *m_ptr, int *dir)
 {
-	int py = player->py;
-	int px = player->px;
-
 	int y, x;
 
 	/* Monsters will run up to z_info->flee_range grids out of sight */
@@ -790,8 +801,8 @@ static bool get_moves(struct chunk *c, struct monster *m_ptr, int *dir)
 	/* Calculate range */
 	find_range(m_ptr);
 
-	/* Flow towards the player */
-	if (get_moves_flow(c, m_ptr)) {
+	/* Flow towards the player, or follow the route to them */
+	if (get_moves_flow(c, m_ptr) || get_moves_route(c, m_ptr)) {
 		/* Extract the "pseudo-direction" */
 		y = m_ptr->ty - m_ptr->fy;
 		x = m_ptr->tx - m_ptr->fx;
@@ -805,22 +816,10 @@ static bool get_moves(struct chunk *c, struct monster *m_ptr, int *dir)
 	if (rf_has(m_ptr->race->flags, RF_GROUP_AI) &&
 	    !flags_test(m_ptr->race->flags, RF_SIZE, RF_PASS_WALL, RF_KILL_WALL,
 					FLAG_END)) {
-		int i, open = 0;
-
-		/* Count empty grids next to player */
-		for (i = 0; i < 8; i++) {
-			int ry = py + ddy_ddd[i];
-			int rx = px + ddx_ddd[i];
-			/* Check grid around the player for room interior (room walls count)
-			 * or other empty space */
-			if (square_ispassable(c, ry, rx) || square_isroom(c, ry, rx)) {
-				/* One more open grid */
-				open++;
-			}
-		}
+		pack_plan_update(c);
 
 		/* Not in an empty space and strong player */
-		if ((open < 7) && (player->chp > player->mhp / 2)) {
+		if (pack_plan.corridor && (player->chp > player->mhp / 2)) {
 			/* Find hiding place */
 			if (find_hiding(m_ptr)) {
 				done = TRUE;
@@ -849,24 +848,11 @@ static bool get_moves(struct chunk *c, struct monster *m_ptr, int *dir)
 
 	/* Monster groups try to surround the player */
 	if (!done && rf_has(m_ptr->race->flags, RF_GROUP_AI)) {
-		int i, yy = m_ptr->ty, xx = m_ptr->tx;
-
-		/* If we are not already adjacent */
-		if (m_ptr->cdis > 1) {
-			/* Find an empty square near the player to fill */
-			int tmp = randint0(8);
-			for (i = 0; i < 8; i++) {
-				/* Pick squares near player (pseudo-randomly) */
-				yy = py + ddy_ddd[(tmp + i) & 7];
-				xx = px + ddx_ddd[(tmp + i) & 7];
-
-				/* Ignore filled grids */
-				if (!square_isempty(cave, yy, xx)) continue;
-
-				/* Try to fill this hole */
-				break;
-			}
-		}
+		int yy = m_ptr->ty, xx = m_ptr->tx;
+
+		/* If we are not already adjacent, find an empty square to fill */
+		if (m_ptr->cdis > 1)
+			pack_plan_claim(c, &yy, &xx);
 
 		/* Extract the new "pseudo-direction" */
 		y = yy - m_ptr->fy;
@@ -891,9 +877,9 @@ static bool monster_can_flow(struct chunk *c, struct monster *mon)
 	assert(c);
 
 	/* Check the flow (normal aaf is about 20) */
-	if ((c->squares[fy][fx].when == c->squares[player->py][player->px].when) &&
-	    (c->squares[fy][fx].cost < z_info->max_flow_depth) &&
-	    (c->squares[fy][fx].cost < mon->race->aaf))
+	if ((c->when[fy][fx] == c->when[player->py][player->px]) &&
+	    (c->cost[fy][fx] < z_info->max_flow_depth) &&
+	    (c->cost[fy][fx] < mon->race->aaf))
 		return TRUE;
 	return FALSE;
 }
@@ -983,6 +969,10 @@ static bool process_monster_timed(struct chunk *c, struct monster *m_ptr)
 		return TRUE;
 	}
 
+	/* Nothing else counting down */
+	if (!m_ptr->m_timed_set)
+		return FALSE;
+
 	if (m_ptr->m_timed[MON_TMD_FAST])
 		mon_dec_timed(m_ptr, MON_TMD_FAST, 1, 0, FALSE);
 
@@ -1025,17 +1015,16 @@ static bool process_monster_multiply(struct chunk *c, struct monster *m_ptr)
 	int oy = m_ptr->fy;
 	int ox = m_ptr->fx;
 
-	int k = 0, y, x;
+	int k;
 
 	monster_lore *l_ptr = get_lore(m_ptr->race);
 
 	/* Too many breeders on the level already */
 	if (num_repro >= z_info->repro_monster_max) return FALSE;
 
-	/* Count the adjacent monsters */
-	for (y = oy - 1; y <= m_ptr->fy + 1; y++)
-		for (x = ox - 1; x <= m_ptr->fx + 1; x++)
-			if (c->squares[y][x].mon > 0) k++;
+	/* Count the adjacent monsters, not the player */
+	k = square_num_occupied(c, oy - 1, ox - 1, oy + 1, ox + 1);
+	if (ABS(player->py - oy) <= 1 && ABS(player->px - ox) <= 1) k--;
 
 	/* Multiply slower in crowded areas */
 	if ((k < 4) && (k == 0 || one_in_(k * z_info->repro_monster_rate))) {
@@ -1102,13 +1091,15 @@ static bool process_monster_can_move(struct chunk *c, struct monster *m_ptr,
 		const char *m_name, int nx, int ny, bool *did_something)
 {
 	monster_lore *l_ptr = get_lore(m_ptr->race);
+	int moves = m_ptr->race->move_flags;
+	int terrain = feat_mon_terrain[c->squares[ny][nx].feat];
 
 	/* Floor is open? */
-	if (square_ispassable(c, ny, nx))
+	if (terrain == MON_TERRAIN_OPEN)
 		return TRUE;
 
 	/* Permanent wall in the way */
-	if (square_iswall(c, ny, nx) && square_isperm(c, ny, nx))
+	if (terrain == MON_TERRAIN_PERM)
 		return FALSE;
 
 	/* Normal wall, door, or secret door in the way */
@@ -1121,11 +1112,11 @@ static bool process_monster_can_move(struct chunk *c, struct monster *m_ptr,
 	}
 
 	/* Monster moves through walls (and doors) */
-	if (rf_has(m_ptr->race->flags, RF_PASS_WALL)) 
+	if (moves & MOVE_PASS_WALL)
 		return TRUE;
 
 	/* Monster destroys walls (and doors) */
-	else if (rf_has(m_ptr->race->flags, RF_KILL_WALL)) {
+	else if (moves & MOVE_KILL_WALL) {
 		/* Forget the wall */
 		sqinfo_off(c->squares[ny][nx].info, SQUARE_MARK);
 
@@ -1136,15 +1127,15 @@ static bool process_monster_can_move(struct chunk *c, struct monster *m_ptr,
 		if (square_isview(c, ny, nx))
 			player->upkeep->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
 
-		/* Fully update the flow since terrain changed */
-		player->upkeep->update |= (PU_FORGET_FLOW | PU_UPDATE_FLOW);
+		/* Update the flow, which repairs itself for the changed grid */
+		player->upkeep->update |= (PU_UPDATE_FLOW);
 
 		return TRUE;
 	}
 
 	/* Handle doors and secret doors */
-	else if (square_iscloseddoor(c, ny, nx) || square_issecretdoor(c, ny, nx)) {
-		bool may_bash = rf_has(m_ptr->race->flags, RF_BASH_DOOR) && one_in_(2);
+	else if (terrain == MON_TERRAIN_DOOR) {
+		bool may_bash = (moves & MOVE_BASH_DOOR) && one_in_(2);
 
 		/* Take a turn */
 		*did_something = TRUE;
@@ -1156,7 +1147,7 @@ static bool process_monster_can_move(struct chunk *c, struct monster *m_ptr,
 		}
 
 		/* Creature can open or bash doors */
-		if (!rf_has(m_ptr->race->flags, RF_OPEN_DOOR) && !rf_has(m_ptr->race->flags, RF_BASH_DOOR))
+		if (!(moves & (MOVE_OPEN_DOOR | MOVE_BASH_DOOR)))
 			return FALSE;
 
 		/* Stuck door -- try to unlock it */
@@ -1186,7 +1177,7 @@ static bool process_monster_can_move(struct chunk *c, struct monster *m_ptr,
 
 				/* Fall into doorway */
 				return TRUE;
-			} else if (rf_has(m_ptr->race->flags, RF_OPEN_DOOR)) {
+			} else if (moves & MOVE_OPEN_DOOR) {
 				square_open_door(c, ny, nx);
 			}
 		}
@@ -1453,7 +1444,7 @@ static void process_monster(struct chunk *c, struct monster *m_ptr)
 			break;
 		} else {
 			/* Some monsters never move */
-			if (rf_has(m_ptr->race->flags, RF_NEVER_MOVE)) {
+			if (m_ptr->race->move_flags & MOVE_NEVER_MOVE) {
 				/* Learn about lack of movement */
 				if (mflag_has(m_ptr->mflag, MFLAG_VISIBLE))
 					rf_on(l_ptr->flags, RF_NEVER_MOVE);
@@ -1497,141 +1488,370 @@ static void process_monster(struct chunk *c, struct monster *m_ptr)
 
 
 /**
- * Monster regeneration of HPs.
+ * Bring a monster's hitpoints up to date with its regeneration.
+ *
+ * A hurt monster regains a little every 100 game turns.  Rather than look at
+ * every monster on those turns, the gain since regen_turn is added up when
+ * the monster moves, or when its hitpoints are about to change.  Hurt
+ * monsters are always active, so they are never long out of date.
  */
-static void regen_monster(monster_type *m_ptr)
+void monster_settle_regen(struct monster *mon)
 {
-	/* Regenerate (if needed) */
-	if (m_ptr->hp < m_ptr->maxhp) {
-		/* Base regeneration */
-		int frac = m_ptr->maxhp / 100;
+	s32b ticks = turn / 100 - mon->regen_turn / 100;
+	int frac;
 
-		/* Minimal regeneration rate */
-		if (!frac) frac = 1;
+	mon->regen_turn = turn;
+	if (ticks <= 0 || mon->hp >= mon->maxhp) return;
 
-		/* Some monsters regenerate quickly */
-		if (rf_has(m_ptr->race->flags, RF_REGENERATE)) frac *= 2;
+	/* Base regeneration */
+	frac = mon->maxhp / 100;
 
-		/* Regenerate */
-		m_ptr->hp += frac;
+	/* Minimal regeneration rate */
+	if (!frac) frac = 1;
 
-		/* Do not over-regenerate */
-		if (m_ptr->hp > m_ptr->maxhp) m_ptr->hp = m_ptr->maxhp;
+	/* Some monsters regenerate quickly */
+	if (rf_has(mon->race->flags, RF_REGENERATE)) frac *= 2;
 
-		/* Redraw (later) if needed */
-		if (player->upkeep->health_who == m_ptr)
-			player->upkeep->redraw |= (PR_HEALTH);
-	}
+	/* Regenerate, but not past the maximum */
+	if (ticks > mon->maxhp) ticks = mon->maxhp;
+	mon->hp = MIN(mon->hp + ticks * frac, mon->maxhp);
+
+	/* Redraw (later) if needed */
+	if (player->upkeep->health_who == mon)
+		player->upkeep->redraw |= (PR_HEALTH);
 }
 
 
 /**
- * Process all the "live" monsters, once per game turn.
+ * ------------------------------------------------------------------------
+ * Monster turn scheduling
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Number of game turns covered by the schedule's wheel; monsters due further
+ * ahead share a slot with nearer ones, and are told apart by their due turn
+ */
+#define SCHED_WHEEL 256
+
+struct sched_entry {
+	int midx;
+	s32b turn;
+};
+
+/**
+ * Which monsters move on which game turn.  Entries are only ever added;
+ * one which no longer matches its monster's next_turn is simply ignored.
+ */
+struct monster_schedule {
+	struct sched_entry *slot[SCHED_WHEEL];
+	int len[SCHED_WHEEL];
+	int size[SCHED_WHEEL];
+};
+
+/**
+ * Energy a monster gains each game turn at its current speed
+ */
+static int monster_turn_energy(const struct monster *mon)
+{
+	int mspeed = mon->mspeed;
+
+	if (mon->m_timed[MON_TMD_FAST])
+		mspeed += 10;
+	if (mon->m_timed[MON_TMD_SLOW])
+		mspeed -= 10;
+
+	return turn_energy(mspeed);
+}
+
+/**
+ * Bring a monster's energy up to date with the game turns before this one.
  *
- * During each game turn, we scan through the list of all the "live" monsters,
- * (backwards, so we can excise any "freshly dead" monsters), energizing each
- * monster, and allowing fully energized monsters to move, attack, pass, etc.
+ * A monster's energy is only counted up when it is due to move, or when
+ * something else needs to know it; energy_turn is the last game turn whose
+ * gain has been added.
+ */
+void monster_settle_energy(struct monster *mon)
+{
+	s32b gap = turn - 1 - mon->energy_turn;
+
+	if (gap <= 0) return;
+
+	/* Long enough to fill up from empty */
+	if (gap > z_info->move_energy)
+		gap = z_info->move_energy;
+
+	mon->energy = MIN(mon->energy + gap * monster_turn_energy(mon), 255);
+	mon->energy_turn = turn - 1;
+}
+
+/**
+ * Set a monster's energy as of the end of the last game turn
+ */
+void monster_set_energy(struct chunk *c, struct monster *mon, int energy)
+{
+	monster_settle_energy(mon);
+	mon->energy = energy;
+	monster_reschedule(c, mon);
+}
+
+/**
+ * Put a monster on its chunk's schedule at the game turn it will next have
+ * the energy to move.  This needs calling whenever its energy or speed is
+ * changed other than by process_monsters().
+ */
+void monster_reschedule(struct chunk *c, struct monster *mon)
+{
+	struct monster_schedule *sched = c->mon_sched;
+	int need = z_info->move_energy - mon->energy;
+	int gain = monster_turn_energy(mon);
+	int i;
+
+	/* Dormant monsters are only scheduled once they wake */
+	if (mflag_has(mon->mflag, MFLAG_DORMANT)) return;
+
+	/* Turns to go, counting from the last one in the monster's energy */
+	mon->next_turn = mon->energy_turn + 1;
+	if (need > gain)
+		mon->next_turn += (need - 1) / gain;
+
+	/* The schedule is made when the chunk's monsters are next processed */
+	if (!sched) return;
+
+	i = mon->next_turn % SCHED_WHEEL;
+	if (sched->len[i] == sched->size[i]) {
+		sched->size[i] = sched->size[i] ? sched->size[i] * 2 : 8;
+		sched->slot[i] = mem_realloc(sched->slot[i],
+			sched->size[i] * sizeof(struct sched_entry));
+	}
+	sched->slot[i][sched->len[i]].midx = mon->midx;
+	sched->slot[i][sched->len[i]].turn = mon->next_turn;
+	sched->len[i]++;
+}
+
+/**
+ * Free a chunk's monster schedule
+ */
+void monster_schedule_free(struct chunk *c)
+{
+	int i;
+
+	if (!c->mon_sched) return;
+
+	for (i = 0; i < SCHED_WHEEL; i++)
+		mem_free(c->mon_sched->slot[i]);
+	mem_free(c->mon_sched);
+	c->mon_sched = NULL;
+}
+
+/**
+ * How much further off than its scanning range a sleeping monster has to be
+ * before it is taken off the schedule, and so stops being looked at at all
+ */
+#define DORMANT_MARGIN 10
+
+/**
+ * Is a monster more than `range` grids beyond its scanning range from the
+ * player in both directions?  Every step of the flow crosses at most one grid
+ * each way, so the player can't be smelled from there either.
+ */
+static bool monster_is_remote(const struct monster *mon, int range)
+{
+	int dy = ABS(mon->fy - player->py);
+	int dx = ABS(mon->fx - player->px);
+
+	return MAX(dy, dx) > mon->race->aaf + range;
+}
+
+/**
+ * Take a sleeping monster which nothing can disturb off the schedule.
  *
- * This function and its children are responsible for a considerable fraction
- * of the processor time in normal situations, greater if the character is
- * resting.
+ * monster_check_active() would keep finding it passive, and a passive monster
+ * neither wakes nor counts down its timed effects; at full hitpoints it has
+ * nothing to regenerate either.  So there is nothing to catch up on when it
+ * returns, bar giving it a fresh start on energy.
  */
-void process_monsters(struct chunk *c, int minimum_energy)
+static void monster_try_dormancy(struct chunk *c, struct monster *mon)
+{
+	if (!mon->m_timed[MON_TMD_SLEEP]) return;
+	if (mon->hp < mon->maxhp) return;
+	if (square_isview(c, mon->fy, mon->fx)) return;
+	if (!monster_is_remote(mon, DORMANT_MARGIN)) return;
+
+	mflag_on(mon->mflag, MFLAG_DORMANT);
+	mon->next_turn = 0;
+}
+
+/**
+ * Put a dormant monster back on the schedule, because something has happened
+ * to it or the player may soon be in reach
+ */
+void monster_end_dormancy(struct chunk *c, struct monster *mon)
+{
+	if (!mflag_has(mon->mflag, MFLAG_DORMANT)) return;
+
+	mflag_off(mon->mflag, MFLAG_DORMANT);
+	mon->energy_turn = turn - 1;
+	monster_reschedule(c, mon);
+}
+
+/**
+ * Wake a dormant monster once the player comes within DORMANT_MARGIN / 2 of
+ * its scanning range, or its grid comes into view; called as its distance
+ * from the player is updated
+ */
+void monster_check_dormancy(struct chunk *c, struct monster *mon)
+{
+	if (!mflag_has(mon->mflag, MFLAG_DORMANT)) return;
+
+	if (!monster_is_remote(mon, DORMANT_MARGIN / 2) ||
+		square_isview(c, mon->fy, mon->fx))
+		monster_end_dormancy(c, mon);
+}
+
+/**
+ * Make the schedule for a chunk's monsters
+ */
+static void monster_schedule_make(struct chunk *c)
 {
 	int i;
-	int mspeed;
 
-	/* Only process some things every so often */
-	bool regen = FALSE;
+	c->mon_sched = mem_zalloc(sizeof(struct monster_schedule));
 
-	/* Regenerate hitpoints and mana every 100 game turns */
-	if (turn % 100 == 0)
-		regen = TRUE;
+	for (i = 1; i < cave_monster_max(c); i++) {
+		struct monster *mon = cave_monster(c, i);
+		if (mon->race)
+			monster_reschedule(c, mon);
+	}
+}
 
-	/* Process the monsters (backwards) */
-	for (i = cave_monster_max(c) - 1; i >= 1; i--)
-	{
-		monster_type *m_ptr;
+/**
+ * Is a schedule entry still the next move of a monster which has not yet
+ * had this game turn's energy?
+ */
+static bool sched_entry_waiting(struct chunk *c, const struct sched_entry *e)
+{
+	struct monster *mon = cave_monster(c, e->midx);
 
-		/* Handle "leaving" */
-		if (player->is_dead || player->upkeep->generate_level) break;
+	return mon->race && mon->next_turn == e->turn && mon->energy_turn < turn;
+}
 
-		/* Get a 'live' monster */
-		m_ptr = cave_monster(cave, i);
-		if (!m_ptr->race) continue;
+/**
+ * Sort schedule entries into the order the old full scan met them
+ */
+static int cmp_sched_entry(const void *a, const void *b)
+{
+	const struct sched_entry *ea = a, *eb = b;
 
-		/* Ignore monsters that have already been handled */
-		if (mflag_has(m_ptr->mflag, MFLAG_HANDLED))
-			continue;
+	return eb->midx - ea->midx;
+}
+
+
+/**
+ * Process the "live" monsters due to move this game turn.
+ *
+ * Rather than scanning every monster on the level to give it energy, each
+ * monster is kept on a schedule at the game turn it will next have enough
+ * energy to move, and only those are looked at.  They are taken in the
+ * order of a backwards scan, so we can excise any "freshly dead" monsters.
+ *
+ * This is called first for monsters with more energy than the player, then
+ * for the rest; a monster due this game turn moves in the first call it
+ * has enough energy for.  Hitpoints regenerate as each monster comes up.
+ *
+ * Passive monsters which are asleep and far away are dropped from the
+ * schedule until the player comes nearer or something disturbs them.
+ */
+void process_monsters(struct chunk *c, int minimum_energy)
+{
+	struct monster_schedule *sched;
+	struct sched_entry *due;
+	int i, n = 0, kept = 0;
+	int now = turn % SCHED_WHEEL;
+
+	TRACE_BEGIN("process_monsters");
+
+	if (!c->mon_sched)
+		monster_schedule_make(c);
+	sched = c->mon_sched;
+
+	/* Find the monsters due now with enough energy for this pass */
+	due = mem_alloc((sched->len[now] + 1) * sizeof(*due));
+	for (i = 0; i < sched->len[now]; i++) {
+		struct sched_entry *e = &sched->slot[now][i];
+		struct monster *mon = cave_monster(c, e->midx);
+
+		if (e->turn > turn || !sched_entry_waiting(c, e)) continue;
 
-		/* Not enough energy to move yet */
-		if (m_ptr->energy < minimum_energy) continue;
+		monster_settle_energy(mon);
+		if (mon->energy < minimum_energy) continue;
 
-		/* Prevent reprocessing */
-		mflag_on(m_ptr->mflag, MFLAG_HANDLED);
+		due[n++] = *e;
+	}
+	sort(due, n, sizeof(*due), cmp_sched_entry);
 
-		/* Handle monster regeneration if requested */
-		if (regen)
-			regen_monster(m_ptr);
+	/* Process them */
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(c, due[i].midx);
 
-		/* Calculate the net speed */
-		mspeed = m_ptr->mspeed;
-		if (m_ptr->m_timed[MON_TMD_FAST])
-			mspeed += 10;
-		if (m_ptr->m_timed[MON_TMD_SLOW])
-			mspeed -= 10;
+		/* Handle "leaving" */
+		if (player->is_dead || player->upkeep->generate_level) break;
 
-		/* Give this monster some energy */
-		m_ptr->energy += turn_energy(mspeed);
+		/* Skip monsters which have died, or been moved on, since */
+		if (!sched_entry_waiting(c, &due[i])) continue;
+
+		/* Give this monster its energy, and catch up on regeneration */
+		monster_settle_regen(mon);
+		monster_settle_energy(mon);
+		mon->energy = MIN(mon->energy + monster_turn_energy(mon), 255);
+		mon->energy_turn = turn;
 
 		/* End the turn of monsters without enough energy to move */
-		if (m_ptr->energy < z_info->move_energy)
+		if (mon->energy < z_info->move_energy) {
+			monster_reschedule(c, mon);
 			continue;
+		}
 
 		/* Use up "some" energy */
-		m_ptr->energy -= z_info->move_energy;
+		mon->energy -= z_info->move_energy;
+		monster_reschedule(c, mon);
 
 		/* Mimics lie in wait */
-		if (is_mimicking(m_ptr)) continue;
+		if (is_mimicking(mon)) continue;
 
 		/* Check if the monster is active */
-		if (monster_check_active(c, m_ptr)) {
+		if (monster_check_active(c, mon)) {
 			/* Process timed effects - skip turn if necessary */
-			if (process_monster_timed(c, m_ptr))
+			if (process_monster_timed(c, mon))
 				continue;
 
 			/* Set this monster to be the current actor */
-			c->mon_current = i;
+			c->mon_current = due[i].midx;
 
 			/* Process the monster */
-			process_monster(c, m_ptr);
+			process_monster(c, mon);
 
 			/* Monster is no longer current */
 			c->mon_current = -1;
+		} else {
+			/* Far out of reach and asleep, so stop looking at it */
+			monster_try_dormancy(c, mon);
+		}
+	}
+	mem_free(due);
+
+	/* Drop the entries which are used up, unless the level went with them */
+	if (c->mon_sched == sched) {
+		for (i = 0; i < sched->len[now]; i++) {
+			struct sched_entry *e = &sched->slot[now][i];
+			if (e->turn > turn || sched_entry_waiting(c, e))
+				sched->slot[now][kept++] = *e;
 		}
+		sched->len[now] = kept;
 	}
 
 	/* Update monster visibility after this */
 	/* XXX This may not be necessary */
 	player->upkeep->update |= PU_MONSTERS;
-}
 
-/**
- * Clear 'moved' status from all monsters.
- *
- * Clear noise if appropriate.
- */
-void reset_monsters(void)
-{
-	int i;
-	monster_type *m_ptr;
-
-	/* Process the monsters (backwards) */
-	for (i = cave_monster_max(cave) - 1; i >= 1; i--) {
-		/* Access the monster */
-		m_ptr = cave_monster(cave, i);
-
-		/* Monster is ready to go again */
-		mflag_off(m_ptr->mflag, MFLAG_HANDLED);
-	}
+	TRACE_END("process_monsters");
 }
@@ -20,7 +20,14 @@
 
 
 bool multiply_monster(const struct monster *m);
+int monster_move_cost(const struct monster_race *race, int feat);
+void monster_settle_energy(struct monster *mon);
+void monster_set_energy(struct chunk *c, struct monster *mon, int energy);
+void monster_reschedule(struct chunk *c, struct monster *mon);
+void monster_schedule_free(struct chunk *c);
+void monster_end_dormancy(struct chunk *c, struct monster *mon);
+void monster_check_dormancy(struct chunk *c, struct monster *mon);
+void monster_settle_regen(struct monster *mon);
 void process_monsters(struct chunk *c, int minimum_energy);
-void reset_monsters(void);
 
 #endif /* !MONSTER_MOVE_H */
@@ -140,18 +140,20 @@ bool test_spells(bitflag *f, int types)
 }
 
 /**
- * Set a spell bitflag to allow only a specific set of spell types.
+ * Make a spell bitflag allowing exactly the spells of a specific set of types;
+ * a race's spells can then be pruned to those types with rsf_inter().
  *
- * \param f is the set of spell flags we're pruning
+ * \param f is the mask we're filling
  * \param types is the spell type(s) we're allowing
  */
-void set_spells(bitflag *f, int types)
+void create_mon_spell_mask(bitflag *f, int types)
 {
 	const struct mon_spell_info *info;
 
+	rsf_wipe(f);
 	for (info = mon_spell_info_table; info->index < RSF_MAX; info++)
-		if (rsf_has(f, info->index) && !(info->type & types))
-			rsf_off(f, info->index);
+		if (info->type & types)
+			rsf_on(f, info->index);
 
 	return;
 }
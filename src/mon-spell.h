@@ -77,7 +77,7 @@ enum mon_spell_type {
 int breath_dam(int element, int hp);
 void do_mon_spell(int index, struct monster *m_ptr, bool seen);
 bool test_spells(bitflag *f, int types);
-void set_spells(bitflag *f, int types);
+void create_mon_spell_mask(bitflag *f, int types);
 int best_spell_power(const monster_race *r_ptr, int resist);
 void unset_spells(bitflag *spells, bitflag *flags, bitflag *pflags,
 				  struct element_info *el, const monster_race *r_ptr);
@@ -17,7 +17,9 @@
  */
 
 #include "angband.h"
+#include "init.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-summon.h"
 #include "mon-util.h"
 
@@ -66,15 +68,17 @@ const char *summon_desc(int type)
 }
 
 /**
- * Decide if a monster race is "okay" to summon.
- *
- * Compares the given monster to the monster type specified by
- * summon_specific_type. Returns TRUE if the monster is eligible to
- * be summoned, FALSE otherwise. 
+ * Which races each summon type can bring, by race index; worked out at
+ * startup, except that S_KIN also needs the summoner's base
  */
-static bool summon_specific_okay(monster_race *race)
+static bool *summon_races;
+
+/**
+ * Decide if a monster race fits a summon type, from the race's flags and base
+ */
+static bool summon_race_fits(const monster_race *race, int type)
 {
-	struct summon_details *info = &summon_info[summon_specific_type];
+	struct summon_details *info = &summon_info[type];
 	bool unique = rf_has(race->flags, RF_UNIQUE);
 
 	/* Forbid uniques? */
@@ -90,11 +94,26 @@ static bool summon_specific_okay(monster_race *race)
 	if (info->race_flag && !rf_has(race->flags, info->race_flag))
 		return FALSE;
 
+	/* If we made it here, we're fine */
+	return TRUE;
+}
+
+/**
+ * Decide if a monster race is "okay" to summon.
+ *
+ * Compares the given monster to the monster type specified by
+ * summon_specific_type. Returns TRUE if the monster is eligible to
+ * be summoned, FALSE otherwise. 
+ */
+static bool summon_specific_okay(monster_race *race)
+{
+	if (!summon_races[summon_specific_type * z_info->r_max + race->ridx])
+		return FALSE;
+
 	/* Special case - summon kin */
 	if (summon_specific_type == S_KIN)
-		return (!unique && race->base == kin_base);
+		return (race->base == kin_base);
 
-	/* If we made it here, we're fine */
 	return TRUE;
 }
 
@@ -187,7 +206,7 @@ int call_monster(int y, int x)
 	mon_clear_timed(m_ptr, MON_TMD_SLEEP, MON_TMD_FLG_NOMESSAGE, FALSE);
 
 	/* Set it's energy to 0 */
-	m_ptr->energy = 0;
+	monster_set_energy(cave, m_ptr, 0);
 
 	return (m_ptr->race->level);
 }
@@ -275,7 +294,7 @@ int summon_specific(int y1, int x1, int lev, int type, bool delay, bool call)
 	/* If delay, try to let the player act before the summoned monsters,
 	 * including slowing down faster monsters for one turn */
 	if (delay) {
-		m_ptr->energy = 0;
+		monster_set_energy(cave, m_ptr, 0);
 		if (m_ptr->race->speed > player->state.speed)
 			mon_inc_timed(m_ptr, MON_TMD_SLOW, 1,
 				MON_TMD_FLG_NOMESSAGE, FALSE);
@@ -284,3 +303,25 @@ int summon_specific(int y1, int x1, int lev, int type, bool delay, bool call)
 	return (m_ptr->race->level);
 }
 
+static void init_summon_races(void)
+{
+	int type, i;
+
+	summon_races = mem_zalloc(S_MAX * z_info->r_max * sizeof(bool));
+	for (type = 0; type < S_MAX; type++)
+		for (i = 0; i < z_info->r_max; i++)
+			if (r_info[i].name)
+				summon_races[type * z_info->r_max + i] =
+					summon_race_fits(&r_info[i], type);
+}
+
+static void cleanup_summon_races(void)
+{
+	mem_free(summon_races);
+}
+
+struct init_module mon_summon_module = {
+	.name = "monster/mon-summon",
+	.init = init_summon_races,
+	.cleanup = cleanup_summon_races
+};
@@ -19,6 +19,7 @@
 #include "angband.h"
 #include "mon-desc.h"
 #include "mon-lore.h"
+#include "mon-move.h"
 #include "mon-msg.h"
 #include "mon-spell.h"
 #include "mon-timed.h"
@@ -147,6 +148,20 @@ static bool mon_resist_effect(const struct monster *mon, int ef_idx, int timer,
 	return (FALSE);
 }
 
+/**
+ * Work out which of a monster's timed effects are running, for when its
+ * timers have been set directly
+ */
+void mon_timed_refresh(struct monster *mon)
+{
+	int i;
+
+	mon->m_timed_set = 0;
+	for (i = 0; i < MON_TMD_MAX; i++)
+		if (mon->m_timed[i])
+			mon->m_timed_set |= 1 << i;
+}
+
 /**
  * Attempts to set the timer of the given monster effect to `timer`.
  *
@@ -202,11 +217,30 @@ static bool mon_set_timed(monster_type *m_ptr, int ef_idx, int timer,
 	if (check_resist)
 		resisted = mon_resist_effect(m_ptr, ef_idx, timer, flag);
 
+	/* Anything happening to a dormant monster brings it back */
+	if (cave)
+		monster_end_dormancy(cave, m_ptr);
+
 	if (resisted)
 		m_note = MON_MSG_UNAFFECTED;
-	else
+	else if ((ef_idx == MON_TMD_FAST || ef_idx == MON_TMD_SLOW) &&
+			 (!old_timer || !timer)) {
+		/* A change of speed moves the monster's next turn */
+		monster_settle_energy(m_ptr);
+		m_ptr->m_timed[ef_idx] = timer;
+		if (cave)
+			monster_reschedule(cave, m_ptr);
+	} else
 		m_ptr->m_timed[ef_idx] = timer;
 
+	/* Keep track of which effects are running */
+	if (!resisted) {
+		if (timer)
+			m_ptr->m_timed_set |= 1 << ef_idx;
+		else
+			m_ptr->m_timed_set &= ~(1 << ef_idx);
+	}
+
 	if (player->upkeep->health_who == m_ptr)
 		player->upkeep->redraw |= (PR_HEALTH);
 
@@ -41,6 +41,7 @@ enum {
 
 /** Functions **/
 int mon_timed_name_to_idx(const char *name);
+void mon_timed_refresh(struct monster *mon);
 bool mon_inc_timed(struct monster *m_ptr, int ef_idx, int timer, u16b flag,
 				   bool id);
 bool mon_dec_timed(struct monster *m_ptr, int ef_idx, int timer, u16b flag,
@@ -20,6 +20,7 @@
 #include "init.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-msg.h"
 #include "mon-spell.h"
 #include "mon-timed.h"
@@ -35,6 +36,58 @@
 #include "player-util.h"
 
 
+/**
+ * Open-addressed index of the monster races by name, kept at most half full;
+ * NULL marks an empty slot
+ */
+static monster_race **race_index;
+static size_t race_index_size;
+
+static size_t race_name_hash(const char *name)
+{
+	size_t hash = 5381;
+	while (*name)
+		hash = hash * 33 + (unsigned char) *name++;
+	return hash;
+}
+
+/**
+ * Index the monster races by name, once they have all been read in.  Races
+ * are added in order, so when two share a name the index finds the same one
+ * that a search would.
+ */
+void race_index_init(void)
+{
+	int i;
+
+	race_index_free();
+
+	race_index_size = 16;
+	while (race_index_size < 2 * (size_t)z_info->r_max)
+		race_index_size *= 2;
+	race_index = mem_zalloc(race_index_size * sizeof(*race_index));
+
+	for (i = 0; i < z_info->r_max; i++) {
+		monster_race *race = &r_info[i];
+		size_t j;
+
+		if (!race->name) continue;
+
+		j = race_name_hash(race->name) & (race_index_size - 1);
+		while (race_index[j] && !streq(race_index[j]->name, race->name))
+			j = (j + 1) & (race_index_size - 1);
+		if (!race_index[j])
+			race_index[j] = race;
+	}
+}
+
+void race_index_free(void)
+{
+	mem_free(race_index);
+	race_index = NULL;
+	race_index_size = 0;
+}
+
 /**
  * Returns the monster with the given name. If no monster has the exact name
  * given, returns the first monster with the given name as a (case-insensitive)
@@ -44,22 +97,32 @@ monster_race *lookup_monster(const char *name)
 {
 	int i;
 	monster_race *closest = NULL;
-	
-	/* Look for it */
-	for (i = 0; i < z_info->r_max; i++)
+
+	if (race_index) {
+		/* Look it up */
+		size_t j = race_name_hash(name) & (race_index_size - 1);
+		for (; race_index[j]; j = (j + 1) & (race_index_size - 1))
+			if (streq(name, race_index[j]->name))
+				return race_index[j];
+	} else {
+		/* Look for it */
+		for (i = 0; i < z_info->r_max; i++) {
+			monster_race *r_ptr = &r_info[i];
+
+			/* Test for equality */
+			if (r_ptr->name && streq(name, r_ptr->name))
+				return r_ptr;
+		}
+	}
+
+	/* Only look for close matches once there is no exact one */
+	for (i = 0; i < z_info->r_max && !closest; i++)
 	{
 		monster_race *r_ptr = &r_info[i];
-		if (!r_ptr->name)
-			continue;
-
-		/* Test for equality */
-		if (streq(name, r_ptr->name))
-			return r_ptr;
 
-		/* Test for close matches */
-		if (!closest && my_stristr(r_ptr->name, name))
+		if (r_ptr->name && my_stristr(r_ptr->name, name))
 			closest = r_ptr;
-	} 
+	}
 
 	/* Return our best match */
 	return closest;
@@ -220,6 +283,9 @@ void update_mon(struct monster *m_ptr, struct chunk *c, bool full)
 
 		/* Save the distance */
 		m_ptr->cdis = d;
+
+		/* Dormant monsters come back as the player nears */
+		monster_check_dormancy(c, m_ptr);
 	}
 
 	/* Extract distance */
@@ -231,9 +297,11 @@ void update_mon(struct monster *m_ptr, struct chunk *c, bool full)
 	/* Detected */
 	if (mflag_has(m_ptr->mflag, MFLAG_MARK)) flag = TRUE;
 
-	/* Check if telepathy works */
+	/* Check if telepathy works; while a level is being built the player
+	 * may still be somewhere outside it */
 	if (square_isno_esp(c, fy, fx) ||
-		square_isno_esp(c, player->py, player->px))
+		(square_in_bounds(c, player->py, player->px) &&
+		 square_isno_esp(c, player->py, player->px)))
 		telepathy_ok = FALSE;
 
 	/* Nearby */
@@ -406,11 +474,29 @@ void update_mon(struct monster *m_ptr, struct chunk *c, bool full)
 
 /**
  * Updates all the (non-dead) monsters via update_mon().
+ *
+ * Without a change of distance, a monster beyond z_info->max_sight can only
+ * be seen through detection, and marking or unmarking it calls update_mon()
+ * directly; so only the monsters in the cells of the chunk's monster index
+ * within that range of the player are looked at.
  */
 void update_monsters(bool full)
 {
 	int i;
 
+	if (!full) {
+		struct cell_iter iter;
+		struct monster *mon;
+
+		cell_iter_rect(&iter, cave, player->py - z_info->max_sight,
+					   player->px - z_info->max_sight,
+					   player->py + z_info->max_sight,
+					   player->px + z_info->max_sight);
+		while ((mon = cell_iter_next_monster(&iter)))
+			update_mon(mon, cave, FALSE);
+		return;
+	}
+
 	/* Update each (live) monster */
 	for (i = 1; i < cave_monster_max(cave); i++) {
 		monster_type *m_ptr = cave_monster(cave, i);
@@ -474,8 +560,9 @@ void monster_swap(int y1, int x1, int y2, int x2)
 	m2 = cave->squares[y2][x2].mon;
 
 	/* Update grids */
-	cave->squares[y1][x1].mon = m2;
-	cave->squares[y2][x2].mon = m1;
+	square_set_mon(cave, y1, x1, m2);
+	square_set_mon(cave, y2, x2, m1);
+	cave_occupant_stamp++;
 
 	/* Monster 1 */
 	if (m1 > 0) {
@@ -487,10 +574,15 @@ void monster_swap(int y1, int x1, int y2, int x2)
 
 		/* Update monster */
 		update_mon(m_ptr, cave, TRUE);
+		cave_monster_cell(cave, m_ptr, y1, x1, FALSE);
+		cave_monster_cell(cave, m_ptr, y2, x2, TRUE);
 
 		/* Radiate light? */
-		if (rf_has(m_ptr->race->flags, RF_HAS_LIGHT))
+		if (rf_has(m_ptr->race->flags, RF_HAS_LIGHT)) {
+			cave_monster_light(cave, m_ptr, y1, x1, FALSE);
+			cave_monster_light(cave, m_ptr, y2, x2, TRUE);
 			player->upkeep->update |= PU_UPDATE_VIEW;
+		}
 
 		/* Redraw monster list */
 		player->upkeep->redraw |= (PR_MONLIST);
@@ -528,10 +620,15 @@ void monster_swap(int y1, int x1, int y2, int x2)
 
 		/* Update monster */
 		update_mon(m_ptr, cave, TRUE);
+		cave_monster_cell(cave, m_ptr, y2, x2, FALSE);
+		cave_monster_cell(cave, m_ptr, y1, x1, TRUE);
 
 		/* Radiate light? */
-		if (rf_has(m_ptr->race->flags, RF_HAS_LIGHT))
+		if (rf_has(m_ptr->race->flags, RF_HAS_LIGHT)) {
+			cave_monster_light(cave, m_ptr, y2, x2, FALSE);
+			cave_monster_light(cave, m_ptr, y1, x1, TRUE);
 			player->upkeep->update |= PU_UPDATE_VIEW;
+		}
 
 		/* Redraw monster list */
 		player->upkeep->redraw |= (PR_MONLIST);
@@ -631,6 +728,7 @@ void update_smart_learn(struct monster *m, struct player *p, int flag,
 						int pflag, int element)
 {
 	bool element_ok = ((element >= 0) && (element < ELEM_MAX));
+	struct player_state *known;
 
 	/* Sanity check */
 	if (!flag && !element_ok) return;
@@ -651,25 +749,26 @@ void update_smart_learn(struct monster *m, struct player *p, int flag,
 	/* Analyze the knowledge; fail very rarely */
 	if (one_in_(100))
 		return;
+	known = cave_monster_known(cave, m->midx);
 
 	/* Learn the flag */
 	if (flag) {
 		if (player_of_has(p, flag))
-			of_on(m->known_pstate.flags, flag);
+			of_on(known->flags, flag);
 		else
-			of_off(m->known_pstate.flags, flag);
+			of_off(known->flags, flag);
 	}
 
 	/* Learn the pflag */
 	if (pflag) {
 		if (pf_has(player->state.pflags, pflag))
-			of_on(m->known_pstate.pflags, pflag);
+			of_on(known->pflags, pflag);
 		else
-			of_off(m->known_pstate.pflags, pflag);
+			of_off(known->pflags, pflag);
 	}
 
 	/* Learn the element */
 	if (element_ok)
-		m->known_pstate.el_info[element].res_level
+		known->el_info[element].res_level
 			= player->state.el_info[element].res_level;
 }
@@ -22,6 +22,8 @@
 #include "monster.h"
 
 /** Functions **/
+void race_index_init(void);
+void race_index_free(void);
 monster_race *lookup_monster(const char *name);
 monster_base *lookup_monster_base(const char *name);
 bool monster_is_nonliving(struct monster_race *race);
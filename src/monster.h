@@ -231,6 +231,40 @@ struct monster_mimic {
 	struct object_kind *kind;
 };
 
+/**
+ * Ways a monster race can get about, gathered from its flags when the races
+ * are loaded so that movement needn't look them up one at a time
+ */
+enum {
+	MOVE_PASS_WALL  = 0x01,
+	MOVE_KILL_WALL  = 0x02,
+	MOVE_OPEN_DOOR  = 0x04,
+	MOVE_BASH_DOOR  = 0x08,
+	MOVE_NEVER_MOVE = 0x10
+};
+
+/**
+ * Movement classes, which decide the terrain a monster can cross
+ */
+enum monster_move_class {
+	MOVE_CLASS_WALKER = 0,	/* Open ground only */
+	MOVE_CLASS_OPENER,		/* Opens or bashes doors */
+	MOVE_CLASS_TUNNELLER,	/* Destroys doors and walls */
+	MOVE_CLASS_PASSER,		/* Passes through doors and walls */
+	MOVE_CLASS_MAX
+};
+
+/**
+ * What a terrain feature is to a moving monster
+ */
+enum monster_terrain {
+	MON_TERRAIN_OPEN = 0,	/* Passable */
+	MON_TERRAIN_PERM,		/* Permanent wall, which nothing crosses */
+	MON_TERRAIN_DOOR,		/* Closed or secret door */
+	MON_TERRAIN_WALL,		/* Anything else in the way */
+	MON_TERRAIN_MAX
+};
+
 /**
  * Monster "race" information, including racial memories
  *
@@ -276,6 +310,12 @@ typedef struct monster_race
 
 	bitflag flags[RF_SIZE];         /* Flags */
 	bitflag spell_flags[RSF_SIZE];  /* Spell flags */
+	byte move_flags;                /* MOVE_* flags, from the flags */
+	byte move_class;                /* enum monster_move_class */
+	bitflag spell_bolt[RSF_SIZE];   /* Bolt spells, from the spell flags */
+	bitflag spell_summon[RSF_SIZE]; /* Summons, from the spell flags */
+	bitflag spell_smart[RSF_SIZE];  /* Spells for when desperate */
+	byte *gf_defence;               /* Defence against each projection type */
 
 	struct monster_blow *blow; /* Melee blows */
 
@@ -305,6 +345,9 @@ typedef struct monster_race
  *
  * The "held_obj" field points to the first object of a stack
  * of objects (if any) being carried by the monster (see above).
+ *
+ * What the monster knows of the player is kept apart, in the chunk's
+ * mon_known array (see cave_monster_known()).
  */
 typedef struct monster
 {
@@ -316,11 +359,15 @@ typedef struct monster
 
 	s16b hp;			/* Current Hit points */
 	s16b maxhp;			/* Max Hit points */
+	s32b regen_turn;	/**< Last game turn counted in hp.  Not saved */
 
 	s16b m_timed[MON_TMD_MAX]; /* Timed monster status effects */
+	u16b m_timed_set;	/**< Bit for each running timed effect.  Not saved */
 
 	byte mspeed;		/* Monster "speed" */
 	byte energy;		/* Monster "energy" */
+	s32b energy_turn;	/**< Last game turn counted in energy.  Not saved */
+	s32b next_turn;		/**< Game turn of next move.  Not saved */
 
 	byte cdis;			/* Current dis from player */
 
@@ -331,8 +378,6 @@ typedef struct monster
 
 	byte attr;  		/* attr last used for drawing monster */
 
-	player_state known_pstate; /* Known player state */
-
     byte ty;		/**< Monster target */
     byte tx;
 
@@ -348,6 +393,7 @@ extern monster_pain *pain_messages;
 extern struct monster_spell *monster_spells;
 extern monster_base *rb_info;
 extern monster_race *r_info;
+extern byte *feat_mon_terrain;
 extern const monster_race *ref_race;
 
 #endif /* !MONSTER_MONSTER_H */
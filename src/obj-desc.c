@@ -655,22 +655,10 @@ static size_t obj_desc_aware(const object_type *o_ptr, char *buf, size_t max,
 
 
 /**
- * Describes item `o_ptr` into buffer `buf` of size `max`.
- *
- * ODESC_PREFIX prepends a 'the', 'a' or number
- * ODESC_BASE results in a base description.
- * ODESC_COMBAT will add to-hit, to-dam and AC info.
- * ODESC_EXTRA will add pval/charge/inscription/ignore info.
- * ODESC_PLURAL will pluralise regardless of the number in the stack.
- * ODESC_STORE turns off ignore markers, for in-store display.
- * ODESC_SPOIL treats the object as fully identified.
- *
- * Setting 'prefix' to TRUE prepends a 'the', 'a' or the number in the stack,
- * respectively.
- *
- * \returns The number of bytes used of the buffer.
+ * Build the description of an object (see "object_desc()")
  */
-size_t object_desc(char *buf, size_t max, const object_type *o_ptr, int mode)
+static size_t object_desc_build(char *buf, size_t max,
+								const object_type *o_ptr, int mode)
 {
 	bool prefix = mode & ODESC_PREFIX;
 	bool spoil = mode & ODESC_SPOIL;
@@ -679,10 +667,6 @@ size_t object_desc(char *buf, size_t max, const object_type *o_ptr, int mode)
 
 	size_t end = 0;
 
-	/* Simple description for null item */
-	if (!o_ptr)
-		return strnfmt(buf, max, "(nothing)");
-
 	known = object_is_known(o_ptr) || spoil;
 
 	/* We've seen it at least once now we're aware of it */
@@ -731,3 +715,126 @@ size_t object_desc(char *buf, size_t max, const object_type *o_ptr, int mode)
 
 	return end;
 }
+
+
+static u32b desc_epoch = 1;
+
+/**
+ * Forget all remembered descriptions.
+ *
+ * This is called after each command and each game turn, and wherever
+ * knowledge or ignore settings that descriptions depend on change, so that
+ * the cache only ever serves the redraws in between, such as menus.
+ */
+void object_desc_invalidate(void)
+{
+	desc_epoch++;
+}
+
+/**
+ * Find the slot for `obj` and `key` in `table`, a cache of `size` entries
+ * each `stride` bytes long and each starting with a struct object_memo.
+ *
+ * `*hit` is set if the slot holds a result worked out from the same object,
+ * unchanged since, with the same `key` values, since the last
+ * object_desc_invalidate().  Comparing a copy of the object catches any change
+ * to it, including the temporary ones callers make to "number"; the key holds
+ * whatever else the result depends on.  Otherwise the caller should work the
+ * result out, store it in the slot and call object_memo_fill().
+ */
+struct object_memo *object_memo_find(void *table, size_t size, size_t stride,
+									 const struct object *obj,
+									 const size_t *key, bool *hit)
+{
+	struct object_memo *memo;
+	size_t h = (size_t)obj / sizeof(*obj);
+	int i;
+
+	/* Objects lying next to each other in memory get different slots */
+	for (i = 0; i < OBJECT_MEMO_KEYS; i++)
+		h = h * 31 + key[i];
+	memo = (struct object_memo *)((char *)table + (h % size) * stride);
+
+	*hit = memo->epoch == desc_epoch && memo->obj == obj &&
+		!memcmp(memo->key, key, sizeof(memo->key)) &&
+		!memcmp(&memo->copy, obj, sizeof(*obj));
+
+	return memo;
+}
+
+/**
+ * Record in `memo` that its result was just worked out from `obj` and `key`
+ */
+void object_memo_fill(struct object_memo *memo, const struct object *obj,
+					  const size_t *key)
+{
+	memo->epoch = desc_epoch;
+	memo->obj = obj;
+	memcpy(memo->key, key, sizeof(memo->key));
+	memcpy(&memo->copy, obj, sizeof(*obj));
+}
+
+/**
+ * Recently built descriptions.
+ *
+ * What the description takes from outside the object - flavour awareness,
+ * ignore settings - is covered by the epoch, which moves on whenever that may
+ * have changed (see "object_desc_invalidate()").
+ */
+#define DESC_CACHE_SIZE	64
+#define DESC_CACHE_LEN	128
+
+static struct desc_cache_entry {
+	struct object_memo memo;
+	size_t len;
+	char desc[DESC_CACHE_LEN];
+} desc_cache[DESC_CACHE_SIZE];
+
+/**
+ * Describes item `o_ptr` into buffer `buf` of size `max`.
+ *
+ * ODESC_PREFIX prepends a 'the', 'a' or number
+ * ODESC_BASE results in a base description.
+ * ODESC_COMBAT will add to-hit, to-dam and AC info.
+ * ODESC_EXTRA will add pval/charge/inscription/ignore info.
+ * ODESC_PLURAL will pluralise regardless of the number in the stack.
+ * ODESC_STORE turns off ignore markers, for in-store display.
+ * ODESC_SPOIL treats the object as fully identified.
+ *
+ * Setting 'prefix' to TRUE prepends a 'the', 'a' or the number in the stack,
+ * respectively.
+ *
+ * \returns The number of bytes used of the buffer.
+ */
+size_t object_desc(char *buf, size_t max, const object_type *o_ptr, int mode)
+{
+	struct desc_cache_entry *entry;
+	size_t key[OBJECT_MEMO_KEYS];
+	bool hit;
+
+	/* Simple description for null item */
+	if (!o_ptr)
+		return strnfmt(buf, max, "(nothing)");
+
+	/* Too long to remember */
+	if (!max || max > DESC_CACHE_LEN)
+		return object_desc_build(buf, max, o_ptr, mode);
+
+	key[0] = mode;
+	key[1] = max;
+	key[2] = OPT(show_flavors);
+	key[3] = player && player->unignoring;
+	entry = (struct desc_cache_entry *)object_memo_find(desc_cache,
+		DESC_CACHE_SIZE, sizeof(*entry), o_ptr, key, &hit);
+
+	if (hit) {
+		my_strcpy(buf, entry->desc, max);
+		return entry->len;
+	}
+
+	entry->len = object_desc_build(buf, max, o_ptr, mode);
+	my_strcpy(entry->desc, buf, sizeof(entry->desc));
+	object_memo_fill(&entry->memo, o_ptr, key);
+
+	return entry->len;
+}
@@ -41,11 +41,34 @@ enum {
 };
 
 
+/**
+ * Number of values, besides the object itself, that a remembered result can
+ * depend on
+ */
+#define OBJECT_MEMO_KEYS 4
+
+/**
+ * The part of an entry in a cache of results worked out from an object which
+ * says what they were worked out from; see object_memo_find().
+ */
+struct object_memo {
+	u32b epoch;
+	const struct object *obj;
+	size_t key[OBJECT_MEMO_KEYS];
+	struct object copy;
+};
+
 extern const char *inscrip_text[];
 
 void object_base_name(char *buf, size_t max, int tval, bool plural);
 void object_kind_name(char *buf, size_t max, const object_kind *kind, bool easy_know);
 size_t obj_desc_name_format(char *buf, size_t max, size_t end, const char *fmt, const char *modstr, bool pluralise);
+void object_desc_invalidate(void);
+struct object_memo *object_memo_find(void *table, size_t size, size_t stride,
+									 const struct object *obj,
+									 const size_t *key, bool *hit);
+void object_memo_fill(struct object_memo *memo, const struct object *obj,
+					  const size_t *key);
 size_t object_desc(char *buf, size_t max, const object_type *o_ptr, int mode);
 
 #endif /* OBJECT_DESC_H */
@@ -86,6 +86,9 @@ int slot_by_type(struct player *p, int type, bool full)
 
 bool slot_type_is(int slot, int type)
 {
+	/* wield_slot() gives the slot count for things that can't be wielded */
+	if (slot < 0 || slot >= player->body.count) return FALSE;
+
 	return player->body.slots[slot].type == type ? TRUE : FALSE;
 }
 
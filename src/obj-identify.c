@@ -371,6 +371,7 @@ void object_flavor_aware(struct object *obj)
 
 	if (obj->kind->aware) return;
 	obj->kind->aware = TRUE;
+	object_desc_invalidate();
 
 	/* Charges or food value (pval) and effect now known */
 	id_on(obj->id_flags, ID_PVAL);
@@ -425,6 +426,7 @@ void object_flavor_tried(struct object *obj)
 	assert(obj->kind);
 
 	obj->kind->tried = TRUE;
+	object_desc_invalidate();
 }
 
 /**
@@ -132,6 +132,8 @@ void ignore_birth_init(void)
 {
 	int i, j;
 
+	object_desc_invalidate();
+
 	/* Reset ignore bits */
 	for (i = 0; i < z_info->k_max; i++)
 		k_info[i].ignore = FALSE;
@@ -262,6 +264,7 @@ void object_ignore_flavor_of(const struct object *obj)
 		obj->kind->ignore |= IGNORE_IF_AWARE;
 	else
 		obj->kind->ignore |= IGNORE_IF_UNAWARE;
+	object_desc_invalidate();
 }
 
 
@@ -476,6 +479,7 @@ void kind_ignore_clear(struct object_kind *kind)
 {
 	kind->ignore = 0;
 	player->upkeep->notice |= PN_IGNORE;
+	object_desc_invalidate();
 }
 
 void ego_ignore(struct object *obj)
@@ -483,6 +487,7 @@ void ego_ignore(struct object *obj)
 	assert(obj->ego);
 	ego_ignore_types[obj->ego->eidx][ignore_type_of(obj)] = TRUE;
 	player->upkeep->notice |= PN_IGNORE;
+	object_desc_invalidate();
 }
 
 void ego_ignore_clear(struct object *obj)
@@ -490,12 +495,14 @@ void ego_ignore_clear(struct object *obj)
 	assert(obj->ego);
 	ego_ignore_types[obj->ego->eidx][ignore_type_of(obj)] = FALSE;
 	player->upkeep->notice |= PN_IGNORE;
+	object_desc_invalidate();
 }
 
 void ego_ignore_toggle(int e_idx, int itype)
 {
 	ego_ignore_types[e_idx][itype] = !ego_ignore_types[e_idx][itype];
 	player->upkeep->notice |= PN_IGNORE;
+	object_desc_invalidate();
 }
 
 bool ego_is_ignored(int e_idx, int itype)
@@ -517,19 +524,21 @@ void kind_ignore_when_aware(struct object_kind *kind)
 {
 	kind->ignore |= IGNORE_IF_AWARE;
 	player->upkeep->notice |= PN_IGNORE;
+	object_desc_invalidate();
 }
 
 void kind_ignore_when_unaware(struct object_kind *kind)
 {
 	kind->ignore |= IGNORE_IF_UNAWARE;
 	player->upkeep->notice |= PN_IGNORE;
+	object_desc_invalidate();
 }
 
 
 /**
  * Determines if an object is already ignored.
  */
-bool object_is_ignored(const struct object *obj)
+static bool object_is_ignored_aux(const struct object *obj)
 {
 	byte type;
 
@@ -569,6 +578,38 @@ bool object_is_ignored(const struct object *obj)
 		return FALSE;
 }
 
+/**
+ * Recently reached verdicts, as the map asks after every object in view each
+ * time it is drawn.  They are kept like remembered descriptions (see
+ * object_memo_find()), and so are forgotten whenever the ignore settings or
+ * the player's knowledge of flavours change.
+ */
+#define IGNORE_CACHE_SIZE 64
+
+static struct ignore_cache_entry {
+	struct object_memo memo;
+	bool ignored;
+} ignore_cache[IGNORE_CACHE_SIZE];
+
+bool object_is_ignored(const struct object *obj)
+{
+	struct ignore_cache_entry *entry;
+	size_t key[OBJECT_MEMO_KEYS];
+	bool hit;
+
+	key[0] = obj->kind->aware;
+	key[1] = key[2] = key[3] = 0;
+	entry = (struct ignore_cache_entry *)object_memo_find(ignore_cache,
+		IGNORE_CACHE_SIZE, sizeof(*entry), obj, key, &hit);
+	if (hit)
+		return entry->ignored;
+
+	entry->ignored = object_is_ignored_aux(obj);
+	object_memo_fill(&entry->memo, obj, key);
+
+	return entry->ignored;
+}
+
 /**
  * Determines if an object is eligible for ignoring.
  */
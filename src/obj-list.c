@@ -153,6 +153,7 @@ static bool object_list_should_ignore_object(const object_type *object)
 void object_list_collect(object_list_t *list)
 {
 	int i, y, x;
+	struct cell_iter iter;
 
 	if (list == NULL || list->entries == NULL)
 		return;
@@ -160,56 +161,55 @@ void object_list_collect(object_list_t *list)
 	if (!object_list_needs_update(list))
 		return;
 
-	/* Scan each object in the dungeon. */
-	for (y = 1; y < cave->height; y++) {
-		for (x = 1; x < cave->width; x++) {
-			struct object *obj = square_object(cave, y, x);
-			for (obj = square_object(cave, y, x); obj; obj = obj->next) {
-				object_list_entry_t *entry = NULL;
-				int entry_index;
-				int current_distance;
-				int entry_distance;
-
-				if (object_list_should_ignore_object(obj))
-					continue;
-
-				/* Find or add a list entry. */
-				for (entry_index = 0; entry_index < (int)list->entries_size;
-					 entry_index++) {
-					if (list->entries[entry_index].object == NULL) {
-						/* We found an empty slot, so add this object here. */
-						list->entries[entry_index].object = obj;
-						list->entries[entry_index].count = 0;
-						list->entries[entry_index].dy = y - player->py;
-						list->entries[entry_index].dx = x - player->px;
-						entry = &list->entries[entry_index];
-						break;
-					} else if (!is_unknown(obj) && object_similar(obj, list->entries[entry_index].object, OSTACK_LIST)) {
-						/* We found a matching object and we'll use that. */
-						entry = &list->entries[entry_index];
-						break;
-					}
+	/* Scan each object in the dungeon, passing over empty parts of it. */
+	cell_iter_rect(&iter, cave, 1, 1, cave->height - 1, cave->width - 1);
+	while (cell_iter_next_object(&iter, &y, &x)) {
+		struct object *obj;
+		for (obj = square_object(cave, y, x); obj; obj = obj->next) {
+			object_list_entry_t *entry = NULL;
+			int entry_index;
+			int current_distance;
+			int entry_distance;
+
+			if (object_list_should_ignore_object(obj))
+				continue;
+
+			/* Find or add a list entry. */
+			for (entry_index = 0; entry_index < (int)list->entries_size;
+				 entry_index++) {
+				if (list->entries[entry_index].object == NULL) {
+					/* We found an empty slot, so add this object here. */
+					list->entries[entry_index].object = obj;
+					list->entries[entry_index].count = 0;
+					list->entries[entry_index].dy = y - player->py;
+					list->entries[entry_index].dx = x - player->px;
+					entry = &list->entries[entry_index];
+					break;
+				} else if (!is_unknown(obj) && object_similar(obj, list->entries[entry_index].object, OSTACK_LIST)) {
+					/* We found a matching object and we'll use that. */
+					entry = &list->entries[entry_index];
+					break;
 				}
+			}
 
-				if (entry == NULL)
-					return;
+			if (entry == NULL)
+				return;
 
-				/* We only know the number of objects we've actually seen */
-				if (obj->marked == MARK_SEEN)
-					entry->count += obj->number;
-				else
-					entry->count = 1;
+			/* We only know the number of objects we've actually seen */
+			if (obj->marked == MARK_SEEN)
+				entry->count += obj->number;
+			else
+				entry->count = 1;
 
-				/* Store the distance to the object in the stack that is
-				 * closest to the player. */
-				current_distance = (y - player->py) * (y - player->py) +
-					(x - player->px) * (x - player->px);
-				entry_distance = entry->dy * entry->dy + entry->dx * entry->dx;
+			/* Store the distance to the object in the stack that is
+			 * closest to the player. */
+			current_distance = (y - player->py) * (y - player->py) +
+				(x - player->px) * (x - player->px);
+			entry_distance = entry->dy * entry->dy + entry->dx * entry->dx;
 
-				if (current_distance < entry_distance) {
-					entry->dy = y - player->py;
-					entry->dx = x - player->px;
-				}
+			if (current_distance < entry_distance) {
+				entry->dy = y - player->py;
+				entry->dx = x - player->px;
 			}
 		}
 	}
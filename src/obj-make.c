@@ -29,16 +29,39 @@
 #include "obj-tval.h"
 #include "obj-util.h"
 
-/** Arrays holding an index of objects to generate for a given level */
-static u32b *obj_total;
-static byte *obj_alloc;
+/**
+ * Arrays holding running totals of the chances of generating each object
+ * kind (in index order) at a given level
+ */
+static u32b *obj_alloc;
+static u32b *obj_alloc_great;
 
-static u32b *obj_total_great;
-static byte *obj_alloc_great;
+/**
+ * Running totals like obj_alloc for only the kinds of one tval, made the
+ * first time an object of that tval is asked for
+ */
+struct tval_alloc {
+	int num;			/* Number of kinds of this tval */
+	s16b *kinds;		/* Their indexes, in order */
+	u32b *sums[2];		/* Running totals per level, ordinary and great */
+};
+
+static struct tval_alloc *obj_alloc_tval;
 
 static s16b alloc_ego_size = 0;
 static alloc_entry *alloc_ego_table;
 
+/**
+ * The entries of alloc_ego_table which can be applied to each object kind,
+ * in table order
+ */
+struct ego_alloc {
+	int num;
+	s16b *entries;
+};
+
+static struct ego_alloc *ego_alloc_kind;
+
 struct money {
 	char *name;
 	int type;
@@ -59,34 +82,28 @@ static void init_obj_make(void) {
 	/*** Initialize object allocation info ***/
 
 	/* Allocate and wipe */
-	obj_alloc = mem_zalloc((z_info->max_obj_depth + 1) * k_max * sizeof(byte));
-	obj_alloc_great = mem_zalloc((z_info->max_obj_depth + 1) * k_max * sizeof(byte));
-	obj_total = mem_zalloc((z_info->max_obj_depth + 1) * sizeof(u32b));
-	obj_total_great = mem_zalloc((z_info->max_obj_depth + 1) * sizeof(u32b));
+	obj_alloc = mem_zalloc((z_info->max_obj_depth + 1) * k_max * sizeof(u32b));
+	obj_alloc_great = mem_zalloc((z_info->max_obj_depth + 1) * k_max * sizeof(u32b));
+	obj_alloc_tval = mem_zalloc(TV_MAX * sizeof(struct tval_alloc));
 
 	/* Init allocation data */
-	for (item = 1; item < k_max; item++) {
-		const struct object_kind *kind = &k_info[item];
-
-		int min = kind->alloc_min;
-		int max = kind->alloc_max;
-
-		/* If an item doesn't have a rarity, move on */
-		if (!kind->alloc_prob) continue;
+	for (lev = 0; lev <= z_info->max_obj_depth; lev++) {
+		u32b total = 0, total_great = 0;
 
-		/* Go through all the dungeon levels */
-		for (lev = 0; lev <= z_info->max_obj_depth; lev++) {
+		for (item = 1; item < k_max; item++) {
+			const struct object_kind *kind = &k_info[item];
 			int rarity = kind->alloc_prob;
 
-			/* Save the probability in the standard table */
-			if ((lev < min) || (lev > max)) rarity = 0;
-			obj_total[lev] += rarity;
-			obj_alloc[(lev * k_max) + item] = rarity;
+			/* Add the probability to the standard table */
+			if ((lev < kind->alloc_min) || (lev > kind->alloc_max))
+				rarity = 0;
+			total += rarity;
+			obj_alloc[(lev * k_max) + item] = total;
 
-			/* Save the probability in the "great" table if relevant */
+			/* Add it to the "great" table if relevant */
 			if (!kind_is_good(kind)) rarity = 0;
-			obj_total_great[lev] += rarity;
-			obj_alloc_great[(lev * k_max) + item] = rarity;
+			total_great += rarity;
+			obj_alloc_great[(lev * k_max) + item] = total_great;
 		}
 	}
 
@@ -155,6 +172,25 @@ static void init_obj_make(void) {
 	mem_free(aux);
 	mem_free(num);
 
+	/* List the egos each kind can have */
+	ego_alloc_kind = mem_zalloc(k_max * sizeof(struct ego_alloc));
+	for (i = 0; i < alloc_ego_size; i++) {
+		struct ego_poss_item *poss;
+
+		e_ptr = &e_info[table[i].index];
+
+		/* XXX Ignore cursed items for now */
+		if (cursed_p(e_ptr->flags)) continue;
+
+		for (poss = e_ptr->poss_items; poss; poss = poss->next) {
+			struct ego_alloc *alloc = &ego_alloc_kind[poss->kidx];
+			if (alloc->num && alloc->entries[alloc->num - 1] == i) continue;
+			if (!alloc->entries)
+				alloc->entries = mem_zalloc(alloc_ego_size * sizeof(s16b));
+			alloc->entries[alloc->num++] = i;
+		}
+	}
+
 	/*** Initialize money info ***/
 
 	/* Count the money types and make a list */
@@ -178,9 +214,16 @@ static void cleanup_obj_make(void) {
 		string_free(money_type[i].name);
 	}
 	mem_free(money_type);
+	for (i = 0; i < z_info->k_max; i++)
+		mem_free(ego_alloc_kind[i].entries);
+	mem_free(ego_alloc_kind);
 	mem_free(alloc_ego_table);
-	mem_free(obj_total_great);
-	mem_free(obj_total);
+	for (i = 0; i < TV_MAX; i++) {
+		mem_free(obj_alloc_tval[i].kinds);
+		mem_free(obj_alloc_tval[i].sums[0]);
+		mem_free(obj_alloc_tval[i].sums[1]);
+	}
+	mem_free(obj_alloc_tval);
 	mem_free(obj_alloc_great);
 	mem_free(obj_alloc);
 }
@@ -243,6 +286,8 @@ static int random_high_resist(struct object *o_ptr, int *resist)
 
 /**
  * Select an ego-item that fits the object's tval and sval.
+ *
+ * Only the egos listed for the object's kind at startup are looked at.
  */
 static struct ego_item *ego_find_random(struct object *o_ptr, int level)
 {
@@ -250,19 +295,21 @@ static struct ego_item *ego_find_random(struct object *o_ptr, int level)
 	long total = 0L;
 
 	alloc_entry *table = alloc_ego_table;
+	struct ego_alloc *alloc = &ego_alloc_kind[o_ptr->kind->kidx];
 	struct ego_item *ego;
-	struct ego_poss_item *poss;
 
-	/* Go through all possible ego items and find ones which fit this item */
-	for (i = 0; i < alloc_ego_size; i++) {
+	/* Go through the ego items which fit this item */
+	for (i = 0; i < alloc->num; i++) {
+		alloc_entry *entry = &table[alloc->entries[i]];
+
 		/* Reset any previous probability of this type being picked */
-		table[i].prob3 = 0;
+		entry->prob3 = 0;
 
-		if (level < table[i].level)
+		if (level < entry->level)
 			continue;
 
 		/* Access the ego item */
-		ego = &e_info[table[i].index];
+		ego = &e_info[entry->index];
         
         /* enforce maximum */
         if (level > ego->alloc_max) continue;
@@ -273,30 +320,23 @@ static struct ego_item *ego_find_random(struct object *o_ptr, int level)
             if (!one_in_(ood_chance)) continue;
         }
 
-		/* XXX Ignore cursed items for now */
-		if (cursed_p(ego->flags)) continue;
-
-		for (poss = ego->poss_items; poss; poss = poss->next)
-			if (poss->kidx == o_ptr->kind->kidx) {
-				table[i].prob3 = table[i].prob2;
-				break;
-			}
+		entry->prob3 = entry->prob2;
 
 		/* Total */
-		total += table[i].prob3;
+		total += entry->prob3;
 	}
 
 	if (total) {
 		long value = randint0(total);
-		for (i = 0; i < alloc_ego_size; i++) {
+		for (i = 0; i < alloc->num; i++) {
+			alloc_entry *entry = &table[alloc->entries[i]];
+
 			/* Found the entry */
-			if (value < table[i].prob3) break;
+			if (value < entry->prob3) return &e_info[entry->index];
 
 			/* Decrement */
-			value = value - table[i].prob3;
+			value = value - entry->prob3;
 		}
-
-		return &e_info[table[i].index];
 	}
 
 	return NULL;
@@ -937,39 +977,80 @@ bool kind_is_good(const object_kind *kind)
 }
 
 
+/**
+ * Find the first of n running totals which is more than value, or n if
+ * there is none
+ */
+static int obj_alloc_find(const u32b *sums, int n, u32b value)
+{
+	int low = 0, high = n;
+
+	while (low < high) {
+		int mid = (low + high) / 2;
+		if (sums[mid] > value)
+			high = mid;
+		else
+			low = mid + 1;
+	}
+
+	return low;
+}
+
+/**
+ * Make the running totals for the kinds of a given tval
+ */
+static void obj_alloc_tval_make(struct tval_alloc *alloc, int tval)
+{
+	int k_max = z_info->k_max;
+	int item, lev, i, g;
+
+	alloc->kinds = mem_zalloc(k_max * sizeof(s16b));
+	for (item = 1; item < k_max; item++)
+		if (k_info[item].tval == tval)
+			alloc->kinds[alloc->num++] = item;
+
+	for (g = 0; g < 2; g++) {
+		u32b *objects = g ? obj_alloc_great : obj_alloc;
+
+		alloc->sums[g] = mem_zalloc((z_info->max_obj_depth + 1) *
+									MAX(alloc->num, 1) * sizeof(u32b));
+		for (lev = 0; lev <= z_info->max_obj_depth; lev++) {
+			u32b *level_sums = objects + lev * k_max;
+			u32b total = 0;
+
+			for (i = 0; i < alloc->num; i++) {
+				item = alloc->kinds[i];
+				total += level_sums[item] - level_sums[item - 1];
+				alloc->sums[g][lev * alloc->num + i] = total;
+			}
+		}
+	}
+}
+
 /**
  * Choose an object kind of a given tval given a dungeon level.
  */
 static struct object_kind *get_obj_num_by_kind(int level, bool good, int tval)
 {
-	/* This is the base index into obj_alloc for this dlev */
-	size_t ind, item;
+	struct tval_alloc *alloc = &obj_alloc_tval[tval];
+	u32b *sums;
 	u32b value;
-	int total = 0;
-	byte *objects = good ? obj_alloc_great : obj_alloc;
-
-	/* Pick an object */
-	ind = level * z_info->k_max;
+	int i;
 
-	/* Get new total */
-	for (item = 1; item < z_info->k_max; item++)
-		if (objkind_byid(item)->tval == tval)
-			total += objects[ind + item];
+	/* Work out this tval's chances the first time they are wanted */
+	if (!alloc->kinds)
+		obj_alloc_tval_make(alloc, tval);
 
 	/* No appropriate items of that tval */
-	if (!total) return NULL;
+	if (!alloc->num) return NULL;
+	sums = alloc->sums[good ? 1 : 0] + level * alloc->num;
+	if (!sums[alloc->num - 1]) return NULL;
 	
-	value = randint0(total);
-	
-	for (item = 1; item < z_info->k_max; item++)
-		if (objkind_byid(item)->tval == tval) {
-			if (value < objects[ind + item]) break;
-
-			value -= objects[ind + item];
-		}
+	value = randint0(sums[alloc->num - 1]);
+	i = obj_alloc_find(sums, alloc->num, value);
 
 	/* Return the item index */
-	return objkind_byid(item);
+	return objkind_byid(alloc->kinds[i]);
 }
 
 /**
@@ -979,8 +1060,8 @@ static struct object_kind *get_obj_num_by_kind(int level, bool good, int tval)
  */
 struct object_kind *get_obj_num(int level, bool good, int tval)
 {
-	/* This is the base index into obj_alloc for this dlev */
-	size_t ind, item;
+	/* These are the running totals for this dlev */
+	u32b *sums;
 	u32b value;
 
 	/* Occasional level boost */
@@ -992,41 +1073,22 @@ struct object_kind *get_obj_num(int level, bool good, int tval)
 	level = MIN(level, z_info->max_obj_depth);
 	level = MAX(level, 0);
 
-	/* Pick an object */
-	ind = level * z_info->k_max;
-	
 	if (tval)
 		return get_obj_num_by_kind(level, good, tval);
-	
-	if (!good) {
-		value = randint0(obj_total[level]);
-		for (item = 1; item < z_info->k_max; item++) {
-			/* Found it */
-			if (value < obj_alloc[ind + item]) break;
 
-			/* Decrement */
-			value -= obj_alloc[ind + item];
-		}
-	} else {
-		value = randint0(obj_total_great[level]);
-		for (item = 1; item < z_info->k_max; item++) {
-			/* Found it */
-			if (value < obj_alloc_great[ind + item]) break;
-
-			/* Decrement */
-			value -= obj_alloc_great[ind + item];
-		}
-	}
+	/* Pick an object */
+	sums = (good ? obj_alloc_great : obj_alloc) + level * z_info->k_max;
+	value = randint0(sums[z_info->k_max - 1]);
 
 	/* Return the item index */
-	return objkind_byid(item);
+	return objkind_byid(obj_alloc_find(sums, z_info->k_max, value));
 }
 
 
 /**
  * Attempt to make an object
  *
- * \param c is the current dungeon level.
+ * \param c is the current dungeon level, which may be NULL if value is.
  * \param lev is the creation level of the object (not necessarily == depth).
  * \param good is whether the object is to be good
  * \param great is whether the object is to be great
@@ -1081,9 +1143,8 @@ struct object *make_object(struct chunk *c, int lev, bool good, bool great,
 
 	/* This seems to imply objects get less value from being > 1 but < 5
 	 * levels out of depth - should it be *value +=... - NRM */
-	if (!cursed_p(new_obj->flags) && (kind->alloc_min > c->depth)) {
-		if (value) *value = (kind->alloc_min - c->depth) * (*value / 5);
-	}
+	if (value && !cursed_p(new_obj->flags) && (kind->alloc_min > c->depth))
+		*value = (kind->alloc_min - c->depth) * (*value / 5);
 
 	return new_obj;
 }
@@ -48,6 +48,10 @@
 /**
  * Check the integrity of a linked - make sure it's not circular and that each
  * entry in the chain has consistent next and prev pointers.
+ *
+ * The prev<->next check alone rules out circularity: the first object to be
+ * met twice would need two different prev pointers (or, for the top of the
+ * pile, a non-NULL one), so this is linear in the size of the pile.
  */
 void pile_check_integrity(const char *op, struct object *pile, struct object *hilight)
 {
@@ -72,14 +76,6 @@ void pile_check_integrity(const char *op, struct object *pile, struct object *hi
 		prev = obj;
 		obj = obj->next;
 	};
-
-	/* Check for circularity */
-	for (obj = pile; obj; obj = obj->next) {
-		struct object *check;
-		for (check = obj->next; check; check = check->next) {
-			assert(check->next != obj);
-		}
-	}
 }
 
 /**
@@ -192,12 +188,47 @@ bool pile_contains(const struct object *top, const struct object *obj)
 	return FALSE;
 }
 
+/**
+ * Objects are handed out from slabs of OBJECT_SLAB at a time, and deleted
+ * ones are kept on a free list to be handed out again.  Objects move freely
+ * between chunks, monsters, stores and the player, so the slabs belong to
+ * none of them, and are only freed by object_pool_free() at shutdown.
+ */
+#define OBJECT_SLAB 256
+
+struct object_slab {
+	struct object_slab *next;
+	struct object objects[OBJECT_SLAB];
+};
+
+static struct object_slab *object_slabs;
+static struct object *object_free_list;
+
 /**
  * Create a new object and return it
  */
 struct object *object_new(void)
 {
-	return mem_zalloc(sizeof(struct object));
+	struct object *obj;
+
+	/* Get another slab if there are no free objects */
+	if (!object_free_list) {
+		struct object_slab *slab = mem_alloc(sizeof(*slab));
+		int i;
+
+		slab->next = object_slabs;
+		object_slabs = slab;
+		for (i = OBJECT_SLAB - 1; i >= 0; i--) {
+			slab->objects[i].next = object_free_list;
+			object_free_list = &slab->objects[i];
+		}
+	}
+
+	obj = object_free_list;
+	object_free_list = obj->next;
+	memset(obj, 0, sizeof(*obj));
+
+	return obj;
 }
 
 /**
@@ -233,7 +264,22 @@ void object_delete(struct object *obj)
 	if (player && player->upkeep && obj == player->upkeep->object)
 		player->upkeep->object = NULL;
 
-	mem_free(obj);
+	/* Keep it for reuse */
+	obj->next = object_free_list;
+	object_free_list = obj;
+}
+
+/**
+ * Free the memory of all objects, which must no longer be in use
+ */
+void object_pool_free(void)
+{
+	while (object_slabs) {
+		struct object_slab *next = object_slabs->next;
+		mem_free(object_slabs);
+		object_slabs = next;
+	}
+	object_free_list = NULL;
 }
 
 /**
@@ -271,6 +317,12 @@ bool object_stackable(const struct object *o_ptr, const struct object *j_ptr,
 {
 	int i;
 
+	/* Hack -- identical items cannot be stacked */
+	if (o_ptr == j_ptr) return FALSE;
+
+	/* Require identical object kinds, the cheapest way to tell most apart */
+	if (o_ptr->kind != j_ptr->kind) return FALSE;
+
 	/* Equipment items don't stack */
 	if (object_is_equipped(player->body, o_ptr))
 		return FALSE;
@@ -281,12 +333,6 @@ bool object_stackable(const struct object *o_ptr, const struct object *j_ptr,
 	if (mode & OSTACK_LIST && o_ptr->marked == MARK_AWARE) return FALSE;
 	if (mode & OSTACK_LIST && j_ptr->marked == MARK_AWARE) return FALSE;
 
-	/* Hack -- identical items cannot be stacked */
-	if (o_ptr == j_ptr) return FALSE;
-
-	/* Require identical object kinds */
-	if (o_ptr->kind != j_ptr->kind) return FALSE;
-
 	/* Different flags don't stack */
 	if (!of_is_equal(o_ptr->flags, j_ptr->flags)) return FALSE;
 
@@ -625,7 +671,7 @@ static struct object *floor_get_oldest_ignored(int y, int x)
 bool floor_carry(struct chunk *c, int y, int x, struct object *drop, bool last)
 {
 	int n = 0;
-	struct object *obj;
+	struct object *obj, *end = NULL;
 
 	/* Scan objects in that grid for combination */
 	for (obj = square_object(c, y, x); obj; obj = obj->next) {
@@ -633,13 +679,16 @@ bool floor_carry(struct chunk *c, int y, int x, struct object *drop, bool last)
 		if (object_similar(obj, drop, OSTACK_FLOOR)) {
 			/* Combine the items */
 			object_absorb(obj, drop);
+			if (tval_can_have_timeout(obj) && obj->timeout)
+				cave_object_charging(c, y, x);
 
 			/* Result */
 			return TRUE;
 		}
 
-		/* Count objects */
+		/* Count objects, remembering the last */
 		n++;
+		end = obj;
 	}
 
 	/* Option -- disallow stacking */
@@ -651,6 +700,8 @@ bool floor_carry(struct chunk *c, int y, int x, struct object *drop, bool last)
 		struct object *ignore = floor_get_oldest_ignored(y, x);
 
 		if (ignore) {
+			if (ignore == end)
+				end = ignore->prev;
 			square_excise_object(c, y, x, ignore);
 			object_delete(ignore);
 		} else
@@ -665,10 +716,20 @@ bool floor_carry(struct chunk *c, int y, int x, struct object *drop, bool last)
 	drop->held_m_idx = 0;
 
 	/* Link to the first or last object in the pile */
-	if (last)
+	if (!c->squares[y][x].obj)
+		cave_object_cell(c, y, x, TRUE);
+	if (last && end) {
+		/* Already found the end of the pile */
+		assert(drop->prev == NULL);
+		end->next = drop;
+		drop->prev = end;
+		pile_check_integrity("insert_end", c->squares[y][x].obj, drop);
+	} else if (last)
 		pile_insert_end(&c->squares[y][x].obj, drop);
 	else
 		pile_insert(&c->squares[y][x].obj, drop);
+	if (tval_can_have_timeout(drop) && drop->timeout)
+		cave_object_charging(c, y, x);
 
 	/* Redraw */
 	square_note_spot(c, y, x);
@@ -904,6 +965,8 @@ void push_object(int y, int x)
 	}
 
 	/* Disassociate the objects from the square */
+	if (cave->squares[y][x].obj)
+		cave_object_cell(cave, y, x, FALSE);
 	cave->squares[y][x].obj = NULL;
 
 	/* Set feature to an open door */
@@ -36,6 +36,7 @@ typedef enum
 struct object *object_new(void);
 void object_delete(struct object *obj);
 void object_pile_free(struct object *obj);
+void object_pool_free(void);
 
 void pile_insert(struct object **pile, struct object *obj);
 void pile_insert_end(struct object **pile, struct object *obj);
@@ -17,6 +17,7 @@
  *    are included in all such copies.  Other copyrights may also apply.
  */
 #include "angband.h"
+#include "obj-desc.h"
 #include "obj-gear.h"
 #include "obj-identify.h"
 #include "obj-power.h"
@@ -131,11 +132,18 @@ static s16b ability_power[25] =
 ang_file *object_log;
 
 /**
- * Log progress info to the object log
+ * Log progress info to the object log; the message is only formatted if
+ * there is a log to write it to
  */
-void log_obj(char *message)
+void log_obj(const char *fmt, ...)
 {
-	file_putf(object_log, message);
+	va_list vp;
+
+	if (!object_log) return;
+
+	va_start(vp, fmt);
+	file_vputf(object_log, fmt, vp);
+	va_end(vp);
 }
 
 /**
@@ -150,7 +158,7 @@ static int bow_multiplier(const object_type *obj)
 	else
 		mult = obj->pval;
 
-	log_obj(format("Base mult for this weapon is %d\n", mult));
+	log_obj("Base mult for this weapon is %d\n", mult);
 	return mult;
 }
 
@@ -162,7 +170,7 @@ static int to_damage_power(const object_type *obj)
 	int p;
 
 	p = (obj->to_d * DAMAGE_POWER / 2);
-	if (p) log_obj(format("%d power from to_dam\n", p));
+	if (p) log_obj("%d power from to_dam\n", p);
 
 	/* Add second lot of damage power for non-weapons */
 	if ((wield_slot(obj) != slot_by_name(player, "shooting")) &&
@@ -171,7 +179,7 @@ static int to_damage_power(const object_type *obj)
 		int q = (obj->to_d * DAMAGE_POWER);
 		p += q;
 		if (q)
-			log_obj(format("Add %d from non-weapon to_dam, total %d\n", q, p));
+			log_obj("Add %d from non-weapon to_dam, total %d\n", q, p);
 	}
 	return p;
 }
@@ -186,7 +194,7 @@ static int damage_dice_power(const object_type *obj)
 	/* Add damage from dice for any wieldable weapon or ammo */
 	if (tval_is_melee_weapon(obj) || tval_is_ammo(obj)) {
 		dice = (obj->dd * (obj->ds + 1) * DAMAGE_POWER / 4);
-		log_obj(format("Add %d power for damage dice, ", dice));
+		log_obj("Add %d power for damage dice, ", dice);
 	} else if (wield_slot(obj) != slot_by_name(player, "shooting")) {
 		/* Add power boost for nonweapons with combat flags */
 		if (obj->brands || obj->slays ||
@@ -194,8 +202,8 @@ static int damage_dice_power(const object_type *obj)
 			(obj->modifiers[OBJ_MOD_SHOTS] > 0) ||
 			(obj->modifiers[OBJ_MOD_MIGHT] > 0)) {
 			dice = (WEAP_DAMAGE * DAMAGE_POWER);
-			log_obj(format("Add %d power for non-weapon combat bonuses, ",
-						   dice));
+			log_obj("Add %d power for non-weapon combat bonuses, ",
+					dice);
 		}
 	}
 	return dice;
@@ -219,8 +227,8 @@ static int ammo_damage_power(const object_type *obj, int p)
 
 		if (launcher != -1) {
 			q = (archery[launcher].ammo_dam * DAMAGE_POWER / 2);
-			log_obj(format("Adding %d power from ammo, total is %d\n", q,
-						   p + q));
+			log_obj("Adding %d power from ammo, total is %d\n", q,
+					p + q);
 		}
 	}
 	return q;
@@ -239,8 +247,8 @@ static int launcher_ammo_damage_power(const object_type *obj, int p)
 		if (obj->ego)
 			p += (archery[ammo_type].launch_dam * DAMAGE_POWER / 2);
 		p = p * archery[ammo_type].launch_mult / (2 * MAX_BLOWS);
-		log_obj(format("After multiplying ammo and rescaling, power is %d\n",
-					   p));
+		log_obj("After multiplying ammo and rescaling, power is %d\n",
+				p);
 	}
 	return p;
 }
@@ -265,8 +273,8 @@ static int extra_blows_power(const object_type *obj, int p, bool known)
 			/* Add boost for assumed off-weapon damage */
 			p += (NONWEAP_DAMAGE * obj->modifiers[OBJ_MOD_BLOWS]
 				  * DAMAGE_POWER / 2);
-			log_obj(format("Add %d power for extra blows, total is %d\n", 
-								p - q, p));
+			log_obj("Add %d power for extra blows, total is %d\n", 
+						 p - q, p);
 		}
 	}
 	return p;
@@ -288,7 +296,7 @@ static int extra_shots_power(const object_type *obj, int p, bool known)
 		} else if (obj->modifiers[OBJ_MOD_SHOTS] > 0) {
 			int q = obj->modifiers[OBJ_MOD_SHOTS];
 			p = p * (1 + q);
-			log_obj(format("Multiplying power by %d for extra shots, total is %d\n", 1 + q, p));
+			log_obj("Multiplying power by %d for extra shots, total is %d\n", 1 + q, p);
 		}
 	}
 	return p;
@@ -309,10 +317,10 @@ static int extra_might_power(const object_type *obj, int p, int mult,
 		} else {
 			mult += obj->modifiers[OBJ_MOD_MIGHT];
 		}
-		log_obj(format("Mult after extra might is %d\n", mult));
+		log_obj("Mult after extra might is %d\n", mult);
 	}
 	p *= mult;
-	log_obj(format("After multiplying power for might, total is %d\n", p));
+	log_obj("After multiplying power for might, total is %d\n", p);
 	return p;
 }
 
@@ -324,7 +332,6 @@ static s32b slay_power(const object_type *obj, int p, int verbose,
 {
 	u32b sv = 0;
 	int i, q, num_brands = 0, num_slays = 0, num_kills = 0;
-	int mult;
 	int tot_mon_power = 0;
 	struct brand *brands = obj->brands;
 	struct slay *slays = obj->slays;
@@ -349,8 +356,12 @@ static s32b slay_power(const object_type *obj, int p, int verbose,
 	if ((num_slays + num_brands + num_kills) == 0)
 		return p;
 
+	/* The total is needed to scale the value, cached or not */
+	for (i = 0; i < z_info->r_max; i++)
+		tot_mon_power += r_info[i].scaled_power;
+
 	/* Look in the cache to see if we know this one yet */
-	sv = check_slay_cache(obj);
+	sv = check_slay_cache(obj, known);
 
 	/* If it's cached (or there are no slays), return the value */
 	if (sv)	{
@@ -362,28 +373,7 @@ static s32b slay_power(const object_type *obj, int p, int verbose,
 		 * for this combination (multiplied by the total number of
 		 * monsters, which we'll divide out later).
 		 */
-		for (i = 0; i < z_info->r_max; i++)	{
-			monster_type *mon = mem_zalloc(sizeof(*mon));
-			const struct brand *b = NULL;
-			const struct slay *s = NULL;
-			char verb[20];
-
-			mult = 1;
-			mon->race = &r_info[i];
-
-			/* Find the best multiplier against this monster */
-			improve_attack_modifier((object_type *)obj, mon, &b, &s, 
-									verb, FALSE, FALSE, !known);
-			if (s)
-				mult = s->multiplier;
-			else if (b)
-				mult = b->multiplier;
-
-			/* Add up totals */
-			tot_mon_power += mon->race->scaled_power;
-			sv += mult * mon->race->scaled_power;
-			mem_free(mon);
-		}
+		sv = slay_race_power(obj, known);
 
 		/*
 		 * To get the expected damage for this weapon, multiply the
@@ -401,54 +391,54 @@ static s32b slay_power(const object_type *obj, int p, int verbose,
 			slays = slay_collect(obj, NULL, !known);
 
 			for (b = brands; b; b = b->next) {
-				log_obj(format("%sx%d ", b->name, b->multiplier));
+				log_obj("%sx%d ", b->name, b->multiplier);
 			}
 			for (s = slays; s; s = s->next) {
-				log_obj(format("%sx%d ", s->name, s->multiplier));
+				log_obj("%sx%d ", s->name, s->multiplier);
 			}
-			log_obj(format("\nsv is: %d\n", sv));
-			log_obj(format(" and t_m_p is: %d \n", tot_mon_power));
-			log_obj(format("times 1000 is: %d\n", (1000 * sv) / tot_mon_power));
+			log_obj("\nsv is: %d\n", sv);
+			log_obj(" and t_m_p is: %d \n", tot_mon_power);
+			log_obj("times 1000 is: %d\n", (1000 * sv) / tot_mon_power);
 			free_brand(brands);
 			free_slay(slays);
 		}
 
 		/* Add to the cache */
-		if (fill_slay_cache(obj, sv))
+		if (fill_slay_cache(obj, known, sv))
 			log_obj("Added to slay cache\n");
 	}
 
 	q = (dice_pwr * (sv / 100)) / (tot_mon_power / 100);
 	p += q;
-	log_obj(format("Add %d for slay power, total is %d\n", q, p));
+	log_obj("Add %d for slay power, total is %d\n", q, p);
 
 	/* Bonuses for multiple brands and slays */
 	if (num_slays > 1) {
 		q = (num_slays * num_slays * dice_pwr) / (DAMAGE_POWER * 5);
 		p += q;
-		log_obj(format("Add %d power for multiple slays, total is %d\n", q, p));
+		log_obj("Add %d power for multiple slays, total is %d\n", q, p);
 	}
 	if (num_brands > 1) {
 		q = (2 * num_brands * num_brands * dice_pwr) / (DAMAGE_POWER * 5);
 		p += q;
-		log_obj(format("Add %d power for multiple brands, total is %d\n",q, p));
+		log_obj("Add %d power for multiple brands, total is %d\n",q, p);
 	}
 	if (num_kills > 1) {
 		q = (3 * num_kills * num_kills * dice_pwr) / (DAMAGE_POWER * 5);
 		p += q;
-		log_obj(format("Add %d power for multiple kills, total is %d\n", q, p));
+		log_obj("Add %d power for multiple kills, total is %d\n", q, p);
 	}
 	if (num_slays == 8) {
 		p += 10;
-		log_obj(format("Add 10 power for full set of slays, total is %d\n", p));
+		log_obj("Add 10 power for full set of slays, total is %d\n", p);
 	}
 	if (num_brands == 5) {
 		p += 20;
-		log_obj(format("Add 20 power for full set of brands, total is %d\n",p));
+		log_obj("Add 20 power for full set of brands, total is %d\n",p);
 	}
 	if (num_kills == 3) {
 		p += 20;
-		log_obj(format("Add 20 power for full set of kills, total is %d\n", p));
+		log_obj("Add 20 power for full set of kills, total is %d\n", p);
 	}
 
 	return p;
@@ -462,7 +452,7 @@ static int rescale_bow_power(const object_type *obj, int p)
 {
 	if (wield_slot(obj) == slot_by_name(player, "shooting")) {
 		p /= MAX_BLOWS;
-		log_obj(format("Rescaling bow power, total is %d\n", p));
+		log_obj("Rescaling bow power, total is %d\n", p);
 	}
 	return p;
 }
@@ -475,7 +465,7 @@ static int to_hit_power(const object_type *obj, int p)
 	int q = (obj->to_h * TO_HIT_POWER / 2);
 	p += q;
 	if (p) 
-		log_obj(format("Add %d power for to hit, total is %d\n", q, p));
+		log_obj("Add %d power for to hit, total is %d\n", q, p);
 	return p;
 }
 
@@ -489,7 +479,7 @@ static int ac_power(const object_type *obj, int p)
 	if (obj->ac) {
 		p += BASE_ARMOUR_POWER;
 		q += (obj->ac * BASE_AC_POWER / 2);
-		log_obj(format("Adding %d power for base AC value\n", q));
+		log_obj("Adding %d power for base AC value\n", q);
 
 		/* Add power for AC per unit weight */
 		if (obj->weight > 0) {
@@ -505,7 +495,7 @@ static int ac_power(const object_type *obj, int p)
 		} else
 			q *= 5;
 		p += q;
-		log_obj(format("Add %d power for AC per unit weight, now %d\n",	q, p));
+		log_obj("Add %d power for AC per unit weight, now %d\n",	q, p);
 	}
 	return p;
 }
@@ -522,18 +512,18 @@ static int to_ac_power(const object_type *obj, int p)
 
 	q = (obj->to_a * TO_AC_POWER / 2);
 	p += q;
-	log_obj(format("Add %d power for to_ac of %d, total is %d\n", 
-				   q, obj->to_a, p));
+	log_obj("Add %d power for to_ac of %d, total is %d\n", 
+			q, obj->to_a, p);
 	if (obj->to_a > HIGH_TO_AC) {
 		q = ((obj->to_a - (HIGH_TO_AC - 1)) * TO_AC_POWER);
 		p += q;
-		log_obj(format("Add %d power for high to_ac, total is %d\n",
-							q, p));
+		log_obj("Add %d power for high to_ac, total is %d\n",
+					 q, p);
 	}
 	if (obj->to_a > VERYHIGH_TO_AC) {
 		q = ((obj->to_a - (VERYHIGH_TO_AC -1)) * TO_AC_POWER * 2);
 		p += q;
-		log_obj(format("Add %d power for very high to_ac, total is %d\n",q, p));
+		log_obj("Add %d power for very high to_ac, total is %d\n",q, p);
 	}
 	if (obj->to_a >= INHIBIT_AC) {
 		p += INHIBIT_POWER;
@@ -549,8 +539,8 @@ static int jewelry_power(const object_type *obj, int p)
 {
 	if (tval_is_jewelry(obj)) {
 		p += BASE_JEWELRY_POWER;
-		log_obj(format("Adding %d power for jewelry, total is %d\n", 
-					   BASE_JEWELRY_POWER, p));
+		log_obj("Adding %d power for jewelry, total is %d\n", 
+				BASE_JEWELRY_POWER, p);
 	}
 	return p;
 }
@@ -572,22 +562,22 @@ static int modifier_power(const object_type *obj, int p, bool known)
 		if (mod_power(i)) {
 			q = (k * mod_power(i) * mod_slot_mult(i, wield_slot(obj)));
 			p += q;
-			if (q) log_obj(format("Add %d power for %d %s, total is %d\n", 
-								  q, k, mod_name(i), p));
+			if (q) log_obj("Add %d power for %d %s, total is %d\n", 
+						   q, k, mod_name(i), p);
 		}
 	}
 
 	/* Add extra power term if there are a lot of ability bonuses */
 	if (extra_stat_bonus > 249) {
-		log_obj(format("Inhibiting - Total ability bonus of %d is too high\n", 
-					   extra_stat_bonus));
+		log_obj("Inhibiting - Total ability bonus of %d is too high\n", 
+				extra_stat_bonus);
 		p += INHIBIT_POWER;
 	} else if (extra_stat_bonus > 0) {
 		q = ability_power[extra_stat_bonus / 10];
 		if (!q) return p;
 		p += q;
-		log_obj(format("Add %d power for modifier total of %d, total is %d\n", 
-					   q, extra_stat_bonus, p));
+		log_obj("Add %d power for modifier total of %d, total is %d\n", 
+				q, extra_stat_bonus, p);
 	}
 	return p;
 }
@@ -621,8 +611,8 @@ static int flags_power(const object_type *obj, int p, int verbose,
 		if (flag_power(i)) {
 			q = (flag_power(i) * flag_slot_mult(i, wield_slot(obj)));
 			p += q;
-			log_obj(format("Add %d power for %s, total is %d\n", 
-						   q, flag_name(i), p));
+			log_obj("Add %d power for %s, total is %d\n", 
+					q, flag_name(i), p);
 		}
 
 		/* Track combinations of flag types */
@@ -636,16 +626,16 @@ static int flags_power(const object_type *obj, int p, int verbose,
 		if (flag_sets[i].count > 1) {
 			q = (flag_sets[i].factor * flag_sets[i].count * flag_sets[i].count);
 			p += q;
-			log_obj(format("Add %d power for multiple %s, total is %d\n",
-						   q, flag_sets[i].desc, p));
+			log_obj("Add %d power for multiple %s, total is %d\n",
+					q, flag_sets[i].desc, p);
 		}
 
 		/* Add bonus if item has a full set of these flags */
 		if (flag_sets[i].count == flag_sets[i].size) {
 			q = flag_sets[i].bonus;
 			p += q;
-			log_obj(format("Add %d power for full set of %s, total is %d\n", 
-						   q, flag_sets[i].desc, p));
+			log_obj("Add %d power for full set of %s, total is %d\n", 
+					q, flag_sets[i].desc, p);
 		}
 	}
 
@@ -672,8 +662,8 @@ static int element_power(const object_type *obj, int p, bool known)
 			if (el_powers[i].ignore_power != 0) {
 				q = (el_powers[i].ignore_power);
 				p += q;
-				log_obj(format("Add %d power for ignoring %s, total is %d\n",
-							   q, el_powers[i].name, p));
+				log_obj("Add %d power for ignoring %s, total is %d\n",
+						q, el_powers[i].name, p);
 			}
 		}
 
@@ -681,20 +671,20 @@ static int element_power(const object_type *obj, int p, bool known)
 			if (el_powers[i].vuln_power != 0) {
 				q = (el_powers[i].vuln_power);
 				p += q;
-				log_obj(format("Add %d power for vulnerability to %s, total is %d\n", q, el_powers[i].name, p));
+				log_obj("Add %d power for vulnerability to %s, total is %d\n", q, el_powers[i].name, p);
 			}
 		} else if (obj->el_info[i].res_level == 1) {
 			if (el_powers[i].res_power != 0) {
 				q = (el_powers[i].res_power);
 				p += q;
-				log_obj(format("Add %d power for resistance to %s, total is %d\n", q, el_powers[i].name, p));
+				log_obj("Add %d power for resistance to %s, total is %d\n", q, el_powers[i].name, p);
 			}
 		} else if (obj->el_info[i].res_level == 3) {
 			if (el_powers[i].im_power != 0) {
 				q = (el_powers[i].im_power + el_powers[i].res_power);
 				p += q;
-				log_obj(format("Add %d power for immunity to %s, total is %d\n",
-							   q, el_powers[i].name, p));
+				log_obj("Add %d power for immunity to %s, total is %d\n",
+						q, el_powers[i].name, p);
 			}
 		}
 
@@ -710,16 +700,16 @@ static int element_power(const object_type *obj, int p, bool known)
 		if (element_sets[i].count > 1) {
 			q = (element_sets[i].factor * element_sets[i].count * element_sets[i].count);
 			p += q;
-			log_obj(format("Add %d power for multiple %s, total is %d\n",
-						   q, element_sets[i].desc, p));
+			log_obj("Add %d power for multiple %s, total is %d\n",
+					q, element_sets[i].desc, p);
 		}
 
 		/* Add bonus if item has a full set of these flags */
 		if (element_sets[i].count == element_sets[i].size) {
 			q = element_sets[i].bonus;
 			p += q;
-			log_obj(format("Add %d power for full set of %s, total is %d\n", 
-						   q, element_sets[i].desc, p));
+			log_obj("Add %d power for full set of %s, total is %d\n", 
+					q, element_sets[i].desc, p);
 		}
 	}
 
@@ -743,8 +733,8 @@ static int effects_power(const object_type *obj, int p, bool known)
 
 		if (q) {
 			p += q;
-			log_obj(format("Add %d power for item activation, total is %d\n",
-						   q, p));
+			log_obj("Add %d power for item activation, total is %d\n",
+					q, p);
 		}
 	}
 	return p;
@@ -772,7 +762,7 @@ s32b object_power(const object_type* obj, int verbose, ang_file *log_file,
 	p = to_damage_power(obj);
 	dice_pwr = damage_dice_power(obj);
 	p += dice_pwr;
-	if (dice_pwr) log_obj(format("total is %d\n", p));
+	if (dice_pwr) log_obj("total is %d\n", p);
 	p += ammo_damage_power(obj, p);
 	mult = bow_multiplier(obj);
 	p = launcher_ammo_damage_power(obj, p);
@@ -799,7 +789,7 @@ s32b object_power(const object_type* obj, int verbose, ang_file *log_file,
 	p = element_power(obj, p, known);
 	p = effects_power(obj, p, known);
 
-	log_obj(format("FINAL POWER IS %d\n", p));
+	log_obj("FINAL POWER IS %d\n", p);
 
 	return p;
 }
@@ -942,7 +932,7 @@ s32b object_value_real(const object_type *obj, int qty, int verbose,
  * Never notice unknown bonuses or properties, including curses,
  * since that would give the player information they did not have.
  */
-s32b object_value(const object_type *obj, int qty, int verbose)
+static s32b object_value_aux(const object_type *obj, int qty, int verbose)
 {
 	s32b value;
 
@@ -979,3 +969,41 @@ s32b object_value(const object_type *obj, int qty, int verbose)
 	/* Return the final value */
 	return (value);
 }
+
+/**
+ * Recently worked out values, so that redrawing a list of objects with
+ * prices, such as a shop's, doesn't value each one again.  They are kept like
+ * remembered descriptions (see object_memo_find()); the brand and slay lists,
+ * which the object copy only points to, are checked through their signature.
+ */
+#define VALUE_CACHE_SIZE 64
+
+static struct value_cache_entry {
+	struct object_memo memo;
+	s32b value;
+} value_cache[VALUE_CACHE_SIZE];
+
+s32b object_value(const object_type *obj, int qty, int verbose)
+{
+	struct value_cache_entry *entry;
+	size_t key[OBJECT_MEMO_KEYS];
+	bool hit;
+
+	/* Logged valuations are always done in full */
+	if (verbose)
+		return object_value_aux(obj, qty, verbose);
+
+	key[0] = qty;
+	key[1] = obj->kind->aware;
+	key[2] = slay_signature(obj->brands, obj->slays);
+	key[3] = 0;
+	entry = (struct value_cache_entry *)object_memo_find(value_cache,
+		VALUE_CACHE_SIZE, sizeof(*entry), obj, key, &hit);
+	if (hit)
+		return entry->value;
+
+	entry->value = object_value_aux(obj, qty, verbose);
+	object_memo_fill(&entry->memo, obj, key);
+
+	return entry->value;
+}
@@ -308,9 +308,11 @@ static s32b artifact_power(int a_idx, bool translate)
 
 	if (fail) return 0;
 
-	object_desc(buf, 256 * sizeof(char), &obj,
-				ODESC_PREFIX | ODESC_FULL | ODESC_SPOIL);
-	file_putf(log_file, "%s\n", buf);
+	if (log_file) {
+		object_desc(buf, 256 * sizeof(char), &obj,
+					ODESC_PREFIX | ODESC_FULL | ODESC_SPOIL);
+		file_putf(log_file, "%s\n", buf);
+	}
 
 	power = object_power(&obj, verbose, log_file, TRUE);
 
@@ -365,6 +367,9 @@ static void store_base_power(void)
 
 	/* Store the number of different types, for use later */
 	/* ToDo: replace this with full combination tracking */
+	art_melee_total = art_bow_total = art_armor_total = art_shield_total = 0;
+	art_cloak_total = art_headgear_total = art_glove_total = 0;
+	art_boot_total = art_other_total = 0;
 	for (i = 0; i < z_info->a_max; i++) {
 		switch (a_info[i].tval)
 		{
@@ -2837,6 +2842,7 @@ static errr init_names(void)
 	int i;
 	struct artifact *a;
 
+	init_randnames();
 	for (i = 0; i < z_info->a_max; i++) {
 		char desc[128] = "Based on ";
 
@@ -2850,8 +2856,8 @@ static errr init_names(void)
 		else
 			my_strcat(desc, a->name + 1, strlen(a->name) + 8);
 
-		a->text = string_make(desc);
-		a->name = artifact_gen_name(a, name_sections);
+		a->text = data_string(string_make(desc));
+		a->name = data_string(artifact_gen_name(a, name_sections));
 	}
 
 	return 0;
@@ -2876,6 +2882,16 @@ static errr do_randart_aux(bool full)
 }
 
 
+/**
+ * Turn the randart.log, and the work done only for it, on or off; it is on
+ * unless asked otherwise, but something making many sets of artifacts in a
+ * row, like the stats frontend, is better off without it
+ */
+void randart_set_verbose(bool on)
+{
+	verbose = on;
+}
+
 /**
  * Randomize the artifacts
  *
@@ -2923,18 +2939,18 @@ errr do_randart(u32b randart_seed, bool full)
 
 	/* Only do all the following if full randomization requested */
 	if (full) {
-		/* Just for fun, look at the frequencies on the finished items */
-		/* Remove this prior to release */
-		store_base_power();
-		parse_frequencies();
-
-		/* Close the log file */
+		/* Close the log file, after a look at the frequencies on the
+		 * finished items, which only go to the log */
 		if (verbose) {
+			store_base_power();
+			parse_frequencies();
+
 			if (!file_close(log_file))
 			{
 				msg("Error - can't close randart.log file.");
 				exit(1);
 			}
+			log_file = NULL;
 		}
 
 		/* Free the "original powers" arrays */
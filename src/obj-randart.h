@@ -161,6 +161,7 @@ enum {
 };
 
 char *artifact_gen_name(struct artifact *a, const char ***wordlist);
+void randart_set_verbose(bool on);
 errr do_randart(u32b randart_seed, bool full);
 
 #endif /* OBJECT_RANDART_H */
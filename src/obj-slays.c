@@ -27,9 +27,40 @@
 
 
 /**
- * Cache of slay values (for object_power)
+ * Cache of slay values (for object_power); it has the combinations found on
+ * ego items, and room for the most recent few others, such as a random
+ * artifact's as it is built up
  */
+#define SLAY_CACHE_EXTRA	64
+
 static struct slay_cache *slay_cache;
+static int slay_cache_num;
+static int slay_cache_size;
+static int slay_cache_reuse;
+
+/**
+ * The cache entries chained by the hash of their signatures; each head is
+ * an index into slay_cache plus one, or 0 for none
+ */
+#define SLAY_HASH_SIZE		256
+#define slay_hash(sig)		(((sig) ^ ((sig) >> 8)) % SLAY_HASH_SIZE)
+
+static int slay_cache_hash[SLAY_HASH_SIZE];
+
+/**
+ * The monster races a brand or slay works on, worked out once for each, so
+ * that valuing a new combination of them needn't simulate attacks on every
+ * race in turn
+ */
+struct rune_reach {
+	int index;				/* Element of a brand, race flag of a slay */
+	char *name;				/* Slay name, which can match a monster base */
+	bool *races;			/* Whether it works on each race */
+	struct rune_reach *next;
+};
+
+static struct rune_reach *brand_reaches;
+static struct rune_reach *slay_reaches;
 
 struct brand_info {
 	const char* name;
@@ -676,46 +707,117 @@ void wipe_slays(struct slay *slays)
 
 
 /**
- * Check the slay cache for a combination of slays and brands
- * 
+ * A quick summary of a combination of slays and brands, which doesn't
+ * depend on their order, and changes with what is known of them
+ */
+u32b slay_signature(const struct brand *brands, const struct slay *slays)
+{
+	u32b sig = 0;
+
+	for (; brands; brands = brands->next)
+		sig += (brands->element * 31 + brands->multiplier) * 2 + brands->known;
+	for (; slays; slays = slays->next)
+		sig += ((slays->race_flag + 97) * 31 + slays->multiplier) * 2 +
+			slays->known;
+
+	return sig;
+}
+
+/**
+ * Find the slay cache entry for a combination of slays and brands
+ *
  * \param obj is the object the combination is on
- * \return the power value of the combination
+ * \param known is whether unknown runes count towards the value
+ * \return the index of the entry, or -1 if the combination isn't there
  */
-s32b check_slay_cache(const object_type *obj)
+static int find_slay_cache(const object_type *obj, bool known)
 {
-	int i = 0;
+	u32b sig = slay_signature(obj->brands, obj->slays);
+	int i;
 
-	while ((slay_cache[i].brands != NULL) && (slay_cache[i].slays != NULL)) {
+	for (i = slay_cache_hash[slay_hash(sig)] - 1; i >= 0;
+		 i = slay_cache[i].hash_next - 1) {
+		if (slay_cache[i].sig != sig) continue;
+
+		/* Entries not yet valued can be taken for either kind of value */
+		if (slay_cache[i].value && (slay_cache[i].known != known))
+			continue;
 		if (brands_are_equal(obj->brands, slay_cache[i].brands, TRUE) &&
-			slays_are_equal(obj->slays, slay_cache[i].slays, TRUE)) 
-			break;
-		i++;
+			slays_are_equal(obj->slays, slay_cache[i].slays, TRUE))
+			return i;
 	}
 
-	return slay_cache[i].value;
+	return -1;
 }
 
+/**
+ * Put a cache entry in its hash chain, or take it out
+ */
+static void slay_cache_link(int i, bool add)
+{
+	int *link = &slay_cache_hash[slay_hash(slay_cache[i].sig)];
+
+	if (add) {
+		slay_cache[i].hash_next = *link;
+		*link = i + 1;
+		return;
+	}
+
+	while (*link != i + 1)
+		link = &slay_cache[*link - 1].hash_next;
+	*link = slay_cache[i].hash_next;
+}
 
 /**
- * Fill in a value in the slay cache. Return TRUE if a change is made.
+ * Check the slay cache for a combination of slays and brands
+ * 
+ * \param obj is the object the combination is on
+ * \param known is whether unknown runes count towards the value
+ * \return the power value of the combination, or 0 if it isn't known yet
+ */
+s32b check_slay_cache(const object_type *obj, bool known)
+{
+	int i = find_slay_cache(obj, known);
+
+	return (i < 0) ? 0 : slay_cache[i].value;
+}
+
+
+/**
+ * Fill in a value in the slay cache, adding the combination if it isn't
+ * there yet.  Return TRUE if a change is made.
  *
  * \param obj is the object the combination is on
+ * \param known is whether unknown runes count towards the value
  * \param value is the value of the slay flags on the object
  */
-bool fill_slay_cache(const object_type *obj, s32b value)
+bool fill_slay_cache(const object_type *obj, bool known, s32b value)
 {
-	int i = 0;
-
-	while ((slay_cache[i].brands != NULL) && (slay_cache[i].slays != NULL)) {
-		if (brands_are_equal(obj->brands, slay_cache[i].brands, TRUE) &&
-			slays_are_equal(obj->slays, slay_cache[i].slays, TRUE)) {
-			slay_cache[i].value = value;
-			return TRUE;
+	int i = find_slay_cache(obj, known);
+
+	if (i < 0) {
+		/* Other combinations take the spare places, oldest out first */
+		if (slay_cache_num < slay_cache_size) {
+			i = slay_cache_num++;
+		} else {
+			i = slay_cache_size - SLAY_CACHE_EXTRA + slay_cache_reuse;
+			slay_cache_reuse = (slay_cache_reuse + 1) % SLAY_CACHE_EXTRA;
+			slay_cache_link(i, FALSE);
+			free_brand(slay_cache[i].brands);
+			free_slay(slay_cache[i].slays);
 		}
-		i++;
+
+		slay_cache[i].brands = NULL;
+		slay_cache[i].slays = NULL;
+		copy_brand(&slay_cache[i].brands, obj->brands);
+		copy_slay(&slay_cache[i].slays, obj->slays);
+		slay_cache[i].sig = slay_signature(obj->brands, obj->slays);
+		slay_cache_link(i, TRUE);
 	}
 
-	return FALSE;
+	slay_cache[i].known = known;
+	slay_cache[i].value = value;
+	return TRUE;
 }
 
 /**
@@ -764,8 +866,9 @@ errr create_slay_cache(struct ego_item *items)
 		copy_slay(&dupcheck[i].slays, e_ptr->slays);
 	}
 
-    /* Allocate slay_cache with an extra empty element for an iteration stop */
-    slay_cache = mem_zalloc((count + 1) * sizeof(struct slay_cache));
+    /* Allocate slay_cache, with room for some more combinations */
+    slay_cache_size = count + SLAY_CACHE_EXTRA;
+    slay_cache = mem_zalloc(slay_cache_size * sizeof(struct slay_cache));
     count = 0;
 
     /* Populate the slay_cache */
@@ -776,10 +879,15 @@ errr create_slay_cache(struct ego_item *items)
 		copy_slay(&slay_cache[count].slays, dupcheck[i].slays);
 		free_brand(dupcheck[i].brands);
 		free_slay(dupcheck[i].slays);
+		slay_cache[count].sig = slay_signature(slay_cache[count].brands,
+											   slay_cache[count].slays);
+		slay_cache[count].known = TRUE;
 		slay_cache[count].value = 0;
+		slay_cache_link(count, TRUE);
 		count++;
 		/*msg("Cached a slay combination");*/
 	}
+	slay_cache_num = count;
 
     mem_free(dupcheck);
 
@@ -787,16 +895,135 @@ errr create_slay_cache(struct ego_item *items)
     return 0;
 }
 
+/**
+ * The races a brand works on: those that don't resist its element
+ */
+static const bool *brand_reach(const struct brand *b)
+{
+	struct rune_reach *reach;
+	int i;
+
+	for (reach = brand_reaches; reach; reach = reach->next)
+		if (reach->index == b->element)
+			return reach->races;
+
+	reach = mem_zalloc(sizeof(*reach));
+	reach->index = b->element;
+	reach->races = mem_zalloc(z_info->r_max * sizeof(bool));
+	for (i = 0; i < z_info->r_max; i++)
+		reach->races[i] = !rf_has(r_info[i].flags,
+								  brand_names[b->element].resist_flag);
+
+	reach->next = brand_reaches;
+	brand_reaches = reach;
+	return reach->races;
+}
+
+/**
+ * The races a slay works on, as react_to_specific_slay() has it
+ */
+static const bool *slay_reach(struct slay *s)
+{
+	struct rune_reach *reach;
+	struct monster mon;
+	int i;
+
+	for (reach = slay_reaches; reach; reach = reach->next)
+		if (reach->index == s->race_flag && streq(reach->name, s->name))
+			return reach->races;
+
+	reach = mem_zalloc(sizeof(*reach));
+	reach->index = s->race_flag;
+	reach->name = string_make(s->name);
+	reach->races = mem_zalloc(z_info->r_max * sizeof(bool));
+	memset(&mon, 0, sizeof(mon));
+	for (i = 0; i < z_info->r_max; i++) {
+		mon.race = &r_info[i];
+		reach->races[i] = react_to_specific_slay(s, &mon);
+	}
+
+	reach->next = slay_reaches;
+	slay_reaches = reach;
+	return reach->races;
+}
+
+/**
+ * Add up, over every monster race, the best multiplier an object's brands
+ * and slays get against that race times the race's scaled power; this is
+ * what improve_attack_modifier() would find race by race.
+ *
+ * \param obj is the object the combination is on
+ * \param known is whether unknown runes count
+ */
+u32b slay_race_power(const object_type *obj, bool known)
+{
+	int *best = mem_alloc(z_info->r_max * sizeof(int));
+	struct brand *b;
+	struct slay *s;
+	u32b sv = 0;
+	int i;
+
+	for (i = 0; i < z_info->r_max; i++)
+		best[i] = 1;
+
+	for (b = obj->brands; b; b = b->next) {
+		const bool *races;
+
+		if (!known && !b->known) continue;
+
+		races = brand_reach(b);
+		for (i = 0; i < z_info->r_max; i++)
+			if (races[i] && best[i] < b->multiplier)
+				best[i] = b->multiplier;
+	}
+
+	for (s = obj->slays; s; s = s->next) {
+		const bool *races;
+
+		if (!known && !s->known) continue;
+
+		races = slay_reach(s);
+		for (i = 0; i < z_info->r_max; i++)
+			if (races[i] && best[i] < s->multiplier)
+				best[i] = s->multiplier;
+	}
+
+	for (i = 0; i < z_info->r_max; i++)
+		sv += best[i] * r_info[i].scaled_power;
+
+	mem_free(best);
+	return sv;
+}
+
+static void free_rune_reaches(struct rune_reach *reach)
+{
+	while (reach) {
+		struct rune_reach *next = reach->next;
+
+		string_free(reach->name);
+		mem_free(reach->races);
+		mem_free(reach);
+		reach = next;
+	}
+}
+
 /**
  * Free the slay cache
  */
 void free_slay_cache(void)
 {
-	int i = 0;
-	while (slay_cache[i].slays || slay_cache[i].brands) {
+	int i;
+
+	for (i = 0; i < slay_cache_num; i++) {
 		free_slay(slay_cache[i].slays);
 		free_brand(slay_cache[i].brands);
-		i++;
 	}
 	mem_free(slay_cache);
+	slay_cache = NULL;
+	slay_cache_num = slay_cache_size = slay_cache_reuse = 0;
+	memset(slay_cache_hash, 0, sizeof(slay_cache_hash));
+
+	free_rune_reaches(brand_reaches);
+	free_rune_reaches(slay_reaches);
+	brand_reaches = slay_reaches = NULL;
 }
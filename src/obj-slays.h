@@ -26,6 +26,9 @@
 struct slay_cache {
 	struct brand *brands;   	/* Brands */
 	struct slay *slays;   	/* Slays */
+	u32b sig;					/* Summary for quick comparison */
+	int hash_next;				/* Next entry with the same hash, plus one */
+	bool known;					/* Whether unknown runes were counted */
 	s32b value;            		/* Value of this combination */
 };
 
@@ -53,8 +56,10 @@ bool react_to_slay(struct object *obj, const struct monster *mon);
 void wipe_brands(struct brand *brands);
 void wipe_slays(struct slay *slays);
 errr create_slay_cache(struct ego_item *items);
-s32b check_slay_cache(const object_type *obj);
-bool fill_slay_cache(const object_type *obj, s32b value);
+s32b check_slay_cache(const object_type *obj, bool known);
+bool fill_slay_cache(const object_type *obj, bool known, s32b value);
+u32b slay_signature(const struct brand *brands, const struct slay *slays);
+u32b slay_race_power(const object_type *obj, bool known);
 void free_slay_cache(void);
 
 #endif /* OBJECT_SLAYS_H */
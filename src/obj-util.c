@@ -53,6 +53,13 @@ struct flavor *flavors;
  */
 static char scroll_adj[MAX_TITLES][18];
 
+/**
+ * The flavor seed and randart setting the flavors were last assigned with
+ */
+static bool flavors_assigned = FALSE;
+static u32b flavors_seed;
+static bool flavors_randarts;
+
 static void flavor_assign_fixed(void)
 {
 	int i;
@@ -149,10 +156,13 @@ void flavor_reset_fixed(void)
  * "town_gen()".  Since no other functions are called while the special
  * seed is in effect, so this function is pretty "safe".
  */
-void flavor_init(void)
+static void flavor_assign(void)
 {
 	int i, j;
 
+	/* The scroll titles are made from the random name tables */
+	init_randnames();
+
 	/* Hack -- Use the "simple" RNG */
 	Rand_quick = TRUE;
 
@@ -211,6 +221,23 @@ void flavor_init(void)
 	/* Hack -- Use the "complex" RNG */
 	Rand_quick = FALSE;
 
+	flavors_assigned = TRUE;
+	flavors_seed = seed_flavor;
+	flavors_randarts = OPT(birth_randarts);
+}
+
+void flavor_init(void)
+{
+	int i;
+
+	object_desc_invalidate();
+
+	/* The flavors only depend on the seed and whether there are randarts, so
+	 * loading the same game again keeps them, scroll titles and all */
+	if (!flavors_assigned || flavors_seed != seed_flavor ||
+			flavors_randarts != OPT(birth_randarts))
+		flavor_assign();
+
 	/* Analyze every object */
 	for (i = 1; i < z_info->k_max; i++) {
 		struct object_kind *kind = &k_info[i];
@@ -224,6 +251,15 @@ void flavor_init(void)
 }
 
 
+/**
+ * Forget that the flavors were assigned, as the flavor list is going
+ */
+void flavor_forget(void)
+{
+	flavors_assigned = FALSE;
+}
+
+
 /**
  * Obtain the flags for an item
  */
@@ -243,15 +279,20 @@ void object_flags(const struct object *obj, bitflag flags[OF_SIZE])
  */
 void object_flags_known(const struct object *obj, bitflag flags[OF_SIZE])
 {
-	object_flags(obj, flags);
-
-	of_inter(flags, obj->known_flags);
-
-	if (object_flavor_is_aware(obj))
-		of_union(flags, obj->kind->flags);
-
-	if (obj->ego && easy_know(obj))
-		of_union(flags, obj->ego->flags);
+	const bitflag *kind_flags = object_flavor_is_aware(obj) ?
+		obj->kind->flags : NULL;
+	const bitflag *ego_flags = obj->ego && easy_know(obj) ?
+		obj->ego->flags : NULL;
+	size_t i;
+
+	/* All in one pass, as this is asked for whenever an object is shown */
+	for (i = 0; i < OF_SIZE; i++) {
+		flags[i] = obj->flags[i] & obj->known_flags[i];
+		if (kind_flags)
+			flags[i] |= kind_flags[i];
+		if (ego_flags)
+			flags[i] |= ego_flags[i];
+	}
 }
 
 /**
@@ -311,17 +352,79 @@ unsigned check_for_inscrip(const struct object *obj, const char *inscrip)
 /*** Object kind lookup functions ***/
 
 /**
- * Return the object kind with the given `tval` and `sval`, or NULL.
+ * Object kinds by tval, each indexed by sval
  */
-struct object_kind *lookup_kind(int tval, int sval)
+static struct kind_index {
+	struct object_kind **kinds;
+	int num;
+} kind_index[TV_MAX];
+static bool kind_index_built;
+
+/**
+ * Index the object kinds, once they have all been read in
+ */
+void kind_index_init(void)
 {
 	int k;
 
-	/* Look for it */
+	kind_index_free();
+
 	for (k = 0; k < z_info->k_max; k++) {
 		struct object_kind *kind = &k_info[k];
-		if (kind->tval == tval && kind->sval == sval)
-			return kind;
+		struct kind_index *index;
+
+		if (kind->tval < 0 || kind->tval >= TV_MAX || kind->sval < 0)
+			continue;
+		index = &kind_index[kind->tval];
+
+		if (kind->sval >= index->num) {
+			index->kinds = mem_realloc(index->kinds,
+									   (kind->sval + 1) * sizeof(*index->kinds));
+			memset(index->kinds + index->num, 0,
+				   (kind->sval + 1 - index->num) * sizeof(*index->kinds));
+			index->num = kind->sval + 1;
+		}
+
+		/* The first kind with a tval and sval is the one found */
+		if (!index->kinds[kind->sval])
+			index->kinds[kind->sval] = kind;
+	}
+
+	kind_index_built = TRUE;
+}
+
+void kind_index_free(void)
+{
+	int tval;
+
+	for (tval = 0; tval < TV_MAX; tval++) {
+		mem_free(kind_index[tval].kinds);
+		kind_index[tval].kinds = NULL;
+		kind_index[tval].num = 0;
+	}
+
+	kind_index_built = FALSE;
+}
+
+/**
+ * Return the object kind with the given `tval` and `sval`, or NULL.
+ */
+struct object_kind *lookup_kind(int tval, int sval)
+{
+	int k;
+
+	if (kind_index_built && tval >= 0 && tval < TV_MAX) {
+		/* Look it up directly */
+		if (sval >= 0 && sval < kind_index[tval].num &&
+				kind_index[tval].kinds[sval])
+			return kind_index[tval].kinds[sval];
+	} else {
+		/* Look for it */
+		for (k = 0; k < z_info->k_max; k++) {
+			struct object_kind *kind = &k_info[k];
+			if (kind->tval == tval && kind->sval == sval)
+				return kind;
+		}
 	}
 
 	/* Failure */
@@ -365,6 +468,20 @@ int lookup_artifact_name(const char *name)
 }
 
 
+/**
+ * Whether an object kind has the given `tval` and name `name`
+ */
+static bool kind_is_named(const struct object_kind *kind, int tval,
+						  const char *name)
+{
+	char cmp_name[1024];
+
+	if (!kind || !kind->name || kind->tval != tval) return FALSE;
+
+	obj_desc_name_format(cmp_name, sizeof cmp_name, 0, kind->name, 0, FALSE);
+	return !my_stricmp(cmp_name, name);
+}
+
 /**
  * Return the numeric sval of the object kind with the given `tval` and
  * name `name`.
@@ -377,21 +494,19 @@ int lookup_sval(int tval, const char *name)
 	if (sscanf(name, "%u", &r) == 1)
 		return r;
 
-	/* Look for it */
-	for (k = 1; k < z_info->k_max; k++) {
-		struct object_kind *kind = &k_info[k];
-		char cmp_name[1024];
-
-		if (!kind || !kind->name) continue;
-
-		obj_desc_name_format(cmp_name, sizeof cmp_name, 0, kind->name, 0,
-							 FALSE);
-
-		/* Found a match */
-		if (kind->tval == tval && !my_stricmp(cmp_name, name))
-			return kind->sval;
+	/* Only the kinds with that tval need looking at, once they are known */
+	if (kind_index_built && tval >= 0 && tval < TV_MAX) {
+		for (k = 0; k < kind_index[tval].num; k++)
+			if (kind_is_named(kind_index[tval].kinds[k], tval, name))
+				return k;
+		return -1;
 	}
 
+	/* Look for it */
+	for (k = 1; k < z_info->k_max; k++)
+		if (kind_is_named(&k_info[k], tval, name))
+			return k_info[k].sval;
+
 	return -1;
 }
 
@@ -26,12 +26,15 @@
 #define MAX_PVAL  32767
 
 void flavor_init(void);
+void flavor_forget(void);
 void object_flags(const struct object *obj, bitflag flags[OF_SIZE]);
 void object_flags_known(const struct object *obj, bitflag flags[OF_SIZE]);
 bool object_test(item_tester tester, const struct object *o);
 bool item_test(item_tester tester, int item);
 bool is_unknown(const struct object *obj);
 unsigned check_for_inscrip(const struct object *obj, const char *inscrip);
+void kind_index_init(void);
+void kind_index_free(void);
 struct object_kind *lookup_kind(int tval, int sval);
 struct object_kind *objkind_byid(int kidx);
 int lookup_artifact_name(const char *name);
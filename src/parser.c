@@ -83,8 +83,15 @@ struct parser {
 	unsigned int colno;
 	char errmsg[1024];
 	struct parser_hook *hooks;
+	struct parser_hook **hook_table; /* Hooks hashed by directive, or NULL */
+	size_t hook_table_size;
 	struct parser_value *fhead;
 	struct parser_value *ftail;
+	struct parser_value *fprev;      /* Value most recently asked for */
+	char *line;                      /* Copy of the line being parsed */
+	size_t line_size;
+	struct parser_value *vals;       /* Value nodes reused for every line */
+	size_t vals_size;
 	void *priv;
 };
 
@@ -96,26 +103,68 @@ struct parser *parser_new(void) {
 	return p;
 }
 
+/**
+ * Hash a directive name (djb2)
+ */
+static size_t hook_hash(const char *dir) {
+	size_t hash = 5381;
+	while (*dir)
+		hash = hash * 33 + (unsigned char) *dir++;
+	return hash;
+}
+
+/**
+ * Build the open-addressed table of hooks by directive.  It is kept at most
+ * half full; hooks are added in list order, so when a directive has been
+ * registered twice the table finds the same hook the list would.
+ */
+static void build_hook_table(struct parser *p) {
+	struct parser_hook *h;
+	size_t count = 0;
+
+	for (h = p->hooks; h; h = h->next)
+		count++;
+
+	p->hook_table_size = 16;
+	while (p->hook_table_size < 2 * count)
+		p->hook_table_size *= 2;
+	p->hook_table = mem_zalloc(p->hook_table_size * sizeof(*p->hook_table));
+
+	for (h = p->hooks; h; h = h->next) {
+		size_t i = hook_hash(h->dir) & (p->hook_table_size - 1);
+		while (p->hook_table[i] && strcmp(p->hook_table[i]->dir, h->dir))
+			i = (i + 1) & (p->hook_table_size - 1);
+		if (!p->hook_table[i])
+			p->hook_table[i] = h;
+	}
+}
+
 static struct parser_hook *findhook(struct parser *p, const char *dir) {
-	struct parser_hook *h = p->hooks;
-	while (h) {
-		if (!strcmp(h->dir, dir))
-			break;
-		h = h->next;
+	size_t i;
+
+	if (!p->hook_table)
+		build_hook_table(p);
+
+	i = hook_hash(dir) & (p->hook_table_size - 1);
+	while (p->hook_table[i]) {
+		if (!strcmp(p->hook_table[i]->dir, dir))
+			return p->hook_table[i];
+		i = (i + 1) & (p->hook_table_size - 1);
 	}
-	return h;
+
+	return NULL;
 }
 
+/**
+ * Forgets the values from the previous line.
+ *
+ * The value nodes live in `p->vals` and their strings point into `p->line`,
+ * so both are simply reused by the next call to parser_parse().
+ */
 static void parser_freeold(struct parser *p) {
-	struct parser_value *v;
-	while (p->fhead) {
-		int t = p->fhead->spec.type & ~PARSE_T_OPT;
-		v = (struct parser_value *)p->fhead->spec.next;
-		if (t == PARSE_T_SYM || t == PARSE_T_STR)
-			mem_free(p->fhead->u.sval);
-		mem_free(p->fhead);
-		p->fhead = v;
-	}
+	p->fhead = NULL;
+	p->ftail = NULL;
+	p->fprev = NULL;
 }
 
 static bool parse_random(const char *str, random_value *bonus) {
@@ -209,12 +258,12 @@ static bool parse_random(const char *str, random_value *bonus) {
  * This runs the first parser hook registered with `p` that matches `line`.
  */
 enum parser_error parser_parse(struct parser *p, const char *line) {
-	char *cline;
 	char *tok;
 	struct parser_hook *h;
 	struct parser_spec *s;
 	struct parser_value *v;
 	char *sp = NULL;
+	size_t len, nspecs = 0;
 
 	assert(p);
 	assert(line);
@@ -223,8 +272,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 
 	p->lineno++;
 	p->colno = 1;
-	p->fhead = NULL;
-	p->ftail = NULL;
 
 	/* Ignore empty lines and comments. */
 	while (*line && (isspace(*line)))
@@ -232,11 +279,18 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!*line || *line == '#')
 		return PARSE_ERROR_NONE;
 
-	cline = string_make(line);
+	/* Tokenize a copy of the line, kept between calls so that the common
+	 * case needs no allocation at all */
+	len = strlen(line) + 1;
+	if (len > p->line_size) {
+		mem_free(p->line);
+		p->line_size = MAX(len, 256);
+		p->line = mem_alloc(p->line_size);
+	}
+	memcpy(p->line, line, len);
 
-	tok = strtok(cline, ":");
+	tok = strtok(p->line, ":");
 	if (!tok) {
-		mem_free(cline);
 		p->error = PARSE_ERROR_MISSING_FIELD;
 		return PARSE_ERROR_MISSING_FIELD;
 	}
@@ -245,10 +299,19 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!h) {
 		my_strcpy(p->errmsg, tok, sizeof(p->errmsg));
 		p->error = PARSE_ERROR_UNDEFINED_DIRECTIVE;
-		mem_free(cline);
 		return PARSE_ERROR_UNDEFINED_DIRECTIVE;
 	}
 
+	/* Make sure there is a value node for every field */
+	for (s = h->fhead; s; s = s->next)
+		nspecs++;
+	if (nspecs > p->vals_size) {
+		mem_free(p->vals);
+		p->vals_size = nspecs;
+		p->vals = mem_alloc(nspecs * sizeof *p->vals);
+	}
+	v = p->vals;
+
 	/* There's a little bit of trickiness here to account for optional
 	 * types. The optional flag has a bit assigned to it in the spec's type
 	 * tag; we compute a temporary type for the spec with that flag removed
@@ -275,14 +338,12 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 			if (!(s->type & PARSE_T_OPT)) {
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_MISSING_FIELD;
-				mem_free(cline);
 				return PARSE_ERROR_MISSING_FIELD;
 			}
 			break;
 		}
 
-		/* Allocate a value node. */
-		v = mem_alloc(sizeof *v);
+		/* Fill in the next value node. */
 		v->spec.next = NULL;
 		v->spec.type = s->type;
 		v->spec.name = s->name;
@@ -292,8 +353,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 			char *z = NULL;
 			v->u.ival = strtol(tok, &z, 0);
 			if (z == tok) {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -302,8 +361,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 			char *z = NULL;
 			v->u.uval = strtoul(tok, &z, 0);
 			if (z == tok || *tok == '-') {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -311,11 +368,9 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		} else if (t == PARSE_T_CHAR) {
 			text_mbstowcs(&v->u.cval, tok, 1);
 		} else if (t == PARSE_T_SYM || t == PARSE_T_STR) {
-			v->u.sval = string_make(tok);
+			v->u.sval = tok;
 		} else if (t == PARSE_T_RAND) {
 			if (!parse_random(tok, &v->u.rval)) {
-				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_RANDOM;
 				return PARSE_ERROR_NOT_RANDOM;
@@ -328,10 +383,9 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		else
 			p->ftail->spec.next = &v->spec;
 		p->ftail = v;
+		v++;
 	}
 
-	mem_free(cline);
-
 	p->error = h->func(p);
 	return p->error;
 }
@@ -390,6 +444,9 @@ static void clean_specs(struct parser_hook *h) {
 void parser_destroy(struct parser *p) {
 	struct parser_hook *h;
 	parser_freeold(p);
+	mem_free(p->line);
+	mem_free(p->vals);
+	mem_free(p->hook_table);
 	while (p->hooks) {
 		h = p->hooks->next;
 		clean_specs(p->hooks);
@@ -495,6 +552,10 @@ errr parser_reg(struct parser *p, const char *fmt,
 
 	p->hooks = h;
 	mem_free(cfmt);
+
+	/* The hook table is rebuilt on the next lookup */
+	mem_free(p->hook_table);
+	p->hook_table = NULL;
 	return 0;
 }
 
@@ -519,10 +580,24 @@ bool parser_hasval(struct parser *p, const char *name) {
 	return FALSE;
 }
 
+/**
+ * Find the value named `name`.  Handlers mostly ask for values in the order
+ * they appear, so the search starts just after the last value found.
+ */
 static struct parser_value *parser_getval(struct parser *p, const char *name) {
 	struct parser_value *v;
-	for (v = p->fhead; v; v = (struct parser_value *)v->spec.next) {
+	struct parser_value *start = p->fprev ?
+		(struct parser_value *)p->fprev->spec.next : NULL;
+
+	for (v = start; v; v = (struct parser_value *)v->spec.next) {
 		if (!strcmp(v->spec.name, name)) {
+			p->fprev = v;
+			return v;
+		}
+	}
+	for (v = p->fhead; v != start; v = (struct parser_value *)v->spec.next) {
+		if (!strcmp(v->spec.name, name)) {
+			p->fprev = v;
 			return v;
 		}
 	}
@@ -809,7 +884,7 @@ errr grab_index_and_int(int *value, int *index, const char **value_type,
 {
 	int i;
 	char value_name[80];
-	char value_string[80];
+	size_t len = strlen(prefix);
 
 	/* Get a rewritable string */
 	my_strcpy(value_name, name_and_value, strlen(name_and_value));
@@ -818,13 +893,11 @@ errr grab_index_and_int(int *value, int *index, const char **value_type,
 	if (!find_value_arg(value_name, NULL, value))
 		return PARSE_ERROR_INVALID_VALUE;
 
-	/* Compose the value string and look for it */
-	for (i = 0; value_type[i]; i++) {
-		my_strcpy(value_string, prefix, sizeof(value_string));
-		my_strcat(value_string, value_type[i],
-				  sizeof(value_string) - strlen(value_string));
-		if (streq(value_string, value_name)) break;
-	}
+	/* Match the prefix once, then look for the rest */
+	if (strncmp(value_name, prefix, len))
+		return PARSE_ERROR_INTERNAL;
+	for (i = 0; value_type[i]; i++)
+		if (streq(value_name + len, value_type[i])) break;
 
 	if (value_type[i])
 		*index = i;
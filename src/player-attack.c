@@ -414,6 +414,62 @@ static bool py_attack_real(int y, int x, bool *fear)
 }
 
 
+/**
+ * Sample the damage of n melee blows by the player against a monster, with no
+ * messages, no learning and no effect on the monster, for balance testing.
+ *
+ * Each blow is worked out as in py_attack_real(), except that the best slay or
+ * brand is only chosen once, since it is the same for every blow.
+ *
+ * \param mon is the monster being attacked.
+ * \param n is the number of blows.
+ * \param dam has room for n entries, and gets each blow's damage (zero for a
+ * miss).
+ * \return the number of blows that hit.
+ */
+int py_attack_sample(const struct monster *mon, int n, int *dam)
+{
+	struct object *obj = equipped_item_by_slot_name(player, "weapon");
+	int chance = py_attack_hit_chance(obj);
+	bool vis = mflag_has(mon->mflag, MFLAG_VISIBLE);
+	const struct brand *b = NULL;
+	const struct slay *s = NULL;
+	char verb[20];
+	int i, hits = 0;
+
+	/* Get the best attack from all slays or brands, as for a real blow */
+	if (obj) {
+		for (i = 2; i < player->body.count; i++) {
+			struct object *worn = slot_object(player, i);
+			if (worn)
+				improve_attack_modifier(worn, mon, &b, &s, verb, FALSE,
+										FALSE, FALSE);
+		}
+
+		improve_attack_modifier(obj, mon, &b, &s, verb, FALSE, FALSE, FALSE);
+	}
+
+	for (i = 0; i < n; i++) {
+		int dmg = 1;
+		u32b msg_type;
+
+		if (!test_hit(chance, mon->race->ac, vis)) {
+			dam[i] = 0;
+			continue;
+		}
+		hits++;
+
+		if (obj) {
+			dmg = melee_damage(obj, b, s);
+			dmg = critical_norm(obj->weight, obj->to_h, dmg, &msg_type);
+		}
+		dmg += player_damage_bonus(&player->state);
+		dam[i] = MAX(dmg, 0);
+	}
+
+	return hits;
+}
+
 /**
  * Attack the monster at the given location
  *
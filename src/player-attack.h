@@ -46,5 +46,6 @@ extern int breakage_chance(const object_type *o_ptr, bool hit_target);
 extern bool test_hit(int chance, int ac, int vis);
 extern void py_attack(int y, int x);
 int py_attack_hit_chance(const object_type *weapon);
+int py_attack_sample(const struct monster *mon, int n, int *dam);
 
 #endif /* !PLAYER_ATTACK_H */
@@ -24,6 +24,7 @@
 #include "init.h"
 #include "mon-lore.h"
 #include "monster.h"
+#include "obj-desc.h"
 #include "obj-gear.h"
 #include "obj-identify.h"
 #include "obj-ignore.h"
@@ -382,6 +383,7 @@ void player_init(struct player *p)
 		k_ptr->tried = FALSE;
 		k_ptr->aware = FALSE;
 	}
+	object_desc_invalidate();
 
 	for (i = 1; z_info && i < z_info->r_max; i++) {
 		monster_race *r_ptr = &r_info[i];
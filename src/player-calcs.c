@@ -1001,6 +1001,8 @@ void calc_inventory(struct player_upkeep *upkeep, struct object *gear,
 					struct player_body body)
 {
 	int quiver_slots = 0;
+	int inven_cnt = 0, i;
+	struct object *current;
 
 	/* Fill the quiver */
 	upkeep->quiver_cnt = 0;
@@ -1059,39 +1061,41 @@ void calc_inventory(struct player_upkeep *upkeep, struct object *gear,
 			upkeep->quiver[quiver_slots++] = NULL;
 	}
 
-	/* Fill the inventory */
-	upkeep->inven_cnt = 0;
-	while (upkeep->inven_cnt <= z_info->pack_size) {
-		struct object *current, *first = NULL;
-		for (current = gear; current; current = current->next) {
-			int i;
-			bool possible = TRUE;
+	/* Fill the inventory, in order, keeping objects that earlier_object()
+	 * can't separate in the order they're carried */
+	for (current = gear; current; current = current->next) {
+		int i, slot;
+		bool possible = TRUE;
 
-			/* Skip equipment */
-			if (object_is_equipped(body, current))
+		/* Skip equipment */
+		if (object_is_equipped(body, current))
+			possible = FALSE;
+
+		/* Skip quivered objects */
+		for (i = 0; i < z_info->quiver_size; i++)
+			if (upkeep->quiver[i] == current)
 				possible = FALSE;
 
-			/* Skip quivered objects */
-			for (i = 0; i < z_info->quiver_size; i++)
-				if (upkeep->quiver[i] == current)
-					possible = FALSE;
-
-			/* Skip objects already allocated to the inventory */
-			for (i = 0; i < upkeep->inven_cnt; i++)
-				if (upkeep->inven[i] == current)
-					possible = FALSE;
-
-			/* If still possible, choose the first in order */
-			if (!possible)
-				continue;
-			else if (earlier_object(first, current, FALSE)) {
-				first = current;
-			}
-		}
+		if (!possible) continue;
+
+		/* Find its place, after everything that comes no later */
+		for (slot = inven_cnt; slot > 0; slot--)
+			if (!earlier_object(upkeep->inven[slot - 1], current, FALSE))
+				break;
+		if (slot > z_info->pack_size) continue;
 
-		/* Allocate */
-		upkeep->inven[upkeep->inven_cnt++] = first;
+		/* Make room, losing the last object if the inventory is full */
+		if (inven_cnt <= z_info->pack_size)
+			inven_cnt++;
+		for (i = inven_cnt - 1; i > slot; i--)
+			upkeep->inven[i] = upkeep->inven[i - 1];
+		upkeep->inven[slot] = current;
 	}
+
+	/* Empty the rest */
+	for (i = inven_cnt; i <= z_info->pack_size; i++)
+		upkeep->inven[i] = NULL;
+	upkeep->inven_cnt = z_info->pack_size + 1;
 }
 
 static void update_inventory(struct player *p)
@@ -1128,6 +1132,9 @@ static void calc_spells(struct player *p)
 
 	const char *noun = p->class->magic.spell_realm->spell_noun;
 
+	/* Spells may be learned or forgotten */
+	spell_cache_invalidate();
+
 	/* Hack -- must be literate */
 	if (!p->class->magic.total_spells) return;
 
@@ -1617,6 +1624,7 @@ void calc_bonuses(struct player *p, player_state *state, bool known_only)
 	int extra_might = 0;
 
 	struct object *obj;
+	bool known;
 
 	bitflag f[OF_SIZE];
 	bitflag collect_f[OF_SIZE];
@@ -1722,9 +1730,9 @@ void calc_bonuses(struct player *p, player_state *state, bool known_only)
 		extra_might += obj->modifiers[OBJ_MOD_MIGHT];
 
 		/* Affect resists */
+		known = !known_only || object_is_known(obj);
 		for (j = 0; j < ELEM_MAX; j++)
-			if (!known_only || object_is_known(obj) ||
-				object_element_is_known(obj, j)) {
+			if (known || object_element_is_known(obj, j)) {
 
 				/* Note vulnerability for later processing */
 				if (obj->el_info[j].res_level == -1)
@@ -1739,8 +1747,7 @@ void calc_bonuses(struct player *p, player_state *state, bool known_only)
 		state->ac += obj->ac;
 
 		/* Apply the bonuses to armor class */
-		if (!known_only || object_is_known(obj) ||
-			object_defence_plusses_are_visible(obj))
+		if (known || object_defence_plusses_are_visible(obj))
 			state->to_a += obj->to_a;
 
 		/* Do not apply weapon and bow bonuses until combat calculations */
@@ -1748,8 +1755,7 @@ void calc_bonuses(struct player *p, player_state *state, bool known_only)
 		if (slot_type_is(i, EQUIP_BOW)) continue;
 
 		/* Apply the bonuses to hit/damage */
-		if (!known_only || object_is_known(obj) ||
-			object_attack_plusses_are_visible(obj))
+		if (known || object_attack_plusses_are_visible(obj))
 		{
 			state->to_h += obj->to_h;
 			state->to_d += obj->to_d;
@@ -2140,6 +2146,8 @@ static void update_bonuses(struct player *p)
 	player_state state = p->state;
 	player_state known_state = p->known_state;
 
+	/* Spell failure rates and descriptions depend on the bonuses */
+	spell_cache_invalidate();
 
 	/* ------------------------------------
 	 * Calculate bonuses
@@ -2354,88 +2362,114 @@ void notice_stuff(struct player *p)
 	}
 }
 
-/**
- * Handle "player->upkeep->update"
- */
-void update_stuff(struct player *p)
+static void update_torch(struct player *p)
 {
-	/* Update stuff */
-	if (!p->upkeep->update) return;
-
-
-	if (p->upkeep->update & (PU_INVEN)) {
-		p->upkeep->update &= ~(PU_INVEN);
-		update_inventory(p);
-	}
+	calc_torch(p, &p->state);
+}
 
-	if (p->upkeep->update & (PU_BONUS)) {
-		p->upkeep->update &= ~(PU_BONUS);
-		update_bonuses(p);
-	}
+static void update_mana(struct player *p)
+{
+	calc_mana(p, &p->state);
+}
 
-	if (p->upkeep->update & (PU_TORCH)) {
-		p->upkeep->update &= ~(PU_TORCH);
-		calc_torch(p, &p->state);
-	}
+static void update_forget_view(struct player *p)
+{
+	forget_view(cave);
+}
 
-	if (p->upkeep->update & (PU_HP)) {
-		p->upkeep->update &= ~(PU_HP);
-		calc_hitpoints(p);
-	}
+static void update_view_aux(struct player *p)
+{
+	update_view(cave, p);
+}
 
-	if (p->upkeep->update & (PU_MANA)) {
-		p->upkeep->update &= ~(PU_MANA);
-		calc_mana(p, &p->state);
-	}
+static void update_forget_flow(struct player *p)
+{
+	cave_forget_flow(cave);
+}
 
-	if (p->upkeep->update & (PU_SPELLS)) {
-		p->upkeep->update &= ~(PU_SPELLS);
-		calc_spells(p);
-	}
+static void update_flow(struct player *p)
+{
+	cave_update_flow(cave);
+}
 
-	/* Character is not ready yet, no map updates */
-	if (!character_generated) return;
+static void update_distance(struct player *p)
+{
+	update_monsters(TRUE);
+}
 
-	/* Map is not shown, no map updates */
-	if (!map_is_visible()) return;
+static void update_monsters_aux(struct player *p)
+{
+	update_monsters(FALSE);
+}
 
-	if (p->upkeep->update & (PU_FORGET_VIEW)) {
-		p->upkeep->update &= ~(PU_FORGET_VIEW);
-		forget_view(cave);
-	}
+static void update_panel(struct player *p)
+{
+	event_signal(EVENT_PLAYERMOVED);
+}
 
-	if (p->upkeep->update & (PU_UPDATE_VIEW)) {
-		p->upkeep->update &= ~(PU_UPDATE_VIEW);
-		update_view(cave, p);
-	}
+struct flag_update
+{
+	u32b flag;				/* The PU_* flag handled */
+	u32b clears;			/* Other flags the handler takes care of */
+	u32b raises;			/* Flags the handler may set */
+	bool map;				/* Only done with the map shown */
+	int phase;				/* Turn profiler phase to charge */
+	void (*update)(struct player *p);
+};
 
+/**
+ * The updates, in the order they are done.  An update may only raise the
+ * flags of those after it, so one pass over the table does everything
+ * asked for; update_stuff() checks that this holds.
+ */
+static const struct flag_update updates[] =
+{
+	{ PU_INVEN, 0, 0, FALSE, TURN_PHASE_INVEN, update_inventory },
+	{ PU_BONUS, 0, PU_HP | PU_MANA | PU_SPELLS | PU_UPDATE_VIEW | PU_MONSTERS,
+	  FALSE, TURN_PHASE_BONUS, update_bonuses },
+	{ PU_TORCH, 0, PU_UPDATE_VIEW | PU_MONSTERS, FALSE, TURN_PHASE_STUFF,
+	  update_torch },
+	{ PU_HP, 0, 0, FALSE, TURN_PHASE_STUFF, calc_hitpoints },
+	{ PU_MANA, 0, 0, FALSE, TURN_PHASE_STUFF, update_mana },
+	{ PU_SPELLS, 0, 0, FALSE, TURN_PHASE_STUFF, calc_spells },
+
+	/* Map updates wait until the character is ready and the map shown */
+	{ PU_FORGET_VIEW, 0, 0, TRUE, TURN_PHASE_STUFF, update_forget_view },
+	{ PU_UPDATE_VIEW, 0, 0, TRUE, TURN_PHASE_VIEW, update_view_aux },
+	{ PU_FORGET_FLOW, 0, 0, TRUE, TURN_PHASE_STUFF, update_forget_flow },
+	{ PU_UPDATE_FLOW, 0, 0, TRUE, TURN_PHASE_FLOW, update_flow },
+	{ PU_DISTANCE, PU_MONSTERS, 0, TRUE, TURN_PHASE_UPDATE_MONSTERS,
+	  update_distance },
+	{ PU_MONSTERS, 0, 0, TRUE, TURN_PHASE_UPDATE_MONSTERS,
+	  update_monsters_aux },
+	{ PU_PANEL, 0, 0, TRUE, TURN_PHASE_STUFF, update_panel },
+};
 
-	if (p->upkeep->update & (PU_FORGET_FLOW)) {
-		p->upkeep->update &= ~(PU_FORGET_FLOW);
-		cave_forget_flow(cave);
-	}
+/**
+ * Handle "player->upkeep->update"
+ */
+void update_stuff(struct player *p)
+{
+	u32b done = 0;
+	size_t i;
 
-	if (p->upkeep->update & (PU_UPDATE_FLOW)) {
-		p->upkeep->update &= ~(PU_UPDATE_FLOW);
-		cave_update_flow(cave);
-	}
+	/* Update stuff */
+	if (!p->upkeep->update) return;
 
+	for (i = 0; i < N_ELEMENTS(updates); i++) {
+		const struct flag_update *u = &updates[i];
 
-	if (p->upkeep->update & (PU_DISTANCE)) {
-		p->upkeep->update &= ~(PU_DISTANCE);
-		p->upkeep->update &= ~(PU_MONSTERS);
-		update_monsters(TRUE);
-	}
+		/* Nothing raises an update that has already had its turn */
+		done |= u->flag;
+		assert(!(u->raises & done));
 
-	if (p->upkeep->update & (PU_MONSTERS)) {
-		p->upkeep->update &= ~(PU_MONSTERS);
-		update_monsters(FALSE);
-	}
+		if (!(p->upkeep->update & u->flag)) continue;
 
+		/* Character is not ready yet, or map is not shown: no map updates */
+		if (u->map && (!character_generated || !map_is_visible())) return;
 
-	if (p->upkeep->update & (PU_PANEL)) {
-		p->upkeep->update &= ~(PU_PANEL);
-		event_signal(EVENT_PLAYERMOVED);
+		p->upkeep->update &= ~(u->flag | u->clears);
+		TURN_PROF(u->phase, u->update(p));
 	}
 }
 
@@ -2490,6 +2524,12 @@ void redraw_stuff(struct player *p)
 	/* Redraw stuff */
 	if (!p->upkeep->redraw) return;
 
+	/* No display at all, nothing to redraw */
+	if (event_headless()) {
+		p->upkeep->redraw = 0;
+		return;
+	}
+
 	/* Character is not ready yet, no screen updates */
 	if (!character_generated) return;
 
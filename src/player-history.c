@@ -27,12 +27,28 @@
 
 /**
  * Number of slots available at birth in the player history list.  Defaults to
- * 10 and will expand automatically as new history entries are added, up the
+ * 10 and will double automatically as new history entries are added, up the
  * the maximum defined value.
  */
 #define HISTORY_BIRTH_SIZE  10
 #define HISTORY_MAX 5000
 
+/**
+ * Number of distinct artifact indices a history entry can refer to (a_idx is
+ * stored as a byte).
+ */
+#define HISTORY_ART_MAX 256
+
+
+/**
+ * Per-artifact summary of the history list, kept in step with every change to
+ * an entry so that artifact queries don't have to scan the whole list.
+ */
+struct history_art {
+	size_t last;		/* 1 + index of the latest entry, or 0 if none */
+	int known;			/* Entries marked HIST_ARTIFACT_KNOWN */
+	int logged;			/* Entries not marked HIST_ARTIFACT_LOST */
+};
 
 
 /* The historical list for the character */
@@ -44,6 +60,9 @@ static size_t history_ctr;
 /* Current size of history list */
 static size_t history_size;
 
+/* Artifact index into the history list */
+static struct history_art history_arts[HISTORY_ART_MAX];
+
 /**
  * Initialise an empty history list.
  */
@@ -52,6 +71,7 @@ static void history_init(size_t entries)
 	history_ctr = 0;
 	history_size = entries;
 	history_list = mem_zalloc(history_size * sizeof(struct history_info));
+	memset(history_arts, 0, sizeof(history_arts));
 }
 
 
@@ -66,6 +86,7 @@ void history_clear(void)
 	history_list = NULL;
 	history_ctr = 0;
 	history_size = 0;
+	memset(history_arts, 0, sizeof(history_arts));
 }
 
 
@@ -88,6 +109,31 @@ static bool history_set_num(size_t num)
 }
 
 
+/**
+ * Add (`sign` = 1) or remove (`sign` = -1) entry `i` from the artifact counts.
+ */
+static void history_count(size_t i, int sign)
+{
+	struct history_art *art = &history_arts[history_list[i].a_idx];
+
+	if (hist_has(history_list[i].type, HIST_ARTIFACT_KNOWN))
+		art->known += sign;
+	if (!hist_has(history_list[i].type, HIST_ARTIFACT_LOST))
+		art->logged += sign;
+}
+
+
+/**
+ * Replace the type flags of entry `i`, keeping the artifact index up to date.
+ */
+static void history_set_type(size_t i, const bitflag *type)
+{
+	history_count(i, -1);
+	hist_copy(history_list[i].type, type);
+	history_count(i, 1);
+}
+
+
 /**
  * Return the number of history entries.
  */
@@ -102,15 +148,16 @@ size_t history_get_num(void)
  */
 static bool history_know_artifact(struct artifact *artifact)
 {
-	size_t i = history_ctr;
+	size_t last;
 	assert(artifact);
 
-	while (i--) {
-		if (history_list[i].a_idx == artifact->aidx) {
-			hist_wipe(history_list[i].type);
-			hist_on(history_list[i].type, HIST_ARTIFACT_KNOWN);
-			return TRUE;
-		}
+	last = history_arts[artifact->aidx].last;
+	if (last) {
+		bitflag type[HIST_SIZE];
+		hist_wipe(type);
+		hist_on(type, HIST_ARTIFACT_KNOWN);
+		history_set_type(last - 1, type);
+		return TRUE;
 	}
 
 	return FALSE;
@@ -123,14 +170,16 @@ static bool history_know_artifact(struct artifact *artifact)
  */
 bool history_lose_artifact(struct artifact *artifact)
 {
-	size_t i = history_ctr;
+	size_t last;
 	assert(artifact);
 
-	while (i--) {
-		if (history_list[i].a_idx == artifact->aidx) {
-			hist_on(history_list[i].type, HIST_ARTIFACT_LOST);
-			return TRUE;
-		}
+	last = history_arts[artifact->aidx].last;
+	if (last) {
+		bitflag type[HIST_SIZE];
+		hist_copy(type, history_list[last - 1].type);
+		hist_on(type, HIST_ARTIFACT_LOST);
+		history_set_type(last - 1, type);
+		return TRUE;
 	}
 
 	/* If we lost an artifact that didn't previously have a history, then we
@@ -151,11 +200,12 @@ bool history_lose_artifact(struct artifact *artifact)
 bool history_add_full(bitflag *type, struct artifact *artifact, s16b dlev,
 		s16b clev, s32b turnno, const char *text)
 {
-	/* Allocate or expand the history list as needed */
+	/* Allocate or expand the history list as needed, doubling its size so
+	 * that appends are cheap however long the history gets */
 	if (!history_list)
 		history_init(HISTORY_BIRTH_SIZE);
 	else if ((history_ctr == history_size) &&
-			 !history_set_num(history_size + 10))
+			 !history_set_num(history_size * 2))
 		return FALSE;
 
 	/* History list exists and is not full.  Add an entry at the current
@@ -168,6 +218,10 @@ bool history_add_full(bitflag *type, struct artifact *artifact, s16b dlev,
 	my_strcpy(history_list[history_ctr].event,
 	          text, sizeof(history_list[history_ctr].event));
 
+	/* Index the new entry */
+	history_count(history_ctr, 1);
+	history_arts[history_list[history_ctr].a_idx].last = history_ctr + 1;
+
 	history_ctr++;
 
 	return TRUE;
@@ -196,16 +250,8 @@ bool history_add(const char *event, int type, struct artifact *artifact)
  */
 bool history_is_artifact_known(struct artifact *artifact)
 {
-	size_t i = history_ctr;
 	assert(artifact);
-
-	while (i--) {
-		if (hist_has(history_list[i].type, HIST_ARTIFACT_KNOWN) &&
-				history_list[i].a_idx == artifact->aidx)
-			return TRUE;
-	}
-
-	return FALSE;
+	return history_arts[artifact->aidx].known > 0;
 }
 
 
@@ -217,20 +263,11 @@ bool history_is_artifact_known(struct artifact *artifact)
  */
 static bool history_is_artifact_logged(struct artifact *artifact)
 {
-	size_t i = history_ctr;
 	assert(artifact);
 
-	while (i--) {
-		/* Don't count ARTIFACT_LOST entries; then we can handle
-		 * re-finding previously lost artifacts in preserve mode  */
-		if (hist_has(history_list[i].type, HIST_ARTIFACT_LOST))
-			continue;
-
-		if (history_list[i].a_idx == artifact->aidx)
-			return TRUE;
-	}
-
-	return FALSE;
+	/* Don't count ARTIFACT_LOST entries; then we can handle
+	 * re-finding previously lost artifacts in preserve mode  */
+	return history_arts[artifact->aidx].logged > 0;
 }
 
 
@@ -294,8 +331,11 @@ void history_unmask_unknown(void)
 
 	while (i--) {
 		if (hist_has(history_list[i].type, HIST_ARTIFACT_UNKNOWN)) {
-			hist_off(history_list[i].type, HIST_ARTIFACT_UNKNOWN);
-			hist_on(history_list[i].type, HIST_ARTIFACT_KNOWN);
+			bitflag type[HIST_SIZE];
+			hist_copy(type, history_list[i].type);
+			hist_off(type, HIST_ARTIFACT_UNKNOWN);
+			hist_on(type, HIST_ARTIFACT_KNOWN);
+			history_set_type(i, type);
 		}
 	}
 }
@@ -34,21 +34,37 @@
  * ------------------------------------------------------------------------ */
 
 /**
- * Maximum size around the player to consider in the pathfinder
+ * Extra cost of stepping onto a known trap, so that paths go round them
+ * where there is a reasonable way round
  */
-#define MAX_PF_RADIUS 50
+#define PF_TRAP_COST 20
 
 /**
- * Maximum distance to consider in the pathfinder
+ * Marks an open-list position for a grid which has been closed
  */
-#define MAX_PF_LENGTH 250
+#define PF_CLOSED -1
 
-
-static int terrain[MAX_PF_RADIUS][MAX_PF_RADIUS];
-static char pf_result[MAX_PF_LENGTH];
+/**
+ * The working storage for the pathfinder, which is kept from one search to
+ * the next and only grows when a larger level is met.  A grid's entries are
+ * only meaningful if its search number is that of the current search, so
+ * nothing needs clearing between searches.
+ */
+static struct {
+	int size;       /* Number of grids there is room for */
+	u32b search;    /* Number of the current search */
+	u32b *seen;     /* Search which last reached each grid */
+	int *cost;      /* Cost of the best path found to each grid */
+	int *score;     /* That cost plus the estimate to the target */
+	int *pos;       /* Place in the open list, or PF_CLOSED */
+	byte *step;     /* Direction of the last step of that path */
+	int *heap;      /* The open list, as a binary heap on score */
+	int heap_len;
+} pf;
+
+static char *pf_result;
 static int pf_result_index;
 
-static int ox, oy, ex, ey;
 static int dir_search[8] = {2,4,6,8,1,3,7,9};
 
 
@@ -61,109 +77,196 @@ static bool is_valid_pf(int y, int x)
 	return (square_ispassable(cave, y, x));
 }
 
-static void fill_terrain_info(void)
+/**
+ * Make sure the pathfinder has room for the current level
+ */
+static void pf_reserve(int size)
 {
-	int i, j;
-
-	ox = MAX(player->px - MAX_PF_RADIUS / 2, 0);
-	oy = MAX(player->py - MAX_PF_RADIUS / 2, 0);
-
-	ex = MIN(player->px + MAX_PF_RADIUS / 2 - 1, cave->width);
-	ey = MIN(player->py + MAX_PF_RADIUS / 2 - 1, cave->height);
+	if (size <= pf.size) return;
+
+	pathfind_cleanup();
+	pf.size = size;
+	pf.seen = mem_zalloc(size * sizeof(u32b));
+	pf.cost = mem_alloc(size * sizeof(int));
+	pf.score = mem_alloc(size * sizeof(int));
+	pf.pos = mem_alloc(size * sizeof(int));
+	pf.step = mem_alloc(size * sizeof(byte));
+	pf.heap = mem_alloc(size * sizeof(int));
+	pf_result = mem_alloc(size * sizeof(char));
+}
 
-	for (i = 0; i < MAX_PF_RADIUS * MAX_PF_RADIUS; i++)
-		terrain[0][i] = -1;
+/**
+ * Free the pathfinder's working storage
+ */
+void pathfind_cleanup(void)
+{
+	mem_free(pf.seen);
+	mem_free(pf.cost);
+	mem_free(pf.score);
+	mem_free(pf.pos);
+	mem_free(pf.step);
+	mem_free(pf.heap);
+	mem_free(pf_result);
+	memset(&pf, 0, sizeof(pf));
+	pf_result = NULL;
+	pf_result_index = -1;
+}
 
-	for (j = oy; j < ey; j++)
-		for (i = ox; i < ex; i++)
-			if (is_valid_pf(j, i))
-				terrain[j - oy][i - ox] = MAX_PF_LENGTH;
+/**
+ * Swap two entries of the open list
+ */
+static void pf_heap_swap(int i, int j)
+{
+	int grid = pf.heap[i];
 
-	terrain[player->py - oy][player->px - ox] = 1;
+	pf.heap[i] = pf.heap[j];
+	pf.heap[j] = grid;
+	pf.pos[pf.heap[i]] = i;
+	pf.pos[pf.heap[j]] = j;
 }
 
-#define MARK_DISTANCE(c,d) if ((c <= MAX_PF_LENGTH) && (c > d)) \
-							{ c = d; try_again = (TRUE); }
+/**
+ * Move an entry of the open list up towards the top until it is in order
+ */
+static void pf_heap_up(int i)
+{
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		if (pf.score[pf.heap[parent]] <= pf.score[pf.heap[i]]) break;
+		pf_heap_swap(i, parent);
+		i = parent;
+	}
+}
 
-bool findpath(int y, int x)
+/**
+ * Take the grid with the best score off the open list
+ */
+static int pf_heap_pop(void)
 {
-	int i, j, k;
-	int dir = 10;
-	bool try_again;
-	int cur_distance;
+	int top = pf.heap[0];
+	int i = 0;
 
-	fill_terrain_info();
+	pf.heap_len--;
+	if (pf.heap_len) {
+		pf.heap[0] = pf.heap[pf.heap_len];
+		pf.pos[pf.heap[0]] = 0;
+	}
 
-	terrain[player->py - oy][player->px - ox] = 1;
+	/* Move the new top down until it is in order */
+	while (TRUE) {
+		int best = i;
+		int left = 2 * i + 1, right = 2 * i + 2;
+
+		if (left < pf.heap_len &&
+			pf.score[pf.heap[left]] < pf.score[pf.heap[best]])
+			best = left;
+		if (right < pf.heap_len &&
+			pf.score[pf.heap[right]] < pf.score[pf.heap[best]])
+			best = right;
+		if (best == i) break;
+
+		pf_heap_swap(i, best);
+		i = best;
+	}
 
-	if ((x >= ox) && (x < ex) && (y >= oy) && (y < ey)) {
-		if ((cave->squares[y][x].mon > 0) &&
-			mflag_has(square_monster(cave, y, x)->mflag, MFLAG_VISIBLE))
-			terrain[y - oy][x - ox] = MAX_PF_LENGTH;
+	pf.pos[top] = PF_CLOSED;
+	return top;
+}
 
-		terrain[y - oy][x - ox] = MAX_PF_LENGTH;
-	} else {
+/**
+ * Find a path from the player to the given grid, anywhere on the level, by
+ * an A* search.  Steps may go in any of the eight directions at the same
+ * cost, so the estimate of the cost to the target is the larger of the
+ * row and column distances, which never overestimates it.
+ *
+ * Grids the player doesn't know about are assumed to be open, so clicking
+ * on unexplored parts of the map heads that way; known traps are avoided
+ * unless going round them would be a long way.
+ *
+ * On success, the steps are left in pf_result[], last step first, for
+ * run_step() to take one at a time.
+ */
+bool findpath(int y, int x)
+{
+	int w = cave->width;
+	int start = player->py * w + player->px;
+	int target = y * w + x;
+	int i, grid;
+
+	if (!square_in_bounds(cave, y, x)) {
 		bell("Target out of range.");
 		return (FALSE);
 	}
 
-	/* 
-	 * And now starts the very naive and very 
-	 * inefficient pathfinding algorithm
-	 */
-	do {
-		try_again = FALSE;
-
-		for (j = oy + 1; j < ey - 1; j++) {
-			for (i = ox + 1; i < ex - 1; i++) {
-				cur_distance = terrain[j - oy][i - ox] + 1;
-
-				if ((cur_distance > 0) && (cur_distance < MAX_PF_LENGTH)) {
-					for (dir = 1; dir < 10; dir++) {
-						int next_y, next_x;
-						if (dir == 5)
-							dir++;
-						next_y = j - oy + ddy[dir];
-						next_x = i - ox + ddx[dir];
-
-						MARK_DISTANCE(terrain[next_y][next_x], cur_distance);
-					}
-				}
-			}
-		}
+	pf_reserve(cave->height * w);
 
-		if (terrain[y - oy][x - ox] < MAX_PF_LENGTH)
-			try_again = FALSE;
+	/* Start a new search, clearing out old searches when the numbers wrap */
+	if (++pf.search == 0) {
+		memset(pf.seen, 0, pf.size * sizeof(u32b));
+		pf.search = 1;
+	}
 
+	/* Put the player grid on the open list */
+	pf.seen[start] = pf.search;
+	pf.cost[start] = 0;
+	pf.score[start] = MAX(ABS(y - player->py), ABS(x - player->px));
+	pf.heap[0] = start;
+	pf.pos[start] = 0;
+	pf.heap_len = 1;
+
+	while (pf.heap_len) {
+		int gy, gx;
+
+		grid = pf_heap_pop();
+		if (grid == target) break;
+
+		gy = grid / w;
+		gx = grid % w;
+
+		for (i = 0; i < 8; i++) {
+			int dir = dir_search[i];
+			int ny = gy + ddy[dir];
+			int nx = gx + ddx[dir];
+			int next = ny * w + nx;
+			int cost;
+
+			if (!square_in_bounds(cave, ny, nx)) continue;
+			if ((next != target) && !is_valid_pf(ny, nx)) continue;
+
+			cost = pf.cost[grid] + 1;
+			if (square_ismark(cave, ny, nx) && square_isknowntrap(cave, ny, nx))
+				cost += PF_TRAP_COST;
+
+			if (pf.seen[next] == pf.search) {
+				/* Closed grids already have their best path */
+				if ((pf.pos[next] == PF_CLOSED) || (pf.cost[next] <= cost))
+					continue;
+			} else {
+				/* A new grid */
+				pf.seen[next] = pf.search;
+				pf.pos[next] = pf.heap_len;
+				pf.heap[pf.heap_len++] = next;
+			}
+
+			pf.cost[next] = cost;
+			pf.score[next] = cost + MAX(ABS(y - ny), ABS(x - nx));
+			pf.step[next] = dir;
+			pf_heap_up(pf.pos[next]);
+		}
 	}
-	while (try_again) ;
 
 	/* Failure */
-	if (terrain[y - oy][x - ox] == MAX_PF_LENGTH) {
+	if ((pf.seen[target] != pf.search) || (pf.pos[target] != PF_CLOSED)) {
 		bell("Target space unreachable.");
 		return (FALSE);
 	}
 
-	/* Success */
-	i = x;
-	j = y;
-
+	/* Success, so read the path back from the target */
 	pf_result_index = 0;
-
-	while ((i != player->px) || (j != player->py)) {
-		cur_distance = terrain[j - oy][i - ox] - 1;
-		for (k = 0; k < 8; k++) {
-			dir = dir_search[k];
-			if (terrain[j - oy + ddy[dir]][i - ox + ddx[dir]] == cur_distance)
-				break;
-		}
-
-		/* Should never happen */
-		assert ((dir != 10) && (dir != 5));
-
-		pf_result[pf_result_index++] = '0' + (char)(10 - dir);
-		i += ddx[dir];
-		j += ddy[dir];
+	for (grid = target; grid != start; ) {
+		int dir = pf.step[grid];
+		pf_result[pf_result_index++] = '0' + (char)dir;
+		grid -= ddy[dir] * w + ddx[dir];
 	}
 
 	pf_result_index--;
@@ -171,6 +274,16 @@ bool findpath(int y, int x)
 	return (TRUE);
 }
 
+/**
+ * Get the direction of the nth step still to be taken along the path from
+ * the last findpath(), counting from 0, or DIR_NONE if the path is shorter
+ */
+int pathfind_step(int n)
+{
+	if ((n < 0) || (n > pf_result_index)) return DIR_NONE;
+	return pf_result[pf_result_index - n] - '0';
+}
+
 /**
  * Compute the direction (in the angband 123456789 sense) from a point to a
  * point. We decide to use diagonals if dx and dy are within a factor of two of
@@ -522,6 +635,9 @@ static bool run_test(void)
 	int i, max, inv;
 	int option, option2;
 
+	/* Whether each newly adjacent grid seems open, indexed by i + max */
+	bool open[5];
+
 
 	/* No options yet */
 	option = 0;
@@ -575,7 +691,8 @@ static bool run_test(void)
 		}
 
 		/* Analyze unknown grids and floors */
-		if (inv || square_ispassable(cave, row, col)) {
+		open[i + max] = inv || square_ispassable(cave, row, col);
+		if (open[i + max]) {
 			/* Looking for open area */
 			if (run_open_area) {
 				/* Nothing */
@@ -636,17 +753,10 @@ static bool run_test(void)
 
 	/* Looking for open area */
 	if (run_open_area) {
-		/* Hack -- look again */
+		/* Hack -- look again, at what was seen of the newly adjacent grids */
 		for (i = -max; i < 0; i++) {
-			new_dir = cycle[chome[prev_dir] + i];
-
-			row = py + ddy[new_dir];
-			col = px + ddx[new_dir];
-
 			/* Unknown grid or non-wall */
-			/* Was: square_ispassable(cave, row, col) */
-			if (!square_ismark(cave, row, col) ||
-			    (square_ispassable(cave, row, col))) {
+			if (open[i + max]) {
 				/* Looking to break right */
 				if (run_break_right) {
 					return (TRUE);
@@ -659,17 +769,10 @@ static bool run_test(void)
 			}
 		}
 
-		/* Hack -- look again */
+		/* Hack -- look again, at what was seen of the newly adjacent grids */
 		for (i = max; i > 0; i--) {
-			new_dir = cycle[chome[prev_dir] + i];
-
-			row = py + ddy[new_dir];
-			col = px + ddx[new_dir];
-
 			/* Unknown grid or non-wall */
-			/* Was: square_ispassable(cave, row, col) */
-			if (!square_ismark(cave, row, col) ||
-			    (square_ispassable(cave, row, col))) {
+			if (open[i + max]) {
 				/* Looking to break left */
 				if (run_break_left) {
 					return (TRUE);
@@ -24,6 +24,8 @@
 
 int pathfind_direction_to(struct loc from, struct loc to);
 bool findpath(int y, int x);
+int pathfind_step(int n);
+void pathfind_cleanup(void);
 void run_step(int dir);
 
 #endif /* !PLAYER_PATH_H */
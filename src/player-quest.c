@@ -211,8 +211,8 @@ static void build_quest_stairs(int y, int x)
 	/* Update the visuals */
 	player->upkeep->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
 
-	/* Fully update the flow */
-	player->upkeep->update |= (PU_FORGET_FLOW | PU_UPDATE_FLOW);
+	/* Update the flow, which repairs itself for the changed grid */
+	player->upkeep->update |= (PU_UPDATE_FLOW);
 }
 
 /**
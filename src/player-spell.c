@@ -147,6 +147,7 @@ void player_spells_free(struct player *p)
 {
 	mem_free(p->spell_flags);
 	mem_free(p->spell_order);
+	spell_cache_invalidate();
 }
 
 /**
@@ -288,52 +289,109 @@ int min_fail(struct player *p)
 	return adj_mag_fail[player->state.stat_ind[stat]];
 }
 
+/**
+ * What spell_chance() and get_spell_info() found for one spell.  Both only
+ * change with the player's bonuses, spells or level, so the results are
+ * kept until spell_cache_invalidate() is called by the PU_BONUS and
+ * PU_SPELLS updates (which a change of level raises).
+ */
+struct spell_cache_entry {
+	bool chance_known;
+	s16b chance;		/* Failure rate before mana, stun and amnesia */
+	bool info_known;
+	char info[80];
+};
+
+static struct spell_cache_entry *spell_cache;
+static const struct player_class *spell_cache_class;
+static int spell_cache_lev;
+static int spell_cache_minfail;
+
+/**
+ * Forget all the cached spell failure rates and descriptions
+ */
+void spell_cache_invalidate(void)
+{
+	mem_free(spell_cache);
+	spell_cache = NULL;
+}
+
+/**
+ * Get the cache entry for a spell, starting a new cache if the old one
+ * belongs to a different class or level
+ */
+static struct spell_cache_entry *spell_cache_get(int spell)
+{
+	if (spell_cache && (spell_cache_class != player->class ||
+						spell_cache_lev != player->lev))
+		spell_cache_invalidate();
+
+	if (!spell_cache) {
+		spell_cache = mem_zalloc(player->class->magic.total_spells *
+								 sizeof(*spell_cache));
+		spell_cache_class = player->class;
+		spell_cache_lev = player->lev;
+
+		/* Extract the minimum failure rate due to realm */
+		spell_cache_minfail = min_fail(player);
+
+		/* Non mage/priest characters never get better than 5 percent */
+		if (!player_has(player, PF_ZERO_FAIL) && spell_cache_minfail < 5)
+			spell_cache_minfail = 5;
+	}
+
+	return &spell_cache[spell];
+}
+
 /**
  * Returns chance of failure for a spell
  */
 s16b spell_chance(int spell)
 {
-	int chance, minfail;
+	int chance;
 
 	const class_spell *s_ptr;
+	struct spell_cache_entry *cached;
 
 	/* Paranoia -- must be literate */
 	if (player->class->magic.total_spells == 0) return (100);
 
 	/* Get the spell */
 	s_ptr = spell_by_index(spell);
+	cached = spell_cache_get(spell);
 
-	/* Extract the base spell failure rate */
-	chance = s_ptr->sfail;
+	if (!cached->chance_known) {
+		/* Extract the base spell failure rate */
+		chance = s_ptr->sfail;
 
-	/* Reduce failure rate by "effective" level adjustment */
-	chance -= 3 * (player->lev - s_ptr->slevel);
+		/* Reduce failure rate by "effective" level adjustment */
+		chance -= 3 * (player->lev - s_ptr->slevel);
 
-	/* Reduce failure rate by realm adjustment */
-	chance -= fail_adjust(player);
+		/* Reduce failure rate by realm adjustment */
+		chance -= fail_adjust(player);
 
-	/* Not enough mana to cast */
-	if (s_ptr->smana > player->csp)
-		chance += 5 * (s_ptr->smana - player->csp);
+		/* Priest prayer penalty for "edged" weapons (before minfail) */
+		if (player->state.icky_wield)
+			chance += 25;
 
-	/* Extract the minimum failure rate due to realm */
-	minfail = min_fail(player);
+		/* Fear makes spells harder (before minfail) */
+		/* Note that spells that remove fear have a much lower fail rate
+		 * than surrounding spells, to make sure this doesn't cause mega
+		 * fail */
+		if (player_of_has(player, OF_AFRAID)) chance += 20;
 
-	/* Non mage/priest characters never get better than 5 percent */
-	if (!player_has(player, PF_ZERO_FAIL) && minfail < 5)
-		minfail = 5;
+		cached->chance = chance;
+		cached->chance_known = TRUE;
+	}
 
-	/* Priest prayer penalty for "edged" weapons (before minfail) */
-	if (player->state.icky_wield)
-		chance += 25;
+	chance = cached->chance;
 
-	/* Fear makes spells harder (before minfail) */
-	/* Note that spells that remove fear have a much lower fail rate than
-	 * surrounding spells, to make sure this doesn't cause mega fail */
-	if (player_of_has(player, OF_AFRAID)) chance += 20;
+	/* Not enough mana to cast */
+	if (s_ptr->smana > player->csp)
+		chance += 5 * (s_ptr->smana - player->csp);
 
 	/* Minimal and maximal failure rate */
-	if (chance < minfail) chance = minfail;
+	if (chance < spell_cache_minfail) chance = spell_cache_minfail;
 	if (chance > 50) chance = 50;
 
 	/* Stunning makes spells harder (after minfail) */
@@ -554,10 +612,24 @@ static void spell_append_value_info(int spell, char *p, size_t len)
 
 void get_spell_info(int spell, char *p, size_t len)
 {
+	struct spell_cache_entry *cached;
+
 	/* Blank 'p' first */
 	p[0] = '\0';
 
-	spell_append_value_info(spell, p, len);
+	/* Values that depend on a monster's level can't be kept */
+	if (ref_race || (cave && cave->mon_current > 0)) {
+		spell_append_value_info(spell, p, len);
+		return;
+	}
+
+	cached = spell_cache_get(spell);
+	if (!cached->info_known) {
+		spell_append_value_info(spell, cached->info, sizeof(cached->info));
+		cached->info_known = TRUE;
+	}
+
+	my_strcpy(p, cached->info, len);
 }
 
 static int spell_value_base_monster_level(void)
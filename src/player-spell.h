@@ -18,6 +18,7 @@
 
 void player_spells_init(struct player *p);
 void player_spells_free(struct player *p);
+void spell_cache_invalidate(void);
 const class_book *object_to_book(const struct object *obj);
 const class_spell *spell_by_index(int index);
 int spell_collect_from_book(const object_type *o_ptr, int **spells);
@@ -815,7 +815,8 @@ void player_place(struct chunk *c, struct player *p, int y, int x)
 	p->px = x;
 
 	/* Mark cave grid */
-	c->squares[y][x].mon = -1;
+	square_set_mon(c, y, x, -1);
+	cave_occupant_stamp++;
 
 	/* Clear stair creation */
 	p->upkeep->create_down_stair = FALSE;
@@ -201,8 +201,8 @@ static void project_feature_handler_KILL_WALL(project_feature_handler_context_t
 	/* Update the visuals */
 	player->upkeep->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
 
-	/* Fully update the flow */
-	player->upkeep->update |= (PU_FORGET_FLOW | PU_UPDATE_FLOW);
+	/* Update the flow, which repairs itself for the changed grid */
+	player->upkeep->update |= (PU_UPDATE_FLOW);
 }
 
 /* Destroy Doors (and traps) */
@@ -69,6 +69,91 @@ static monster_race *poly_race(monster_race *race)
 	return race;
 }
 
+/**
+ * ------------------------------------------------------------------------
+ * Monster defences
+ * ------------------------------------------------------------------------ */
+
+/**
+ * The race properties each projection type cares about, in the order the
+ * handler below checks them.  A race's defence against a type is the number
+ * of the first test it passes, or zero if it passes none; they are worked out
+ * once at startup by project_m_defences().
+ */
+struct monster_defence_test {
+	bool spell;		/* flag is an RSF_ flag, rather than an RF_ one */
+	int flag;
+};
+
+#define MONSTER_DEFENCE_TESTS 3
+
+static const struct monster_defence_test
+monster_defence_tests[GF_MAX][MONSTER_DEFENCE_TESTS] = {
+	[GF_ACID] = {{FALSE, RF_IM_ACID}},
+	[GF_ELEC] = {{FALSE, RF_IM_ELEC}},
+	[GF_FIRE] = {{FALSE, RF_IM_FIRE}, {FALSE, RF_HURT_FIRE}},
+	[GF_COLD] = {{FALSE, RF_IM_COLD}, {FALSE, RF_HURT_COLD}},
+	[GF_POIS] = {{FALSE, RF_IM_POIS}},
+	[GF_LIGHT] = {{TRUE, RSF_BR_LIGHT}, {FALSE, RF_HURT_LIGHT}},
+	[GF_DARK] = {{TRUE, RSF_BR_DARK}},
+	[GF_SOUND] = {{TRUE, RSF_BR_SOUN}},
+	[GF_SHARD] = {{TRUE, RSF_BR_SHAR}},
+	[GF_NEXUS] = {{FALSE, RF_IM_NEXUS}},
+	[GF_NETHER] = {{FALSE, RF_UNDEAD}, {FALSE, RF_IM_NETHER},
+				   {FALSE, RF_EVIL}},
+	[GF_CHAOS] = {{TRUE, RSF_BR_CHAO}},
+	[GF_DISEN] = {{FALSE, RF_IM_DISEN}},
+	[GF_WATER] = {{FALSE, RF_IM_WATER}},
+	[GF_ICE] = {{FALSE, RF_IM_COLD}, {FALSE, RF_HURT_COLD}},
+	[GF_GRAVITY] = {{TRUE, RSF_BR_GRAV}},
+	[GF_INERTIA] = {{TRUE, RSF_BR_INER}},
+	[GF_FORCE] = {{TRUE, RSF_BR_WALL}},
+	[GF_TIME] = {{TRUE, RSF_BR_TIME}},
+	[GF_PLASMA] = {{FALSE, RF_IM_PLASMA}},
+	[GF_HOLY_ORB] = {{FALSE, RF_EVIL}},
+	[GF_LIGHT_WEAK] = {{FALSE, RF_HURT_LIGHT}},
+	[GF_KILL_WALL] = {{FALSE, RF_HURT_ROCK}},
+	[GF_AWAY_UNDEAD] = {{FALSE, RF_UNDEAD}},
+	[GF_AWAY_EVIL] = {{FALSE, RF_EVIL}},
+	[GF_TURN_UNDEAD] = {{FALSE, RF_UNDEAD}},
+	[GF_TURN_EVIL] = {{FALSE, RF_EVIL}},
+	[GF_DISP_UNDEAD] = {{FALSE, RF_UNDEAD}},
+	[GF_DISP_EVIL] = {{FALSE, RF_EVIL}},
+	[GF_OLD_DRAIN] = {{FALSE, RF_DEMON}, {FALSE, RF_UNDEAD},
+					  {FALSE, RF_NONLIVING}},
+};
+
+/**
+ * Fill in a race's defence against every projection type
+ *
+ * \param race is the monster race.
+ * \param defences has room for GF_MAX entries.
+ */
+void project_m_defences(const struct monster_race *race, byte *defences)
+{
+	int typ, i;
+
+	for (typ = 0; typ < GF_MAX; typ++) {
+		defences[typ] = 0;
+		for (i = 0; i < MONSTER_DEFENCE_TESTS; i++) {
+			const struct monster_defence_test *test =
+				&monster_defence_tests[typ][i];
+			bool passed;
+
+			if (!test->flag) break;
+			if (test->spell)
+				passed = rsf_has(race->spell_flags, test->flag);
+			else
+				passed = rf_has(race->flags, test->flag);
+
+			if (passed) {
+				defences[typ] = i + 1;
+				break;
+			}
+		}
+	}
+}
+
 /**
  * ------------------------------------------------------------------------
  * Monster handlers
@@ -93,6 +178,7 @@ typedef struct project_monster_handler_context_s {
 	enum mon_messages hurt_msg;
 	enum mon_messages die_msg;
 	int mon_timed[MON_TMD_MAX];
+	int defence; /* The race's defence against this type, see above */
 } project_monster_handler_context_t;
 typedef void (*project_monster_handler_f)(project_monster_handler_context_t *);
 
@@ -109,7 +195,7 @@ typedef void (*project_monster_handler_f)(project_monster_handler_context_t *);
 static void project_monster_resist_element(project_monster_handler_context_t *context, int flag, int factor)
 {
 	if (context->seen) rf_on(context->l_ptr->flags, flag);
-	if (rf_has(context->m_ptr->race->flags, flag)) {
+	if (context->defence == 1) {
 		context->hurt_msg = MON_MSG_RESIST_A_LOT;
 		context->dam /= factor;
 	}
@@ -132,7 +218,7 @@ static void project_monster_resist_element(project_monster_handler_context_t *co
 static void project_monster_resist_other(project_monster_handler_context_t *context, int flag, int factor, bool reduce, enum mon_messages msg)
 {
 	if (context->seen) rf_on(context->l_ptr->flags, flag);
-	if (rf_has(context->m_ptr->race->flags, flag)) {
+	if (context->defence == 1) {
 		context->hurt_msg = msg;
 		context->dam *= factor;
 
@@ -163,11 +249,11 @@ static void project_monster_hurt_immune(project_monster_handler_context_t *conte
 		rf_on(context->l_ptr->flags, hurt_flag);
 	}
 
-	if (rf_has(context->m_ptr->race->flags, imm_flag)) {
+	if (context->defence == 1) {
 		context->hurt_msg = MON_MSG_RESIST_A_LOT;
 		context->dam /= imm_factor;
 	}
-	else if (rf_has(context->m_ptr->race->flags, hurt_flag)) {
+	else if (context->defence == 2) {
 		context->hurt_msg = hurt_msg;
 		context->die_msg = die_msg;
 		context->dam *= hurt_factor;
@@ -189,7 +275,7 @@ static void project_monster_hurt_only(project_monster_handler_context_t *context
 {
 	if (context->seen) rf_on(context->l_ptr->flags, flag);
 
-	if (rf_has(context->m_ptr->race->flags, flag)) {
+	if (context->defence == 1) {
 		context->hurt_msg = hurt_msg;
 		context->die_msg = die_msg;
 	}
@@ -211,7 +297,7 @@ static void project_monster_hurt_only(project_monster_handler_context_t *context
  */
 static void project_monster_breath(project_monster_handler_context_t *context, int flag, int factor)
 {
-	if (rsf_has(context->m_ptr->race->spell_flags, flag)) {
+	if (context->defence == 1) {
 		/* Learn about breathers through resistance */
 		if (context->seen) rsf_on(context->l_ptr->spell_flags, flag);
 
@@ -270,7 +356,7 @@ static void project_monster_teleport_away(project_monster_handler_context_t *con
 {
 	if (context->seen) rf_on(context->l_ptr->flags, flag);
 
-	if (rf_has(context->m_ptr->race->flags, flag)) {
+	if (context->defence == 1) {
 		if (context->seen) context->obvious = TRUE;
 		context->teleport_distance = context->dam;
 		context->hurt_msg = MON_MSG_DISAPPEAR;
@@ -296,7 +382,7 @@ static void project_monster_scare(project_monster_handler_context_t *context, in
 {
     if (context->seen) rf_on(context->l_ptr->flags, flag);
 
-	if (rf_has(context->m_ptr->race->flags, flag)) {
+	if (context->defence == 1) {
 		if (context->seen) context->obvious = TRUE;
         project_monster_timed_no_damage(context, MON_TMD_FEAR);
 	}
@@ -322,7 +408,7 @@ static void project_monster_dispel(project_monster_handler_context_t *context, i
 {
 	if (context->seen) rf_on(context->l_ptr->flags, flag);
 
-	if (rf_has(context->m_ptr->race->flags, flag)) {
+	if (context->defence == 1) {
 		if (context->seen) context->obvious = TRUE;
 		context->hurt_msg = MON_MSG_SHUDDER;
 		context->die_msg = MON_MSG_DISSOLVE;
@@ -368,7 +454,7 @@ static void project_monster_handler_LIGHT(project_monster_handler_context_t *con
 {
 	if (context->seen) rf_on(context->l_ptr->flags, RF_HURT_LIGHT);
 
-	if (rsf_has(context->m_ptr->race->spell_flags, RSF_BR_LIGHT)) {
+	if (context->defence == 1) {
 		/* Learn about breathers through resistance */
 		if (context->seen) rsf_on(context->l_ptr->spell_flags, RSF_BR_LIGHT);
 
@@ -376,7 +462,7 @@ static void project_monster_handler_LIGHT(project_monster_handler_context_t *con
 		context->dam *= 2;
 		context->dam /= randint1(6) + 6;
 	}
-	else if (rf_has(context->m_ptr->race->flags, RF_HURT_LIGHT)) {
+	else if (context->defence == 2) {
 		context->hurt_msg = MON_MSG_CRINGE_LIGHT;
 		context->die_msg = MON_MSG_SHRIVEL_LIGHT;
 		context->dam *= 2;
@@ -420,7 +506,7 @@ static void project_monster_handler_NETHER(project_monster_handler_context_t *co
 		rf_on(context->l_ptr->flags, RF_IM_NETHER);
 
 		/* If it isn't undead, acquire extra knowledge */
-		if (!rf_has(context->m_ptr->race->flags, RF_UNDEAD)) {
+		if (context->defence != 1) {
 			/* Learn this creature breathes nether if true */
 			if (rsf_has(context->m_ptr->race->spell_flags, RSF_BR_NETH)) {
 				rsf_on(context->l_ptr->spell_flags, RSF_BR_NETH);
@@ -433,16 +519,16 @@ static void project_monster_handler_NETHER(project_monster_handler_context_t *co
 		}
 	}
 
-	if (rf_has(context->m_ptr->race->flags, RF_UNDEAD)) {
+	if (context->defence == 1) {
 		context->hurt_msg = MON_MSG_IMMUNE;
 		context->dam = 0;
 	}
-	else if (rf_has(context->m_ptr->race->flags, RF_IM_NETHER)) {
+	else if (context->defence == 2) {
 		context->hurt_msg = MON_MSG_RESIST;
 		context->dam *= 3;
 		context->dam /= (randint1(6)+6);
 	}
-	else if (rf_has(context->m_ptr->race->flags, RF_EVIL)) {
+	else if (context->defence == 3) {
 		context->dam /= 2;
 		context->hurt_msg = MON_MSG_RESIST_SOMEWHAT;
 	}
@@ -455,7 +541,7 @@ static void project_monster_handler_CHAOS(project_monster_handler_context_t *con
 	int monster_amount = (5 + randint1(11) + context->r) / (context->r + 1);
 
 	/* Prevent polymorph on chaos breathers. */
-	if (rsf_has(context->m_ptr->race->spell_flags, RSF_BR_CHAO))
+	if (context->defence == 1)
 		context->do_poly = 0;
 	else
 		context->do_poly = 1;
@@ -496,7 +582,7 @@ static void project_monster_handler_GRAVITY(project_monster_handler_context_t *c
 		context->teleport_distance = 10;
 
 	/* Prevent displacement on gravity breathers. */
-	if (rsf_has(context->m_ptr->race->spell_flags, RSF_BR_GRAV))
+	if (context->defence == 1)
 		context->teleport_distance = 0;
 
 	project_monster_breath(context, RSF_BR_GRAV, 3);
@@ -739,7 +825,7 @@ static void project_monster_handler_OLD_DRAIN(project_monster_handler_context_t
 		rf_on(context->l_ptr->flags, RF_UNDEAD);
 		rf_on(context->l_ptr->flags, RF_DEMON);
 	}
-	if (monster_is_nonliving(context->m_ptr->race)) {
+	if (context->defence) {
 		context->hurt_msg = MON_MSG_UNAFFECTED;
 		context->obvious = FALSE;
 		context->dam = 0;
@@ -1096,6 +1182,11 @@ bool project_m(int who, int r, int y, int x, int dam, int typ, int flg)
 	l_ptr = get_lore(m_ptr->race);
 	context.m_ptr = m_ptr;
 	context.l_ptr = l_ptr;
+	context.defence = m_ptr->race->gf_defence[typ];
+
+	/* Being hit by anything makes a monster worth processing */
+	monster_end_dormancy(cave, m_ptr);
+	monster_settle_regen(m_ptr);
 
 	/* See visible monsters */
 	if (mflag_has(m_ptr->mflag, MFLAG_VISIBLE)) {
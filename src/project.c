@@ -26,6 +26,7 @@
 #include "player-calcs.h"
 #include "player-timed.h"
 #include "project.h"
+#include "z-trace.h"
 
 /*
  * Specify attr/char pairs for visual special effects for project()
@@ -34,6 +35,88 @@
 byte gf_to_attr[GF_MAX][BOLT_MAX];
 wchar_t gf_to_char[GF_MAX][BOLT_MAX];
 
+/**
+ * Recently computed projection paths.  Monsters cast the same bolts along the
+ * same lines turn after turn, and projectable() is asked the same questions
+ * over and over, so the last few answers are kept.  An entry is only good
+ * while the terrain is untouched, and, for paths that stop at monsters, while
+ * nothing has moved.
+ */
+#define PATH_CACHE_SIZE 16
+#define PATH_CACHE_LEN 64
+
+static struct path_cache_entry {
+	struct chunk *c;
+	u32b terrain_stamp;
+	u32b occupant_stamp;
+	u32b used;
+	int y1, x1, y2, x2;
+	int range;
+	int flg;
+	int n;
+	struct loc grid[PATH_CACHE_LEN];
+} path_cache[PATH_CACHE_SIZE];
+
+static u32b path_cache_clock;
+
+/**
+ * Look up a path in the cache, copying it out if it is there
+ */
+static bool path_cache_find(struct loc *gp, int *n, int range, int y1, int x1,
+							int y2, int x2, int flg)
+{
+	int i;
+
+	for (i = 0; i < PATH_CACHE_SIZE; i++) {
+		struct path_cache_entry *entry = &path_cache[i];
+
+		if (!entry->c || entry->c != cave) continue;
+		if (entry->y1 != y1 || entry->x1 != x1) continue;
+		if (entry->y2 != y2 || entry->x2 != x2) continue;
+		if (entry->range != range || entry->flg != flg) continue;
+		if (entry->terrain_stamp != cave_terrain_stamp) continue;
+		if ((flg & PROJECT_STOP) &&
+			(entry->occupant_stamp != cave_occupant_stamp))
+			continue;
+
+		entry->used = ++path_cache_clock;
+		memcpy(gp, entry->grid, entry->n * sizeof(*gp));
+		*n = entry->n;
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/**
+ * Remember a path, replacing the least recently used entry
+ */
+static void path_cache_store(const struct loc *gp, int n, int range, int y1,
+							 int x1, int y2, int x2, int flg)
+{
+	struct path_cache_entry *entry = &path_cache[0];
+	int i;
+
+	if (n > PATH_CACHE_LEN) return;
+
+	for (i = 1; i < PATH_CACHE_SIZE; i++)
+		if (path_cache[i].used < entry->used)
+			entry = &path_cache[i];
+
+	entry->c = cave;
+	entry->terrain_stamp = cave_terrain_stamp;
+	entry->occupant_stamp = cave_occupant_stamp;
+	entry->used = ++path_cache_clock;
+	entry->y1 = y1;
+	entry->x1 = x1;
+	entry->y2 = y2;
+	entry->x2 = x2;
+	entry->range = range;
+	entry->flg = flg;
+	entry->n = n;
+	memcpy(entry->grid, gp, n * sizeof(*gp));
+}
+
 /**
  * Determine the path taken by a projection.
  *
@@ -74,7 +157,8 @@ wchar_t gf_to_char[GF_MAX][BOLT_MAX];
  * This algorithm is similar to, but slightly different from, the one used
  * by "update_view_los()", and very different from the one used by "los()".
  */
-int project_path(struct loc *gp, int range, int y1, int x1, int y2, int x2, int flg)
+static int project_path_aux(struct loc *gp, int range, int y1, int x1, int y2,
+							int x2, int flg)
 {
 	int y, x;
 
@@ -270,6 +354,25 @@ int project_path(struct loc *gp, int range, int y1, int x1, int y2, int x2, int
 	return (n);
 }
 
+/**
+ * Determine the path taken by a projection, reusing a recent answer where the
+ * cave has not changed underneath it; see project_path_aux()
+ */
+int project_path(struct loc *gp, int range, int y1, int x1, int y2, int x2, int flg)
+{
+	int n;
+
+	/* Only the flags that affect the path matter */
+	flg &= (PROJECT_STOP | PROJECT_THRU);
+
+	if (path_cache_find(gp, &n, range, y1, x1, y2, x2, flg))
+		return n;
+
+	n = project_path_aux(gp, range, y1, x1, y2, x2, flg);
+	path_cache_store(gp, n, range, y1, x1, y2, x2, flg);
+	return n;
+}
+
 
 /**
  * Determine if a bolt spell cast from (y1,x1) to (y2,x2) will arrive
@@ -430,6 +533,138 @@ const char *gf_idx_to_name(int type)
  * The main project() function and its helpers
  * ------------------------------------------------------------------------ */
 
+/**
+ * Working space for project(), kept from call to call so that a projection
+ * needs no allocation once the buffers are big enough.  A projection can set
+ * off another, so there is one for each level of nesting.
+ */
+struct project_workspace {
+	int size;					/* Number of blast grids there is room for */
+	int dam_size;				/* Number of distances there is room for */
+	struct loc *path_grid;		/* Grids in the path */
+	struct loc *blast_grid;		/* Coordinates of the affected grids */
+	int *distance_to_grid;		/* Distance to each of the affected grids */
+	bool *player_sees_grid;		/* Player visibility of each of them */
+	int *stage_grid;			/* Affected grids a stage acts on */
+	int *dam_at_dist;			/* Damage values for each distance */
+};
+
+static struct project_workspace **project_ws;
+static int project_ws_num;
+static int project_depth;
+
+/**
+ * Get the workspace for the current level of nesting, with room for the
+ * path and for damage out to the given radius
+ */
+static struct project_workspace *project_workspace_get(int rad)
+{
+	struct project_workspace *ws;
+
+	if (project_depth == project_ws_num) {
+		project_ws = mem_realloc(project_ws, (project_ws_num + 1) *
+								 sizeof(*project_ws));
+		project_ws[project_ws_num++] = mem_zalloc(sizeof(**project_ws));
+	}
+	ws = project_ws[project_depth];
+
+	if (!ws->path_grid) {
+		ws->path_grid = mem_zalloc(z_info->max_range * sizeof(struct loc));
+		ws->size = 256;
+		ws->blast_grid = mem_zalloc(ws->size * sizeof(struct loc));
+		ws->distance_to_grid = mem_zalloc(ws->size * sizeof(int));
+		ws->player_sees_grid = mem_zalloc(ws->size * sizeof(bool));
+		ws->stage_grid = mem_zalloc(ws->size * sizeof(int));
+	}
+
+	if (ws->dam_size < MAX(rad, z_info->max_range) + 1) {
+		ws->dam_size = MAX(rad, z_info->max_range) + 1;
+		ws->dam_at_dist = mem_realloc(ws->dam_at_dist,
+									  ws->dam_size * sizeof(int));
+	}
+
+	return ws;
+}
+
+/**
+ * Add a grid to the blast area, making room for it if need be
+ */
+static void project_add_grid(struct project_workspace *ws, int *num_grids,
+							 int y, int x, int dist)
+{
+	if (*num_grids == ws->size) {
+		ws->size *= 2;
+		ws->blast_grid = mem_realloc(ws->blast_grid,
+									 ws->size * sizeof(struct loc));
+		ws->distance_to_grid = mem_realloc(ws->distance_to_grid,
+										   ws->size * sizeof(int));
+		ws->player_sees_grid = mem_realloc(ws->player_sees_grid,
+										   ws->size * sizeof(bool));
+		ws->stage_grid = mem_realloc(ws->stage_grid, ws->size * sizeof(int));
+	}
+
+	ws->blast_grid[*num_grids].y = y;
+	ws->blast_grid[*num_grids].x = x;
+	ws->distance_to_grid[*num_grids] = dist;
+	sqinfo_on(cave->squares[y][x].info, SQUARE_PROJECT);
+	(*num_grids)++;
+}
+
+/**
+ * Grid tests for the stages of a projection
+ */
+static bool project_grid_has_object(int y, int x)
+{
+	return square_object(cave, y, x) ? TRUE : FALSE;
+}
+
+static bool project_grid_has_monster(int y, int x)
+{
+	return (cave->squares[y][x].mon > 0) ? TRUE : FALSE;
+}
+
+static bool project_grid_has_player(int y, int x)
+{
+	return (cave->squares[y][x].mon < 0) ? TRUE : FALSE;
+}
+
+/**
+ * List the affected grids a stage of the projection acts on, in order, so
+ * that the stage only visits those; returns how many there are
+ */
+static int project_gather(struct project_workspace *ws, int num_grids,
+						  bool (*pred)(int y, int x))
+{
+	int i, n = 0;
+
+	for (i = 0; i < num_grids; i++)
+		if (pred(ws->blast_grid[i].y, ws->blast_grid[i].x))
+			ws->stage_grid[n++] = i;
+
+	return n;
+}
+
+/**
+ * Free project()'s working space
+ */
+void project_cleanup(void)
+{
+	int i;
+
+	for (i = 0; i < project_ws_num; i++) {
+		mem_free(project_ws[i]->path_grid);
+		mem_free(project_ws[i]->blast_grid);
+		mem_free(project_ws[i]->distance_to_grid);
+		mem_free(project_ws[i]->player_sees_grid);
+		mem_free(project_ws[i]->stage_grid);
+		mem_free(project_ws[i]->dam_at_dist);
+		mem_free(project_ws[i]);
+	}
+	mem_free(project_ws);
+	project_ws = NULL;
+	project_ws_num = 0;
+}
+
 /**
  * Generic "beam"/"bolt"/"ball" projection routine.  
  *   -BEN-, some changes by -LM-
@@ -550,15 +785,16 @@ const char *gf_idx_to_name(int type)
  * In successive passes, the code then displays explosion graphics, erases 
  *   these graphics, marks terrain for possible later changes, affects 
  *   objects, monsters, the character, and finally changes features and 
- *   teleports monsters and characters in marked grids.
+ *   teleports monsters and characters in marked grids.  The object, monster
+ *   and character passes each first list the affected grids holding what
+ *   they act on, and then work through that list alone.
  * 
  *
  * Usage and graphics notes:
  *
- * Only 256 grids can be affected per projection, limiting the effective 
- * radius of standard ball attacks to nine units (diameter nineteen).  Arcs 
- * can have larger radii; an arc capable of going out to range 20 should not 
- * be wider than 70 degrees.
+ * There is no limit on the number of grids affected by a projection; the
+ * working space grows to fit.  An arc capable of going out to range 20
+ * should still not be wider than 70 degrees.
  *
  * Balls must explode BEFORE hitting walls, or they would affect monsters on 
  * both sides of a wall. 
@@ -581,6 +817,7 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 			 int degrees_of_arc, byte diameter_of_source)
 {
 	int i, j, k, dist_from_centre;
+	const struct loc *offsets;
 
 	u32b dam_temp;
 
@@ -600,23 +837,24 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 	/* Number of grids in the "path" */
 	int num_path_grids = 0;
 
-	/* Actual grids in the "path" */
-	struct loc path_grid[512];
-
 	/* Number of grids in the "blast area" (including the "beam" path) */
 	int num_grids = 0;
 
-	/* Coordinates of the affected grids */
-	struct loc blast_grid[256];
+	/* Number of those a stage of the projection acts on */
+	int num_stage;
 
-	/* Distance to each of the affected grids. */
-	int distance_to_grid[256];
+	/* Path, blast area and damage by distance */
+	struct project_workspace *ws = project_workspace_get(rad);
+	struct loc *path_grid = ws->path_grid;
+	int *dam_at_dist = ws->dam_at_dist;
+	struct loc *blast_grid;
+	int *distance_to_grid;
+	bool *player_sees_grid;
 
-	/* Player visibility of each of the affected grids. */
-	bool player_sees_grid[256];
+	TRACE_BEGIN("project");
 
-	/* Precalculated damage values for each distance. */
-	int *dam_at_dist = malloc((z_info->max_range + 1) * sizeof(*dam_at_dist));
+	/* Nested projections get their own space */
+	project_depth++;
 
 	/* Flush any pending output */
 	handle_stuff(player);
@@ -664,11 +902,7 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 	/* If a single grid is both source and destination (for example
 	 * if PROJECT_JUMP is set), store it. */
 	if ((source.x == destination.x) && (source.y == destination.y)) {
-		blast_grid[num_grids].y = y;
-		blast_grid[num_grids].x = x;
-		distance_to_grid[num_grids] = 0;
-		sqinfo_on(cave->squares[y][x].info, SQUARE_PROJECT);
-		num_grids++;
+		project_add_grid(ws, &num_grids, y, x, 0);
 	}
 
 	/* Otherwise, travel along the projection path. */
@@ -709,20 +943,12 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 
 				/* If a beam, collect all grids in the path. */
 				if (flg & (PROJECT_BEAM)) {
-					blast_grid[num_grids].y = y;
-					blast_grid[num_grids].x = x;
-					distance_to_grid[num_grids] = 0;
-					sqinfo_on(cave->squares[y][x].info, SQUARE_PROJECT);
-					num_grids++;
+					project_add_grid(ws, &num_grids, y, x, 0);
 				}
 
 				/* Otherwise, collect only the final grid in the path. */
 				else if (i == num_path_grids - 1) {
-					blast_grid[num_grids].y = y;
-					blast_grid[num_grids].x = x;
-					distance_to_grid[num_grids] = 0;
-					sqinfo_on(cave->squares[y][x].info, SQUARE_PROJECT);
-					num_grids++;
+					project_add_grid(ws, &num_grids, y, x, 0);
 				}
 
 				/* Only do visuals if requested and within range limit. */
@@ -773,24 +999,21 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 
 		/* If the explosion centre hasn't been saved already, save it now. */
 		if (num_grids == 0) {
-			blast_grid[num_grids].y = centre.y;
-			blast_grid[num_grids].x = centre.x;
-			distance_to_grid[num_grids] = 0;
-			sqinfo_on(cave->squares[centre.y][centre.x].info, SQUARE_PROJECT);
-			num_grids++;
+			project_add_grid(ws, &num_grids, centre.y, centre.x, 0);
 		}
 
-		/* Scan every grid that might possibly be in the blast radius. */
-		for (y = centre.y - rad; y <= centre.y + rad; y++) {
-			for (x = centre.x - rad; x <= centre.x + rad; x++) {
+		/* Blasts reach no further than the precomputed distance table */
+		if (rad > z_info->max_sight)
+			rad = z_info->max_sight;
 
-				/* Center grid has already been stored. */
-				if ((y == centre.y) && (x == centre.x))
-					continue;
-
-				/* Precaution: Stay within area limit. */
-				if (num_grids >= 255)
-					break;
+		/* Scan every grid within the blast radius, nearest first; the
+		 * first offset is the centre, which has already been stored. */
+		j = distance_offsets(0, &offsets);
+		for (dist_from_centre = 1; dist_from_centre <= rad; dist_from_centre++) {
+			int end = distance_offsets(dist_from_centre, &offsets);
+			for (; j < end; j++) {
+				y = centre.y + offsets[j].y;
+				x = centre.x + offsets[j].x;
 
 				/* Ignore "illegal" locations */
 				if (!square_in_bounds(cave, y, x))
@@ -825,20 +1048,11 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 				} else if (!square_isprojectable(cave, y, x))
 					continue;
 
-				/* Must be within maximum distance. */
-				dist_from_centre  = (distance(centre.y, centre.x, y, x));
-				if (dist_from_centre > rad)
-					continue;
-
 
 				/* If not an arc, accept all grids in LOS. */
 				if (!(flg & (PROJECT_ARC))) {
 					if (los(cave, centre.y, centre.x, y, x)) {
-						blast_grid[num_grids].y = y;
-						blast_grid[num_grids].x = x;
-						distance_to_grid[num_grids] = dist_from_centre;
-						sqinfo_on(cave->squares[y][x].info, SQUARE_PROJECT);
-						num_grids++;
+						project_add_grid(ws, &num_grids, y, x, dist_from_centre);
 					}
 				}
 
@@ -865,11 +1079,7 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 					 */
 					if (diff < (degrees_of_arc + 6) / 4) {
 						if (los(cave, centre.y, centre.x, y, x)) {
-							blast_grid[num_grids].y = y;
-							blast_grid[num_grids].x = x;
-							distance_to_grid[num_grids] = dist_from_centre;
-							sqinfo_on(cave->squares[y][x].info, SQUARE_PROJECT);
-							num_grids++;
+							project_add_grid(ws, &num_grids, y, x, dist_from_centre);
 						}
 					}
 				}
@@ -877,8 +1087,13 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 		}
 	}
 
+	/* The blast area is complete, so its buffers stay put from here */
+	blast_grid = ws->blast_grid;
+	distance_to_grid = ws->distance_to_grid;
+	player_sees_grid = ws->player_sees_grid;
+
 	/* Calculate and store the actual damage at each distance. */
-	for (i = 0; i <= z_info->max_range; i++) {
+	for (i = 0; i < ws->dam_size; i++) {
 		/* No damage outside the radius. */
 		if (i > rad)
 			dam_temp = 0;
@@ -901,30 +1116,8 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 	}
 
 
-	/* Sort the blast grids by distance, starting at the origin. */
-	for (i = 0, k = 0; i <= rad; i++) {
-		int tmp_y, tmp_x, tmp_d;
-
-		/* Collect all the grids of a given distance together. */
-		for (j = k; j < num_grids; j++) {
-			if (distance_to_grid[j] == i) {
-				tmp_y = blast_grid[k].y;
-				tmp_x = blast_grid[k].x;
-				tmp_d = distance_to_grid[k];
-
-				blast_grid[k].y = blast_grid[j].y;
-				blast_grid[k].x = blast_grid[j].x;
-				distance_to_grid[k] = distance_to_grid[j];
-
-				blast_grid[j].y = tmp_y;
-				blast_grid[j].x = tmp_x;
-				distance_to_grid[j] = tmp_d;
-
-				/* Write to next slot */
-				k++;
-			}
-		}
-	}
+	/* The blast grids are already in order of distance from the origin,
+	 * since the blast area was scanned outwards from it. */
 
 	/* Establish which grids are visible - no blast visuals with PROJECT_HIDE */
 	if (!blind && !(flg & (PROJECT_HIDE))) {
@@ -943,9 +1136,10 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 
 	/* Check objects */
 	if (flg & (PROJECT_ITEM)) {
-		/* Scan for objects */
-		for (i = 0; i < num_grids; i++) {
+		num_stage = project_gather(ws, num_grids, project_grid_has_object);
+		for (j = 0; j < num_stage; j++) {
 			/* Get the grid location */
+			i = ws->stage_grid[j];
 			y = blast_grid[i].y;
 			x = blast_grid[i].x;
 
@@ -963,12 +1157,14 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 		project_m_x = 0;
 		project_m_y = 0;
 
-		/* Scan for monsters */
-		for (i = 0; i < num_grids; i++) {
+		/* Scan for monsters, including any mimics the objects gave away */
+		num_stage = project_gather(ws, num_grids, project_grid_has_monster);
+		for (j = 0; j < num_stage; j++) {
 			/* Get the grid location */
+			i = ws->stage_grid[j];
 			y = blast_grid[i].y;
 			x = blast_grid[i].x;
-			
+
 			/* Check this monster hasn't been processed already */
 			if (!square_isproject(cave, y, x)) continue;
 
@@ -1000,8 +1196,10 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 	/* Check player */
 	if (flg & (PROJECT_PLAY)) {
 		/* Scan for player */
-		for (i = 0; i < num_grids; i++) {
+		num_stage = project_gather(ws, num_grids, project_grid_has_player);
+		for (j = 0; j < num_stage; j++) {
 			/* Get the grid location */
+			i = ws->stage_grid[j];
 			y = blast_grid[i].y;
 			x = blast_grid[i].x;
 
@@ -1043,7 +1241,10 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 	if (player->upkeep->update)
 		update_stuff(player);
 
-	free(dam_at_dist);
+	/* Done with the working space */
+	project_depth--;
+
+	TRACE_END("project");
 
 	/* Return "something was noticed" */
 	return (notice);
@@ -73,6 +73,7 @@ int project_m_y;
 bool project_f(int who, int r, int y, int x, int dam, int typ);
 int inven_damage(struct player *p, int type, int cperc);
 bool project_o(int who, int r, int y, int x, int dam, int typ);
+void project_m_defences(const struct monster_race *race, byte *defences);
 bool project_m(int who, int r, int y, int x, int dam, int typ, int flg);
 int adjust_dam(struct player *p, int type, int dam, aspect dam_aspect, int resist);
 bool project_p(int who, int r, int y, int x, int dam, int typ);
@@ -94,5 +95,6 @@ int gf_name_to_idx(const char *name);
 const char *gf_idx_to_name(int type);
 bool project(int who, int rad, int y, int x, int dam, int typ, int flg,
 			 int degrees_of_arc, byte diameter_of_source);
+void project_cleanup(void);
 
 #endif /* !PROJECT_H */
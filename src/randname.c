@@ -67,41 +67,74 @@ static void build_prob(name_probs probs, const char **learn)
 	}
 }
 
+/**
+ * Probability tables for each name type, built on first use and kept until the
+ * word lists they were built from change.
+ */
+static name_probs *probs_cache[RANDNAME_NUM_TYPES];
+static const char ***probs_source;
+
+/**
+ * Forget all cached probability tables.
+ */
+void randname_cleanup(void)
+{
+	int i;
+
+	for (i = 0; i < RANDNAME_NUM_TYPES; i++) {
+		mem_free(probs_cache[i]);
+		probs_cache[i] = NULL;
+	}
+	probs_source = NULL;
+}
+
+/**
+ * Return the probability table for `name_type`, building it if needed.
+ */
+static name_probs *randname_probs(randname_type name_type,
+								  const char ***sections)
+{
+	if (probs_source != sections) {
+		randname_cleanup();
+		probs_source = sections;
+	}
+
+	if (!probs_cache[name_type]) {
+		probs_cache[name_type] = mem_zalloc(sizeof(name_probs));
+		build_prob(*probs_cache[name_type], sections[name_type]);
+	}
+
+	return probs_cache[name_type];
+}
+
+/**
+ * Build the probability tables for every name type from `sections` up front.
+ * After this, names can be generated from several threads at once as long as
+ * each uses its own RNG stream (see randname_make_batch()).
+ */
+void randname_prepare(const char ***sections)
+{
+	int i;
+
+	for (i = 1; i < RANDNAME_NUM_TYPES; i++)
+		randname_probs(i, sections);
+}
+
 /**
  * Use W. Sheldon Simms' random name generator algorithm (Markov Chain stylee).
  * 
  * Generate a random word using the probability tables we built earlier.  
  * Relies on the A2I and I2A macros (and so the ASCII character set) and 
  * is_a_vowel (so the basic 5 English vowels).
+ *
+ * Letters are drawn from `rng` if given, and from the game RNG otherwise.
  */
-size_t randname_make(randname_type name_type, size_t min, size_t max,
-					 char *word_buf, size_t buflen, const char ***sections)
+static size_t randname_build(name_probs lprobs, size_t min, size_t max,
+							 char *word_buf, rng_state *rng)
 {
 	size_t lnum = 0;
 	bool found_word = FALSE;
 
-	static name_probs lprobs;
-	static randname_type cached_type = RANDNAME_NUM_TYPES;
-
-	assert(name_type > 0 && name_type < RANDNAME_NUM_TYPES);
-
-	/* To allow for a terminating character */
-	assert(buflen > max);
-
-	/* We cache one set of probabilities, only regenerate when
-	   the type changes.  It's as good a way as any for now.
-	   Frankly, we could probably regenerate every time. */
-	if (cached_type != name_type) {
-		const char **wordlist = NULL;
-
-		wordlist = sections[name_type];
-
-		(void)memset(lprobs, 0, sizeof(name_probs));
-		build_prob(lprobs, wordlist);
-
-		cached_type = name_type;
-	}
-        
 	/* Generate the actual word wanted. */
 	while (!found_word) {
 		char *cp = word_buf;
@@ -123,7 +156,10 @@ size_t randname_make(randname_type name_type, size_t min, size_t max,
 			assert(c_prev >= 0 && c_prev <= S_WORD);
 			assert(c_cur >= 0 && c_cur <= S_WORD);
 
-			r = randint0(lprobs[c_prev][c_cur][TOTAL]);
+			if (rng)
+				r = rng_div(rng, lprobs[c_prev][c_cur][TOTAL]);
+			else
+				r = randint0(lprobs[c_prev][c_cur][TOTAL]);
 
 			while (r >= lprobs[c_prev][c_cur][c_next]) {
 				r -= lprobs[c_prev][c_cur][c_next];
@@ -164,6 +200,45 @@ size_t randname_make(randname_type name_type, size_t min, size_t max,
 	return lnum;
 }
 
+/**
+ * Make a random name of type `name_type` into `word_buf`, using the game RNG.
+ */
+size_t randname_make(randname_type name_type, size_t min, size_t max,
+					 char *word_buf, size_t buflen, const char ***sections)
+{
+	assert(name_type > 0 && name_type < RANDNAME_NUM_TYPES);
+
+	/* To allow for a terminating character */
+	assert(buflen > max);
+
+	return randname_build(*randname_probs(name_type, sections), min, max,
+						  word_buf, NULL);
+}
+
+/**
+ * Make `num` random names of type `name_type`, writing the i'th into
+ * `names + i * buflen`.  Letters come from `rng`, so the same seed always gives
+ * the same names and the game RNG is left untouched.
+ *
+ * Once randname_prepare() has been called for `sections`, this only reads
+ * shared state and may be called concurrently with separate RNG streams.
+ */
+void randname_make_batch(randname_type name_type, size_t min, size_t max,
+						 char *names, size_t buflen, size_t num,
+						 const char ***sections, rng_state *rng)
+{
+	name_probs *lprobs;
+	size_t i;
+
+	assert(name_type > 0 && name_type < RANDNAME_NUM_TYPES);
+	assert(buflen > max);
+	assert(rng);
+
+	lprobs = randname_probs(name_type, sections);
+	for (i = 0; i < num; i++)
+		randname_build(*lprobs, min, max, names + i * buflen, rng);
+}
+
 
 /**
  * To run standalone tests, #define RANDNAME_TESTING and link with
@@ -18,6 +18,8 @@
 #ifndef RANDNAME_H
 #define RANDNAME_H
 
+#include "z-rand.h"
+
 /**
  * The different types of name randname.c can generate
  * which is also the number of sections in names.txt
@@ -32,9 +34,17 @@ typedef enum {
 
 extern const char *** name_sections;
 
+void randname_prepare(const char ***sections);
+void randname_cleanup(void);
+
 /**
  * Make a random name.
  */
 extern size_t randname_make(randname_type name_type, size_t min, size_t max, char *word_buf, size_t buflen, const char ***wordlist);
 
+/**
+ * Make several random names at once from an explicit RNG stream.
+ */
+extern void randname_make_batch(randname_type name_type, size_t min, size_t max, char *names, size_t buflen, size_t num, const char ***sections, rng_state *rng);
+
 #endif /* RANDNAME_H */
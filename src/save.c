@@ -22,6 +22,7 @@
 #include "init.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "monster.h"
 #include "object.h"
 #include "obj-pile.h"
@@ -167,10 +168,13 @@ static void wr_item(const object_type *obj)
 
 
 /**
- * Write a monster record (including held or mimicked objects)
+ * Write a monster record (including held or mimicked objects); 'known' is
+ * what it knows of the player, or NULL for nothing
  */
-static void wr_monster(const monster_type *mon)
+static void wr_monster(const monster_type *mon,
+					   const struct player_state *known)
 {
+	static const struct player_state nothing;
 	size_t j;
 	struct object *obj = mon->held_obj; 
 	struct object *dummy = object_new();
@@ -190,11 +194,13 @@ static void wr_monster(const monster_type *mon)
 	for (j = 0; j < MFLAG_SIZE; j++)
 		wr_byte(mon->mflag[j]);
 
+	if (!known) known = &nothing;
+
 	for (j = 0; j < OF_SIZE; j++)
-		wr_byte(mon->known_pstate.flags[j]);
+		wr_byte(known->flags[j]);
 
 	for (j = 0; j < ELEM_MAX; j++)
-		wr_s16b(mon->known_pstate.el_info[j].res_level);
+		wr_s16b(known->el_info[j].res_level);
 
 	/* Write mimicked object if any */
 	if (mon->mimicked_obj) {
@@ -626,7 +632,7 @@ void wr_stores(void)
 /**
  * Write the current dungeon terrain features and info flags
  *
- * Note that the cost and when fields of c->squares[y][x] are not saved
+ * Note that the flow (c->cost and c->when) is not saved
  */
 static void wr_dungeon_aux(struct chunk *c)
 {
@@ -635,7 +641,7 @@ static void wr_dungeon_aux(struct chunk *c)
 
 	byte tmp8u;
 
-	byte count;
+	u32b count;
 	byte prev_char;
 
 	/* Dungeon specific info follows */
@@ -643,7 +649,8 @@ static void wr_dungeon_aux(struct chunk *c)
 	wr_u16b(c->height);
 	wr_u16b(c->width);
 
-	/* Run length encoding of c->squares[y][x].info */
+	/* Run length encoding of c->squares[y][x].info; runs may be any length,
+	 * so that a uniform plane takes a couple of bytes */
 	for (i = 0; i < SQUARE_SIZE; i++) {
 		count = 0;
 		prev_char = 0;
@@ -654,21 +661,24 @@ static void wr_dungeon_aux(struct chunk *c)
 				/* Extract the important c->squares[y][x].info flags */
 				tmp8u = c->squares[y][x].info[i];
 
-				/* If the run is broken, or too full, flush it */
-				if ((tmp8u != prev_char) || (count == MAX_UCHAR)) {
-					wr_byte((byte)count);
-					wr_byte((byte)prev_char);
+				/* If the run is broken, flush it */
+				if (count && (tmp8u == prev_char)) {
+					count++;
+				} else {
+					if (count) {
+						wr_varint(count);
+						wr_byte(prev_char);
+					}
 					prev_char = tmp8u;
 					count = 1;
-				} else /* Continue the run */
-					count++;
+				}
 			}
 		}
 
 		/* Flush the data (if any) */
 		if (count) {
-			wr_byte((byte)count);
-			wr_byte((byte)prev_char);
+			wr_varint(count);
+			wr_byte(prev_char);
 		}
 	}
 
@@ -682,21 +692,24 @@ static void wr_dungeon_aux(struct chunk *c)
 			/* Extract a byte */
 			tmp8u = c->squares[y][x].feat;
 
-			/* If the run is broken, or too full, flush it */
-			if ((tmp8u != prev_char) || (count == MAX_UCHAR)) {
-				wr_byte((byte)count);
-				wr_byte((byte)prev_char);
+			/* If the run is broken, flush it */
+			if (count && (tmp8u == prev_char)) {
+				count++;
+			} else {
+				if (count) {
+					wr_varint(count);
+					wr_byte(prev_char);
+				}
 				prev_char = tmp8u;
 				count = 1;
-			} else /* Continue the run */
-				count++;
+			}
 		}
 	}
 
 	/* Flush the data (if any) */
 	if (count) {
-		wr_byte((byte)count);
-		wr_byte((byte)prev_char);
+		wr_varint(count);
+		wr_byte(prev_char);
 	}
 
 	/* Write feeling */
@@ -748,9 +761,14 @@ static void wr_monsters_aux(struct chunk *c)
 
 	/* Dump the monsters */
 	for (i = 1; i < cave_monster_max(c); i++) {
-		const monster_type *mon = cave_monster(c, i);
+		monster_type *mon = cave_monster(c, i);
 
-		wr_monster(mon);
+		/* Energy and hitpoints are saved up to date */
+		if (mon->race) {
+			monster_settle_energy(mon);
+			monster_settle_regen(mon);
+		}
+		wr_monster(mon, c->mon_known ? &c->mon_known[i] : NULL);
 	}
 }
 
@@ -17,9 +17,20 @@
  */
 #include <errno.h>
 #include "angband.h"
+#include "cave.h"
+#include "cmd-core.h"
 #include "game-world.h"
+#include "generate.h"
 #include "init.h"
+#include "mon-make.h"
+#include "obj-ignore.h"
+#include "obj-pile.h"
+#include "player-birth.h"
+#include "player-quest.h"
+#include "player-spell.h"
 #include "savefile.h"
+#include "store.h"
+#include "z-trace.h"
 
 /**
  * The savefile code.
@@ -50,7 +61,10 @@
  *
  * Savefile loading and saving is done by keeping the current block in
  * memory, which is accessed using the wr_* and rd_* functions.  This is
- * then written out, whole, to disk, with the appropriate header.
+ * then written out, whole, to disk, with the appropriate header.  Loading
+ * reads the whole file into memory first and works through that image, so
+ * savefile_snapshot() and savefile_restore() can pass images around without
+ * any files at all.
  *
  *
  * So, if you want to make a savefile compat-breaking change, then there are
@@ -113,11 +127,11 @@ static const struct {
 	{ "player spells", wr_player_spells, 1 },
 	{ "gear", wr_gear, 1 },
 	{ "stores", wr_stores, 1 },
-	{ "dungeon", wr_dungeon, 1 },
+	{ "dungeon", wr_dungeon, 2 },
 	{ "objects", wr_objects, 1 },
 	{ "monsters", wr_monsters, 1 },
 	{ "traps", wr_traps, 1 },
-	{ "chunks", wr_chunks, 1 },
+	{ "chunks", wr_chunks, 2 },
 	{ "history", wr_history, 1 },
 };
 
@@ -140,11 +154,13 @@ static const struct blockinfo loaders[] = {
 	{ "player spells", rd_player_spells, 1 },
 	{ "gear", rd_gear, 1 },	
 	{ "stores", rd_stores, 1 },	
-	{ "dungeon", rd_dungeon, 1 },
+	{ "dungeon", rd_dungeon_1, 1 },
+	{ "dungeon", rd_dungeon, 2 },
 	{ "objects", rd_objects, 1 },	
 	{ "monsters", rd_monsters, 1 },
 	{ "traps", rd_traps, 1 },
-	{ "chunks", rd_chunks, 1 },
+	{ "chunks", rd_chunks_1, 1 },
+	{ "chunks", rd_chunks, 2 },
 	{ "history", rd_history, 1 },
 };
 
@@ -155,8 +171,18 @@ static u32b buffer_size;
 static u32b buffer_pos;
 static u32b buffer_check;
 
+/* Set when a loader tries to read past the end of its block */
+static bool buffer_overrun;
+
+/* Size of the image written by the last save */
+static u32b buffer_save_size;
+
+/* The last image written, and where it went */
+static byte *last_image;
+static u32b last_image_size;
+static char last_image_path[1024];
+
 #define BUFFER_INITIAL_SIZE		1024
-#define BUFFER_BLOCK_INCREMENT	1024
 
 #define SAVEFILE_HEAD_SIZE		28
 
@@ -181,28 +207,50 @@ void note(const char *message)
  * Base put/get
  * ------------------------------------------------------------------------ */
 
-static void sf_put(byte v)
+/**
+ * Make room for another n bytes in the save buffer
+ */
+static void sf_reserve(u32b n)
 {
 	assert(buffer != NULL);
 	assert(buffer_size > 0);
 
-	if (buffer_size == buffer_pos)
-	{
-		buffer_size += BUFFER_BLOCK_INCREMENT;
-		buffer = mem_realloc(buffer, buffer_size);
-	}
+	if (buffer_size - buffer_pos >= n)
+		return;
 
-	assert(buffer_pos < buffer_size);
+	while (buffer_size - buffer_pos < n)
+		buffer_size *= 2;
+	buffer = mem_realloc(buffer, buffer_size);
+}
+
+static void sf_put(byte v)
+{
+	sf_reserve(1);
 
 	buffer[buffer_pos++] = v;
 	buffer_check += v;
 }
 
-static byte sf_get(void)
+/**
+ * Check that another n bytes can be read from the block, so that a truncated
+ * or corrupt block reads as zeroes and fails to load rather than running off
+ * the end of the buffer
+ */
+static bool sf_avail(u32b n)
 {
 	assert(buffer != NULL);
-	assert(buffer_size > 0);
-	assert(buffer_pos < buffer_size);
+
+	if (buffer_size - buffer_pos >= n)
+		return TRUE;
+
+	buffer_overrun = TRUE;
+	return FALSE;
+}
+
+static byte sf_get(void)
+{
+	if (!sf_avail(1))
+		return 0;
 
 	buffer_check += buffer[buffer_pos];
 
@@ -222,8 +270,14 @@ void wr_byte(byte v)
 
 void wr_u16b(u16b v)
 {
-	sf_put((byte)(v & 0xFF));
-	sf_put((byte)((v >> 8) & 0xFF));
+	byte *b;
+
+	sf_reserve(2);
+	b = buffer + buffer_pos;
+	b[0] = (byte)(v & 0xFF);
+	b[1] = (byte)((v >> 8) & 0xFF);
+	buffer_check += b[0] + b[1];
+	buffer_pos += 2;
 }
 
 void wr_s16b(s16b v)
@@ -233,10 +287,16 @@ void wr_s16b(s16b v)
 
 void wr_u32b(u32b v)
 {
-	sf_put((byte)(v & 0xFF));
-	sf_put((byte)((v >> 8) & 0xFF));
-	sf_put((byte)((v >> 16) & 0xFF));
-	sf_put((byte)((v >> 24) & 0xFF));
+	byte *b;
+
+	sf_reserve(4);
+	b = buffer + buffer_pos;
+	b[0] = (byte)(v & 0xFF);
+	b[1] = (byte)((v >> 8) & 0xFF);
+	b[2] = (byte)((v >> 16) & 0xFF);
+	b[3] = (byte)((v >> 24) & 0xFF);
+	buffer_check += b[0] + b[1] + b[2] + b[3];
+	buffer_pos += 4;
 }
 
 void wr_s32b(s32b v)
@@ -244,14 +304,28 @@ void wr_s32b(s32b v)
 	wr_u32b((u32b)v);
 }
 
-void wr_string(const char *str)
+/**
+ * Write a number in as few bytes as it needs, seven bits to the byte with the
+ * top bit set on all but the last
+ */
+void wr_varint(u32b v)
 {
-	while (*str)
-	{
-		wr_byte(*str);
-		str++;
+	while (v >= 0x80) {
+		sf_put((byte)((v & 0x7F) | 0x80));
+		v >>= 7;
 	}
-	wr_byte(*str);
+	sf_put((byte)v);
+}
+
+void wr_string(const char *str)
+{
+	u32b i, len = strlen(str) + 1;
+
+	sf_reserve(len);
+	memcpy(buffer + buffer_pos, str, len);
+	for (i = 0; i < len; i++)
+		buffer_check += buffer[buffer_pos + i];
+	buffer_pos += len;
 }
 
 
@@ -262,8 +336,16 @@ void rd_byte(byte *ip)
 
 void rd_u16b(u16b *ip)
 {
-	(*ip) = sf_get();
-	(*ip) |= ((u16b)(sf_get()) << 8);
+	const byte *b = buffer + buffer_pos;
+
+	if (!sf_avail(2)) {
+		*ip = 0;
+		return;
+	}
+
+	*ip = b[0] | ((u16b)b[1] << 8);
+	buffer_check += b[0] + b[1];
+	buffer_pos += 2;
 }
 
 void rd_s16b(s16b *ip)
@@ -273,10 +355,16 @@ void rd_s16b(s16b *ip)
 
 void rd_u32b(u32b *ip)
 {
-	(*ip) = sf_get();
-	(*ip) |= ((u32b)(sf_get()) << 8);
-	(*ip) |= ((u32b)(sf_get()) << 16);
-	(*ip) |= ((u32b)(sf_get()) << 24);
+	const byte *b = buffer + buffer_pos;
+
+	if (!sf_avail(4)) {
+		*ip = 0;
+		return;
+	}
+
+	*ip = b[0] | ((u32b)b[1] << 8) | ((u32b)b[2] << 16) | ((u32b)b[3] << 24);
+	buffer_check += b[0] + b[1] + b[2] + b[3];
+	buffer_pos += 4;
 }
 
 void rd_s32b(s32b *ip)
@@ -284,30 +372,97 @@ void rd_s32b(s32b *ip)
 	rd_u32b((u32b*)ip);
 }
 
-void rd_string(char *str, int max)
+void rd_varint(u32b *ip)
 {
-	byte tmp8u;
-	int i = 0;
+	int shift = 0;
+	byte b;
 
+	*ip = 0;
 	do {
-		rd_byte(&tmp8u);
+		b = sf_get();
+		if (shift < 32)
+			*ip |= (u32b)(b & 0x7F) << shift;
+		shift += 7;
+	} while ((b & 0x80) && !buffer_overrun);
+}
+
+/**
+ * Whether the current block has been read past its end
+ */
+bool rd_overrun(void)
+{
+	return buffer_overrun;
+}
 
-		if (i < max) str[i] = tmp8u;
-		if (!tmp8u) break;
-	} while (++i);
+void rd_string(char *str, int max)
+{
+	const byte *start = buffer + buffer_pos;
+	const byte *end = memchr(start, '\0', buffer_size - buffer_pos);
+	u32b i, len;
+
+	/* An unterminated string runs to the end of the block */
+	if (end) {
+		len = end - start + 1;
+	} else {
+		len = buffer_size - buffer_pos;
+		buffer_overrun = TRUE;
+	}
 
+	memcpy(str, start, MIN(len, (u32b)max));
+	if (!end && len < (u32b)max)
+		str[len] = '\0';
 	str[max - 1] = '\0';
+
+	for (i = 0; i < len; i++)
+		buffer_check += start[i];
+	buffer_pos += len;
+}
+
+/**
+ * Read n bytes straight into an array, such as a set of flags
+ */
+void rd_bytes(byte *dst, int n)
+{
+	int i;
+
+	if (n <= 0)
+		return;
+
+	if (!sf_avail(n)) {
+		memset(dst, 0, n);
+		return;
+	}
+
+	memcpy(dst, buffer + buffer_pos, n);
+	for (i = 0; i < n; i++)
+		buffer_check += dst[i];
+	buffer_pos += n;
 }
 
 void strip_bytes(int n)
 {
-	byte tmp8u;
-	while (n--) rd_byte(&tmp8u);
+	int i;
+
+	if (n <= 0)
+		return;
+
+	if (!sf_avail(n)) {
+		buffer_pos = buffer_size;
+		return;
+	}
+
+	for (i = 0; i < n; i++)
+		buffer_check += buffer[buffer_pos + i];
+	buffer_pos += n;
 }
 
 void pad_bytes(int n)
 {
-	while (n--) wr_byte(0);
+	if (n <= 0) return;
+
+	sf_reserve(n);
+	memset(buffer + buffer_pos, 0, n);
+	buffer_pos += n;
 }
 
 
@@ -317,25 +472,43 @@ void pad_bytes(int n)
  * ------------------------------------------------------------------------ */
 
 
-static bool try_save(ang_file *file)
+/**
+ * Serialise the whole game into the save buffer, as the complete image of
+ * the savefile: the magic header and then each block with its own header,
+ * data and padding.  This touches no files, so nothing is written unless
+ * the whole game serialised.
+ */
+static void save_image(void)
 {
-	byte savefile_head[SAVEFILE_HEAD_SIZE];
+	byte *savefile_head;
 	size_t i, pos;
+	u32b head_pos, block_size;
+
+	/* Start off the buffer, big enough for the last save */
+	buffer_size = MAX(buffer_save_size, BUFFER_INITIAL_SIZE);
+	buffer = mem_alloc(buffer_size);
+	buffer_pos = 0;
 
-	/* Start off the buffer */
-	buffer = mem_alloc(BUFFER_INITIAL_SIZE);
-	buffer_size = BUFFER_INITIAL_SIZE;
+	memcpy(buffer, savefile_magic, 4);
+	memcpy(buffer + 4, savefile_name, 4);
+	buffer_pos = 8;
 
 	for (i = 0; i < N_ELEMENTS(savers); i++) {
-		buffer_pos = 0;
+		/* Leave room for the header, filled in once the block is done */
+		sf_reserve(SAVEFILE_HEAD_SIZE);
+		head_pos = buffer_pos;
+		buffer_pos += SAVEFILE_HEAD_SIZE;
 		buffer_check = 0;
 
 		savers[i].save();
 
+		block_size = buffer_pos - head_pos - SAVEFILE_HEAD_SIZE;
+		savefile_head = buffer + head_pos;
+
 		/* 16-byte block name */
 		pos = my_strcpy((char *)savefile_head,
 				savers[i].name,
-				sizeof savefile_head);
+				SAVEFILE_HEAD_SIZE);
 		while (pos < 16)
 			savefile_head[pos++] = 0;
 
@@ -346,33 +519,61 @@ static bool try_save(ang_file *file)
 		savefile_head[pos++] = ((v >> 24) & 0xFF);
 
 		SAVE_U32B(savers[i].version);
-		SAVE_U32B(buffer_pos);
+		SAVE_U32B(block_size);
 		SAVE_U32B(buffer_check);
 
 		assert(pos == SAVEFILE_HEAD_SIZE);
 
-		file_write(file, (char *)savefile_head, SAVEFILE_HEAD_SIZE);
-		file_write(file, (char *)buffer, buffer_pos);
-
 		/* pad to 4 byte multiples */
-		if (buffer_pos % 4)
-			file_write(file, "xxx", 4 - (buffer_pos % 4));
+		if (block_size % 4) {
+			sf_reserve(4 - (block_size % 4));
+			while (buffer_pos % 4)
+				buffer[buffer_pos++] = 'x';
+		}
 	}
 
-	mem_free(buffer);
+	buffer_save_size = buffer_pos;
+}
 
-	return TRUE;
+/**
+ * Write the serialised game out in one go
+ */
+static bool try_save(ang_file *file)
+{
+	bool ok = file_write(file, (char *)buffer, buffer_pos);
+
+	if (!ok)
+		msg("Couldn't write the savefile.");
+
+	return ok;
 }
 
 /**
- * Attempt to save the player in a savefile
+ * Save the player in a savefile, for savefile_save()
  */
-bool savefile_save(const char *path)
+static bool savefile_save_aux(const char *path)
 {
 	ang_file *file;
 	int count = 0;
 	char new_savefile[1024];
 	char old_savefile[1024];
+	byte *image;
+	u32b image_size;
+
+	/* Serialise the game before touching any files */
+	save_image();
+	image = buffer;
+	image_size = buffer_pos;
+
+	/* Nothing to write if the file already holds exactly this game */
+	if (last_image && streq(last_image_path, path) &&
+			last_image_size == image_size &&
+			!memcmp(last_image, image, image_size) && file_exists(path)) {
+		mem_free(buffer);
+		buffer = NULL;
+		character_saved = TRUE;
+		return TRUE;
+	}
 
 	/* New savefile */
 	strnfmt(old_savefile, sizeof(old_savefile), "%s%u.old", path,
@@ -395,13 +596,14 @@ bool savefile_save(const char *path)
 	safe_setuid_drop();
 
 	if (file) {
-		file_write(file, (char *) &savefile_magic, 4);
-		file_write(file, (char *) &savefile_name, 4);
-
 		character_saved = try_save(file);
 		file_close(file);
+	} else {
+		msg("Couldn't create the new savefile.");
 	}
 
+	buffer = NULL;
+
 	if (character_saved) {
 		bool err = FALSE;
 
@@ -422,9 +624,21 @@ bool savefile_save(const char *path)
 
 		safe_setuid_drop();
 
+		/* Remember what is now in the file */
+		if (!err) {
+			mem_free(last_image);
+			last_image = image;
+			last_image_size = image_size;
+			my_strcpy(last_image_path, path, sizeof(last_image_path));
+		} else {
+			mem_free(image);
+		}
+
 		return err ? FALSE : TRUE;
 	}
 
+	mem_free(image);
+
 	/* Delete temp file if the save failed */
 	if (file) {
 		/* File is no longer valid, but it still points to a non zero
@@ -436,6 +650,30 @@ bool savefile_save(const char *path)
 	return FALSE;
 }
 
+/**
+ * Attempt to save the player in a savefile
+ */
+bool savefile_save(const char *path)
+{
+	bool ok;
+
+	TRACE("savefile_save", ok = savefile_save_aux(path));
+
+	return ok;
+}
+
+
+
+/**
+ * Forget the last image saved
+ */
+void savefile_cleanup(void)
+{
+	mem_free(last_image);
+	last_image = NULL;
+	last_image_size = 0;
+	last_image_path[0] = '\0';
+}
 
 
 /**
@@ -444,15 +682,22 @@ bool savefile_save(const char *path)
  * ------------------------------------------------------------------------ */
 
 /**
- * Check the savefile header file clearly inicates that it's a savefile
+ * The savefile image being loaded, and how far through it the loader is
  */
-static bool check_header(ang_file *f) {
-	byte head[8];
+static const byte *load_data;
+static u32b load_size;
+static u32b load_pos;
 
-	if (file_read(f, (char *) &head, 8) == 8 &&
-			memcmp(&head[0], savefile_magic, 4) == 0 &&
-			memcmp(&head[4], savefile_name, 4) == 0)
+/**
+ * Check the savefile header file clearly inicates that it's a savefile
+ */
+static bool check_header(void) {
+	if (load_size - load_pos >= 8 &&
+			memcmp(load_data + load_pos, savefile_magic, 4) == 0 &&
+			memcmp(load_data + load_pos + 4, savefile_name, 4) == 0) {
+		load_pos += 8;
 		return TRUE;
+	}
 
 	return FALSE;
 }
@@ -460,17 +705,17 @@ static bool check_header(ang_file *f) {
 /**
  * Get the next block header from the savefile
  */
-static errr next_blockheader(ang_file *f, struct blockheader *b) {
-	byte savefile_head[SAVEFILE_HEAD_SIZE];
-	size_t len;
+static errr next_blockheader(struct blockheader *b) {
+	const byte *savefile_head = load_data + load_pos;
 
-	len = file_read(f, (char *)savefile_head, SAVEFILE_HEAD_SIZE);
-	if (len == 0) /* no more blocks */
+	if (load_pos == load_size) /* no more blocks */
 		return 1;
 
-	if (len != SAVEFILE_HEAD_SIZE || savefile_head[15] != 0) {
+	if (load_size - load_pos < SAVEFILE_HEAD_SIZE ||
+			savefile_head[15] != 0) {
 		return -1;
 	}
+	load_pos += SAVEFILE_HEAD_SIZE;
 
 #define RECONSTRUCT_U32B(from) \
 	((u32b) savefile_head[from]) | \
@@ -478,7 +723,7 @@ static errr next_blockheader(ang_file *f, struct blockheader *b) {
 	((u32b) savefile_head[from+2] << 16) | \
 	((u32b) savefile_head[from+3] << 24);
 
-	my_strcpy(b->name, (char *)&savefile_head, sizeof b->name);
+	my_strcpy(b->name, (const char *)savefile_head, sizeof b->name);
 	b->version = RECONSTRUCT_U32B(16);
 	b->size = RECONSTRUCT_U32B(20);
 
@@ -509,49 +754,57 @@ static loader_t find_loader(struct blockheader *b,
 }
 
 /**
- * Load a given block with the given loader
+ * Load a given block with the given loader, reading it where it lies in the
+ * image rather than copying it out
  */
-static bool load_block(ang_file *f, struct blockheader *b, loader_t loader)
+static bool load_block(struct blockheader *b, loader_t loader)
 {
-	/* Allocate space for the buffer */
-	buffer = mem_alloc(b->size);
+	bool ok;
+
+	if (load_size - load_pos < b->size)
+		return FALSE;
+
+	buffer = (byte *)(load_data + load_pos);
+	buffer_size = b->size;
 	buffer_pos = 0;
 	buffer_check = 0;
+	buffer_overrun = FALSE;
+	load_pos += b->size;
 
-	buffer_size = file_read(f, (char *) buffer, b->size);
-	if (buffer_size != b->size ||
-			loader() != 0) {
-		mem_free(buffer);
-		return FALSE;
-	}
+	ok = loader() == 0 && !buffer_overrun;
 
-	mem_free(buffer);
-	return TRUE;
+	buffer = NULL;
+	return ok;
 }
 
 /**
  * Skip a block
  */
-static void skip_block(ang_file *f, struct blockheader *b)
+static void skip_block(struct blockheader *b)
 {
-	file_skip(f, b->size);
+	load_pos += MIN(b->size, load_size - load_pos);
 }
 
 /**
- * Try to load a savefile
+ * Try to load a savefile image
  */
-static bool try_load(ang_file *f, const struct blockinfo *loaders)
+static bool try_load(const byte *image, u32b size,
+		const struct blockinfo *loaders)
 {
 	struct blockheader b;
 	errr err;
 
-	if (!check_header(f)) {
+	load_data = image;
+	load_size = size;
+	load_pos = 0;
+
+	if (!check_header()) {
 		note("Savefile is corrupted -- incorrect file header.");
 		return FALSE;
 	}
 
 	/* Get the next block header */
-	while ((err = next_blockheader(f, &b)) == 0) {
+	while ((err = next_blockheader(&b)) == 0) {
 		loader_t loader = find_loader(&b, loaders);
 		if (!loader) {
 			note("Savefile block can't be read.");
@@ -559,7 +812,7 @@ static bool try_load(ang_file *f, const struct blockinfo *loaders)
 			return FALSE;
 		}
 
-		if (!load_block(f, &b, loader)) {
+		if (!load_block(&b, loader)) {
 			note(format("Savefile corrupted - Couldn't load block %s", b.name));
 			return FALSE;
 		}
@@ -573,6 +826,33 @@ static bool try_load(ang_file *f, const struct blockinfo *loaders)
 	return TRUE;
 }
 
+/**
+ * Read a whole savefile into memory.  Returns the image, to be freed with
+ * mem_free(), or NULL if the file can't be opened.
+ */
+static byte *read_image(const char *path, u32b *size)
+{
+	u32b alloc = MAX(buffer_save_size, BUFFER_INITIAL_SIZE);
+	byte *image;
+	int len;
+
+	ang_file *f = file_open(path, MODE_READ, FTYPE_TEXT);
+	if (!f) return NULL;
+
+	image = mem_alloc(alloc);
+	*size = 0;
+	while ((len = file_read(f, (char *)image + *size, alloc - *size)) > 0) {
+		*size += len;
+		if (*size == alloc) {
+			alloc *= 2;
+			image = mem_realloc(image, alloc);
+		}
+	}
+
+	file_close(f);
+	return image;
+}
+
 /* XXX this isn't nice but it'll have to do */
 static char savefile_desc[120];
 
@@ -583,9 +863,19 @@ static int get_desc(void) {
 
 /**
  * Try to get the 'description' block from a savefile.  Fail gracefully.
+ *
+ * The description is always the first block written, so it sits at a fixed
+ * offset just after the file and block headers; a single small read of the
+ * start of the file normally finds it.  Files laid out otherwise fall back
+ * to walking the blocks.
  */
 const char *savefile_get_description(const char *path) {
 	struct blockheader b;
+	byte head[8 + SAVEFILE_HEAD_SIZE + sizeof savefile_desc];
+	byte *block = head + 8;
+	byte *image;
+	size_t len, size;
+	u32b image_size;
 
 	ang_file *f = file_open(path, MODE_READ, FTYPE_TEXT);
 	if (!f) return NULL;
@@ -593,38 +883,57 @@ const char *savefile_get_description(const char *path) {
 	/* Blank the description */
 	savefile_desc[0] = 0;
 
-	if (!check_header(f)) {
+	len = file_read(f, (char *)head, sizeof head);
+	file_close(f);
+	if (len < 8 || memcmp(head, savefile_magic, 4) != 0 ||
+			memcmp(head + 4, savefile_name, 4) != 0) {
 		my_strcpy(savefile_desc, "Invalid savefile", sizeof savefile_desc);
-	} else {
-		while (!next_blockheader(f, &b)) {
-			if (!streq(b.name, "description")) {
-				skip_block(f, &b);
-				continue;
-			}
-			load_block(f, &b, get_desc);
-			break;
+		return savefile_desc;
+	}
+
+	/* The usual case: the description comes first */
+	if (len >= 8 + SAVEFILE_HEAD_SIZE &&
+			streq((char *)block, "description")) {
+		size = block[20] | ((size_t)block[21] << 8) |
+			((size_t)block[22] << 16) | ((size_t)block[23] << 24);
+		size = MIN(size, len - 8 - SAVEFILE_HEAD_SIZE);
+		size = MIN(size, sizeof savefile_desc - 1);
+		memcpy(savefile_desc, block + SAVEFILE_HEAD_SIZE, size);
+		savefile_desc[size] = 0;
+		return savefile_desc;
+	}
+
+	/* Otherwise look for it */
+	image = read_image(path, &image_size);
+	load_data = image;
+	load_size = image ? image_size : 0;
+	load_pos = 0;
+	if (!image || !check_header()) {
+		mem_free(image);
+		my_strcpy(savefile_desc, "Invalid savefile", sizeof savefile_desc);
+		return savefile_desc;
+	}
+	while (!next_blockheader(&b)) {
+		if (!streq(b.name, "description")) {
+			skip_block(&b);
+			continue;
 		}
+		load_block(&b, get_desc);
+		break;
 	}
 
-	file_close(f);
+	mem_free(image);
 	return savefile_desc;
 }
 
 
 /**
- * Load a savefile.
+ * Load a savefile image over a game with nothing in it, and ready the
+ * character to be played.
  */
-bool savefile_load(const char *path, bool cheat_death)
+static bool load_image(const byte *image, u32b size, bool cheat_death)
 {
-	bool ok;
-	ang_file *f = file_open(path, MODE_READ, FTYPE_TEXT);
-	if (!f) {
-		note("Couldn't open savefile.");
-		return FALSE;
-	}
-
-	ok = try_load(f, loaders);
-	file_close(f);
+	bool ok = try_load(image, size, loaders);
 
 	if (player->chp < 0) {
 		player->is_dead = TRUE;
@@ -642,3 +951,109 @@ bool savefile_load(const char *path, bool cheat_death)
 
 	return ok;
 }
+
+/**
+ * Load a savefile.
+ */
+bool savefile_load(const char *path, bool cheat_death)
+{
+	bool ok = FALSE;
+	u32b size;
+	byte *image;
+
+	TRACE_BEGIN("savefile_load");
+
+	image = read_image(path, &size);
+	if (!image) {
+		note("Couldn't open savefile.");
+	} else {
+		ok = load_image(image, size, cheat_death);
+		mem_free(image);
+	}
+
+	TRACE_END("savefile_load");
+
+	return ok;
+}
+
+
+/**
+ * ------------------------------------------------------------------------
+ * Snapshots
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Serialise the whole game into a new savefile image, touching no files.
+ * The caller frees the image with mem_free().
+ */
+byte *savefile_snapshot(u32b *size)
+{
+	byte *image;
+
+	save_image();
+	image = buffer;
+	*size = buffer_pos;
+	buffer = NULL;
+
+	return image;
+}
+
+/**
+ * Free everything the loaders would make afresh, and put the player and the
+ * game data back as a newly started game has them, so that loading over the
+ * current game neither leaks nor keeps anything from it.
+ */
+static void wipe_game(void)
+{
+	int i;
+
+	/* The levels, with their monsters counted off their races */
+	if (cave) {
+		wipe_mon_list(cave, player);
+		cave_free(cave);
+		cave = NULL;
+	}
+	if (cave_k) {
+		cave_free(cave_k);
+		cave_k = NULL;
+	}
+	chunk_list_free();
+	character_dungeon = FALSE;
+
+	/* The player's own buffers, which player_init() only forgets */
+	object_pile_free(player->gear);
+	object_pile_free(player->gear_k);
+	for (i = 0; i < player->body.count; i++)
+		string_free(player->body.slots[i].name);
+	mem_free(player->body.slots);
+	string_free(player->body.name);
+	mem_free(player->history);
+	player_spells_free(player);
+	player_quests_free(player);
+	player_init(player);
+
+	/* Store stock, ignore settings, the message log and pending commands */
+	for (i = 0; i < MAX_STORES; i++) {
+		object_pile_free(stores[i].stock);
+		stores[i].stock = NULL;
+		stores[i].stock_num = 0;
+	}
+	ignore_birth_init();
+	for (i = 0; i < z_info->k_max; i++)
+		k_info[i].note = 0;
+	messages_clear();
+	cmdq_flush();
+	cmd_cancel_repeat();
+}
+
+/**
+ * Put the game back exactly as it was when the given image was taken by
+ * savefile_snapshot(), without touching any files.  As with savefile_load(),
+ * the caller then enters the level with on_new_level().
+ */
+bool savefile_restore(const byte *image, u32b size)
+{
+	wipe_game();
+
+	return load_image(image, size, FALSE);
+}
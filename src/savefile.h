@@ -34,6 +34,11 @@
  */
 bool savefile_save(const char *path);
 
+/**
+ * Free the copy of the last savefile written.
+ */
+void savefile_cleanup(void);
+
 /**
  * Load the savefile given.  Returns TRUE on succcess, FALSE otherwise.
  */
@@ -44,6 +49,19 @@ bool savefile_load(const char *path, bool cheat_death);
  */
 const char *savefile_get_description(const char *path);
 
+/**
+ * Serialise the game into a new savefile image, without touching any files,
+ * for savefile_restore().  The image is *size bytes and freed by the caller
+ * with mem_free().
+ */
+byte *savefile_snapshot(u32b *size);
+
+/**
+ * Put the game back as it was when the image was taken.  Returns TRUE on
+ * success; on failure the game is left half-loaded and can't be played on.
+ */
+bool savefile_restore(const byte *image, u32b size);
+
 
 /**
  * ------------------------------------------------------------------------
@@ -60,6 +78,7 @@ void wr_u16b(u16b v);
 void wr_s16b(s16b v);
 void wr_u32b(u32b v);
 void wr_s32b(s32b v);
+void wr_varint(u32b v);
 void wr_string(const char *str);
 void pad_bytes(int n);
 
@@ -69,7 +88,10 @@ void rd_u16b(u16b *ip);
 void rd_s16b(s16b *ip);
 void rd_u32b(u32b *ip);
 void rd_s32b(s32b *ip);
+void rd_varint(u32b *ip);
+bool rd_overrun(void);
 void rd_string(char *str, int max);
+void rd_bytes(byte *dst, int n);
 void strip_bytes(int n);
 
 
@@ -89,7 +111,9 @@ int rd_player_hp(void);
 int rd_player_spells(void);
 int rd_gear(void);
 int rd_stores(void);
+int rd_dungeon_1(void);
 int rd_dungeon(void);
+int rd_chunks_1(void);
 int rd_chunks(void);
 int rd_objects(void);
 int rd_monsters(void);
@@ -32,7 +32,58 @@ static long total_points(void)
 
 
 /**
- * Read in a highscore file.
+ * Scores are kept in two files in the apex directory.
+ *
+ * scores.raw is the table: the best MAX_HISCORES entries, best first.
+ *
+ * scores.log is a log of the entries made since the table was last
+ * compacted.  A death only has to append one entry to it, holding a lock on
+ * the log for just that write, so games sharing a score file don't wait on
+ * each other rewriting the table.  highscore_compact() (angband -c) merges the
+ * log into the table and empties it.
+ */
+
+static size_t highscore_count(const high_score scores[], size_t sz)
+{
+	size_t i;
+	for (i = 0; i < sz; i++)
+		if (scores[i].what[0] == '\0')
+			break;
+
+	return i;
+}
+
+
+/**
+ * Merge the entries in the score log into a table read from scores.raw.
+ */
+static void highscore_merge_log(ang_file *log, high_score scores[], size_t sz)
+{
+	high_score entry;
+
+	while (file_read(log, (char *)&entry, sizeof(entry)) == sizeof(entry)) {
+		size_t i;
+
+		/* A reader can race compaction, and see an entry in both files */
+		for (i = 0; i < sz && scores[i].what[0]; i++)
+			if (!memcmp(&scores[i], &entry, sizeof(entry)))
+				break;
+
+		if (i < sz && scores[i].what[0]) continue;
+
+		/* Don't let an entry that misses a full table push out the last */
+		if (i == sz && strtoul(entry.pts, NULL, 0) <
+			strtoul(scores[sz - 1].pts, NULL, 0))
+			continue;
+
+		highscore_add(&entry, scores, sz);
+	}
+}
+
+
+/**
+ * Read in the highscore table, with the entries logged since it was last
+ * compacted.
  */
 size_t highscore_read(high_score scores[], size_t sz)
 {
@@ -46,15 +97,24 @@ size_t highscore_read(high_score scores[], size_t sz)
 	path_build(fname, sizeof(fname), ANGBAND_DIR_APEX, "scores.raw");
 	scorefile = file_open(fname, MODE_READ, FTYPE_TEXT);
 
-	if (!scorefile) return TRUE;
+	if (scorefile) {
+		for (i = 0; i < sz; i++)
+			if (file_read(scorefile, (char *)&scores[i],
+						  sizeof(high_score)) <= 0)
+				break;
 
-	for (i = 0; i < sz; i++)
-		if (file_read(scorefile, (char *)&scores[i], sizeof(high_score)) <= 0)
-			break;
+		file_close(scorefile);
+	}
 
-	file_close(scorefile);
+	path_build(fname, sizeof(fname), ANGBAND_DIR_APEX, "scores.log");
+	scorefile = file_open(fname, MODE_READ, FTYPE_RAW);
 
-	return i;
+	if (scorefile) {
+		highscore_merge_log(scorefile, scores, sz);
+		file_close(scorefile);
+	}
+
+	return highscore_count(scores, sz);
 }
 
 
@@ -94,59 +154,92 @@ size_t highscore_add(const high_score *entry, high_score scores[], size_t sz)
 	return slot;
 }
 
-static size_t highscore_count(const high_score scores[], size_t sz)
+
+/**
+ * Append an entry to the score log.
+ */
+bool highscore_append(const high_score *entry)
 {
-	size_t i;
-	for (i = 0; i < sz; i++)
-		if (scores[i].what[0] == '\0')
-			break;
+	char fname[1024];
+	ang_file *log;
+	bool ok;
 
-	return i;
+	path_build(fname, sizeof(fname), ANGBAND_DIR_APEX, "scores.log");
+
+	safe_setuid_grab();
+	log = file_open(fname, MODE_APPEND, FTYPE_RAW);
+	safe_setuid_drop();
+
+	if (!log) {
+		msg("Failed to open the score log for writing.");
+		return FALSE;
+	}
+
+	/* Closing the log writes the entry out, then drops the lock */
+	file_lock(log);
+	ok = file_write(log, (const char *)entry, sizeof(*entry));
+	file_close(log);
+
+	if (!ok) msg("Failed to write to the score log.");
+
+	return ok;
 }
 
 
 /**
- * Actually place an entry into the high score file
- * Return the location (0 is best) or -1 on "failure"
+ * Merge the score log into the highscore table, and empty the log.
+ *
+ * This holds the log lock while the table is rewritten, so it is best run
+ * when no games are ending.
  */
-static void highscore_write(const high_score scores[], size_t sz)
+bool highscore_compact(void)
 {
-	size_t n;
+	high_score scores[MAX_HISCORES];
+	size_t n, i;
 
-	ang_file *lok;
+	ang_file *log;
 	ang_file *scorefile;
 
 	char old_name[1024];
 	char cur_name[1024];
 	char new_name[1024];
-	char lok_name[1024];
+	char log_name[1024];
 
 	path_build(old_name, sizeof(old_name), ANGBAND_DIR_APEX, "scores.old");
 	path_build(cur_name, sizeof(cur_name), ANGBAND_DIR_APEX, "scores.raw");
 	path_build(new_name, sizeof(new_name), ANGBAND_DIR_APEX, "scores.new");
-	path_build(lok_name, sizeof(lok_name), ANGBAND_DIR_APEX, "scores.lok");
-
+	path_build(log_name, sizeof(log_name), ANGBAND_DIR_APEX, "scores.log");
 
-	/* Read in and add new score */
-	n = highscore_count(scores, sz);
+	/* Nothing to do */
+	if (!file_exists(log_name)) return TRUE;
 
+	/* Lock the log, so that no entries are added while we work */
+	safe_setuid_grab();
+	log = file_open(log_name, MODE_APPEND, FTYPE_RAW);
+	safe_setuid_drop();
 
-	/* Lock scores */
-	if (file_exists(lok_name)) {
-		msg("Lock file in place for scorefile; not writing.");
-		return;
+	if (!log) {
+		msg("Failed to open the score log.");
+		return FALSE;
 	}
 
-	safe_setuid_grab();
-	lok = file_open(lok_name, MODE_WRITE, FTYPE_RAW);
-	file_lock(lok);
-	safe_setuid_drop();
+	file_lock(log);
 
-	if (!lok) {
-		msg("Failed to create lock for scorefile; not writing.");
-		return;
+	/* Read the table, then the log from the start */
+	memset(scores, 0, sizeof(scores));
+	scorefile = file_open(cur_name, MODE_READ, -1);
+	if (scorefile) {
+		for (i = 0; i < N_ELEMENTS(scores); i++)
+			if (file_read(scorefile, (char *)&scores[i],
+						  sizeof(high_score)) <= 0)
+				break;
+
+		file_close(scorefile);
 	}
 
+	/* A fresh append handle reads from the start */
+	highscore_merge_log(log, scores, N_ELEMENTS(scores));
+	n = highscore_count(scores, N_ELEMENTS(scores));
 
 	/* Open the new file for writing */
 	safe_setuid_grab();
@@ -156,12 +249,11 @@ static void highscore_write(const high_score scores[], size_t sz)
 	if (!scorefile) {
 		msg("Failed to open new scorefile for writing.");
 
-		file_close(lok);
-		file_delete(lok_name);
-		return;
+		file_close(log);
+		return FALSE;
 	}
 
-	file_write(scorefile, (const char *)scores, sizeof(high_score)*n);
+	file_write(scorefile, (const char *)scores, sizeof(high_score) * n);
 	file_close(scorefile);
 
 	/* Now move things around */
@@ -173,14 +265,21 @@ static void highscore_write(const high_score scores[], size_t sz)
 	if (file_exists(cur_name) && !file_move(cur_name, old_name))
 		msg("Couldn't move old scores.raw out of the way");
 
-	if (!file_move(new_name, cur_name))
+	if (!file_move(new_name, cur_name)) {
 		msg("Couldn't rename new scorefile to scores.raw");
+	} else {
+		/* Empty the log.  Closing the handle that does it drops our lock
+		 * (POSIX locks belong to the process, not the handle), but only
+		 * once the log is already empty. */
+		scorefile = file_open(log_name, MODE_WRITE, FTYPE_RAW);
+		if (scorefile) file_close(scorefile);
+	}
 
-	/* Remove the lock */
-	file_close(lok);
-	file_delete(lok_name);
+	file_close(log);
 
 	safe_setuid_drop();
+
+	return TRUE;
 }
 
 
@@ -262,13 +361,9 @@ void enter_score(time_t *death_time)
 		event_signal(EVENT_MESSAGE_FLUSH);
 	} else {
 		high_score entry;
-		high_score scores[MAX_HISCORES];
 
 		build_score(&entry, player->died_from, death_time);
-
-		highscore_read(scores, N_ELEMENTS(scores));
-		highscore_add(&entry, scores, N_ELEMENTS(scores));
-		highscore_write(scores, N_ELEMENTS(scores));
+		highscore_append(&entry);
 	}
 
 	/* Success */
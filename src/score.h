@@ -59,6 +59,8 @@ size_t highscore_read(high_score scores[], size_t sz);
 size_t highscore_where(const high_score *entry, const high_score scores[],
 					   size_t sz);
 size_t highscore_add(const high_score *entry, high_score scores[], size_t sz);
+bool highscore_append(const high_score *entry);
+bool highscore_compact(void);
 void build_score(high_score *entry, const char *died_from, time_t *death_time);
 void enter_score(time_t *death_time);
 
@@ -28,19 +28,38 @@
 
 
 /**
- * Don't cache audio
+ * Arbitary limit on number of samples per event
  */
-static bool no_cache_audio = FALSE;
+#define MAX_SAMPLES      16
 
 /**
- * Using mp3s
+ * Most samples heard at once; a new one replaces the nearest to finishing
  */
-static bool use_mp3 = FALSE;
+#define MAX_VOICES       8
 
 /**
- * Arbitary limit on number of samples per event
+ * Room for samples triggered but not yet picked up by the audio thread
+ * (a power of two)
  */
-#define MAX_SAMPLES      16
+#define TRIGGER_QUEUE    64
+
+/**
+ * Order the trigger queue's slots before its indices between threads
+ */
+#if defined(__GNUC__)
+#define TRIGGER_BARRIER() __sync_synchronize()
+#else
+#define TRIGGER_BARRIER()
+#endif
+
+/**
+ * A decoded sample, as frames of the mixer's own format
+ */
+typedef struct
+{
+	Sint16 *pcm;                    /* Start of the sample in sound_pcm */
+	Uint32 frames;                  /* Length in frames */
+} sound_sample;
 
 /**
  * Struct representing all data about an event sample
@@ -48,39 +67,124 @@ static bool use_mp3 = FALSE;
 typedef struct
 {
 	int num;                        /* Number of samples for this event */
-	Mix_Chunk *wavs[MAX_SAMPLES];   /* Sample array */
-	Mix_Music *mp3s[MAX_SAMPLES];   /* Sample array */
-	char *paths[MAX_SAMPLES]; /* Relative pathnames for samples */
+	sound_sample smps[MAX_SAMPLES]; /* Sample array */
 } sample_list;
 
+/**
+ * A sample being played by the audio thread
+ */
+typedef struct
+{
+	const sound_sample *smp;        /* Sample, or NULL if the voice is free */
+	Uint32 pos;                     /* Next frame to mix */
+} sound_voice;
+
 
 /**
  * Just need an array of SampInfos
  */
 static sample_list samples[MSG_MAX];
 
+/**
+ * Every decoded sample, in one block
+ */
+static Sint16 *sound_pcm;
+
+/**
+ * Channels of the mixer's output
+ */
+static int sound_channels;
+
+/**
+ * Samples waiting to start.  Only play_sound() writes a slot and advances
+ * trigger_head; only the audio thread advances trigger_tail.
+ */
+static const sound_sample *trigger_queue[TRIGGER_QUEUE];
+static volatile Uint32 trigger_head;
+static volatile Uint32 trigger_tail;
+
+/**
+ * The samples playing, only touched on the audio thread
+ */
+static sound_voice voices[MAX_VOICES];
+
+
+/**
+ * Start the samples triggered since the last call and add every voice into
+ * the mixer's output.  Runs on the audio thread as SDL_mixer's post-mix hook.
+ */
+static void mix_voices(void *udata, Uint8 *stream, int len)
+{
+	Sint16 *out = (Sint16 *)stream;
+	Uint32 frames = len / (sizeof(Sint16) * sound_channels);
+	int i;
+
+	/* Unused */
+	(void)udata;
+
+	/* Pick up new samples */
+	while (trigger_tail != trigger_head) {
+		const sound_sample *smp;
+		int v = 0;
+
+		TRIGGER_BARRIER();
+		smp = trigger_queue[trigger_tail & (TRIGGER_QUEUE - 1)];
+		TRIGGER_BARRIER();
+		trigger_tail++;
+
+		/* Take a free voice, or the one nearest to finishing */
+		for (i = 0; i < MAX_VOICES; i++) {
+			if (!voices[i].smp) {
+				v = i;
+				break;
+			}
+			if (voices[i].smp->frames - voices[i].pos <
+				voices[v].smp->frames - voices[v].pos)
+				v = i;
+		}
+
+		voices[v].smp = smp;
+		voices[v].pos = 0;
+	}
+
+	/* Add each voice, clipping */
+	for (i = 0; i < MAX_VOICES; i++) {
+		sound_voice *voice = &voices[i];
+		const Sint16 *in;
+		Uint32 n, k;
+
+		if (!voice->smp) continue;
+
+		n = voice->smp->frames - voice->pos;
+		if (n > frames) n = frames;
+
+		in = voice->smp->pcm + voice->pos * sound_channels;
+		for (k = 0; k < n * sound_channels; k++) {
+			int sum = out[k] + in[k];
+
+			if (sum > 32767) sum = 32767;
+			else if (sum < -32768) sum = -32768;
+			out[k] = (Sint16)sum;
+		}
+
+		voice->pos += n;
+		if (voice->pos >= voice->smp->frames) voice->smp = NULL;
+	}
+}
+
 
 /**
  * Shut down the sound system and free resources.
  */
 static void close_audio(void)
 {
-	size_t i;
-	int j;
+	/* Stop mixing before the samples go */
+	Mix_SetPostMix(NULL, NULL);
 
 	/* Free all the sample data*/
-	for (i = 0; i < MSG_MAX; i++) {
-  		sample_list *smp = &samples[i];
-
-		/* Nuke all samples */
-		for (j = 0; j < smp->num; j++) {
-			if (use_mp3)
-				Mix_FreeMusic(smp->mp3s[j]);
-			else
-				Mix_FreeChunk(smp->wavs[j]);
-			string_free(smp->paths[j]);
-		}
-	}
+	mem_free(sound_pcm);
+	sound_pcm = NULL;
+	memset(samples, 0, sizeof(samples));
 
 	/* Close the audio */
 	Mix_CloseAudio();
@@ -101,7 +205,7 @@ static bool open_audio(void)
 	
 	/* Initialize variables */
 	audio_rate = 22050;
-	audio_format = AUDIO_S16;
+	audio_format = AUDIO_S16SYS;
 	audio_channels = 2;
 
 	/* Initialize the SDL library */
@@ -116,22 +220,63 @@ static bool open_audio(void)
 		return FALSE;
 	}
 
+	/* The samples are mixed by hand, so they must be in this format */
+	if (!Mix_QuerySpec(&audio_rate, &audio_format, &audio_channels) ||
+		audio_format != AUDIO_S16SYS) {
+		plog("Couldn't get 16 bit audio");
+		Mix_CloseAudio();
+		return FALSE;
+	}
+	sound_channels = audio_channels;
+
 	/* Success */
 	return TRUE;
 }
 
 
+/**
+ * Move every decoded sample into one block, freeing the chunks.
+ */
+static void pack_samples(Mix_Chunk *chunks[MSG_MAX][MAX_SAMPLES])
+{
+	size_t total = 0, at = 0;
+	int i, j;
+
+	for (i = 0; i < MSG_MAX; i++)
+		for (j = 0; j < samples[i].num; j++)
+			total += chunks[i][j]->alen / sizeof(Sint16);
+
+	if (total) sound_pcm = mem_alloc(total * sizeof(Sint16));
+
+	for (i = 0; i < MSG_MAX; i++) {
+		for (j = 0; j < samples[i].num; j++) {
+			Mix_Chunk *chunk = chunks[i][j];
+			size_t n = chunk->alen / sizeof(Sint16);
+
+			memcpy(sound_pcm + at, chunk->abuf, n * sizeof(Sint16));
+			samples[i].smps[j].pcm = sound_pcm + at;
+			samples[i].smps[j].frames = n / sound_channels;
+			at += n;
+
+			Mix_FreeChunk(chunk);
+		}
+	}
+}
+
 
 /**
- * Read sound.cfg and map events to sounds; then load all the sounds into
- * memory to avoid I/O latency later.
+ * Read sound.cfg and map events to sounds; then decode all the sounds into
+ * memory to avoid I/O and decoding latency later.
  */
-static bool sound_sdl_init(bool no_cache)
+static bool sound_sdl_init(void)
 {
 	char path[2048];
 	char buffer[2048];
 	ang_file *fff;
 
+	/* Decoded samples, until they are packed */
+	static Mix_Chunk *chunks[MSG_MAX][MAX_SAMPLES];
+
 
 	/* Initialise the mixer  */
 	if (!open_audio())
@@ -202,7 +347,6 @@ static bool sound_sdl_init(bool no_cache)
          */
         while (cur_token) {
 			int num = samples[event].num;
-			bool got_file_type = FALSE;
 
 			/* Don't allow too many samples */
 			if (num >= MAX_SAMPLES) break;
@@ -211,32 +355,11 @@ static bool sound_sdl_init(bool no_cache)
 			path_build(path, sizeof(path), ANGBAND_DIR_XTRA_SOUND, cur_token);
 			if (!file_exists(path)) goto next_token;
 
-			if (!got_file_type) {
-			        if (streq(path + strlen(path) - 3, "mp3")) {
-				        use_mp3 = TRUE;
-					got_file_type = TRUE;
-				}
-			}
-
-			/* Don't load now if we're not caching */
-			if (no_cache) {
-				/* Just save the path for later */
-				samples[event].paths[num] = string_make(path);
-			} else {
-				/* Load the file now */
-				if (use_mp3) {
-					samples[event].mp3s[num] = Mix_LoadMUS(path);
-					if (!samples[event].mp3s[num]) {
-						plog_fmt("%s: %s", SDL_GetError(), strerror(errno));
-						goto next_token;
-					}
-				} else {
-					samples[event].wavs[num] = Mix_LoadWAV(path);
-					if (!samples[event].wavs[num]) {
-					        plog_fmt("%s: %s", SDL_GetError(), strerror(errno));
-						goto next_token;
-					}
-				}
+			/* Decode the file now, into the mixer's format */
+			chunks[event][num] = Mix_LoadWAV(path);
+			if (!chunks[event][num]) {
+				plog_fmt("%s: %s", SDL_GetError(), strerror(errno));
+				goto next_token;
 			}
 
 			/* Imcrement the sample count */
@@ -265,6 +388,12 @@ static bool sound_sdl_init(bool no_cache)
 	/* Close the file */
 	file_close(fff);
 
+	/* Keep the samples together */
+	pack_samples(chunks);
+
+	/* Mix them ourselves; SDL_mixer's own channels are not used */
+	Mix_AllocateChannels(0);
+	Mix_SetPostMix(mix_voices, NULL);
 
 	/* Success */
 	return TRUE;
@@ -272,11 +401,11 @@ static bool sound_sdl_init(bool no_cache)
 
 /**
  * Play a sound of type "event".
+ *
+ * This only queues the sample for the audio thread, so it never waits on it.
  */
 static void play_sound(game_event_type type, game_event_data *data, void *user)
 {
-	Mix_Chunk *wave = NULL;
-	Mix_Music *mp3 = NULL;
 	int s;
 
 	int event = data->message.type;
@@ -287,37 +416,16 @@ static void play_sound(game_event_type type, game_event_data *data, void *user)
 	/* Check there are samples for this event */
 	if (!samples[event].num) return;
 
-	/* Choose a random event */
-	s = randint0(samples[event].num);
-	if (use_mp3)
-	        mp3 = samples[event].mp3s[s];
-	else
-	        wave = samples[event].wavs[s];
-
-	/* Try loading it, if it's not cached */
-	if (!(wave || mp3)) {
-		/* Verify it exists */
-		const char *filename = samples[event].paths[s];
-		if (!file_exists(filename)) return;
-
-		/* Load */
-		if (use_mp3)
-		        mp3 = Mix_LoadMUS(filename);
-		else
-		        wave = Mix_LoadWAV(filename);
-	}
+	/* Drop the sound if the audio thread is that far behind */
+	if (trigger_head - trigger_tail >= TRIGGER_QUEUE) return;
 
-	/* Check to see if we have a sound again */
-	if (!(wave || mp3)) {
-		plog("SDL sound load failed.");
-		return;
-	}
+	/* Choose a random event */
+	s = Rand_simple(samples[event].num);
 
-	/* Actually play the thing */
-	if (use_mp3)
-	        Mix_PlayMusic(mp3, 1);
-	else
-	        Mix_PlayChannel(-1, wave, 0);
+	/* Hand it over */
+	trigger_queue[trigger_head & (TRIGGER_QUEUE - 1)] = &samples[event].smps[s];
+	TRIGGER_BARRIER();
+	trigger_head++;
 }
 
 
@@ -326,19 +434,12 @@ static void play_sound(game_event_type type, game_event_data *data, void *user)
  */
 errr init_sound_sdl(int argc, char **argv)
 {
-	int i;
-
-	/* Parse args */
-	for (i = 1; i < argc; i++) {
-		if (prefix(argv[i], "-c")) {
-			no_cache_audio = TRUE;
-			plog("Audio cache disabled.");
-			continue;
-		}
-	}
+	/* Unused */
+	(void)argc;
+	(void)argv;
 
 	/* Load sound preferences if requested */
-	if (!sound_sdl_init(no_cache_audio)) {
+	if (!sound_sdl_init()) {
 		plog("Failed to load sound config");
 
 		/* Failure */
@@ -0,0 +1,166 @@
+/**
+ * \file stats/cols.c
+ * \brief Columnar storage of stats counts
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational,
+ *    research,
+ *    and not for profit purposes provided that this copyright and
+ *    statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "stats/cols.h"
+
+/**
+ * Each table goes in its own <table>.col file, laid out as:
+ *
+ *   "ANGCOLS1"               magic and format version
+ *   ncols                    number of columns
+ *   ncols * (len, name)      column names, without terminators
+ *   chunks                   each one nrows, then nrows values of the first
+ *                            column, nrows of the second, and so on
+ *   0                        an empty chunk ends the file
+ *
+ * Every number is an unsigned 32-bit little-endian integer.  Chunks hold at
+ * most STATS_COLS_CHUNK rows, so memory use doesn't grow with the table; a
+ * reader can map each chunk's columns straight into arrays.
+ */
+#define STATS_COLS_MAGIC "ANGCOLS1"
+#define STATS_COLS_CHUNK 4096
+#define STATS_COLS_MAX 8
+
+struct stats_cols {
+	ang_file *f;
+	char path[1024];
+	char tmp[1024];
+	int ncols;
+	u32b nrows;
+	bool ok;
+	byte *buf;		/* Column-major, STATS_COLS_CHUNK values per column */
+};
+
+static void stats_cols_put(byte *p, u32b value)
+{
+	p[0] = value & 0xFF;
+	p[1] = (value >> 8) & 0xFF;
+	p[2] = (value >> 16) & 0xFF;
+	p[3] = (value >> 24) & 0xFF;
+}
+
+static void stats_cols_write_u32b(struct stats_cols *c, u32b value)
+{
+	byte p[4];
+
+	stats_cols_put(p, value);
+	if (c->ok && !file_write(c->f, (const char *)p, sizeof(p)))
+		c->ok = FALSE;
+}
+
+static void stats_cols_flush(struct stats_cols *c)
+{
+	int i;
+
+	if (!c->nrows) return;
+
+	stats_cols_write_u32b(c, c->nrows);
+	for (i = 0; i < c->ncols && c->ok; i++)
+		if (!file_write(c->f, (const char *)c->buf + i * STATS_COLS_CHUNK * 4,
+						c->nrows * 4))
+			c->ok = FALSE;
+
+	c->nrows = 0;
+}
+
+/**
+ * Start writing table 'table' in directory 'dir'.  'columns' names the
+ * columns, separated by commas.  The file is written to one side and only
+ * replaces any earlier copy when stats_cols_close() succeeds, so a
+ * checkpoint never leaves half a table.  Returns NULL on failure.
+ */
+struct stats_cols *stats_cols_open(const char *dir, const char *table,
+								   const char *columns)
+{
+	struct stats_cols *c = mem_zalloc(sizeof(*c));
+	char name[80];
+	const char *s;
+
+	strnfmt(name, sizeof(name), "%s.col", table);
+	path_build(c->path, sizeof(c->path), dir, name);
+	strnfmt(c->tmp, sizeof(c->tmp), "%s.new", c->path);
+
+	c->f = file_open(c->tmp, MODE_WRITE, FTYPE_RAW);
+	if (!c->f) {
+		mem_free(c);
+		return NULL;
+	}
+	c->ok = file_write(c->f, STATS_COLS_MAGIC, strlen(STATS_COLS_MAGIC));
+
+	/* Count the columns, then name them */
+	c->ncols = 1;
+	for (s = columns; *s; s++)
+		if (*s == ',') c->ncols++;
+	assert(c->ncols <= STATS_COLS_MAX);
+	stats_cols_write_u32b(c, c->ncols);
+
+	for (s = columns; *s; ) {
+		size_t len = strcspn(s, ",");
+
+		stats_cols_write_u32b(c, len);
+		if (c->ok && !file_write(c->f, s, len))
+			c->ok = FALSE;
+		s += len;
+		if (*s) s++;
+	}
+
+	c->buf = mem_alloc(c->ncols * STATS_COLS_CHUNK * 4);
+
+	return c;
+}
+
+/**
+ * Add a row of 'ncols' values to a table
+ */
+bool stats_cols_row(struct stats_cols *c, const u32b *values)
+{
+	int i;
+
+	for (i = 0; i < c->ncols; i++)
+		stats_cols_put(c->buf + (i * STATS_COLS_CHUNK + c->nrows) * 4,
+					   values[i]);
+
+	if (++c->nrows == STATS_COLS_CHUNK)
+		stats_cols_flush(c);
+
+	return c->ok;
+}
+
+/**
+ * Finish a table and put it in place, returning whether it all got written
+ */
+bool stats_cols_close(struct stats_cols *c)
+{
+	bool ok;
+
+	stats_cols_flush(c);
+	stats_cols_write_u32b(c, 0);
+
+	ok = file_close(c->f) && c->ok;
+	if (ok) {
+		if (file_exists(c->path))
+			file_delete(c->path);
+		ok = file_move(c->tmp, c->path);
+	}
+
+	mem_free(c->buf);
+	mem_free(c);
+
+	return ok;
+}
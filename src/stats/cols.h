@@ -0,0 +1,29 @@
+/**
+ * \file stats/cols.h
+ * Purpose: interface to columnar stats output
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational,
+ *    research,
+ *    and not for profit purposes provided that this copyright and
+ *    statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef STATS_COLS_H
+#define STATS_COLS_H
+
+struct stats_cols;
+
+extern struct stats_cols *stats_cols_open(const char *dir, const char *table,
+										  const char *columns);
+extern bool stats_cols_row(struct stats_cols *c, const u32b *values);
+extern bool stats_cols_close(struct stats_cols *c);
+
+#endif /* STATS_COLS_H */
@@ -32,6 +32,17 @@ static sqlite3 *db;
 static char *ANGBAND_DIR_STATS;
 static char *db_filename;
 
+/**
+ * Statements kept prepared between checkpoints, found by their SQL
+ */
+struct stats_db_cached_stmt {
+	char *sql_str;
+	sqlite3_stmt *sql_stmt;
+	struct stats_db_cached_stmt *next;
+};
+
+static struct stats_db_cached_stmt *cached_stmts;
+
 /**
  * Utility functions
  */
@@ -55,10 +66,12 @@ static bool stats_make_output_dir(void) {
 /**
  * Call stats_db_open first to create the database file and set up a 
  * database connection. Returns true on success, false on failure.
+ * A nonzero seed is added to the file name, so that processes started
+ * together with different seeds don't collide.
  */
-bool stats_db_open(void) {
+bool stats_db_open(u32b seed) {
 	size_t size;
-	char filename_buf[20];
+	char filename_buf[30];
 	int result;
 	time_t now_time = time(NULL);
 	struct tm *now = localtime(&now_time);
@@ -67,11 +80,16 @@ bool stats_db_open(void) {
 		return false;
 	}
 
-	size = strlen(ANGBAND_DIR_STATS) + strlen(PATH_SEP) + 20;
+	size = strlen(ANGBAND_DIR_STATS) + strlen(PATH_SEP) + 30;
 	db_filename = mem_alloc(size * sizeof(char));
-	strnfmt(filename_buf, 20, "%4d-%02d-%02dT%02d:%02d.db",
-		now->tm_year + 1900, now->tm_mon + 1, now->tm_mday,
-		now->tm_hour, now->tm_min);
+	if (seed)
+		strnfmt(filename_buf, 30, "%4d-%02d-%02dT%02d:%02d-%08lx.db",
+			now->tm_year + 1900, now->tm_mon + 1, now->tm_mday,
+			now->tm_hour, now->tm_min, (unsigned long)seed);
+	else
+		strnfmt(filename_buf, 30, "%4d-%02d-%02dT%02d:%02d.db",
+			now->tm_year + 1900, now->tm_mon + 1, now->tm_mday,
+			now->tm_hour, now->tm_min);
 	path_build(db_filename, size, ANGBAND_DIR_STATS, filename_buf);
 
 	if (file_exists(db_filename)) {
@@ -92,12 +110,27 @@ bool stats_db_open(void) {
  * module variables.
  */
 bool stats_db_close(void) {
+	while (cached_stmts) {
+		struct stats_db_cached_stmt *next = cached_stmts->next;
+		sqlite3_finalize(cached_stmts->sql_stmt);
+		string_free(cached_stmts->sql_str);
+		mem_free(cached_stmts);
+		cached_stmts = next;
+	}
+
 	sqlite3_close(db);
 	mem_free(ANGBAND_DIR_STATS);
 	mem_free(db_filename);
 	return true;
 }
 
+/**
+ * The path of the open database file
+ */
+const char *stats_db_path(void) {
+	return db_filename;
+}
+
 /**
  * Evaluate a sqlite3 SQL statement on the previously opened database.
  * The argument sql_str should contain the SQL statement, encoded as UTF-8.
@@ -128,6 +161,37 @@ int stats_db_stmt_prep(sqlite3_stmt **sql_stmt, char *sql_str) {
 		sql_stmt, NULL);
 }
 
+/**
+ * Find a statement prepared by an earlier call with the same SQL, or
+ * prepare and remember a new one.  The statement belongs to this module
+ * and is finalized by stats_db_close(), so callers should leave it reset
+ * rather than finalizing it.  Returns 0 on success or a sqlite3 error
+ * code on failure.
+ */
+
+int stats_db_stmt_cached(sqlite3_stmt **sql_stmt, char *sql_str) {
+	struct stats_db_cached_stmt *c;
+	int err;
+
+	for (c = cached_stmts; c; c = c->next) {
+		if (streq(c->sql_str, sql_str)) {
+			*sql_stmt = c->sql_stmt;
+			return SQLITE_OK;
+		}
+	}
+
+	err = stats_db_stmt_prep(sql_stmt, sql_str);
+	if (err) return err;
+
+	c = mem_zalloc(sizeof(*c));
+	c->sql_str = string_make(sql_str);
+	c->sql_stmt = *sql_stmt;
+	c->next = cached_stmts;
+	cached_stmts = c;
+
+	return SQLITE_OK;
+}
+
 /**
  * Utility function for binding many ints at once. The offset argument 
  * should be the number of columns to skip before starting to bind. 
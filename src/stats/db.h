@@ -41,10 +41,12 @@
 	err = sqlite3_finalize(s);\
 	if (err) return err;
 
-extern bool stats_db_open(void);
+extern bool stats_db_open(u32b seed);
 extern bool stats_db_close(void);
+extern const char *stats_db_path(void);
 extern int stats_db_exec(char *sql_str);
 extern int stats_db_stmt_prep(sqlite3_stmt **sql_stmt, char *sql_str);
+extern int stats_db_stmt_cached(sqlite3_stmt **sql_stmt, char *sql_str);
 extern int stats_db_bind_ints(sqlite3_stmt *sql_stmt, int num_cols, 
 							  int offset, ...);
 extern int stats_db_bind_rv(sqlite3_stmt *sql_stmt, int col,
@@ -557,16 +557,12 @@ static bool store_will_buy(struct store *store, const struct object *obj)
  *
  * Hack -- the black market always charges twice as much as it should.
  */
-int price_item(struct store *store, const struct object *obj,
-			   bool store_buying, int qty)
+static int price_item_aux(struct store *store, const struct object *obj,
+						  bool store_buying, int qty)
 {
 	int adjust = 100;
 	int price;
-	struct owner *proprietor;
-
-	if (!store) return 0L;
-
-	proprietor = store->owner;
+	struct owner *proprietor = store->owner;
 
 	/* Get the value of the stack of wands, or a single item */
 	if (tval_can_have_charges(obj))
@@ -630,6 +626,42 @@ int price_item(struct store *store, const struct object *obj,
 	return (price);
 }
 
+/**
+ * Recently worked out prices, so that redrawing a shop's list doesn't value
+ * every object again.  They are kept like remembered descriptions (see
+ * object_memo_find()), keyed also by the shop, its owner and the quantity.
+ */
+#define PRICE_CACHE_SIZE 64
+
+static struct price_cache_entry {
+	struct object_memo memo;
+	int price;
+} price_cache[PRICE_CACHE_SIZE];
+
+int price_item(struct store *store, const struct object *obj,
+			   bool store_buying, int qty)
+{
+	struct price_cache_entry *entry;
+	size_t key[OBJECT_MEMO_KEYS];
+	bool hit;
+
+	if (!store) return 0L;
+
+	key[0] = (size_t)store;
+	key[1] = (size_t)store->owner;
+	key[2] = qty;
+	key[3] = (store_buying ? 2 : 0) | (obj->kind->aware ? 1 : 0);
+	entry = (struct price_cache_entry *)object_memo_find(price_cache,
+		PRICE_CACHE_SIZE, sizeof(*entry), obj, key, &hit);
+	if (hit)
+		return entry->price;
+
+	entry->price = price_item_aux(store, obj, store_buying, qty);
+	object_memo_fill(&entry->memo, obj, key);
+
+	return entry->price;
+}
+
 
 /**
  * Special "mass production" computation.
@@ -1243,10 +1275,12 @@ static void store_maint(struct store *s)
 
 	/* Destroy crappy black market items */
 	if (s->sidx == STORE_B_MARKET) {
-		struct object *obj;
-		for (obj = s->stock; obj; obj = obj->next) {
+		struct object *obj = s->stock;
+		while (obj) {
+			struct object *next = obj->next;
 			if (!black_market_ok(obj))
 				store_delete(s, obj, obj->number);
+			obj = next;
 		}
 	}
 
@@ -1338,18 +1372,26 @@ static void store_maint(struct store *s)
 	}
 }
 
+/**
+ * Days of maintenance after which nothing stocked before is still there;
+ * the shops then look the same however much longer the player was away
+ */
+#define STORE_MAINT_DAYS_MAX 30
+
 /**
  * Update the stores on the return to town.
  */
 void store_update(void)
 {
+	int day;
+
 	if (OPT(cheat_xtra)) msg("Updating Shops...");
-	while (daycount--)
+	for (day = daycount; day > 0; day--)
 	{
 		int n;
 
-		/* Maintain each shop (except home) */
-		for (n = 0; n < MAX_STORES; n++)
+		/* Maintain each shop (except home) on the last days only */
+		for (n = 0; n < MAX_STORES && day <= STORE_MAINT_DAYS_MAX; n++)
 		{
 			/* Skip the home */
 			if (n == STORE_HOME) continue;
@@ -418,6 +418,21 @@ bool target_sighted(void)
 
 #define TS_INITIAL_SIZE	20
 
+/**
+ * Sort comparator putting locations in the order a scan of the map meets them
+ */
+static int cmp_scan_order(const void *a, const void *b)
+{
+	const struct loc *pa = a;
+	const struct loc *pb = b;
+
+	if (pa->y != pb->y)
+		return pa->y < pb->y ? -1 : 1;
+	if (pa->x != pb->x)
+		return pa->x < pb->x ? -1 : 1;
+	return 0;
+}
+
 /**
  * Return a target set of target_able monsters.
  */
@@ -430,27 +445,46 @@ struct point_set *target_get_monsters(int mode)
 	/* Get the current panel */
 	get_panel(&min_y, &min_x, &max_y, &max_x);
 
-	/* Scan for targets */
-	for (y = min_y; y < max_y; y++) {
-		for (x = min_x; x < max_x; x++) {
-			/* Check bounds */
-			if (!square_in_bounds_fully(cave, y, x)) continue;
+	if (mode & (TARGET_KILL)) {
+		int i;
 
-			/* Require "interesting" contents */
-			if (!target_accept(y, x)) continue;
+		/* Only targettable monsters will do, so go straight to them */
+		for (i = 1; i < cave_monster_max(cave); i++) {
+			struct monster *mon = cave_monster(cave, i);
 
-			/* Special mode */
-			if (mode & (TARGET_KILL)) {
-				/* Must contain a monster */
-				if (!(cave->squares[y][x].mon > 0)) continue;
+			/* Skip dead monsters */
+			if (!mon->race) continue;
 
-				/* Must be a targettable monster */
-			 	if (!target_able(square_monster(cave, y, x))) continue;
-			}
+			/* Must be on the panel */
+			y = mon->fy;
+			x = mon->fx;
+			if (y < min_y || y >= max_y || x < min_x || x >= max_x) continue;
+			if (!square_in_bounds_fully(cave, y, x)) continue;
+
+			/* Must be a targettable monster */
+			if (!target_able(mon)) continue;
 
 			/* Save the location */
 			add_to_point_set(targets, y, x);
 		}
+
+		/* Ties in distance then go as they would from a scan of the panel */
+		sort(targets->pts, point_set_size(targets), sizeof(*(targets->pts)),
+			 cmp_scan_order);
+	} else {
+		/* Scan for targets */
+		for (y = min_y; y < max_y; y++) {
+			for (x = min_x; x < max_x; x++) {
+				/* Check bounds */
+				if (!square_in_bounds_fully(cave, y, x)) continue;
+
+				/* Require "interesting" contents */
+				if (!target_accept(y, x)) continue;
+
+				/* Save the location */
+				add_to_point_set(targets, y, x);
+			}
+		}
 	}
 
 	sort(targets->pts, point_set_size(targets), sizeof(*(targets->pts)),
@@ -0,0 +1,169 @@
+/* bench.c
+ *
+ * Framework for micro-benchmarks.  Each benchmark is run from the same seed,
+ * first with more and more operations until it has warmed up, then for a
+ * few timed samples, and the time per operation is reported as CSV or JSON.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "cmd-core.h"
+#include "game-event.h"
+#include "game-world.h"
+#include "init.h"
+#include "player.h"
+#include "z-rand.h"
+#include "z-util.h"
+
+#define BENCH_SAMPLES 5
+
+volatile u32b bench_sink;
+
+static u32b seed = 42;
+static double warmup = 0.05;
+static double sample = 0.1;
+static bool json = FALSE;
+
+/**
+ * Time 'n' operations of a benchmark, in seconds, from the fixed seed
+ */
+static double bench_time(const struct bench *b, void *state, int n)
+{
+	clock_t start;
+
+	Rand_quick = FALSE;
+	Rand_state_init(seed);
+
+	start = clock();
+	b->func(state, n);
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+static void bench_run(const struct bench *b, void *state, bool first)
+{
+	double t, ns[BENCH_SAMPLES];
+	int n = 1, i;
+
+	/* Warm up, finding out roughly how long an operation takes */
+	while ((t = bench_time(b, state, n)) < warmup && n < 0x40000000)
+		n *= 2;
+
+	/* Then take samples of about the same length */
+	if (t > 0)
+		n = MAX(1, (int)(n * (sample / t)));
+	for (i = 0; i < BENCH_SAMPLES; i++)
+		ns[i] = bench_time(b, state, n) * 1e9 / n;
+	qsort(ns, BENCH_SAMPLES, sizeof(ns[0]), compare_doubles);
+
+	if (json)
+		printf("%s\n    { \"name\": \"%s\", \"iterations\": %d, "
+			   "\"samples\": %d, \"ns_per_op\": %.1f, \"min_ns_per_op\": %.1f }",
+			   first ? "" : ",", b->name, n, BENCH_SAMPLES,
+			   ns[BENCH_SAMPLES / 2], ns[0]);
+	else
+		printf("%s,%s,%d,%d,%.1f,%.1f\n", suite_name, b->name, n,
+			   BENCH_SAMPLES, ns[BENCH_SAMPLES / 2], ns[0]);
+	fflush(stdout);
+}
+
+static void usage(const char *prog)
+{
+	printf("Usage: %s [-j] [-s seed] [-w warmup-ms] [-t sample-ms] [name...]\n",
+		   prog);
+	exit(1);
+}
+
+int main(int argc, char *argv[]) {
+	void *state;
+	bool first = TRUE;
+	int i, j;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (streq(argv[i], "-j"))
+			json = TRUE;
+		else if (streq(argv[i], "-s") && i + 1 < argc)
+			seed = strtoul(argv[++i], NULL, 0);
+		else if (streq(argv[i], "-w") && i + 1 < argc)
+			warmup = atoi(argv[++i]) / 1000.0;
+		else if (streq(argv[i], "-t") && i + 1 < argc)
+			sample = atoi(argv[++i]) / 1000.0;
+		else
+			usage(argv[0]);
+	}
+
+	if (setup_benches(&state)) {
+		fprintf(stderr, "ERROR: %s setup failed\n", suite_name);
+		return 1;
+	}
+
+	if (json)
+		printf("{ \"suite\": \"%s\", \"seed\": %lu, \"benchmarks\": [",
+			   suite_name, (unsigned long)seed);
+	else
+		printf("suite,name,iterations,samples,ns_per_op,min_ns_per_op\n");
+
+	for (j = 0; benches[j].name; j++) {
+		int k;
+
+		/* Any names given pick out the benchmarks to run */
+		for (k = i; k < argc; k++)
+			if (streq(argv[k], benches[j].name)) break;
+		if (i < argc && k == argc) continue;
+
+		bench_run(&benches[j], state, first);
+		first = FALSE;
+	}
+
+	if (json)
+		printf("\n] }\n");
+
+	if (teardown_benches(state)) {
+		fprintf(stderr, "ERROR: %s teardown failed\n", suite_name);
+		return 1;
+	}
+
+	return 0;
+}
+
+static void println(const char *str) {
+	fprintf(stderr, "%s\n", str);
+}
+
+void bench_new_game(void) {
+	plog_aux = println;
+	event_set_headless(TRUE);
+
+	set_file_paths();
+	init_angband();
+
+	/* The same character on the same level every time */
+	Rand_quick = FALSE;
+	Rand_state_init(seed);
+
+	cmdq_push(CMD_BIRTH_INIT);
+	cmdq_push(CMD_BIRTH_RESET);
+	cmdq_push(CMD_CHOOSE_RACE);
+	cmd_set_arg_choice(cmdq_peek(), "choice", 0);
+	cmdq_push(CMD_CHOOSE_CLASS);
+	cmd_set_arg_choice(cmdq_peek(), "choice", 0);
+	cmdq_push(CMD_ROLL_STATS);
+	cmdq_push(CMD_NAME_CHOICE);
+	cmd_set_arg_string(cmdq_peek(), "name", "Bench");
+	cmdq_push(CMD_ACCEPT_CHARACTER);
+	cmdq_execute(CMD_BIRTH);
+
+	player->depth = 5;
+	cave_generate(&cave, player);
+	on_new_level();
+}
@@ -0,0 +1,32 @@
+/* bench.h
+ *
+ * Framework for micro-benchmarks, laid out like unit-test.h
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "h-basic.h"
+
+/**
+ * A benchmark does its operation 'n' times; anything it sets up for itself
+ * is timed along with it, so that belongs in setup_benches()
+ */
+struct bench {
+	const char *name;
+	void (*func)(void *state, int n);
+};
+
+/* Supplied by each benchmark suite */
+extern const char *suite_name;
+extern struct bench benches[];
+extern int setup_benches(void **state);
+extern int teardown_benches(void *state);
+
+/* Results go here, so that the work can't be left out */
+extern volatile u32b bench_sink;
+
+/* Start a new character on a fresh level, with the whole game loaded */
+extern void bench_new_game(void);
+
+#endif /* !BENCH_H */
@@ -0,0 +1,103 @@
+/* cave/bench
+ *
+ * Time the sight, view, flow and projection code on a generated level.
+ */
+
+#include "bench.h"
+#include "cave.h"
+#include "init.h"
+#include "player.h"
+#include "project.h"
+
+#define BENCH_PAIRS 4096
+
+static struct loc targets[BENCH_PAIRS];
+
+int setup_benches(void **state) {
+	u32b lcg = 1;
+	int i;
+
+	bench_new_game();
+
+	/* Grids within sight of the player, the same ones every time */
+	for (i = 0; i < BENCH_PAIRS; i++) {
+		int y, x;
+
+		do {
+			lcg = lcg * 1103515245 + 12345;
+			y = player->py + (int)((lcg >> 16) % 41) - 20;
+			lcg = lcg * 1103515245 + 12345;
+			x = player->px + (int)((lcg >> 16) % 41) - 20;
+		} while (!square_in_bounds(cave, y, x));
+		targets[i] = loc(x, y);
+	}
+
+	*state = 0;
+	return 0;
+}
+
+int teardown_benches(void *state) {
+	cleanup_angband();
+	return 0;
+}
+
+static void bench_los(void *state, int n) {
+	int i;
+
+	for (i = 0; i < n; i++) {
+		struct loc t = targets[i % BENCH_PAIRS];
+		bench_sink += los(cave, player->py, player->px, t.y, t.x);
+	}
+}
+
+static void bench_update_view(void *state, int n) {
+	int i;
+
+	for (i = 0; i < n; i++) {
+		cave->view_changed = TRUE;
+		update_view(cave, player);
+	}
+}
+
+static void bench_update_flow(void *state, int n) {
+	int i;
+
+	for (i = 0; i < n; i++) {
+		cave->flow_dirty = TRUE;
+		cave_update_flow(cave);
+	}
+}
+
+static void bench_distances(void *state, int n) {
+	int grids = cave->height * cave->width;
+	u16b *dist = mem_alloc(grids * sizeof(u16b));
+	int *queue = mem_alloc(grids * sizeof(int));
+	struct loc from = loc(player->px, player->py);
+	int i;
+
+	for (i = 0; i < n; i++)
+		bench_sink += cave_distances(cave, PLANE_PASSABLE, &from, 1, dist,
+									 queue);
+
+	mem_free(dist);
+	mem_free(queue);
+}
+
+static void bench_project(void *state, int n) {
+	int flg = PROJECT_GRID | PROJECT_ITEM | PROJECT_KILL | PROJECT_HIDE;
+	int i;
+
+	for (i = 0; i < n; i++)
+		bench_sink += project(-1, 3, player->py, player->px, 0, GF_LIGHT_WEAK,
+							  flg, 0, 0);
+}
+
+const char *suite_name = "cave/bench";
+struct bench benches[] = {
+	{ "los", bench_los },
+	{ "update_view", bench_update_view },
+	{ "cave_update_flow", bench_update_flow },
+	{ "cave_distances", bench_distances },
+	{ "project", bench_project },
+	{ NULL, NULL }
+};
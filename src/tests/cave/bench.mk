@@ -0,0 +1 @@
+BENCHPROGS += cave/bench
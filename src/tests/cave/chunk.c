@@ -0,0 +1,96 @@
+/* cave/chunk
+ *
+ * Check that saved chunks can be found by name as they are added and
+ * removed, and that they shed their play-only state when stored.
+ */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "generate.h"
+#include "init.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	chunk_list_free();
+	return 0;
+}
+
+static struct chunk *named_chunk(const char *name)
+{
+	struct chunk *c = cave_new(3, 3);
+	c->name = string_make(name);
+	return c;
+}
+
+int test_find(void *state) {
+	struct chunk *added[40];
+	char name[20];
+	int i;
+
+	null(chunk_find_name("Town"));
+
+	for (i = 0; i < 40; i++) {
+		strnfmt(name, sizeof(name), "Level %d", i);
+		added[i] = named_chunk(name);
+		chunk_list_add(added[i]);
+	}
+	eq(chunk_list_max, 40);
+
+	/* Stored chunks without monsters don't keep a monster list */
+	null(added[0]->monsters);
+
+	for (i = 0; i < 40; i++) {
+		strnfmt(name, sizeof(name), "Level %d", i);
+		ptreq(chunk_find_name(name), added[i]);
+	}
+	null(chunk_find_name("Level 40"));
+
+	/* A later chunk of the same name doesn't hide the first */
+	chunk_list_add(named_chunk("Level 7"));
+	ptreq(chunk_find_name("Level 7"), added[7]);
+
+	ok;
+}
+
+int test_remove(void *state) {
+	char name[20];
+	int i;
+
+	/* Remove the even levels */
+	for (i = 0; i < 40; i += 2) {
+		struct chunk *c;
+		strnfmt(name, sizeof(name), "Level %d", i);
+		c = chunk_find_name(name);
+		eq(chunk_list_remove(name), TRUE);
+		cave_free(c);
+	}
+	eq(chunk_list_remove("Level 0"), FALSE);
+
+	for (i = 0; i < 40; i++) {
+		struct chunk *c;
+		strnfmt(name, sizeof(name), "Level %d", i);
+		c = chunk_find_name(name);
+		if (i % 2) {
+			notnull(c);
+			require(streq(c->name, name));
+		} else {
+			null(c);
+		}
+	}
+
+	ok;
+}
+
+const char *suite_name = "cave/chunk";
+struct test tests[] = {
+	{ "find", test_find },
+	{ "remove", test_remove },
+	{ NULL, NULL }
+};
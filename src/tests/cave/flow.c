@@ -0,0 +1,257 @@
+/* cave/flow
+ *
+ * Check that the flow, whether rebuilt or repaired after terrain changes,
+ * always matches a plain breadth-first search from the player, and that
+ * the distance fields follow changes in terrain and view.
+ */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "init.h"
+#include "player.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	player = &test_player;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	return 0;
+}
+
+/**
+ * Fill a chunk with granite at roughly the given percentage of grids, using
+ * a fixed LCG so that the layout is the same on every run.
+ */
+static void fill_chunk(struct chunk *c, int percent, u32b seed)
+{
+	int y, x;
+
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < c->width; x++) {
+			seed = seed * 1103515245 + 12345;
+			c->squares[y][x].feat = ((seed >> 16) % 100 < (u32b)percent) ?
+				FEAT_GRANITE : FEAT_FLOOR;
+			square_update_planes(c, y, x);
+		}
+	}
+}
+
+/**
+ * Does the flow agree with a full breadth-first search from the player?
+ */
+static bool flow_matches(struct chunk *c)
+{
+	int n = c->height * c->width;
+	int *dist = mem_alloc(n * sizeof(int));
+	int *queue = mem_alloc(n * sizeof(int));
+	int head = 0, tail = 0, i, d;
+	bool match = TRUE;
+
+	for (i = 0; i < n; i++) dist[i] = -1;
+	dist[player->py * c->width + player->px] = 0;
+	queue[tail++] = player->py * c->width + player->px;
+
+	while (head < tail) {
+		int grid = queue[head++];
+		int y = grid / c->width, x = grid % c->width;
+		if (dist[grid] + 1 >= z_info->max_flow_depth) continue;
+		for (d = 0; d < 8; d++) {
+			int yy = y + ddy_ddd[d], xx = x + ddx_ddd[d];
+			if (!square_in_bounds(c, yy, xx)) continue;
+			if (dist[yy * c->width + xx] >= 0) continue;
+			if (tf_has(f_info[c->squares[yy][xx].feat].flags, TF_NO_FLOW))
+				continue;
+			dist[yy * c->width + xx] = dist[grid] + 1;
+			queue[tail++] = yy * c->width + xx;
+		}
+	}
+
+	for (i = 0; i < n && match; i++) {
+		int y = i / c->width, x = i % c->width;
+		bool reached = (c->when[y][x] == c->flow_stamp);
+		if (reached != (dist[i] >= 0))
+			match = FALSE;
+		else if (reached && c->cost[y][x] != dist[i])
+			match = FALSE;
+	}
+
+	mem_free(dist);
+	mem_free(queue);
+	return match;
+}
+
+int test_flow_repair(void *state) {
+	struct chunk *c = cave_new(66, 198);
+	int i, y, x;
+
+	fill_chunk(c, 35, 7);
+	player->py = 33;
+	player->px = 99;
+	square_set_feat(c, player->py, player->px, FEAT_FLOOR);
+
+	cave_update_flow(c);
+	require(flow_matches(c));
+
+	/* Opening walls is repaired on the spot */
+	for (i = 0; i < 200; i++) {
+		y = 23 + (i * 7) % 20;
+		x = 79 + (i * 13) % 40;
+		square_set_feat(c, y, x, FEAT_FLOOR);
+		require(flow_matches(c));
+	}
+
+	/* Closing them is picked up by the next update */
+	for (i = 0; i < 50; i++) {
+		y = 23 + (i * 11) % 20;
+		x = 79 + (i * 17) % 40;
+		if (y == player->py && x == player->px) continue;
+		square_set_feat(c, y, x, FEAT_GRANITE);
+		cave_update_flow(c);
+		require(flow_matches(c));
+	}
+
+	/* So is the player moving */
+	for (i = 0; i < 8; i++) {
+		y = player->py + ddy_ddd[i];
+		x = player->px + ddx_ddd[i];
+		if (tf_has(f_info[c->squares[y][x].feat].flags, TF_NO_FLOW))
+			continue;
+		player->py = y;
+		player->px = x;
+		cave_update_flow(c);
+		require(flow_matches(c));
+	}
+
+	cave_free(c);
+	ok;
+}
+
+int test_field_stairs(void *state) {
+	struct chunk *c = cave_new(20, 40);
+	int y, x;
+
+	fill_chunk(c, 0, 1);
+	player->py = 1;
+	player->px = 1;
+	square_set_feat(c, 10, 5, FEAT_MORE);
+	square_set_feat(c, 3, 30, FEAT_LESS);
+
+	/* In the open, the nearest stairs are the king's-move distance away */
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < c->width; x++) {
+			int d1 = MAX(ABS(y - 10), ABS(x - 5));
+			int d2 = MAX(ABS(y - 3), ABS(x - 30));
+			eq(cave_field_dist(c, FIELD_STAIRS, y, x), MIN(d1, d2));
+		}
+	}
+
+	/* Wall off one staircase and the field follows */
+	for (y = 9; y <= 11; y++)
+		for (x = 4; x <= 6; x++)
+			if (y != 10 || x != 5)
+				square_set_feat(c, y, x, FEAT_GRANITE);
+	eq(cave_field_dist(c, FIELD_STAIRS, 10, 5), 0);
+	eq(cave_field_dist(c, FIELD_STAIRS, 10, 8), 22);
+	eq(cave_field_dist(c, FIELD_STAIRS, 10, 6), FIELD_UNREACHED);
+
+	cave_free(c);
+	ok;
+}
+
+int test_field_safety(void *state) {
+	struct chunk *c = cave_new(20, 40);
+	int y, x;
+
+	fill_chunk(c, 0, 1);
+	for (y = 0; y < c->height; y++)
+		for (x = 0; x < 30; x++)
+			sqinfo_on(c->squares[y][x].info, SQUARE_VIEW);
+	cave_fields_view_changed(c);
+
+	eq(cave_field_dist(c, FIELD_SAFETY, 10, 35), 0);
+	eq(cave_field_dist(c, FIELD_SAFETY, 10, 29), 1);
+	eq(cave_field_dist(c, FIELD_SAFETY, 10, 20), 10);
+
+	/* The field follows the view */
+	for (y = 0; y < c->height; y++)
+		sqinfo_off(c->squares[y][25].info, SQUARE_VIEW);
+	cave_fields_view_changed(c);
+	eq(cave_field_dist(c, FIELD_SAFETY, 10, 20), 5);
+
+	cave_free(c);
+	ok;
+}
+
+int test_field_route(void *state) {
+	struct chunk *c = cave_new(20, 80);
+
+	fill_chunk(c, 0, 1);
+	player->py = 10;
+	player->px = 5;
+	cave_update_flow(c);
+
+	/* The route leads to the player's sector, which the flow reaches */
+	eq(cave_field_dist(c, FIELD_ROUTE, 10, 5), 0);
+	eq(cave_field_dist(c, FIELD_ROUTE, 12, 7), 0);
+	eq(cave_field_dist(c, FIELD_ROUTE, 10, 75), 68);
+
+	/* And follows the player into another sector */
+	player->px = 45;
+	cave_update_flow(c);
+	eq(cave_field_dist(c, FIELD_ROUTE, 10, 75), 28);
+
+	cave_free(c);
+	ok;
+}
+
+int test_distances(void *state) {
+	struct chunk *c = cave_new(20, 40);
+	int n = c->height * c->width;
+	u16b *dist = mem_alloc(n * sizeof(u16b));
+	int *queue = mem_alloc(n * sizeof(int));
+	struct loc from[2] = { { 5, 10 }, { 30, 3 } };
+	int y, x;
+
+	fill_chunk(c, 0, 1);
+
+	/* From several sources at once, in the open */
+	eq(cave_distances(c, PLANE_PASSABLE, from, 2, dist, queue),
+	   (c->height - 2) * (c->width - 2));
+	for (y = 1; y < c->height - 1; y++) {
+		for (x = 1; x < c->width - 1; x++) {
+			int d1 = MAX(ABS(y - 10), ABS(x - 5));
+			int d2 = MAX(ABS(y - 3), ABS(x - 30));
+			eq(dist[y * c->width + x], MIN(d1, d2));
+		}
+	}
+	eq(dist[0], FIELD_UNREACHED);
+
+	/* A wall across the level cuts off the far side */
+	for (y = 0; y < c->height; y++)
+		square_set_feat(c, y, 20, FEAT_GRANITE);
+	eq(cave_distances(c, PLANE_PASSABLE, from, 1, dist, queue),
+	   (c->height - 2) * 19);
+	eq(dist[10 * c->width + 19], 14);
+	eq(dist[10 * c->width + 20], FIELD_UNREACHED);
+	eq(dist[3 * c->width + 30], FIELD_UNREACHED);
+
+	mem_free(dist);
+	mem_free(queue);
+	cave_free(c);
+	ok;
+}
+
+const char *suite_name = "cave/flow";
+struct test tests[] = {
+	{ "flow-repair", test_flow_repair },
+	{ "field-stairs", test_field_stairs },
+	{ "field-safety", test_field_safety },
+	{ "field-route", test_field_route },
+	{ "distances", test_distances },
+	{ NULL, NULL }
+};
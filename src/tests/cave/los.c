@@ -0,0 +1,293 @@
+/* cave/los
+ *
+ * Check that the table-driven los() agrees with the original
+ * Joseph Hall line of sight algorithm it replaced, and that the
+ * precomputed distance offsets are complete and in order, and that
+ * cached projection paths notice changes to the terrain.
+ */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+#include "test-utils.h"
+#include "cave.h"
+#include "init.h"
+#include "project.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cave_view_cleanup();
+	return 0;
+}
+
+/**
+ * The original los(), kept here as the reference result
+ */
+static bool los_reference(struct chunk *c, int y1, int x1, int y2, int x2)
+{
+	/* Delta */
+	int dx, dy;
+
+	/* Absolute */
+	int ax, ay;
+
+	/* Signs */
+	int sx, sy;
+
+	/* Fractions */
+	int qx, qy;
+
+	/* Scanners */
+	int tx, ty;
+
+	/* Scale factors */
+	int f1, f2;
+
+	/* Slope, or 1/Slope, of LOS */
+	int m;
+
+
+	/* Extract the offset */
+	dy = y2 - y1;
+	dx = x2 - x1;
+
+	/* Extract the absolute offset */
+	ay = ABS(dy);
+	ax = ABS(dx);
+
+
+	/* Handle adjacent (or identical) grids */
+	if ((ax < 2) && (ay < 2)) return (TRUE);
+
+
+	/* Directly South/North */
+	if (!dx) {
+		/* South -- check for walls */
+		if (dy > 0) {
+			for (ty = y1 + 1; ty < y2; ty++)
+				if (!square_isprojectable(c, ty, x1)) return (FALSE);
+		} else { /* North -- check for walls */
+			for (ty = y1 - 1; ty > y2; ty--)
+				if (!square_isprojectable(c, ty, x1)) return (FALSE);
+		}
+
+		/* Assume los */
+		return (TRUE);
+	}
+
+	/* Directly East/West */
+	if (!dy) {
+		/* East -- check for walls */
+		if (dx > 0) {
+			for (tx = x1 + 1; tx < x2; tx++)
+				if (!square_isprojectable(c, y1, tx)) return (FALSE);
+		} else { /* West -- check for walls */
+			for (tx = x1 - 1; tx > x2; tx--)
+				if (!square_isprojectable(c, y1, tx)) return (FALSE);
+		}
+
+		/* Assume los */
+		return (TRUE);
+	}
+
+
+	/* Extract some signs */
+	sx = (dx < 0) ? -1 : 1;
+	sy = (dy < 0) ? -1 : 1;
+
+	/* Vertical "knights" */
+	if ((ax == 1) && (ay == 2) && square_isprojectable(c, y1 + sy, x1))
+		return (TRUE);
+	
+	/* Horizontal "knights" */
+	else if ((ay == 1) && (ax == 2) && square_isprojectable(c, y1, x1 + sx))
+		return (TRUE);
+
+	/* Calculate scale factor div 2 */
+	f2 = (ax * ay);
+
+	/* Calculate scale factor */
+	f1 = f2 << 1;
+
+
+	/* Travel horizontally */
+	if (ax >= ay) {
+		/* Let m = dy / dx * 2 * (dy * dx) = 2 * dy * dy */
+		qy = ay * ay;
+		m = qy << 1;
+
+		tx = x1 + sx;
+
+		/* Consider the special case where slope == 1. */
+		if (qy == f2) {
+			ty = y1 + sy;
+			qy -= f1;
+		} else {
+			ty = y1;
+		}
+
+		/* Note (below) the case (qy == f2), where */
+		/* the LOS exactly meets the corner of a tile. */
+		while (x2 - tx) {
+			if (!square_isprojectable(c, ty, tx))
+				return (FALSE);
+
+			qy += m;
+
+			if (qy < f2) {
+				tx += sx;
+			} else if (qy > f2) {
+				ty += sy;
+				if (!square_isprojectable(c, ty, tx))
+					return (FALSE);
+				qy -= f1;
+				tx += sx;
+			} else {
+				ty += sy;
+				qy -= f1;
+				tx += sx;
+			}
+		}
+	} else { /* Travel vertically */
+		/* Let m = dx / dy * 2 * (dx * dy) = 2 * dx * dx */
+		qx = ax * ax;
+		m = qx << 1;
+
+		ty = y1 + sy;
+
+		if (qx == f2) {
+			tx = x1 + sx;
+			qx -= f1;
+		} else {
+			tx = x1;
+		}
+
+		/* Note (below) the case (qx == f2), where */
+		/* the LOS exactly meets the corner of a tile. */
+		while (y2 - ty) {
+			if (!square_isprojectable(c, ty, tx))
+				return (FALSE);
+
+			qx += m;
+
+			if (qx < f2) {
+				ty += sy;
+			} else if (qx > f2) {
+				tx += sx;
+				if (!square_isprojectable(c, ty, tx))
+					return (FALSE);
+				qx -= f1;
+				ty += sy;
+			} else {
+				tx += sx;
+				qx -= f1;
+				ty += sy;
+			}
+		}
+	}
+
+	/* Assume los */
+	return (TRUE);
+}
+
+/**
+ * Fill a chunk with granite at roughly the given percentage of grids, using
+ * a fixed LCG so that the layout is the same on every run.
+ */
+static void fill_chunk(struct chunk *c, int percent, u32b seed)
+{
+	int y, x;
+
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < c->width; x++) {
+			seed = seed * 1103515245 + 12345;
+			c->squares[y][x].feat = ((seed >> 16) % 100 < (u32b)percent) ?
+				FEAT_GRANITE : FEAT_FLOOR;
+			square_update_planes(c, y, x);
+		}
+	}
+}
+
+int test_los_matches(void *state) {
+	int percent, y1, x1, y2, x2;
+	struct chunk *c = cave_new(66, 198);
+
+	for (percent = 0; percent <= 60; percent += 15) {
+		fill_chunk(c, percent, 42 + percent);
+
+		for (y1 = 22; y1 < c->height; y1 += 21) {
+			for (x1 = 10; x1 < c->width; x1 += 37) {
+				for (y2 = 0; y2 < c->height; y2++) {
+					for (x2 = 0; x2 < c->width; x2++) {
+						eq(los(c, y1, x1, y2, x2),
+						   los_reference(c, y1, x1, y2, x2));
+					}
+				}
+			}
+		}
+	}
+
+	cave_free(c);
+	ok;
+}
+
+int test_distance_offsets(void *state) {
+	const struct loc *grids;
+	int d, i = 0, radius = z_info->max_sight;
+	int side = 2 * radius + 1;
+	int n = distance_offsets(radius, &grids);
+	int count = 0, dy, dx;
+
+	/* Every offset within range is listed, nearest first */
+	for (d = 0; d <= radius; d++) {
+		for (; i < distance_offsets(d, &grids); i++)
+			eq(distance(0, 0, grids[i].y, grids[i].x), d);
+	}
+	eq(i, n);
+
+	for (dy = -radius; dy <= radius; dy++)
+		for (dx = -radius; dx <= radius; dx++)
+			if (distance(0, 0, dy, dx) <= radius) count++;
+	eq(count, n);
+	require(n <= side * side);
+	ok;
+}
+
+int test_path_cache(void *state) {
+	struct loc first[64], second[64];
+	struct chunk *old = cave;
+	int n, i;
+
+	cave = cave_new(22, 66);
+	fill_chunk(cave, 0, 0);
+
+	/* The same question gets the same answer */
+	n = project_path(first, z_info->max_range, 10, 10, 10, 20, 0);
+	eq(n, 10);
+	eq(project_path(second, z_info->max_range, 10, 10, 10, 20, 0), n);
+	for (i = 0; i < n; i++) {
+		eq(second[i].y, first[i].y);
+		eq(second[i].x, first[i].x);
+	}
+
+	/* A new wall cuts the path short */
+	square_set_feat(cave, 10, 15, FEAT_GRANITE);
+	eq(project_path(second, z_info->max_range, 10, 10, 10, 20, 0), 5);
+	eq(projectable(cave, 10, 10, 10, 20, 0), FALSE);
+
+	cave_free(cave);
+	cave = old;
+	ok;
+}
+
+const char *suite_name = "cave/los";
+struct test tests[] = {
+	{ "los-matches", test_los_matches },
+	{ "distance-offsets", test_distance_offsets },
+	{ "path-cache", test_path_cache },
+	{ NULL, NULL }
+};
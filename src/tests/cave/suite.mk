@@ -0,0 +1,3 @@
+TESTPROGS += cave/los
+TESTPROGS += cave/flow
+TESTPROGS += cave/chunk
@@ -52,9 +52,56 @@ int test_cmd_lookup_rogue(void *state) {
 	ok;
 }
 
+int test_keymap_find(void *state) {
+	struct keypress actions[2] = { { EVT_KBRD, 'w', 0 }, { EVT_NONE, 0, 0 } };
+	struct keypress trigger = { EVT_KBRD, 0, 0 };
+	int i;
+
+	/* Enough keymaps that some share a hash bucket */
+	for (i = 0; i < 300; i++) {
+		trigger.code = i;
+		trigger.mods = i % 3;
+		actions[0].code = 'a' + i % 26;
+		keymap_add(KEYMAP_MODE_ORIG, trigger, actions, TRUE);
+	}
+
+	for (i = 0; i < 300; i++) {
+		const struct keypress *act;
+
+		trigger.code = i;
+		trigger.mods = i % 3;
+		act = keymap_find(KEYMAP_MODE_ORIG, trigger);
+		require(act && act[0].code == (keycode_t)('a' + i % 26));
+		require(act[1].type == EVT_NONE);
+
+		/* Same key, different modifiers */
+		trigger.mods = (i + 1) % 3;
+		require(!keymap_find(KEYMAP_MODE_ORIG, trigger));
+		require(!keymap_find(KEYMAP_MODE_ROGUE, trigger));
+	}
+
+	/* Replace one, remove another */
+	trigger.code = 7;
+	trigger.mods = 1;
+	actions[0].code = 'z';
+	keymap_add(KEYMAP_MODE_ORIG, trigger, actions, TRUE);
+	require(keymap_find(KEYMAP_MODE_ORIG, trigger)[0].code == 'z');
+	require(keymap_remove(KEYMAP_MODE_ORIG, trigger));
+	require(!keymap_find(KEYMAP_MODE_ORIG, trigger));
+	require(!keymap_remove(KEYMAP_MODE_ORIG, trigger));
+	trigger.code = 8;
+	trigger.mods = 2;
+	require(keymap_find(KEYMAP_MODE_ORIG, trigger)[0].code == 'a' + 8);
+
+	keymap_free();
+	require(!keymap_find(KEYMAP_MODE_ORIG, trigger));
+	ok;
+}
+
 const char *suite_name = "command/lookup";
 struct test tests[] = {
 	{ "cmd_lookup_orig",  test_cmd_lookup_orig },
 	{ "cmd_lookup_rogue", test_cmd_lookup_rogue },
+	{ "keymap_find",      test_keymap_find },
 	{ NULL, NULL }
 };
@@ -12,6 +12,7 @@
 #include "init.h"
 #include "savefile.h"
 #include "player.h"
+#include "player-attack.h"
 #include "player-timed.h"
 #include "z-util.h"
 
@@ -31,6 +32,9 @@ int setup_tests(void **state) {
 	event_add_handler(EVENT_MESSAGE, event_message, NULL);
 	event_add_handler(EVENT_INITSTATUS, event_message, NULL);
 
+	/* There is no display to update */
+	event_set_headless(TRUE);
+
 	/* Init the game */
 	set_file_paths();
 	init_angband();
@@ -173,6 +177,81 @@ int test_drop_eat(void *state) {
 	ok;
 }
 
+/* Sampled blows hit some of the time and never do negative damage */
+int test_attack_sample(void *state) {
+	struct monster mon;
+	int dam[200];
+	int i, hits, nonzero = 0;
+
+	eq(savefile_load("Test1", FALSE), TRUE);
+	memset(&mon, 0, sizeof(mon));
+	mon.race = &r_info[1];
+
+	hits = py_attack_sample(&mon, N_ELEMENTS(dam), dam);
+	require(hits > 0 && hits <= (int) N_ELEMENTS(dam));
+	for (i = 0; i < (int) N_ELEMENTS(dam); i++) {
+		require(dam[i] >= 0);
+		if (dam[i]) nonzero++;
+	}
+	require(nonzero <= hits);
+
+	ok;
+}
+
+static void walk_about(void) {
+	int i;
+
+	cmdq_push(CMD_WALK);
+	cmd_set_arg_direction(cmdq_peek(), "direction", 2);
+	run_game_loop();
+	cmdq_push(CMD_HOLD);
+	run_game_loop();
+	cmdq_push(CMD_WALK);
+	cmd_set_arg_direction(cmdq_peek(), "direction", 8);
+	run_game_loop();
+	cmdq_push(CMD_GO_DOWN);
+	run_game_loop();
+	for (i = 1; i < 10; i++) {
+		cmdq_push(CMD_WALK);
+		cmd_set_arg_direction(cmdq_peek(), "direction", i);
+		run_game_loop();
+	}
+}
+
+/* A restored snapshot is the same game, and plays on the same way each time */
+int test_snapshot(void *state) {
+	byte *start, *again, *played, *replayed;
+	u32b start_size, again_size, played_size, replayed_size;
+
+	eq(savefile_load("Test1", FALSE), TRUE);
+	start = savefile_snapshot(&start_size);
+	notnull(start);
+
+	eq(savefile_restore(start, start_size), TRUE);
+	eq(player->is_dead, FALSE);
+	notnull(cave);
+	again = savefile_snapshot(&again_size);
+	eq(again_size, start_size);
+	require(!memcmp(again, start, start_size));
+
+	on_new_level();
+	walk_about();
+	played = savefile_snapshot(&played_size);
+
+	eq(savefile_restore(start, start_size), TRUE);
+	on_new_level();
+	walk_about();
+	replayed = savefile_snapshot(&replayed_size);
+	eq(replayed_size, played_size);
+	require(!memcmp(replayed, played, played_size));
+
+	mem_free(start);
+	mem_free(again);
+	mem_free(played);
+	mem_free(replayed);
+	ok;
+}
+
 const char *suite_name = "game/basic";
 struct test tests[] = {
 	{ "newgame", test_newgame },
@@ -181,5 +260,7 @@ struct test tests[] = {
 	{ "stairs2", test_stairs2 },
 	{ "droppickup", test_drop_pickup },
 	{ "dropeat", test_drop_eat },
+	{ "attacksample", test_attack_sample },
+	{ "snapshot", test_snapshot },
 	{ NULL, NULL }
 };
@@ -0,0 +1,81 @@
+/* game/bench
+ *
+ * Time saving and loading a new character's game, working out the
+ * character's state from scratch, as every PU_BONUS does twice, and resting
+ * back to full on an empty level.
+ */
+
+#include "bench.h"
+#include "cave.h"
+#include "cmd-core.h"
+#include "game-world.h"
+#include "init.h"
+#include "mon-make.h"
+#include "player-calcs.h"
+#include "player-timed.h"
+#include "player-util.h"
+#include "savefile.h"
+#include "z-file.h"
+
+int setup_benches(void **state) {
+	bench_new_game();
+	*state = 0;
+	return !savefile_save("Bench1");
+}
+
+int teardown_benches(void *state) {
+	file_delete("Bench1");
+	cleanup_angband();
+	return 0;
+}
+
+static void bench_savefile_save(void *state, int n) {
+	int i;
+
+	for (i = 0; i < n; i++) {
+		/* A save that changes nothing isn't written, so change something */
+		turn++;
+		bench_sink += savefile_save("Bench1");
+	}
+}
+
+static void bench_savefile_load(void *state, int n) {
+	int i;
+
+	for (i = 0; i < n; i++)
+		bench_sink += savefile_load("Bench1", FALSE);
+}
+
+static void bench_calc_bonuses(void *state, int n) {
+	player_state st;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		calc_bonuses(player, &st, i % 2);
+		bench_sink += st.speed;
+	}
+}
+
+static void bench_rest(void *state, int n) {
+	int i;
+
+	for (i = 0; i < n; i++) {
+		/* Nothing to disturb the rest, or kill the resting character */
+		wipe_mon_list(cave, player);
+		player->chp = 1;
+		player->food = PY_FOOD_FULL - 1;
+		cmdq_push(CMD_REST);
+		cmd_set_arg_choice(cmdq_peek(), "choice", REST_COMPLETE);
+		run_game_loop();
+		bench_sink += turn;
+	}
+}
+
+const char *suite_name = "game/bench";
+struct bench benches[] = {
+	{ "savefile_save", bench_savefile_save },
+	{ "savefile_load", bench_savefile_load },
+	{ "calc_bonuses", bench_calc_bonuses },
+	{ "rest", bench_rest },
+	{ NULL, NULL }
+};
@@ -0,0 +1 @@
+BENCHPROGS += game/bench
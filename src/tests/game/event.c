@@ -0,0 +1,87 @@
+/* game/event */
+
+#include "unit-test.h"
+
+#include "game-event.h"
+
+int setup_tests(void **state) {
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	event_remove_all_handlers();
+	return 0;
+}
+
+static char calls[16];
+static int n_calls;
+
+static void note(game_event_type type, game_event_data *data, void *user) {
+	calls[n_calls++] = *(const char *)user;
+	calls[n_calls] = '\0';
+}
+
+static void remove_self(game_event_type type, game_event_data *data,
+						void *user) {
+	note(type, data, user);
+	event_remove_handler(type, remove_self, user);
+}
+
+static void add_another(game_event_type type, game_event_data *data,
+						void *user) {
+	note(type, data, user);
+	event_remove_handler(type, add_another, user);
+	event_add_handler(type, note, "z");
+}
+
+static void send(game_event_type type) {
+	n_calls = 0;
+	calls[0] = '\0';
+	event_signal(type);
+}
+
+/* Handlers are called newest first */
+int test_order(void *state) {
+	event_add_handler(EVENT_INPUT_FLUSH, note, "a");
+	event_add_handler(EVENT_INPUT_FLUSH, note, "b");
+	event_add_handler(EVENT_INPUT_FLUSH, note, "c");
+	send(EVENT_INPUT_FLUSH);
+	require(streq(calls, "cba"));
+
+	event_remove_handler(EVENT_INPUT_FLUSH, note, "b");
+	send(EVENT_INPUT_FLUSH);
+	require(streq(calls, "ca"));
+
+	event_remove_handler_type(EVENT_INPUT_FLUSH);
+	send(EVENT_INPUT_FLUSH);
+	require(streq(calls, ""));
+	ok;
+}
+
+/* Handlers may change the handlers of the event being sent */
+int test_reentry(void *state) {
+	event_add_handler(EVENT_INPUT_FLUSH, note, "a");
+	event_add_handler(EVENT_INPUT_FLUSH, remove_self, "b");
+	event_add_handler(EVENT_INPUT_FLUSH, note, "c");
+	send(EVENT_INPUT_FLUSH);
+	require(streq(calls, "cba"));
+	send(EVENT_INPUT_FLUSH);
+	require(streq(calls, "ca"));
+
+	/* New handlers hear about the next event, not this one */
+	event_add_handler(EVENT_INPUT_FLUSH, add_another, "d");
+	send(EVENT_INPUT_FLUSH);
+	require(streq(calls, "dca"));
+	send(EVENT_INPUT_FLUSH);
+	require(streq(calls, "zca"));
+
+	event_remove_handler_type(EVENT_INPUT_FLUSH);
+	ok;
+}
+
+const char *suite_name = "game/event";
+struct test tests[] = {
+	{ "order", test_order },
+	{ "reentry", test_reentry },
+	{ NULL, NULL }
+};
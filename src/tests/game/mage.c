@@ -31,6 +31,9 @@ int setup_tests(void **state) {
 	event_add_handler(EVENT_MESSAGE, event_message, NULL);
 	event_add_handler(EVENT_INITSTATUS, event_message, NULL);
 
+	/* There is no display to update */
+	event_set_headless(TRUE);
+
 	/* Init the game */
 	set_file_paths();
 	init_angband();
@@ -39,7 +42,8 @@ int setup_tests(void **state) {
 }
 
 int teardown_tests(void **state) {
-	file_delete("Test1");
+	/* Nothing is saved here, so game/basic's Test1 is left alone while it
+	 * runs alongside */
 	cleanup_angband();
 	return 0;
 }
@@ -0,0 +1,150 @@
+/* game/sim.c */
+
+#include "unit-test.h"
+
+#include <stdio.h>
+#include "cave.h"
+#include "cmd-core.h"
+#include "game-sim.h"
+#include "player.h"
+#include "savefile.h"
+#include "z-util.h"
+#include "z-virt.h"
+
+static void println(const char *str) {
+	printf("%s\n", str);
+}
+
+int setup_tests(void **state) {
+	plog_aux = println;
+	if (!sim_init(NULL, NULL, NULL)) return 1;
+	return !sim_new_game(42, 0, 0, "Sim");
+}
+
+int teardown_tests(void *state) {
+	sim_cleanup();
+	return 0;
+}
+
+static bool walk(int dir) {
+	cmdq_push(CMD_WALK);
+	cmd_set_arg_direction(cmdq_peek(), "direction", dir);
+	return sim_step();
+}
+
+int test_newgame(void *state) {
+	struct sim_status status;
+
+	sim_status(&status);
+	eq(status.dead, FALSE);
+	eq(status.depth, 0);
+	eq(status.lev, 1);
+	eq(status.chp, status.mhp);
+	eq(status.y, player->py);
+	eq(status.x, player->px);
+
+	ok;
+}
+
+/* Stepping plays the queued command and stops for the next one */
+int test_step(void *state) {
+	struct sim_status before, after;
+
+	sim_status(&before);
+	require(walk(2));
+	require(walk(8));
+	sim_status(&after);
+	require(after.turn > before.turn);
+	eq(after.y, before.y);
+	eq(after.x, before.x);
+
+	ok;
+}
+
+/* The map holds what the player knows, the monsters what they are aware of */
+int test_map(void *state) {
+	struct sim_grid *grids;
+	struct sim_monster mons[64];
+	int height, width, i, n, seen = 0;
+
+	sim_map_size(&height, &width);
+	eq(height, cave->height);
+	eq(width, cave->width);
+	grids = mem_zalloc(height * width * sizeof(*grids));
+	sim_map(grids);
+
+	require(grids[player->py * width + player->px].seen);
+	eq(grids[player->py * width + player->px].monster, 0);
+	for (i = 0; i < height * width; i++) {
+		if (grids[i].seen) seen++;
+		if (grids[i].seen)
+			noteq(grids[i].feat, FEAT_NONE);
+	}
+	require(seen > 1 && seen < height * width);
+
+	n = sim_monsters(mons, N_ELEMENTS(mons));
+	for (i = 0; i < n && i < (int) N_ELEMENTS(mons); i++)
+		eq(grids[mons[i].y * width + mons[i].x].monster, mons[i].race);
+
+	mem_free(grids);
+	ok;
+}
+
+int test_gear(void *state) {
+	struct sim_item items[64];
+	int i, n, worn = 0;
+
+	n = sim_gear(items, N_ELEMENTS(items));
+	require(n > 0);
+	eq(sim_gear(items, 1), n);
+	for (i = 0; i < n; i++) {
+		require(items[i].number > 0);
+		require(items[i].name[0]);
+		if (items[i].slot >= 0) worn++;
+	}
+	require(worn > 0);
+
+	ok;
+}
+
+/* Looking at the game leaves it just as it was */
+int test_queries(void *state) {
+	struct sim_grid *grids;
+	struct sim_monster mons[64];
+	struct sim_item items[64];
+	struct sim_status status;
+	int height, width;
+	u32b size, size2;
+	byte *before, *after;
+
+	require(walk(6));
+	before = savefile_snapshot(&size);
+	notnull(before);
+
+	sim_map_size(&height, &width);
+	grids = mem_zalloc(height * width * sizeof(*grids));
+	sim_map(grids);
+	sim_monsters(mons, N_ELEMENTS(mons));
+	sim_gear(items, N_ELEMENTS(items));
+	sim_status(&status);
+
+	after = savefile_snapshot(&size2);
+	notnull(after);
+	eq(size, size2);
+	require(!memcmp(before, after, size));
+
+	mem_free(grids);
+	mem_free(before);
+	mem_free(after);
+	ok;
+}
+
+const char *suite_name = "game/sim";
+struct test tests[] = {
+	{ "newgame", test_newgame },
+	{ "step", test_step },
+	{ "map", test_map },
+	{ "gear", test_gear },
+	{ "queries", test_queries },
+	{ NULL, NULL }
+};
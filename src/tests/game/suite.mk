@@ -1,2 +1,4 @@
 TESTPROGS += game/basic \
-	game/mage
+	game/event \
+	game/mage \
+	game/sim
@@ -9,7 +9,17 @@
 #include "unit-test.h"
 #include "unit-test-data.h"
 #include "test-utils.h"
+#include "cave.h"
+#include "game-world.h"
+#include "init.h"
+#include "mon-make.h"
+#include "mon-move.h"
+#include "mon-spell.h"
+#include "mon-timed.h"
 #include "mon-util.h"
+#include "obj-util.h"
+#include "player.h"
+#include "project.h"
 
 int setup_tests(void **state) {
 	read_edit_files();
@@ -43,8 +53,437 @@ int test_match_monster_bases(void *state) {
 	ok;
 }
 
+/* Energy is only counted up to date when it is needed */
+int test_schedule_energy(void *state) {
+	struct chunk c;
+	struct monster mon;
+	int gain = turn_energy(110);
+
+	memset(&c, 0, sizeof(c));
+	memset(&mon, 0, sizeof(mon));
+	mon.race = &r_info[3];
+	mon.mspeed = 110;
+	turn = 1000;
+	mon.energy_turn = turn - 1;
+
+	/* Due on the turn its energy first reaches move_energy */
+	monster_reschedule(&c, &mon);
+	eq(mon.next_turn, turn - 1 +
+	   (z_info->move_energy + gain - 1) / gain);
+
+	/* Catch up with the turns since */
+	turn += 5;
+	monster_settle_energy(&mon);
+	eq(mon.energy, 5 * gain);
+	eq(mon.energy_turn, turn - 1);
+
+	/* Settling again changes nothing */
+	monster_settle_energy(&mon);
+	eq(mon.energy, 5 * gain);
+
+	/* Energy set from outside moves the next turn */
+	monster_set_energy(&c, &mon, z_info->move_energy);
+	eq(mon.next_turn, turn);
+
+	ok;
+}
+
+/* Dormant monsters stay off the schedule until brought back */
+int test_schedule_dormant(void *state) {
+	struct chunk c;
+	struct monster mon;
+
+	memset(&c, 0, sizeof(c));
+	memset(&mon, 0, sizeof(mon));
+	mon.race = &r_info[3];
+	mon.mspeed = 110;
+	turn = 2000;
+	mon.energy_turn = turn - 1;
+	mflag_on(mon.mflag, MFLAG_DORMANT);
+
+	monster_reschedule(&c, &mon);
+	eq(mon.next_turn, 0);
+
+	/* Back with its energy as it was */
+	turn += 300;
+	monster_end_dormancy(&c, &mon);
+	require(!mflag_has(mon.mflag, MFLAG_DORMANT));
+	eq(mon.energy, 0);
+	eq(mon.energy_turn, turn - 1);
+	require(mon.next_turn >= turn);
+
+	ok;
+}
+
+/* The monster index keeps a list of the monsters in each cell */
+int test_monster_cells(void *state) {
+	struct chunk *c = cave_new(2 * CAVE_CELL, 2 * CAVE_CELL);
+	struct monster a, b;
+	int cell = c->cells_wide + 1;
+
+	memset(&a, 0, sizeof(a));
+	memset(&b, 0, sizeof(b));
+	a.midx = 3;
+	b.midx = 5;
+
+	cave_monster_cell(c, &a, CAVE_CELL, CAVE_CELL + 1, TRUE);
+	cave_monster_cell(c, &b, CAVE_CELL + 2, CAVE_CELL, TRUE);
+	eq(c->mon_cells[cell], 5);
+	eq(c->mon_cell_next[5], 3);
+	eq(c->mon_cell_next[3], 0);
+
+	/* Taking one out leaves the other */
+	cave_monster_cell(c, &a, CAVE_CELL, CAVE_CELL + 1, FALSE);
+	eq(c->mon_cells[cell], 5);
+	eq(c->mon_cell_next[5], 0);
+
+	/* Moving to another cell */
+	cave_monster_cell(c, &b, CAVE_CELL + 2, CAVE_CELL, FALSE);
+	cave_monster_cell(c, &b, 0, 0, TRUE);
+	eq(c->mon_cells[cell], 0);
+	eq(c->mon_cells[0], 5);
+
+	cave_free(c);
+	ok;
+}
+
+/* Walks over an area only find what is in it */
+int test_cell_iter(void *state) {
+	struct chunk *c = cave_new(3 * CAVE_CELL, 3 * CAVE_CELL);
+	struct cell_iter iter;
+	struct object obj;
+	struct monster *mon;
+	int i, y, x, n;
+
+	/* Monsters along the diagonal, three to a cell */
+	for (i = 1; i <= 3 * CAVE_CELL / 4; i++) {
+		mon = cave_monster(c, i);
+		mon->midx = i;
+		mon->fy = mon->fx = 4 * i - 2;
+		cave_monster_cell(c, mon, mon->fy, mon->fx, TRUE);
+	}
+
+	n = 0;
+	cell_iter_rect(&iter, c, 10, 10, 22, 22);
+	while ((mon = cell_iter_next_monster(&iter))) {
+		require(mon->fy >= 10 && mon->fy <= 22);
+		n++;
+	}
+	eq(n, 4);
+
+	/* A circle misses the corners of its square */
+	n = 0;
+	cell_iter_radius(&iter, c, 4, 4, 2);
+	while ((mon = cell_iter_next_monster(&iter)))
+		n++;
+	eq(n, 0);
+
+	/* Off the map there is nothing */
+	cell_iter_rect(&iter, c, -10, -10, -1, -1);
+	null(cell_iter_next_monster(&iter));
+
+	/* Floor piles */
+	memset(&obj, 0, sizeof(obj));
+	c->squares[20][30].obj = &obj;
+	cave_object_cell(c, 20, 30, TRUE);
+	cell_iter_rect(&iter, c, 0, 0, c->height - 1, c->width - 1);
+	require(cell_iter_next_object(&iter, &y, &x));
+	eq(y, 20);
+	eq(x, 30);
+	require(!cell_iter_next_object(&iter, &y, &x));
+	c->squares[20][30].obj = NULL;
+
+	/* A grid is queued for recharging only once */
+	cave_object_charging(c, 20, 30);
+	cave_object_charging(c, 20, 30);
+	cave_object_charging(c, 5, 30);
+	eq(c->charging_num, 2);
+
+	cave_free(c);
+	ok;
+}
+
+/* Movement is worked out per race and per terrain at load time */
+int test_move_cost(void *state) {
+	struct monster_race *walker = NULL, *passer = NULL;
+	int i;
+
+	for (i = 0; i < z_info->r_max; i++) {
+		struct monster_race *r = &r_info[i];
+		if (!r->name) continue;
+		if (!walker && !flags_test(r->flags, RF_SIZE, RF_PASS_WALL,
+								   RF_KILL_WALL, RF_OPEN_DOOR, RF_BASH_DOOR,
+								   FLAG_END))
+			walker = r;
+		if (!passer && rf_has(r->flags, RF_PASS_WALL))
+			passer = r;
+	}
+	require(walker && passer);
+	eq(walker->move_class, MOVE_CLASS_WALKER);
+	eq(passer->move_class, MOVE_CLASS_PASSER);
+	require(passer->move_flags & MOVE_PASS_WALL);
+
+	eq(monster_move_cost(walker, FEAT_FLOOR), 1);
+	eq(monster_move_cost(walker, FEAT_GRANITE), 0);
+	eq(monster_move_cost(walker, FEAT_CLOSED), 0);
+	eq(monster_move_cost(passer, FEAT_GRANITE), 1);
+	eq(monster_move_cost(passer, FEAT_PERM), 0);
+	ok;
+}
+
+/* The running timed effects can be worked out from the timers */
+int test_timed_refresh(void *state) {
+	struct monster mon;
+
+	memset(&mon, 0, sizeof(mon));
+	mon_timed_refresh(&mon);
+	eq(mon.m_timed_set, 0);
+
+	mon.m_timed[MON_TMD_CONF] = 5;
+	mon.m_timed[MON_TMD_FAST] = 1;
+	mon_timed_refresh(&mon);
+	eq(mon.m_timed_set, (1 << MON_TMD_CONF) | (1 << MON_TMD_FAST));
+	ok;
+}
+
+/* Situational spells are sorted out per race at load time */
+int test_spell_masks(void *state) {
+	struct monster_race *summoner = NULL;
+	int i;
+
+	for (i = 0; i < z_info->r_max && !summoner; i++)
+		if (r_info[i].name && rsf_has(r_info[i].spell_flags, RSF_S_MONSTER))
+			summoner = &r_info[i];
+	require(summoner);
+	require(rsf_has(summoner->spell_summon, RSF_S_MONSTER));
+	require(rsf_has(summoner->spell_smart, RSF_S_MONSTER));
+	require(!rsf_has(summoner->spell_bolt, RSF_S_MONSTER));
+	require(rsf_is_subset(summoner->spell_flags, summoner->spell_summon));
+	ok;
+}
+
+/* Every race knows how it stands up to fire, nether and life drain */
+int test_defences(void *state) {
+	int i;
+
+	for (i = 0; i < z_info->r_max; i++) {
+		struct monster_race *race = &r_info[i];
+
+		if (!race->name) continue;
+		require(race->gf_defence);
+		if (rf_has(race->flags, RF_IM_FIRE)) {
+			eq(race->gf_defence[GF_FIRE], 1);
+		} else if (rf_has(race->flags, RF_HURT_FIRE)) {
+			eq(race->gf_defence[GF_FIRE], 2);
+		} else {
+			eq(race->gf_defence[GF_FIRE], 0);
+		}
+		if (rf_has(race->flags, RF_UNDEAD)) {
+			eq(race->gf_defence[GF_NETHER], 1);
+		}
+		require((race->gf_defence[GF_OLD_DRAIN] != 0) ==
+				monster_is_nonliving(race));
+		eq(race->gf_defence[GF_MISSILE], 0);
+	}
+	ok;
+}
+
+extern struct init_module mon_make_module;
+
+static struct monster_race *only_race;
+
+static bool only_race_okay(struct monster_race *race)
+{
+	return race == only_race;
+}
+
+/* Monster choice keeps up with restrictions and with uniques coming and
+ * going */
+int test_get_mon_num(void *state) {
+	int i;
+
+	player = &test_player;
+	player->depth = 0;
+	mon_make_module.init();
+
+	for (i = 0; i < 100; i++) {
+		struct monster_race *race = get_mon_num(0);
+		require(race);
+		eq(race->level, 0);
+	}
+
+	/* Restrict to a single unique */
+	for (i = 1; i < z_info->r_max && !only_race; i++)
+		if (r_info[i].rarity && rf_has(r_info[i].flags, RF_UNIQUE) &&
+			!rf_has(r_info[i].flags, RF_FORCE_DEPTH) && r_info[i].level > 0)
+			only_race = &r_info[i];
+	require(only_race);
+	get_mon_num_prep(only_race_okay);
+	only_race->max_num = 1;
+	only_race->cur_num = 0;
+	ptreq(get_mon_num(only_race->level), only_race);
+	only_race->cur_num = 1;
+	null(get_mon_num(only_race->level));
+	only_race->cur_num = 0;
+	ptreq(get_mon_num(only_race->level), only_race);
+
+	get_mon_num_prep(NULL);
+	mon_make_module.cleanup();
+	ok;
+}
+
+/* Regeneration is added up when it is next needed */
+int test_settle_regen(void *state) {
+	struct monster mon;
+	struct player_upkeep upkeep;
+
+	memset(&upkeep, 0, sizeof(upkeep));
+	player = &test_player;
+	player->upkeep = &upkeep;
+	memset(&mon, 0, sizeof(mon));
+	mon.race = &r_info[3];
+	mon.maxhp = 50;
+	mon.hp = 40;
+	mon.regen_turn = 1050;
+	turn = 1399;
+	monster_settle_regen(&mon);
+	eq(mon.hp, 43);
+	eq(mon.regen_turn, 1399);
+
+	/* Nothing more until the next 100 game turns are up */
+	monster_settle_regen(&mon);
+	eq(mon.hp, 43);
+	turn = 1400;
+	monster_settle_regen(&mon);
+	eq(mon.hp, 44);
+
+	/* Never past the maximum */
+	turn = 100000;
+	monster_settle_regen(&mon);
+	eq(mon.hp, 50);
+	player->upkeep = NULL;
+	ok;
+}
+
 const char *suite_name = "monster/monster";
+/* Once the monster list is full, the lowest dead slot is used again */
+int test_mon_pop(void *state) {
+	struct chunk *c = cave_new(CAVE_CELL, CAVE_CELL);
+	int i;
+
+	for (i = 1; i < z_info->level_monster_max; i++)
+		cave_monster(c, i)->race = &r_info[1];
+	c->mon_max = z_info->level_monster_max;
+	c->mon_cnt = c->mon_max - 1;
+
+	/* Slots die as delete_monster_idx() leaves them */
+	cave_monster(c, 40)->race = NULL;
+	cave_monster(c, 20)->race = NULL;
+	c->mon_cnt -= 2;
+	c->mon_hole = 20;
+
+	eq(mon_pop(c), 20);
+	cave_monster(c, 20)->race = &r_info[1];
+	eq(mon_pop(c), 40);
+	cave_monster(c, 40)->race = &r_info[1];
+	eq(mon_pop(c), 0);
+	eq(c->mon_cnt, c->mon_max - 1);
+
+	for (i = 1; i < z_info->level_monster_max; i++)
+		cave_monster(c, i)->race = NULL;
+	cave_free(c);
+	ok;
+}
+
+/* The occupied plane follows square_set_mon(), across word boundaries */
+int test_occupied(void *state) {
+	struct chunk *c = cave_new(4, 70);
+
+	square_set_mon(c, 1, 0, 5);
+	square_set_mon(c, 1, 31, 6);
+	square_set_mon(c, 1, 32, -1);
+	square_set_mon(c, 1, 69, 7);
+	square_set_mon(c, 2, 33, 8);
+	eq(c->squares[1][31].mon, 6);
+	eq(square_isoccupied(c, 1, 32), TRUE);
+	eq(square_isoccupied(c, 1, 33), FALSE);
+
+	eq(square_num_occupied(c, 0, 0, 3, 69), 5);
+	eq(square_num_occupied(c, 1, 0, 1, 69), 4);
+	eq(square_num_occupied(c, 1, 1, 1, 68), 2);
+	eq(square_num_occupied(c, 0, 30, 2, 32), 2);
+	eq(square_num_occupied(c, 1, 32, 2, 33), 2);
+	eq(square_num_occupied(c, 2, 0, 3, 32), 0);
+
+	square_set_mon(c, 1, 31, 0);
+	eq(square_isoccupied(c, 1, 31), FALSE);
+	eq(square_num_occupied(c, 0, 30, 2, 32), 1);
+
+	cave_free(c);
+	ok;
+}
+
+/* What monsters know is only given room once some monster knows something */
+int test_known(void *state) {
+	struct chunk *c = cave_new(4, 70);
+	struct chunk *d = cave_new(4, 70);
+
+	require(!c->mon_known);
+	cave_monster_known_copy(c, 2, d, 1);
+	cave_monster_known_copy(c, 2, NULL, 0);
+	require(!c->mon_known);
+
+	of_on(cave_monster_known(c, 3)->flags, OF_FREE_ACT);
+	cave_monster_known(c, 3)->el_info[ELEM_FIRE].res_level = 1;
+	cave_monster_known_copy(d, 5, c, 3);
+	require(of_has(cave_monster_known(d, 5)->flags, OF_FREE_ACT));
+	eq(cave_monster_known(d, 5)->el_info[ELEM_FIRE].res_level, 1);
+
+	cave_monster_known_copy(d, 5, NULL, 0);
+	require(of_is_empty(cave_monster_known(d, 5)->flags));
+	eq(cave_monster_known(d, 5)->el_info[ELEM_FIRE].res_level, 0);
+
+	cave_free(c);
+	cave_free(d);
+	ok;
+}
+
+/* The name and tval/sval indexes find what a search would */
+int test_lookups(void *state) {
+	int i;
+
+	for (i = 0; i < z_info->r_max; i++) {
+		monster_race *race = &r_info[i];
+		if (!race->name) continue;
+		require(streq(lookup_monster(race->name)->name, race->name));
+	}
+	ptreq(lookup_monster("farmer maggot"), lookup_monster("Farmer Maggot"));
+	ptreq(lookup_monster("No such monster"), NULL);
+
+	for (i = 1; i < z_info->k_max; i++) {
+		struct object_kind *kind = &k_info[i];
+		if (!kind->name) continue;
+		ptreq(lookup_kind(kind->tval, kind->sval), kind);
+	}
+	ptreq(lookup_kind(TV_FOOD, 255), NULL);
+	ok;
+}
+
 struct test tests[] = {
 	{ "match_monster_bases", test_match_monster_bases },
+	{ "schedule_energy", test_schedule_energy },
+	{ "schedule_dormant", test_schedule_dormant },
+	{ "monster_cells", test_monster_cells },
+	{ "cell_iter", test_cell_iter },
+	{ "move_cost", test_move_cost },
+	{ "timed_refresh", test_timed_refresh },
+	{ "spell_masks", test_spell_masks },
+	{ "defences", test_defences },
+	{ "settle_regen", test_settle_regen },
+	{ "get_mon_num", test_get_mon_num },
+	{ "mon_pop", test_mon_pop },
+	{ "occupied", test_occupied },
+	{ "known", test_known },
+	{ "lookups", test_lookups },
 	{ NULL, NULL }
 };
@@ -0,0 +1,101 @@
+/* object/bench
+ *
+ * Time object_desc() on a new character's gear, both as the display asks
+ * for it, mostly from the description cache, and built afresh; and the
+ * making of a whole set of random artifacts, without the randart.log.
+ */
+
+#include "bench.h"
+#include "init.h"
+#include "object.h"
+#include "obj-desc.h"
+#include "obj-randart.h"
+#include "obj-slays.h"
+#include "player.h"
+
+#define BENCH_OBJECTS 64
+
+static struct object *objects[BENCH_OBJECTS];
+static int nobjects;
+static struct artifact *a_info_save;
+
+static void copy_artifacts(struct artifact *dest, const struct artifact *src)
+{
+	int i;
+
+	for (i = 0; i < z_info->a_max; i++) {
+		free_slay(dest[i].slays);
+		free_brand(dest[i].brands);
+		memcpy(&dest[i], &src[i], sizeof(*dest));
+		dest[i].slays = NULL;
+		dest[i].brands = NULL;
+		copy_slay(&dest[i].slays, src[i].slays);
+		copy_brand(&dest[i].brands, src[i].brands);
+	}
+}
+
+int setup_benches(void **state) {
+	struct object *obj;
+
+	bench_new_game();
+	for (obj = player->gear; obj && nobjects < BENCH_OBJECTS; obj = obj->next)
+		objects[nobjects++] = obj;
+
+	/* Every set of randarts starts from the standard artifacts */
+	a_info_save = mem_zalloc(z_info->a_max * sizeof(*a_info_save));
+	copy_artifacts(a_info_save, a_info);
+	randart_set_verbose(FALSE);
+
+	*state = 0;
+	return !nobjects;
+}
+
+int teardown_benches(void *state) {
+	int i;
+
+	for (i = 0; i < z_info->a_max; i++) {
+		free_slay(a_info_save[i].slays);
+		free_brand(a_info_save[i].brands);
+	}
+	mem_free(a_info_save);
+	cleanup_angband();
+	return 0;
+}
+
+static void bench_object_desc(void *state, int n) {
+	char buf[80];
+	int i;
+
+	for (i = 0; i < n; i++)
+		bench_sink += object_desc(buf, sizeof(buf), objects[i % nobjects],
+								  ODESC_PREFIX | ODESC_FULL);
+}
+
+static void bench_object_desc_build(void *state, int n) {
+	char buf[1024];
+	int i;
+
+	/* Descriptions this long aren't cached */
+	for (i = 0; i < n; i++)
+		bench_sink += object_desc(buf, sizeof(buf), objects[i % nobjects],
+								  ODESC_PREFIX | ODESC_FULL);
+}
+
+static void bench_do_randart(void *state, int n) {
+	static u32b randart_seed;
+	int i;
+
+	/* A new seed every time, as the stats frontend gives each run */
+	for (i = 0; i < n; i++) {
+		copy_artifacts(a_info, a_info_save);
+		bench_sink += do_randart(++randart_seed, TRUE);
+	}
+}
+
+const char *suite_name = "object/bench";
+struct bench benches[] = {
+	{ "object_desc", bench_object_desc },
+	{ "object_desc-build", bench_object_desc_build },
+	{ "do_randart", bench_do_randart },
+	{ NULL, NULL }
+};
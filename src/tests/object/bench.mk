@@ -0,0 +1 @@
+BENCHPROGS += object/bench
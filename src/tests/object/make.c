@@ -0,0 +1,57 @@
+/* object/make */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+#include "test-utils.h"
+#include "init.h"
+#include "obj-make.h"
+#include "obj-tval.h"
+#include "obj-util.h"
+
+extern struct init_module obj_make_module;
+
+int setup_tests(void **state) {
+	read_edit_files();
+	obj_make_module.init();
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	obj_make_module.cleanup();
+	mem_free(state);
+	return 0;
+}
+
+/* Kinds are only picked if they can be generated */
+int test_get_obj_num(void *state) {
+	int i;
+
+	for (i = 0; i < 200; i++) {
+		struct object_kind *kind = get_obj_num(i % 50, i % 2, 0);
+		require(kind);
+		require(kind->alloc_prob > 0);
+	}
+	ok;
+}
+
+/* Kinds of a given tval are picked from that tval alone */
+int test_get_obj_num_tval(void *state) {
+	int i;
+
+	for (i = 0; i < 200; i++) {
+		struct object_kind *kind = get_obj_num(i % 50, FALSE, TV_POTION);
+		require(kind);
+		eq(kind->tval, TV_POTION);
+		require(kind->alloc_prob > 0);
+	}
+	null(get_obj_num(10, FALSE, TV_GOLD));
+	ok;
+}
+
+const char *suite_name = "object/make";
+struct test tests[] = {
+	{ "get_obj_num", test_get_obj_num },
+	{ "get_obj_num_tval", test_get_obj_num_tval },
+	{ NULL, NULL }
+};
@@ -90,8 +90,23 @@ int test_obj_piles(void *state) {
 	ok;
 }
 
+/* Deleted objects are reused, and come back blank */
+int test_obj_reuse(void *state) {
+	struct object *a = object_new(), *b;
+
+	a->number = 5;
+	object_delete(a);
+	b = object_new();
+	ptreq(b, a);
+	eq(b->number, 0);
+	null(b->next);
+	object_delete(b);
+	ok;
+}
+
 const char *suite_name = "object/pile";
 struct test tests[] = {
 	{ "pile checking", test_obj_piles },
+	{ "object reuse", test_obj_reuse },
 	{ NULL, NULL }
 };
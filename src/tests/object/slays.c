@@ -0,0 +1,72 @@
+/* object/slays */
+
+#include "unit-test.h"
+#include "test-utils.h"
+#include "init.h"
+#include "monster.h"
+#include "obj-slays.h"
+#include "object.h"
+
+int setup_tests(void **state) {
+	read_edit_files();
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	free_slay_cache();
+	return 0;
+}
+
+/**
+ * The value of a combination, found by attacking every race in turn
+ */
+static u32b attack_every_race(struct object *obj, bool known)
+{
+	struct monster mon;
+	u32b sv = 0;
+	int i;
+
+	memset(&mon, 0, sizeof(mon));
+	for (i = 0; i < z_info->r_max; i++) {
+		const struct brand *b = NULL;
+		const struct slay *s = NULL;
+		char verb[20];
+		int mult = 1;
+
+		mon.race = &r_info[i];
+		improve_attack_modifier(obj, &mon, &b, &s, verb, FALSE, FALSE, !known);
+		if (s)
+			mult = s->multiplier;
+		else if (b)
+			mult = b->multiplier;
+		sv += mult * r_info[i].scaled_power;
+	}
+
+	return sv;
+}
+
+/* Each ego item's brands and slays are valued as attacks would have it */
+int test_slay_race_power(void *state) {
+	struct object obj;
+	int i, combos = 0;
+
+	for (i = 0; i < z_info->e_max; i++) {
+		if (!e_info[i].brands && !e_info[i].slays) continue;
+
+		memset(&obj, 0, sizeof(obj));
+		obj.brands = e_info[i].brands;
+		obj.slays = e_info[i].slays;
+		eq(slay_race_power(&obj, TRUE), attack_every_race(&obj, TRUE));
+		eq(slay_race_power(&obj, FALSE), attack_every_race(&obj, FALSE));
+		combos++;
+	}
+	require(combos > 0);
+	ok;
+}
+
+const char *suite_name = "object/slays";
+struct test tests[] = {
+	{ "slay_race_power", test_slay_race_power },
+	{ NULL, NULL }
+};
@@ -0,0 +1,51 @@
+/* parse/bench
+ *
+ * Time parser_parse() on typical monster.txt lines.
+ */
+
+#include "bench.h"
+#include "test-utils.h"
+#include "init.h"
+#include "monster.h"
+
+static const char *lines[] = {
+	"base:humanoid",
+	"color:r",
+	"info:110:100:80:12:3",
+	"power:0:1:162:4:0",
+	"flags:HAS_LIGHT | SEASONAL",
+	"flags:DROP_1 | DROP_GOOD | ONLY_ITEM",
+	"spell-freq:4",
+	"spells:BLINK | HEAL",
+	"# a comment",
+	""
+};
+
+int setup_benches(void **state) {
+	struct parser *p;
+
+	read_edit_files();
+	p = init_parse_monster();
+	if (!p || parser_parse(p, "name:618:Father Christmas"))
+		return 1;
+	*state = p;
+	return 0;
+}
+
+int teardown_benches(void *state) {
+	parser_destroy(state);
+	return 0;
+}
+
+static void bench_parser_parse(void *state, int n) {
+	int i;
+
+	for (i = 0; i < n; i++)
+		bench_sink += parser_parse(state, lines[i % N_ELEMENTS(lines)]);
+}
+
+const char *suite_name = "parse/bench";
+struct bench benches[] = {
+	{ "parser_parse", bench_parser_parse },
+	{ NULL, NULL }
+};
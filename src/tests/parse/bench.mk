@@ -0,0 +1 @@
+BENCHPROGS += parse/bench
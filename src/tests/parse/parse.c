@@ -394,6 +394,61 @@ int test_char1(void *state) {
 	ok;
 }
 
+static enum parser_error helper_sym2(struct parser *p) {
+	const char *t = parser_getsym(p, "baz");
+	const char *s = parser_getsym(p, "foo");
+	const char *u = parser_getsym(p, "baz");
+	int *wasok = parser_priv(p);
+	if (!s || !t || !u || strcmp(s, "bar") || strcmp(t, "quxx") ||
+		strcmp(u, "quxx"))
+		return PARSE_ERROR_GENERIC;
+	*wasok = 1;
+	return PARSE_ERROR_NONE;
+}
+
+int test_sym2(void *state) {
+	int wasok = 0;
+	errr r = parser_reg(state, "test-sym2 sym foo sym baz", helper_sym2);
+	eq(r, 0);
+	parser_setpriv(state, &wasok);
+	r = parser_parse(state, "test-sym2:bar:quxx");
+	eq(r, PARSE_ERROR_NONE);
+	eq(wasok, 1);
+	ok;
+}
+
+static enum parser_error helper_dup(struct parser *p) {
+	int *wasok = parser_priv(p);
+	*wasok = 1;
+	return PARSE_ERROR_NONE;
+}
+
+int test_dup(void *state) {
+	int wasok = 0;
+	char dir[32];
+	int i;
+	errr r;
+
+	/* Registering after lines have been parsed still works, and the latest
+	 * registration of a directive wins */
+	r = parser_reg(state, "test-sym0 sym foo", helper_dup);
+	eq(r, 0);
+	for (i = 0; i < 40; i++) {
+		strnfmt(dir, sizeof(dir), "test-dup%d int foo", i);
+		r = parser_reg(state, dir, helper_dup);
+		eq(r, 0);
+	}
+	parser_setpriv(state, &wasok);
+	r = parser_parse(state, "test-sym0:baz");
+	eq(r, PARSE_ERROR_NONE);
+	eq(wasok, 1);
+	wasok = 0;
+	r = parser_parse(state, "test-dup39:3");
+	eq(r, PARSE_ERROR_NONE);
+	eq(wasok, 1);
+	ok;
+}
+
 const char *suite_name = "parse/parser";
 struct test tests[] = {
 	{ "priv", test_priv },
@@ -418,6 +473,7 @@ struct test tests[] = {
 
 	{ "sym0", test_sym0 },
 	{ "sym1", test_sym1 },
+	{ "sym2", test_sym2 },
 
 	{ "int0", test_int0 },
 	{ "int1", test_int1 },
@@ -436,6 +492,7 @@ struct test tests[] = {
 	{ "char1", test_char1 },
 
 	{ "baddir", test_baddir },
+	{ "dup", test_dup },
 
 	{ NULL, NULL }
 };
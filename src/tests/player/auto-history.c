@@ -0,0 +1,73 @@
+/* player/auto-history */
+
+#include "unit-test.h"
+#include "object.h"
+#include "player-history.h"
+
+NOSETUP
+
+int teardown_tests(void *state) {
+	history_clear();
+	return 0;
+}
+
+static void add(struct artifact *art, int type, bool lost)
+{
+	bitflag h[HIST_SIZE];
+	hist_wipe(h);
+	hist_on(h, type);
+	if (lost)
+		hist_on(h, HIST_ARTIFACT_LOST);
+	history_add_full(h, art, 1, 1, 0, "entry");
+}
+
+int test_grow(void *state) {
+	struct history_info *list;
+	size_t i;
+
+	history_clear();
+	for (i = 0; i < 1000; i++)
+		add(NULL, HIST_PLAYER_BIRTH, FALSE);
+	eq(history_get_num(), 1000);
+	eq(history_get_list(&list), 1000);
+	require(streq(list[999].event, "entry"));
+	ok;
+}
+
+int test_artifacts(void *state) {
+	struct artifact a, b;
+
+	memset(&a, 0, sizeof(a));
+	memset(&b, 0, sizeof(b));
+	a.aidx = 3;
+	b.aidx = 4;
+
+	history_clear();
+	add(&a, HIST_ARTIFACT_UNKNOWN, FALSE);
+	add(NULL, HIST_PLAYER_BIRTH, FALSE);
+	require(!history_is_artifact_known(&a));
+	require(!history_is_artifact_known(&b));
+
+	/* Losing an artifact marks its latest entry */
+	require(history_lose_artifact(&a));
+	require(!history_is_artifact_known(&a));
+
+	/* Unknown entries become known at the end of the game */
+	add(&b, HIST_ARTIFACT_KNOWN, TRUE);
+	require(history_is_artifact_known(&b));
+	history_unmask_unknown();
+	require(history_is_artifact_known(&a));
+	eq(history_get_num(), 3);
+
+	history_clear();
+	require(!history_is_artifact_known(&a));
+	require(!history_is_artifact_known(&b));
+	ok;
+}
+
+const char *suite_name = "player/auto-history";
+struct test tests[] = {
+	{ "grow", test_grow },
+	{ "artifacts", test_artifacts },
+	{ NULL, NULL },
+};
@@ -1,11 +1,25 @@
 /* player/pathfind */
 
 #include "unit-test.h"
+#include "unit-test-data.h"
+#include "test-utils.h"
+#include "cave.h"
 #include "cmd-core.h"
+#include "init.h"
+#include "player.h"
 #include "player-path.h"
 
-NOSETUP
-NOTEARDOWN
+int setup_tests(void **state) {
+	read_edit_files();
+	player = &test_player;
+	*state = 0;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	pathfind_cleanup();
+	return 0;
+}
 
 int test_dir_to(void *state) {
 	eq(pathfind_direction_to(loc(0,0), loc(0,1)), DIR_S);
@@ -24,8 +38,58 @@ int test_dir_to(void *state) {
 	ok;
 }
 
+/**
+ * Make a known, open level with a wall down it, leaving a gap at the bottom
+ */
+static struct chunk *walled_cave(bool gap)
+{
+	struct chunk *c = cave_new(20, 40);
+	int y, x;
+
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < c->width; x++) {
+			bool wall = !square_in_bounds_fully(c, y, x) ||
+				((x == 20) && (!gap || (y < 18)));
+			c->squares[y][x].feat = wall ? FEAT_GRANITE : FEAT_FLOOR;
+			square_update_planes(c, y, x);
+			sqinfo_on(c->squares[y][x].info, SQUARE_MARK);
+		}
+	}
+
+	return c;
+}
+
+int test_findpath(void *state) {
+	int n, y, x;
+
+	cave = walled_cave(TRUE);
+	player->py = 10;
+	player->px = 5;
+
+	/* Round the end of the wall and back, the shortest way */
+	require(findpath(10, 35));
+	for (n = 0, y = player->py, x = player->px; pathfind_step(n) != DIR_NONE;
+		 n++) {
+		y += ddy[pathfind_step(n)];
+		x += ddx[pathfind_step(n)];
+		require(square_ispassable(cave, y, x));
+	}
+	eq(n, 30);
+	eq(y, 10);
+	eq(x, 35);
+
+	cave_free(cave);
+	cave = walled_cave(FALSE);
+	require(!findpath(10, 35));
+
+	cave_free(cave);
+	cave = NULL;
+	ok;
+}
+
 const char *suite_name = "player/pathfind";
 struct test tests[] = {
 	{ "dir-to", test_dir_to },
+	{ "findpath", test_findpath },
 	{ NULL, NULL },
 };
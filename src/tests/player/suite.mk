@@ -1,4 +1,5 @@
-TESTPROGS += player/birth \
+TESTPROGS += player/auto-history \
+             player/birth \
              player/history \
              player/pathfind \
              player/playerstat
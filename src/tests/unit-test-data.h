@@ -977,10 +977,10 @@ static struct chunk TEST_DATA test_cave = {
 	.feeling_squares = 0,
 	.feat_count = NULL,
 
-	.feat = NULL,
-	.m_idx = NULL,
-
 	.squares = NULL,
+	.cost = NULL,
+	.when = NULL,
+	.mon_light = NULL,
 
 	.monsters = NULL,
 	.mon_max = 1,
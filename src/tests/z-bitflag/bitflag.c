@@ -0,0 +1,85 @@
+/* z-bitflag/bitflag.c */
+
+#include "unit-test.h"
+#include "z-bitflag.h"
+
+/* Big enough for a full word and an odd tail */
+#define SIZE 11
+
+int setup_tests(void **state) {
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	return 0;
+}
+
+int test_next(void *state) {
+	bitflag f[SIZE];
+
+	flag_wipe(f, SIZE);
+	eq(flag_next(f, SIZE, FLAG_START), FLAG_END);
+	flag_on(f, SIZE, 3);
+	flag_on(f, SIZE, 70);
+	flag_on(f, SIZE, FLAG_MAX(SIZE) - 1);
+	eq(flag_next(f, SIZE, FLAG_START), 3);
+	eq(flag_next(f, SIZE, 4), 70);
+	eq(flag_next(f, SIZE, 71), FLAG_MAX(SIZE) - 1);
+	ok;
+}
+
+int test_tests(void *state) {
+	bitflag f1[SIZE], f2[SIZE];
+
+	flag_wipe(f1, SIZE);
+	require(flag_is_empty(f1, SIZE));
+	flag_on(f1, SIZE, 85);
+	require(!flag_is_empty(f1, SIZE));
+
+	flag_setall(f2, SIZE);
+	require(flag_is_full(f2, SIZE));
+	flag_off(f2, SIZE, 2);
+	require(!flag_is_full(f2, SIZE));
+
+	require(flag_is_inter(f1, f2, SIZE));
+	require(flag_is_subset(f2, f1, SIZE));
+	require(!flag_is_subset(f1, f2, SIZE));
+	ok;
+}
+
+int test_ops(void *state) {
+	bitflag f1[SIZE], f2[SIZE];
+
+	flags_init(f1, SIZE, 5, 80, FLAG_END);
+	flags_init(f2, SIZE, 5, 60, FLAG_END);
+
+	require(flag_union(f1, f2, SIZE));
+	require(flags_test_all(f1, SIZE, 5, 60, 80, FLAG_END));
+	require(!flag_union(f1, f2, SIZE));
+
+	require(flag_diff(f1, f2, SIZE));
+	require(flag_has(f1, SIZE, 80));
+	require(!flags_test(f1, SIZE, 5, 60, FLAG_END));
+
+	flags_init(f1, SIZE, 5, 80, FLAG_END);
+	require(flag_inter(f1, f2, SIZE));
+	require(flag_has(f1, SIZE, 5));
+	require(!flag_has(f1, SIZE, 80));
+
+	flag_negate(f1, SIZE);
+	require(!flag_has(f1, SIZE, 5));
+	require(flag_has(f1, SIZE, 80));
+
+	require(flags_mask(f1, SIZE, 80, FLAG_END));
+	eq(flag_next(f1, SIZE, FLAG_START), 80);
+	eq(flag_next(f1, SIZE, 81), FLAG_END);
+	ok;
+}
+
+const char *suite_name = "z-bitflag/bitflag";
+struct test tests[] = {
+	{ "next", test_next },
+	{ "tests", test_tests },
+	{ "ops", test_ops },
+	{ NULL, NULL }
+};
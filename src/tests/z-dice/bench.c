@@ -0,0 +1,35 @@
+/* z-dice/bench
+ *
+ * Time dice_evaluate() on an already parsed dice string.
+ */
+
+#include "bench.h"
+#include "z-dice.h"
+
+int setup_benches(void **state) {
+	dice_t *dice = dice_new();
+
+	if (!dice_parse_string(dice, "5+3d8M4"))
+		return 1;
+	*state = dice;
+	return 0;
+}
+
+int teardown_benches(void *state) {
+	dice_free(state);
+	return 0;
+}
+
+static void bench_dice_evaluate(void *state, int n) {
+	random_value v;
+	int i;
+
+	for (i = 0; i < n; i++)
+		bench_sink += dice_evaluate(state, i % 100, RANDOMISE, &v);
+}
+
+const char *suite_name = "z-dice/bench";
+struct bench benches[] = {
+	{ "dice_evaluate", bench_dice_evaluate },
+	{ NULL, NULL }
+};
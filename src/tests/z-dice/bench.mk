@@ -0,0 +1 @@
+BENCHPROGS += z-dice/bench
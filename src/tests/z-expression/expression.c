@@ -150,11 +150,33 @@ int test_evaluate(void *state)
 	ok;
 }
 
+int test_evaluate_divisions(void *state)
+{
+	expression_t *new = expression_new();
+	expression_t *copy;
+
+	/* Divisions in the middle still round at the point they happen */
+	expression_set_base_value(new, base_value_2);
+	expression_add_operations_string(new, "+ 2 / 2 * 5 - 1");
+	require(expression_evaluate(new) == 24);
+	expression_add_operations_string(new, "n / 4 + 1");
+	require(expression_evaluate(new) == -5);
+
+	/* A copy evaluates the same */
+	copy = expression_copy(new);
+	require(expression_evaluate(copy) == -5);
+
+	expression_free(copy);
+	expression_free(new);
+	ok;
+}
+
 const char *suite_name = "z-expression/expression";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "parse-success", test_parse_success },
 	{ "parse-failure", test_parse_failure },
 	{ "evaluate", test_evaluate },
+	{ "evaluate-divisions", test_evaluate_divisions },
 	{ NULL, NULL },
 };
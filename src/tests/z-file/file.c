@@ -0,0 +1,149 @@
+/* z-file/file */
+
+#include "unit-test.h"
+#include "z-file.h"
+#include "z-virt.h"
+
+#define TEST_FILE "z-file-test.txt"
+
+NOSETUP
+NOTEARDOWN
+
+static void write_test_file(const char *text, size_t len)
+{
+	ang_file *f = file_open(TEST_FILE, MODE_WRITE, FTYPE_TEXT);
+	file_write(f, text, len);
+	file_close(f);
+}
+
+int test_getl(void *state) {
+	const char text[] = "one\r\ntwo\n\tthree\r\n\nlast";
+	char buf[80];
+	ang_file *f;
+
+	write_test_file(text, sizeof(text) - 1);
+	f = file_open(TEST_FILE, MODE_READ, -1);
+	require(f);
+
+	require(file_getl(f, buf, sizeof(buf)));
+	require(streq(buf, "one"));
+	require(file_getl(f, buf, sizeof(buf)));
+	require(streq(buf, "two"));
+	require(file_getl(f, buf, sizeof(buf)));
+	require(streq(buf, "    three"));
+	require(file_getl(f, buf, sizeof(buf)));
+	require(streq(buf, ""));
+	require(file_getl(f, buf, sizeof(buf)));
+	require(streq(buf, "last"));
+	require(!file_getl(f, buf, sizeof(buf)));
+
+	file_close(f);
+	file_delete(TEST_FILE);
+	ok;
+}
+
+int test_getl_long(void *state) {
+	char text[20000];
+	char buf[1024];
+	ang_file *f;
+	int i, lines = 0;
+
+	/* Lines that straddle the read-ahead buffer */
+	for (i = 0; i < (int)sizeof(text); i++)
+		text[i] = (i % 37 == 36) ? '\n' : 'a' + i % 26;
+	write_test_file(text, sizeof(text));
+
+	f = file_open(TEST_FILE, MODE_READ, -1);
+	require(f);
+	while (file_getl(f, buf, sizeof(buf))) {
+		require(strlen(buf) == 36 || !file_getl(f, buf, sizeof(buf)));
+		lines++;
+	}
+	eq(lines, (int)sizeof(text) / 37 + 1);
+
+	file_close(f);
+	file_delete(TEST_FILE);
+	ok;
+}
+
+int test_readc_skip(void *state) {
+	const char text[] = "abcdef\nghij";
+	char buf[80];
+	byte b;
+	ang_file *f;
+
+	write_test_file(text, sizeof(text) - 1);
+	f = file_open(TEST_FILE, MODE_READ, -1);
+	require(f);
+
+	require(file_readc(f, &b));
+	eq(b, 'a');
+	require(file_skip(f, 2));
+	require(file_getl(f, buf, sizeof(buf)));
+	require(streq(buf, "def"));
+	eq(file_read(f, buf, 3), 3);
+	require(!strncmp(buf, "ghi", 3));
+	require(file_readc(f, &b));
+	eq(b, 'j');
+	require(!file_readc(f, &b));
+
+	file_close(f);
+	file_delete(TEST_FILE);
+	ok;
+}
+
+int test_map(void *state) {
+	const char text[] = "one\r\n\ttwo\n\nlast";
+	const char *line;
+	size_t len;
+	ang_map *map;
+
+	write_test_file(text, sizeof(text) - 1);
+	map = file_map(TEST_FILE);
+	require(map);
+
+	require(file_map_data(map, &len));
+	eq(len, sizeof(text) - 1);
+
+	require(file_map_getl(map, &line, &len));
+	require(len == 3 && !strncmp(line, "one", 3));
+	require(file_map_getl(map, &line, &len));
+	require(len == 4 && !strncmp(line, "\ttwo", 4));
+	require(file_map_getl(map, &line, &len));
+	eq(len, 0);
+	require(file_map_getl(map, &line, &len));
+	require(len == 4 && !strncmp(line, "last", 4));
+	require(!file_map_getl(map, &line, &len));
+
+	file_unmap(map);
+	file_delete(TEST_FILE);
+	ok;
+}
+
+int test_map_empty(void *state) {
+	const char *line;
+	size_t len;
+	ang_map *map;
+
+	write_test_file("", 0);
+	map = file_map(TEST_FILE);
+	require(map);
+	file_map_data(map, &len);
+	eq(len, 0);
+	require(!file_map_getl(map, &line, &len));
+	file_unmap(map);
+
+	file_delete(TEST_FILE);
+	require(!file_map(TEST_FILE));
+	ok;
+}
+
+const char *suite_name = "z-file/file";
+struct test tests[] = {
+	{ "getl", test_getl },
+	{ "getl_long", test_getl_long },
+	{ "readc_skip", test_readc_skip },
+	{ "map", test_map },
+	{ "map_empty", test_map_empty },
+	{ NULL, NULL }
+};
@@ -0,0 +1,59 @@
+/* z-form/format.c */
+
+#include "unit-test.h"
+#include "z-form.h"
+#include "z-util.h"
+
+int setup_tests(void **state) {
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	vformat_kill();
+	return 0;
+}
+
+int test_plain(void *state) {
+	char buf[64];
+
+	eq(strnfmt(buf, sizeof(buf), "%s-%d-%s", "a", -12, NULL), 6);
+	require(streq(buf, "a--12-"));
+	strnfmt(buf, sizeof(buf), "%d %d", INT_MIN, 0);
+	require(streq(buf, "-2147483648 0"));
+	strnfmt(buf, sizeof(buf), "%3d|%-3s|%x|%%", 7, "b", 255);
+	require(streq(buf, "  7|b  |ff|%"));
+	ok;
+}
+
+int test_truncate(void *state) {
+	char buf[6];
+
+	eq(strnfmt(buf, sizeof(buf), "%s", "abcdefgh"), 5);
+	require(streq(buf, "abcde"));
+	eq(strnfmt(buf, sizeof(buf), "ab%dcd", 12345), 5);
+	require(streq(buf, "ab123"));
+	ok;
+}
+
+int test_format(void *state) {
+	char *a = format("%s", "first");
+	char *b = format("%d", 2);
+	char big[3000];
+
+	require(streq(a, "first"));
+	require(streq(b, "2"));
+	ptreq(format(NULL), b);
+
+	memset(big, 'x', sizeof(big) - 1);
+	big[sizeof(big) - 1] = '\0';
+	eq(strlen(format("%s", big)), sizeof(big) - 1);
+	ok;
+}
+
+const char *suite_name = "z-form/format";
+struct test tests[] = {
+	{ "plain", test_plain },
+	{ "truncate", test_truncate },
+	{ "format", test_format },
+	{ NULL, NULL }
+};
@@ -0,0 +1,47 @@
+/* z-quark/bench
+ *
+ * Time quark_add() on strings it has already seen, as inscriptions are.
+ */
+
+#include "bench.h"
+#include "z-form.h"
+#include "z-quark.h"
+#include "z-virt.h"
+
+#define BENCH_STRINGS 1024
+
+static char *strings[BENCH_STRINGS];
+
+int setup_benches(void **state) {
+	int i;
+
+	quarks_init();
+	for (i = 0; i < BENCH_STRINGS; i++) {
+		strings[i] = string_make(format("@r%d=g!k%d", i % 10, i));
+		quark_add(strings[i]);
+	}
+	*state = 0;
+	return 0;
+}
+
+int teardown_benches(void *state) {
+	int i;
+
+	for (i = 0; i < BENCH_STRINGS; i++)
+		string_free(strings[i]);
+	quarks_free();
+	return 0;
+}
+
+static void bench_quark_add(void *state, int n) {
+	int i;
+
+	for (i = 0; i < n; i++)
+		bench_sink += quark_add(strings[i % BENCH_STRINGS]);
+}
+
+const char *suite_name = "z-quark/bench";
+struct bench benches[] = {
+	{ "quark_add", bench_quark_add },
+	{ NULL, NULL }
+};
@@ -0,0 +1 @@
+BENCHPROGS += z-quark/bench
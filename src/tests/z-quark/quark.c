@@ -1,6 +1,7 @@
 /* z-quark/quark.c */
 
 #include "unit-test.h"
+#include "z-form.h"
 #include "z-quark.h"
 
 int setup_tests(void **state) {
@@ -46,9 +47,30 @@ int test_dedup(void *state) {
 	ok;
 }
 
+int test_many(void *state) {
+	quark_t q[500];
+	char buf[20];
+	int i;
+
+	for (i = 0; i < 500; i++) {
+		strnfmt(buf, sizeof(buf), "2-%d", i);
+		q[i] = quark_add(buf);
+	}
+
+	for (i = 0; i < 500; i++) {
+		strnfmt(buf, sizeof(buf), "2-%d", i);
+		require(quark_add(buf) == q[i]);
+		require(streq(quark_str(q[i]), buf));
+	}
+
+	require(quark_str(q[499] + 1) == NULL);
+	ok;
+}
+
 const char *suite_name = "z-quark/quark";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "dedup", test_dedup },
+	{ "many", test_many },
 	{ NULL, NULL }
 };
@@ -0,0 +1,54 @@
+/* z-queue/queue.c */
+
+#include "unit-test.h"
+#include "z-queue.h"
+
+int setup_tests(void **state) {
+	*state = q_new(4);
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	q_free(state);
+	return 0;
+}
+
+int test_fifo(void *state) {
+	struct queue *q = state;
+
+	q_push_int(q, 1);
+	q_push_int(q, 2);
+	q_push_int(q, 3);
+	eq(q_len(q), 3);
+	eq(q_pop_int(q), 1);
+	eq(q_pop_int(q), 2);
+	eq(q_pop_int(q), 3);
+	eq(q_len(q), 0);
+	ok;
+}
+
+int test_grow(void *state) {
+	struct queue *q = state;
+	int i;
+
+	/* Wrap the ring first, so growing has to unwrap it */
+	q_push_int(q, -1);
+	q_push_int(q, -2);
+	eq(q_pop_int(q), -1);
+
+	for (i = 0; i < 100; i++)
+		q_push_int(q, i);
+	eq(q_len(q), 101);
+	eq(q_pop_int(q), -2);
+	for (i = 0; i < 100; i++)
+		eq(q_pop_int(q), i);
+	eq(q_len(q), 0);
+	ok;
+}
+
+const char *suite_name = "z-queue/queue";
+struct test tests[] = {
+	{ "fifo", test_fifo },
+	{ "grow", test_grow },
+	{ NULL, NULL }
+};
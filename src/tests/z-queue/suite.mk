@@ -0,0 +1 @@
+TESTPROGS += z-queue/queue
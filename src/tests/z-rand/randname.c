@@ -0,0 +1,78 @@
+/* z-rand/randname */
+
+#include "unit-test.h"
+#include "randname.h"
+#include "z-rand.h"
+
+NOSETUP
+
+int teardown_tests(void *state) {
+	randname_cleanup();
+	return 0;
+}
+
+static const char *tolkien[] = {
+	"aragorn", "boromir", "celeborn", "denethor", "elrond", "faramir",
+	"galadriel", "haldir", "isildur", "legolas", NULL
+};
+
+static const char *scroll[] = {
+	"abra", "cadabra", "hocus", "pocus", "presto", "zim", "zala", NULL
+};
+
+static const char **sections[] = { NULL, tolkien, scroll };
+
+/* A batch gives the same names as single calls on the same seed */
+int test_batch_matches(void *state)
+{
+	char batch[20][16];
+	char one[16];
+	rng_state rng;
+	int i;
+
+	randname_prepare(sections);
+	rng_state_init(&rng, 99);
+	randname_make_batch(RANDNAME_TOLKIEN, 4, 8, batch[0], sizeof(batch[0]),
+						20, sections, &rng);
+
+	Rand_quick = FALSE;
+	state_i = 0;
+	Rand_state_init(99);
+	for (i = 0; i < 20; i++) {
+		size_t len = randname_make(RANDNAME_TOLKIEN, 4, 8, one, sizeof(one),
+								   sections);
+		require(streq(one, batch[i]));
+		eq(len, strlen(one));
+		require(len >= 4 && len <= 9);
+	}
+	ok;
+}
+
+/* Cached tables give the same names as ones rebuilt on every switch */
+int test_alternate(void *state)
+{
+	char a[16], b[16];
+	rng_state r1, r2;
+	int i;
+
+	rng_state_init(&r1, 7);
+	rng_state_init(&r2, 7);
+	randname_prepare(sections);
+	for (i = 0; i < 20; i++) {
+		randname_type type = (i % 2) ? RANDNAME_SCROLL : RANDNAME_TOLKIEN;
+
+		randname_make_batch(type, 2, 8, a, sizeof(a), 1, sections, &r1);
+		randname_cleanup();
+		randname_make_batch(type, 2, 8, b, sizeof(b), 1, sections, &r2);
+		randname_prepare(sections);
+		require(streq(a, b));
+	}
+	ok;
+}
+
+const char *suite_name = "z-rand/randname";
+struct test tests[] = {
+	{ "batch_matches", test_batch_matches },
+	{ "alternate", test_alternate },
+	{ NULL, NULL }
+};
@@ -0,0 +1,112 @@
+/* z-rand/stream */
+
+#include "unit-test.h"
+#include "z-rand.h"
+
+NOSETUP
+NOTEARDOWN
+
+/* A stream gives the same numbers as the game's RNG seeded the same way */
+int test_matches_global(void *state)
+{
+	rng_state rng;
+	int i;
+
+	Rand_quick = FALSE;
+	state_i = 0;
+	Rand_state_init(4242);
+	rng_state_init(&rng, 4242);
+
+	for (i = 0; i < 1000; i++)
+		eq(rng_div(&rng, 1000), Rand_div(1000));
+	ok;
+}
+
+/* Drawing from a stream leaves the game's RNG alone */
+int test_independent(void *state)
+{
+	rng_state rng;
+	u32b expect[100];
+	int i;
+
+	Rand_quick = FALSE;
+	state_i = 0;
+	Rand_state_init(99);
+	for (i = 0; i < 100; i++)
+		expect[i] = Rand_div(100000);
+
+	state_i = 0;
+	Rand_state_init(99);
+	rng_state_init(&rng, 7);
+	for (i = 0; i < 100; i++) {
+		rng_damroll(&rng, 3, 6);
+		rng_normal(&rng, 50, 10);
+		eq(Rand_div(100000), expect[i]);
+	}
+	ok;
+}
+
+/* Split streams repeat from the same parent, and differ from each other */
+int test_split(void *state)
+{
+	rng_state parent, again, a, b, c;
+	int i, same = 0;
+
+	rng_state_init(&parent, 1);
+	rng_state_split(&parent, &a);
+	rng_state_split(&parent, &b);
+	rng_state_init(&again, 1);
+	rng_state_split(&again, &c);
+
+	for (i = 0; i < 100; i++) {
+		u32b x = rng_div(&a, 0x10000000);
+		eq(rng_div(&c, 0x10000000), x);
+		if (rng_div(&b, 0x10000000) == x) same++;
+	}
+	require(same < 5);
+	ok;
+}
+
+/* Filling a buffer gives the stream's numbers in order */
+int test_fill(void *state)
+{
+	rng_state a, b;
+	u32b buf[64];
+	int i;
+
+	rng_state_init(&a, 5);
+	rng_state_init(&b, 5);
+	rng_fill(&a, buf, N_ELEMENTS(buf));
+	for (i = 0; i < (int) N_ELEMENTS(buf); i++) {
+		u32b r = rng_div(&b, 0x10000000);
+		eq(r, (buf[i] >> 4) & 0x0FFFFFFF);
+	}
+	ok;
+}
+
+/* The normal distribution is symmetric and stays within four deviations */
+int test_normal(void *state)
+{
+	rng_state rng;
+	int i, below = 0, above = 0;
+
+	rng_state_init(&rng, 11);
+	for (i = 0; i < 2000; i++) {
+		s16b x = rng_normal(&rng, 100, 10);
+		require(x > 60 && x < 140);
+		if (x < 100) below++;
+		if (x > 100) above++;
+	}
+	require(below > 800 && above > 800);
+	ok;
+}
+
+const char *suite_name = "z-rand/stream";
+struct test tests[] = {
+	{ "matches-global", test_matches_global },
+	{ "independent", test_independent },
+	{ "split", test_split },
+	{ "fill", test_fill },
+	{ "normal", test_normal },
+	{ NULL, NULL }
+};
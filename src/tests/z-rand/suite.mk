@@ -0,0 +1,2 @@
+TESTPROGS += z-rand/randname \
+             z-rand/stream
@@ -0,0 +1,64 @@
+/* z-set/set.c */
+
+#include "unit-test.h"
+#include "z-set.h"
+
+int setup_tests(void **state) {
+	*state = set_new();
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	set_free(state);
+	return 0;
+}
+
+int test_add_del(void *state) {
+	struct set *s = state;
+	static int vals[100];
+	int i;
+
+	for (i = 0; i < 100; i++)
+		set_add(s, &vals[i]);
+	eq(set_size(s), 100);
+
+	/* Delete every other element */
+	for (i = 0; i < 100; i += 2)
+		require(set_del(s, &vals[i]));
+	eq(set_size(s), 50);
+	require(!set_del(s, &vals[0]));
+
+	/* The rest are all still there */
+	for (i = 1; i < 100; i += 2)
+		require(set_del(s, &vals[i]));
+	eq(set_size(s), 0);
+	null(set_choose(s));
+	ok;
+}
+
+int test_insert(void *state) {
+	struct set *s = state;
+	static int a, b, c;
+
+	set_insert(s, 2, &a);
+	eq(set_size(s), 3);
+	null(set_get(s, 0));
+	ptreq(set_get(s, 2), &a);
+
+	set_insert(s, 2, &b);
+	ptreq(set_get(s, 2), &b);
+	require(!set_del(s, &a));
+
+	set_add(s, &c);
+	require(set_del(s, &b));
+	require(set_del(s, &c));
+	eq(set_size(s), 2);
+	ok;
+}
+
+const char *suite_name = "z-set/set";
+struct test tests[] = {
+	{ "add_del", test_add_del },
+	{ "insert", test_insert },
+	{ NULL, NULL }
+};
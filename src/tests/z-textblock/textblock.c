@@ -3,6 +3,7 @@
 #include "unit-test.h"
 #include "z-color.h"
 #include "z-textblock.h"
+#include "z-virt.h"
 
 int setup_tests(void **state) {
 	ok;
@@ -75,9 +76,38 @@ int test_length(void *state) {
 	ok;
 }
 
+int test_wrap(void *state) {
+	textblock *tb = textblock_new(), *fresh = textblock_new();
+	size_t *starts = NULL, *lengths = NULL;
+
+	textblock_append(tb, "aaa bbb ccc\n");
+	eq(textblock_calculate_lines(tb, &starts, &lengths, 8), 2);
+	eq(starts[1], 8);
+	eq(lengths[1], 3);
+
+	/* Same width again uses the remembered wrapping */
+	eq(textblock_calculate_lines(tb, &starts, &lengths, 8), 2);
+	eq(starts[1], 8);
+
+	/* Appending or changing the width wraps afresh */
+	textblock_append(tb, "ddd\n");
+	eq(textblock_calculate_lines(tb, &starts, &lengths, 8), 3);
+	eq(starts[2], 12);
+	textblock_append(fresh, "aaa bbb ccc\nddd\n");
+	eq(textblock_calculate_lines(tb, &starts, &lengths, 4),
+			textblock_calculate_lines(fresh, &starts, &lengths, 4));
+
+	mem_free(starts);
+	mem_free(lengths);
+	textblock_free(fresh);
+	textblock_free(tb);
+	ok;
+}
+
 const char *suite_name = "z-textblock/textblock";
 struct test tests[] = {
 	{ "alloc", test_alloc },
+	{ "wrap", test_wrap },
 	{ "append", test_append },
 	{ "colour", test_colour },
 	{ "length", test_length },
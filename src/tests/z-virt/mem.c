@@ -25,9 +25,62 @@ int test_realloc(void *state) {
 	return 0;
 }
 
+int test_pool(void *state) {
+	struct mem_pool *pool = mem_pool_new(24, 4);
+	struct mem_pool_stats stats;
+	void *p[10];
+	int i;
+
+	for (i = 0; i < 10; i++) {
+		p[i] = mem_pool_zalloc(pool);
+		require(p[i]);
+		memset(p[i], 0x4, 24);
+	}
+	mem_pool_get_stats(pool, &stats);
+	eq(stats.in_use, 10);
+	eq(stats.blocks, 3);
+
+	/* Freed objects are reused, zeroed */
+	mem_pool_free(pool, p[3]);
+	require(mem_pool_zalloc(pool) == p[3]);
+	eq(((char *)p[3])[23], 0);
+
+	mem_pool_get_stats(pool, &stats);
+	eq(stats.in_use, 10);
+	eq(stats.peak, 10);
+	mem_pool_destroy(pool);
+	ok;
+}
+
+int test_arena(void *state) {
+	struct mem_arena *arena = mem_arena_new(64);
+	struct mem_arena_mark mark;
+	char *a, *b;
+	int i;
+
+	a = mem_arena_alloc(arena, 10);
+	memset(a, 0x5, 10);
+	mark = mem_arena_push(arena);
+
+	/* Enough to need several more blocks */
+	for (i = 0; i < 20; i++)
+		memset(mem_arena_alloc(arena, 30), 0x6, 30);
+
+	/* Popping makes the space after the mark available again */
+	mem_arena_pop(arena, mark);
+	b = mem_arena_alloc(arena, 10);
+	require(b > a && b < a + 64);
+	eq(a[9], 0x5);
+
+	mem_arena_destroy(arena);
+	ok;
+}
+
 const char *suite_name = "z-virt/mem";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "realloc", test_realloc },
+	{ "pool", test_pool },
+	{ "arena", test_arena },
 	{ NULL, NULL }
 };
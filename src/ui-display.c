@@ -128,6 +128,73 @@ void cnv_stat(int val, char *out_val, size_t out_len)
  * Sidebar display functions
  * ------------------------------------------------------------------------ */
 
+/**
+ * Most values a sidebar or status line field is drawn from
+ */
+#define FIELD_KEY_MAX	16
+
+/**
+ * Widest field whose screen contents are remembered
+ */
+#define FIELD_WIDTH_MAX	256
+
+/**
+ * What a field of the sidebar or status line last showed: the values it was
+ * drawn from, and the cells that drawing left on the screen
+ */
+struct field_cache {
+	term *t;
+	int row, col, width;
+	size_t n;
+	s32b key[FIELD_KEY_MAX];
+	int a[FIELD_WIDTH_MAX];
+	wchar_t c[FIELD_WIDTH_MAX];
+};
+
+/**
+ * Check whether a field, drawn from the values in "key", would show exactly
+ * what is on the screen already - in which case it need not be formatted or
+ * printed again.  The screen itself is checked too, since prompts, menus and
+ * screen loads can all draw over a field behind its back.
+ */
+static bool field_is_current(struct field_cache *f, int row, int col,
+							 int width, const s32b *key, size_t n)
+{
+	assert(n <= FIELD_KEY_MAX);
+
+	width = MAX(0, MIN(MIN(width, Term->wid - col), FIELD_WIDTH_MAX));
+
+	if (f->t != Term || f->row != row || f->col != col || f->width != width)
+		return FALSE;
+	if (f->n != n || memcmp(f->key, key, n * sizeof(*key)))
+		return FALSE;
+	if (memcmp(f->a, Term->scr->a[row] + col, width * sizeof(int)))
+		return FALSE;
+	if (memcmp(f->c, Term->scr->c[row] + col, width * sizeof(wchar_t)))
+		return FALSE;
+
+	return TRUE;
+}
+
+/**
+ * Remember what a field was just drawn from, and what it now shows
+ */
+static void field_drawn(struct field_cache *f, int row, int col, int width,
+						const s32b *key, size_t n)
+{
+	width = MAX(0, MIN(MIN(width, Term->wid - col), FIELD_WIDTH_MAX));
+
+	f->t = Term;
+	f->row = row;
+	f->col = col;
+	f->width = width;
+	f->n = n;
+	memcpy(f->key, key, n * sizeof(*key));
+	memcpy(f->a, Term->scr->a[row] + col, width * sizeof(int));
+	memcpy(f->c, Term->scr->c[row] + col, width * sizeof(wchar_t));
+}
+
+
 /**
  * Print character info at given row, column in a 13 char field
  */
@@ -494,6 +561,108 @@ static void prt_race(int row, int col) { prt_field(player->race->name, row, col)
 static void prt_class(int row, int col) { prt_field(player->class->name, row, col); }
 
 
+/**
+ * The values each sidebar field is drawn from (see "field_is_current()")
+ */
+static size_t key_title(s32b *key)
+{
+	key[0] = player->wizard;
+	key[1] = player->total_winner;
+	key[2] = player->lev;
+	return 3;
+}
+
+static size_t key_level(s32b *key)
+{
+	key[0] = player->lev;
+	key[1] = player->max_lev;
+	return 2;
+}
+
+static size_t key_exp(s32b *key)
+{
+	key[0] = player->exp;
+	key[1] = player->max_exp;
+	key[2] = player->lev;
+	key[3] = player->expfact;
+	return 4;
+}
+
+static size_t key_gold(s32b *key)
+{
+	key[0] = player->au;
+	return 1;
+}
+
+static size_t key_stat(int stat, s32b *key)
+{
+	key[0] = player->stat_cur[stat];
+	key[1] = player->stat_max[stat];
+	key[2] = player->state.stat_use[stat];
+	return 3;
+}
+
+static size_t key_str(s32b *key) { return key_stat(STAT_STR, key); }
+static size_t key_int(s32b *key) { return key_stat(STAT_INT, key); }
+static size_t key_wis(s32b *key) { return key_stat(STAT_WIS, key); }
+static size_t key_dex(s32b *key) { return key_stat(STAT_DEX, key); }
+static size_t key_con(s32b *key) { return key_stat(STAT_CON, key); }
+
+static size_t key_ac(s32b *key)
+{
+	key[0] = player->known_state.ac + player->known_state.to_a;
+	return 1;
+}
+
+static size_t key_hp(s32b *key)
+{
+	key[0] = player->chp;
+	key[1] = player->mhp;
+	key[2] = player_hp_attr(player);
+	return 3;
+}
+
+static size_t key_sp(s32b *key)
+{
+	key[0] = player->csp;
+	key[1] = player->msp;
+	key[2] = player_sp_attr(player);
+	return 3;
+}
+
+static size_t key_health(s32b *key)
+{
+	struct monster *mon = player->upkeep->health_who;
+
+	key[0] = mon ? 1 : 0;
+	key[1] = monster_health_attr();
+	key[2] = -1;
+
+	/* The length of the bar, as prt_health() works it out */
+	if (mon && mflag_has(mon->mflag, MFLAG_VISIBLE) &&
+			!player->timed[TMD_IMAGE] && (mon->hp >= 0)) {
+		int pct = 100L * mon->hp / mon->maxhp;
+
+		key[2] = (pct < 10) ? 1 : (pct < 90) ? (pct / 10 + 1) : 10;
+	}
+
+	return 3;
+}
+
+static size_t key_speed(s32b *key)
+{
+	key[0] = player->state.speed;
+	key[1] = player->searching;
+	return 2;
+}
+
+static size_t key_depth(s32b *key)
+{
+	key[0] = player->depth;
+	return 1;
+}
+
+
 /**
  * Struct of sidebar handlers.
  */
@@ -502,31 +671,64 @@ static const struct side_handler_t
 	void (*hook)(int, int);	 /* int row, int col */
 	int priority;		 /* 1 is most important (always displayed) */
 	game_event_type type;	 /* PR_* flag this corresponds to */
+	size_t (*key)(s32b *);	 /* What it is drawn from, if worth caching */
 } side_handlers[] = {
-	{ prt_race,    19, EVENT_RACE_CLASS },
-	{ prt_title,   18, EVENT_PLAYERTITLE },
-	{ prt_class,   22, EVENT_RACE_CLASS },
-	{ prt_level,   10, EVENT_PLAYERLEVEL },
-	{ prt_exp,     16, EVENT_EXPERIENCE },
-	{ prt_gold,    11, EVENT_GOLD },
-	{ prt_equippy, 17, EVENT_EQUIPMENT },
-	{ prt_str,      6, EVENT_STATS },
-	{ prt_int,      5, EVENT_STATS },
-	{ prt_wis,      4, EVENT_STATS },
-	{ prt_dex,      3, EVENT_STATS },
-	{ prt_con,      2, EVENT_STATS },
-	{ NULL,        15, 0 },
-	{ prt_ac,       7, EVENT_AC },
-	{ prt_hp,       8, EVENT_HP },
-	{ prt_sp,       9, EVENT_MANA },
-	{ NULL,        21, 0 },
-	{ prt_health,  12, EVENT_MONSTERHEALTH },
-	{ NULL,        20, 0 },
-	{ NULL,        22, 0 },
-	{ prt_speed,   13, EVENT_PLAYERSPEED }, /* Slow (-NN) / Fast (+NN) */
-	{ prt_depth,   14, EVENT_DUNGEONLEVEL }, /* Lev NNN / NNNN ft */
+	{ prt_race,    19, EVENT_RACE_CLASS,    NULL },
+	{ prt_title,   18, EVENT_PLAYERTITLE,   key_title },
+	{ prt_class,   22, EVENT_RACE_CLASS,    NULL },
+	{ prt_level,   10, EVENT_PLAYERLEVEL,   key_level },
+	{ prt_exp,     16, EVENT_EXPERIENCE,    key_exp },
+	{ prt_gold,    11, EVENT_GOLD,          key_gold },
+	{ prt_equippy, 17, EVENT_EQUIPMENT,     NULL },
+	{ prt_str,      6, EVENT_STATS,         key_str },
+	{ prt_int,      5, EVENT_STATS,         key_int },
+	{ prt_wis,      4, EVENT_STATS,         key_wis },
+	{ prt_dex,      3, EVENT_STATS,         key_dex },
+	{ prt_con,      2, EVENT_STATS,         key_con },
+	{ NULL,        15, 0,                   NULL },
+	{ prt_ac,       7, EVENT_AC,            key_ac },
+	{ prt_hp,       8, EVENT_HP,            key_hp },
+	{ prt_sp,       9, EVENT_MANA,          key_sp },
+	{ NULL,        21, 0,                   NULL },
+	{ prt_health,  12, EVENT_MONSTERHEALTH, key_health },
+	{ NULL,        20, 0,                   NULL },
+	{ NULL,        22, 0,                   NULL },
+	{ prt_speed,   13, EVENT_PLAYERSPEED,   key_speed }, /* Slow (-NN) / Fast (+NN) */
+	{ prt_depth,   14, EVENT_DUNGEONLEVEL,  key_depth }, /* Lev NNN / NNNN ft */
 };
 
+/**
+ * Width of the sidebar fields, for "field_is_current()"
+ */
+#define SIDEBAR_WIDTH	13
+
+/**
+ * What each sidebar field last showed
+ */
+static struct field_cache side_cache[N_ELEMENTS(side_handlers)];
+
+/**
+ * Print one sidebar field, unless it already shows what it would print
+ */
+static void prt_side_field(size_t i, int row, int col)
+{
+	const struct side_handler_t *hnd = &side_handlers[i];
+	s32b key[FIELD_KEY_MAX];
+	size_t n;
+
+	if (!hnd->key) {
+		hnd->hook(row, col);
+		return;
+	}
+
+	n = hnd->key(key);
+	if (field_is_current(&side_cache[i], row, col, SIDEBAR_WIDTH, key, n))
+		return;
+
+	hnd->hook(row, col);
+	field_drawn(&side_cache[i], row, col, SIDEBAR_WIDTH, key, n);
+}
+
 
 /**
  * This prints the sidebar, using a clever method which means that it will only
@@ -565,9 +767,9 @@ static void update_sidebar(game_event_type type, game_event_data *data,
 		if (priority <= max_priority) {
 			if (hnd->type == type && hnd->hook) {
 				if (from_bottom)
-					hnd->hook(Term->hgt - (N_ELEMENTS(side_handlers) - i), 0);
+					prt_side_field(i, Term->hgt - (N_ELEMENTS(side_handlers) - i), 0);
 				else
-				    hnd->hook(row, 0);
+					prt_side_field(i, row, 0);
 			}
 
 			/* Increment for next time */
@@ -1010,14 +1212,93 @@ static status_f *status_handlers[] =
   prt_stun, prt_hunger, prt_study, prt_tmd, prt_dtrap };
 
 
+/**
+ * Find which entry of a state_info table a value falls under, the way
+ * PRINT_STATE() does; "at_most" selects its "<=" form over its ">" one
+ */
+static s32b state_index(const struct state_info *data, size_t n, int value,
+						bool at_most)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		if (at_most ? (value <= data[i].value) : (value > data[i].value))
+			break;
+
+	return i;
+}
+
+/**
+ * The values the status line is drawn from (see "field_is_current()").
+ *
+ * Timed effects only count by the description they get, so that a cut
+ * healing a point a turn does not redraw the line every turn.
+ */
+static size_t status_key(s32b *key)
+{
+	size_t i, n = 0;
+	u32b tmd = 0;
+	int rest = player_is_resting(player) ? player_resting_count(player) : 0;
+	int repeats = cmd_get_nrepeats();
+
+	/* Level feeling */
+	key[n++] = (OPT(birth_no_feelings) || !player->depth) ? -1 : cave->feeling;
+	key[n++] = cave->feeling_squares < z_info->feeling_need;
+
+	key[n++] = player->unignoring;
+	key[n++] = player->word_recall ? 1 : 0;
+
+	/* Counts from 1000 up are only shown to the hundred */
+	key[n++] = (rest >= 1000) ? rest / 100 : rest;
+	key[n++] = (repeats > 999) ? repeats / 100 * 100 : repeats;
+	key[n++] = player->searching;
+
+	key[n++] = state_index(cut_data, N_ELEMENTS(cut_data),
+						   player->timed[TMD_CUT], FALSE);
+	key[n++] = state_index(stun_data, N_ELEMENTS(stun_data),
+						   player->timed[TMD_STUN], FALSE);
+	key[n++] = state_index(hunger_data, N_ELEMENTS(hunger_data),
+						   player->food, TRUE);
+
+	key[n++] = player->upkeep->new_spells;
+	key[n++] = player->upkeep->new_spells &&
+		player_book_has_unlearned_spells(player);
+
+	/* One bit for each timed effect shown */
+	for (i = 0; i < N_ELEMENTS(effects); i++) {
+		if (i && !(i % 32)) {
+			key[n++] = (s32b)tmd;
+			tmd = 0;
+		}
+		if (player->timed[effects[i].value])
+			tmd |= 1UL << (i % 32);
+	}
+	key[n++] = (s32b)tmd;
+
+	/* Trap detection */
+	if (!square_isdtrap(cave, player->py, player->px))
+		key[n++] = 0;
+	else
+		key[n++] = square_isdedge(cave, player->py, player->px) ? 1 : 2;
+
+	return n;
+}
+
 /**
  * Print the status line.
  */
 static void update_statusline(game_event_type type, game_event_data *data, void *user)
 {
+	static struct field_cache cache;
 	int row = Term->hgt - 1;
 	int col = 13;
-	size_t i;
+	size_t i, n;
+	s32b key[FIELD_KEY_MAX];
+
+	/* Nothing it shows has changed */
+	n = status_key(key);
+	if (field_is_current(&cache, row, 13, Term->wid - 13, key, n))
+		return;
 
 	/* Clear the remainder of the line */
 	prt("", row, col);
@@ -1025,6 +1306,48 @@ static void update_statusline(game_event_type type, game_event_data *data, void
 	/* Display those which need redrawing */
 	for (i = 0; i < N_ELEMENTS(status_handlers); i++)
 		col += status_handlers[i](row, col);
+
+	field_drawn(&cache, row, 13, Term->wid - 13, key, n);
+}
+
+
+/**
+ * ------------------------------------------------------------------------
+ * Display pacing.
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Set when a message or disturbance has come up since the last player turn
+ * was shown, so that it reaches the screen without waiting for a frame
+ */
+static bool display_urgent = FALSE;
+
+/**
+ * Refresh the current window after a routine update.
+ *
+ * While the game plays on by itself - running, resting or repeating a
+ * command - these come after every game turn, so they are paced to
+ * "term_frame_rate" (see "Term_fresh_paced()").  Waiting for a key always
+ * refreshes in full, so the screen catches up whenever play stops.
+ */
+static void display_fresh(void)
+{
+	bool busy = player && player->upkeep && (player->upkeep->running ||
+		player_is_resting(player) || cmd_get_nrepeats() > 0);
+
+	if (busy && !display_urgent)
+		Term_fresh_paced();
+	else
+		Term_fresh();
+}
+
+/**
+ * Let the rest of this turn's updates past the pacing
+ */
+static void display_pace_break(game_event_type type, game_event_data *data,
+							   void *user)
+{
+	display_urgent = TRUE;
 }
 
 
@@ -1044,6 +1367,15 @@ static void trace_map_updates(game_event_type type, game_event_data *data,
 }
 #endif
 
+/**
+ * Let the overview maps know which grids to look at again
+ */
+static void update_overviews(game_event_type type, game_event_data *data,
+							 void *user)
+{
+	map_overview_note(data->point.y, data->point.x);
+}
+
 /**
  * Update either a single map grid or a whole map
  */
@@ -1051,9 +1383,11 @@ static void update_maps(game_event_type type, game_event_data *data, void *user)
 {
 	term *t = user;
 
-	/* This signals a whole-map redraw. */
-	if (data->point.x == -1 && data->point.y == -1)
-		prt_map();
+	/* This signals a whole-map redraw; prt_map() covers every map window */
+	if (data->point.x == -1 && data->point.y == -1) {
+		if (t == angband_term[0])
+			prt_map();
+	}
 
 	/* Single point to be redrawn */
 	else {
@@ -1117,7 +1451,7 @@ static void update_maps(game_event_type type, game_event_data *data, void *user)
 	}
 
 	/* Refresh the main screen */
-	Term_fresh();
+	display_fresh();
 }
 
 /**
@@ -1183,14 +1517,18 @@ static void do_animation(void)
 		if (!m_ptr || !m_ptr->race || !mflag_has(m_ptr->mflag, MFLAG_VISIBLE))
 			continue;
 		else if (rf_has(m_ptr->race->flags, RF_ATTR_MULTI))
-			attr = randint1(BASIC_COLORS - 1);
+			/* Leave the game's RNG alone, so recordings replay exactly */
+			attr = Rand_simple(BASIC_COLORS - 1) + 1;
 		else if (rf_has(m_ptr->race->flags, RF_ATTR_FLICKER))
 			attr = get_flicker(monster_x_attr[m_ptr->race->ridx]);
 		else
 			continue;
 
+		/* Only the monster's own grid needs redrawing */
 		m_ptr->attr = attr;
-		player->upkeep->redraw |= (PR_MAP | PR_MONLIST);
+		if (textui_map_is_visible())
+			event_signal_point(EVENT_MAP, m_ptr->fx, m_ptr->fy);
+		player->upkeep->redraw |= (PR_MONLIST);
 	}
 
 	flicker++;
@@ -1462,7 +1800,7 @@ static void update_inven_subwindow(game_event_type type, game_event_data *data,
 	else
 		show_equip(OLIST_WINDOW | OLIST_WEIGHT, NULL);
 
-	Term_fresh();
+	display_fresh();
 	
 	/* Restore */
 	Term_activate(old);
@@ -1482,7 +1820,7 @@ static void update_equip_subwindow(game_event_type type, game_event_data *data,
 	else
 		show_inven(OLIST_WINDOW | OLIST_WEIGHT | OLIST_QUIVER, NULL);
 
-	Term_fresh();
+	display_fresh();
 	
 	/* Restore */
 	Term_activate(old);
@@ -1534,7 +1872,7 @@ static void update_itemlist_subwindow(game_event_type type,
 
     clear_from(0);
     object_list_show_subwindow(Term->hgt, Term->wid);
-	Term_fresh();
+	display_fresh();
 	
 	/* Restore */
 	Term_activate(old);
@@ -1551,7 +1889,7 @@ static void update_monlist_subwindow(game_event_type type,
 
 	clear_from(0);
 	monster_list_show_subwindow(Term->hgt, Term->wid);
-	Term_fresh();
+	display_fresh();
 	
 	/* Restore */
 	Term_activate(old);
@@ -1572,7 +1910,7 @@ static void update_monster_subwindow(game_event_type type,
 		lore_show_subwindow(player->upkeep->monster_race, 
 							get_lore(player->upkeep->monster_race));
 
-	Term_fresh();
+	display_fresh();
 	
 	/* Restore */
 	Term_activate(old);
@@ -1592,7 +1930,7 @@ static void update_object_subwindow(game_event_type type,
 		display_object_recall(player->upkeep->object);
 	else if (player->upkeep->object_kind)
 		display_object_kind_recall(player->upkeep->object_kind);
-	Term_fresh();
+	display_fresh();
 	
 	/* Restore */
 	Term_activate(old);
@@ -1670,7 +2008,7 @@ static void update_minimap_subwindow(game_event_type type,
 
 		/* Redraw map */
 		display_map(NULL, NULL);
-		Term_fresh();
+		display_fresh();
 		
 		/* Restore */
 		Term_activate(old);
@@ -1707,7 +2045,7 @@ static void update_player0_subwindow(game_event_type type,
 	/* Display flags */
 	display_player(0);
 
-	Term_fresh();
+	display_fresh();
 	
 	/* Restore */
 	Term_activate(old);
@@ -1728,7 +2066,7 @@ static void update_player1_subwindow(game_event_type type,
 	/* Display flags */
 	display_player(1);
 
-	Term_fresh();
+	display_fresh();
 	
 	/* Restore */
 	Term_activate(old);
@@ -1786,7 +2124,7 @@ static void update_player_compact_subwindow(game_event_type type,
 	/* Monster health */
 	prt_health(row++, col);
 
-	Term_fresh();
+	display_fresh();
 	
 	/* Restore */
 	Term_activate(old);
@@ -1802,7 +2140,7 @@ static void flush_subwindow(game_event_type type, game_event_data *data,
 	/* Activate */
 	Term_activate(t);
 
-	Term_fresh();
+	display_fresh();
 	
 	/* Restore */
 	Term_activate(old);
@@ -2138,7 +2476,11 @@ static void refresh(game_event_type type, game_event_data *data, void *user)
 		move_cursor_relative(row, col);
 	}
 
-	Term_fresh();
+	display_fresh();
+	display_urgent = FALSE;
+
+	/* Everything this turn changed goes to the screen together */
+	Term_frame();
 }
 
 static void repeated_command_display(game_event_type type,
@@ -2161,6 +2503,9 @@ static void new_level_display_update(game_event_type type,
 	Term->offset_y = z_info->dungeon_hgt;
 	Term->offset_x = z_info->dungeon_wid;
 
+	/* The overview maps show the old level */
+	map_overview_note(-1, -1);
+
 
 	/*
 	 * Because changing levels doesn't take a turn and PR_MONLIST might not be
@@ -2401,6 +2746,7 @@ static void ui_enter_world(game_event_type type, game_event_data *data,
 
 	/* Simplest way to keep the map up to date - will do for now */
 	event_add_handler(EVENT_MAP, update_maps, angband_term[0]);
+	event_add_handler(EVENT_MAP, update_overviews, NULL);
 #ifdef MAP_DEBUG
 	event_add_handler(EVENT_MAP, trace_map_updates, angband_term[0]);
 #endif
@@ -2429,6 +2775,10 @@ static void ui_enter_world(game_event_type type, game_event_data *data,
 	/* Refresh the screen and put the cursor in the appropriate place */
 	event_add_handler(EVENT_REFRESH, refresh, NULL);
 
+	/* Show messages and disturbances without waiting for the next frame */
+	event_add_handler(EVENT_MESSAGE, display_pace_break, NULL);
+	event_add_handler(EVENT_INPUT_FLUSH, display_pace_break, NULL);
+
 	/* Do the visual updates required on a new dungeon level */
 	event_add_handler(EVENT_NEW_LEVEL_DISPLAY, new_level_display_update, NULL);
 
@@ -2466,6 +2816,7 @@ static void ui_leave_world(game_event_type type, game_event_data *data,
 
 	/* Simplest way to keep the map up to date - will do for now */
 	event_remove_handler(EVENT_MAP, update_maps, angband_term[0]);
+	event_remove_handler(EVENT_MAP, update_overviews, NULL);
 #ifdef MAP_DEBUG
 	event_remove_handler(EVENT_MAP, trace_map_updates, angband_term[0]);
 #endif
@@ -2491,6 +2842,10 @@ static void ui_leave_world(game_event_type type, game_event_data *data,
 	/* Refresh the screen and put the cursor in the appropriate place */
 	event_remove_handler(EVENT_REFRESH, refresh, NULL);
 
+	/* Show messages and disturbances without waiting for the next frame */
+	event_remove_handler(EVENT_MESSAGE, display_pace_break, NULL);
+	event_remove_handler(EVENT_INPUT_FLUSH, display_pace_break, NULL);
+
 	/* Do the visual updates required on a new dungeon level */
 	event_remove_handler(EVENT_NEW_LEVEL_DISPLAY, new_level_display_update, NULL);
 
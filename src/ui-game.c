@@ -18,6 +18,7 @@
  */
 
 #include "angband.h"
+#include "cmd-record.h"
 #include "cmds.h"
 #include "game-world.h"
 #include "init.h"
@@ -351,6 +352,7 @@ void check_for_player_interrupt(game_event_type type, game_event_data *data,
 			event_signal(EVENT_INPUT_FLUSH);
 			disturb(player, 0);
 			msg("Cancelled.");
+			cmd_record_interrupt();
 		}
 	}
 }
@@ -368,6 +370,14 @@ static void start_game(bool new_game)
 	if (file_exists(savefile) && !savefile_load(savefile, arg_wizard))
 		quit("Broken savefile");
 
+	/* Record from the savefile as it stands (see cmd-record.c) */
+	if (cmd_record_wanted()) {
+		if (player->is_dead || new_game)
+			quit("Only a saved, living character can be recorded");
+		if (!cmd_record_start(savefile))
+			quit("Couldn't start recording");
+	}
+
 	/* No living character loaded */
 	if (player->is_dead || new_game) {
 		character_generated = FALSE;
@@ -400,8 +410,13 @@ void play_game(bool new_game)
 	 * command queue is empty and a new player command is needed */
 	while (!player->is_dead && player->upkeep->playing) {
 		cmd_get_hook(CMD_GAME);
+
+		/* Show each turn's changes to all windows as a single frame */
+		Term_frame_hold(TRUE);
 		run_game_loop();
+		Term_frame_hold(FALSE);
 	}
+	cmd_record_stop();
 
 	/* Close game on death or quitting */
 	close_game();
@@ -446,8 +461,9 @@ void save_game(void)
 	/* Message */
 	prt("Saving game...", 0, 0);
 
-	/* Refresh */
+	/* Refresh, even in the middle of a turn */
 	Term_fresh();
+	Term_frame();
 
 	/* The player is not dead */
 	my_strcpy(player->died_from, "(saved)", sizeof(player->died_from));
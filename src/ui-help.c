@@ -34,14 +34,61 @@ static void string_lower(char *buf)
 }
 
 
+/*
+ * The lines of a file as shown, read once when the file is opened
+ */
+struct help_lines
+{
+	char *text;		/* Every line, each ending in a NUL */
+	size_t len;		/* Bytes of text used */
+	size_t size;	/* Bytes of text allocated */
+
+	size_t *start;	/* Offset of each line in text */
+	int count;		/* Number of lines */
+	int max;		/* Number of offsets allocated */
+};
+
+
+/*
+ * Add a line to the end of a help_lines
+ */
+static void help_lines_add(struct help_lines *hl, const char *buf)
+{
+	size_t n = strlen(buf) + 1;
+
+	if (hl->len + n > hl->size) {
+		while (hl->len + n > hl->size)
+			hl->size = hl->size ? hl->size * 2 : 4096;
+		hl->text = mem_realloc(hl->text, hl->size);
+	}
+
+	if (hl->count == hl->max) {
+		hl->max = hl->max ? hl->max * 2 : 256;
+		hl->start = mem_realloc(hl->start, hl->max * sizeof(size_t));
+	}
+
+	memcpy(hl->text + hl->len, buf, n);
+	hl->start[hl->count++] = hl->len;
+	hl->len += n;
+}
+
+
+/*
+ * Get line "i" of a help_lines
+ */
+static const char *help_lines_get(const struct help_lines *hl, int i)
+{
+	return hl->text + hl->start[i];
+}
+
+
 /*
  * Recursive file perusal.
  *
  * Return FALSE on "?", otherwise TRUE.
  *
- * This function could be made much more efficient with the use of "seek"
- * functionality, especially when moving backwards through a file, or
- * forwards through a file by less than a page at a time.  XXX XXX XXX
+ * The file is read once, into a table of the lines to show, so paging and
+ * searching never go back to the file.
  */
 bool show_file(const char *name, const char *what, int line, int mode)
 {
@@ -55,6 +102,9 @@ bool show_file(const char *name, const char *what, int line, int mode)
 	/* Number of "real" lines in the file */
 	int size;
 
+	/* The "real" lines */
+	struct help_lines lines = { NULL, 0, 0, NULL, 0, 0 };
+
 	/* Backup value for "line" */
 	int back = 0;
 
@@ -221,10 +271,20 @@ bool show_file(const char *name, const char *what, int line, int mode)
 			continue;
 		}
 
-		/* Count the "real" lines */
+		/* skip | characters */
+		strskip(buf,'|');
+
+		/* escape backslashes */
+		strescape(buf,'\\');
+
+		/* Keep the "real" lines */
+		help_lines_add(&lines, buf);
 		next++;
 	}
 
+	/* The file is no longer needed */
+	file_close(fff);
+
 	/* Save the number of "real" lines */
 	size = next;
 
@@ -240,78 +300,33 @@ bool show_file(const char *name, const char *what, int line, int mode)
 		if (line > (size - (hgt - 4))) line = size - (hgt - 4);
 		if (line < 0) line = 0;
 
-		skip_lines = FALSE;
-		/* Re-open the file if needed */
-		if (next > line)
+		/* Look for the search string, from the top line down */
+		if (find)
 		{
-			/* Close it */
-			file_close(fff);
-
-			/* Hack -- Re-Open the file */
-			fff = file_open(path, MODE_READ, FTYPE_TEXT);
-			if (!fff) return (TRUE);
-
-			/* File has been restarted */
-			next = 0;
-		}
+			for (k = line; k < size; k++)
+			{
+				/* Make a copy of the line for searching */
+				my_strcpy(lc_buf, help_lines_get(&lines, k), sizeof(lc_buf));
 
+				/* Make the line lower case */
+				if (!case_sensitive) string_lower(lc_buf);
 
-		/* Goto the selected line */
-		while (next < line)
-		{
-			/* Get a line */
-			if (!file_getl(fff, buf, sizeof(buf))) break;
-
-			/* Skip lines if we are inside a RST directive*/
-			if(skip_lines){
-				if(contains_only_spaces(buf))
-					skip_lines=FALSE;
-				continue;
+				if (strstr(lc_buf, find)) break;
 			}
 
-			/* Skip RST directives */
-			if (prefix(buf, ".. "))
+			if (k < size)
 			{
-				skip_lines=TRUE;
-				continue;
+				/* Start at the match */
+				line = k;
+				find = NULL;
 			}
-
-			/* Count the lines */
-			next++;
 		}
 
-
 		/* Dump the next lines of the file */
-		for (i = 0; i < hgt - 4; )
+		for (i = 0; !find && i < hgt - 4 && line + i < size; i++)
 		{
-			/* Hack -- track the "first" line */
-			if (!i) line = next;
-
-			/* Get a line of the file or stop */
-			if (!file_getl(fff, buf, sizeof(buf))) break;
-
-			/* Skip lines if we are inside a RST directive*/
-			if(skip_lines){
-				if(contains_only_spaces(buf))
-					skip_lines=FALSE;
-				continue;
-			}
-
-			/* Skip RST directives */
-			if (prefix(buf, ".. "))
-			{
-				skip_lines=TRUE;
-				continue;
-			}
-
-			/* skip | characters */
-			strskip(buf,'|');
-
-			/* escape backslashes */
-			strescape(buf,'\\');
-
-			/* Count the "real" lines */
-			next++;
+			/* Make a copy of the current line */
+			my_strcpy(buf, help_lines_get(&lines, line + i), sizeof(buf));
 
 			/* Make a copy of the current line for searching */
 			my_strcpy(lc_buf, buf, sizeof(lc_buf));
@@ -319,12 +334,6 @@ bool show_file(const char *name, const char *what, int line, int mode)
 			/* Make the line lower case */
 			if (!case_sensitive) string_lower(lc_buf);
 
-			/* Hack -- keep searching */
-			if (find && !i && !strstr(lc_buf, find)) continue;
-
-			/* Hack -- stop searching */
-			find = NULL;
-
 			/* Dump the line */
 			Term_putstr(0, i+2, -1, COLOUR_WHITE, buf);
 
@@ -346,9 +355,6 @@ bool show_file(const char *name, const char *what, int line, int mode)
 					str += len;
 				}
 			}
-
-			/* Count the printed lines */
-			i++;
 		}
 
 		/* Hack -- failed search */
@@ -500,8 +506,9 @@ bool show_file(const char *name, const char *what, int line, int mode)
 		if (ch.code == ESCAPE) break;
 	}
 
-	/* Close the file */
-	file_close(fff);
+	/* Free the lines */
+	mem_free(lines.text);
+	mem_free(lines.start);
 
 	/* Done */
 	return (ch.code != '?');
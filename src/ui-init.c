@@ -24,13 +24,17 @@
 
 
 #include "angband.h"
+#include "cave.h"
 #include "game-input.h"
 #include "game-event.h"
+#include "mon-lore.h"
 #include "ui-display.h"
 #include "ui-game.h"
 #include "ui-input.h"
 #include "ui-keymap.h"
 #include "ui-knowledge.h"
+#include "ui-map.h"
+#include "ui-mon-lore.h"
 #include "ui-options.h"
 #include "ui-output.h"
 #include "ui-prefs.h"
@@ -105,4 +109,7 @@ void textui_cleanup(void)
 
 	keymap_free();
 	textui_prefs_free();
+	map_frame_free();
+	map_overview_free();
+	lore_recall_free();
 }
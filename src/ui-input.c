@@ -754,6 +754,7 @@ static bool get_name_keypress(char *buf, size_t buflen, size_t *curs,
 	{
 		case '*':
 		{
+			init_randnames();
 			*len = randname_make(RANDNAME_TOLKIEN, 4, 8, buf, buflen,
 								 name_sections);
 			my_strcap(buf);
@@ -45,6 +45,7 @@ struct keymap {
 	bool user;		/* User-defined keymap */
 
 	struct keymap *next;
+	struct keymap *hash_next;	/* Next keymap with the same hash */
 };
 
 
@@ -53,6 +54,19 @@ struct keymap {
  */
 static struct keymap *keymaps[KEYMAP_MODE_MAX];
 
+/**
+ * The same keymaps hashed by trigger, as pref files can make hundreds and
+ * every keypress looks for one; the list keeps the order for dumping.
+ */
+#define KEYMAP_HASH_SIZE 128
+static struct keymap *keymap_hash[KEYMAP_MODE_MAX][KEYMAP_HASH_SIZE];
+
+static struct keymap **keymap_bucket(int keymap, struct keypress kc)
+{
+	return &keymap_hash[keymap][(kc.code ^ (kc.mods << 5)) %
+								KEYMAP_HASH_SIZE];
+}
+
 
 /**
  * Find a keymap, given a keypress.
@@ -61,7 +75,7 @@ const struct keypress *keymap_find(int keymap, struct keypress kc)
 {
 	struct keymap *k;
 	assert(keymap >= 0 && keymap < KEYMAP_MODE_MAX);
-	for (k = keymaps[keymap]; k; k = k->next) {
+	for (k = *keymap_bucket(keymap, kc); k; k = k->hash_next) {
 		if (k->key.code == kc.code && k->key.mods == kc.mods)
 			return k->actions;
 	}
@@ -110,6 +124,9 @@ void keymap_add(int keymap, struct keypress trigger, struct keypress *actions, b
 	k->next = keymaps[keymap];
 	keymaps[keymap] = k;
 
+	k->hash_next = *keymap_bucket(keymap, trigger);
+	*keymap_bucket(keymap, trigger) = k;
+
 	return;
 }
 
@@ -119,10 +136,23 @@ void keymap_add(int keymap, struct keypress trigger, struct keypress *actions, b
  */
 bool keymap_remove(int keymap, struct keypress trigger)
 {
-	struct keymap *k;
+	struct keymap *k, **link;
 	struct keymap *prev = NULL;
+	bool found = FALSE;
 	assert(keymap >= 0 && keymap < KEYMAP_MODE_MAX);
 
+	/* Take it out of the hash; if it isn't there, it isn't anywhere */
+	for (link = keymap_bucket(keymap, trigger); *link;
+		 link = &(*link)->hash_next) {
+		k = *link;
+		if (k->key.code == trigger.code && k->key.mods == trigger.mods) {
+			*link = k->hash_next;
+			found = TRUE;
+			break;
+		}
+	}
+	if (!found) return FALSE;
+
 	for (k = keymaps[keymap]; k; k = k->next) {
 		if (k->key.code == trigger.code && k->key.mods == trigger.mods) {
 			mem_free(k->actions);
@@ -156,7 +186,9 @@ void keymap_free(void)
 			mem_free(k);
 			k = next;
 		}
+		keymaps[i] = NULL;
 	}
+	memset(keymap_hash, 0, sizeof(keymap_hash));
 }
 
 
@@ -21,6 +21,7 @@
 #include "cave.h"
 #include "cmds.h"
 #include "game-input.h"
+#include "game-world.h"
 #include "grafmode.h"
 #include "init.h"
 #include "mon-lore.h"
@@ -128,6 +129,24 @@ typedef struct join {
  */
 static join_t *default_join;
 
+/**
+ * A browser's sorted member list, kept from one visit to the next.  The
+ * sort is only redone when the collected list or the signature of the
+ * knowledge it was sorted by has changed.
+ */
+struct knowledge_order {
+	u32b sig;
+	int count;
+	int *input;
+	int *sorted;
+};
+
+static struct knowledge_order monster_order;
+static struct knowledge_order artifact_order;
+static struct knowledge_order ego_order;
+static struct knowledge_order object_order;
+static struct knowledge_order feature_order;
+
 /**
  * Clipboard variables for copy & paste in visual mode
  */
@@ -149,6 +168,66 @@ static int default_group_id(int oid)
 	return default_join[oid].gid;
 }
 
+/**
+ * Fold a value into a knowledge signature
+ */
+static u32b knowledge_sig(u32b sig, int val)
+{
+	return sig * 33 + (u32b) val;
+}
+
+/**
+ * Fold a join table into a knowledge signature
+ */
+static u32b join_sig(const join_t *join, int count)
+{
+	u32b sig = 5381;
+	int i;
+
+	for (i = 0; i < count; i++)
+		sig = knowledge_sig(knowledge_sig(sig, join[i].oid), join[i].gid);
+
+	return sig;
+}
+
+/**
+ * Put a member list into display order, reusing the last visit's order
+ * when nothing it depends on has changed.
+ */
+static void knowledge_sort(struct knowledge_order *order, u32b sig,
+		int *list, int count, int (*gcomp)(const void *, const void *))
+{
+	size_t size = count * sizeof(*list);
+
+	if (order->sorted && order->sig == sig && order->count == count &&
+			!memcmp(order->input, list, size)) {
+		memcpy(list, order->sorted, size);
+		return;
+	}
+
+	mem_free(order->input);
+	mem_free(order->sorted);
+	order->input = mem_alloc(size + sizeof(*list));
+	order->sorted = mem_alloc(size + sizeof(*list));
+	memcpy(order->input, list, size);
+
+	sort(list, count, sizeof(*list), gcomp);
+
+	memcpy(order->sorted, list, size);
+	order->sig = sig;
+	order->count = count;
+}
+
+/**
+ * Forget a kept member list
+ */
+static void knowledge_order_free(struct knowledge_order *order)
+{
+	mem_free(order->input);
+	mem_free(order->sorted);
+	memset(order, 0, sizeof(*order));
+}
+
 /**
  * Return a specific ordering for the features
  */
@@ -689,7 +768,8 @@ static const char *recall_prompt(int oid)
  */
 static void display_knowledge(const char *title, int *obj_list, int o_count,
 				group_funcs g_funcs, member_funcs o_funcs,
-				const char *otherfields)
+				const char *otherfields, struct knowledge_order *order,
+				u32b sig)
 {
 	/* Maximum number of groups to display */
 	int max_group = g_funcs.maxnum < o_count ? g_funcs.maxnum : o_count ;
@@ -757,7 +837,7 @@ static void display_knowledge(const char *title, int *obj_list, int o_count,
 	if (tiles) tiles = (current_graphics_mode->grafID != 0);
 
 	if (g_funcs.gcomp)
-		sort(obj_list, o_count, sizeof(*obj_list), g_funcs.gcomp);
+		knowledge_sort(order, sig, obj_list, o_count, g_funcs.gcomp);
 
 	/* Sort everything into group order */
 	g_list = mem_zalloc((max_group + 1) * sizeof(int));
@@ -800,12 +880,12 @@ static void display_knowledge(const char *title, int *obj_list, int o_count,
 	menu_init(&group_menu, MN_SKIN_SCROLL, menu_find_iter(MN_ITER_STRINGS));
 	menu_setpriv(&group_menu, grp_cnt, g_names);
 	menu_layout(&group_menu, &group_region);
-	group_menu.flags |= MN_DBL_TAP;
+	group_menu.flags |= MN_DBL_TAP | MN_CACHE_ROWS;
 
 	menu_init(&object_menu, MN_SKIN_SCROLL, &object_iter);
 	menu_setpriv(&object_menu, 0, &o_funcs);
 	menu_layout(&object_menu, &object_region);
-	object_menu.flags |= MN_DBL_TAP;
+	object_menu.flags |= MN_DBL_TAP | MN_CACHE_ROWS;
 
 	o_funcs.is_visual = FALSE;
 
@@ -945,6 +1025,12 @@ static void display_knowledge(const char *title, int *obj_list, int o_count,
 				ke = ke0;
 		}
 
+		/* Anything but moving about may change rows or draw over them */
+		if (ke.type != EVT_MOVE) {
+			menu_redraw_rows(&group_menu);
+			menu_redraw_rows(&object_menu);
+		}
+
 		/* XXX Do visual mode command if needed */
 		if (o_funcs.xattr && o_funcs.xchar) {
 			if (tiles) {
@@ -1319,7 +1405,8 @@ static void do_cmd_knowledge_monsters(const char *name, int row)
 	}
 
 	display_knowledge("monsters", monsters, m_count, r_funcs, m_funcs,
-			"                   Sym  Kills");
+			"                   Sym  Kills", &monster_order,
+			join_sig(default_join, m_count));
 	mem_free(default_join);
 	mem_free(monsters);
 }
@@ -1559,7 +1646,8 @@ static void do_cmd_knowledge_artifacts(const char *name, int row)
 	/* Collect valid artifacts */
 	a_count = collect_known_artifacts(artifacts, z_info->a_max);
 
-	display_knowledge("artifacts", artifacts, a_count, obj_f, art_f, NULL);
+	display_knowledge("artifacts", artifacts, a_count, obj_f, art_f, NULL,
+			&artifact_order, 0);
 	mem_free(artifacts);
 }
 
@@ -1668,7 +1756,8 @@ static void do_cmd_knowledge_ego_items(const char *name, int row)
 		}
 	}
 
-	display_knowledge("ego items", egoitems, e_count, obj_f, ego_f, NULL);
+	display_knowledge("ego items", egoitems, e_count, obj_f, ego_f, NULL,
+			&ego_order, join_sig(default_join, e_count));
 
 	mem_free(default_join);
 	mem_free(egoitems);
@@ -1955,6 +2044,9 @@ void textui_browse_object_knowledge(const char *name, int row)
 	int i;
 	object_kind *kind;
 
+	/* Unaware kinds sort by flavour, and awareness moves them about */
+	u32b sig = knowledge_sig(5381, seed_flavor);
+
 	objects = mem_zalloc(z_info->k_max * sizeof(int));
 
 	for (i = 0; i < z_info->k_max; i++) {
@@ -1969,11 +2061,12 @@ void textui_browse_object_knowledge(const char *name, int row)
 				 !artifact_is_known(get_artifact_from_kind(kind)))) {
 			int c = obj_group_order[k_info[i].tval];
 			if (c >= 0) objects[o_count++] = i;
+			sig = knowledge_sig(sig, kind->aware * 2 + kind->tried);
 		}
 	}
 
 	display_knowledge("known objects", objects, o_count, kind_f, obj_f,
-					  "Ignore  Inscribed          Sym");
+					  "Ignore  Inscribed          Sym", &object_order, sig);
 
 	mem_free(objects);
 }
@@ -2123,7 +2216,7 @@ static void do_cmd_knowledge_features(const char *name, int row)
 	}
 
 	display_knowledge("features", features, f_count, fkind_f, feat_f,
-					  "                    Sym");
+					  "                    Sym", &feature_order, 0);
 	mem_free(features);
 }
 
@@ -2179,6 +2272,11 @@ static struct menu knowledge_menu;
  */
 static void cleanup_cmds(void) {
 	mem_free(obj_group_order);
+	knowledge_order_free(&monster_order);
+	knowledge_order_free(&artifact_order);
+	knowledge_order_free(&ego_order);
+	knowledge_order_free(&object_order);
+	knowledge_order_free(&feature_order);
 }
 
 void textui_knowledge_init(void)
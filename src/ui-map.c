@@ -40,7 +40,7 @@ static void hallucinatory_monster(int *a, wchar_t *c)
 {
 	while (1) {
 		/* Select a random monster */
-		monster_race *r_ptr = &r_info[randint0(z_info->r_max)];
+		monster_race *r_ptr = &r_info[Rand_simple(z_info->r_max)];
 		
 		/* Skip non-entries */
 		if (!r_ptr->name) continue;
@@ -61,7 +61,7 @@ static void hallucinatory_object(int *a, wchar_t *c)
 	
 	while (1) {
 		/* Select a random object */
-		object_kind *k_ptr = &k_info[randint0(z_info->k_max - 1) + 1];
+		object_kind *k_ptr = &k_info[Rand_simple(z_info->k_max - 1) + 1];
 
 		/* Skip non-entries */
 		if (!k_ptr->name) continue;
@@ -542,6 +542,64 @@ void print_rel(wchar_t c, byte a, int y, int x)
 }
 
 
+/**
+ * Grids worked out during the current prt_map(), shared between the main map
+ * and any map subwindows so that each grid goes through map_info() once.
+ */
+static grid_data *frame_grids;
+static u32b *frame_stamps;
+static size_t frame_size;
+static u32b frame_now;
+
+/**
+ * Start a new redraw, forgetting every grid worked out so far
+ */
+static void map_frame_begin(void)
+{
+	size_t size = (size_t)cave->height * cave->width;
+
+	if (size > frame_size) {
+		mem_free(frame_grids);
+		mem_free(frame_stamps);
+		frame_grids = mem_alloc(size * sizeof(*frame_grids));
+		frame_stamps = mem_zalloc(size * sizeof(*frame_stamps));
+		frame_size = size;
+		frame_now = 0;
+	}
+
+	/* Stamps of zero never match, so restart them when the count wraps */
+	if (++frame_now == 0) {
+		memset(frame_stamps, 0, frame_size * sizeof(*frame_stamps));
+		frame_now = 1;
+	}
+}
+
+/**
+ * map_info(), remembering the result for the rest of the current redraw
+ */
+static void map_info_frame(int y, int x, grid_data *g)
+{
+	size_t i = (size_t)y * cave->width + x;
+
+	if (frame_stamps[i] != frame_now) {
+		map_info(y, x, &frame_grids[i]);
+		frame_stamps[i] = frame_now;
+	}
+	*g = frame_grids[i];
+}
+
+/**
+ * Free the redraw cache
+ */
+void map_frame_free(void)
+{
+	mem_free(frame_grids);
+	mem_free(frame_stamps);
+	frame_grids = NULL;
+	frame_stamps = NULL;
+	frame_size = 0;
+}
+
 static void prt_map_aux(void)
 {
 	int a, ta;
@@ -577,7 +635,7 @@ static void prt_map_aux(void)
 				if (vx + tile_width - 1 >= t->wid) continue;
 
 				/* Determine what is there */
-				map_info(y, x, &g);
+				map_info_frame(y, x, &g);
 				grid_data_as_text(&g, &a, &c, &ta, &tc);
 				Term_queue_char(t, vx, vy, a, c, ta, tc);
 
@@ -607,6 +665,9 @@ void prt_map(void)
 	int vy, vx;
 	int ty, tx;
 
+	/* Both the main map and the sub-windows draw from the same grids */
+	map_frame_begin();
+
 	/* Redraw map sub-windows */
 	prt_map_aux();
 
@@ -621,7 +682,7 @@ void prt_map(void)
 			if (!square_in_bounds(cave, y, x)) continue;
 
 			/* Determine what is there */
-			map_info(y, x, &g);
+			map_info_frame(y, x, &g);
 			grid_data_as_text(&g, &a, &c, &ta, &tc);
 
 			/* Hack -- Queue it */
@@ -632,6 +693,225 @@ void prt_map(void)
 		}
 }
 
+/**
+ * ------------------------------------------------------------------------
+ * The overview map
+ *
+ * display_map() shrinks the whole level into a window, showing for each cell
+ * of the window the grid under it with the highest priority.  Rather than
+ * look at every grid of the level on every call, each window that shows an
+ * overview keeps the cells it last worked out, and only works out again the
+ * cells that map_overview_note() has been told about.
+ * ------------------------------------------------------------------------ */
+
+/**
+ * The most windows that keep an overview at once
+ */
+#define MAP_OVERVIEWS	4
+
+/**
+ * What one cell of an overview shows
+ */
+struct overview_cell {
+	byte priority;		/* Priority of the grid shown, 0 for none */
+	int a, ta;
+	wchar_t c, tc;
+};
+
+/**
+ * An overview of the current level for one window
+ */
+struct map_overview {
+	term *t;				/* Window it is drawn in */
+	u32b used;				/* When it was last drawn, to pick one to reuse */
+	int height, width;		/* Size of the level */
+	int hgt, wid;			/* Size of the overview */
+	int tw, th;				/* Tile size it was laid out for */
+	bool stale;				/* Every cell needs working out */
+	struct overview_cell *cells;
+	bool *dirty;			/* Cells needing working out */
+	int *dirty_list;
+	int dirty_num;
+};
+
+static struct map_overview overviews[MAP_OVERVIEWS];
+static u32b overview_clock;
+
+/**
+ * Find the cell of an overview which shows grid (y, x)
+ */
+static int overview_cell_at(const struct map_overview *o, int y, int x)
+{
+	int row = y * o->hgt / o->height;
+	int col = x * o->wid / o->width;
+
+	if (o->tw > 1) col -= col % o->tw;
+	if (o->th > 1) row -= row % o->th;
+
+	return row * o->wid + col;
+}
+
+/**
+ * Find the first grid (along one axis) that falls in overview cell `cell`,
+ * given `len` cells for `size` grids
+ */
+static int overview_grid_start(int cell, int len, int size)
+{
+	int grid = (cell * size + len - 1) / len;
+
+	return MIN(grid, size);
+}
+
+/**
+ * Work out what one cell of an overview shows
+ */
+static void overview_cell_update(struct map_overview *o, int cell)
+{
+	struct overview_cell *oc = &o->cells[cell];
+	int row = cell / o->wid, col = cell % o->wid;
+	int y0 = overview_grid_start(row, o->hgt, o->height);
+	int y1 = overview_grid_start(row + o->th, o->hgt, o->height);
+	int x0 = overview_grid_start(col, o->wid, o->width);
+	int x1 = overview_grid_start(col + o->tw, o->wid, o->width);
+	int y, x;
+
+	/* Nothing here */
+	oc->priority = 0;
+	oc->a = oc->ta = COLOUR_WHITE;
+	oc->c = oc->tc = L' ';
+
+	for (y = y0; y < y1; y++) {
+		for (x = x0; x < x1; x++) {
+			grid_data g;
+			int a, ta;
+			wchar_t c, tc;
+			byte tp;
+
+			/* Get the attr/char at that map location */
+			map_info(y, x, &g);
+			grid_data_as_text(&g, &a, &c, &ta, &tc);
+
+			/* Get the priority of that attr/char */
+			tp = f_info[g.f_idx].priority;
+
+			/* Stuff on top of terrain gets higher priority */
+			if ((a != ta) || (c != tc)) tp = 20;
+
+			/* Save "best" */
+			if (oc->priority < tp) {
+				/* Hack - make every grid on the map lit */
+				g.lighting = LIGHTING_LIT;
+				grid_data_as_text(&g, &oc->a, &oc->c, &oc->ta, &oc->tc);
+				oc->priority = tp;
+			}
+		}
+	}
+}
+
+/**
+ * Get an overview of the current level sized for the active window,
+ * working out any cells that have changed
+ */
+static struct map_overview *overview_get(int map_hgt, int map_wid)
+{
+	struct map_overview *o = NULL;
+	int i, n = map_hgt * map_wid;
+
+	/* Use the window's own overview, or the one least recently drawn */
+	for (i = 0; i < MAP_OVERVIEWS; i++) {
+		if (overviews[i].t == Term) {
+			o = &overviews[i];
+			break;
+		}
+		if (!o || overviews[i].used < o->used)
+			o = &overviews[i];
+	}
+
+	/* Lay it out again if the level or the window has changed shape */
+	if (o->t != Term || o->height != cave->height ||
+		o->width != cave->width || o->hgt != map_hgt || o->wid != map_wid ||
+		o->tw != tile_width || o->th != tile_height) {
+		mem_free(o->cells);
+		mem_free(o->dirty);
+		mem_free(o->dirty_list);
+		o->t = Term;
+		o->height = cave->height;
+		o->width = cave->width;
+		o->hgt = map_hgt;
+		o->wid = map_wid;
+		o->tw = tile_width;
+		o->th = tile_height;
+		o->cells = mem_zalloc(n * sizeof(*o->cells));
+		o->dirty = mem_zalloc(n * sizeof(*o->dirty));
+		o->dirty_list = mem_zalloc(n * sizeof(*o->dirty_list));
+		o->dirty_num = 0;
+		o->stale = TRUE;
+	}
+
+	o->used = ++overview_clock;
+
+	if (o->stale) {
+		int row, col;
+
+		for (row = 0; row < o->hgt; row += o->th)
+			for (col = 0; col < o->wid; col += o->tw)
+				overview_cell_update(o, row * o->wid + col);
+		o->stale = FALSE;
+	} else {
+		for (i = 0; i < o->dirty_num; i++)
+			overview_cell_update(o, o->dirty_list[i]);
+	}
+
+	for (i = 0; i < o->dirty_num; i++)
+		o->dirty[o->dirty_list[i]] = FALSE;
+	o->dirty_num = 0;
+
+	return o;
+}
+
+/**
+ * Tell the overviews that grid (y, x) of the current level may look
+ * different, or with (-1, -1) that anything may have changed
+ */
+void map_overview_note(int y, int x)
+{
+	int i;
+
+	for (i = 0; i < MAP_OVERVIEWS; i++) {
+		struct map_overview *o = &overviews[i];
+		int cell;
+
+		if (!o->t || o->stale) continue;
+
+		if (y < 0 || x < 0 || !cave || o->height != cave->height ||
+			o->width != cave->width) {
+			o->stale = TRUE;
+			continue;
+		}
+
+		cell = overview_cell_at(o, y, x);
+		if (!o->dirty[cell]) {
+			o->dirty[cell] = TRUE;
+			o->dirty_list[o->dirty_num++] = cell;
+		}
+	}
+}
+
+/**
+ * Free the overviews
+ */
+void map_overview_free(void)
+{
+	int i;
+
+	for (i = 0; i < MAP_OVERVIEWS; i++) {
+		mem_free(overviews[i].cells);
+		mem_free(overviews[i].dirty);
+		mem_free(overviews[i].dirty_list);
+	}
+	memset(overviews, 0, sizeof(overviews));
+}
+
 /**
  * Display a "small-scale" map of the dungeon in the active Term.
  *
@@ -655,21 +935,13 @@ void display_map(int *cy, int *cx)
 	int map_hgt, map_wid;
 	int row, col;
 
-	int x, y;
-	grid_data g;
-
-	int a, ta;
-	wchar_t c, tc;
+	int ta;
+	wchar_t tc;
 
-	byte tp;
+	struct map_overview *o;
 
 	monster_race *r_ptr = &r_info[0];
 
-	/* Priority array */
-	byte **mp = mem_zalloc(cave->height * sizeof(byte*));
-	for (y = 0; y < cave->height; y++)
-		mp[y] = mem_zalloc(cave->width * sizeof(byte));
-
 	/* Desired map height */
 	map_hgt = Term->hgt - 2;
 	map_wid = Term->wid - 2;
@@ -679,58 +951,25 @@ void display_map(int *cy, int *cx)
 	if (map_wid > cave->width) map_wid = cave->width;
 
 	/* Prevent accidents */
-	if ((map_wid < 1) || (map_hgt < 1)) {
-		for (y = 0; y < cave->height; y++)
-			mem_free(mp[y]);
-		mem_free(mp);
+	if ((map_wid < 1) || (map_hgt < 1))
 		return;
-	}
-
-	/* Nothing here */
-	a = COLOUR_WHITE;
-    c = L' ';
-	ta = COLOUR_WHITE;
-	tc = L' ';
 
 	/* Draw a box around the edge of the term */
 	window_make(0, 0, map_wid + 1, map_hgt + 1);
 
-	/* Analyze the actual map */
-	for (y = 0; y < cave->height; y++)
-		for (x = 0; x < cave->width; x++) {
-			row = (y * map_hgt / cave->height);
-			col = (x * map_wid / cave->width);
+	/* Draw the overview, working out only the cells that have changed */
+	o = overview_get(map_hgt, map_wid);
+	for (row = 0; row < map_hgt; row += tile_height) {
+		for (col = 0; col < map_wid; col += tile_width) {
+			struct overview_cell *oc = &o->cells[row * map_wid + col];
 
-			if (tile_width > 1)
-				col = col - (col % tile_width);
-			if (tile_height > 1)
-				row = row - (row % tile_height);
+			Term_queue_char(Term, col + 1, row + 1, oc->a, oc->c, oc->ta,
+							oc->tc);
 
-			/* Get the attr/char at that map location */
-			map_info(y, x, &g);
-			grid_data_as_text(&g, &a, &c, &ta, &tc);
-
-			/* Get the priority of that attr/char */
-			tp = f_info[g.f_idx].priority;
-
-			/* Stuff on top of terrain gets higher priority */
-			if ((a != ta) || (c != tc)) tp = 20;
-
-			/* Save "best" */
-			if (mp[row][col] < tp) {
-				/* Hack - make every grid on the map lit */
-				g.lighting = LIGHTING_LIT;
-				grid_data_as_text(&g, &a, &c, &ta, &tc);
-
-				Term_queue_char(Term, col + 1, row + 1, a, c, ta, tc);
-
-				if ((tile_width > 1) || (tile_height > 1))
-					Term_big_queue_char(Term, col + 1, row + 1, 255, -1, 0, 0);
-
-				/* Save priority */
-				mp[row][col] = tp;
-			}
+			if ((tile_width > 1) || (tile_height > 1))
+				Term_big_queue_char(Term, col + 1, row + 1, 255, -1, 0, 0);
 		}
+	}
 
 	/*** Display the player ***/
 
@@ -756,10 +995,6 @@ void display_map(int *cy, int *cx)
 	/* Return player location */
 	if (cy != NULL) (*cy) = row + 1;
 	if (cx != NULL) (*cx) = col + 1;
-
-	for (y = 0; y < cave->height; y++)
-		mem_free(mp[y]);
-	mem_free(mp);
 }
 
 
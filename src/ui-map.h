@@ -20,5 +20,8 @@ extern void grid_data_as_text(grid_data *g, int *ap, wchar_t *cp, int *tap, wcha
 extern void move_cursor_relative(int y, int x);
 extern void print_rel(wchar_t c, byte a, int y, int x);
 extern void prt_map(void);
+extern void map_frame_free(void);
+extern void map_overview_note(int y, int x);
+extern void map_overview_free(void);
 extern void display_map(int *cy, int *cx);
 extern void do_cmd_view_map(void);
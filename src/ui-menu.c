@@ -171,6 +171,7 @@ static void display_scrolling(struct menu *menu, int cursor, int *top, region *l
 	int rows_per_page = loc->page_rows;
 	int n = menu->filter_list ? menu->filter_count : menu->count;
 	int i;
+	bool partial;
 
 	/* Keep a certain distance from the top when possible */
 	if ((cursor <= *top) && (*top > 0))
@@ -184,17 +185,32 @@ static void display_scrolling(struct menu *menu, int cursor, int *top, region *l
 	*top = MIN(*top, n - rows_per_page);
 	*top = MAX(*top, 0);
 
+	/* With the same page already on screen, only the cursor rows change */
+	partial = (menu->flags & MN_CACHE_ROWS) && menu->drawn &&
+		menu->drawn_filter == menu->filter_list && menu->drawn_count == n &&
+		menu->drawn_top == *top;
+
 	for (i = 0; i < rows_per_page; i++) {
+		bool is_curs = (i == cursor - *top);
+
+		if (partial && !is_curs && i != menu->drawn_cursor - *top)
+			continue;
+
 		/* Blank all lines */
 		Term_erase(col, row + i, loc->width);
 		if (i < n) {
 			/* Redraw the line if it's within the number of menu items */
-			bool is_curs = (i == cursor - *top);
 			display_menu_row(menu, i + *top, *top, is_curs, row + i, col,
 							loc->width);
 		}
 	}
 
+	menu->drawn = TRUE;
+	menu->drawn_filter = menu->filter_list;
+	menu->drawn_count = n;
+	menu->drawn_top = *top;
+	menu->drawn_cursor = cursor;
+
 	if (menu->cursor >= 0)
 		Term_gotoxy(col + menu->cursor_x_offset, row + cursor - *top);
 }
@@ -568,6 +584,7 @@ void menu_refresh(struct menu *menu, bool reset_screen)
 	if (reset_screen) {
 		screen_load();
 		screen_save();
+		menu_redraw_rows(menu);
 	}
 
 	if (menu->filter_list && menu->cursor >= 0)
@@ -591,6 +608,11 @@ void menu_refresh(struct menu *menu, bool reset_screen)
 	menu->skin->display_list(menu, menu->cursor, &menu->top, loc);
 }
 
+void menu_redraw_rows(struct menu *menu)
+{
+	menu->drawn = FALSE;
+}
+
 
 /*** MENU RUNNING AND INPUT HANDLING CODE ***/
 
@@ -906,6 +928,7 @@ static bool menu_calc_size(struct menu *menu)
 bool menu_layout(struct menu *m, const region *loc)
 {
 	m->boundary = *loc;
+	menu_redraw_rows(m);
 	return menu_calc_size(m);
 }
 
@@ -913,6 +936,7 @@ void menu_setpriv(struct menu *menu, int count, void *data)
 {
 	menu->count = count;
 	menu->menu_data = data;
+	menu_redraw_rows(menu);
 
 	menu_ensure_cursor_valid(menu);
 }
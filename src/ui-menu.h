@@ -197,7 +197,11 @@ enum
 	MN_NO_ACTION = 0x20,
 
 	/* Tags can be selected via an inscription */
-	MN_INSCRIP_TAGS = 0x40
+	MN_INSCRIP_TAGS = 0x40,
+
+	/* Rows keep their look between refreshes unless the menu is told
+	 * otherwise, so only rows the cursor moves on or off need redrawing */
+	MN_CACHE_ROWS = 0x80
 };
 
 
@@ -250,6 +254,13 @@ struct menu
 	int top;                /* Position in list for partial display */
 	region active;          /* Subregion actually active for selection */
 	int cursor_x_offset;    /* Adjustment to the default position of the cursor on a line. */
+
+	/* What the scrolling skin last drew, for MN_CACHE_ROWS */
+	bool drawn;             /* The rows below are on screen */
+	const int *drawn_filter;
+	int drawn_count;
+	int drawn_top;
+	int drawn_cursor;
 };
 
 
@@ -324,6 +335,13 @@ bool menu_layout(struct menu *menu, const region *loc);
 void menu_refresh(struct menu *menu, bool reset_screen);
 
 
+/**
+ * Make the next refresh of an MN_CACHE_ROWS menu redraw every row, for
+ * use when the rows' contents or the screen under them have changed.
+ */
+void menu_redraw_rows(struct menu *menu);
+
+
 /**
  * Run a menu.
  *
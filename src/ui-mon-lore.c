@@ -17,7 +17,10 @@
  */
 
 #include "angband.h"
+#include "init.h"
 #include "mon-lore.h"
+#include "obj-gear.h"
+#include "player-attack.h"
 #include "ui-mon-lore.h"
 #include "ui-output.h"
 #include "ui-prefs.h"
@@ -75,28 +78,121 @@ void lore_title(textblock *tb, const monster_race *race)
 }
 
 /**
- * Place a full monster recall description (with title) into a textblock, with
- * or without spoilers.
- *
- * \param tb is the textblock we are placing the description into.
- * \param race is the monster race we are describing.
- * \param original_lore is the known information about the monster race.
- * \param spoilers indicates what information is used; `TRUE` will display full
- *        information without subjective information and monster flavor,
- *        while `FALSE` only shows what the player knows.
+ * The last recall made for the player, kept as the monster recall subwindow
+ * asks for it again whenever it is redrawn.  Besides the lore, the text
+ * depends on how the player stands against the race: their level and depth,
+ * their chance to hit it and the colours given to its attacks; the title,
+ * which depends on the visual prefs, is always made afresh.
  */
-void lore_description(textblock *tb, const monster_race *race,
-					  const monster_lore *original_lore, bool spoilers)
+static struct lore_recall {
+	const monster_race *race;
+	monster_lore lore;
+	struct monster_blow *blows;
+	bool *blow_known;
+	bool cheat;
+	byte max_num;
+	s16b lev;
+	s16b max_depth;
+	int hit_chance;
+	int melee_colors[RBE_MAX];
+	int spell_colors[RSF_MAX];
+	textblock *text;
+} recall;
+
+/**
+ * Whatever the recall text depends on, other than the race and its lore
+ */
+static void lore_recall_player(struct lore_recall *r, const int *melee_colors,
+							   const int *spell_colors)
+{
+	r->cheat = OPT(cheat_know);
+	r->lev = player->lev;
+	r->max_depth = player->max_depth;
+	r->hit_chance = py_attack_hit_chance(equipped_item_by_slot_name(player,
+																	"weapon"));
+	memcpy(r->melee_colors, melee_colors, sizeof(r->melee_colors));
+	memcpy(r->spell_colors, spell_colors, sizeof(r->spell_colors));
+}
+
+/**
+ * Whether the last recall made is still right for the race and its lore
+ */
+static bool lore_recall_is_current(const monster_race *race,
+								   const monster_lore *lore,
+								   const int *melee_colors,
+								   const int *spell_colors)
+{
+	struct lore_recall now;
+
+	if (!recall.text || recall.race != race || recall.max_num != race->max_num)
+		return FALSE;
+
+	lore_recall_player(&now, melee_colors, spell_colors);
+	if (now.cheat != recall.cheat || now.lev != recall.lev ||
+			now.max_depth != recall.max_depth ||
+			now.hit_chance != recall.hit_chance ||
+			memcmp(now.melee_colors, recall.melee_colors,
+				   sizeof(now.melee_colors)) ||
+			memcmp(now.spell_colors, recall.spell_colors,
+				   sizeof(now.spell_colors)))
+		return FALSE;
+
+	/* The blows are kept apart from the rest of the lore */
+	return !memcmp(&recall.lore, lore, sizeof(*lore)) &&
+		!memcmp(recall.blows, lore->blows,
+				z_info->mon_blows_max * sizeof(*lore->blows)) &&
+		!memcmp(recall.blow_known, lore->blow_known,
+				z_info->mon_blows_max * sizeof(*lore->blow_known));
+}
+
+/**
+ * Remember the recall just made, in place of the last one
+ */
+static void lore_recall_remember(const monster_race *race,
+								 const monster_lore *lore,
+								 const int *melee_colors,
+								 const int *spell_colors)
+{
+	recall.race = race;
+	recall.max_num = race->max_num;
+	lore_recall_player(&recall, melee_colors, spell_colors);
+
+	memcpy(&recall.lore, lore, sizeof(*lore));
+	if (!recall.blows) {
+		recall.blows = mem_zalloc(z_info->mon_blows_max *
+								  sizeof(*recall.blows));
+		recall.blow_known = mem_zalloc(z_info->mon_blows_max *
+									   sizeof(*recall.blow_known));
+	}
+	memcpy(recall.blows, lore->blows,
+		   z_info->mon_blows_max * sizeof(*lore->blows));
+	memcpy(recall.blow_known, lore->blow_known,
+		   z_info->mon_blows_max * sizeof(*lore->blow_known));
+}
+
+/**
+ * Forget the last recall made
+ */
+void lore_recall_free(void)
+{
+	if (recall.text)
+		textblock_free(recall.text);
+	mem_free(recall.blows);
+	mem_free(recall.blow_known);
+	memset(&recall, 0, sizeof(recall));
+}
+
+/**
+ * Place a monster recall description, less the title, into a textblock.
+ */
+static void lore_append_recall(textblock *tb, const monster_race *race,
+							   const monster_lore *original_lore,
+							   const int *melee_colors,
+							   const int *spell_colors, bool spoilers)
 {
 	monster_lore mutable_lore;
 	monster_lore *lore = &mutable_lore;
 	bitflag known_flags[RF_SIZE];
-	int melee_colors[RBE_MAX], spell_colors[RSF_MAX];
-
-	assert(tb && race && original_lore);
-
-	/* Determine the special attack colors */
-	get_attack_colors(melee_colors, spell_colors);
 
 	/* Hack -- create a copy of the monster-memory that we can modify */
 	memcpy(lore, original_lore, sizeof(monster_lore));
@@ -108,13 +204,6 @@ void lore_description(textblock *tb, const monster_race *race,
 	if (OPT(cheat_know) || spoilers)
 		cheat_monster_lore(race, lore);
 
-	/* Appending the title here simplifies code in the callers. It also causes
-	 * a crash when generating spoilers (we don't need titles for them anwyay)*/
-	if (!spoilers) {
-		lore_title(tb, race);
-		textblock_append(tb, "\n");
-	}
-
 	/* Show kills of monster vs. player(s) */
 	if (!spoilers)
 		lore_append_kills(tb, race, lore, known_flags);
@@ -152,6 +241,51 @@ void lore_description(textblock *tb, const monster_race *race,
 	textblock_append(tb, "\n");
 }
 
+/**
+ * Place a full monster recall description (with title) into a textblock, with
+ * or without spoilers.
+ *
+ * \param tb is the textblock we are placing the description into.
+ * \param race is the monster race we are describing.
+ * \param original_lore is the known information about the monster race.
+ * \param spoilers indicates what information is used; `TRUE` will display full
+ *        information without subjective information and monster flavor,
+ *        while `FALSE` only shows what the player knows.
+ */
+void lore_description(textblock *tb, const monster_race *race,
+					  const monster_lore *original_lore, bool spoilers)
+{
+	int melee_colors[RBE_MAX], spell_colors[RSF_MAX];
+
+	assert(tb && race && original_lore);
+
+	/* Determine the special attack colors */
+	get_attack_colors(melee_colors, spell_colors);
+
+	/* Spoilers are made once and for all, and have no title */
+	if (spoilers) {
+		lore_append_recall(tb, race, original_lore, melee_colors,
+						   spell_colors, TRUE);
+		return;
+	}
+
+	/* Appending the title here simplifies code in the callers */
+	lore_title(tb, race);
+	textblock_append(tb, "\n");
+
+	/* The rest is the same as last time, unless something has changed */
+	if (!lore_recall_is_current(race, original_lore, melee_colors,
+								spell_colors)) {
+		if (recall.text)
+			textblock_free(recall.text);
+		recall.text = textblock_new();
+		lore_append_recall(recall.text, race, original_lore, melee_colors,
+						   spell_colors, FALSE);
+		lore_recall_remember(race, original_lore, melee_colors, spell_colors);
+	}
+	textblock_append_textblock(tb, recall.text);
+}
+
 /**
  * Display monster recall modally and wait for a keypress.
  *
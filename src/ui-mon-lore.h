@@ -23,5 +23,6 @@ void lore_title(textblock *tb, const monster_race *r_ptr);
 void lore_description(textblock *tb, const monster_race *race, const monster_lore *original_lore, bool spoilers);
 void lore_show_interactive(const monster_race *race, const monster_lore *lore);
 void lore_show_subwindow(const monster_race *race, const monster_lore *lore);
+void lore_recall_free(void);
 
 #endif /* UI_MONSTER_LORE_H */
@@ -1668,6 +1668,7 @@ void textui_cmd_ignore_menu(struct object *obj)
 		int type = ignore_type_of(obj);
 
 		ignore_level[type] = value;
+		object_desc_invalidate();
 	}
 
 	player->upkeep->notice |= PN_IGNORE;
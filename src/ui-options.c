@@ -1384,8 +1384,10 @@ static bool quality_action(struct menu *m, const ui_event *event, int oid)
 	evt = menu_select(&menu, 0, TRUE);
 
 	/* Set the new value appropriately */
-	if (evt.type == EVT_SELECT)
+	if (evt.type == EVT_SELECT) {
 		ignore_level[oid] = menu.cursor;
+		object_desc_invalidate();
+	}
 
 	/* Load and finish */
 	screen_load();
@@ -1519,6 +1521,7 @@ static bool ignore_sval_menu_action(struct menu *m, const ui_event *event,
 		else
 			kind->ignore ^= IGNORE_IF_UNAWARE;
 
+		object_desc_invalidate();
 		player->upkeep->notice |= PN_IGNORE;
 		return TRUE;
 	}
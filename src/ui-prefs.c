@@ -18,6 +18,7 @@
  *    are included in all such copies.  Other copyrights may also apply.
  */
 #include "angband.h"
+#include "buildid.h"
 #include "cave.h"
 #include "game-input.h"
 #include "grafmode.h"
@@ -406,6 +407,25 @@ struct prefs_data
 };
 
 
+/**
+ * The most pref files a single visuals load may read before it is no longer
+ * worth caching.
+ */
+#define VISUALS_CACHE_DEPS	64
+
+/**
+ * What a visuals load did while it was being recorded for the cache.
+ */
+static struct {
+	bool recording;
+	bool cacheable;
+	int n_deps;
+	char *deps[VISUALS_CACHE_DEPS];
+	bool exists[VISUALS_CACHE_DEPS];
+	bool gf_set[GF_MAX][BOLT_MAX];
+} visuals_record;
+
+
 /**
  * Load another file.
  */
@@ -765,6 +785,8 @@ static enum parser_error parse_prefs_gf(struct parser *p)
 
 		gf_to_attr[i][motion] = (byte)parser_getuint(p, "attr");
 		gf_to_char[i][motion] = (wchar_t)parser_getuint(p, "char");
+		if (visuals_record.recording)
+			visuals_record.gf_set[i][motion] = TRUE;
 	}
 
 	return PARSE_ERROR_NONE;
@@ -1009,6 +1031,53 @@ static void print_error(const char *name, struct parser *p) {
 	event_signal(EVENT_MESSAGE_FLUSH);
 }
 
+/**
+ * Note that a visuals load being recorded looked for the file at `path`, so
+ * that the cached result goes stale if the file changes, appears or vanishes.
+ */
+static void visuals_record_file(const char *path)
+{
+	int i;
+
+	if (!visuals_record.recording) return;
+
+	for (i = 0; i < visuals_record.n_deps; i++)
+		if (streq(visuals_record.deps[i], path))
+			return;
+
+	if (visuals_record.n_deps == VISUALS_CACHE_DEPS) {
+		visuals_record.cacheable = FALSE;
+		return;
+	}
+
+	visuals_record.deps[i] = string_make(path);
+	visuals_record.exists[i] = file_exists(path);
+	visuals_record.n_deps++;
+}
+
+/**
+ * Check whether a pref line only sets visuals or controls which lines are
+ * read.  Anything else (keymaps, colours, windows...) can't be replayed from
+ * the visuals cache.
+ */
+static bool visuals_record_line(const char *line)
+{
+	static const char *directives[] = {
+		"%", "?", "object", "monster", "feat", "trap", "GF", "flavor"
+	};
+	size_t i, n;
+
+	while (isspace((unsigned char)*line)) line++;
+	if (!*line || *line == '#') return TRUE;
+
+	n = strcspn(line, ":");
+	for (i = 0; i < N_ELEMENTS(directives); i++)
+		if (strlen(directives[i]) == n && !strncmp(line, directives[i], n))
+			return TRUE;
+
+	return FALSE;
+}
+
 /**
  * Process the user pref file with a given name and search paths.
  *
@@ -1040,12 +1109,14 @@ static bool process_pref_file_layered(const char *name, bool quiet, bool user,
 
 	/* Build the filename */
 	path_build(buf, sizeof(buf), base_search_path, name);
+	visuals_record_file(buf);
 
 	if (used_fallback != NULL)
 		*used_fallback = FALSE;
 
 	if (!file_exists(buf) && fallback_search_path != NULL) {
 		path_build(buf, sizeof(buf), fallback_search_path, name);
+		visuals_record_file(buf);
 
 		if (used_fallback != NULL)
 			*used_fallback = TRUE;
@@ -1067,8 +1138,12 @@ static bool process_pref_file_layered(const char *name, bool quiet, bool user,
 			e = parser_parse(p, line);
 			if (e != PARSE_ERROR_NONE) {
 				print_error(buf, p);
+				visuals_record.cacheable = FALSE;
 				break;
 			}
+
+			if (visuals_record.recording && !visuals_record_line(line))
+				visuals_record.cacheable = FALSE;
 		}
 		finish_parse_prefs(p);
 
@@ -1126,6 +1201,300 @@ bool process_pref_file(const char *name, bool quiet, bool user)
 	return root_success || user_success;
 }
 
+/**
+ * ------------------------------------------------------------------------
+ * Compiled visuals cache
+ *
+ * Tile pref files run to thousands of lines, so the tables that
+ * reset_visuals() builds from them are kept in user/<pref>.cache.  The cache
+ * starts with a key describing everything that can change what the pref
+ * files mean (the build, the $SYS/$RACE/$CLASS/$PLAYER values they may test,
+ * and the sizes of the tables), then lists every file that was looked for,
+ * then holds the tables.  It is only used if it is newer than all of those
+ * files and none of them has appeared or vanished since.
+ * ------------------------------------------------------------------------ */
+
+#define VISUALS_CACHE_MAGIC	0x41564331	/* "AVC1" */
+
+/**
+ * Game data files which supply the default visuals and the names used by
+ * the pref files.
+ */
+static const char *visuals_edit_files[] = {
+	"flavor.txt", "monster.txt", "monster_base.txt", "object.txt",
+	"object_base.txt", "terrain.txt", "trap.txt"
+};
+
+/**
+ * A growable byte buffer for building cache files.
+ */
+struct visuals_blob {
+	char *data;
+	size_t len;
+	size_t size;
+};
+
+static void blob_put(struct visuals_blob *b, const void *data, size_t n)
+{
+	if (b->len + n > b->size) {
+		while (b->len + n > b->size)
+			b->size = b->size ? b->size * 2 : 1024;
+		b->data = mem_realloc(b->data, b->size);
+	}
+
+	memcpy(b->data + b->len, data, n);
+	b->len += n;
+}
+
+static void blob_put_u32(struct visuals_blob *b, u32b v)
+{
+	blob_put(b, &v, sizeof v);
+}
+
+static void blob_put_str(struct visuals_blob *b, const char *s)
+{
+	blob_put_u32(b, strlen(s));
+	blob_put(b, s, strlen(s));
+}
+
+/**
+ * Take `n` bytes from a cache file being read, or return NULL if it is short.
+ */
+static const char *blob_get(const char **data, size_t *left, size_t n)
+{
+	const char *r = *data;
+
+	if (*left < n) return NULL;
+	*data += n;
+	*left -= n;
+
+	return r;
+}
+
+/**
+ * Build the name of the cache for the pref file `name`.
+ */
+static void visuals_cache_path(char *buf, size_t len, const char *name)
+{
+	char fname[128];
+
+	strnfmt(fname, sizeof(fname), "%s.cache", name);
+	path_build(buf, len, ANGBAND_DIR_USER, fname);
+}
+
+/**
+ * Build the key that a cache of the visuals from `name` must match.
+ */
+static void visuals_cache_key(struct visuals_blob *b, const char *name)
+{
+	blob_put_u32(b, VISUALS_CACHE_MAGIC);
+	blob_put_str(b, buildid);
+	blob_put_str(b, name);
+	blob_put_str(b, ANGBAND_SYS);
+	blob_put_str(b, player->race ? player->race->name : "");
+	blob_put_str(b, player->class ? player->class->name : "");
+	blob_put_str(b, player_safe_name(player, TRUE));
+	blob_put_u32(b, sizeof(wchar_t));
+	blob_put_u32(b, LIGHTING_MAX);
+	blob_put_u32(b, GF_MAX);
+	blob_put_u32(b, BOLT_MAX);
+	blob_put_u32(b, z_info->r_max);
+	blob_put_u32(b, z_info->k_max);
+	blob_put_u32(b, z_info->f_max);
+	blob_put_u32(b, z_info->trap_max);
+	blob_put_u32(b, flavor_max);
+}
+
+/**
+ * The size of the tables held in a cache.
+ */
+static size_t visuals_cache_table_size(void)
+{
+	size_t glyph = sizeof(byte) + sizeof(wchar_t);
+
+	return glyph * (z_info->r_max + z_info->k_max + flavor_max + 1 +
+					LIGHTING_MAX * (z_info->f_max + z_info->trap_max)) +
+		(sizeof(bool) + glyph) * GF_MAX * BOLT_MAX;
+}
+
+/**
+ * Try to fill the visual tables from the cache of the pref file `name`.
+ *
+ * Returns TRUE if the cache was current and has been used.
+ */
+static bool visuals_cache_load(const char *name)
+{
+	char path[1024];
+	struct visuals_blob key = { NULL, 0, 0 };
+	ang_map *map;
+	const char *data;
+	size_t left;
+	const char *s;
+	u32b i, j, n;
+	bool ok = FALSE;
+
+	visuals_cache_path(path, sizeof(path), name);
+	map = file_map(path);
+	if (!map) return FALSE;
+	data = file_map_data(map, &left);
+
+	/* The key must match exactly */
+	visuals_cache_key(&key, name);
+	s = blob_get(&data, &left, key.len);
+	if (!s || memcmp(s, key.data, key.len)) goto out;
+
+	/* Every file must be as it was, and older than the cache */
+	if (!(s = blob_get(&data, &left, sizeof n))) goto out;
+	memcpy(&n, s, sizeof n);
+	for (i = 0; i < n; i++) {
+		char dep[1024];
+		u32b len;
+		bool exists;
+
+		if (!(s = blob_get(&data, &left, sizeof len))) goto out;
+		memcpy(&len, s, sizeof len);
+		if (len >= sizeof(dep)) goto out;
+		if (!(s = blob_get(&data, &left, len + 1))) goto out;
+		memcpy(dep, s, len);
+		dep[len] = '\0';
+
+		exists = file_exists(dep);
+		if (exists != (s[len] != 0)) goto out;
+		if (exists && !file_newer(path, dep)) goto out;
+	}
+
+	/* Then the tables */
+	if (left != visuals_cache_table_size()) goto out;
+
+#define GET_TABLE(table, count) \
+	memcpy(table, blob_get(&data, &left, (count) * sizeof(*(table))), \
+		(count) * sizeof(*(table)))
+
+	GET_TABLE(monster_x_attr, z_info->r_max);
+	GET_TABLE(monster_x_char, z_info->r_max);
+	GET_TABLE(kind_x_attr, z_info->k_max);
+	GET_TABLE(kind_x_char, z_info->k_max);
+	for (i = 0; i < LIGHTING_MAX; i++) {
+		GET_TABLE(feat_x_attr[i], z_info->f_max);
+		GET_TABLE(feat_x_char[i], z_info->f_max);
+		GET_TABLE(trap_x_attr[i], z_info->trap_max);
+		GET_TABLE(trap_x_char[i], z_info->trap_max);
+	}
+	GET_TABLE(flavor_x_attr, flavor_max + 1);
+	GET_TABLE(flavor_x_char, flavor_max + 1);
+
+#undef GET_TABLE
+
+	/* Projection glyphs are only changed where the pref files set them */
+	for (i = 0; i < GF_MAX; i++) {
+		for (j = 0; j < BOLT_MAX; j++) {
+			bool set;
+
+			memcpy(&set, blob_get(&data, &left, sizeof set), sizeof set);
+			s = blob_get(&data, &left, sizeof(byte) + sizeof(wchar_t));
+			if (!set) continue;
+
+			gf_to_attr[i][j] = (byte)s[0];
+			memcpy(&gf_to_char[i][j], s + 1, sizeof(wchar_t));
+		}
+	}
+
+	ok = TRUE;
+
+out:
+	mem_free(key.data);
+	file_unmap(map);
+	return ok;
+}
+
+/**
+ * Start recording a visuals load.
+ */
+static void visuals_cache_begin(void)
+{
+	size_t i;
+
+	memset(&visuals_record, 0, sizeof visuals_record);
+	visuals_record.recording = TRUE;
+	visuals_record.cacheable = TRUE;
+
+	for (i = 0; i < N_ELEMENTS(visuals_edit_files); i++) {
+		char path[1024];
+
+		path_build(path, sizeof(path), ANGBAND_DIR_EDIT,
+				   visuals_edit_files[i]);
+		visuals_record_file(path);
+	}
+}
+
+/**
+ * Stop recording a visuals load from the pref file `name`, and write the
+ * cache if everything the load did can be replayed from it.
+ */
+static void visuals_cache_end(const char *name)
+{
+	char path[1024];
+	struct visuals_blob b = { NULL, 0, 0 };
+	ang_file *f;
+	int i, j;
+
+	visuals_record.recording = FALSE;
+	if (!visuals_record.cacheable) goto out;
+
+	visuals_cache_key(&b, name);
+
+	blob_put_u32(&b, visuals_record.n_deps);
+	for (i = 0; i < visuals_record.n_deps; i++) {
+		byte exists = visuals_record.exists[i] ? 1 : 0;
+
+		blob_put_str(&b, visuals_record.deps[i]);
+		blob_put(&b, &exists, 1);
+	}
+
+#define PUT_TABLE(table, count) \
+	blob_put(&b, table, (count) * sizeof(*(table)))
+
+	PUT_TABLE(monster_x_attr, z_info->r_max);
+	PUT_TABLE(monster_x_char, z_info->r_max);
+	PUT_TABLE(kind_x_attr, z_info->k_max);
+	PUT_TABLE(kind_x_char, z_info->k_max);
+	for (i = 0; i < LIGHTING_MAX; i++) {
+		PUT_TABLE(feat_x_attr[i], z_info->f_max);
+		PUT_TABLE(feat_x_char[i], z_info->f_max);
+		PUT_TABLE(trap_x_attr[i], z_info->trap_max);
+		PUT_TABLE(trap_x_char[i], z_info->trap_max);
+	}
+	PUT_TABLE(flavor_x_attr, flavor_max + 1);
+	PUT_TABLE(flavor_x_char, flavor_max + 1);
+
+#undef PUT_TABLE
+
+	for (i = 0; i < GF_MAX; i++) {
+		for (j = 0; j < BOLT_MAX; j++) {
+			blob_put(&b, &visuals_record.gf_set[i][j], sizeof(bool));
+			blob_put(&b, &gf_to_attr[i][j], sizeof(byte));
+			blob_put(&b, &gf_to_char[i][j], sizeof(wchar_t));
+		}
+	}
+
+	/* Failing to write the cache only costs a parse next time */
+	visuals_cache_path(path, sizeof(path), name);
+	f = file_open(path, MODE_WRITE, FTYPE_RAW);
+	if (f) {
+		bool written = file_write(f, b.data, b.len);
+
+		file_close(f);
+		if (!written)
+			file_delete(path);
+	}
+
+out:
+	for (i = 0; i < visuals_record.n_deps; i++)
+		string_free(visuals_record.deps[i]);
+	visuals_record.n_deps = 0;
+	mem_free(b.data);
+}
+
 /**
  * Reset the "visual" lists
  *
@@ -1139,6 +1508,7 @@ void reset_visuals(bool load_prefs)
 {
 	int i, j;
 	struct flavor *f;
+	const char *name;
 
 	/* Extract default attr/char code for features */
 	for (i = 0; i < z_info->f_max; i++) {
@@ -1195,11 +1565,19 @@ void reset_visuals(bool load_prefs)
 		graphics_mode *mode = get_graphics_mode(use_graphics);
 		assert(mode);
 
-		(void)process_pref_file(mode->pref, FALSE, FALSE);
+		name = mode->pref;
 	} else {
 		/* Normal symbols */
-		process_pref_file("font.prf", FALSE, FALSE);
+		name = "font.prf";
 	}
+
+	/* Use the compiled tables if they are still current */
+	if (visuals_cache_load(name))
+		return;
+
+	visuals_cache_begin();
+	(void)process_pref_file(name, FALSE, FALSE);
+	visuals_cache_end(name);
 }
 
 /**
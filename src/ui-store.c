@@ -18,6 +18,7 @@
  */
 #include "angband.h"
 #include "cave.h"
+#include "cmd-record.h"
 #include "cmds.h"
 #include "game-event.h"
 #include "game-input.h"
@@ -121,8 +122,10 @@ static const char *random_hint(void)
 {
 	struct hint *v, *r = NULL;
 	int n;
+
+	init_hints();
 	for (v = hints, n = 1; v; v = v->next, n++)
-		if (one_in_(n))
+		if (!Rand_simple(n))
 			r = v;
 	return r->hint;
 }
@@ -140,7 +143,7 @@ static void prt_welcome(const struct owner *proprietor)
 
 	int j;
 
-	if (one_in_(2))
+	if (!Rand_simple(2))
 		return;
 
 	/* Get the first name of the store owner (stop before the first space) */
@@ -150,8 +153,8 @@ static void prt_welcome(const struct owner *proprietor)
 	/* Truncate the name */
 	short_name[j] = '\0';
 
-	if (one_in_(3)) {
-		size_t i = randint0(N_ELEMENTS(comment_hint));
+	if (!Rand_simple(3)) {
+		size_t i = Rand_simple(N_ELEMENTS(comment_hint));
 		msg(comment_hint[i], random_hint());
 	} else if (player->lev > 5) {
 		const char *player_name;
@@ -161,9 +164,9 @@ static void prt_welcome(const struct owner *proprietor)
 		i = MIN(i, N_ELEMENTS(comment_welcome) - 1);
 
 		/* Get a title for the character */
-		if ((i % 2) && randint0(2))
+		if ((i % 2) && Rand_simple(2))
 			player_name = player->class->title[(player->lev - 1) / 5];
-		else if (randint0(2))
+		else if (Rand_simple(2))
 			player_name = op_ptr->full_name;
 		else
 			player_name = "valued customer";
@@ -1172,10 +1175,14 @@ void use_store(game_event_type type, game_event_data *data, void *user)
 {
 	struct store *store = store_at(cave, player->py, player->px);
 	struct store_context ctx;
+	int depth;
 
 	/* Check that we're on a store */
 	if (!store) return;
 
+	/* Anything asked from here on is for the store's own screen */
+	depth = cmd_record_ui_enter();
+
 	/* Forget the view */
 	forget_view(cave);
 
@@ -1209,6 +1216,8 @@ void use_store(game_event_type type, game_event_data *data, void *user)
 
 	/* Load the screen */
 	screen_load();
+
+	cmd_record_ui_leave(depth);
 }
 
 void leave_store(game_event_type type, game_event_data *data, void *user)
@@ -19,6 +19,7 @@
 #include "h-basic.h"
 #include "ui-term.h"
 #include "z-color.h"
+#include "z-trace.h"
 #include "z-util.h"
 #include "z-virt.h"
 
@@ -195,6 +196,7 @@
  *   Term->wipe_hook = Draw some blank spaces
  *   Term->text_hook = Draw some text in the window
  *   Term->pict_hook = Draw some attr/chars in the window
+ *   Term->batch_hook = Draw every changed grid of a refresh
  *
  * The "Term->xtra_hook" hook provides a variety of different functions,
  * based on the first parameter (which should be taken from the various
@@ -237,6 +239,14 @@
  * the terrain values as a background and the "ap", "cp" values in
  * the foreground.
  *
+ * The "Term->batch_hook" hook, if set, replaces the three drawing hooks
+ * above during "Term_fresh()".  It is called once per refresh with every
+ * changed grid, in row order, as "term_cell" records giving the position,
+ * the attr/char pair and the terrain attr/char pair.  The frontend decides
+ * how to draw each one (text, blank or tile), so it can fill backgrounds,
+ * blit tiles and update its surface in a single pass.  The array belongs
+ * to the term and is only valid during the call.
+ *
  * The game "Angband" uses a set of files called "main-xxx.c", for
  * various "xxx" suffixes.  Most of these contain a function called
  * "init_xxx()", that will prepare the underlying visual system for
@@ -290,6 +300,19 @@ char angband_term_name[ANGBAND_TERM_MAX][16] =
 
 u32b window_flag[ANGBAND_TERM_MAX];
 
+/**
+ * The most times per second "Term_fresh_paced()" lets a window reach the
+ * screen, or 0 for no limit
+ */
+int term_frame_rate = 30;
+
+/**
+ * Whether a frame is being held back in the front end, and whether anything
+ * has been flushed into it (see "Term_frame()")
+ */
+static bool term_frame_held = FALSE;
+static bool term_frame_pending = FALSE;
+
 
 
 
@@ -414,6 +437,239 @@ static errr term_win_copy(term_win *s, term_win *f, int w, int h)
 }
 
 
+/**
+ * Make an empty "term_layer" for a window of the given height
+ */
+static term_layer *term_layer_new(int h)
+{
+	term_layer *layer = mem_zalloc(sizeof(term_layer));
+	int y;
+
+	layer->x1 = mem_zalloc(h * sizeof(int));
+	layer->x2 = mem_zalloc(h * sizeof(int));
+
+	layer->a = mem_zalloc(h * sizeof(int*));
+	layer->c = mem_zalloc(h * sizeof(wchar_t*));
+	layer->ta = mem_zalloc(h * sizeof(int*));
+	layer->tc = mem_zalloc(h * sizeof(wchar_t*));
+
+	/* Nothing kept yet */
+	for (y = 0; y < h; y++) {
+		layer->x1[y] = 1;
+		layer->x2[y] = 0;
+	}
+
+	return layer;
+}
+
+
+/**
+ * Free one row of a "term_layer"
+ */
+static void term_layer_free_row(term_layer *layer, int y)
+{
+	mem_free(layer->a[y]);
+	mem_free(layer->c[y]);
+	mem_free(layer->ta[y]);
+	mem_free(layer->tc[y]);
+
+	layer->a[y] = NULL;
+	layer->c[y] = NULL;
+	layer->ta[y] = NULL;
+	layer->tc[y] = NULL;
+}
+
+
+/**
+ * Free a "term_layer" of a window of the given height
+ */
+static void term_layer_free(term_layer *layer, int h)
+{
+	int y;
+
+	for (y = 0; y < h; y++)
+		term_layer_free_row(layer, y);
+
+	mem_free(layer->x1);
+	mem_free(layer->x2);
+	mem_free(layer->a);
+	mem_free(layer->c);
+	mem_free(layer->ta);
+	mem_free(layer->tc);
+	mem_free(layer);
+}
+
+
+/**
+ * Copy columns "x1" to "x2" of row "y" of a window into a "term_layer"
+ */
+static void term_layer_copy(term_layer *layer, const term_win *s, int y,
+							int x1, int x2)
+{
+	int n = x2 - x1 + 1;
+
+	if (n <= 0) return;
+
+	memcpy(layer->a[y] + x1, s->a[y] + x1, n * sizeof(int));
+	memcpy(layer->c[y] + x1, s->c[y] + x1, n * sizeof(wchar_t));
+	memcpy(layer->ta[y] + x1, s->ta[y] + x1, n * sizeof(int));
+	memcpy(layer->tc[y] + x1, s->tc[y] + x1, n * sizeof(wchar_t));
+}
+
+
+/**
+ * Keep columns "x1" to "x2" of row "y" in the newest saved layer, if any,
+ * before they are drawn over.
+ *
+ * Grids between those already kept and the new ones have not been drawn
+ * since the save, so they are kept along with them.
+ */
+static void term_layer_keep(term *t, int y, int x1, int x2)
+{
+	term_layer *layer = t->mem;
+	int kx1, kx2;
+
+	if (!layer) return;
+
+	kx1 = layer->x1[y];
+	kx2 = layer->x2[y];
+
+	/* Already kept */
+	if ((kx1 <= x1) && (x2 <= kx2)) return;
+
+	/* First grids of this row */
+	if (!layer->a[y]) {
+		layer->a[y] = mem_alloc(t->wid * sizeof(int));
+		layer->c[y] = mem_alloc(t->wid * sizeof(wchar_t));
+		layer->ta[y] = mem_alloc(t->wid * sizeof(int));
+		layer->tc[y] = mem_alloc(t->wid * sizeof(wchar_t));
+	}
+
+	if (kx1 > kx2) {
+		term_layer_copy(layer, t->scr, y, x1, x2);
+		layer->x1[y] = x1;
+		layer->x2[y] = x2;
+		return;
+	}
+
+	if (x1 < kx1) {
+		term_layer_copy(layer, t->scr, y, x1, kx1 - 1);
+		layer->x1[y] = x1;
+	}
+	if (x2 > kx2) {
+		term_layer_copy(layer, t->scr, y, kx2 + 1, x2);
+		layer->x2[y] = x2;
+	}
+}
+
+
+/**
+ * Find the screen as it was when "layer" was saved, at one grid that "layer"
+ * did not keep: that is the grid as kept by the nearest newer layer, or as
+ * the screen has it now.
+ */
+static void term_layer_peek(const term *t, const term_layer *layer, int x,
+							int y, int *a, wchar_t *c, int *ta, wchar_t *tc)
+{
+	const term_layer *newer, *found = NULL;
+
+	for (newer = t->mem; newer != layer; newer = newer->next)
+		if ((newer->x1[y] <= x) && (x <= newer->x2[y])) found = newer;
+
+	if (found) {
+		*a = found->a[y][x];
+		*c = found->c[y][x];
+		*ta = found->ta[y][x];
+		*tc = found->tc[y][x];
+	} else {
+		*a = t->scr->a[y][x];
+		*c = t->scr->c[y][x];
+		*ta = t->scr->ta[y][x];
+		*tc = t->scr->tc[y][x];
+	}
+}
+
+
+/**
+ * Fit a "term_layer" to a new window size, before the window itself changes.
+ *
+ * Grids added by the resize start out zeroed in the new screen, so each layer
+ * keeps them that way; loading it then leaves them as they were just after
+ * the resize, as if the whole screen had been saved.
+ */
+static void term_layer_resize(term *t, term_layer *layer, int w, int h)
+{
+	int old_w = t->wid, old_h = t->hgt;
+	int x, y;
+
+	/* Rows that go away */
+	for (y = h; y < old_h; y++)
+		term_layer_free_row(layer, y);
+
+	layer->x1 = mem_realloc(layer->x1, h * sizeof(int));
+	layer->x2 = mem_realloc(layer->x2, h * sizeof(int));
+	layer->a = mem_realloc(layer->a, h * sizeof(int*));
+	layer->c = mem_realloc(layer->c, h * sizeof(wchar_t*));
+	layer->ta = mem_realloc(layer->ta, h * sizeof(int*));
+	layer->tc = mem_realloc(layer->tc, h * sizeof(wchar_t*));
+
+	for (y = 0; y < h; y++) {
+		int x1 = (y < old_h) ? layer->x1[y] : 1;
+		int x2 = (y < old_h) ? layer->x2[y] : 0;
+		int keep_from = (y < old_h) ? old_w : 0;
+
+		if (y >= old_h) {
+			layer->a[y] = NULL;
+			layer->c[y] = NULL;
+			layer->ta[y] = NULL;
+			layer->tc[y] = NULL;
+		}
+
+		/* Narrower: drop the columns that go away */
+		if (w <= keep_from) {
+			if (x2 >= w) x2 = w - 1;
+			if (x1 > x2) {
+				term_layer_free_row(layer, y);
+				x1 = 1;
+				x2 = 0;
+			} else {
+				layer->a[y] = mem_realloc(layer->a[y], w * sizeof(int));
+				layer->c[y] = mem_realloc(layer->c[y], w * sizeof(wchar_t));
+				layer->ta[y] = mem_realloc(layer->ta[y], w * sizeof(int));
+				layer->tc[y] = mem_realloc(layer->tc[y], w * sizeof(wchar_t));
+			}
+
+			layer->x1[y] = x1;
+			layer->x2[y] = x2;
+			continue;
+		}
+
+		/* Wider: keep the new columns, and any gap up to them */
+		layer->a[y] = mem_realloc(layer->a[y], w * sizeof(int));
+		layer->c[y] = mem_realloc(layer->c[y], w * sizeof(wchar_t));
+		layer->ta[y] = mem_realloc(layer->ta[y], w * sizeof(int));
+		layer->tc[y] = mem_realloc(layer->tc[y], w * sizeof(wchar_t));
+
+		if (x1 > x2) {
+			x1 = keep_from;
+			x2 = keep_from - 1;
+		}
+		for (x = x2 + 1; x < keep_from; x++)
+			term_layer_peek(t, layer, x, y, &layer->a[y][x], &layer->c[y][x],
+							&layer->ta[y][x], &layer->tc[y][x]);
+		for (x = keep_from; x < w; x++) {
+			layer->a[y][x] = 0;
+			layer->c[y][x] = 0;
+			layer->ta[y][x] = 0;
+			layer->tc[y][x] = 0;
+		}
+
+		layer->x1[y] = MIN(x1, keep_from);
+		layer->x2[y] = w - 1;
+	}
+}
+
+
 
 /**
  * ------------------------------------------------------------------------
@@ -429,6 +685,12 @@ errr Term_xtra(int n, int v)
 	/* Verify the hook */
 	if (!Term->xtra_hook) return (-1);
 
+	/* Show any frame being held before waiting on the player or the clock,
+	 * or before the front end is suspended */
+	if (term_frame_pending && ((n == TERM_XTRA_EVENT && v) ||
+							   n == TERM_XTRA_DELAY || n == TERM_XTRA_ALIVE))
+		Term_frame();
+
 	/* Call the hook */
 	return ((*Term->xtra_hook)(n, v));
 }
@@ -524,6 +786,9 @@ void Term_queue_char(term *t, int x, int y, int a, wchar_t c, int ta,
 	/* Hack -- Ignore non-changes */
 	if ((oa == a) && (oc == c) && (ota == ta) && (otc == tc)) return;
 
+	/* Keep what a saved screen had here */
+	term_layer_keep(t, y, x, x);
+
 	/* Save the "literal" information */
 	scr_aa[x] = a;
 	scr_cc[x] = c;
@@ -621,6 +886,9 @@ void Term_queue_chars(int x, int y, int n, int a, const wchar_t *s)
 		/* Hack -- Ignore non-changes */
 		if ((oa == a) && (oc == *s) && (ota == 0) && (otc == 0)) continue;
 
+		/* Keep what a saved screen had here */
+		term_layer_keep(Term, y, x, x);
+
 		/* Save the "literal" information */
 		scr_aa[x] = a;
 		scr_cc[x] = *s;
@@ -653,6 +921,39 @@ void Term_queue_chars(int x, int y, int n, int a, const wchar_t *s)
  * ------------------------------------------------------------------------ */
 
 
+/**
+ * Find the first column from `x` to `x2` at which the old and new contents of
+ * row `y` differ, or `x2 + 1` if there is none.  Unchanged stretches are
+ * passed over a block at a time with memcmp(); the terrain layer is compared
+ * too when `tiles` is set.
+ */
+#define ROW_BLOCK 16
+static int Term_row_mismatch(int y, int x, int x2, bool tiles)
+{
+	const int *old_aa = Term->old->a[y], *scr_aa = Term->scr->a[y];
+	const wchar_t *old_cc = Term->old->c[y], *scr_cc = Term->scr->c[y];
+	const int *old_taa = Term->old->ta[y], *scr_taa = Term->scr->ta[y];
+	const wchar_t *old_tcc = Term->old->tc[y], *scr_tcc = Term->scr->tc[y];
+
+	for (; x + ROW_BLOCK - 1 <= x2; x += ROW_BLOCK) {
+		if (memcmp(old_aa + x, scr_aa + x, ROW_BLOCK * sizeof(*old_aa)) ||
+			memcmp(old_cc + x, scr_cc + x, ROW_BLOCK * sizeof(*old_cc)))
+			break;
+		if (tiles &&
+			(memcmp(old_taa + x, scr_taa + x, ROW_BLOCK * sizeof(*old_taa)) ||
+			 memcmp(old_tcc + x, scr_tcc + x, ROW_BLOCK * sizeof(*old_tcc))))
+			break;
+	}
+
+	for (; x <= x2; x++) {
+		if (old_aa[x] != scr_aa[x] || old_cc[x] != scr_cc[x]) break;
+		if (tiles && (old_taa[x] != scr_taa[x] || old_tcc[x] != scr_tcc[x]))
+			break;
+	}
+
+	return x;
+}
+
 /**
  * Flush a row of the current window (see "Term_fresh")
  *
@@ -694,6 +995,12 @@ static void Term_fresh_row_pict(int y, int x1, int x2)
 
 	/* Scan "modified" columns */
 	for (x = x1; x <= x2; x++) {
+		/* Jump over unchanged columns while nothing is pending */
+		if (!fn) {
+			x = Term_row_mismatch(y, x, x2, TRUE);
+			if (x > x2) break;
+		}
+
 		/* See what is currently here */
 		oa = old_aa[x];
 		oc = old_cc[x];
@@ -790,6 +1097,12 @@ static void Term_fresh_row_both(int y, int x1, int x2)
 
 	/* Scan "modified" columns */
 	for (x = x1; x <= x2; x++) {
+		/* Jump over unchanged columns while nothing is pending */
+		if (!fn) {
+			x = Term_row_mismatch(y, x, x2, TRUE);
+			if (x > x2) break;
+		}
+
 		/* See what is currently here */
 		oa = old_aa[x];
 		oc = old_cc[x];
@@ -885,6 +1198,48 @@ static void Term_fresh_row_both(int y, int x1, int x2)
 }
 
 
+/**
+ * Gather the changed cells of a row for "Term->batch_hook" (see "Term_fresh")
+ *
+ * The second halves of big tiles are noted as drawn but not passed on.
+ */
+static int Term_fresh_row_batch(int y, int x1, int x2, int n)
+{
+	int x;
+
+	for (x = x1; x <= x2; x++) {
+		term_cell *cell;
+
+		x = Term_row_mismatch(y, x, x2, TRUE);
+		if (x > x2) break;
+
+		/* Save new contents */
+		Term->old->a[y][x] = Term->scr->a[y][x];
+		Term->old->c[y][x] = Term->scr->c[y][x];
+		Term->old->ta[y][x] = Term->scr->ta[y][x];
+		Term->old->tc[y][x] = Term->scr->tc[y][x];
+
+		/* 2nd byte of bigtile */
+		if (Term->scr->a[y][x] == 255) continue;
+
+		if (n == Term->batch_max) {
+			Term->batch_max = Term->batch_max ? Term->batch_max * 2 : 256;
+			Term->batch = mem_realloc(Term->batch,
+					Term->batch_max * sizeof(*Term->batch));
+		}
+
+		cell = &Term->batch[n++];
+		cell->x = x;
+		cell->y = y;
+		cell->a = Term->scr->a[y][x];
+		cell->c = Term->scr->c[y][x];
+		cell->ta = Term->scr->ta[y][x];
+		cell->tc = Term->scr->tc[y][x];
+	}
+
+	return n;
+}
+
 /**
  * Flush a row of the current window (see "Term_fresh")
  *
@@ -921,6 +1276,12 @@ static void Term_fresh_row_text(int y, int x1, int x2)
 
 	/* Scan "modified" columns */
 	for (x = x1; x <= x2; x++) {
+		/* Jump over unchanged columns while nothing is pending */
+		if (!fn) {
+			x = Term_row_mismatch(y, x, x2, FALSE);
+			if (x > x2) break;
+		}
+
 		/* See what is currently here */
 		oa = old_aa[x];
 		oc = old_cc[x];
@@ -1159,6 +1520,8 @@ errr Term_fresh(void)
 	}
 
 
+	TRACE_BEGIN("Term_fresh");
+
 	/* Paranoia -- use "fake" hooks to prevent core dumps */
 	if (!Term->curs_hook) Term->curs_hook = Term_curs_hack;
 	if (!Term->bigcurs_hook) Term->bigcurs_hook = Term->curs_hook;
@@ -1250,6 +1613,9 @@ errr Term_fresh(void)
 
 	/* Something to update */
 	if (y1 <= y2) {
+		/* Number of cells gathered for the batch hook */
+		int batched = 0;
+
 		/* Handle "icky corner" */
 		if ((Term->icky_corner) && (y2 >= h - 1) && (Term->x2[h - 1] > w - 2))
 			Term->x2[h - 1] = w - 2;
@@ -1262,8 +1628,10 @@ errr Term_fresh(void)
 
 			/* Flush each "modified" row */
 			if (x1 <= x2) {
-				/* Use "Term_pict()" - always, sometimes or never */
-				if (Term->always_pict)
+				/* Gather changes for a single call, or draw them now */
+				if (Term->batch_hook)
+					batched = Term_fresh_row_batch(y, x1, x2, batched);
+				else if (Term->always_pict)
 					/* Flush the row */
 					Term_fresh_row_pict(y, x1, x2);
 				else if (Term->higher_pict)
@@ -1278,10 +1646,15 @@ errr Term_fresh(void)
 				Term->x2[y] = 0;
 
 				/* Hack -- Flush that row (if allowed) */
-				if (!Term->never_frosh) Term_xtra(TERM_XTRA_FROSH, y);
+				if (!Term->never_frosh && !Term->batch_hook)
+					Term_xtra(TERM_XTRA_FROSH, y);
 			}
 		}
 
+		/* Draw everything that changed in one go */
+		if (batched)
+			(void)((*Term->batch_hook)(Term->batch, batched));
+
 		/* No rows are invalid */
 		Term->y1 = h;
 		Term->y2 = 0;
@@ -1326,11 +1699,73 @@ errr Term_fresh(void)
 	/* Actually flush the output */
 	Term_xtra(TERM_XTRA_FRESH, 0);
 
+	/* Show it now, or with the rest of the frame */
+	if (term_frame_held)
+		term_frame_pending = TRUE;
+	else
+		Term_xtra(TERM_XTRA_FRAME, 0);
+
+	/* Remember when, for "Term_fresh_paced()" */
+	Term->fresh_clock = clock();
+
+	TRACE_END("Term_fresh");
+
 	/* Success */
 	return (0);
 }
 
 
+/**
+ * Refresh the current window, unless it already reached the screen within
+ * the last frame at "term_frame_rate" frames per second.
+ *
+ * This is meant for the stream of refreshes made while the game runs on by
+ * itself (running, resting, repeated commands), most of which nobody could
+ * ever see.  Changes held back stay queued, so the next refresh that does go
+ * through (paced or not) shows all of them.  Anything that waits on the
+ * player must use "Term_fresh()" itself; "inkey_ex()" already does.
+ *
+ * The time is taken from "clock()", which is processor time on some systems;
+ * that is fine here, since pacing only matters while the game is busy.
+ */
+errr Term_fresh_paced(void)
+{
+	if (term_frame_rate > 0) {
+		clock_t frame = CLOCKS_PER_SEC / term_frame_rate;
+
+		if (clock() - Term->fresh_clock < frame) return (1);
+	}
+
+	return (Term_fresh());
+}
+
+/**
+ * Hold back what "Term_fresh()" flushes, in every window, until the next
+ * "Term_frame()", or stop doing so.
+ *
+ * Front ends that flush each window by itself (curses, over a slow link)
+ * can then send all the windows changed in a game turn as one update.  A
+ * held frame is always shown before waiting for a key or a delay, so
+ * nothing is left off the screen while the player looks at it.
+ */
+void Term_frame_hold(bool hold)
+{
+	term_frame_held = hold;
+	if (!hold) Term_frame();
+}
+
+/**
+ * Show everything flushed since the last frame at once, if anything was
+ */
+errr Term_frame(void)
+{
+	if (!term_frame_pending) return (1);
+	term_frame_pending = FALSE;
+
+	return (Term_xtra(TERM_XTRA_FRAME, 0));
+}
+
+
 
 /**
  * ------------------------------------------------------------------------
@@ -1633,6 +2068,9 @@ errr Term_erase(int x, int y, int n)
 		/* Hack -- Ignore "non-changes" */
 		if ((oa == na) && (oc == nc)) continue;
 
+		/* Keep what a saved screen had here */
+		term_layer_keep(Term, y, x, x);
+
 		/* Save the "literal" information */
 		scr_aa[x] = na;
 		scr_cc[x] = nc;
@@ -1691,6 +2129,9 @@ errr Term_clear(void)
 		int *scr_taa = Term->scr->ta[y];
 		wchar_t *scr_tcc = Term->scr->tc[y];
 
+		/* Keep what a saved screen had here */
+		term_layer_keep(Term, y, 0, w - 1);
+
 		/* Wipe each column */
 		for (x = 0; x < w; x++) {
 			scr_aa[x] = na;
@@ -2065,23 +2506,20 @@ errr Term_inkey(ui_event *ch, bool wait, bool take)
 /**
  * Save the "requested" screen into the "memorized" screen
  *
+ * Nothing is copied yet: the new layer keeps each grid only when it is first
+ * drawn over (see "term_layer_keep()"), so a popup saves just what it covers.
+ *
  * Every "Term_save()" should match exactly one "Term_load()"
  */
 errr Term_save(void)
 {
-	int w = Term->wid;
-	int h = Term->hgt;
-
-	term_win *mem;
-
-	/* Allocate window */
-	mem = mem_zalloc(sizeof(term_win));
+	term_layer *mem = term_layer_new(Term->hgt);
 
-	/* Initialize window */
-	term_win_init(mem, w, h);
-
-	/* Grab */
-	term_win_copy(mem, Term->scr, w, h);
+	/* Remember the cursor */
+	mem->cx = Term->scr->cx;
+	mem->cy = Term->scr->cy;
+	mem->cu = Term->scr->cu;
+	mem->cv = Term->scr->cv;
 
 	/* Front of the queue */
 	mem->next = Term->mem;
@@ -2098,6 +2536,8 @@ errr Term_save(void)
 /**
  * Restore the "requested" contents (see above).
  *
+ * Only the grids drawn over since the save are put back and redrawn.
+ *
  * Every "Term_save()" should match exactly one "Term_load()"
  */
 errr Term_load(void)
@@ -2107,7 +2547,7 @@ errr Term_load(void)
 	int w = Term->wid;
 	int h = Term->hgt;
 
-	term_win *tmp;
+	term_layer *tmp;
 
 	/* Pop off window from the list */
 	if (Term->mem) {
@@ -2117,27 +2557,45 @@ errr Term_load(void)
 		/* Forget it */
 		Term->mem = Term->mem->next;
 
-		/* Load */
-		term_win_copy(Term->scr, tmp, w, h);
+		/* Load the grids that were kept */
+		for (y = 0; y < h; y++) {
+			int x1 = tmp->x1[y];
+			int x2 = tmp->x2[y];
+			int n = x2 - x1 + 1;
+
+			if (n <= 0) continue;
+
+			memcpy(Term->scr->a[y] + x1, tmp->a[y] + x1, n * sizeof(int));
+			memcpy(Term->scr->c[y] + x1, tmp->c[y] + x1, n * sizeof(wchar_t));
+			memcpy(Term->scr->ta[y] + x1, tmp->ta[y] + x1, n * sizeof(int));
+			memcpy(Term->scr->tc[y] + x1, tmp->tc[y] + x1,
+				   n * sizeof(wchar_t));
+
+			/* Just these have changed */
+			if (y < Term->y1) Term->y1 = y;
+			if (y > Term->y2) Term->y2 = y;
+			if (x1 < Term->x1[y]) Term->x1[y] = x1;
+			if (x2 > Term->x2[y]) Term->x2[y] = x2;
+		}
 
-		/* Free the old window */
-		(void)term_win_nuke(tmp);
+		/* Load the cursor */
+		Term->scr->cx = tmp->cx;
+		Term->scr->cy = tmp->cy;
+		Term->scr->cu = tmp->cu;
+		Term->scr->cv = tmp->cv;
 
 		/* Kill it */
-		mem_free(tmp);
-	}
-
-	/* Assume change */
-	for (y = 0; y < h; y++) {
-		/* Assume change */
-		Term->x1[y] = 0;
-		Term->x2[y] = w - 1;
+		term_layer_free(tmp, h);
+	} else {
+		/* Nothing to load, so just redraw */
+		for (y = 0; y < h; y++) {
+			Term->x1[y] = 0;
+			Term->x2[y] = w - 1;
+		}
+		Term->y1 = 0;
+		Term->y2 = h - 1;
 	}
 
-	/* Assume change */
-	Term->y1 = 0;
-	Term->y2 = h - 1;
-
 	/* One less saved */
 	Term->saved--;
 
@@ -2161,7 +2619,7 @@ errr Term_resize(int w, int h)
 
 	term_win *hold_old;
 	term_win *hold_scr;
-	term_win *hold_mem;
+	term_layer *mem;
 	term_win *hold_tmp;
 
 	ui_event evt = EVENT_EMPTY;
@@ -2190,8 +2648,9 @@ errr Term_resize(int w, int h)
 	/* Save old window */
 	hold_scr = Term->scr;
 
-	/* Save old window */
-	hold_mem = Term->mem;
+	/* Fit the saved layers, while the old screen is still there */
+	for (mem = Term->mem; mem; mem = mem->next)
+		term_layer_resize(Term, mem, w, h);
 
 	/* Save old window */
 	hold_tmp = Term->tmp;
@@ -2218,18 +2677,6 @@ errr Term_resize(int w, int h)
 	/* Save the contents */
 	term_win_copy(Term->scr, hold_scr, wid, hgt);
 
-	/* If needed */
-	if (hold_mem) {
-		/* Create new window */
-		Term->mem = mem_zalloc(sizeof(term_win));
-
-		/* Initialize new window */
-		term_win_init(Term->mem, w, h);
-
-		/* Save the contents */
-		term_win_copy(Term->mem, hold_mem, wid, hgt);
-	}
-
 	/* If needed */
 	if (hold_tmp) {
 		/* Create new window */
@@ -2266,17 +2713,10 @@ errr Term_resize(int w, int h)
 	if (Term->scr->cx >= w) Term->scr->cu = 1;
 	if (Term->scr->cy >= h) Term->scr->cu = 1;
 
-	/* If needed */
-	if (hold_mem) {
-		/* Nuke */
-		term_win_nuke(hold_mem);
-
-		/* Kill */
-		mem_free(hold_mem);
-
-		/* Illegal cursor */
-		if (Term->mem->cx >= w) Term->mem->cu = 1;
-		if (Term->mem->cy >= h) Term->mem->cu = 1;
+	/* Illegal cursors */
+	for (mem = Term->mem; mem; mem = mem->next) {
+		if (mem->cx >= w) mem->cu = 1;
+		if (mem->cy >= h) mem->cu = 1;
 	}
 
 	/* If needed */
@@ -2390,13 +2830,12 @@ errr term_nuke(term *t)
 	/* Kill "requested" */
 	mem_free(t->scr);
 
-	/* If needed */
-	if (t->mem) {
-		/* Nuke "memorized" */
-		term_win_nuke(t->mem);
+	/* Kill any saved layers */
+	while (t->mem) {
+		term_layer *mem = t->mem;
 
-		/* Kill "memorized" */
-		mem_free(t->mem);
+		t->mem = mem->next;
+		term_layer_free(mem, t->hgt);
 	}
 
 	/* If needed */
@@ -2411,6 +2850,7 @@ errr term_nuke(term *t)
 	/* Free some arrays */
 	mem_free(t->x1);
 	mem_free(t->x2);
+	mem_free(t->batch);
 
 	/* Free the input queue */
 	mem_free(t->key_queue);
@@ -27,7 +27,6 @@
  *	- Array[h*w] -- Attribute array
  *	- Array[h*w] -- Character array
  *
- *	- next screen saved
  *	- hook to be called on screen size change
  *
  * Note that the attr/char pair at (x,y) is a[y][x]/c[y][x]
@@ -52,8 +51,49 @@ struct term_win
 
 	int *vta;
 	wchar_t *vtc;
+};
+
 
-	term_win *next;
+/**
+ * A term_layer is what "Term_save()" keeps of the screen below a popup
+ *
+ *	- Cursor Useless/Visible codes
+ *	- Cursor Location (see "Useless")
+ *
+ *	- Array[h] -- First saved column of each row
+ *	- Array[h] -- Last saved column of each row
+ *
+ *	- Array[h] -- Saved attributes of each row, or NULL
+ *	- Array[h] -- Saved characters of each row, or NULL
+ *	- Array[h] -- Saved terrain attributes of each row, or NULL
+ *	- Array[h] -- Saved terrain characters of each row, or NULL
+ *
+ *	- next (older) layer saved
+ *
+ * Nothing is copied when the layer is made.  The first time a grid is drawn
+ * over, the old contents of the row are kept from that grid out to the
+ * columns already kept, so row y holds the saved screen from x1[y] to x2[y]
+ * (none if x1[y] > x2[y]) and every other grid is as it was at the save.
+ * The row arrays are allocated the width of the term when first needed.
+ */
+
+typedef struct term_layer term_layer;
+
+struct term_layer
+{
+	bool cu, cv;
+	int cx, cy;
+
+	int *x1;
+	int *x2;
+
+	int **a;
+	wchar_t **c;
+
+	int **ta;
+	wchar_t **tc;
+
+	term_layer *next;
 };
 
 
@@ -140,7 +180,7 @@ struct term_win
  *	- Requested screen image
  *
  *	- Temporary screen image
- *	- Memorized screen image
+ *	- Saved screen layers (newest first)
  *
  *
  *	- Hook for init-ing the term
@@ -155,7 +195,25 @@ struct term_win
  *	- Hook for drawing a string of chars using an attr
  *
  *	- Hook for drawing a sequence of special attr/char pairs
+ *
+ *	- Hook for drawing every changed cell of a refresh at once
+ */
+
+/**
+ * A changed grid, as handed to "batch_hook"
  */
+typedef struct term_cell term_cell;
+
+struct term_cell
+{
+	int x, y;
+
+	int a;
+	wchar_t c;
+
+	int ta;
+	wchar_t tc;
+};
 
 typedef struct term term;
 
@@ -211,7 +269,7 @@ struct term
 	term_win *scr;
 
 	term_win *tmp;
-	term_win *mem;
+	term_layer *mem;
 
 	/* Number of times saved */
 	byte saved;
@@ -233,6 +291,14 @@ struct term
 
 	void (*view_map_hook)(term *t);
 
+	errr (*batch_hook)(const term_cell *cells, int n);
+
+	/* Changed cells gathered for "batch_hook" */
+	term_cell *batch;
+	int batch_max;
+
+	/* When this window last reached the screen (see "Term_fresh_paced") */
+	clock_t fresh_clock;
 };
 
 
@@ -297,6 +363,7 @@ struct term
 #define TERM_XTRA_ALIVE 11    /* Change the "hard" level (optional) */
 #define TERM_XTRA_LEVEL 12    /* Change the "soft" level (optional) */
 #define TERM_XTRA_DELAY 13    /* Delay some milliseconds (optional) */
+#define TERM_XTRA_FRAME 14    /* Show every term flushed so far (optional) */
 
 /**
  * Bit flags for the "window_flag" variable.
@@ -340,6 +407,7 @@ extern bool smlcurs;
 extern term *angband_term[ANGBAND_TERM_MAX];
 extern char angband_term_name[ANGBAND_TERM_MAX][16];
 extern u32b window_flag[ANGBAND_TERM_MAX];
+extern int term_frame_rate;
 
 /**
  * Hack -- The main "screen"
@@ -360,6 +428,9 @@ extern void Term_big_queue_char(term *t, int x, int y, int a, wchar_t c, int a1,
 extern void Term_queue_chars(int x, int y, int n, int a, const wchar_t *s);
 
 extern errr Term_fresh(void);
+extern errr Term_fresh_paced(void);
+extern void Term_frame_hold(bool hold);
+extern errr Term_frame(void);
 extern errr Term_set_cursor(bool v);
 extern errr Term_gotoxy(int x, int y);
 extern errr Term_draw(int x, int y, int a, wchar_t c);
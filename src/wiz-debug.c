@@ -21,6 +21,7 @@
 #include "cmds.h"
 #include "effects.h"
 #include "game-input.h"
+#include "game-world.h"
 #include "grafmode.h"
 #include "init.h"
 #include "mon-lore.h"
@@ -52,6 +53,7 @@
 #include "ui-prefs.h"
 #include "ui-target.h"
 #include "wizard.h"
+#include "z-trace.h"
 
 
 static void gf_display(struct menu *m, int type, bool cursor,
@@ -149,10 +151,10 @@ static void do_cmd_wiz_hack_ben(void)
 				if (!square_in_bounds_fully(cave, y, x)) continue;
 
 				/* Display proper cost */
-				if (cave->squares[y][x].cost != i) continue;
+				if (cave->cost[y][x] != i) continue;
 
 				/* Reliability in yellow */
-				if (cave->squares[y][x].when == cave->squares[py][px].when)
+				if (cave->when[y][x] == cave->when[py][px])
 					a = COLOUR_YELLOW;
 
 				/* Display player/floors/walls */
@@ -1318,6 +1320,7 @@ static void do_cmd_wiz_learn(int lev)
 		if (kind->level <= lev)
 			kind->aware = TRUE;
 	}
+	object_desc_invalidate();
 	
 	msg("You now know about many items!");
 }
@@ -1659,6 +1662,82 @@ static void wiz_test_kind(int tval)
 	msg("Done.");
 }
 
+#if defined(MEM_TRACK) || defined(TURN_PROFILE)
+static ang_file *wiz_report;
+
+static void wiz_report_line(const char *line)
+{
+	file_putf(wiz_report, "%s\n", line);
+}
+
+/**
+ * Write a report, a line at a time from 'dump', to 'name' in the user
+ * directory.
+ */
+static void wiz_report_write(const char *name, const char *what,
+							 void (*dump)(void (*out)(const char *line)))
+{
+	char buf[1024];
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_USER, name);
+	wiz_report = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+	if (!wiz_report) {
+		msg("Couldn't open %s.", buf);
+		return;
+	}
+
+	dump(wiz_report_line);
+	file_close(wiz_report);
+	wiz_report = NULL;
+	msg("Wrote %s to %s.", what, buf);
+}
+#endif
+
+#ifdef MEM_TRACK
+/**
+ * Write the allocation report to a file in the user directory.
+ */
+static void do_cmd_wiz_mem_report(void)
+{
+	wiz_report_write("memory.txt", "allocation report", mem_track_dump);
+}
+#endif
+
+#ifdef TURN_PROFILE
+/**
+ * Start the turn profiler, or write what it has found to a file in the user
+ * directory and stop it.
+ */
+static void do_cmd_wiz_turn_profile(void)
+{
+	if (!turn_prof_on) {
+		turn_prof_reset();
+		turn_prof_on = TRUE;
+		msg("Turn profiling started.");
+		return;
+	}
+
+	wiz_report_write("turnprof.txt", "turn profile", turn_prof_dump);
+	turn_prof_on = FALSE;
+}
+#endif
+
+#ifdef EVENT_TRACE
+/**
+ * Write the spans recorded by the tracer to a file in the user directory.
+ */
+static void do_cmd_wiz_trace_dump(void)
+{
+	char buf[1024];
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_USER, "trace.json");
+	if (trace_dump(buf))
+		msg("Wrote trace to %s.", buf);
+	else
+		msg("Couldn't write %s.", buf);
+}
+#endif
+
 /**
  * Display the debug commands help file.
  */
@@ -1950,6 +2029,15 @@ void get_debug_command(void)
 			break;
 		}
 
+#ifdef MEM_TRACK
+		/* Report allocations by call site */
+		case 'M':
+		{
+			do_cmd_wiz_mem_report();
+			break;
+		}
+#endif
+
 		/* Magic Mapping */
 		case 'm':
 		{
@@ -2224,6 +2312,24 @@ void get_debug_command(void)
 			break;
 		}
 
+#ifdef TURN_PROFILE
+		/* Start the turn profiler, or report and stop it */
+		case 'Y':
+		{
+			do_cmd_wiz_turn_profile();
+			break;
+		}
+#endif
+
+#ifdef EVENT_TRACE
+		/* Write the recent timeline */
+		case 'J':
+		{
+			do_cmd_wiz_trace_dump();
+			break;
+		}
+#endif
+
 		/* Zap Monsters (Banishment) */
 		case 'z':
 		{
@@ -666,6 +666,17 @@ static void spoil_mon_info(const char *fname)
 	msg("Successfully created a spoiler file.");
 }
 
+/**
+ * Create every spoiler file in one go, without any prompts
+ */
+void spoil_all(void)
+{
+	spoil_obj_desc("obj-desc.spo");
+	spoil_artifact("artifact.spo");
+	spoil_mon_desc("mon-desc.spo");
+	spoil_mon_info("mon-info.spo");
+}
+
 static void spoiler_menu_act(const char *title, int row)
 {
 	if (row == 0)
@@ -676,6 +687,8 @@ static void spoiler_menu_act(const char *title, int row)
 		spoil_mon_desc("mon-desc.spo");
 	else if (row == 3)
 		spoil_mon_info("mon-info.spo");
+	else if (row == 4)
+		spoil_all();
 
 	event_signal(EVENT_MESSAGE_FLUSH);
 }
@@ -687,6 +700,7 @@ static menu_action spoil_actions[] =
 	{ 0, 0, "Brief Artifact Info (artifact.spo)",	spoiler_menu_act },
 	{ 0, 0, "Brief Monster Info (mon-desc.spo)",	spoiler_menu_act },
 	{ 0, 0, "Full Monster Info (mon-info.spo)",		spoiler_menu_act },
+	{ 0, 0, "All of the above",						spoiler_menu_act },
 };
 
 
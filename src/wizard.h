@@ -29,6 +29,7 @@ void disconnect_stats(void);
 void pit_stats(void);
 
 /* wiz-spoil.c */
+void spoil_all(void);
 void do_cmd_spoilers(void);
 
 #endif /* !INCLUDED_WIZARD_H */
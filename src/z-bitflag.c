@@ -18,6 +18,26 @@
 
 #include "z-bitflag.h"
 
+/**
+ * Set-style operations work a machine word at a time, finishing any odd bytes
+ * at the end individually.  Words are loaded and stored through memcpy() so
+ * that flag arrays needn't be aligned.
+ */
+typedef u64b flag_word;
+#define WORD_SIZE	sizeof(flag_word)
+
+static inline flag_word word_get(const bitflag *flags)
+{
+	flag_word w;
+	memcpy(&w, flags, WORD_SIZE);
+	return w;
+}
+
+static inline void word_put(bitflag *flags, flag_word w)
+{
+	memcpy(flags, &w, WORD_SIZE);
+}
+
 
 /**
  * Tests if a flag is "on" in a bitflag set.
@@ -71,13 +91,26 @@ bool flag_has_dbg(const bitflag *flags, const size_t size, const int flag,
 int flag_next(const bitflag *flags, const size_t size, const int flag)
 {
 	const int max_flags = FLAG_MAX(size);
-	int f, flag_offset, flag_binary;
-
-	for (f = flag; f < max_flags; f++) {
-		flag_offset = FLAG_OFFSET(f);
-		flag_binary = FLAG_BINARY(f);
+	int f = MAX(flag, FLAG_START);
+
+	while (f < max_flags) {
+		size_t flag_offset = FLAG_OFFSET(f);
+
+		/* Skip empty words and bytes whole */
+		if ((f - FLAG_START) % FLAG_WIDTH == 0) {
+			if (flag_offset + WORD_SIZE <= size &&
+					!word_get(flags + flag_offset)) {
+				f += WORD_SIZE * FLAG_WIDTH;
+				continue;
+			}
+			if (!flags[flag_offset]) {
+				f += FLAG_WIDTH;
+				continue;
+			}
+		}
 
-		if (flags[flag_offset] & flag_binary) return f;
+		if (flags[flag_offset] & FLAG_BINARY(f)) return f;
+		f++;
 	}
 
 	return FLAG_END;
@@ -94,7 +127,9 @@ bool flag_is_empty(const bitflag *flags, const size_t size)
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i + WORD_SIZE <= size; i += WORD_SIZE)
+		if (word_get(flags + i)) return FALSE;
+	for (; i < size; i++)
 		if (flags[i] > 0) return FALSE;
 
 	return TRUE;
@@ -111,7 +146,9 @@ bool flag_is_full(const bitflag *flags, const size_t size)
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i + WORD_SIZE <= size; i += WORD_SIZE)
+		if (word_get(flags + i) != (flag_word) -1) return FALSE;
+	for (; i < size; i++)
 		if (flags[i] != (bitflag) -1) return FALSE;
 
 	return TRUE;
@@ -129,7 +166,9 @@ bool flag_is_inter(const bitflag *flags1, const bitflag *flags2,
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i + WORD_SIZE <= size; i += WORD_SIZE)
+		if (word_get(flags1 + i) & word_get(flags2 + i)) return TRUE;
+	for (; i < size; i++)
 		if (flags1[i] & flags2[i]) return TRUE;
 
 	return FALSE;
@@ -147,7 +186,9 @@ bool flag_is_subset(const bitflag *flags1, const bitflag *flags2,
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i + WORD_SIZE <= size; i += WORD_SIZE)
+		if (~word_get(flags1 + i) & word_get(flags2 + i)) return FALSE;
+	for (; i < size; i++)
 		if (~flags1[i] & flags2[i]) return FALSE;
 
 	return TRUE;
@@ -261,8 +302,10 @@ void flag_setall(bitflag *flags, const size_t size)
 void flag_negate(bitflag *flags, const size_t size)
 {
 	size_t i;
-	
-	for (i = 0; i < size; i++)
+
+	for (i = 0; i + WORD_SIZE <= size; i += WORD_SIZE)
+		word_put(flags + i, ~word_get(flags + i));
+	for (; i < size; i++)
 		flags[i] = ~flags[i];
 }
 
@@ -291,7 +334,15 @@ bool flag_union(bitflag *flags1, const bitflag *flags2, const size_t size)
 	size_t i;
 	bool delta = FALSE;
 
-	for (i = 0; i < size; i++) {
+	for (i = 0; i + WORD_SIZE <= size; i += WORD_SIZE) {
+		flag_word w1 = word_get(flags1 + i), w2 = word_get(flags2 + i);
+
+		/* !flag_is_subset() */
+		if (~w1 & w2) delta = TRUE;
+
+		word_put(flags1 + i, w1 | w2);
+	}
+	for (; i < size; i++) {
 		/* !flag_is_subset() */
 		if (~flags1[i] & flags2[i]) delta = TRUE;
 
@@ -337,7 +388,15 @@ bool flag_inter(bitflag *flags1, const bitflag *flags2, const size_t size)
 	size_t i;
 	bool delta = FALSE;
 
-	for (i = 0; i < size; i++) {
+	for (i = 0; i + WORD_SIZE <= size; i += WORD_SIZE) {
+		flag_word w1 = word_get(flags1 + i), w2 = word_get(flags2 + i);
+
+		/* !flag_is_equal() */
+		if (w1 != w2) delta = TRUE;
+
+		word_put(flags1 + i, w1 & w2);
+	}
+	for (; i < size; i++) {
 		/* !flag_is_equal() */
 		if (!(flags1[i] == flags2[i])) delta = TRUE;
 
@@ -361,7 +420,15 @@ bool flag_diff(bitflag *flags1, const bitflag *flags2, const size_t size)
 	size_t i;
 	bool delta = FALSE;
 
-	for (i = 0; i < size; i++) {
+	for (i = 0; i + WORD_SIZE <= size; i += WORD_SIZE) {
+		flag_word w1 = word_get(flags1 + i), w2 = word_get(flags2 + i);
+
+		/* flag_is_inter() */
+		if (w1 & w2) delta = TRUE;
+
+		word_put(flags1 + i, w1 & ~w2);
+	}
+	for (; i < size; i++) {
 		/* flag_is_inter() */
 		if (flags1[i] & flags2[i]) delta = TRUE;
 
@@ -569,10 +636,14 @@ bool flags_mask(bitflag *flags, const size_t size, ...)
 	va_list args;
 	bool delta = FALSE;
 
-	bitflag *mask;
+	bitflag mask_buf[64];
+	bitflag *mask = mask_buf;
 
-	/* Build the mask */
-	mask = mem_zalloc(size * sizeof(bitflag));
+	/* Build the mask, on the stack unless it is unusually large */
+	if (size > N_ELEMENTS(mask_buf))
+		mask = mem_zalloc(size * sizeof(bitflag));
+	else
+		memset(mask, 0, size * sizeof(bitflag));
 
 	va_start(args, size);
 
@@ -585,8 +656,8 @@ bool flags_mask(bitflag *flags, const size_t size, ...)
 	delta = flag_inter(flags, mask, size);
 
 	/* Free the mask */
-
-	mem_free(mask);
+	if (mask != mask_buf)
+		mem_free(mask);
 
 	return delta;
 }
@@ -25,11 +25,23 @@ struct expression_operation_s {
 	s16b operand;
 };
 
+/**
+ * A run of operations folded into value * mul + add, followed by a division
+ * by div (which is 1 for runs that end without one).
+ */
+typedef struct expression_step_s {
+	s32b mul;
+	s32b add;
+	s32b div;
+} expression_step_t;
+
 struct expression_s {
 	expression_base_value_f base_value;
 	size_t operation_count;
 	size_t operations_size;
 	expression_operation_t *operations;
+	size_t step_count;
+	expression_step_t *steps;
 };
 
 /**
@@ -123,6 +135,56 @@ static expression_input_t expression_input_for_operator(expression_operator_t op
 	return EXPRESSION_INPUT_INVALID;
 }
 
+/**
+ * Fold the operations of an expression into steps, so that it can be evaluated
+ * with one multiply and one add between divisions.  Since sums and products
+ * wrap the same way however they are grouped, the result is exactly what the
+ * operations would give one at a time.
+ */
+static void expression_compile(expression_t *expression)
+{
+	size_t i;
+	expression_step_t step = { 1, 0, 1 };
+
+	expression->steps = mem_realloc(expression->steps,
+									(expression->operation_count + 1) *
+									sizeof(expression_step_t));
+	expression->step_count = 0;
+
+	for (i = 0; i < expression->operation_count; i++) {
+		s32b operand = expression->operations[i].operand;
+
+		switch (expression->operations[i].operator) {
+			case OPERATOR_ADD:
+				step.add += operand;
+				break;
+			case OPERATOR_SUB:
+				step.add -= operand;
+				break;
+			case OPERATOR_MUL:
+				step.mul *= operand;
+				step.add *= operand;
+				break;
+			case OPERATOR_DIV:
+				step.div = operand;
+				expression->steps[expression->step_count++] = step;
+				step.mul = 1;
+				step.add = 0;
+				step.div = 1;
+				break;
+			case OPERATOR_NEG:
+				step.mul = -step.mul;
+				step.add = -step.add;
+				break;
+			default:
+				break;
+		}
+	}
+
+	if (step.mul != 1 || step.add != 0)
+		expression->steps[expression->step_count++] = step;
+}
+
 /**
  * Allocate and initialize a new expression object. Returns NULL if it was
  * unable to be created.
@@ -161,6 +223,7 @@ void expression_free(expression_t *expression)
 		expression->operations = NULL;
 	}
 
+	mem_free(expression->steps);
 	mem_free(expression);
 }
 
@@ -197,6 +260,7 @@ expression_t *expression_copy(const expression_t *source)
 		copy->operations[i].operator = source->operations[i].operator;
 	}
 
+	expression_compile(copy);
 	return copy;
 }
 
@@ -221,26 +285,12 @@ s32b expression_evaluate(expression_t const * const expression)
 	if (expression->base_value != NULL)
 		value = expression->base_value();
 
-	for (i = 0; i < expression->operation_count; i++) {
-		switch (expression->operations[i].operator) {
-			case OPERATOR_ADD:
-				value += expression->operations[i].operand;
-				break;
-			case OPERATOR_SUB:
-				value -= expression->operations[i].operand;
-				break;
-			case OPERATOR_MUL:
-				value *= expression->operations[i].operand;
-				break;
-			case OPERATOR_DIV:
-				value /= expression->operations[i].operand;
-				break;
-			case OPERATOR_NEG:
-				value = -value;
-				break;
-			default:
-				break;
-		}
+	for (i = 0; i < expression->step_count; i++) {
+		const expression_step_t *step = &expression->steps[i];
+
+		value = value * step->mul + step->add;
+		if (step->div != 1)
+			value /= step->div;
 	}
 
 	return value;
@@ -380,6 +430,7 @@ s16b expression_add_operations_string(expression_t *expression,
 	for (i = 0; i < count; i++) {
 		expression_add_operation(expression, operations[i]);
 	}
+	expression_compile(expression);
 
 	string_free(parse_string);
 	return count;
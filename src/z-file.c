@@ -44,6 +44,10 @@
 # include <sys/types.h>
 #endif
 
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+#endif
+
 #ifdef WINDOWS
 # define my_mkdir(path, perms) mkdir(path)
 #elif defined(HAVE_MKDIR) || defined(MACH_O_CARBON)
@@ -249,12 +253,20 @@ size_t path_filename_index(const char *path)
 FILE *fdopen(int handle, const char *mode);
 #endif
 
+/* Size of the read-ahead buffer of a file */
+#define FILE_BUF_SIZE 8192
+
 /* Private structure to hold file pointers and useful info. */
 struct ang_file
 {
 	FILE *fh;
 	char *fname;
 	file_mode mode;
+
+	/* Bytes read ahead of the caller, from rbuf[rpos] to rbuf[rlen - 1] */
+	char *rbuf;
+	size_t rpos;
+	size_t rlen;
 };
 
 
@@ -423,6 +435,7 @@ bool file_close(ang_file *f)
 	if (fclose(f->fh) != 0)
 		return FALSE;
 
+	mem_free(f->rbuf);
 	mem_free(f->fname);
 	mem_free(f);
 
@@ -468,11 +481,46 @@ void file_unlock(ang_file *f)
 
 /** Byte-based IO and functions **/
 
+/**
+ * Read the next block of file 'f' into its read-ahead buffer, once the
+ * buffer is used up.  Returns FALSE at the end of the file.
+ */
+static bool file_fill(ang_file *f)
+{
+	if (f->rpos < f->rlen) return TRUE;
+
+	if (!f->rbuf) f->rbuf = mem_alloc(FILE_BUF_SIZE);
+
+	f->rpos = 0;
+	f->rlen = fread(f->rbuf, 1, FILE_BUF_SIZE, f->fh);
+
+	return f->rlen > 0;
+}
+
+/**
+ * Give back to the stream whatever of file 'f' has been read ahead, so that
+ * it can be written to or repositioned.
+ */
+static void file_unread(ang_file *f)
+{
+	if (f->rpos < f->rlen)
+		fseek(f->fh, -(long)(f->rlen - f->rpos), SEEK_CUR);
+
+	f->rpos = f->rlen = 0;
+}
+
 /**
  * Seek to location 'pos' in file 'f'.
  */
 bool file_skip(ang_file *f, int bytes)
 {
+	/* Stay in the read-ahead if possible */
+	if (bytes >= 0 && (size_t)bytes <= f->rlen - f->rpos) {
+		f->rpos += bytes;
+		return TRUE;
+	}
+
+	file_unread(f);
 	return (fseek(f->fh, bytes, SEEK_CUR) == 0);
 }
 
@@ -481,12 +529,10 @@ bool file_skip(ang_file *f, int bytes)
  */
 bool file_readc(ang_file *f, byte *b)
 {
-	int i = fgetc(f->fh);
-
-	if (i == EOF)
+	if (!file_fill(f))
 		return FALSE;
 
-	*b = (byte)i;
+	*b = (byte)f->rbuf[f->rpos++];
 	return TRUE;
 }
 
@@ -503,7 +549,16 @@ bool file_writec(ang_file *f, byte b)
  */
 int file_read(ang_file *f, char *buf, size_t n)
 {
-	size_t read = fread(buf, 1, n, f->fh);
+	size_t ahead = MIN(n, f->rlen - f->rpos);
+	size_t read;
+
+	/* Anything already read ahead comes first */
+	if (ahead) {
+		memcpy(buf, f->rbuf + f->rpos, ahead);
+		f->rpos += ahead;
+	}
+
+	read = ahead + fread(buf + ahead, 1, n - ahead, f->fh);
 
 	if (read == 0 && ferror(f->fh))
 		return -1;
@@ -516,6 +571,7 @@ int file_read(ang_file *f, char *buf, size_t n)
  */
 bool file_write(ang_file *f, const char *buf, size_t n)
 {
+	file_unread(f);
 	return fwrite(buf, 1, n, f->fh) == n;
 }
 
@@ -532,52 +588,64 @@ bool file_write(ang_file *f, const char *buf, size_t n)
 bool file_getl(ang_file *f, char *buf, size_t len)
 {
 	bool seen_cr = FALSE;
-	byte b;
 	size_t i = 0;
 
 	/* Leave a byte for the terminating 0 */
 	size_t max_len = len - 1;
 
 	while (i < max_len) {
-		char c;
+		const char *p, *end;
 
-		if (!file_readc(f, &b)) {
+		if (!file_fill(f)) {
 			buf[i] = '\0';
 			return (i == 0) ? FALSE : TRUE;
 		}
 
-		c = (char) b;
+		/* Work through what has been read ahead */
+		p = f->rbuf + f->rpos;
+		end = f->rbuf + f->rlen;
 
-		if (c == '\r') {
-			seen_cr = TRUE;
-			continue;
-		}
+		while (p < end && i < max_len) {
+			char c = *p++;
 
-		if (seen_cr && c != '\n') {
-			fseek(f->fh, -1, SEEK_CUR);
-			buf[i] = '\0';
-			return TRUE;
-		}
+			if (c == '\r') {
+				seen_cr = TRUE;
+				continue;
+			}
 
-		if (c == '\n') {
-			buf[i] = '\0';
-			return TRUE;
-		}
+			if (seen_cr && c != '\n') {
+				f->rpos = p - 1 - f->rbuf;
+				buf[i] = '\0';
+				return TRUE;
+			}
 
-		/* Expand tabs */
-		if (c == '\t') {
-			/* Next tab stop */
-			size_t tabstop = ((i + TAB_COLUMNS) / TAB_COLUMNS) * TAB_COLUMNS;
-			if (tabstop >= len) break;
+			if (c == '\n') {
+				f->rpos = p - f->rbuf;
+				buf[i] = '\0';
+				return TRUE;
+			}
 
-			/* Convert to spaces */
-			while (i < tabstop)
-				buf[i++] = ' ';
+			/* Expand tabs */
+			if (c == '\t') {
+				/* Next tab stop */
+				size_t tabstop = ((i + TAB_COLUMNS) / TAB_COLUMNS) * TAB_COLUMNS;
+				if (tabstop >= len) {
+					f->rpos = p - f->rbuf;
+					buf[i] = '\0';
+					return TRUE;
+				}
 
-			continue;
+				/* Convert to spaces */
+				while (i < tabstop)
+					buf[i++] = ' ';
+
+				continue;
+			}
+
+			buf[i++] = c;
 		}
 
-		buf[i++] = c;
+		f->rpos = p - f->rbuf;
 	}
 
 	buf[i] = '\0';
@@ -636,6 +704,128 @@ bool file_vputf(ang_file *f, const char *fmt, va_list vp)
 }
 
 
+/** Mapped files **/
+
+/* Private structure for a read-only view of a whole file */
+struct ang_map
+{
+	char *data;
+	size_t len;
+	size_t pos;
+
+	/* The view is mapped, rather than read into memory */
+	bool mapped;
+};
+
+/**
+ * Map file 'fname' into memory, read-only.
+ * Returns the view or NULL.
+ */
+ang_map *file_map(const char *fname)
+{
+	ang_map *map;
+	ang_file *f;
+	char buf[1024];
+	long len;
+
+	/* Get the system-specific path */
+	path_parse(buf, sizeof(buf), fname);
+
+#ifdef HAVE_MMAP
+	{
+		int fd = open(buf, O_RDONLY | O_BINARY);
+		struct stat st;
+
+		if (fd < 0) return NULL;
+
+		if (fstat(fd, &st) == 0 && st.st_size > 0) {
+			void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (data != MAP_FAILED) {
+				close(fd);
+
+				map = mem_zalloc(sizeof(ang_map));
+				map->data = data;
+				map->len = st.st_size;
+				map->mapped = TRUE;
+				return map;
+			}
+		}
+
+		/* Empty, or can't be mapped, so read it instead */
+		close(fd);
+	}
+#endif /* HAVE_MMAP */
+
+	f = file_open(fname, MODE_READ, -1);
+	if (!f) return NULL;
+
+	map = mem_zalloc(sizeof(ang_map));
+
+	/* Find the length */
+	fseek(f->fh, 0, SEEK_END);
+	len = ftell(f->fh);
+	fseek(f->fh, 0, SEEK_SET);
+
+	if (len > 0) {
+		map->data = mem_alloc(len);
+		map->len = fread(map->data, 1, len, f->fh);
+	}
+
+	file_close(f);
+	return map;
+}
+
+/**
+ * Get the contents of mapped file 'map'.
+ */
+const char *file_map_data(const ang_map *map, size_t *len)
+{
+	*len = map->len;
+	return map->data;
+}
+
+/**
+ * Get the next line of mapped file 'map', without copying it.
+ */
+bool file_map_getl(ang_map *map, const char **line, size_t *len)
+{
+	const char *start = map->data + map->pos;
+	const char *nl;
+	size_t n;
+
+	if (map->pos >= map->len) return FALSE;
+
+	nl = memchr(start, '\n', map->len - map->pos);
+	n = nl ? (size_t)(nl - start) : map->len - map->pos;
+
+	/* Step over the line ending */
+	map->pos += nl ? n + 1 : n;
+
+	/* Drop the \r of a \r\n */
+	if (nl && n > 0 && start[n - 1] == '\r') n--;
+
+	*line = start;
+	*len = n;
+	return TRUE;
+}
+
+/**
+ * Release mapped file 'map'.
+ */
+void file_unmap(ang_map *map)
+{
+#ifdef HAVE_MMAP
+	if (map->mapped)
+		munmap(map->data, map->len);
+	else
+#endif /* HAVE_MMAP */
+		mem_free(map->data);
+
+	mem_free(map);
+}
+
+
 bool dir_exists(const char *path)
 {
 	#ifdef HAVE_STAT
@@ -205,6 +205,43 @@ bool file_putf(ang_file *f, const char *fmt, ...);
 bool file_vputf(ang_file *f, const char *fmt, va_list vp);
 
 
+/** Mapped files **/
+
+/**
+ * An opaque handle for a read-only view of a whole file.
+ */
+typedef struct ang_map ang_map;
+
+/**
+ * Map the file `fname` into memory, read-only.  Where the system can't map
+ * files, it is read into memory instead.
+ *
+ * Returns NULL if the file can't be opened.
+ */
+ang_map *file_map(const char *fname);
+
+/**
+ * Get the contents of the file mapped by `map`, placing its length in `len`.
+ * The contents are not 0-terminated.
+ */
+const char *file_map_data(const ang_map *map, size_t *len);
+
+/**
+ * Get the next line of the file mapped by `map`, placing a pointer to it in
+ * `line` and its length in `len`.  The line points into the mapping, is not
+ * 0-terminated, and has its \n or \r\n ending removed; tabs are left as they
+ * are.
+ *
+ * Returns TRUE when a line is returned; FALSE at the end of the file.
+ */
+bool file_map_getl(ang_map *map, const char **line, size_t *len);
+
+/**
+ * Release the view `map`.  Lines taken from it are no longer valid.
+ */
+void file_unmap(ang_map *map);
+
+
 /** Byte-based IO */
 
 /**
@@ -170,6 +170,10 @@
  *
  * As of 4.0, we use snprintf (for safety, and to quieten picky compilers)
  *
+ * Plain "%s" and "%d", with no flags, width or precision, are the bulk of
+ * what the game formats, so they are copied straight into "buf" without
+ * going through snprintf.
+ *
  * We should also consider extracting and processing the "width" and other
  * "flags" by hand, it might be more "accurate", and it would allow us to
  * remove the limit (1000 chars) on the result of format sequences.
@@ -182,6 +186,18 @@
  * the given buffer to a length of zero, and return a "length" of zero.
  * The contents of "buf", except for "buf[0]", may then be undefined.
  */
+static bool format_append(char *buf, size_t max, size_t *n, const char *str,
+		size_t len)
+{
+	bool fits = len <= max - 1 - *n;
+
+	if (!fits) len = max - 1 - *n;
+	memcpy(buf + *n, str, len);
+	*n += len;
+
+	return fits;
+}
+
 size_t vstrnfmt(char *buf, size_t max, const char *fmt, va_list vp)
 {
 	const char *s;
@@ -216,13 +232,13 @@ size_t vstrnfmt(char *buf, size_t max, const char *fmt, va_list vp)
 		/* All done */
 		if (!*s) break;
 
-		/* Normal character */
+		/* Normal characters, copied a run at a time */
 		if (*s != '%') {
-			/* Check total length */
-			if (n == max-1) break;
+			const char *e = s;
 
-			/* Save the character */
-			buf[n++] = *s++;
+			while (*e && *e != '%') e++;
+			if (!format_append(buf, max, &n, s, e - s)) break;
+			s = e;
 
 			/* Continue */
 			continue;
@@ -263,6 +279,34 @@ size_t vstrnfmt(char *buf, size_t max, const char *fmt, va_list vp)
 			continue;
 		}
 
+		/* Plain "%s" and "%d" go straight into the buffer */
+		if (*s == 's') {
+			const char *arg = va_arg(vp, const char *);
+
+			/* Hack -- convert NULL to EMPTY */
+			if (!arg) arg = "";
+
+			s++;
+			if (!format_append(buf, max, &n, arg, strlen(arg))) break;
+			continue;
+		}
+		if (*s == 'd') {
+			int arg = va_arg(vp, int);
+			unsigned int mag = arg < 0 ? 0U - (unsigned int)arg : (unsigned int)arg;
+			char digits[24];
+			size_t d = sizeof(digits);
+
+			do {
+				digits[--d] = '0' + mag % 10;
+				mag /= 10;
+			} while (mag);
+			if (arg < 0) digits[--d] = '-';
+
+			s++;
+			if (!format_append(buf, max, &n, digits + d, sizeof(digits) - d))
+				break;
+			continue;
+		}
 
 		/* Begin the "aux" string */
 		q = 0;
@@ -515,13 +559,7 @@ size_t vstrnfmt(char *buf, size_t max, const char *fmt, va_list vp)
 		}
 
 		/* Now append "tmp" to "buf" */
-		for (q = 0; tmp[q]; q++) {
-			/* Check total length */
-			if (n == max-1) break;
-
-			/* Save the character */
-			buf[n++] = tmp[q];
-		}
+		if (!format_append(buf, max, &n, tmp, strlen(tmp))) break;
 	}
 
 
@@ -559,8 +597,15 @@ void strnfcat(char *str, size_t max, size_t *end, const char *fmt, ...)
 }
 
 
-static char *format_buf = NULL;
-static size_t format_len = 0;
+/**
+ * format() results rotate through a few buffers, so that several calls can be
+ * used in one expression, as in msg("%s %s", format(...), format(...)).
+ */
+#define FORMAT_BUFS 4
+
+static char *format_bufs[FORMAT_BUFS];
+static size_t format_lens[FORMAT_BUFS];
+static int format_cur = 0;
 
 
 /**
@@ -569,13 +614,24 @@ static size_t format_len = 0;
  */
 char *vformat(const char *fmt, va_list vp)
 {
+	char *format_buf;
+	size_t format_len;
+
+	/* Null format yields last result */
+	if (!fmt && format_bufs[format_cur]) return (format_bufs[format_cur]);
+
+	/* Use the next buffer */
+	if (fmt) format_cur = (format_cur + 1) % FORMAT_BUFS;
+
 	/* Initial allocation */
-	if (!format_buf) {
-		format_len = 1024;
-		format_buf = mem_zalloc(format_len);
-		format_buf[0] = 0;
+	if (!format_bufs[format_cur]) {
+		format_lens[format_cur] = 1024;
+		format_bufs[format_cur] = mem_zalloc(format_lens[format_cur]);
 	}
 
+	format_buf = format_bufs[format_cur];
+	format_len = format_lens[format_cur];
+
 	/* Null format yields last result */
 	if (!fmt) return (format_buf);
 
@@ -595,6 +651,8 @@ char *vformat(const char *fmt, va_list vp)
 		/* Grow the buffer */
 		format_len = format_len * 2;
 		format_buf = mem_realloc(format_buf, format_len);
+		format_bufs[format_cur] = format_buf;
+		format_lens[format_cur] = format_len;
 	}
 
 	/* Return the new buffer */
@@ -603,7 +661,13 @@ char *vformat(const char *fmt, va_list vp)
 
 void vformat_kill(void)
 {
-	mem_free(format_buf);
+	int i;
+
+	for (i = 0; i < FORMAT_BUFS; i++) {
+		mem_free(format_bufs[i]);
+		format_bufs[i] = NULL;
+		format_lens[i] = 0;
+	}
 }
 
 
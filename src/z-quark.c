@@ -25,16 +25,75 @@ static char **quarks;
 static size_t nr_quarks = 1;
 static size_t alloc_quarks = 0;
 
+/* Open-addressed index of quarks by string hash; 0 marks an empty slot */
+static quark_t *quark_index;
+static size_t quark_index_size;
+
+/* The quarks' text, packed into an arena so that it never moves */
+static struct mem_arena *quark_text;
+
 #define QUARKS_INIT	16
+#define QUARK_BLOCK_SIZE	4096
+
+static size_t quark_hash(const char *str)
+{
+	size_t h = 5381;
+
+	while (*str)
+		h = (h * 33) ^ (byte)*str++;
+
+	return h;
+}
+
+/**
+ * Find the index slot for 'str'; either the one holding its quark or the
+ * empty one where that quark belongs
+ */
+static size_t quark_slot(const char *str)
+{
+	size_t mask = quark_index_size - 1;
+	size_t i = quark_hash(str) & mask;
+
+	while (quark_index[i] && strcmp(quarks[quark_index[i]], str))
+		i = (i + 1) & mask;
+
+	return i;
+}
+
+/**
+ * Double the index and re-insert every quark
+ */
+static void quark_index_grow(void)
+{
+	quark_t q;
+
+	mem_free(quark_index);
+	quark_index_size *= 2;
+	quark_index = mem_zalloc(quark_index_size * sizeof(*quark_index));
+
+	for (q = 1; q < nr_quarks; q++)
+		quark_index[quark_slot(quarks[q])] = q;
+}
+
+/**
+ * Copy 'str' into the text arena
+ */
+static char *quark_store(const char *str)
+{
+	size_t len = strlen(str) + 1;
+	char *text = mem_arena_alloc(quark_text, len);
+
+	memcpy(text, str, len);
+	return text;
+}
 
 quark_t quark_add(const char *str)
 {
 	quark_t q;
+	size_t slot = quark_slot(str);
 
-	for (q = 1; q < nr_quarks; q++) {
-		if (!strcmp(quarks[q], str))
-			return q;
-	}
+	if (quark_index[slot])
+		return quark_index[slot];
 
 	if (nr_quarks == alloc_quarks) {
 		alloc_quarks *= 2;
@@ -42,7 +101,12 @@ quark_t quark_add(const char *str)
 	}
 
 	q = nr_quarks++;
-	quarks[q] = string_make(str);
+	quarks[q] = quark_store(str);
+	quark_index[slot] = q;
+
+	/* Keep the index at most half full */
+	if (nr_quarks * 2 > quark_index_size)
+		quark_index_grow();
 
 	return q;
 }
@@ -56,17 +120,27 @@ void quarks_init(void)
 {
 	alloc_quarks = QUARKS_INIT;
 	quarks = mem_zalloc(alloc_quarks * sizeof(char*));
+	nr_quarks = 1;
+
+	quark_text = mem_arena_new(QUARK_BLOCK_SIZE);
+
+	quark_index_size = QUARKS_INIT * 2;
+	quark_index = mem_zalloc(quark_index_size * sizeof(*quark_index));
 }
 
 void quarks_free(void)
 {
-	size_t i;
+	mem_arena_destroy(quark_text);
+	quark_text = NULL;
 
-	/* quarks[0] is special */
-	for (i = 1; i < nr_quarks; i++)
-		string_free(quarks[i]);
+	mem_free(quark_index);
+	quark_index = NULL;
+	quark_index_size = 0;
 
 	mem_free(quarks);
+	quarks = NULL;
+	nr_quarks = 1;
+	alloc_quarks = 0;
 }
 
 struct init_module z_quark_module = {
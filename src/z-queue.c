@@ -17,6 +17,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include "z-queue.h"
 
 struct queue *q_new(size_t size) {
@@ -38,10 +39,31 @@ int q_len(struct queue *q) {
     return len;
 }
 
+/**
+ * Double the space in a full queue, unwrapping its contents to the start
+ */
+static void q_grow(struct queue *q) {
+    size_t n = q->size - 1;
+    size_t grown = n ? 2 * n : 1;
+    size_t first = q->size - q->head;
+    uintptr_t *data = (uintptr_t*)malloc(sizeof(uintptr_t) * (grown + 1));
+
+    if (!data) abort();
+    if (first > n) first = n;
+    memcpy(data, q->data + q->head, first * sizeof(uintptr_t));
+    memcpy(data + first, q->data, (n - first) * sizeof(uintptr_t));
+
+    free(q->data);
+    q->data = data;
+    q->size = grown + 1;
+    q->head = 0;
+    q->tail = n;
+}
+
 void q_push(struct queue *q, uintptr_t item) {
+    if ((q->tail + 1) % q->size == (size_t)q->head) q_grow(q);
     q->data[q->tail] = item;
     q->tail = (q->tail + 1) % q->size;
-    if (q->tail == q->head) abort();
 }
 
 uintptr_t q_pop(struct queue *q) {
@@ -74,6 +74,33 @@ static u32b WELLRNG1024a (void){
 	state_i = (state_i + 31) & 0x0000001fU;
 	return STATE[state_i];
 }
+
+#undef V0
+#undef VM1
+#undef VM2
+#undef VM3
+#undef VRm1
+#undef newV0
+#undef newV1
+
+/**
+ * The same generator, run on a separate stream's state
+ */
+static u32b WELLRNG1024a_stream(rng_state *rng)
+{
+	u32b *s = rng->state;
+	u32b i = rng->i;
+	u32b y0 = s[(i + 31) & 0x1fU];
+	u32b y1 = Identity(s[i]) ^ MAT0POS(8, s[(i + M1) & 0x1fU]);
+	u32b y2 = MAT0NEG(-19, s[(i + M2) & 0x1fU]) ^
+		MAT0NEG(-14, s[(i + M3) & 0x1fU]);
+
+	s[i] = y1 ^ y2;
+	s[(i + 31) & 0x1fU] = MAT0NEG(-11, y0) ^ MAT0NEG(-7, y1) ^
+		MAT0NEG(-13, y2);
+	rng->i = (i + 31) & 0x1fU;
+	return s[rng->i];
+}
 /* end WELL RNG */
 
 /**
@@ -96,32 +123,62 @@ static bool rand_fixed = FALSE;
 static u32b rand_fixval = 0;
 
 /**
- * Initialize the complex RNG using a new seed.
+ * Seed a complex RNG table
  */
-void Rand_state_init(u32b seed)
+static void rand_table_init(u32b *table, u32b *index, u32b seed)
 {
 	int i, j;
 
 	/* Seed the table */
-	STATE[0] = seed;
+	table[0] = seed;
 
 	/* Propagate the seed */
 	for (i = 1; i < RAND_DEG; i++)
-		STATE[i] = LCRNG(STATE[i - 1]);
+		table[i] = LCRNG(table[i - 1]);
 
 	/* Cycle the table ten times per degree */
 	for (i = 0; i < RAND_DEG * 10; i++) {
 		/* Acquire the next index */
-		j = (state_i + 1) % RAND_DEG;
+		j = (*index + 1) % RAND_DEG;
 
 		/* Update the table, extract an entry */
-		STATE[j] += STATE[state_i];
+		table[j] += table[*index];
 
 		/* Advance the index */
-		state_i = j;
+		*index = j;
 	}
 }
 
+/**
+ * Initialize the complex RNG using a new seed.
+ */
+void Rand_state_init(u32b seed)
+{
+	rand_table_init(STATE, &state_i, seed);
+}
+
+/**
+ * Initialize a separate RNG stream using a new seed.
+ */
+void rng_state_init(rng_state *rng, u32b seed)
+{
+	rng->i = 0;
+	rand_table_init(rng->state, &rng->i, seed);
+}
+
+/**
+ * Start a new stream, seeded from another one (or from the game's RNG if
+ * from is NULL).  Streams split off in the same order from the same parent
+ * always come out the same, and are independent of each other from then on.
+ */
+void rng_state_split(rng_state *from, rng_state *to)
+{
+	u32b seed = from ? WELLRNG1024a_stream(from) : WELLRNG1024a();
+
+	/* Make sure a child never shares its parent's table */
+	rng_state_init(to, seed ^ 0x9E3779B9);
+}
+
 /**
  * Initialise the RNG
  */
@@ -161,7 +218,7 @@ void Rand_init(void)
  * This method has no bias, and is much less affected by patterns in the "low"
  * bits of the underlying RNG's. However, it is potentially non-terminating.
  */
-u32b Rand_div(u32b m)
+static u32b rand_div_aux(rng_state *rng, u32b m)
 {
 	u32b r, n;
 
@@ -177,7 +234,14 @@ u32b Rand_div(u32b m)
 	/* Partition size */
 	n = (0x10000000 / m);
 
-	if (Rand_quick) {
+	if (rng) {
+		/* Use a separate stream */
+		while (1) {
+			r = WELLRNG1024a_stream(rng);
+			r = ((r >> 4) & 0x0FFFFFFF) / n;
+			if (r < m) break;
+		}
+	} else if (Rand_quick) {
 		/* Use a simple RNG */
 		/* Wait for it */
 		while (1) {
@@ -208,6 +272,31 @@ u32b Rand_div(u32b m)
 	return (r);
 }
 
+u32b Rand_div(u32b m)
+{
+	return rand_div_aux(NULL, m);
+}
+
+/**
+ * Fill a buffer with raw 32-bit output from a stream, for callers that want
+ * many random bits at once and will do their own reduction
+ */
+void rng_fill(rng_state *rng, u32b *buf, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		buf[i] = WELLRNG1024a_stream(rng);
+}
+
+/**
+ * Rand_div(), drawing from a separate stream
+ */
+u32b rng_div(rng_state *rng, u32b m)
+{
+	return rand_div_aux(rng, m);
+}
+
 
 /**
  * The number of entries in the "Rand_normal_table"
@@ -261,6 +350,13 @@ static s16b Rand_normal_table[RANDNOR_NUM] = {
 };
 
 
+/**
+ * For each roll out of 32768, the first entry of Rand_normal_table that is at
+ * least as big
+ */
+static byte Rand_normal_index[32768];
+static bool Rand_normal_indexed = FALSE;
+
 /**
  * Generate a random integer number of NORMAL distribution
  *
@@ -278,43 +374,57 @@ static s16b Rand_normal_table[RANDNOR_NUM] = {
  * standard deviations away from the mean.  This results in "conservative"
  * distribution of approximately 1/32768 values.
  *
- * Note that the binary search takes up to 16 quick iterations.
+ * Rather than search the table for every sample, it is inverted once into
+ * Rand_normal_index, which gives the answer the search would for each roll.
  */
-s16b Rand_normal(int mean, int stand)
+static s16b rand_normal_aux(rng_state *rng, int mean, int stand)
 {
-	s16b tmp, offset;
-
-	s16b low = 0;
-	s16b high = RANDNOR_NUM;
+	s16b tmp, offset, low;
 
 	/* Paranoia */
 	if (stand < 1) return (mean);
 
-	/* Roll for probability */
-	tmp = (s16b)randint0(32768);
-
-	/* Binary Search */
-	while (low < high) {
-		int mid = (low + high) >> 1;
+	/* Invert the table the first time through */
+	if (!Rand_normal_indexed) {
+		int i = 0;
 
-		/* Move right if forced */
-		if (Rand_normal_table[mid] < tmp) {
-			low = mid + 1;
-		} else {
-			high = mid;
+		for (tmp = 0; tmp < 32767; tmp++) {
+			while (Rand_normal_table[i] < tmp) i++;
+			Rand_normal_index[tmp] = i;
 		}
+		Rand_normal_index[32767] = RANDNOR_NUM - 1;
+		Rand_normal_indexed = TRUE;
 	}
 
+	/* Roll for probability */
+	tmp = (s16b)rand_div_aux(rng, 32768);
+
+	/* Find the first table entry at least that big */
+	low = Rand_normal_index[tmp];
+
 	/* Convert the index into an offset */
 	offset = (s16b)((long)stand * (long)low / RANDNOR_STD);
 
 	/* One half should be negative */
-	if (one_in_(2)) return (mean - offset);
+	if (!rand_div_aux(rng, 2)) return (mean - offset);
 
 	/* One half should be positive */
 	return (mean + offset);
 }
 
+s16b Rand_normal(int mean, int stand)
+{
+	return rand_normal_aux(NULL, mean, stand);
+}
+
+/**
+ * Rand_normal(), drawing from a separate stream
+ */
+s16b rng_normal(rng_state *rng, int mean, int stand)
+{
+	return rand_normal_aux(rng, mean, stand);
+}
+
 
 /**
  * Generates damage for "2d6" style dice rolls
@@ -331,6 +441,21 @@ int damroll(int num, int sides)
 	return sum;
 }
 
+/**
+ * damroll(), drawing from a separate stream
+ */
+int rng_damroll(rng_state *rng, int num, int sides)
+{
+	int i;
+	int sum = 0;
+
+	if (sides <= 0) return 0;
+
+	for (i = 0; i < num; i++)
+		sum += rng_div(rng, sides) + 1;
+	return sum;
+}
+
 
 
 /**
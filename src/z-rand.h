@@ -49,6 +49,15 @@ typedef struct random {
  */
 #define RAND_DEG 32
 
+/**
+ * The state of a separate stream of complex RNG numbers, for work that must
+ * not disturb (or be disturbed by) the game's own RNG.
+ */
+typedef struct rng_state {
+	u32b i;
+	u32b state[RAND_DEG];
+} rng_state;
+
 /**
  * Random aspects used by damcalc, m_bonus_calc, and ranvals
  */
@@ -89,6 +98,12 @@ typedef enum {
  */
 #define one_in_(x) (!randint0(x))
 
+/**
+ * randint0() and randint1(), drawing from a separate stream.
+ */
+#define rng_randint0(R, M) ((s32b) rng_div(R, M))
+#define rng_randint1(R, M) ((s32b) rng_div(R, M) + 1)
+
 /**
  * Whether we are currently using the "quick" method or not.
  */
@@ -119,18 +134,28 @@ void Rand_state_init(u32b seed);
  */
 void Rand_init(void);
 
+/**
+ * Initialise a separate RNG stream with the given seed, or from another
+ * stream (the game's RNG if from is NULL).
+ */
+void rng_state_init(rng_state *rng, u32b seed);
+void rng_state_split(rng_state *from, rng_state *to);
+
 /**
  * Generates a random unsigned long integer X where "0 <= X < M" holds.
  *
  * The integer X falls along a uniform distribution.
  */
 u32b Rand_div(u32b m);
+u32b rng_div(rng_state *rng, u32b m);
+void rng_fill(rng_state *rng, u32b *buf, size_t n);
 
 /**
  * Generate a signed random integer within `stand` standard deviations of
  * `mean`, following a normal distribution.
  */
 s16b Rand_normal(int mean, int stand);
+s16b rng_normal(rng_state *rng, int mean, int stand);
 
 /**
  * Generate a semi-random number from 0 to m-1, in a way that doesn't affect
@@ -143,6 +168,7 @@ u32b Rand_simple(u32b m);
  * Emulate a number `num` of dice rolls of dice with `sides` sides.
  */
 int damroll(int num, int sides);
+int rng_damroll(rng_state *rng, int num, int sides);
 
 /**
  * Calculation helper function for damroll
@@ -25,25 +25,94 @@ struct set {
 	void **elems;
 	size_t allocated;
 	size_t filled;
+
+	/* Open-addressed index of element positions (plus one, so that 0 is an
+	 * empty slot), hashed on the element pointer */
+	size_t *index;
+	size_t index_size;
 };
 
 static void _set_check(struct set *s) {
 	assert(s->allocated >= s->filled);
 	assert(!s->allocated || s->elems);
+	assert(s->index_size >= 2 * s->allocated);
+}
+
+static size_t _set_hash(struct set *s, void *p) {
+	size_t h = (size_t)p;
+	h ^= h >> 16;
+	h *= 0x45d9f3b;
+	h ^= h >> 16;
+	return h & (s->index_size - 1);
+}
+
+/* Put element pos into the index */
+static void _set_index_add(struct set *s, size_t pos) {
+	size_t i = _set_hash(s, s->elems[pos]);
+	while (s->index[i])
+		i = (i + 1) & (s->index_size - 1);
+	s->index[i] = pos + 1;
+}
+
+/* Find the index slot that holds element pos */
+static size_t _set_index_slot(struct set *s, size_t pos) {
+	size_t i = _set_hash(s, s->elems[pos]);
+	while (s->index[i] != pos + 1)
+		i = (i + 1) & (s->index_size - 1);
+	return i;
+}
+
+/* Empty an index slot, moving later entries of the probe run up to fill it */
+static void _set_index_remove(struct set *s, size_t slot) {
+	size_t mask = s->index_size - 1;
+	size_t j = slot, k = slot;
+
+	while (1) {
+		size_t h;
+
+		k = (k + 1) & mask;
+		if (!s->index[k])
+			break;
+
+		/* Leave entries whose home slot lies cyclically in (j, k] */
+		h = _set_hash(s, s->elems[s->index[k] - 1]);
+		if ((j < k) ? (h > j && h <= k) : (h > j || h <= k))
+			continue;
+
+		s->index[j] = s->index[k];
+		j = k;
+	}
+
+	s->index[j] = 0;
 }
 
 static void _set_grow(struct set *s) {
+	size_t i;
 	size_t nsz = s->allocated ? s->allocated * 2 : 16;
 	s->elems = mem_realloc(s->elems, nsz * sizeof(void*));
 	memset(s->elems + s->allocated, 0, sizeof(void*) * (nsz - s->allocated));
 	s->allocated = nsz;
+
+	/* Rebuild the index at the new size */
+	mem_free(s->index);
+	s->index_size = 2 * nsz;
+	s->index = mem_zalloc(s->index_size * sizeof(size_t));
+	for (i = 0; i < s->filled; i++)
+		_set_index_add(s, i);
 }
 
 static int _set_find(struct set *s, void *p) {
 	size_t i;
-	for (i = 0; i < s->filled; i++)
-		if (s->elems[i] == p)
-			return i;
+
+	if (!s->index_size)
+		return -1;
+
+	i = _set_hash(s, p);
+	while (s->index[i]) {
+		if (s->elems[s->index[i] - 1] == p)
+			return s->index[i] - 1;
+		i = (i + 1) & (s->index_size - 1);
+	}
 	return -1;
 }
 
@@ -54,6 +123,7 @@ struct set *set_new(void) {
 
 void set_free(struct set *s) {
 	_set_check(s);
+	mem_free(s->index);
 	mem_free(s->elems);
 	mem_free(s);
 }
@@ -63,18 +133,27 @@ void set_add(struct set *s, void *p) {
 	if (s->allocated == s->filled)
 		_set_grow(s);
 	s->elems[s->filled++] = p;
+	_set_index_add(s, s->filled - 1);
 }
 
 bool set_del(struct set *s, void *p) {
 	ssize_t i;
+	size_t last;
 	_set_check(s);
 
 	i = _set_find(s, p);
 	if (i < 0)
 		return FALSE;
+
 	/* overwrite elem i with the last elem, drop the size of the set
 	 * if the elem to delete is the last elem, this is a noop */
-	s->elems[i] = s->elems[--s->filled];
+	_set_index_remove(s, _set_index_slot(s, i));
+	last = --s->filled;
+	if ((size_t)i != last) {
+		s->index[_set_index_slot(s, last)] = i + 1;
+		s->elems[i] = s->elems[last];
+	}
+	s->elems[last] = NULL;
 	return TRUE;
 }
 
@@ -99,7 +178,19 @@ void *set_get(struct set *s, size_t index) {
 void set_insert(struct set *s, size_t index, void *p) {
 	while (index >= s->allocated)
 		_set_grow(s);
-	s->elems[index] = p;
-	if (index >= s->filled)
+
+	if (index < s->filled) {
+		/* Replace an existing element */
+		_set_index_remove(s, _set_index_slot(s, index));
+	} else {
+		/* Any gap up to the new element is filled with NULLs */
+		while (s->filled < index) {
+			s->elems[s->filled] = NULL;
+			_set_index_add(s, s->filled++);
+		}
 		s->filled = index + 1;
+	}
+
+	s->elems[index] = p;
+	_set_index_add(s, index);
 }
@@ -28,7 +28,7 @@
 #include "z-form.h"
 
 #define TEXTBLOCK_LEN_INITIAL		128
-#define TEXTBLOCK_LEN_INCR(x)		((x) + 128)
+#define TEXTBLOCK_LEN_INCR(x)		((x) * 2)
 
 struct textblock {
 	wchar_t *text;
@@ -36,6 +36,13 @@ struct textblock {
 
 	size_t strlen;
 	size_t size;
+
+	/* The last wrapping calculated, valid while strlen is unchanged */
+	size_t wrap_width;
+	size_t wrap_strlen;
+	size_t wrap_lines;
+	size_t *wrap_starts;
+	size_t *wrap_lengths;
 };
 
 
@@ -59,6 +66,8 @@ textblock *textblock_new(void)
  */
 void textblock_free(textblock *tb)
 {
+	mem_free(tb->wrap_starts);
+	mem_free(tb->wrap_lengths);
 	mem_free(tb->text);
 	mem_free(tb->attrs);
 	mem_free(tb);
@@ -78,6 +87,7 @@ void textblock_resize_if_needed(textblock *tb, size_t additional_size)
 	/* If we need more room, reallocate it */
 	if (remaining < additional_size) {
 		tb->size = TEXTBLOCK_LEN_INCR(tb->strlen + additional_size);
+		tb->size = MAX(tb->size, TEXTBLOCK_LEN_INCR(tb->size));
 		tb->text = mem_realloc(tb->text, tb->size * sizeof *tb->text);
 		tb->attrs = mem_realloc(tb->attrs, tb->size);
 	}
@@ -86,8 +96,9 @@ void textblock_resize_if_needed(textblock *tb, size_t additional_size)
 static void textblock_vappend_c(textblock *tb, byte attr, const char *fmt,
 		va_list vp)
 {
-	size_t temp_len = TEXTBLOCK_LEN_INITIAL;
-	char *temp_space = mem_zalloc(temp_len);
+	char temp_buf[1024];
+	size_t temp_len = sizeof(temp_buf);
+	char *temp_space = temp_buf;
 	int new_length;
 
 	/* We have to format the incoming string in native (external) format
@@ -107,7 +118,10 @@ static void textblock_vappend_c(textblock *tb, byte attr, const char *fmt,
 		}
 
 		temp_len = TEXTBLOCK_LEN_INCR(temp_len);
-		temp_space = mem_realloc(temp_space, temp_len * sizeof *temp_space);
+		if (temp_space == temp_buf)
+			temp_space = mem_alloc(temp_len * sizeof *temp_space);
+		else
+			temp_space = mem_realloc(temp_space, temp_len * sizeof *temp_space);
 	}
 
 	/* Get extent of addition in wide chars */
@@ -119,7 +133,8 @@ static void textblock_vappend_c(textblock *tb, byte attr, const char *fmt,
 	text_mbstowcs(tb->text + tb->strlen, temp_space, tb->size - tb->strlen);
 	memset(tb->attrs + tb->strlen, attr, new_length);
 	tb->strlen += new_length;
-	mem_free(temp_space);
+	if (temp_space != temp_buf)
+		mem_free(temp_space);
 }
 
 /**
@@ -133,6 +148,17 @@ void textblock_append_pict(textblock *tb, byte attr, int c)
 	tb->strlen += 1;
 }
 
+/**
+ * Add the whole of another text block, with its colours, to a text block.
+ */
+void textblock_append_textblock(textblock *tb, const textblock *tba)
+{
+	textblock_resize_if_needed(tb, tba->strlen);
+	memcpy(tb->text + tb->strlen, tba->text, tba->strlen * sizeof *tb->text);
+	memcpy(tb->attrs + tb->strlen, tba->attrs, tba->strlen);
+	tb->strlen += tba->strlen;
+}
+
 /**
  * Append a UTF-8 string to the textblock.
  *
@@ -226,11 +252,9 @@ static void new_line(size_t **line_starts, size_t **line_lengths,
 }
 
 /**
- * Given a certain width, split a textblock into wrapped lines of text.
- *
- * \returns Number of lines in output.
+ * Split a textblock into wrapped lines of text, ignoring any cached result.
  */
-size_t textblock_calculate_lines(textblock *tb,
+static size_t textblock_wrap(textblock *tb,
 		size_t **line_starts, size_t **line_lengths, size_t width)
 {
 	const wchar_t *text = tb->text;
@@ -288,6 +312,44 @@ size_t textblock_calculate_lines(textblock *tb,
 	return cur_line;
 }
 
+/**
+ * Given a certain width, split a textblock into wrapped lines of text.
+ *
+ * The result is remembered in the textblock, so asking again for the same
+ * width without appending anything in between just copies it.  The arrays
+ * returned belong to the caller as before.
+ *
+ * \returns Number of lines in output.
+ */
+size_t textblock_calculate_lines(textblock *tb,
+		size_t **line_starts, size_t **line_lengths, size_t width)
+{
+	size_t n = sizeof(size_t) * tb->wrap_lines;
+
+	if (!tb->wrap_width || tb->wrap_width != width ||
+			tb->wrap_strlen != tb->strlen) {
+		mem_free(tb->wrap_starts);
+		mem_free(tb->wrap_lengths);
+		tb->wrap_starts = NULL;
+		tb->wrap_lengths = NULL;
+		tb->wrap_lines = textblock_wrap(tb, &tb->wrap_starts,
+				&tb->wrap_lengths, width);
+		tb->wrap_width = width;
+		tb->wrap_strlen = tb->strlen;
+		n = sizeof(size_t) * tb->wrap_lines;
+	}
+
+	/* Callers expect arrays they can free, even when empty */
+	*line_starts = mem_realloc(*line_starts, MAX(n, sizeof(size_t)));
+	*line_lengths = mem_realloc(*line_lengths, MAX(n, sizeof(size_t)));
+	if (n) {
+		memcpy(*line_starts, tb->wrap_starts, n);
+		memcpy(*line_lengths, tb->wrap_lengths, n);
+	}
+
+	return tb->wrap_lines;
+}
+
 /**
  * Output a textblock to file.
  */
@@ -0,0 +1,168 @@
+/**
+ * \file z-trace.c
+ * \brief Timeline tracing, exported as Chrome trace JSON
+ *
+ * Copyright (c) 2026 Angband contributors
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "z-trace.h"
+
+#ifdef EVENT_TRACE
+
+#include "z-file.h"
+#include "z-virt.h"
+#include <time.h>
+
+/**
+ * One end of a span.
+ */
+struct trace_event {
+	const char *name;
+	double ts;			/* Microseconds */
+	char ph;			/* 'B'egin or 'E'nd */
+};
+
+/**
+ * The events recorded by one thread.  Rings are never freed, so that a dump
+ * can always walk them.
+ */
+struct trace_ring {
+	struct trace_ring *next;
+	int tid;
+	u32b count;			/* Events ever recorded; the ring holds the last ones */
+	struct trace_event events[TRACE_RING_SIZE];
+};
+
+static struct trace_ring *trace_rings;
+static int trace_threads;
+
+/**
+ * Per-thread storage needs a compiler extension, so tracing builds need GCC
+ * or clang.
+ */
+static __thread struct trace_ring *trace_mine;
+
+/**
+ * Microseconds since some fixed point.
+ */
+static double trace_now(void)
+{
+#if defined(UNIX) && defined(CLOCK_MONOTONIC)
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+#else
+	return clock() * (1000000.0 / CLOCKS_PER_SEC);
+#endif
+}
+
+/**
+ * Record one event for the calling thread, making its ring on first use.
+ */
+static void trace_record(const char *name, char ph)
+{
+	struct trace_ring *ring = trace_mine;
+	struct trace_event *e;
+
+	if (!ring) {
+		ring = trace_mine = mem_zalloc(sizeof(*ring));
+		ring->tid = __sync_add_and_fetch(&trace_threads, 1);
+		do
+			ring->next = trace_rings;
+		while (!__sync_bool_compare_and_swap(&trace_rings, ring->next, ring));
+	}
+
+	e = &ring->events[ring->count % TRACE_RING_SIZE];
+	e->name = name;
+	e->ph = ph;
+	e->ts = trace_now();
+	ring->count++;
+}
+
+void trace_begin(const char *name)
+{
+	trace_record(name, 'B');
+}
+
+void trace_end(const char *name)
+{
+	trace_record(name, 'E');
+}
+
+/**
+ * Write a string as a JSON string.
+ */
+static void trace_put_string(ang_file *f, const char *s)
+{
+	file_put(f, "\"");
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\')
+			file_putf(f, "\\%c", *s);
+		else if ((unsigned char)*s < ' ')
+			file_putf(f, "\\u%04x", (unsigned char)*s);
+		else
+			file_putf(f, "%c", *s);
+	}
+	file_put(f, "\"");
+}
+
+/**
+ * Write every thread's recorded events to `path` in the Chrome trace event
+ * format, which chrome://tracing and Perfetto load.
+ *
+ * Spans whose start has been overwritten in the ring are left out; spans
+ * still open are left open.  Other threads' rings are read as they stand,
+ * so a thread recording during the dump may contribute a torn event.
+ */
+bool trace_dump(const char *path)
+{
+	struct trace_ring *ring;
+	bool first = TRUE;
+	ang_file *f = file_open(path, MODE_WRITE, FTYPE_TEXT);
+
+	if (!f) return FALSE;
+
+	file_put(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	for (ring = trace_rings; ring; ring = ring->next) {
+		u32b count = ring->count;
+		u32b i = count > TRACE_RING_SIZE ? count - TRACE_RING_SIZE : 0;
+		int depth = 0;
+
+		for (; i < count; i++) {
+			const struct trace_event *e = &ring->events[i % TRACE_RING_SIZE];
+
+			if (e->ph == 'E') {
+				if (!depth) continue;
+				depth--;
+			} else {
+				depth++;
+			}
+
+			file_put(f, first ? "" : ",\n");
+			file_put(f, "{\"name\":");
+			trace_put_string(f, e->name);
+			file_putf(f, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+					  e->ph, e->ts, ring->tid);
+			first = FALSE;
+		}
+	}
+
+	file_put(f, "\n]}\n");
+
+	return file_close(f);
+}
+
+#endif /* EVENT_TRACE */
@@ -0,0 +1,59 @@
+/**
+ * \file z-trace.h
+ * \brief Timeline tracing, exported as Chrome trace JSON
+ *
+ * Copyright (c) 2026 Angband contributors
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef INCLUDED_Z_TRACE_H
+#define INCLUDED_Z_TRACE_H
+
+#include "h-basic.h"
+
+/**
+ * Tracing is only compiled into builds with EVENT_TRACE defined.  Each
+ * thread then records the start and end of every marked span into its own
+ * ring, which keeps the latest TRACE_RING_SIZE events, so a dump shows the
+ * time leading up to it.  Otherwise the markers compile to nothing.
+ *
+ * TRACE_BEGIN() and TRACE_END() must pair up within a thread, and `name`
+ * must stay valid until the trace is dumped (a string literal, or a name
+ * from the game data).  TRACE() marks a single call.
+ */
+#ifdef EVENT_TRACE
+
+#define TRACE_RING_SIZE	65536
+
+void trace_begin(const char *name);
+void trace_end(const char *name);
+bool trace_dump(const char *path);
+
+#define TRACE_BEGIN(name) trace_begin(name)
+#define TRACE_END(name) trace_end(name)
+#define TRACE(name, call) \
+	do { \
+		trace_begin(name); \
+		call; \
+		trace_end(name); \
+	} while (0)
+
+#else /* EVENT_TRACE */
+
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE(name, call) call
+
+#endif /* EVENT_TRACE */
+
+#endif /* INCLUDED_Z_TRACE_H */
@@ -20,8 +20,145 @@
 
 unsigned int mem_flags = 0;
 
+/**
+ * Number of calls to the system allocator so far, for benchmarks
+ */
+unsigned long mem_alloc_count = 0;
+
 #define SZ(uptr)	*((size_t *)((char *)(uptr) - sizeof(size_t)))
 
+#ifdef MEM_TRACK
+
+#undef mem_alloc
+#undef mem_zalloc
+#undef mem_realloc
+#undef string_make
+
+/* Tracked blocks also record their call site, before the size */
+#define MEM_HEAD	(2 * sizeof(size_t))
+#define SITE(uptr)	*((size_t *)((char *)(uptr) - MEM_HEAD))
+
+#define MEM_SITES	4096
+
+static struct mem_site {
+	const char *file;
+	int line;
+	size_t count;		/* Allocations made */
+	size_t bytes;		/* Bytes allocated in total */
+	size_t live;		/* Bytes allocated and not yet freed */
+	size_t peak;		/* Most bytes live at once */
+} mem_sites[MEM_SITES];
+
+static size_t mem_live, mem_peak;
+
+static void mem_track_exit(void);
+
+/**
+ * Find the record for a call site, starting a new one if necessary; the last
+ * slot collects everything once the table is full
+ */
+static size_t mem_site_find(const char *file, int line)
+{
+	static bool registered;
+	size_t h = ((size_t)file * 31 + line) % (MEM_SITES - 1);
+	size_t probes;
+
+	if (!registered) {
+		atexit(mem_track_exit);
+		registered = TRUE;
+	}
+
+	for (probes = 0; probes < MEM_SITES - 1; probes++) {
+		struct mem_site *s = &mem_sites[h];
+
+		if (!s->file) {
+			s->file = file;
+			s->line = line;
+		}
+		if (s->file == file && s->line == line)
+			return h;
+		h = (h + 1) % (MEM_SITES - 1);
+	}
+
+	mem_sites[MEM_SITES - 1].file = "(other)";
+	return MEM_SITES - 1;
+}
+
+static void mem_track_add(size_t site, size_t len)
+{
+	struct mem_site *s = &mem_sites[site];
+
+	s->count++;
+	s->bytes += len;
+	s->live += len;
+	s->peak = MAX(s->peak, s->live);
+	mem_live += len;
+	mem_peak = MAX(mem_peak, mem_live);
+}
+
+static void mem_track_sub(size_t site, size_t len)
+{
+	mem_sites[site].live -= len;
+	mem_live -= len;
+}
+
+static int mem_site_cmp(const void *a, const void *b)
+{
+	const struct mem_site *sa = *(const struct mem_site * const *)a;
+	const struct mem_site *sb = *(const struct mem_site * const *)b;
+
+	if (sa->peak != sb->peak)
+		return sa->peak < sb->peak ? 1 : -1;
+	return sa->bytes < sb->bytes ? 1 : (sa->bytes > sb->bytes ? -1 : 0);
+}
+
+/**
+ * Report allocations by call site, biggest peak first, one line at a time
+ */
+void mem_track_dump(void (*out)(const char *line))
+{
+	struct mem_site *sorted[MEM_SITES];
+	char buf[256];
+	size_t i, n = 0;
+
+	for (i = 0; i < MEM_SITES; i++)
+		if (mem_sites[i].count)
+			sorted[n++] = &mem_sites[i];
+	qsort(sorted, n, sizeof(sorted[0]), mem_site_cmp);
+
+	snprintf(buf, sizeof(buf), "%lu bytes live, %lu at peak",
+			(unsigned long)mem_live, (unsigned long)mem_peak);
+	out(buf);
+	snprintf(buf, sizeof(buf), "%10s %12s %10s %10s  %s", "allocs",
+			"bytes", "live", "peak", "site");
+	out(buf);
+	for (i = 0; i < n; i++) {
+		snprintf(buf, sizeof(buf), "%10lu %12lu %10lu %10lu  %s:%d",
+				(unsigned long)sorted[i]->count,
+				(unsigned long)sorted[i]->bytes,
+				(unsigned long)sorted[i]->live,
+				(unsigned long)sorted[i]->peak,
+				sorted[i]->file, sorted[i]->line);
+		out(buf);
+	}
+}
+
+static void mem_track_print(const char *line)
+{
+	fprintf(stderr, "%s\n", line);
+}
+
+static void mem_track_exit(void)
+{
+	mem_track_dump(mem_track_print);
+}
+
+#else
+
+#define MEM_HEAD	sizeof(size_t)
+
+#endif /* MEM_TRACK */
+
 /**
  * Allocate `len` bytes of memory.
  *
@@ -31,27 +168,66 @@ unsigned int mem_flags = 0;
  *
  * Doesn't return on out of memory.
  */
-void *mem_alloc(size_t len)
+static void *mem_alloc_site(size_t len, const char *file, int line)
 {
 	char *mem;
 
 	/* Allow allocation of "zero bytes" */
 	if (len == 0) return (NULL);
 
-	mem = malloc(len + sizeof(size_t));
+	mem = malloc(len + MEM_HEAD);
 	if (!mem)
 		quit("Out of Memory!");
-	mem += sizeof(size_t);
+	mem_alloc_count++;
+	mem += MEM_HEAD;
 	if (mem_flags & MEM_POISON_ALLOC)
 		memset(mem, 0xCC, len);
 	SZ(mem) = len;
 
+#ifdef MEM_TRACK
+	SITE(mem) = mem_site_find(file, line);
+	mem_track_add(SITE(mem), len);
+#endif
+
 	return mem;
 }
 
+static void *mem_realloc_site(void *p, size_t len, const char *file, int line)
+{
+	char *m = p;
+
+	/* Fail gracefully */
+	if (len == 0) return (NULL);
+
+#ifdef MEM_TRACK
+	if (m)
+		mem_track_sub(SITE(m), SZ(m));
+#endif
+
+	m = realloc(m ? m - MEM_HEAD : NULL, len + MEM_HEAD);
+
+	/* Handle OOM */
+	if (!m) quit("Out of Memory!");
+	mem_alloc_count++;
+	m += MEM_HEAD;
+	SZ(m) = len;
+
+#ifdef MEM_TRACK
+	SITE(m) = mem_site_find(file, line);
+	mem_track_add(SITE(m), len);
+#endif
+
+	return m;
+}
+
+void *mem_alloc(size_t len)
+{
+	return mem_alloc_site(len, __FILE__, __LINE__);
+}
+
 void *mem_zalloc(size_t len)
 {
-	void *mem = mem_alloc(len);
+	void *mem = mem_alloc_site(len, __FILE__, __LINE__);
 	memset(mem, 0, len);
 	return mem;
 }
@@ -60,32 +236,240 @@ void mem_free(void *p)
 {
 	if (!p) return;
 
+#ifdef MEM_TRACK
+	mem_track_sub(SITE(p), SZ(p));
+#endif
+
 	if (mem_flags & MEM_POISON_FREE)
 		memset(p, 0xCD, SZ(p));
-	free((char *)p - sizeof(size_t));
+	free((char *)p - MEM_HEAD);
 }
 
 void *mem_realloc(void *p, size_t len)
 {
-	char *m = p;
+	return mem_realloc_site(p, len, __FILE__, __LINE__);
+}
 
-	/* Fail gracefully */
-	if (len == 0) return (NULL);
+#ifdef MEM_TRACK
+void *mem_alloc_at(size_t len, const char *file, int line)
+{
+	return mem_alloc_site(len, file, line);
+}
 
-	m = realloc(m ? m - sizeof(size_t) : NULL, len + sizeof(size_t));
-	m += sizeof(size_t);
+void *mem_zalloc_at(size_t len, const char *file, int line)
+{
+	void *mem = mem_alloc_site(len, file, line);
+	memset(mem, 0, len);
+	return mem;
+}
 
-	/* Handle OOM */
-	if (!m) quit("Out of Memory!");
-	SZ(m) = len;
+void *mem_realloc_at(void *p, size_t len, const char *file, int line)
+{
+	return mem_realloc_site(p, len, file, line);
+}
+#endif
 
-	return m;
+/**
+ * Everything handed out by pools and arenas is aligned for any of these
+ */
+union mem_align {
+	long l;
+	double d;
+	void *p;
+};
+
+#define MEM_ALIGN(len) \
+	(((len) + sizeof(union mem_align) - 1) & ~(sizeof(union mem_align) - 1))
+
+struct mem_pool_block {
+	struct mem_pool_block *next;
+	union mem_align data[1];
+};
+
+struct mem_pool {
+	size_t size;
+	size_t per_block;
+	struct mem_pool_block *blocks;
+	void *free_list;
+	size_t fresh;		/* Untouched objects left in the newest block */
+	struct mem_pool_stats stats;
+};
+
+/**
+ * Make a pool of objects of `size` bytes, taking room for `per_block` of
+ * them at a time.
+ */
+struct mem_pool *mem_pool_new(size_t size, size_t per_block)
+{
+	struct mem_pool *pool = mem_zalloc(sizeof(*pool));
+
+	/* Free objects hold the free list link */
+	pool->size = MEM_ALIGN(MAX(size, sizeof(void *)));
+	pool->per_block = MAX(per_block, 1);
+	return pool;
+}
+
+/**
+ * Take a zeroed object from the pool.
+ */
+void *mem_pool_zalloc(struct mem_pool *pool)
+{
+	void *p;
+
+	if (pool->free_list) {
+		p = pool->free_list;
+		pool->free_list = *(void **)p;
+	} else {
+		if (!pool->fresh) {
+			struct mem_pool_block *b = mem_alloc(sizeof(*b) +
+					pool->size * pool->per_block);
+			b->next = pool->blocks;
+			pool->blocks = b;
+			pool->fresh = pool->per_block;
+			pool->stats.blocks++;
+		}
+		p = (char *)pool->blocks->data +
+			pool->size * (pool->per_block - pool->fresh--);
+	}
+
+	pool->stats.in_use++;
+	pool->stats.peak = MAX(pool->stats.peak, pool->stats.in_use);
+
+	memset(p, 0, pool->size);
+	return p;
+}
+
+/**
+ * Give an object back to the pool it came from.
+ */
+void mem_pool_free(struct mem_pool *pool, void *p)
+{
+	if (!p) return;
+
+	if (mem_flags & MEM_POISON_FREE)
+		memset(p, 0xCD, pool->size);
+	*(void **)p = pool->free_list;
+	pool->free_list = p;
+	pool->stats.in_use--;
+}
+
+/**
+ * Free a pool and every object in it.
+ */
+void mem_pool_destroy(struct mem_pool *pool)
+{
+	if (!pool) return;
+
+	while (pool->blocks) {
+		struct mem_pool_block *next = pool->blocks->next;
+		mem_free(pool->blocks);
+		pool->blocks = next;
+	}
+	mem_free(pool);
+}
+
+void mem_pool_get_stats(const struct mem_pool *pool,
+		struct mem_pool_stats *stats)
+{
+	*stats = pool->stats;
+}
+
+struct mem_arena_block {
+	struct mem_arena_block *next;
+	size_t size;
+	union mem_align data[1];
+};
+
+struct mem_arena {
+	size_t block_size;
+	struct mem_arena_block *blocks;	/* Newest first */
+	size_t used;			/* Bytes used in the newest block */
+};
+
+/**
+ * Make an arena that takes memory `block_size` bytes at a time.
+ */
+struct mem_arena *mem_arena_new(size_t block_size)
+{
+	struct mem_arena *arena = mem_zalloc(sizeof(*arena));
+	arena->block_size = MAX(block_size, sizeof(union mem_align));
+	return arena;
+}
+
+/**
+ * Allocate `len` bytes from an arena.  The memory is not initialised, and
+ * stays where it is until the arena is popped past it or destroyed.
+ */
+void *mem_arena_alloc(struct mem_arena *arena, size_t len)
+{
+	struct mem_arena_block *b = arena->blocks;
+	void *p;
+
+	if (len == 0) return NULL;
+	len = MEM_ALIGN(len);
+
+	if (!b || b->size - arena->used < len) {
+		size_t size = MAX(len, arena->block_size);
+
+		b = mem_alloc(sizeof(*b) + size);
+		b->next = arena->blocks;
+		b->size = size;
+		arena->blocks = b;
+		arena->used = 0;
+	}
+
+	p = (char *)b->data + arena->used;
+	arena->used += len;
+
+	if (mem_flags & MEM_POISON_ALLOC)
+		memset(p, 0xCC, len);
+	return p;
+}
+
+/**
+ * Remember how much of the arena is in use.
+ */
+struct mem_arena_mark mem_arena_push(const struct mem_arena *arena)
+{
+	struct mem_arena_mark mark;
+
+	mark.block = arena->blocks;
+	mark.used = arena->used;
+	return mark;
+}
+
+/**
+ * Release everything allocated from the arena since `mark` was taken.
+ */
+void mem_arena_pop(struct mem_arena *arena, struct mem_arena_mark mark)
+{
+	while (arena->blocks && arena->blocks != mark.block) {
+		struct mem_arena_block *next = arena->blocks->next;
+		mem_free(arena->blocks);
+		arena->blocks = next;
+	}
+	arena->used = mark.block ? mark.used : 0;
+}
+
+/**
+ * Free an arena and everything allocated from it.
+ */
+void mem_arena_destroy(struct mem_arena *arena)
+{
+	if (!arena) return;
+
+	while (arena->blocks) {
+		struct mem_arena_block *next = arena->blocks->next;
+		mem_free(arena->blocks);
+		arena->blocks = next;
+	}
+	mem_free(arena);
 }
 
 /**
  * Duplicates an existing string `str`, allocating as much memory as necessary.
  */
-char *string_make(const char *str)
+static char *string_make_site(const char *str, const char *file, int line)
 {
 	char *res;
 	size_t siz;
@@ -95,7 +479,7 @@ char *string_make(const char *str)
 
 	/* Allocate space for the string (including terminator) */
 	siz = strlen(str) + 1;
-	res = mem_alloc(siz);
+	res = mem_alloc_site(siz, file, line);
 
 	/* Copy the string (with terminator) */
 	my_strcpy(res, str, siz);
@@ -103,6 +487,18 @@ char *string_make(const char *str)
 	return res;
 }
 
+char *string_make(const char *str)
+{
+	return string_make_site(str, __FILE__, __LINE__);
+}
+
+#ifdef MEM_TRACK
+char *string_make_at(const char *str, const char *file, int line)
+{
+	return string_make_site(str, file, line);
+}
+#endif
+
 void string_free(char *str)
 {
 	mem_free(str);
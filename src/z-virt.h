@@ -27,11 +27,67 @@ char *string_make(const char *str);
 void string_free(char *str);
 char *string_append(char *s1, const char *s2);
 
+/**
+ * Pools of fixed-size objects, carved out of larger blocks.  Freed objects
+ * go on a free list for reuse, and everything goes when the pool does.
+ */
+struct mem_pool;
+
+struct mem_pool *mem_pool_new(size_t size, size_t per_block);
+void *mem_pool_zalloc(struct mem_pool *pool);
+void mem_pool_free(struct mem_pool *pool, void *p);
+void mem_pool_destroy(struct mem_pool *pool);
+
+struct mem_pool_stats {
+	size_t in_use;		/* Objects currently allocated */
+	size_t peak;		/* Most objects ever allocated at once */
+	size_t blocks;		/* Blocks taken from mem_alloc() */
+};
+
+void mem_pool_get_stats(const struct mem_pool *pool,
+		struct mem_pool_stats *stats);
+
+/**
+ * Arenas for allocations of any size that are all released together, either
+ * completely or back to a mark taken earlier.
+ */
+struct mem_arena;
+
+struct mem_arena_mark {
+	void *block;
+	size_t used;
+};
+
+struct mem_arena *mem_arena_new(size_t block_size);
+void *mem_arena_alloc(struct mem_arena *arena, size_t len);
+struct mem_arena_mark mem_arena_push(const struct mem_arena *arena);
+void mem_arena_pop(struct mem_arena *arena, struct mem_arena_mark mark);
+void mem_arena_destroy(struct mem_arena *arena);
+
+/**
+ * Allocation tracking, for builds with MEM_TRACK defined.  Every allocation
+ * is charged to the file and line that made it, and a report of counts,
+ * bytes and peak live bytes per call site is printed at exit or on demand.
+ */
+#ifdef MEM_TRACK
+void *mem_alloc_at(size_t len, const char *file, int line);
+void *mem_zalloc_at(size_t len, const char *file, int line);
+void *mem_realloc_at(void *p, size_t len, const char *file, int line);
+char *string_make_at(const char *str, const char *file, int line);
+void mem_track_dump(void (*out)(const char *line));
+
+#define mem_alloc(len)		mem_alloc_at((len), __FILE__, __LINE__)
+#define mem_zalloc(len)		mem_zalloc_at((len), __FILE__, __LINE__)
+#define mem_realloc(p, len)	mem_realloc_at((p), (len), __FILE__, __LINE__)
+#define string_make(str)	string_make_at((str), __FILE__, __LINE__)
+#endif
+
 enum {
 	MEM_POISON_ALLOC = 0x00000001,
 	MEM_POISON_FREE  = 0x00000002
 };
 
 extern unsigned int mem_flags;
+extern unsigned long mem_alloc_count;
 
 #endif /* INCLUDED_Z_VIRT_H */